@@ -0,0 +1,48 @@
+#!/bin/bash
+#--------------------------------------------------------------
+# Compare serial and multi-threaded Kirchhoff depth migration (SUKDMIG2D)
+# Requires a CWP/SU installation to create the input data and traveltime tables.
+#
+
+if [ -z "$CWPROOT" ]; then
+  echo "Environment variable CWPROOT is not set. CWP/SU is required to create the input data."
+  exit -1
+fi
+export PATH=$CWPROOT/bin:$PATH
+
+if [ ! -d data ]; then
+  mkdir data
+fi
+if [ ! -d logs ]; then
+  mkdir logs
+fi
+
+# Constant velocity 2000m/s, traveltime tables on a 20m grid for 21 source positions
+makevel nz=51 nx=101 v000=2000 > data/t08_kdmig_vel.bin
+rayt2d < data/t08_kdmig_vel.bin nt=251 dt=0.004 \
+  fz=0 nz=51 dz=20 fx=0 nx=101 dx=20 \
+  fzo=0 nzo=51 dzo=20 fxo=0 nxo=101 dxo=20 \
+  fxs=0 nxs=21 dxs=100 ek=0 ms=1 > data/t08_kdmig_tt.bin
+
+# Shot gathers over one flat reflector at 500m depth
+susynlv kilounits=0 nt=501 dt=0.004 v00=2000 \
+  nxs=6 fxs=0 dxs=200 nxg=41 fxg=0 dxg=25 \
+  ref="0,500;2000,500" > data/t08_kdmig_input.su
+
+flow=t08_sukdmig2d_threads.flow
+for nthreads in 1 4
+do
+  echo "Run processing flow $flow with nthreads=$nthreads"
+  echo "    seaseis -f $flow -d logs -D nthreads=$nthreads"
+  seaseis -f $flow -d logs -D nthreads=$nthreads
+  if [ $? -ne 0 ]; then
+    echo "    ..flow $flow terminated with ERRORS."
+    exit -1
+  fi
+done
+
+# Differences are at the level of float rounding: Traces are summed in a different order
+echo "Maximum absolute amplitude, nthreads=1:"
+sumax < data/t08_kdmig_nthreads1.su mode=abs
+echo "Maximum absolute difference between nthreads=1 and nthreads=4:"
+suop2 data/t08_kdmig_nthreads1.su data/t08_kdmig_nthreads4.su op=diff | sumax mode=abs
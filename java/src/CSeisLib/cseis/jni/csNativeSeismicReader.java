@@ -4,6 +4,9 @@
 
 package cseis.jni;
 
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.FloatBuffer;
 import cseis.seis.csHeader;
 import cseis.seis.csISeismicReader;
 import cseis.seis.csSeismicTrace;
@@ -29,6 +32,8 @@ public class csNativeSeismicReader implements csISeismicReader {
   
   private native boolean native_getNextTrace( long ptr, float[] samples, csSeismicTrace trace ) throws Exception;
   private native boolean native_moveToTrace( long ptr, int traceIndex, int numTracesToRead ) throws Exception;
+  private native int native_readTraces( long ptr, int firstTraceIndex, int numTraces, int traceStep, int sampleStep,
+          ByteBuffer sampleBuffer, ByteBuffer hdrBuffer ) throws Exception;
   
   private native String native_headerName( long ptr, int hdrIndex );
   private native String native_headerDesc( long ptr, int hdrIndex );
@@ -53,6 +58,11 @@ public class csNativeSeismicReader implements csISeismicReader {
   private native void native_freeInstance( long nativePtr );
 
   protected long myNativePtr = 0;
+  /// Direct buffers used by getTraces()
+  private ByteBuffer mySampleBuffer = null;
+  private ByteBuffer myHdrBuffer = null;
+  private int[] myHeaderTypes = null;
+  private boolean myHasStringHeaders = false;
 
   public csNativeSeismicReader( String filename ) throws Exception {
     this( filename, 20 );
@@ -96,6 +106,96 @@ public class csNativeSeismicReader implements csISeismicReader {
     boolean success = native_getNextTrace( myNativePtr, trace.samples(), trace );
     return success;
   }
+  /**
+   * Read block of traces with one native call.
+   * Samples are stored trace after trace in sampleBuffer (float values), header values in hdrBuffer
+   * (8 bytes per header value: double for floating point headers, long for integer headers, zero for string headers).
+   * Both buffers must be direct byte buffers in native byte order.
+   * 
+   * @param firstTraceIndex Index of first trace to read, starting at 0
+   * @param numTraces       Maximum number of traces to read
+   * @param traceStep       Trace decimation step (1: Read all traces)
+   * @param sampleStep      Sample decimation step (1: Keep all samples)
+   * @param sampleBuffer    (o) Sample buffer, at least numTraces * numSamplesDecimated(sampleStep) * 4 bytes
+   * @param hdrBuffer       (o) Header buffer, at least numTraces * numHeaders() * 8 bytes. Pass null if not required
+   * @return Number of traces read
+   */
+  public int readTraces( int firstTraceIndex, int numTraces, int traceStep, int sampleStep,
+          ByteBuffer sampleBuffer, ByteBuffer hdrBuffer ) throws Exception {
+    return native_readTraces( myNativePtr, firstTraceIndex, numTraces, traceStep, sampleStep, sampleBuffer, hdrBuffer );
+  }
+  /**
+   * @param sampleStep Sample decimation step
+   * @return Number of samples per trace after decimation
+   */
+  public int numSamplesDecimated( int sampleStep ) {
+    if( sampleStep < 1 ) sampleStep = 1;
+    return ( numSamples() + sampleStep - 1 ) / sampleStep;
+  }
+  /**
+   * Read block of traces into existing trace objects.
+   * Same as moveToTrace() followed by repeated calls to getNextTrace() (every traceStep'th trace),
+   * but all traces cross the JNI boundary in one call.
+   * 
+   * @param firstTraceIndex Index of first trace to read, starting at 0
+   * @param traceStep       Trace decimation step (1: Read all traces)
+   * @param traces          (o) Traces to fill, with numSamples() samples and numHeaders() headers each
+   * @return Number of traces read
+   */
+  public int getTraces( int firstTraceIndex, int traceStep, csSeismicTrace[] traces ) throws Exception {
+    int numTracesToRead = traces.length;
+    int numSamples = numSamples();
+    int numHeaders = numHeaders();
+    if( myHeaderTypes == null ) {
+      myHeaderTypes = new int[numHeaders];
+      for( int ihdr = 0; ihdr < numHeaders; ihdr++ ) {
+        myHeaderTypes[ihdr] = headerType( ihdr );
+        if( myHeaderTypes[ihdr] == csJNIDef.TYPE_STRING ) myHasStringHeaders = true;
+      }
+    }
+    if( myHasStringHeaders ) {
+      // String header values are not part of the header buffer: Read trace by trace
+      int numTracesRead = 0;
+      for( ; numTracesRead < numTracesToRead; numTracesRead++ ) {
+        int traceIndex = firstTraceIndex + numTracesRead * traceStep;
+        if( traceIndex >= numTraces() ) break;
+        if( numTracesRead == 0 || traceStep > 1 ) {
+          if( !moveToTrace( traceIndex, traceStep == 1 ? numTracesToRead : 1 ) ) break;
+        }
+        if( !getNextTrace( traces[numTracesRead] ) ) break;
+      }
+      return numTracesRead;
+    }
+    if( mySampleBuffer == null || mySampleBuffer.capacity() < numTracesToRead * numSamples * 4 ) {
+      mySampleBuffer = ByteBuffer.allocateDirect( numTracesToRead * numSamples * 4 ).order( ByteOrder.nativeOrder() );
+      myHdrBuffer    = ByteBuffer.allocateDirect( numTracesToRead * numHeaders * 8 ).order( ByteOrder.nativeOrder() );
+    }
+    int numTracesRead = native_readTraces( myNativePtr, firstTraceIndex, numTracesToRead, traceStep, 1, mySampleBuffer, myHdrBuffer );
+    FloatBuffer samples = mySampleBuffer.asFloatBuffer();
+    for( int itrc = 0; itrc < numTracesRead; itrc++ ) {
+      samples.position( itrc * numSamples );
+      samples.get( traces[itrc].samples(), 0, numSamples );
+      csHeader[] headers = traces[itrc].headerValues();
+      int bytePos = itrc * numHeaders * 8;
+      for( int ihdr = 0; ihdr < numHeaders; ihdr++, bytePos += 8 ) {
+        switch( myHeaderTypes[ihdr] ) {
+          case csJNIDef.TYPE_DOUBLE:
+            headers[ihdr].setValue( myHdrBuffer.getDouble( bytePos ) );
+            break;
+          case csJNIDef.TYPE_FLOAT:
+            headers[ihdr].setValue( (float)myHdrBuffer.getDouble( bytePos ) );
+            break;
+          case csJNIDef.TYPE_LONG:
+            headers[ihdr].setValue( myHdrBuffer.getLong( bytePos ) );
+            break;
+          default:
+            headers[ihdr].setValue( (int)myHdrBuffer.getLong( bytePos ) );
+            break;
+        }
+      }
+    }
+    return numTracesRead;
+  }
   @Override
   public boolean hasRandomFileAccess() {
     return true;
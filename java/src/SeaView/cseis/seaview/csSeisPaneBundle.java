@@ -18,6 +18,7 @@ import cseis.jni.csNativeFFTTransform;
 import cseis.jni.csNativeRSFReader;
 import cseis.jni.csNativeSegdReader;
 import cseis.jni.csNativeSegyReader;
+import cseis.jni.csNativeSeismicReader;
 import cseis.segy.csSegyHeaderView;
 import cseis.seis.csHeader;
 import cseis.seis.csHeaderDef;
@@ -68,6 +69,8 @@ public class csSeisPaneBundle extends JPanel implements csIGraphPanelListener,
   private static int id_counter = 0;
   /// Number of traces to read before progress bar is refreshed:
   private static final int REFRESH_FREQUENCY = 20;
+  /// Number of traces read in one native call (SeaSeis files only)
+  private static final int NUM_TRACES_BULK_READ = 500;
   
   public static int OPERATION_SUBTRACT = 0; // Do not change number values
   public static int OPERATION_ADD      = 1;
@@ -1060,19 +1063,41 @@ public class csSeisPaneBundle extends JPanel implements csIGraphPanelListener,
             }
             int counterDisplayedTraces = 0;  // Counter of traces that are actually going to be displayed
             int counterTraceSteps = mySelectParam.traceStep; // Make sure that first trace is read in
-            if( hasRandomFileAccess() ) myReader.moveToTrace( traceIndex1, Math.max(mySelectParam.numTraces/10,10) );
-            while( counterDisplayedTraces < mySelectParam.numTraces && myReader.getNextTrace( trace ) && !myStopReadDataThread ) {
-              if( counterDisplayedTraces % REFRESH_FREQUENCY == 0 ) myListener.updateTrace( counterDisplayedTraces, traceIndex1 );
-              traceIndex1 += 1;
-              if( counterTraceSteps < mySelectParam.traceStep ) {
-                counterTraceSteps += 1;
-                continue;
+            if( myReader instanceof csNativeSeismicReader ) {
+              // Read blocks of (decimated) traces, with one native call per block
+              csNativeSeismicReader nativeReader = (csNativeSeismicReader)myReader;
+              while( counterDisplayedTraces < mySelectParam.numTraces && !myStopReadDataThread ) {
+                myListener.updateTrace( counterDisplayedTraces, traceIndex1 );
+                int numTracesBlock = Math.min( NUM_TRACES_BULK_READ, mySelectParam.numTraces - counterDisplayedTraces );
+                csSeismicTrace[] traces = new csSeismicTrace[numTracesBlock];
+                for( int itrc = 0; itrc < numTracesBlock; itrc++ ) {
+                  traces[itrc] = new csSeismicTrace( numSamples, numHeaders );
+                }
+                int numTracesRead = nativeReader.getTraces( traceIndex1, mySelectParam.traceStep, traces );
+                for( int itrc = 0; itrc < numTracesRead; itrc++ ) {
+                  traces[itrc].setOriginalTraceNumber( traceIndex1 + 1 );
+                  newTraceBuffer.addTrace( traces[itrc] );
+                  traceIndex1 += mySelectParam.traceStep;
+                }
+                counterDisplayedTraces += numTracesRead;
+                if( numTracesRead < numTracesBlock ) break;
+              }
+            }
+            else {
+              if( hasRandomFileAccess() ) myReader.moveToTrace( traceIndex1, Math.max(mySelectParam.numTraces/10,10) );
+              while( counterDisplayedTraces < mySelectParam.numTraces && myReader.getNextTrace( trace ) && !myStopReadDataThread ) {
+                if( counterDisplayedTraces % REFRESH_FREQUENCY == 0 ) myListener.updateTrace( counterDisplayedTraces, traceIndex1 );
+                traceIndex1 += 1;
+                if( counterTraceSteps < mySelectParam.traceStep ) {
+                  counterTraceSteps += 1;
+                  continue;
+                }
+                trace.setOriginalTraceNumber( traceIndex1 );  // traceIndex1 has just been incremented by 1, making it the trace "number"
+                newTraceBuffer.addTrace( trace );
+                trace = new csSeismicTrace( numSamples, numHeaders );
+                counterDisplayedTraces += 1;
+                counterTraceSteps = 1;
               }
-              trace.setOriginalTraceNumber( traceIndex1 );  // traceIndex1 has just been incremented by 1, making it the trace "number"
-              newTraceBuffer.addTrace( trace );
-              trace = new csSeismicTrace( numSamples, numHeaders );
-              counterDisplayedTraces += 1;
-              counterTraceSteps = 1;
             }
           } //
           //==============================================================================================
@@ -1099,15 +1124,27 @@ public class csSeisPaneBundle extends JPanel implements csIGraphPanelListener,
                 int numTracesToRead = Math.min( numTracesToBuffer, traceIndex1 + 1 );
                 traceIndex1 -= (numTracesToRead-1);
                 csSeismicTrace[] tempTraces = new csSeismicTrace[numTracesToRead];
-                myReader.moveToTrace( traceIndex1, numTracesToRead );
-                for( int itrc = 0; itrc < numTracesToRead; itrc++ ) {
-                  if( !myReader.getNextTrace( trace ) ) {
-                    numTracesToRead = itrc;
-                    break;
+                if( myReader instanceof csNativeSeismicReader ) {
+                  // Read block with one native call
+                  for( int itrc = 0; itrc < numTracesToRead; itrc++ ) {
+                    tempTraces[itrc] = new csSeismicTrace( numSamples, numHeaders );
+                  }
+                  numTracesToRead = ((csNativeSeismicReader)myReader).getTraces( traceIndex1, 1, tempTraces );
+                  for( int itrc = 0; itrc < numTracesToRead; itrc++ ) {
+                    tempTraces[itrc].setOriginalTraceNumber( traceIndex1+itrc+1 );
+                  }
+                }
+                else {
+                  myReader.moveToTrace( traceIndex1, numTracesToRead );
+                  for( int itrc = 0; itrc < numTracesToRead; itrc++ ) {
+                    if( !myReader.getNextTrace( trace ) ) {
+                      numTracesToRead = itrc;
+                      break;
+                    }
+                    trace.setOriginalTraceNumber( traceIndex1+itrc+1 );
+                    tempTraces[itrc] = trace;
+                    trace = new csSeismicTrace( numSamples, numHeaders );
                   }
-                  trace.setOriginalTraceNumber( traceIndex1+itrc+1 );
-                  tempTraces[itrc] = trace;
-                  trace = new csSeismicTrace( numSamples, numHeaders );
                 }
                 // Step (2): Check ensemble header value. Save to trace buffer. Stop when all ensembles have been read
                 for( int itrc = numTracesToRead-1; itrc >= 0; itrc-- ) {
@@ -1167,26 +1204,60 @@ public class csSeisPaneBundle extends JPanel implements csIGraphPanelListener,
               }
               int counterReadTraces = 0;
               int counterDisplayedEns = 0;
-              myReader.moveToTrace( traceIndex1, numTracesToBuffer );
               myReader.setHeaderToPeek( mySelectParam.selectedHdrName );
               csHeader peekValue = new csHeader();
               myReader.peekHeaderValue( traceIndex1, peekValue );
               myListener.updateTrace( 0, traceIndex1 );
-              while( counterDisplayedEns < mySelectParam.numEns && myReader.getNextTrace( trace ) && !myStopReadDataThread ) {
-                if( counterReadTraces % REFRESH_FREQUENCY == 0 ) myListener.updateTrace( counterDisplayedEns, traceIndex1+counterReadTraces );
-                csHeader ensValue = trace.headerValues()[myCurrentSelectedHdrIndex];
-                counterReadTraces += 1;
-                if( !ensValue.equals(peekValue) ) {
-                  peekValue = ensValue;
-                  counterDisplayedEns += 1;
-                  if( counterDisplayedEns == mySelectParam.numEns ) {
-                    break;
+              if( myReader instanceof csNativeSeismicReader ) {
+                // Read blocks of consecutive traces, with one native call per block
+                csNativeSeismicReader nativeReader = (csNativeSeismicReader)myReader;
+                csSeismicTrace[] traces = null;
+                int numTracesBlock = 0;
+                int itrcBlock = 0;
+                while( counterDisplayedEns < mySelectParam.numEns && !myStopReadDataThread ) {
+                  if( itrcBlock == numTracesBlock ) {
+                    traces = new csSeismicTrace[NUM_TRACES_BULK_READ];
+                    for( int itrc = 0; itrc < NUM_TRACES_BULK_READ; itrc++ ) {
+                      traces[itrc] = new csSeismicTrace( numSamples, numHeaders );
+                    }
+                    numTracesBlock = nativeReader.getTraces( traceIndex1+counterReadTraces, 1, traces );
+                    itrcBlock = 0;
+                    if( numTracesBlock == 0 ) break;
                   }
-                  continue;
+                  csSeismicTrace blockTrace = traces[itrcBlock++];
+                  if( counterReadTraces % REFRESH_FREQUENCY == 0 ) myListener.updateTrace( counterDisplayedEns, traceIndex1+counterReadTraces );
+                  csHeader ensValue = blockTrace.headerValues()[myCurrentSelectedHdrIndex];
+                  counterReadTraces += 1;
+                  if( !ensValue.equals(peekValue) ) {
+                    peekValue = ensValue;
+                    counterDisplayedEns += 1;
+                    if( counterDisplayedEns == mySelectParam.numEns ) {
+                      break;
+                    }
+                    continue;
+                  }
+                  blockTrace.setOriginalTraceNumber( traceIndex1+counterReadTraces );
+                  newTraceBuffer.addTrace( blockTrace );
+                }
+              }
+              else {
+                myReader.moveToTrace( traceIndex1, numTracesToBuffer );
+                while( counterDisplayedEns < mySelectParam.numEns && myReader.getNextTrace( trace ) && !myStopReadDataThread ) {
+                  if( counterReadTraces % REFRESH_FREQUENCY == 0 ) myListener.updateTrace( counterDisplayedEns, traceIndex1+counterReadTraces );
+                  csHeader ensValue = trace.headerValues()[myCurrentSelectedHdrIndex];
+                  counterReadTraces += 1;
+                  if( !ensValue.equals(peekValue) ) {
+                    peekValue = ensValue;
+                    counterDisplayedEns += 1;
+                    if( counterDisplayedEns == mySelectParam.numEns ) {
+                      break;
+                    }
+                    continue;
+                  }
+                  trace.setOriginalTraceNumber( traceIndex1+counterReadTraces );
+                  newTraceBuffer.addTrace( trace );
+                  trace = new csSeismicTrace( numSamples, numHeaders );
                 }
-                trace.setOriginalTraceNumber( traceIndex1+counterReadTraces );
-                newTraceBuffer.addTrace( trace );
-                trace = new csSeismicTrace( numSamples, numHeaders );
               }
 //              myCurrentTraceIndex += counterReadTraces - 1;
             } // END if moveoption = begin, forward or selection
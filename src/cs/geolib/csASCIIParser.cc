@@ -0,0 +1,480 @@
+/* Copyright (c) Colorado School of Mines, 2013.*/
+/* All rights reserved.                       */
+
+#include "csASCIIParser.h"
+#include "csThreadPool.h"
+#include "csException.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#ifndef PLATFORM_WINDOWS
+extern "C" {
+  #include <fcntl.h>
+  #include <unistd.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+}
+#endif
+
+using namespace cseis_geolib;
+
+namespace {
+  /// Minimum number of bytes indexed by one thread
+  csInt64_t const MIN_CHUNK_NUM_BYTES = 4*1024*1024;
+  /// Minimum number of lines parsed by one thread
+  int const MIN_CHUNK_NUM_LINES = 16384;
+  /// Maximum number of significant digits converted directly
+  int const MAX_NUM_DIGITS_DIRECT = 19;
+  /// 2^53: Integers up to this value are exactly representable as double
+  unsigned long long const MAX_MANTISSA_DIRECT = 9007199254740992ULL;
+  /// Powers of 10 that are exactly representable as double
+  double const POWERS_OF_TEN[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+  };
+  int const MAX_POWER_OF_TEN = 22;
+
+  inline bool isSeparator( char c ) {
+    return( c == ' ' || c == '\t' || c == ',' || c == ';' );
+  }
+  /**
+   * Find next token, see tokenize() in geolib_string_utils
+   * @return false if there are no more tokens in line
+   */
+  inline bool nextToken( char const*& ptr, char const* end, char const** tokenStart, int* tokenLength ) {
+    while( ptr < end && isSeparator(*ptr) ) ptr++;
+    if( ptr >= end ) return false;
+    if( *ptr == '"' ) {
+      ptr++;
+      char const* start = ptr;
+      while( ptr < end && ( *ptr != '"' || *(ptr-1) == '\\' ) ) ptr++;
+      *tokenStart  = start;
+      *tokenLength = (int)( ptr - start );
+      ptr++;
+      return true;
+    }
+    if( *ptr == '#' ) return false;  // Remaining text are comments
+    char const* start = ptr;
+    while( ptr < end && *ptr != ' ' && *ptr != '\t' ) ptr++;
+    *tokenStart  = start;
+    *tokenLength = (int)( ptr - start );
+    return true;
+  }
+}
+
+namespace cseis_geolib {
+/**
+ * Parser task: Index line start positions of one byte range, or parse one range of lines
+ */
+class csASCIIParserTask : public csRunnable {
+public:
+  csASCIIParserTask( csASCIIParser* parser ) : myParser( parser ) {
+    myStart = 0;
+    myEnd   = 0;
+    myIsIndexTask = true;
+    myLineStart   = NULL;
+    myNumLines    = 0;
+    myNumLinesAlloc = 0;
+  }
+  ~csASCIIParserTask() {
+    if( myLineStart != NULL ) delete [] myLineStart;
+  }
+  virtual void run() {
+    if( myIsIndexTask ) {
+      myParser->indexChunk( myStart, myEnd, this );
+    }
+    else {
+      myParser->parseLines( (int)myStart, (int)myEnd );
+    }
+  }
+  void addLine( csInt64_t lineStart ) {
+    if( myNumLines == myNumLinesAlloc ) {
+      int numLinesAlloc = myNumLinesAlloc > 0 ? 2*myNumLinesAlloc : 4096;
+      csInt64_t* lineStartNew = new csInt64_t[numLinesAlloc];
+      if( myNumLines > 0 ) memcpy( lineStartNew, myLineStart, myNumLines*sizeof(csInt64_t) );
+      if( myLineStart != NULL ) delete [] myLineStart;
+      myLineStart = lineStartNew;
+      myNumLinesAlloc = numLinesAlloc;
+    }
+    myLineStart[myNumLines++] = lineStart;
+  }
+  csASCIIParser* myParser;
+  /// Byte range (index task) or line range (parse task), end exclusive
+  csInt64_t myStart;
+  csInt64_t myEnd;
+  bool myIsIndexTask;
+  csInt64_t* myLineStart;
+  int myNumLines;
+  int myNumLinesAlloc;
+};
+}
+
+//--------------------------------------------------------------------
+csASCIIParser::csASCIIParser( std::string const& filename, int numThreads ) {
+  myFilename   = filename;
+  myData       = NULL;
+  myFileSize   = 0;
+  myBuffer     = NULL;
+  myLineStart  = NULL;
+  myNumLines   = 0;
+  myColumns    = NULL;
+  myNumColumns = 0;
+  myMaxColumn  = -1;
+  myColumnFirst = NULL;
+  myColumnNext  = NULL;
+  myBlockFirstLine = 0;
+  myBlockNumLines  = 0;
+  myNumLinesAlloc  = 0;
+  myNumTokens  = NULL;
+  myValues     = NULL;
+  myNumThreads = numThreads > 0 ? numThreads : csThreadPool::numProcessors();
+  myThreadPool = NULL;
+  myTasks      = NULL;
+  myNumTasks   = 0;
+
+#ifdef PLATFORM_WINDOWS
+  FILE* file = fopen( filename.c_str(), "rb" );
+  if( file == NULL ) {
+    throw( csException("Could not open file '%s'", filename.c_str()) );
+  }
+  _fseeki64( file, 0, SEEK_END );
+  myFileSize = _ftelli64( file );
+  _fseeki64( file, 0, SEEK_SET );
+  myBuffer = new char[myFileSize > 0 ? myFileSize : 1];
+  if( myFileSize > 0 && fread( myBuffer, 1, (size_t)myFileSize, file ) != (size_t)myFileSize ) {
+    fclose( file );
+    delete [] myBuffer;
+    myBuffer = NULL;
+    throw( csException("Error occurred when reading file '%s'", filename.c_str()) );
+  }
+  fclose( file );
+  myData = myBuffer;
+#else
+  int fd = open( filename.c_str(), O_RDONLY );
+  if( fd < 0 ) {
+    throw( csException("Could not open file '%s'", filename.c_str()) );
+  }
+  struct stat fileStat;
+  if( fstat( fd, &fileStat ) != 0 ) {
+    close( fd );
+    throw( csException("Could not retrieve size of file '%s'", filename.c_str()) );
+  }
+  myFileSize = (csInt64_t)fileStat.st_size;
+  if( myFileSize > 0 ) {
+    void* ptr = mmap( NULL, (size_t)myFileSize, PROT_READ, MAP_PRIVATE, fd, 0 );
+    if( ptr == MAP_FAILED ) {
+      close( fd );
+      throw( csException("Could not memory map file '%s'", filename.c_str()) );
+    }
+    madvise( ptr, (size_t)myFileSize, MADV_SEQUENTIAL );
+    myData = (char const*)ptr;
+  }
+  close( fd );
+#endif
+}
+//--------------------------------------------------------------------
+csASCIIParser::~csASCIIParser() {
+#ifndef PLATFORM_WINDOWS
+  if( myData != NULL ) {
+    munmap( (void*)myData, (size_t)myFileSize );
+    myData = NULL;
+  }
+#endif
+  if( myBuffer != NULL ) {
+    delete [] myBuffer;
+    myBuffer = NULL;
+  }
+  if( myTasks != NULL ) {
+    for( int i = 0; i < myNumThreads; i++ ) {
+      delete myTasks[i];
+    }
+    delete [] myTasks;
+    myTasks = NULL;
+  }
+  if( myThreadPool != NULL ) {
+    delete myThreadPool;
+    myThreadPool = NULL;
+  }
+  if( myLineStart != NULL ) {
+    delete [] myLineStart;
+    myLineStart = NULL;
+  }
+  if( myColumns != NULL ) {
+    delete [] myColumns;
+    delete [] myColumnNext;
+    delete [] myColumnFirst;
+    myColumns = NULL;
+  }
+  if( myNumTokens != NULL ) {
+    delete [] myNumTokens;
+    myNumTokens = NULL;
+  }
+  if( myValues != NULL ) {
+    delete [] myValues;
+    myValues = NULL;
+  }
+}
+//--------------------------------------------------------------------
+int csASCIIParser::lineLength( int iline ) const {
+  csInt64_t lineEnd = ( iline+1 < myNumLines ) ? myLineStart[iline+1]-1 : myFileSize;
+  csInt64_t lineStart = myLineStart[iline];
+  while( lineEnd > lineStart && ( myData[lineEnd-1] == '\r' || myData[lineEnd-1] == '\n' ) ) lineEnd--;
+  return (int)( lineEnd - lineStart );
+}
+//--------------------------------------------------------------------
+void csASCIIParser::allocateTasks() {
+  if( myTasks != NULL ) return;
+  myTasks = new csASCIIParserTask*[myNumThreads];
+  for( int i = 0; i < myNumThreads; i++ ) {
+    myTasks[i] = new csASCIIParserTask( this );
+  }
+}
+//--------------------------------------------------------------------
+void csASCIIParser::runTasks() {
+  if( myNumTasks == 1 ) {
+    myTasks[0]->run();
+    return;
+  }
+  if( myThreadPool == NULL ) {
+    myThreadPool = new csThreadPool( myNumThreads );
+  }
+  for( int i = 0; i < myNumTasks; i++ ) {
+    myThreadPool->submit( myTasks[i] );
+  }
+  myThreadPool->waitAll();
+  for( int i = 0; i < myNumTasks; i++ ) {
+    if( myTasks[i]->hasError() ) {
+      throw( csException("Error occurred when parsing file '%s': %s", myFilename.c_str(), myTasks[i]->errorMessage()) );
+    }
+  }
+}
+//--------------------------------------------------------------------
+void csASCIIParser::indexLines() {
+  if( myLineStart != NULL ) {
+    delete [] myLineStart;
+    myLineStart = NULL;
+  }
+  myNumLines = 0;
+  if( myFileSize == 0 ) return;
+
+  csInt64_t numChunks = ( myFileSize + MIN_CHUNK_NUM_BYTES - 1 ) / MIN_CHUNK_NUM_BYTES;
+  int numTasks = numChunks < myNumThreads ? (int)numChunks : myNumThreads;
+  allocateTasks();
+  myNumTasks = numTasks;
+  csInt64_t chunkSize = ( myFileSize + numTasks - 1 ) / numTasks;
+  for( int i = 0; i < myNumTasks; i++ ) {
+    myTasks[i]->myIsIndexTask = true;
+    myTasks[i]->myStart = (csInt64_t)i * chunkSize;
+    myTasks[i]->myEnd   = ( i < myNumTasks-1 ) ? (csInt64_t)(i+1) * chunkSize : myFileSize;
+    myTasks[i]->myNumLines = 0;
+  }
+  runTasks();
+
+  csInt64_t numLines = 0;
+  for( int i = 0; i < myNumTasks; i++ ) {
+    numLines += myTasks[i]->myNumLines;
+  }
+  if( numLines > 2147483647LL ) {
+    throw( csException("File '%s' contains too many lines (%lld)", myFilename.c_str(), (long long)numLines) );
+  }
+  myNumLines  = (int)numLines;
+  myLineStart = new csInt64_t[myNumLines > 0 ? myNumLines : 1];
+  int lineIndex = 0;
+  for( int i = 0; i < myNumTasks; i++ ) {
+    csASCIIParserTask* task = myTasks[i];
+    if( task->myNumLines > 0 ) {
+      memcpy( &myLineStart[lineIndex], task->myLineStart, task->myNumLines*sizeof(csInt64_t) );
+      lineIndex += task->myNumLines;
+    }
+    // Release index memory, tasks are reused for parsing
+    delete [] task->myLineStart;
+    task->myLineStart = NULL;
+    task->myNumLines  = 0;
+    task->myNumLinesAlloc = 0;
+  }
+}
+//--------------------------------------------------------------------
+// A line starts at the first byte of the file, or after a newline character. Each line start is recorded by the chunk
+// containing the preceding newline character, so that chunk boundaries can be arbitrary.
+//
+void csASCIIParser::indexChunk( csInt64_t byteStart, csInt64_t byteEnd, csASCIIParserTask* task ) {
+  if( byteStart == 0 ) task->addLine( 0 );
+  char const* ptr = myData + byteStart;
+  char const* end = myData + byteEnd;
+  while( ptr < end ) {
+    char const* newline = (char const*)memchr( ptr, '\n', (size_t)(end - ptr) );
+    if( newline == NULL ) break;
+    csInt64_t lineStart = (csInt64_t)( newline - myData ) + 1;
+    if( lineStart < myFileSize ) task->addLine( lineStart );
+    ptr = newline + 1;
+  }
+}
+//--------------------------------------------------------------------
+void csASCIIParser::setColumns( int const* columns, int numColumns ) {
+  if( myColumns != NULL ) {
+    delete [] myColumns;
+    delete [] myColumnNext;
+    delete [] myColumnFirst;
+  }
+  myNumColumns = numColumns;
+  myMaxColumn  = -1;
+  myColumns    = new int[myNumColumns > 0 ? myNumColumns : 1];
+  myColumnNext = new int[myNumColumns > 0 ? myNumColumns : 1];
+  for( int icol = 0; icol < myNumColumns; icol++ ) {
+    myColumns[icol] = columns[icol];
+    if( columns[icol] > myMaxColumn ) myMaxColumn = columns[icol];
+  }
+  myColumnFirst = new int[myMaxColumn+2];
+  for( int itoken = 0; itoken <= myMaxColumn; itoken++ ) {
+    myColumnFirst[itoken] = -1;
+  }
+  // Same column may be requested more than once: Chain requested columns for each token index
+  for( int icol = myNumColumns-1; icol >= 0; icol-- ) {
+    if( myColumns[icol] < 0 ) continue;
+    myColumnNext[icol] = myColumnFirst[myColumns[icol]];
+    myColumnFirst[myColumns[icol]] = icol;
+  }
+  if( myNumTokens != NULL ) {
+    delete [] myNumTokens;
+    delete [] myValues;
+    myNumTokens = NULL;
+    myValues    = NULL;
+    myNumLinesAlloc = 0;
+  }
+}
+//--------------------------------------------------------------------
+void csASCIIParser::parseColumns( int firstLine, int numLines ) {
+  if( firstLine < 0 || numLines < 0 || firstLine + numLines > myNumLines ) {
+    throw( csException("csASCIIParser::parseColumns: Line range %d-%d out of range (number of lines: %d)",
+                       firstLine, firstLine+numLines-1, myNumLines) );
+  }
+  if( numLines > myNumLinesAlloc ) {
+    if( myNumTokens != NULL ) {
+      delete [] myNumTokens;
+      delete [] myValues;
+    }
+    myNumLinesAlloc = numLines;
+    myNumTokens = new int[myNumLinesAlloc];
+    myValues    = new double[(size_t)myNumLinesAlloc*(myNumColumns > 0 ? myNumColumns : 1)];
+  }
+  myBlockFirstLine = firstLine;
+  myBlockNumLines  = numLines;
+  if( numLines == 0 ) return;
+
+  int numChunks = ( numLines + MIN_CHUNK_NUM_LINES - 1 ) / MIN_CHUNK_NUM_LINES;
+  int numTasks  = numChunks < myNumThreads ? numChunks : myNumThreads;
+  allocateTasks();
+  myNumTasks = numTasks;
+  int chunkSize = ( numLines + numTasks - 1 ) / numTasks;
+  for( int i = 0; i < myNumTasks; i++ ) {
+    myTasks[i]->myIsIndexTask = false;
+    myTasks[i]->myStart = firstLine + i * chunkSize;
+    myTasks[i]->myEnd   = ( i < myNumTasks-1 ) ? firstLine + (i+1) * chunkSize : firstLine + numLines;
+  }
+  runTasks();
+}
+//--------------------------------------------------------------------
+void csASCIIParser::parseLines( int firstLine, int lastLine ) {
+  for( int iline = firstLine; iline < lastLine; iline++ ) {
+    double* values = &myValues[(size_t)(iline-myBlockFirstLine)*myNumColumns];
+    for( int icol = 0; icol < myNumColumns; icol++ ) {
+      values[icol] = 0.0;
+    }
+    char const* ptr = line( iline );
+    char const* end = ptr + lineLength( iline );
+    char const* tokenStart;
+    int tokenLength;
+    int numTokens = 0;
+    while( nextToken( ptr, end, &tokenStart, &tokenLength ) ) {
+      if( numTokens <= myMaxColumn ) {
+        for( int icol = myColumnFirst[numTokens]; icol >= 0; icol = myColumnNext[icol] ) {
+          values[icol] = parseDouble( tokenStart, tokenLength );
+        }
+      }
+      numTokens += 1;
+    }
+    myNumTokens[iline-myBlockFirstLine] = numTokens;
+  }
+}
+//--------------------------------------------------------------------
+bool csASCIIParser::token( char const* line, int length, int column, char const** tokenStart, int* tokenLength ) {
+  char const* ptr = line;
+  char const* end = line + length;
+  for( int itoken = 0; itoken <= column; itoken++ ) {
+    if( !nextToken( ptr, end, tokenStart, tokenLength ) ) return false;
+  }
+  return true;
+}
+//--------------------------------------------------------------------
+// Plain decimal numbers: Mantissa and power of ten are both exact as double, so that one multiplication or division
+// gives the correctly rounded result, identical to strtod(). Everything else is passed to strtod().
+//
+double csASCIIParser::parseDouble( char const* text, int length ) {
+  char const* ptr = text;
+  char const* end = text + length;
+  bool isNegative = false;
+  if( ptr < end && ( *ptr == '-' || *ptr == '+' ) ) {
+    isNegative = ( *ptr == '-' );
+    ptr++;
+  }
+  unsigned long long mantissa = 0;
+  int numDigits = 0;
+  int numSignificantDigits = 0;
+  int exponent = 0;
+  while( ptr < end && *ptr >= '0' && *ptr <= '9' ) {
+    if( numSignificantDigits > 0 || *ptr != '0' ) numSignificantDigits++;
+    mantissa = 10*mantissa + (unsigned long long)( *ptr - '0' );
+    numDigits++;
+    ptr++;
+  }
+  if( ptr < end && *ptr == '.' ) {
+    ptr++;
+    while( ptr < end && *ptr >= '0' && *ptr <= '9' ) {
+      if( numSignificantDigits > 0 || *ptr != '0' ) numSignificantDigits++;
+      mantissa = 10*mantissa + (unsigned long long)( *ptr - '0' );
+      numDigits++;
+      exponent--;
+      ptr++;
+    }
+  }
+  bool isDirect = ( numDigits > 0 && numSignificantDigits <= MAX_NUM_DIGITS_DIRECT );
+  if( isDirect && ptr < end && ( *ptr == 'e' || *ptr == 'E' ) ) {
+    ptr++;
+    bool isNegativeExponent = false;
+    if( ptr < end && ( *ptr == '-' || *ptr == '+' ) ) {
+      isNegativeExponent = ( *ptr == '-' );
+      ptr++;
+    }
+    int exponentValue = 0;
+    int numExponentDigits = 0;
+    while( ptr < end && *ptr >= '0' && *ptr <= '9' && numExponentDigits < 5 ) {
+      exponentValue = 10*exponentValue + ( *ptr - '0' );
+      numExponentDigits++;
+      ptr++;
+    }
+    if( numExponentDigits == 0 ) isDirect = false;
+    exponent += isNegativeExponent ? -exponentValue : exponentValue;
+  }
+  if( isDirect && ptr == end && mantissa <= MAX_MANTISSA_DIRECT ) {
+    if( mantissa == 0 ) {
+      return( isNegative ? -0.0 : 0.0 );
+    }
+    if( exponent >= -MAX_POWER_OF_TEN && exponent <= MAX_POWER_OF_TEN ) {
+      double value = (double)mantissa;
+      if( exponent >= 0 ) value *= POWERS_OF_TEN[exponent];
+      else value /= POWERS_OF_TEN[-exponent];
+      return( isNegative ? -value : value );
+    }
+  }
+  // Fall back to strtod(): Text needs to be null terminated
+  char buffer[64];
+  if( length < (int)sizeof(buffer) ) {
+    memcpy( buffer, text, length );
+    buffer[length] = '\0';
+    return strtod( buffer, NULL );
+  }
+  std::string str( text, length );
+  return strtod( str.c_str(), NULL );
+}
@@ -0,0 +1,138 @@
+/* Copyright (c) Colorado School of Mines, 2013.*/
+/* All rights reserved.                       */
+
+#ifndef CS_ASCII_PARSER_H
+#define CS_ASCII_PARSER_H
+
+#include <string>
+#include "geolib_defines.h"
+
+namespace cseis_geolib {
+
+class csThreadPool;
+class csASCIIParserTask;
+
+/**
+ * Parser for large ASCII table files
+ *
+ * The input file is memory mapped (read into memory on Windows). Lines are never copied: Line start positions are
+ * indexed once, and columns are then parsed directly from the mapped file.
+ * Both steps split the work into chunks which are processed in parallel: Line indexing splits the file into byte ranges,
+ * column parsing splits a block of lines into line ranges.
+ *
+ * Lines are split into columns ('tokens') in the same way as done by tokenize() in geolib_string_utils:
+ *  - Tokens are separated by white spaces or tabs. Leading commas and semicolons are skipped
+ *  - Tokens in double quotes may contain white spaces
+ *  - A token starting with '#' starts a comment: The remainder of the line is ignored
+ * Numbers are converted with the same result as atof(): Plain decimal numbers with up to 19 significant digits and a
+ * small exponent are converted directly (exact, correctly rounded), all other tokens are passed to strtod().
+ *
+ * Usage: indexLines(), setColumns(), then parseColumns() for consecutive blocks of lines.
+ *
+ * @author Bjorn Olofsson
+ * @date 2013
+ */
+class csASCIIParser {
+public:
+  /**
+   * @param filename    Input file name
+   * @param numThreads  Number of threads. Pass 0 to use the number of online processors
+   * @throws csException if file cannot be opened
+   */
+  csASCIIParser( std::string const& filename, int numThreads );
+  ~csASCIIParser();
+  /**
+   * Index start positions of all lines
+   */
+  void indexLines();
+  int numLines() const { return myNumLines; }
+  /// @return Pointer to first character of line. Line is not terminated by a null character
+  inline char const* line( int iline ) const {
+    return myData + myLineStart[iline];
+  }
+  /// @return Number of characters in line, excluding newline and carriage return
+  int lineLength( int iline ) const;
+
+  /**
+   * Set columns to parse
+   * @param columns     Column indexes (0 for first column)
+   * @param numColumns  Number of columns
+   */
+  void setColumns( int const* columns, int numColumns );
+  /**
+   * Parse specified columns of a block of lines. Results are valid until the next call to this method.
+   * @param firstLine  Index of first line in block
+   * @param numLines   Number of lines in block
+   */
+  void parseColumns( int firstLine, int numLines );
+  /// @return Number of columns in line (0 for blank and comment lines). Line must be in current block
+  inline int numTokens( int iline ) const {
+    return myNumTokens[iline-myBlockFirstLine];
+  }
+  /// @return Value in specified column. 0 if line has too few columns. Line must be in current block
+  inline double value( int iline, int icol ) const {
+    return myValues[(size_t)(iline-myBlockFirstLine)*myNumColumns + icol];
+  }
+
+  /**
+   * Find token in line
+   * @param line         Line
+   * @param length       Number of characters in line
+   * @param column       Column index of token
+   * @param tokenStart   (o) Pointer to first character of token
+   * @param tokenLength  (o) Number of characters in token
+   * @return false if line has too few columns
+   */
+  static bool token( char const* line, int length, int column, char const** tokenStart, int* tokenLength );
+  /**
+   * Convert text to double. Same result as atof()
+   * @param text    Text, does not need to be null terminated
+   * @param length  Number of characters
+   */
+  static double parseDouble( char const* text, int length );
+
+private:
+  friend class csASCIIParserTask;
+  void indexChunk( csInt64_t byteStart, csInt64_t byteEnd, csASCIIParserTask* task );
+  void parseLines( int firstLine, int lastLine );
+  /// Allocate one task per thread. Tasks are reused for line indexing and parsing
+  void allocateTasks();
+  /// Run the first myNumTasks tasks, in the calling thread if there is only one
+  void runTasks();
+
+  std::string myFilename;
+  char const* myData;
+  csInt64_t myFileSize;
+  /// Only used if file cannot be memory mapped
+  char* myBuffer;
+
+  csInt64_t* myLineStart;
+  int myNumLines;
+
+  int* myColumns;
+  int myNumColumns;
+  int myMaxColumn;
+  /// For each token index up to myMaxColumn: First entry in myColumnNext chain of requested columns, or -1
+  int* myColumnFirst;
+  int* myColumnNext;
+
+  int myBlockFirstLine;
+  int myBlockNumLines;
+  int myNumLinesAlloc;
+  int* myNumTokens;
+  double* myValues;
+
+  int myNumThreads;
+  csThreadPool* myThreadPool;
+  csASCIIParserTask** myTasks;
+  /// Number of tasks used in current step, at most myNumThreads
+  int myNumTasks;
+
+  csASCIIParser();
+  csASCIIParser( csASCIIParser const& obj );
+  csASCIIParser& operator=( csASCIIParser const& obj );
+};
+
+} // namespace
+
+#endif
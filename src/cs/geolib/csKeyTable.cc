@@ -0,0 +1,215 @@
+/* Copyright (c) Colorado School of Mines, 2013.*/
+/* All rights reserved.                       */
+
+#include "csKeyTable.h"
+#include "csException.h"
+#include <cstdio>
+#include <cstring>
+
+using namespace cseis_geolib;
+
+namespace {
+  char const CACHE_MAGIC[8] = { 'C','S','K','E','Y','T','B','1' };
+  /// Endianness check value
+  int const CACHE_ORDER = 0x01020304;
+}
+
+csKeyTable::csKeyTable( int numKeys, int numValues ) {
+  myNumKeys   = numKeys;
+  myNumValues = numValues;
+  myNumRecords      = 0;
+  myNumRecordsAlloc = 0;
+  myKeys   = NULL;
+  myValues = NULL;
+  mySlots    = NULL;
+  myNumSlots = 0;
+  myIsIndexed = false;
+  myNumDuplicates = 0;
+}
+csKeyTable::~csKeyTable() {
+  if( myKeys != NULL ) {
+    delete [] myKeys;
+    myKeys = NULL;
+  }
+  if( myValues != NULL ) {
+    delete [] myValues;
+    myValues = NULL;
+  }
+  if( mySlots != NULL ) {
+    delete [] mySlots;
+    mySlots = NULL;
+  }
+}
+//--------------------------------------------------------------------
+void csKeyTable::clear() {
+  myNumRecords = 0;
+  myIsIndexed  = false;
+  myNumDuplicates = 0;
+}
+//--------------------------------------------------------------------
+int csKeyTable::addRecord( double const* keys, double const* values ) {
+  if( myNumRecords == myNumRecordsAlloc ) {
+    int numRecordsAlloc = myNumRecordsAlloc > 0 ? 2*myNumRecordsAlloc : 1024;
+    double* keysNew   = new double[(size_t)numRecordsAlloc*myNumKeys];
+    double* valuesNew = new double[(size_t)numRecordsAlloc*myNumValues];
+    if( myNumRecords > 0 ) {
+      memcpy( keysNew, myKeys, (size_t)myNumRecords*myNumKeys*sizeof(double) );
+      memcpy( valuesNew, myValues, (size_t)myNumRecords*myNumValues*sizeof(double) );
+    }
+    if( myKeys != NULL ) delete [] myKeys;
+    if( myValues != NULL ) delete [] myValues;
+    myKeys   = keysNew;
+    myValues = valuesNew;
+    myNumRecordsAlloc = numRecordsAlloc;
+  }
+  memcpy( &myKeys[(size_t)myNumRecords*myNumKeys], keys, myNumKeys*sizeof(double) );
+  if( myNumValues > 0 ) {
+    memcpy( &myValues[(size_t)myNumRecords*myNumValues], values, myNumValues*sizeof(double) );
+  }
+  myIsIndexed = false;
+  return myNumRecords++;
+}
+//--------------------------------------------------------------------
+unsigned long long csKeyTable::hash( double const* keys, int numKeys ) {
+  unsigned long long h = 0;
+  for( int ikey = 0; ikey < numKeys; ikey++ ) {
+    double value = keys[ikey];
+    if( value == 0.0 ) value = 0.0;  // -0.0 equals 0.0: Same bit pattern required
+    unsigned long long bits;
+    memcpy( &bits, &value, sizeof(double) );
+    h = ( h ^ bits ) * 0x9E3779B97F4A7C15ULL;
+    h ^= ( h >> 29 );
+  }
+  h ^= ( h >> 32 );
+  return h;
+}
+//--------------------------------------------------------------------
+int csKeyTable::findSlot( double const* keys ) const {
+  int mask = myNumSlots - 1;
+  int slot = (int)( hash( keys, myNumKeys ) & (unsigned long long)mask );
+  while( mySlots[slot] >= 0 ) {
+    double const* keysRecord = &myKeys[(size_t)mySlots[slot]*myNumKeys];
+    int ikey = 0;
+    while( ikey < myNumKeys && keysRecord[ikey] == keys[ikey] ) {
+      ikey += 1;
+    }
+    if( ikey == myNumKeys ) return slot;
+    slot = ( slot + 1 ) & mask;
+  }
+  return slot;
+}
+//--------------------------------------------------------------------
+int csKeyTable::buildIndex() {
+  // Load factor <= 0.5
+  int numSlots = 1024;
+  while( numSlots < 2*myNumRecords ) {
+    numSlots *= 2;
+  }
+  if( numSlots != myNumSlots ) {
+    if( mySlots != NULL ) delete [] mySlots;
+    myNumSlots = numSlots;
+    mySlots = new int[myNumSlots];
+  }
+  for( int slot = 0; slot < myNumSlots; slot++ ) {
+    mySlots[slot] = -1;
+  }
+  myNumDuplicates = 0;
+  for( int irec = 0; irec < myNumRecords; irec++ ) {
+    double const* keys = &myKeys[(size_t)irec*myNumKeys];
+    bool isNaN = false;
+    for( int ikey = 0; ikey < myNumKeys; ikey++ ) {
+      if( keys[ikey] != keys[ikey] ) isNaN = true;
+    }
+    if( isNaN ) continue;
+    int slot = findSlot( keys );
+    if( mySlots[slot] >= 0 ) {
+      myNumDuplicates += 1;
+    }
+    else {
+      mySlots[slot] = irec;
+    }
+  }
+  myIsIndexed = true;
+  return myNumDuplicates;
+}
+//--------------------------------------------------------------------
+int csKeyTable::find( double const* keys ) {
+  if( !myIsIndexed ) buildIndex();
+  return mySlots[findSlot( keys )];
+}
+//--------------------------------------------------------------------
+bool csKeyTable::isDuplicate( int record ) {
+  int recordFound = find( &myKeys[(size_t)record*myNumKeys] );
+  return( recordFound >= 0 && recordFound != record );
+}
+//--------------------------------------------------------------------
+void csKeyTable::writeCache( std::string const& filename, std::string const& signature ) const {
+  FILE* file = fopen( filename.c_str(), "wb" );
+  if( file == NULL ) {
+    throw( csException("Cannot open cache file '%s' for writing", filename.c_str()) );
+  }
+  int sizeSignature = (int)signature.length();
+  bool success = true;
+  success = success && fwrite( CACHE_MAGIC, sizeof(char), 8, file ) == 8;
+  success = success && fwrite( &CACHE_ORDER, sizeof(int), 1, file ) == 1;
+  success = success && fwrite( &sizeSignature, sizeof(int), 1, file ) == 1;
+  success = success && (int)fwrite( signature.c_str(), sizeof(char), sizeSignature, file ) == sizeSignature;
+  success = success && fwrite( &myNumKeys, sizeof(int), 1, file ) == 1;
+  success = success && fwrite( &myNumValues, sizeof(int), 1, file ) == 1;
+  success = success && fwrite( &myNumRecords, sizeof(int), 1, file ) == 1;
+  if( myNumRecords > 0 ) {
+    size_t numKeyValues   = (size_t)myNumRecords*myNumKeys;
+    size_t numOtherValues = (size_t)myNumRecords*myNumValues;
+    success = success && fwrite( myKeys, sizeof(double), numKeyValues, file ) == numKeyValues;
+    success = success && fwrite( myValues, sizeof(double), numOtherValues, file ) == numOtherValues;
+  }
+  success = ( fclose( file ) == 0 ) && success;
+  if( !success ) {
+    remove( filename.c_str() );
+    throw( csException("Error occurred when writing cache file '%s'. Disk full?", filename.c_str()) );
+  }
+}
+//--------------------------------------------------------------------
+bool csKeyTable::readCache( std::string const& filename, std::string const& signature ) {
+  clear();
+  FILE* file = fopen( filename.c_str(), "rb" );
+  if( file == NULL ) return false;
+
+  char magic[8];
+  int order = 0;
+  int sizeSignature = -1;
+  bool success = true;
+  success = success && fread( magic, sizeof(char), 8, file ) == 8 && !memcmp( magic, CACHE_MAGIC, 8 );
+  success = success && fread( &order, sizeof(int), 1, file ) == 1 && order == CACHE_ORDER;
+  success = success && fread( &sizeSignature, sizeof(int), 1, file ) == 1 && sizeSignature == (int)signature.length();
+  if( success ) {
+    char* signatureCache = new char[sizeSignature+1];
+    success = (int)fread( signatureCache, sizeof(char), sizeSignature, file ) == sizeSignature;
+    success = success && !memcmp( signatureCache, signature.c_str(), sizeSignature );
+    delete [] signatureCache;
+  }
+  int numKeys   = -1;
+  int numValues = -1;
+  int numRecords = -1;
+  success = success && fread( &numKeys, sizeof(int), 1, file ) == 1 && numKeys == myNumKeys;
+  success = success && fread( &numValues, sizeof(int), 1, file ) == 1 && numValues == myNumValues;
+  success = success && fread( &numRecords, sizeof(int), 1, file ) == 1 && numRecords >= 0;
+  if( success && numRecords > myNumRecordsAlloc ) {
+    if( myKeys != NULL ) delete [] myKeys;
+    if( myValues != NULL ) delete [] myValues;
+    myNumRecordsAlloc = numRecords;
+    myKeys   = new double[(size_t)myNumRecordsAlloc*myNumKeys];
+    myValues = new double[(size_t)myNumRecordsAlloc*myNumValues];
+  }
+  if( success && numRecords > 0 ) {
+    size_t numKeyValues   = (size_t)numRecords*myNumKeys;
+    size_t numOtherValues = (size_t)numRecords*myNumValues;
+    success = fread( myKeys, sizeof(double), numKeyValues, file ) == numKeyValues;
+    success = success && fread( myValues, sizeof(double), numOtherValues, file ) == numOtherValues;
+  }
+  fclose( file );
+  if( !success ) return false;
+  myNumRecords = numRecords;
+  myIsIndexed  = false;
+  return true;
+}
@@ -0,0 +1,113 @@
+/* Copyright (c) Colorado School of Mines, 2013.*/
+/* All rights reserved.                       */
+
+#ifndef CS_KEY_TABLE_H
+#define CS_KEY_TABLE_H
+
+#include <string>
+#include "geolib_defines.h"
+
+namespace cseis_geolib {
+
+/**
+ * Table of records with composite key, indexed by a hash table
+ *
+ * Each record consists of a fixed number of key values and a fixed number of other values.
+ * Records are stored in input order. Records are found by their key values with one hash table lookup, independent
+ * of the order in which records were input or are requested.
+ * Key values are compared for equality as doubles, as done when comparing a trace header value to a value read
+ * in from an ASCII file. Integer key values are exactly representable.
+ * If two or more records have the same key, only the first one is found. Records with a NaN key value are never found.
+ *
+ * The whole table can be written to a binary cache file, together with a user defined signature string.
+ * Reading the cache file back in succeeds only if the signature matches, so that the caller can encode everything
+ * the table content depends upon (input file size, time stamp, parameters) in the signature.
+ *
+ * @author Bjorn Olofsson
+ * @date 2013
+ */
+class csKeyTable {
+public:
+  /**
+   * @param numKeys    Number of key values per record
+   * @param numValues  Number of other values per record
+   */
+  csKeyTable( int numKeys, int numValues );
+  ~csKeyTable();
+  /**
+   * Add record
+   * @param keys    Key values of record (numKeys values)
+   * @param values  Other values of record (numValues values). Pass NULL if numValues is zero
+   * @return Index of record
+   */
+  int addRecord( double const* keys, double const* values );
+  void clear();
+  /**
+   * Build hash index
+   * This method is called automatically by find() if records have been added since the index was last built.
+   * @return Number of records whose key is identical to the key of a previous record
+   */
+  int buildIndex();
+  /**
+   * Find record matching the given key values
+   * @param keys  Key values (numKeys values)
+   * @return Index of first record with these key values, or -1 if no record matches
+   */
+  int find( double const* keys );
+
+  inline double key( int record, int ikey ) const {
+    return myKeys[(size_t)record*myNumKeys + ikey];
+  }
+  inline double value( int record, int ivalue ) const {
+    return myValues[(size_t)record*myNumValues + ivalue];
+  }
+  int numKeys() const { return myNumKeys; }
+  int numValues() const { return myNumValues; }
+  int numRecords() const { return myNumRecords; }
+  /// @return Number of records whose key is identical to the key of a previous record (after index has been built)
+  int numDuplicates() const { return myNumDuplicates; }
+  /// @return true if record key is identical to the key of a previous record (after index has been built)
+  bool isDuplicate( int record );
+
+  /**
+   * Write table to binary cache file
+   * @param filename   Name of cache file
+   * @param signature  Signature string
+   * @throws csException if file cannot be written
+   */
+  void writeCache( std::string const& filename, std::string const& signature ) const;
+  /**
+   * Read table from binary cache file. Current records are replaced.
+   * @param filename   Name of cache file
+   * @param signature  Expected signature string
+   * @return false if cache file does not exist, is corrupt, or has a different signature or table layout. Table is empty in this case.
+   */
+  bool readCache( std::string const& filename, std::string const& signature );
+
+private:
+  static unsigned long long hash( double const* keys, int numKeys );
+  /// @return Hash slot containing record with same key as given record, or empty slot where record shall go
+  int findSlot( double const* keys ) const;
+
+  int myNumKeys;
+  int myNumValues;
+  int myNumRecords;
+  int myNumRecordsAlloc;
+  /// Record-major arrays: [record*myNumKeys + ikey], [record*myNumValues + ivalue]
+  double* myKeys;
+  double* myValues;
+
+  /// Open addressing hash table: Record index, or -1 for empty slot. Size is a power of 2
+  int* mySlots;
+  int myNumSlots;
+  bool myIsIndexed;
+  int myNumDuplicates;
+
+  csKeyTable();
+  csKeyTable( csKeyTable const& obj );
+  csKeyTable& operator=( csKeyTable const& obj );
+};
+
+} // namespace
+
+#endif
@@ -0,0 +1,279 @@
+/* Copyright (c) Colorado School of Mines, 2013.*/
+/* All rights reserved.                       */
+
+#include "csPNGWriter.h"
+#include "csException.h"
+#include <cstdio>
+#include <cstring>
+
+using namespace cseis_geolib;
+
+namespace {
+  int const HASH_BITS   = 15;
+  int const WINDOW_SIZE = 32768;
+  int const MIN_MATCH   = 3;
+  int const MAX_MATCH   = 258;
+  /// Maximum number of hash chain entries searched for each match
+  int const MAX_CHAIN   = 48;
+  int const CHUNK_BYTE_SIZE = 65536;
+
+  int const LENGTH_BASE[29] = { 3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,35,43,51,59,67,83,99,115,131,163,195,227,258 };
+  int const LENGTH_EXTRA[29] = { 0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,4,4,5,5,5,5,0 };
+  int const DIST_BASE[30] = { 1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,257,385,513,769,1025,1537,2049,3073,4097,6145,8193,12289,16385,24577 };
+  int const DIST_EXTRA[30] = { 0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13 };
+
+  /**
+   * Output stream of PNG file
+   * Compressed bytes are collected in a buffer which is written out as one IDAT chunk whenever it is full.
+   */
+  class PNGStream {
+  public:
+    PNGStream( std::string const& filename ) {
+      myFilename = filename;
+      myFile = fopen( filename.c_str(), "wb" );
+      if( myFile == NULL ) {
+        throw( csException("Cannot open PNG file '%s' for writing", filename.c_str()) );
+      }
+      myNumBytes = 0;
+      myBitBuffer = 0;
+      myNumBits   = 0;
+      for( unsigned int n = 0; n < 256; n++ ) {
+        unsigned int c = n;
+        for( int k = 0; k < 8; k++ ) {
+          c = ( c & 1 ) ? ( 0xEDB88320U ^ (c >> 1) ) : ( c >> 1 );
+        }
+        myCRCTable[n] = c;
+      }
+    }
+    ~PNGStream() {
+      if( myFile != NULL ) fclose( myFile );
+    }
+    void close() {
+      int result = fclose( myFile );
+      myFile = NULL;
+      if( result != 0 ) {
+        throw( csException("Error occurred when writing PNG file '%s'. Disk full?", myFilename.c_str()) );
+      }
+    }
+    void writeRaw( void const* data, int numBytes ) {
+      if( numBytes == 0 ) return;
+      if( (int)fwrite( data, 1, numBytes, myFile ) != numBytes ) {
+        throw( csException("Error occurred when writing PNG file '%s'. Disk full?", myFilename.c_str()) );
+      }
+    }
+    void writeChunk( char const* type, unsigned char const* data, int numBytes ) {
+      unsigned char header[8];
+      putInt( header, (unsigned int)numBytes );
+      memcpy( &header[4], type, 4 );
+      writeRaw( header, 8 );
+      writeRaw( data, numBytes );
+      unsigned int crc = updateCRC( 0xFFFFFFFFU, &header[4], 4 );
+      crc = updateCRC( crc, data, numBytes ) ^ 0xFFFFFFFFU;
+      unsigned char trailer[4];
+      putInt( trailer, crc );
+      writeRaw( trailer, 4 );
+    }
+    static void putInt( unsigned char* buffer, unsigned int value ) {
+      buffer[0] = (unsigned char)( value >> 24 );
+      buffer[1] = (unsigned char)( value >> 16 );
+      buffer[2] = (unsigned char)( value >> 8 );
+      buffer[3] = (unsigned char)( value );
+    }
+    //--------------------------------------------------------------------
+    // Compressed data, written into IDAT chunks
+    void putByte( unsigned char byte ) {
+      myBuffer[myNumBytes++] = byte;
+      if( myNumBytes == CHUNK_BYTE_SIZE ) flushData();
+    }
+    void flushData() {
+      if( myNumBytes > 0 ) writeChunk( "IDAT", myBuffer, myNumBytes );
+      myNumBytes = 0;
+    }
+    /// Write bits, least significant bit first
+    inline void putBits( unsigned int value, int numBits ) {
+      myBitBuffer |= value << myNumBits;
+      myNumBits += numBits;
+      while( myNumBits >= 8 ) {
+        putByte( (unsigned char)( myBitBuffer & 0xFF ) );
+        myBitBuffer >>= 8;
+        myNumBits -= 8;
+      }
+    }
+    /// Write Huffman code, most significant bit first
+    inline void putCode( unsigned int code, int numBits ) {
+      unsigned int reversed = 0;
+      for( int i = 0; i < numBits; i++ ) {
+        reversed = ( reversed << 1 ) | ( (code >> i) & 1 );
+      }
+      putBits( reversed, numBits );
+    }
+    void alignByte() {
+      if( myNumBits > 0 ) putBits( 0, 8 - myNumBits );
+    }
+    /// Literal/length symbol, fixed Huffman code
+    inline void putSymbol( int symbol ) {
+      if( symbol < 144 )      putCode( 0x30 + symbol, 8 );
+      else if( symbol < 256 ) putCode( 0x190 + (symbol-144), 9 );
+      else if( symbol < 280 ) putCode( symbol-256, 7 );
+      else                    putCode( 0xC0 + (symbol-280), 8 );
+    }
+    void putMatch( int length, int distance ) {
+      int icode = 28;
+      while( LENGTH_BASE[icode] > length ) icode--;
+      putSymbol( 257 + icode );
+      if( LENGTH_EXTRA[icode] > 0 ) putBits( length - LENGTH_BASE[icode], LENGTH_EXTRA[icode] );
+      int dcode = 29;
+      while( DIST_BASE[dcode] > distance ) dcode--;
+      putCode( dcode, 5 );
+      if( DIST_EXTRA[dcode] > 0 ) putBits( distance - DIST_BASE[dcode], DIST_EXTRA[dcode] );
+    }
+    unsigned int updateCRC( unsigned int crc, unsigned char const* data, int numBytes ) const {
+      for( int i = 0; i < numBytes; i++ ) {
+        crc = myCRCTable[(crc ^ data[i]) & 0xFF] ^ ( crc >> 8 );
+      }
+      return crc;
+    }
+
+  private:
+    std::string myFilename;
+    FILE* myFile;
+    unsigned int myCRCTable[256];
+    unsigned char myBuffer[CHUNK_BYTE_SIZE];
+    int myNumBytes;
+    unsigned int myBitBuffer;
+    int myNumBits;
+  };
+
+  /**
+   * Compress data into single deflate block with fixed Huffman codes, wrapped in zlib format
+   */
+  void deflate( unsigned char const* data, int numBytes, PNGStream* stream ) {
+    // zlib header: Deflate with 32K window, no dictionary, fastest compression level
+    stream->putByte( 0x78 );
+    stream->putByte( 0x01 );
+    stream->putBits( 1, 1 );  // Final block
+    stream->putBits( 1, 2 );  // Fixed Huffman codes
+
+    int const hashSize = 1 << HASH_BITS;
+    int* head = new int[hashSize];
+    int* prev = new int[WINDOW_SIZE];
+    for( int i = 0; i < hashSize; i++ ) {
+      head[i] = -1;
+    }
+    int pos = 0;
+    while( pos < numBytes ) {
+      int bestLength   = 0;
+      int bestDistance = 0;
+      int hash = 0;
+      if( pos + MIN_MATCH <= numBytes ) {
+        hash = ( ( (int)data[pos] << 10 ) ^ ( (int)data[pos+1] << 5 ) ^ (int)data[pos+2] ) & ( hashSize - 1 );
+        int maxLength = numBytes - pos < MAX_MATCH ? numBytes - pos : MAX_MATCH;
+        int candidate = head[hash];
+        int chain = 0;
+        while( candidate >= 0 && pos - candidate <= WINDOW_SIZE && chain < MAX_CHAIN ) {
+          if( data[candidate+bestLength] == data[pos+bestLength] ) {
+            int length = 0;
+            while( length < maxLength && data[candidate+length] == data[pos+length] ) {
+              length += 1;
+            }
+            if( length > bestLength ) {
+              bestLength   = length;
+              bestDistance = pos - candidate;
+              if( length == maxLength ) break;
+            }
+          }
+          int candidatePrev = prev[candidate & (WINDOW_SIZE-1)];
+          if( candidatePrev >= candidate ) break;
+          candidate = candidatePrev;
+          chain += 1;
+        }
+        prev[pos & (WINDOW_SIZE-1)] = head[hash];
+        head[hash] = pos;
+      }
+      if( bestLength >= MIN_MATCH ) {
+        stream->putMatch( bestLength, bestDistance );
+        // Insert skipped positions into hash chains
+        int posEnd = pos + bestLength;
+        for( pos = pos + 1; pos < posEnd; pos++ ) {
+          if( pos + MIN_MATCH <= numBytes ) {
+            hash = ( ( (int)data[pos] << 10 ) ^ ( (int)data[pos+1] << 5 ) ^ (int)data[pos+2] ) & ( hashSize - 1 );
+            prev[pos & (WINDOW_SIZE-1)] = head[hash];
+            head[hash] = pos;
+          }
+        }
+      }
+      else {
+        stream->putSymbol( data[pos] );
+        pos += 1;
+      }
+    }
+    stream->putSymbol( 256 );  // End of block
+    stream->alignByte();
+    delete [] head;
+    delete [] prev;
+
+    // Adler-32 checksum of uncompressed data
+    unsigned int s1 = 1;
+    unsigned int s2 = 0;
+    int index = 0;
+    while( index < numBytes ) {
+      int indexEnd = index + 5552 < numBytes ? index + 5552 : numBytes;  // Largest block without 32bit overflow
+      for( ; index < indexEnd; index++ ) {
+        s1 += data[index];
+        s2 += s1;
+      }
+      s1 %= 65521;
+      s2 %= 65521;
+    }
+    unsigned int adler = ( s2 << 16 ) | s1;
+    stream->putByte( (unsigned char)( adler >> 24 ) );
+    stream->putByte( (unsigned char)( adler >> 16 ) );
+    stream->putByte( (unsigned char)( adler >> 8 ) );
+    stream->putByte( (unsigned char)( adler ) );
+    stream->flushData();
+  }
+}
+
+//--------------------------------------------------------------------
+void csPNGWriter::writeRGB( std::string const& filename, unsigned char const* pixels, int width, int height ) {
+  if( width <= 0 || height <= 0 ) {
+    throw( csException("csPNGWriter: Invalid image size %dx%d", width, height) );
+  }
+  PNGStream stream( filename );
+  unsigned char const signature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+  stream.writeRaw( signature, 8 );
+
+  unsigned char header[13];
+  PNGStream::putInt( &header[0], (unsigned int)width );
+  PNGStream::putInt( &header[4], (unsigned int)height );
+  header[8]  = 8;  // Bit depth
+  header[9]  = 2;  // Colour type: RGB
+  header[10] = 0;  // Compression method: Deflate
+  header[11] = 0;  // Filter method
+  header[12] = 0;  // No interlace
+  stream.writeChunk( "IHDR", header, 13 );
+
+  // Each row is preceded by its filter type (0: No filter)
+  int rowByteSize = 3 * width;
+  size_t numBytes = (size_t)height * (rowByteSize + 1);
+  if( numBytes > 2147483647U ) {
+    throw( csException("csPNGWriter: Image size %dx%d too large", width, height) );
+  }
+  unsigned char* data = new unsigned char[numBytes];
+  for( int row = 0; row < height; row++ ) {
+    unsigned char* dataRow = &data[(size_t)row * (rowByteSize + 1)];
+    dataRow[0] = 0;
+    memcpy( &dataRow[1], &pixels[(size_t)row * rowByteSize], rowByteSize );
+  }
+  try {
+    deflate( data, (int)numBytes, &stream );
+  }
+  catch( csException& e ) {
+    delete [] data;
+    throw;
+  }
+  delete [] data;
+
+  stream.writeChunk( "IEND", NULL, 0 );
+  stream.close();
+}
@@ -0,0 +1,38 @@
+/* Copyright (c) Colorado School of Mines, 2013.*/
+/* All rights reserved.                       */
+
+#ifndef CS_PNG_WRITER_H
+#define CS_PNG_WRITER_H
+
+#include <string>
+
+namespace cseis_geolib {
+
+/**
+ * PNG image writer
+ *
+ * Writes 8bit RGB images in PNG format, without external library.
+ * Image data is compressed by a small deflate encoder (LZ77 with hash chains, fixed Huffman codes). This gives
+ * good compression for plots with large uniform areas, lines and text, which is all that is required here.
+ *
+ * @author Bjorn Olofsson
+ * @date 2013
+ */
+class csPNGWriter {
+public:
+  /**
+   * Write RGB image to PNG file
+   * @param filename  Output file name
+   * @param pixels    Pixel values, 3 bytes (red, green, blue) per pixel, row by row starting with the top row
+   * @param width     Image width in pixels
+   * @param height    Image height in pixels
+   * @throws csException if file cannot be written
+   */
+  static void writeRGB( std::string const& filename, unsigned char const* pixels, int width, int height );
+private:
+  csPNGWriter();
+};
+
+} // namespace
+
+#endif
@@ -8,12 +8,12 @@
 #include "csSelectionField.h"
 #include "csSelectionFieldDouble.h"
 #include "csSelectionFieldInt.h"
+#include "csSelectionPredicate.h"
 #include "csException.h"
 #include "geolib_string_utils.h"
 #include "csFlexNumber.h"
 #include "csVector.h"
 #include "csGeolibUtils.h"
-#include <cstdio>
 
 using namespace cseis_geolib;
 
@@ -28,9 +28,23 @@ csSelection::csSelection( int numHeaders, type_t const* hdrTypes ) {
   myHdrTypes   = NULL;
   mySelectionList = new csVector<csSelectionField const*>();
   myNumFieldsList = new csVector<int>();
+  myPredicateList = new csVector<csSelectionPredicate*>();
+  myIsCandidate   = NULL;
+  myNumCandidatesAlloc = 0;
   resetHeaders( numHeaders, hdrTypes );
 }
 csSelection::~csSelection() {
+  if( myPredicateList != NULL ) {
+    for( int i = 0; i < myPredicateList->size(); i++ ) {
+      delete myPredicateList->at(i);
+    }
+    delete myPredicateList;
+    myPredicateList = NULL;
+  }
+  if( myIsCandidate != NULL ) {
+    delete [] myIsCandidate;
+    myIsCandidate = NULL;
+  }
   if( mySelectionList != NULL ) {
     for( int i = 0; i < mySelectionList->size(); i++ ) {
       delete mySelectionList->at(i);
@@ -81,6 +95,13 @@ void csSelection::resetHeaders( int numHeaders, type_t const* hdrTypes ) {
   //fprintf(stdout,"csSelection::resetHeaders: Header types: %d %s\n", myHdrTypes[0], cseis_geolib::csGeolibUtils::typeText(myHdrTypes[0]));
 }
 void csSelection::clear() {
+  for( int i = 0; i < myPredicateList->size(); i++ ) {
+    delete myPredicateList->at(i);
+  }
+  myPredicateList->clear();
+  for( int i = 0; i < mySelectionList->size(); i++ ) {
+    delete mySelectionList->at(i);
+  }
   mySelectionList->clear();
   myNumFieldsList->clear();
 }
@@ -120,43 +141,61 @@ void csSelection::add( std::string const& textIn ) {
         parse( fieldTokenList.at(iField), selectionField );
         mySelectionList->insertEnd( selectionField );
       }
+      int firstField = mySelectionList->size() - numSelectionFields;
+      myPredicateList->insertEnd( new csSelectionPredicate( myHdrTypes[iHeader], &mySelectionList->at(firstField), numSelectionFields ) );
     }
   }
 }
 
 //--------------------------------------------------------------------------------
 bool csSelection::contains( csFlexNumber const* const values ) {
-  int numSelectionFields = mySelectionList->size();
-  int counterNumFields = 0;
-  int counterSelectionFields = 0;
-  bool isSelected = false;
+  int numPredicates = myPredicateList->size();
 
-  while( counterSelectionFields < numSelectionFields ) {
-    bool isSelectedHeaders = true;
+  for( int iPred = 0; iPred < numPredicates; iPred += myNumHeaders ) {
+    int iHeader = 0;
+    // All headers need to be selected
+    while( iHeader < myNumHeaders && myPredicateList->at(iPred+iHeader)->contains( values[iHeader] ) ) {
+      iHeader += 1;
+    }
+    if( iHeader == myNumHeaders ) return true;
+  }
+  return false;
+}
+//--------------------------------------------------------------------------------
+int csSelection::contains( csFlexNumber const* const values, int numSets, bool* isSelected ) {
+  if( numSets > myNumCandidatesAlloc ) {
+    if( myIsCandidate != NULL ) delete [] myIsCandidate;
+    myNumCandidatesAlloc = numSets;
+    myIsCandidate = new bool[myNumCandidatesAlloc];
+  }
+  for( int iset = 0; iset < numSets; iset++ ) {
+    isSelected[iset] = false;
+  }
+  int numPredicates = myPredicateList->size();
+  int numSelected = 0;
+
+  for( int iPred = 0; iPred < numPredicates && numSelected < numSets; iPred += myNumHeaders ) {
+    for( int iset = 0; iset < numSets; iset++ ) {
+      myIsCandidate[iset] = !isSelected[iset];
+    }
     for( int iHeader = 0; iHeader < myNumHeaders; iHeader++ ) {
-      int numFields = myNumFieldsList->at(counterNumFields);
-      counterNumFields += 1;
-      bool isSelectedFields = false;
-      for( int iField = 0; iField < numFields; iField++ ) {
-        isSelectedFields = isSelectedFields || mySelectionList->at(counterSelectionFields)->contains( values[iHeader] );
-        counterSelectionFields += 1;
-      }
-      isSelectedHeaders = isSelectedHeaders && isSelectedFields;  // All headers need to be selected
-/*      if( !isSelectedFields ) {   // Every header must be selected true. Try next selection
-        for( int ih = iHeader; ih < numHeaders; ih++ ) {  // Loop to set counters correctly
-          int numFields = myNumFieldsList->at(counterNumFields++);
-          counterSelectionFields += numFields;
+      csSelectionPredicate const* predicate = myPredicateList->at(iPred+iHeader);
+      for( int iset = 0; iset < numSets; iset++ ) {
+        if( myIsCandidate[iset] ) {
+          myIsCandidate[iset] = predicate->contains( values[iset*myNumHeaders + iHeader] );
         }
-        break;
-      } */
+      }
+    }
+    for( int iset = 0; iset < numSets; iset++ ) {
+      if( myIsCandidate[iset] ) {
+        isSelected[iset] = true;
+        numSelected += 1;
+      }
     }
-    isSelected = isSelected || isSelectedHeaders;
-  } // END while
-    
-  return isSelected;
+  }
+  return numSelected;
 }
 
-
 //--------------------------------------------------------------------------------
 void csSelection::dump() {
   int numSelectionFields = mySelectionList->size();
@@ -176,6 +215,7 @@ void csSelection::dump() {
         printf("     Field: %d\n", iField+1 );
         mySelectionList->at(counterSelectionFields++)->dump();
       }
+      myPredicateList->at(counterNumFields-1)->dump();
     }
   }
 
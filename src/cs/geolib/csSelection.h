@@ -11,6 +11,7 @@
 namespace cseis_geolib {
   class csFlexNumber;
   class csSelectionField;
+  class csSelectionPredicate;
   template <typename T> class csVector;
 
 /**
@@ -41,6 +42,9 @@ namespace cseis_geolib {
 *                       !<any_selection>   All numbers NOT contained in the specified selection
 * See @class csSelectionField
 *
+* Each header expression is compiled into a csSelectionPredicate when it is added, see @class csSelectionPredicate.
+* Evaluation stops at the first header that is not selected, and at the first selection that contains all header values.
+*
 * @author Bjorn Olofsson
 * @date 2005
 */
@@ -80,6 +84,15 @@ public:
   */
   bool contains( csFlexNumber const* const values );
   /**
+  * Evaluate selection for a number of value sets, for example the trace headers of one ensemble.
+  * Selections are evaluated one header at a time for all value sets which are still undecided.
+  * @param values      (i) Values of all headers of all value sets: [iset*numHeaders + iheader]
+  * @param numSets     (i) Number of value sets
+  * @param isSelected  (o) For each value set: true if selection contains the header values of this set
+  * @return Number of selected value sets
+  */
+  int contains( csFlexNumber const* const values, int numSets, bool* isSelected );
+  /**
   * Clear selection
   */
   void clear();
@@ -96,6 +109,11 @@ protected:
 private:
   csVector<csSelectionField const*>* mySelectionList;
   csVector<int>* myNumFieldsList;
+  /// Compiled header expressions: [iselection*myNumHeaders + iheader]
+  csVector<csSelectionPredicate*>* myPredicateList;
+  /// Work array for bulk evaluation
+  bool* myIsCandidate;
+  int myNumCandidatesAlloc;
   int myNumHeaders;
   type_t* myHdrTypes;
 
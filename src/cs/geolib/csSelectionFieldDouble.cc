@@ -8,6 +8,8 @@
 #include "csSelectionField.h"
 #include "csSelectionFieldDouble.h"
 #include "csFlexNumber.h"
+#include "csVector.h"
+#include <limits>
 
 using namespace cseis_geolib;
 
@@ -88,6 +90,89 @@ bool csSelectionFieldDouble::contains( csFlexNumber const& value_in ) const {
   return( !myDoInvert ? ret : !ret );
 }
 
+//--------------------------------------------------------------------------------
+bool csSelectionFieldDouble::getIntervals( csVector<double>* minList, csVector<double>* maxList ) const {
+  double const VALUE_INF = std::numeric_limits<double>::infinity();
+  csVector<double> selMinList;
+  csVector<double> selMaxList;
+
+  switch( mySelectType ) {
+  case csSelection::SELECTION_SINGLE:
+    selMinList.insertEnd( myValue );
+    selMaxList.insertEnd( myValue );
+    break;
+  case csSelection::SELECTION_RANGE:
+    if( myRangeMin <= myRangeMax ) {
+      selMinList.insertEnd( myRangeMin );
+      selMaxList.insertEnd( myRangeMax );
+    }
+    break;
+  case csSelection::SELECTION_RANGE_INC:
+  case csSelection::SELECTION_RANGE_INC_WIDTH:
+    // fmod() selection: Not an interval
+    return false;
+  case csSelection::SELECTION_OPERATOR:
+    // Strict operators: Closest representable double value excludes the operand itself
+    switch( myOperator ) {
+    case csSelection::OPERATOR_SMALLER:
+      if( myValue > -VALUE_INF ) {
+        selMinList.insertEnd( -VALUE_INF );
+        selMaxList.insertEnd( nextafter( myValue, -VALUE_INF ) );
+      }
+      break;
+    case csSelection::OPERATOR_GREATER:
+      if( myValue < VALUE_INF ) {
+        selMinList.insertEnd( nextafter( myValue, VALUE_INF ) );
+        selMaxList.insertEnd( VALUE_INF );
+      }
+      break;
+    case csSelection::OPERATOR_SMALLER_EQUAL:
+      selMinList.insertEnd( -VALUE_INF );
+      selMaxList.insertEnd( myValue );
+      break;
+    case csSelection::OPERATOR_GREATER_EQUAL:
+      selMinList.insertEnd( myValue );
+      selMaxList.insertEnd( VALUE_INF );
+      break;
+    }
+    break;
+  case csSelection::SELECTION_ALL:
+    selMinList.insertEnd( -VALUE_INF );
+    selMaxList.insertEnd( VALUE_INF );
+    break;
+  }
+
+  minList->clear();
+  maxList->clear();
+  if( !myDoInvert ) {
+    for( int i = 0; i < selMinList.size(); i++ ) {
+      minList->insertEnd( selMinList.at(i) );
+      maxList->insertEnd( selMaxList.at(i) );
+    }
+  }
+  else {
+    // Complement: Gaps between selected intervals
+    double next = -VALUE_INF;
+    bool isDone = false;
+    for( int i = 0; i < selMinList.size(); i++ ) {
+      if( selMinList.at(i) > next ) {
+        minList->insertEnd( next );
+        maxList->insertEnd( nextafter( selMinList.at(i), -VALUE_INF ) );
+      }
+      if( selMaxList.at(i) == VALUE_INF ) {
+        isDone = true;
+        break;
+      }
+      next = nextafter( selMaxList.at(i), VALUE_INF );
+    }
+    if( !isDone ) {
+      minList->insertEnd( next );
+      maxList->insertEnd( VALUE_INF );
+    }
+  }
+  return true;
+}
+
 void csSelectionFieldDouble::dump() const {
 
   if( mySelectType == csSelection::SELECTION_SINGLE ) {
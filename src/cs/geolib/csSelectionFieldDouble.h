@@ -9,6 +9,8 @@
 
 namespace cseis_geolib {
 
+template <typename T> class csVector;
+
 /**
 * Double selection field
 *
@@ -23,6 +25,14 @@ public:
   virtual void setRange( csFlexNumber const& rangeMin, csFlexNumber const& rangeMax );
   virtual void setRange( csFlexNumber const& rangeMin, csFlexNumber const& rangeMax, csFlexNumber const& rangeInc );
   virtual void setWidth( csFlexNumber const& width );
+  /**
+   * Retrieve selected values as sorted list of disjoint, inclusive intervals
+   * NaN is never contained in the returned intervals.
+   * @param minList (o) Interval minimum values
+   * @param maxList (o) Interval maximum values
+   * @return false if the selection cannot be expressed by intervals (ranges with increment)
+   */
+  bool getIntervals( csVector<double>* minList, csVector<double>* maxList ) const;
   virtual void dump() const;
 private:
   double myValue;
@@ -4,9 +4,12 @@
 #include <string>
 #include <cstdio>
 #include <cmath>
+#include <climits>
+#include <algorithm>
 #include "csSelection.h"
 #include "csSelectionFieldInt.h"
 #include "csFlexNumber.h"
+#include "csVector.h"
 
 using namespace cseis_geolib;
 
@@ -85,6 +88,109 @@ bool csSelectionFieldInt::contains( csFlexNumber const& value_in ) const {
   return( !myDoInvert ? ret : !ret );
 }
 
+//--------------------------------------------------------------------------------
+bool csSelectionFieldInt::getIntervals( csVector<csInt64_t>* minList, csVector<csInt64_t>* maxList, int maxNumIntervals ) const {
+  csInt64_t const VALUE_MIN = (csInt64_t)INT_MIN;
+  csInt64_t const VALUE_MAX = (csInt64_t)INT_MAX;
+  csVector<csInt64_t> selMinList;
+  csVector<csInt64_t> selMaxList;
+
+  switch( mySelectType ) {
+  case csSelection::SELECTION_SINGLE:
+    selMinList.insertEnd( myValue );
+    selMaxList.insertEnd( myValue );
+    break;
+  case csSelection::SELECTION_RANGE:
+    if( myRangeMin <= myRangeMax ) {
+      selMinList.insertEnd( myRangeMin );
+      selMaxList.insertEnd( myRangeMax );
+    }
+    break;
+  case csSelection::SELECTION_RANGE_INC:
+    if( myRangeInc <= 0 ) return false;
+    if( myRangeMin <= myRangeMax ) {
+      if( ((csInt64_t)myRangeMax - (csInt64_t)myRangeMin) / myRangeInc + 1 > maxNumIntervals ) return false;
+      for( csInt64_t value = myRangeMin; value <= myRangeMax; value += myRangeInc ) {
+        selMinList.insertEnd( value );
+        selMaxList.insertEnd( value );
+      }
+    }
+    break;
+  case csSelection::SELECTION_RANGE_INC_WIDTH:
+    if( myRangeInc <= 0 || myWidth < 0 ) return false;
+    {
+      csInt64_t first = std::max( (csInt64_t)myRangeMin - (csInt64_t)myWidth, VALUE_MIN );
+      csInt64_t last  = std::min( (csInt64_t)myRangeMax + (csInt64_t)myWidth, VALUE_MAX );
+      if( first > last ) break;
+      if( 2*(csInt64_t)myWidth >= (csInt64_t)myRangeInc - 1 ) {
+        // Neighbouring windows touch or overlap
+        selMinList.insertEnd( first );
+        selMaxList.insertEnd( last );
+        break;
+      }
+      if( (last - first) / myRangeInc + 1 > maxNumIntervals ) return false;
+      for( csInt64_t value = first; value <= last; value += myRangeInc ) {
+        selMinList.insertEnd( value );
+        selMaxList.insertEnd( std::min( value + 2*(csInt64_t)myWidth, last ) );
+      }
+    }
+    break;
+  case csSelection::SELECTION_OPERATOR:
+    switch( myOperator ) {
+    case csSelection::OPERATOR_SMALLER:
+      if( (csInt64_t)myValue > VALUE_MIN ) {
+        selMinList.insertEnd( VALUE_MIN );
+        selMaxList.insertEnd( (csInt64_t)myValue - 1 );
+      }
+      break;
+    case csSelection::OPERATOR_GREATER:
+      if( (csInt64_t)myValue < VALUE_MAX ) {
+        selMinList.insertEnd( (csInt64_t)myValue + 1 );
+        selMaxList.insertEnd( VALUE_MAX );
+      }
+      break;
+    case csSelection::OPERATOR_SMALLER_EQUAL:
+      selMinList.insertEnd( VALUE_MIN );
+      selMaxList.insertEnd( myValue );
+      break;
+    case csSelection::OPERATOR_GREATER_EQUAL:
+      selMinList.insertEnd( myValue );
+      selMaxList.insertEnd( VALUE_MAX );
+      break;
+    }
+    break;
+  case csSelection::SELECTION_ALL:
+    selMinList.insertEnd( VALUE_MIN );
+    selMaxList.insertEnd( VALUE_MAX );
+    break;
+  }
+
+  minList->clear();
+  maxList->clear();
+  if( !myDoInvert ) {
+    for( int i = 0; i < selMinList.size(); i++ ) {
+      minList->insertEnd( selMinList.at(i) );
+      maxList->insertEnd( selMaxList.at(i) );
+    }
+  }
+  else {
+    // Complement: Gaps between selected intervals
+    csInt64_t next = VALUE_MIN;
+    for( int i = 0; i < selMinList.size(); i++ ) {
+      if( selMinList.at(i) > next ) {
+        minList->insertEnd( next );
+        maxList->insertEnd( selMinList.at(i) - 1 );
+      }
+      next = selMaxList.at(i) + 1;
+    }
+    if( next <= VALUE_MAX ) {
+      minList->insertEnd( next );
+      maxList->insertEnd( VALUE_MAX );
+    }
+  }
+  return( minList->size() <= maxNumIntervals );
+}
+
 void csSelectionFieldInt::dump() const {
   if( mySelectType == csSelection::SELECTION_SINGLE ) {
     printf(" Type: %d, operator: %d, value: %d\n", mySelectType, myOperator, myValue );
@@ -6,9 +6,12 @@
 
 #include <string>
 #include "csSelectionField.h"
+#include "geolib_defines.h"
 
 namespace cseis_geolib {
 
+template <typename T> class csVector;
+
 /**
 * Integer selection field
 *
@@ -24,6 +27,14 @@ public:
   virtual void setRange( csFlexNumber const& rangeMin, csFlexNumber const& rangeMax );
   virtual void setRange( csFlexNumber const& rangeMin, csFlexNumber const& rangeMax, csFlexNumber const& rangeInc );
   virtual void setWidth( csFlexNumber const& width );
+  /**
+   * Retrieve selected values as sorted list of disjoint, inclusive intervals
+   * @param minList (o) Interval minimum values
+   * @param maxList (o) Interval maximum values
+   * @param maxNumIntervals Maximum number of intervals
+   * @return false if the selection cannot be expressed by maxNumIntervals intervals
+   */
+  bool getIntervals( csVector<csInt64_t>* minList, csVector<csInt64_t>* maxList, int maxNumIntervals ) const;
 
 private:
   int myValue;
@@ -0,0 +1,215 @@
+/* Copyright (c) Colorado School of Mines, 2013.*/
+/* All rights reserved.                       */
+
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include "csSelectionPredicate.h"
+#include "csSelectionField.h"
+#include "csSelectionFieldInt.h"
+#include "csSelectionFieldDouble.h"
+#include "csVector.h"
+
+using namespace cseis_geolib;
+
+namespace {
+  /// Maximum number of intervals one selection field may be expanded into (ranges with increment)
+  int const MAX_NUM_INTERVALS_FIELD = 1000000;
+  /// Up to this number of intervals, intervals are searched linearly
+  int const MAX_NUM_INTERVALS_LINEAR = 8;
+  /// Maximum number of values covered by bitmap (128KB)
+  csInt64_t const MAX_BITMAP_NUM_VALUES = 1024*1024;
+}
+
+csSelectionPredicate::csSelectionPredicate( type_t hdrType, csSelectionField const* const* fields, int numFields ) {
+  myIsFloat    = ( hdrType == TYPE_DOUBLE || hdrType == TYPE_FLOAT );
+  myIsCompiled = false;
+  myNumFields  = numFields;
+  myFields     = new csSelectionField const*[myNumFields > 0 ? myNumFields : 1];
+  for( int i = 0; i < myNumFields; i++ ) {
+    myFields[i] = fields[i];
+  }
+  myNumIntervals = 0;
+  myIntMin    = NULL;
+  myIntMax    = NULL;
+  myDoubleMin = NULL;
+  myDoubleMax = NULL;
+  myNaNResult = false;
+  myBitmap    = NULL;
+  myBitmapFirstValue = 0;
+  myBitmapNumValues  = 0;
+
+  if( myIsFloat ) {
+    compileDouble();
+  }
+  else {
+    compileInt();
+  }
+}
+csSelectionPredicate::~csSelectionPredicate() {
+  delete [] myFields;
+  if( myIntMin != NULL ) {
+    delete [] myIntMin;
+    delete [] myIntMax;
+  }
+  if( myDoubleMin != NULL ) {
+    delete [] myDoubleMin;
+    delete [] myDoubleMax;
+  }
+  if( myBitmap != NULL ) {
+    delete [] myBitmap;
+  }
+}
+//--------------------------------------------------------------------------------
+void csSelectionPredicate::compileInt() {
+  std::vector< std::pair<csInt64_t,csInt64_t> > intervals;
+  csVector<csInt64_t> minList;
+  csVector<csInt64_t> maxList;
+  for( int ifield = 0; ifield < myNumFields; ifield++ ) {
+    csSelectionFieldInt const* field = static_cast<csSelectionFieldInt const*>( myFields[ifield] );
+    if( !field->getIntervals( &minList, &maxList, MAX_NUM_INTERVALS_FIELD ) ) return;
+    for( int i = 0; i < minList.size(); i++ ) {
+      intervals.push_back( std::make_pair( minList.at(i), maxList.at(i) ) );
+    }
+  }
+  std::sort( intervals.begin(), intervals.end() );
+
+  // Merge overlapping and adjacent intervals
+  int numIntervals = 0;
+  for( int i = 0; i < (int)intervals.size(); i++ ) {
+    if( numIntervals > 0 && intervals[i].first <= intervals[numIntervals-1].second + 1 ) {
+      intervals[numIntervals-1].second = std::max( intervals[numIntervals-1].second, intervals[i].second );
+    }
+    else {
+      intervals[numIntervals++] = intervals[i];
+    }
+  }
+  myNumIntervals = numIntervals;
+  myIntMin = new csInt64_t[myNumIntervals > 0 ? myNumIntervals : 1];
+  myIntMax = new csInt64_t[myNumIntervals > 0 ? myNumIntervals : 1];
+  for( int i = 0; i < myNumIntervals; i++ ) {
+    myIntMin[i] = intervals[i].first;
+    myIntMax[i] = intervals[i].second;
+  }
+  myIsCompiled = true;
+
+  if( myNumIntervals > MAX_NUM_INTERVALS_LINEAR ) {
+    csInt64_t numValues = myIntMax[myNumIntervals-1] - myIntMin[0] + 1;
+    if( numValues <= MAX_BITMAP_NUM_VALUES ) {
+      myBitmapFirstValue = myIntMin[0];
+      myBitmapNumValues  = numValues;
+      int byteSize = (int)( (numValues + 7) / 8 );
+      myBitmap = new unsigned char[byteSize];
+      memset( myBitmap, 0, byteSize );
+      for( int i = 0; i < myNumIntervals; i++ ) {
+        for( csInt64_t value = myIntMin[i]; value <= myIntMax[i]; value++ ) {
+          csInt64_t bit = value - myBitmapFirstValue;
+          myBitmap[bit >> 3] |= (unsigned char)( 1 << (bit & 7) );
+        }
+      }
+    }
+  }
+}
+//--------------------------------------------------------------------------------
+void csSelectionPredicate::compileDouble() {
+  std::vector< std::pair<double,double> > intervals;
+  csVector<double> minList;
+  csVector<double> maxList;
+  for( int ifield = 0; ifield < myNumFields; ifield++ ) {
+    csSelectionFieldDouble const* field = static_cast<csSelectionFieldDouble const*>( myFields[ifield] );
+    if( !field->getIntervals( &minList, &maxList ) ) return;
+    for( int i = 0; i < minList.size(); i++ ) {
+      intervals.push_back( std::make_pair( minList.at(i), maxList.at(i) ) );
+    }
+  }
+  std::sort( intervals.begin(), intervals.end() );
+
+  // Merge overlapping intervals
+  int numIntervals = 0;
+  for( int i = 0; i < (int)intervals.size(); i++ ) {
+    if( numIntervals > 0 && intervals[i].first <= intervals[numIntervals-1].second ) {
+      intervals[numIntervals-1].second = std::max( intervals[numIntervals-1].second, intervals[i].second );
+    }
+    else {
+      intervals[numIntervals++] = intervals[i];
+    }
+  }
+  myNumIntervals = numIntervals;
+  myDoubleMin = new double[myNumIntervals > 0 ? myNumIntervals : 1];
+  myDoubleMax = new double[myNumIntervals > 0 ? myNumIntervals : 1];
+  for( int i = 0; i < myNumIntervals; i++ ) {
+    myDoubleMin[i] = intervals[i].first;
+    myDoubleMax[i] = intervals[i].second;
+  }
+  // NaN fails all comparisons: Only inverted fields contain NaN
+  myNaNResult = containsFields( csFlexNumber( std::numeric_limits<double>::quiet_NaN() ) );
+  myIsCompiled = true;
+}
+//--------------------------------------------------------------------------------
+bool csSelectionPredicate::containsFields( csFlexNumber const& value ) const {
+  for( int ifield = 0; ifield < myNumFields; ifield++ ) {
+    if( myFields[ifield]->contains( value ) ) return true;
+  }
+  return false;
+}
+//--------------------------------------------------------------------------------
+bool csSelectionPredicate::containsInt( int value_in ) const {
+  csInt64_t value = value_in;
+  if( myBitmap != NULL ) {
+    csInt64_t bit = value - myBitmapFirstValue;
+    if( bit < 0 || bit >= myBitmapNumValues ) return false;
+    return( ( myBitmap[bit >> 3] & (unsigned char)( 1 << (bit & 7) ) ) != 0 );
+  }
+  if( myNumIntervals <= MAX_NUM_INTERVALS_LINEAR ) {
+    for( int i = 0; i < myNumIntervals; i++ ) {
+      if( value <= myIntMax[i] ) return( value >= myIntMin[i] );
+    }
+    return false;
+  }
+  // Binary search: First interval with maximum >= value
+  int i1 = 0;
+  int i2 = myNumIntervals;
+  while( i1 < i2 ) {
+    int im = ( i1 + i2 ) / 2;
+    if( myIntMax[im] < value ) i1 = im + 1;
+    else i2 = im;
+  }
+  return( i1 < myNumIntervals && value >= myIntMin[i1] );
+}
+//--------------------------------------------------------------------------------
+bool csSelectionPredicate::containsDouble( double value ) const {
+  if( value != value ) return myNaNResult;
+  if( myNumIntervals <= MAX_NUM_INTERVALS_LINEAR ) {
+    for( int i = 0; i < myNumIntervals; i++ ) {
+      if( value <= myDoubleMax[i] ) return( value >= myDoubleMin[i] );
+    }
+    return false;
+  }
+  int i1 = 0;
+  int i2 = myNumIntervals;
+  while( i1 < i2 ) {
+    int im = ( i1 + i2 ) / 2;
+    if( myDoubleMax[im] < value ) i1 = im + 1;
+    else i2 = im;
+  }
+  return( i1 < myNumIntervals && value >= myDoubleMin[i1] );
+}
+//--------------------------------------------------------------------------------
+void csSelectionPredicate::dump() const {
+  if( !myIsCompiled ) {
+    printf("    Predicate: %d fields, not compiled\n", myNumFields );
+    return;
+  }
+  printf("    Predicate: %d fields, %d intervals%s\n", myNumFields, myNumIntervals, myBitmap != NULL ? ", bitmap" : "" );
+  for( int i = 0; i < myNumIntervals; i++ ) {
+    if( myIsFloat ) {
+      printf("     [%f, %f]\n", myDoubleMin[i], myDoubleMax[i] );
+    }
+    else {
+      printf("     [%lld, %lld]\n", (long long)myIntMin[i], (long long)myIntMax[i] );
+    }
+  }
+}
@@ -0,0 +1,81 @@
+/* Copyright (c) Colorado School of Mines, 2013.*/
+/* All rights reserved.                       */
+
+#ifndef CS_SELECTION_PREDICATE_H
+#define CS_SELECTION_PREDICATE_H
+
+#include "geolib_defines.h"
+#include "csFlexNumber.h"
+
+namespace cseis_geolib {
+
+class csSelectionField;
+
+/**
+ * Compiled selection of one header value
+ *
+ * Combines the comma-separated selection fields of one header (logical OR) into one predicate.
+ * Integer fields are converted into a sorted list of disjoint intervals, which is searched with a binary search.
+ * For dense integer selections, a bitmap covering all selected values is used instead.
+ * Floating point fields are converted into intervals in the same way, except ranges with increment.
+ * If any field cannot be converted, the predicate evaluates the selection fields themselves, stopping at the first
+ * field that contains the value.
+ * Results are identical to the logical OR of csSelectionField::contains() of all fields.
+ *
+ * @author Bjorn Olofsson
+ * @date 2013
+ */
+class csSelectionPredicate {
+public:
+  /**
+   * @param hdrType    Header type. TYPE_FLOAT and TYPE_DOUBLE use floating point fields, all other types integer fields
+   * @param fields     Selection fields. Fields are not copied, and must exist as long as this object
+   * @param numFields  Number of selection fields
+   */
+  csSelectionPredicate( type_t hdrType, csSelectionField const* const* fields, int numFields );
+  ~csSelectionPredicate();
+  inline bool contains( csFlexNumber const& value ) const {
+    if( !myIsCompiled ) return containsFields( value );
+    if( myIsFloat ) return containsDouble( value.doubleValue() );
+    return containsInt( value.intValue() );
+  }
+  /// @return true if fields have been converted into intervals
+  bool isCompiled() const { return myIsCompiled; }
+  int numIntervals() const { return myNumIntervals; }
+  bool usesBitmap() const { return myBitmap != NULL; }
+  void dump() const;
+
+private:
+  bool containsInt( int value ) const;
+  bool containsDouble( double value ) const;
+  bool containsFields( csFlexNumber const& value ) const;
+  void compileInt();
+  void compileDouble();
+
+  bool myIsFloat;
+  bool myIsCompiled;
+  csSelectionField const** myFields;
+  int myNumFields;
+
+  /// Sorted, disjoint, inclusive intervals
+  int myNumIntervals;
+  csInt64_t* myIntMin;
+  csInt64_t* myIntMax;
+  double* myDoubleMin;
+  double* myDoubleMax;
+  /// Floating point fields: Result for NaN values
+  bool myNaNResult;
+
+  /// Bitmap of selected integer values, starting at myBitmapFirstValue
+  unsigned char* myBitmap;
+  csInt64_t myBitmapFirstValue;
+  csInt64_t myBitmapNumValues;
+
+  csSelectionPredicate();
+  csSelectionPredicate( csSelectionPredicate const& obj );
+  csSelectionPredicate& operator=( csSelectionPredicate const& obj );
+};
+
+} // namespace
+
+#endif
@@ -3,6 +3,7 @@
 
 #include "csTableNew.h"
 #include "csTimeFunction.h"
+#include "csTimeFunctionCache.h"
 #include "csException.h"
 #include "csVector.h"
 #include "csGeolibUtils.h"
@@ -10,6 +11,7 @@
 #include "csSort.h"
 #include "csSortManager.h"
 #include "csFlexNumber.h"
+#include "csASCIIParser.h"
 #include <string>
 #include <cstring>
 #include <algorithm>
@@ -32,7 +34,7 @@ csTableNew::csTableNew( int tableType ) {
 void csTableNew::init( int tableType ) {
   myValues     = NULL;
   myKeyValues  = NULL;
-  myFile       = NULL;
+  myParser     = NULL;
   myNumKeys    = 0;
   myNumInterpKeys    = 0;
   myNumValues  = 0;
@@ -47,9 +49,15 @@ void csTableNew::init( int tableType ) {
   myHasReadTableContents = false;
   myHasBeenInitialized   = false;
 
+  myIsKeySorted = false;
+  myKeyRunStart = NULL;
+  myKeyRunEnd   = NULL;
+
   myTimeFunctions2D = NULL;
   myIndexTimeCol    = 0;
   myCurrentTimeFunction = NULL;
+  myFunctionCache       = NULL;
+  myFunctionCacheSize   = DEFAULT_FUNCTION_CACHE_SIZE;
   if( myTableType == TABLE_TYPE_TIME_FUNCTION ) {
     myCurrentTimeFunction = new csTimeFunction<double>();
   }
@@ -82,9 +90,9 @@ csTableNew::~csTableNew() {
     delete myValues;
     myValues = NULL;
   }
-  if( myFile != NULL ) {
-    fclose( myFile );
-    myFile = NULL;
+  if( myParser != NULL ) {
+    delete myParser;
+    myParser = NULL;
   }
   if( myTimeFunctions2D != NULL ) {
     for( int i = 0; i < myNumLocations; i++ ) {
@@ -99,6 +107,10 @@ csTableNew::~csTableNew() {
     delete myCurrentTimeFunction;
     myCurrentTimeFunction = NULL;
   }
+  if( myFunctionCache != NULL ) {
+    delete myFunctionCache;
+    myFunctionCache = NULL;
+  }
 }
 void csTableNew::addKey( int columnIndex, bool doInterpolate ) {
   if( doInterpolate ) {
@@ -144,6 +156,19 @@ void csTableNew::addKey( int columnIndex, bool doInterpolate ) {
 }
 
 
+void csTableNew::setFunctionCacheSize( int numFunctions ) {
+  if( myHasBeenInitialized ) {
+    throw( csException("csTableNew::setFunctionCacheSize(): Cache size must be set before table is initialized. This is a program bug in the calling function") );
+  }
+  myFunctionCacheSize = numFunctions;
+}
+long csTableNew::numFunctionCacheHits() const {
+  return( myFunctionCache != NULL ? myFunctionCache->numHits() : 0 );
+}
+long csTableNew::numFunctionCacheMisses() const {
+  return( myFunctionCache != NULL ? myFunctionCache->numMisses() : 0 );
+}
+
 void csTableNew::addValue( int columnIndex ) {
   int newNumValues = myNumValues + 1;
   int* valueColumns = new int[newNumValues];
@@ -172,6 +197,16 @@ void csTableNew::clearBuffers() {
     delete [] myKeyValues;
     myKeyValues = NULL;
   }
+  if( myKeyRunStart != NULL ) {
+    for( int i = 0; i < myNumAllKeys; i++ ) {
+      delete [] myKeyRunStart[i];
+      delete [] myKeyRunEnd[i];
+    }
+    delete [] myKeyRunStart;
+    delete [] myKeyRunEnd;
+    myKeyRunStart = NULL;
+    myKeyRunEnd   = NULL;
+  }
 }
 
 //-----------------------------------------------------------------------------------
@@ -188,7 +223,10 @@ void csTableNew::initialize( std::string const& filename, bool doSort ) {
 
   clearBuffers();
 
-  if( (myFile = fopen( filename.c_str(), "r" )) == (FILE*) NULL ) {
+  try {
+    myParser = new csASCIIParser( filename, 0 );
+  }
+  catch( csException& ) {
     throw csException("Could not open file: '%s'", filename.c_str());
   }
   myHasBeenInitialized = true;
@@ -238,10 +276,7 @@ void csTableNew::readTableContents( bool doSort ) {
   }
   maxColumnIndex = std::max( maxColumnIndex, myValueColumns[myNumValues-1] );
 
-  char buffer[1024];
   int counterLines = 1;
-  // Helper field for storing tokens extracted from input line
-  csVector<std::string> tokenList;
   // List of values for each 'value' column in input file
   csVector<double>* valueList = new csVector<double>[myNumValues];
   // List of key values for each 'location'. Each list item is an array of key values (one value for each key)
@@ -251,24 +286,45 @@ void csTableNew::readTableContents( bool doSort ) {
   //  csVector<double> valueListTime;
   csVector<csTimeFunction<double>*> timeFunctionList;
 
+  // Parser columns: All keys, then values, then time
+  int numParseColumns = myNumAllKeys + myNumValues + 1;
+  int* parseColumns = new int[numParseColumns];
+  for( int ikey = 0; ikey < myNumAllKeys; ikey++ ) {
+    parseColumns[ikey] = myKeyAllCols[ikey];
+  }
+  for( int ival = 0; ival < myNumValues; ival++ ) {
+    parseColumns[myNumAllKeys+ival] = myValueColumns[ival];
+  }
+  parseColumns[numParseColumns-1] = ( myTableType == TABLE_TYPE_TIME_FUNCTION ) ? myIndexTimeCol : -1;
+  myParser->setColumns( parseColumns, numParseColumns );
+  delete [] parseColumns;
+  myParser->indexLines();
+
   //-------------------------------
-  // (1) Loop through all input lines
+  // (1) Loop through all input lines. Lines are parsed in blocks, using multiple threads
   //
   int maxTableColumns = 0;
-  while( fgets( buffer, 1024, myFile ) != NULL ) {
-    tokenList.clear();
-    tokenize( buffer, tokenList );
-    int numColumns = tokenList.size();
+  int const numLinesBlock = 262144;
+  for( int iline = 0; iline < myParser->numLines(); iline++ ) {
+    if( iline % numLinesBlock == 0 ) {
+      myParser->parseColumns( iline, std::min( numLinesBlock, myParser->numLines() - iline ) );
+    }
+    int numColumns = myParser->numTokens( iline );
     if( numColumns > maxTableColumns ) maxTableColumns = numColumns;
     if( numColumns == 0 ) continue;  // Assume blank line, do nothing
-    else if( tokenList.at(0)[0] == '#') continue; // Comment line, do nothing
     else if( numColumns <= maxColumnIndex ) continue;
+    else {
+      char const* tokenStart;
+      int tokenLength;
+      csASCIIParser::token( myParser->line(iline), myParser->lineLength(iline), 0, &tokenStart, &tokenLength );
+      if( tokenLength > 0 && tokenStart[0] == '#' ) continue; // Comment line, do nothing
+    }
 
     // Extract key values
     if( myNumAllKeys > 0 ) {
       bool isSame = true;
       for( int ikey = 0; ikey < myNumAllKeys; ikey++ ) {
-        keysNew[ikey] = atof(tokenList.at( myKeyAllCols[ikey] ).c_str());
+        keysNew[ikey] = myParser->value( iline, ikey );
         if( keysNew[ikey] != keysCurrent[ikey] ) isSame = false;
       }
       if( !isSame ) {  // Key value in current line differs from key value in previous line --> Store values up to this point under previous key
@@ -313,15 +369,15 @@ no matching function for call to 'cseis_geolib::csTimeFunction<double>::set(csei
     } // End: Extract key values
     
     for( int ival = 0; ival < myNumValues; ival++ ) {
-      valueList[ival].insertEnd( atof(tokenList.at( myValueColumns[ival] ).c_str()) );
+      valueList[ival].insertEnd( myParser->value( iline, myNumAllKeys+ival ) );
     }
     if( myTableType == TABLE_TYPE_TIME_FUNCTION ) {
-      timeList.insertEnd( atof(tokenList.at(myIndexTimeCol).c_str()) );
+      timeList.insertEnd( myParser->value( iline, numParseColumns-1 ) );
       //      valueListTime.insertEnd( atof(tokenList.at( myValueColumns[0] ).c_str()) );
     }
 
     counterLines++;
-  }  // end while reading lines from input file
+  }  // end loop over lines in input file
 
   //  if( myTableType != TABLE_TYPE_TIME_FUNCTION ) {
     if( valueList[0].size() == 0 ) {
@@ -334,8 +390,8 @@ no matching function for call to 'cseis_geolib::csTimeFunction<double>::set(csei
     //  }
     //  }
 
-  fclose( myFile );
-  myFile = NULL;
+  delete myParser;
+  myParser = NULL;
 
   //-------------------------------------------------------
   //
@@ -410,6 +466,12 @@ no matching function for call to 'cseis_geolib::csTimeFunction<double>::set(csei
       myTimeFunctions2D[i] = timeFunctionList.at(i);
     }
     myCurrentTimeFunction->resetNumSpatialValues( myNumValues );
+    if( myFunctionCacheSize > 0 ) {
+      myFunctionCache = new csTimeFunctionCache<double>( myNumAllKeys, myFunctionCacheSize );
+    }
+  }
+  if( myNumAllKeys > 0 ) {
+    buildKeyIndex();
   }
 
   if( valueList != NULL ) delete [] valueList;
@@ -440,12 +502,85 @@ double csTableNew::getKeyValue( int indexLocation, int indexKey ) const {
   }
 }
 
+//-----------------------------------------------------------------------------------
+// Build key index:
+// - Check whether non-interpolated keys are sorted, allowing binary search for exact key locations
+// - For each key and location, store first and last location with the same key value
+//
+void csTableNew::buildKeyIndex() {
+  myIsKeySorted = true;
+  for( int iloc = 1; iloc < myNumLocations && myIsKeySorted; iloc++ ) {
+    for( int ikey = 0; ikey < myNumKeys; ikey++ ) {
+      if( myKeyValues[ikey][iloc] > myKeyValues[ikey][iloc-1] ) break;
+      if( myKeyValues[ikey][iloc] < myKeyValues[ikey][iloc-1] ) {
+        myIsKeySorted = false;
+        break;
+      }
+    }
+  }
+
+  myKeyRunStart = new int*[myNumAllKeys];
+  myKeyRunEnd   = new int*[myNumAllKeys];
+  for( int ikey = 0; ikey < myNumAllKeys; ikey++ ) {
+    double const* keyValues = myKeyValues[ikey];
+    int* runStart = new int[myNumLocations];
+    int* runEnd   = new int[myNumLocations];
+    runStart[0] = 0;
+    for( int iloc = 1; iloc < myNumLocations; iloc++ ) {
+      runStart[iloc] = ( keyValues[iloc] == keyValues[iloc-1] ) ? runStart[iloc-1] : iloc;
+    }
+    runEnd[myNumLocations-1] = myNumLocations-1;
+    for( int iloc = myNumLocations-2; iloc >= 0; iloc-- ) {
+      runEnd[iloc] = ( keyValues[iloc] == keyValues[iloc+1] ) ? runEnd[iloc+1] : iloc;
+    }
+    myKeyRunStart[ikey] = runStart;
+    myKeyRunEnd[ikey]   = runEnd;
+  }
+}
+
 //-----------------------------------------------------------------------------------
 // Find exact key values (non-interpolated keys only)
-// Assumes that keys are all sorted with increasing order
 // Reminder: Non-interpolated keys come first, in fields keyValues_in and myKeyValues 
+// Binary search within the range of locations matching all previous keys. Requires sorted keys,
+// otherwise fall back to linear search.
 //
 bool csTableNew::findExactKeyLocation( double const* keyValues_in, int& locStart, int& locEnd ) const {
+  if( !myIsKeySorted ) {
+    return findExactKeyLocation_linear( keyValues_in, locStart, locEnd );
+  }
+  int locFirst = 0;
+  int locLast  = myNumLocations-1;
+  for( int ikey = 0; ikey < myNumKeys; ikey++ ) {
+    double const* keyValues = myKeyValues[ikey];
+    double currentKeyValue  = keyValues_in[ikey];
+    int locLow  = locFirst;
+    int locHigh = locLast + 1;
+    while( locLow < locHigh ) {
+      int locMid = (locLow + locHigh) / 2;
+      if( keyValues[locMid] < currentKeyValue ) {
+        locLow = locMid + 1;
+      }
+      else {
+        locHigh = locMid;
+      }
+    }
+    if( locLow > locLast || keyValues[locLow] != currentKeyValue ) {
+      locStart = -1;
+      locEnd   = -1;
+      return false;
+    }
+    locFirst = locLow;
+    locLast  = std::min( locLast, myKeyRunEnd[ikey][locLow] );
+  }
+  locStart = locFirst;
+  locEnd   = locLast;
+  return true;
+}
+//-----------------------------------------------------------------------------------
+// Find exact key values (non-interpolated keys only), linear search
+// Assumes that keys are all sorted with increasing order
+//
+bool csTableNew::findExactKeyLocation_linear( double const* keyValues_in, int& locStart, int& locEnd ) const {
   locStart = -1;
   locEnd   = -1;
   int startLocationIndex = 0;
@@ -562,12 +697,8 @@ void csTableNew::findInterpKeyLocation2D( double const* keyValues_in,
   int loc1 = locLeftUp;
   int loc2 = locRightDown;
   // Widen the field of search for the second key: Extend left/right key locations to locations with same first key value
-  while( locLeftUp > locStart && myKeyValues[keyIndex1][locLeftUp] == myKeyValues[keyIndex1][locLeftUp-1] ) {
-    locLeftUp -= 1;
-  }
-  while( locRightDown < locEnd && myKeyValues[keyIndex1][locRightDown] == myKeyValues[keyIndex1][locRightDown+1] ) {
-    locRightDown += 1;
-  }
+  locLeftUp    = std::max( locStart, myKeyRunStart[keyIndex1][locLeftUp] );
+  locRightDown = std::min( locEnd, myKeyRunEnd[keyIndex1][locRightDown] );
 
   // First interpolation key value is constant over the range of possible locations
   // --> Simply search for second key value
@@ -812,6 +943,33 @@ void csTableNew::dump() const {
 //
 //
 csTimeFunction<double> const* csTableNew::getFunction( double const* keyValues_in, bool dump ) const {
+  csTimeFunction<double> const* cachedTimeFunc = NULL;
+  if( myFunctionCache != NULL ) {
+    cachedTimeFunc = myFunctionCache->get( keyValues_in );
+  }
+  if( cachedTimeFunc != NULL ) {
+    myCurrentTimeFunction->set( cachedTimeFunc );
+  }
+  else {
+    interpolateFunction( keyValues_in );
+    if( myFunctionCache != NULL ) {
+      myFunctionCache->put( keyValues_in, myCurrentTimeFunction );
+    }
+  }
+
+  if( dump ) {
+    for(int i = 0; i < myCurrentTimeFunction->numValues(); i++ ) {
+      for( int ikey = 0; ikey < myNumAllKeys; ikey++ ) {
+	fprintf(stdout,"%f ", keyValues_in[ikey] );
+      }
+      fprintf(stdout,"%f %f\n",myCurrentTimeFunction->timeAtIndex( i ), myCurrentTimeFunction->valueAtIndex( i ) );
+    }
+  }
+
+  return myCurrentTimeFunction;
+}
+
+void csTableNew::interpolateFunction( double const* keyValues_in ) const {
   int locLeft    = 0;
   int locRight   = myNumLocations-1;
   double weightLoc = 1.0;
@@ -854,17 +1012,6 @@ csTimeFunction<double> const* csTableNew::getFunction( double const* keyValues_i
   } // END if myNumAllKeys > 0
 
   interpolateTimeFunction( timeFuncLeft, timeFuncRight, weightLoc, myCurrentTimeFunction );
-
-  if( dump ) {
-    for(int i = 0; i < myCurrentTimeFunction->numValues(); i++ ) {
-      for( int ikey = 0; ikey < myNumAllKeys; ikey++ ) {
-	fprintf(stdout,"%f ", keyValues_in[ikey] );
-      }
-      fprintf(stdout,"%f %f\n",myCurrentTimeFunction->timeAtIndex( i ), myCurrentTimeFunction->valueAtIndex( i ) );
-    }
-  }
-
-  return myCurrentTimeFunction;
 }
 
 void csTableNew::interpolateTimeFunction( csTimeFunction<double> const* timeFuncLeft, csTimeFunction<double> const* timeFuncRight,
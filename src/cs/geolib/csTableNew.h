@@ -12,7 +12,9 @@
 namespace cseis_geolib {
 
   template<typename T> class csTimeFunction;
+  template<typename T> class csTimeFunctionCache;
   template <typename T> class csVector;
+  class csASCIIParser;
 
 /**
 * CSEIS ASCII Table - Base class
@@ -53,6 +55,7 @@ public:
   static const int TABLE_TYPE_UNIQUE_KEYS    = 3;
 
   static const char KEY_CHAR = '@';
+  static const int DEFAULT_FUNCTION_CACHE_SIZE = 16;
 
 public:
   csTableNew( int tableType );
@@ -122,7 +125,26 @@ public:
 
   //---------------------------------------------------------
   // Time function
+  /**
+   * Retrieve time function interpolated at given key location.
+   * Interpolated functions are cached (LRU). The returned pointer remains valid until the next call to this method.
+   * @param keyValues  Array containing key values
+   * @return Interpolated time function
+   */
   virtual csTimeFunction<double> const* getFunction( double const* keyValues, bool dump = false ) const;
+  /**
+   * Set maximum number of interpolated time functions kept in cache. Default: DEFAULT_FUNCTION_CACHE_SIZE
+   * Call before initialize(). Set to 0 to disable caching.
+   */
+  void setFunctionCacheSize( int numFunctions );
+  /**
+   * @return Number of getFunction() calls served from the time function cache
+   */
+  long numFunctionCacheHits() const;
+  /**
+   * @return Number of getFunction() calls that required interpolation of the time function
+   */
+  long numFunctionCacheMisses() const;
   virtual double getTimeValue( double const* keyValues, double time ) const;
   void interpolateTimeFunction( csTimeFunction<double> const* timeFuncLeft, csTimeFunction<double> const* timeFuncRight,
 				double weightLoc, csTimeFunction<double>* newTimeFunction ) const;
@@ -147,8 +169,8 @@ public:
 protected:
   /// Table input file name
   std::string myFilename;
-  /// Table input file stream
-  std::FILE* myFile;
+  /// Table input file parser
+  csASCIIParser* myParser;
   /// Type of table
   int myTableType;
   /// Data type of each column (for example TYPE_DOUBLE, TYPE_INT, TYPE_STRING...)
@@ -192,6 +214,18 @@ protected:
   double interpolate( int valueIndex, double const* keyValues_in ) const;
   void clearBuffers();
   void addData_internal( cseis_geolib::csVector<double>* valueList );
+  void buildKeyIndex();
+  bool findExactKeyLocation_linear( double const* keyValues_in, int& locStart, int& locEnd ) const;
+
+  //------------------------------------------------------------------------------------
+  // Key index, built once after table contents have been read in
+  //
+  /// true if non-interpolated keys are sorted in increasing order --> Exact key locations can be found by binary search
+  bool myIsKeySorted;
+  /// First location of run of identical key values, for each key and location
+  int** myKeyRunStart;
+  /// Last location of run of identical key values, for each key and location
+  int** myKeyRunEnd;
 
   //------------------------------------------------------------------------------------
   // Time function
@@ -200,9 +234,14 @@ protected:
   /// Values at each knee point of each location, including time values
   csTimeFunction<double>** myTimeFunctions2D;
   csTimeFunction<double>* myCurrentTimeFunction;
+  /// Cache of already interpolated time functions
+  csTimeFunctionCache<double>* myFunctionCache;
+  int myFunctionCacheSize;
   /// Index of time column
   int myIndexTimeCol;
   double interpolateTimeFunction( double const* keyValues_in, double time ) const;
+  /// Interpolate time function at given key location, store result in myCurrentTimeFunction
+  void interpolateFunction( double const* keyValues_in ) const;
 };
 
 } // end namespace
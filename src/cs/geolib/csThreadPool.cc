@@ -0,0 +1,136 @@
+/* Copyright (c) Colorado School of Mines, 2013.*/
+/* All rights reserved.                       */
+
+#include "csThreadPool.h"
+#include "csException.h"
+
+extern "C" {
+  #include <unistd.h>
+}
+
+using namespace cseis_geolib;
+
+csRunnable::csRunnable() {
+  myNext     = NULL;
+  myIsDone   = false;
+  myHasError = false;
+}
+csRunnable::~csRunnable() {
+}
+void csRunnable::execute() {
+  try {
+    run();
+  }
+  catch( csException& e ) {
+    myHasError = true;
+    myErrorMessage = e.getMessage();
+  }
+  catch( ... ) {
+    myHasError = true;
+    myErrorMessage = "Unknown exception in worker thread";
+  }
+}
+
+//--------------------------------------------------------------------------------
+//
+csThreadPool::csThreadPool( int numThreads ) {
+  myNumThreads = numThreads > 0 ? numThreads : numProcessors();
+  myQueueHead  = NULL;
+  myQueueTail  = NULL;
+  myNumPending = 0;
+  myIsShutdown = false;
+  pthread_mutex_init( &myMutex, NULL );
+  pthread_cond_init( &myCondTask, NULL );
+  pthread_cond_init( &myCondDone, NULL );
+
+  myThreads = new pthread_t[myNumThreads];
+  for( int ithread = 0; ithread < myNumThreads; ithread++ ) {
+    if( pthread_create( &myThreads[ithread], NULL, csThreadPool::threadFunction, this ) != 0 ) {
+      myNumThreads = ithread;
+      break;
+    }
+  }
+  if( myNumThreads == 0 ) {
+    delete [] myThreads;
+    myThreads = NULL;
+    pthread_cond_destroy( &myCondDone );
+    pthread_cond_destroy( &myCondTask );
+    pthread_mutex_destroy( &myMutex );
+    throw( csException("csThreadPool: Failed to create worker threads") );
+  }
+}
+csThreadPool::~csThreadPool() {
+  pthread_mutex_lock( &myMutex );
+  myIsShutdown = true;
+  pthread_cond_broadcast( &myCondTask );
+  pthread_mutex_unlock( &myMutex );
+  for( int ithread = 0; ithread < myNumThreads; ithread++ ) {
+    pthread_join( myThreads[ithread], NULL );
+  }
+  delete [] myThreads;
+  myThreads = NULL;
+  pthread_cond_destroy( &myCondDone );
+  pthread_cond_destroy( &myCondTask );
+  pthread_mutex_destroy( &myMutex );
+}
+int csThreadPool::numProcessors() {
+  long nproc = sysconf( _SC_NPROCESSORS_ONLN );
+  return( nproc > 0 ? (int)nproc : 1 );
+}
+void csThreadPool::submit( csRunnable* task ) {
+  pthread_mutex_lock( &myMutex );
+  task->myNext     = NULL;
+  task->myIsDone   = false;
+  task->myHasError = false;
+  task->myErrorMessage.clear();
+  if( myQueueTail != NULL ) {
+    myQueueTail->myNext = task;
+  }
+  else {
+    myQueueHead = task;
+  }
+  myQueueTail = task;
+  myNumPending += 1;
+  pthread_cond_signal( &myCondTask );
+  pthread_mutex_unlock( &myMutex );
+}
+void csThreadPool::wait( csRunnable* task ) {
+  pthread_mutex_lock( &myMutex );
+  while( !task->myIsDone ) {
+    pthread_cond_wait( &myCondDone, &myMutex );
+  }
+  pthread_mutex_unlock( &myMutex );
+}
+void csThreadPool::waitAll() {
+  pthread_mutex_lock( &myMutex );
+  while( myNumPending > 0 ) {
+    pthread_cond_wait( &myCondDone, &myMutex );
+  }
+  pthread_mutex_unlock( &myMutex );
+}
+void* csThreadPool::threadFunction( void* arg ) {
+  reinterpret_cast<csThreadPool*>( arg )->workerLoop();
+  return NULL;
+}
+void csThreadPool::workerLoop() {
+  pthread_mutex_lock( &myMutex );
+  while( true ) {
+    while( myQueueHead == NULL && !myIsShutdown ) {
+      pthread_cond_wait( &myCondTask, &myMutex );
+    }
+    // Drain queue before shutting down, so that no caller is left waiting for a task that never runs
+    if( myQueueHead == NULL ) break;
+    csRunnable* task = myQueueHead;
+    myQueueHead = task->myNext;
+    if( myQueueHead == NULL ) myQueueTail = NULL;
+    pthread_mutex_unlock( &myMutex );
+
+    task->execute();
+
+    pthread_mutex_lock( &myMutex );
+    task->myIsDone = true;
+    myNumPending -= 1;
+    pthread_cond_broadcast( &myCondDone );
+  }
+  pthread_mutex_unlock( &myMutex );
+}
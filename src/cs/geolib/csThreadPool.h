@@ -0,0 +1,88 @@
+/* Copyright (c) Colorado School of Mines, 2013.*/
+/* All rights reserved.                       */
+
+#ifndef CS_THREAD_POOL_H
+#define CS_THREAD_POOL_H
+
+#include <string>
+
+extern "C" {
+  #include <pthread.h>
+}
+
+namespace cseis_geolib {
+
+class csThreadPool;
+
+/**
+ * Unit of work executed by csThreadPool
+ *
+ * Derived classes implement run(). A csException thrown from run() is caught by the worker thread
+ * and made available through errorMessage().
+ *
+ * @author Bjorn Olofsson
+ * @date 2013
+ */
+class csRunnable {
+public:
+  csRunnable();
+  virtual ~csRunnable();
+  virtual void run() = 0;
+  /// @return true if run() has completed (successfully or not)
+  bool isDone() const { return myIsDone; }
+  /// @return true if run() terminated with an exception
+  bool hasError() const { return myHasError; }
+  char const* errorMessage() const { return myErrorMessage.c_str(); }
+private:
+  friend class csThreadPool;
+  void execute();
+  csRunnable* myNext;
+  bool myIsDone;
+  bool myHasError;
+  std::string myErrorMessage;
+};
+
+/**
+ * Fixed size pool of worker threads
+ *
+ * Tasks are executed in the order in which they were submitted. Tasks are not owned by the pool:
+ * The caller must keep a submitted task alive until wait() has returned for this task.
+ *
+ * @author Bjorn Olofsson
+ * @date 2013
+ */
+class csThreadPool {
+public:
+  /**
+   * @param numThreads Number of worker threads. Pass 0 to use the number of online processors.
+   */
+  csThreadPool( int numThreads );
+  ~csThreadPool();
+  void submit( csRunnable* task );
+  /// Block until given task has completed
+  void wait( csRunnable* task );
+  /// Block until all submitted tasks have completed
+  void waitAll();
+  int numThreads() const { return myNumThreads; }
+  /// @return Number of processors online, or 1 if this cannot be determined
+  static int numProcessors();
+
+private:
+  static void* threadFunction( void* arg );
+  void workerLoop();
+
+  int myNumThreads;
+  pthread_t* myThreads;
+  pthread_mutex_t myMutex;
+  /// Signalled when a task is added to the queue, or on shutdown
+  pthread_cond_t myCondTask;
+  /// Signalled when a task has completed
+  pthread_cond_t myCondDone;
+  csRunnable* myQueueHead;
+  csRunnable* myQueueTail;
+  int myNumPending;
+  bool myIsShutdown;
+};
+
+} // namespace
+#endif
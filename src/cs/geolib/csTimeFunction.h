@@ -90,7 +90,7 @@ template<typename T> inline double csTimeFunction<T>::timeAtIndex( int timeIndex
 template<typename T> void csTimeFunction<T>::set( csTimeFunction<T> const* timeFunc ) {
   resetNumSpatialValues( timeFunc->numSpatialValues() );
   resetBuffer( timeFunc->numValues() );
-  std::memcpy( myTimeBuffer, timeFunc->myTimeBuffer, sizeof(T)*myNumValues );
+  std::memcpy( myTimeBuffer, timeFunc->myTimeBuffer, sizeof(double)*myNumValues );
   for( int i = 0; i < myNumSpatialValues; i++ ) {
     T const* valuesIn = timeFunc->myValueList->at(i);
     T* valuesOut = myValueList->at(i);
@@ -147,15 +147,18 @@ template<typename T> inline T csTimeFunction<T>::valueAt( double time, int spati
   }
   // Linear interpolation
   else {
-    int topIndex = -1;
-    // Temp, slow 'find' method for correct index... !CHANGE!
-    for( int i = 1; i < myNumValues; i++ ) {
-      if( myTimeBuffer[i] >= time ) {
-        topIndex = i-1;
-        break;
+    // Binary search for first time >= specified time
+    int bottomIndex = myNumValues-1;
+    int topIndex    = 0;
+    while( bottomIndex - topIndex > 1 ) {
+      int midIndex = (topIndex + bottomIndex) / 2;
+      if( myTimeBuffer[midIndex] >= time ) {
+        bottomIndex = midIndex;
+      }
+      else {
+        topIndex = midIndex;
       }
     }
-    int bottomIndex = topIndex+1;
     double weight = (time-myTimeBuffer[topIndex]) / (myTimeBuffer[bottomIndex]-myTimeBuffer[topIndex]);
     return( (T)( (double)values[topIndex] + weight*( values[bottomIndex] - values[topIndex] ) ) );
   }
@@ -0,0 +1,149 @@
+/* Copyright (c) Colorado School of Mines, 2013.*/
+/* All rights reserved.                       */
+
+#ifndef CS_TIME_FUNCTION_CACHE_H
+#define CS_TIME_FUNCTION_CACHE_H
+
+#include <cstring>
+#include "csTimeFunction.h"
+
+namespace cseis_geolib {
+
+/**
+ * LRU cache of interpolated time functions, keyed by table key values
+ *
+ * Consecutive traces of the same CMP/shot request the time function at identical key locations.
+ * The cache keeps a small number of already interpolated functions so that these requests do not
+ * have to redo the table look-up and interpolation.
+ * Cached functions are owned by the cache. A pointer returned by get() remains valid until the next call to put().
+ *
+ * @author Bjorn Olofsson
+ * @date 2013
+ */
+template <typename T>
+class csTimeFunctionCache {
+public:
+  csTimeFunctionCache( int numKeys, int capacity );
+  ~csTimeFunctionCache();
+  /**
+   * @param keyValues Key values of requested location
+   * @return Cached time function at this location, or NULL if location is not cached
+   */
+  csTimeFunction<T> const* get( double const* keyValues );
+  /**
+   * Store copy of time function. Replaces least recently used entry if cache is full.
+   * @param keyValues Key values of location
+   * @param timeFunc  Time function at this location
+   */
+  void put( double const* keyValues, csTimeFunction<T> const* timeFunc );
+  void clear();
+  inline int capacity() const { return myCapacity; }
+  inline int numEntries() const { return myNumEntries; }
+  inline long numHits() const { return myNumHits; }
+  inline long numMisses() const { return myNumMisses; }
+
+private:
+  bool isMatch( int index, double const* keyValues ) const;
+  int myNumKeys;
+  int myCapacity;
+  int myNumEntries;
+  /// Index of last accessed entry. Checked first.
+  int myLastIndex;
+  /// Key values of all cached entries, myNumKeys values per entry
+  double* myKeyValues;
+  csTimeFunction<T>** myFunctions;
+  /// 'Time stamp' of last access, for each entry
+  long* myLastAccess;
+  long myAccessCounter;
+  long myNumHits;
+  long myNumMisses;
+};
+
+template<typename T>csTimeFunctionCache<T>::csTimeFunctionCache( int numKeys, int capacity ) {
+  myNumKeys    = numKeys;
+  myCapacity   = capacity > 0 ? capacity : 1;
+  myNumEntries = 0;
+  myLastIndex  = 0;
+  myAccessCounter = 0;
+  myNumHits    = 0;
+  myNumMisses  = 0;
+  myKeyValues  = new double[myCapacity*(myNumKeys > 0 ? myNumKeys : 1)];
+  myFunctions  = new csTimeFunction<T>*[myCapacity];
+  myLastAccess = new long[myCapacity];
+  for( int i = 0; i < myCapacity; i++ ) {
+    myFunctions[i]  = NULL;
+    myLastAccess[i] = 0;
+  }
+}
+template<typename T>csTimeFunctionCache<T>::~csTimeFunctionCache() {
+  clear();
+  if( myFunctions != NULL ) {
+    delete [] myFunctions;
+    myFunctions = NULL;
+  }
+  if( myKeyValues != NULL ) {
+    delete [] myKeyValues;
+    myKeyValues = NULL;
+  }
+  if( myLastAccess != NULL ) {
+    delete [] myLastAccess;
+    myLastAccess = NULL;
+  }
+}
+template<typename T> void csTimeFunctionCache<T>::clear() {
+  for( int i = 0; i < myCapacity; i++ ) {
+    if( myFunctions[i] != NULL ) {
+      delete myFunctions[i];
+      myFunctions[i] = NULL;
+    }
+    myLastAccess[i] = 0;
+  }
+  myNumEntries = 0;
+  myLastIndex  = 0;
+}
+template<typename T> inline bool csTimeFunctionCache<T>::isMatch( int index, double const* keyValues ) const {
+  double const* keysCached = &myKeyValues[index*myNumKeys];
+  for( int ikey = 0; ikey < myNumKeys; ikey++ ) {
+    if( keysCached[ikey] != keyValues[ikey] ) return false;
+  }
+  return true;
+}
+template<typename T> csTimeFunction<T> const* csTimeFunctionCache<T>::get( double const* keyValues ) {
+  myAccessCounter += 1;
+  if( myNumEntries > 0 && isMatch( myLastIndex, keyValues ) ) {
+    myLastAccess[myLastIndex] = myAccessCounter;
+    myNumHits += 1;
+    return myFunctions[myLastIndex];
+  }
+  for( int i = 0; i < myNumEntries; i++ ) {
+    if( isMatch( i, keyValues ) ) {
+      myLastIndex     = i;
+      myLastAccess[i] = myAccessCounter;
+      myNumHits += 1;
+      return myFunctions[i];
+    }
+  }
+  myNumMisses += 1;
+  return NULL;
+}
+template<typename T> void csTimeFunctionCache<T>::put( double const* keyValues, csTimeFunction<T> const* timeFunc ) {
+  int index = 0;
+  if( myNumEntries < myCapacity ) {
+    index = myNumEntries++;
+    myFunctions[index] = new csTimeFunction<T>( timeFunc->numSpatialValues() );
+  }
+  else {
+    // Replace least recently used entry
+    for( int i = 1; i < myCapacity; i++ ) {
+      if( myLastAccess[i] < myLastAccess[index] ) index = i;
+    }
+  }
+  if( myNumKeys > 0 ) memcpy( &myKeyValues[index*myNumKeys], keyValues, myNumKeys*sizeof(double) );
+  myFunctions[index]->set( timeFunc );
+  myAccessCounter += 1;
+  myLastAccess[index] = myAccessCounter;
+  myLastIndex = index;
+}
+
+} // namespace
+#endif
@@ -0,0 +1,219 @@
+/* Copyright (c) Colorado School of Mines, 2013.*/
+/* All rights reserved.                       */
+
+#include "csTransposeBuffer.h"
+#include "csVector.h"
+#include "csException.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef PLATFORM_WINDOWS
+#include <io.h>
+#else
+extern "C" {
+  #include <unistd.h>
+}
+#endif
+
+using namespace cseis_geolib;
+
+namespace {
+  /// Maximum byte size of one staged chunk. Large sequential writes, but small enough to stay in the page cache
+  int const MAX_CHUNK_BYTE_SIZE = 1024*1024;
+}
+
+csTransposeBuffer::csTransposeBuffer( int numRows, int numColumns, csInt64_t maxMemoryByteSize, std::string const& tempDir ) {
+  myNumRows    = numRows > 0 ? numRows : 1;
+  myNumColumns = numColumns > 0 ? numColumns : 1;
+  myBlock      = NULL;
+  myCurrentBlockIndex = -1;
+  myIsReading  = false;
+  myChunk      = NULL;
+  myNumRecordsInChunk  = NULL;
+  myMaxNumRecordsChunk = 0;
+  myChunkOffsetList     = NULL;
+  myChunkNumRecordsList = NULL;
+  myFileSize = 0;
+  myFile     = NULL;
+
+  csInt64_t byteSizeRow = (csInt64_t)myNumColumns * (csInt64_t)sizeof(float);
+  if( (csInt64_t)myNumRows * byteSizeRow <= maxMemoryByteSize ) {
+    myNumRowsBlock = myNumRows;
+    myNumBlocks    = 1;
+  }
+  else {
+    // Half of the memory holds one block of rows, the other half holds the staged chunks
+    csInt64_t numRowsBlock = ( maxMemoryByteSize / 2 ) / byteSizeRow;
+    myNumRowsBlock = numRowsBlock > 1 ? (int)numRowsBlock : 1;
+    myNumBlocks    = ( myNumRows + myNumRowsBlock - 1 ) / myNumRowsBlock;
+  }
+  myBlock = new float[(size_t)myNumRowsBlock * (size_t)myNumColumns];
+  memset( myBlock, 0, (size_t)myNumRowsBlock * (size_t)myNumColumns * sizeof(float) );
+
+  if( myNumBlocks == 1 ) {
+    myCurrentBlockIndex = 0;
+    return;
+  }
+
+  int byteSizeRecord = (int)sizeof(int) + myNumRowsBlock * (int)sizeof(float);
+  csInt64_t byteSizeChunk = ( maxMemoryByteSize / 2 ) / myNumBlocks;
+  if( byteSizeChunk > MAX_CHUNK_BYTE_SIZE ) byteSizeChunk = MAX_CHUNK_BYTE_SIZE;
+  myMaxNumRecordsChunk = (int)( byteSizeChunk / byteSizeRecord );
+  if( myMaxNumRecordsChunk < 1 ) myMaxNumRecordsChunk = 1;
+
+  myChunk = new char*[myNumBlocks];
+  myNumRecordsInChunk   = new int[myNumBlocks];
+  myChunkOffsetList     = new csVector<csInt64_t>*[myNumBlocks];
+  myChunkNumRecordsList = new csVector<int>*[myNumBlocks];
+  for( int iblock = 0; iblock < myNumBlocks; iblock++ ) {
+    myChunk[iblock] = new char[(size_t)myMaxNumRecordsChunk * (size_t)byteSizeRecord];
+    myNumRecordsInChunk[iblock]   = 0;
+    myChunkOffsetList[iblock]     = new csVector<csInt64_t>();
+    myChunkNumRecordsList[iblock] = new csVector<int>();
+  }
+  openTempFile( tempDir );
+}
+csTransposeBuffer::~csTransposeBuffer() {
+  if( myBlock != NULL ) {
+    delete [] myBlock;
+    myBlock = NULL;
+  }
+  if( myChunk != NULL ) {
+    for( int iblock = 0; iblock < myNumBlocks; iblock++ ) {
+      delete [] myChunk[iblock];
+      delete myChunkOffsetList[iblock];
+      delete myChunkNumRecordsList[iblock];
+    }
+    delete [] myChunk;
+    delete [] myNumRecordsInChunk;
+    delete [] myChunkOffsetList;
+    delete [] myChunkNumRecordsList;
+    myChunk = NULL;
+  }
+  if( myFile != NULL ) {
+    myFile->close();
+    delete myFile;
+    myFile = NULL;
+    remove( myTempFilename.c_str() );
+  }
+}
+//--------------------------------------------------------------------
+void csTransposeBuffer::openTempFile( std::string const& tempDir ) {
+#ifdef PLATFORM_WINDOWS
+  char* name = _tempnam( tempDir.c_str(), "cseis_transpose_" );
+  if( name == NULL ) {
+    throw( csException("csTransposeBuffer: Cannot create temporary file in directory '%s'", tempDir.c_str()) );
+  }
+  myTempFilename = name;
+  free( name );
+#else
+  std::string nameTemplate = tempDir + "/cseis_transpose_XXXXXX";
+  char* name = new char[nameTemplate.length()+1];
+  strcpy( name, nameTemplate.c_str() );
+  int fd = mkstemp( name );
+  if( fd < 0 ) {
+    delete [] name;
+    throw( csException("csTransposeBuffer: Cannot create temporary file in directory '%s'", tempDir.c_str()) );
+  }
+  close( fd );
+  myTempFilename = name;
+  delete [] name;
+#endif
+  myFile = new std::fstream();
+  myFile->open( myTempFilename.c_str(), std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc );
+  if( myFile->fail() ) {
+    delete myFile;
+    myFile = NULL;
+    remove( myTempFilename.c_str() );
+    throw( csException("csTransposeBuffer: Cannot open temporary file '%s'", myTempFilename.c_str()) );
+  }
+}
+//--------------------------------------------------------------------
+int csTransposeBuffer::numRowsInBlock( int blockIndex ) const {
+  int firstRow = blockIndex * myNumRowsBlock;
+  return( firstRow + myNumRowsBlock <= myNumRows ? myNumRowsBlock : myNumRows - firstRow );
+}
+//--------------------------------------------------------------------
+void csTransposeBuffer::putColumn( int column, float const* values ) {
+  if( myIsReading ) {
+    throw( csException("csTransposeBuffer::putColumn: Cannot input further columns after first row has been retrieved") );
+  }
+  if( column < 0 || column >= myNumColumns ) {
+    throw( csException("csTransposeBuffer::putColumn: Column index out of range: %d (number of columns: %d)", column, myNumColumns) );
+  }
+  if( myNumBlocks == 1 ) {
+    for( int irow = 0; irow < myNumRows; irow++ ) {
+      myBlock[(size_t)irow*(size_t)myNumColumns + column] = values[irow];
+    }
+    return;
+  }
+  int byteSizeRecord = (int)sizeof(int) + myNumRowsBlock * (int)sizeof(float);
+  for( int iblock = 0; iblock < myNumBlocks; iblock++ ) {
+    char* record = &myChunk[iblock][(size_t)myNumRecordsInChunk[iblock] * (size_t)byteSizeRecord];
+    memcpy( record, &column, sizeof(int) );
+    memcpy( record + sizeof(int), &values[iblock*myNumRowsBlock], numRowsInBlock(iblock) * sizeof(float) );
+    myNumRecordsInChunk[iblock] += 1;
+    if( myNumRecordsInChunk[iblock] == myMaxNumRecordsChunk ) flushChunk( iblock );
+  }
+}
+//--------------------------------------------------------------------
+void csTransposeBuffer::flushChunk( int blockIndex ) {
+  int numRecords = myNumRecordsInChunk[blockIndex];
+  if( numRecords == 0 ) return;
+  int byteSizeRecord = (int)sizeof(int) + myNumRowsBlock * (int)sizeof(float);
+  csInt64_t byteSize = (csInt64_t)numRecords * (csInt64_t)byteSizeRecord;
+  myFile->seekp( (std::streamoff)myFileSize, std::ios_base::beg );
+  myFile->write( myChunk[blockIndex], (std::streamsize)byteSize );
+  if( myFile->fail() ) {
+    throw( csException("csTransposeBuffer: Error occurred when writing to temporary file '%s'. Disk full?", myTempFilename.c_str()) );
+  }
+  myChunkOffsetList[blockIndex]->insertEnd( myFileSize );
+  myChunkNumRecordsList[blockIndex]->insertEnd( numRecords );
+  myFileSize += byteSize;
+  myNumRecordsInChunk[blockIndex] = 0;
+}
+//--------------------------------------------------------------------
+void csTransposeBuffer::getRow( int row, float* values ) {
+  if( row < 0 || row >= myNumRows ) {
+    throw( csException("csTransposeBuffer::getRow: Row index out of range: %d (number of rows: %d)", row, myNumRows) );
+  }
+  if( !myIsReading ) {
+    myIsReading = true;
+    if( myNumBlocks > 1 ) {
+      for( int iblock = 0; iblock < myNumBlocks; iblock++ ) {
+        flushChunk( iblock );
+      }
+      myFile->flush();
+    }
+  }
+  int blockIndex = row / myNumRowsBlock;
+  if( blockIndex != myCurrentBlockIndex ) loadBlock( blockIndex );
+  memcpy( values, &myBlock[(size_t)(row - blockIndex*myNumRowsBlock) * (size_t)myNumColumns], myNumColumns * sizeof(float) );
+}
+//--------------------------------------------------------------------
+void csTransposeBuffer::loadBlock( int blockIndex ) {
+  memset( myBlock, 0, (size_t)myNumRowsBlock * (size_t)myNumColumns * sizeof(float) );
+  int numRows = numRowsInBlock( blockIndex );
+  int byteSizeRecord = (int)sizeof(int) + myNumRowsBlock * (int)sizeof(float);
+  // Staging memory is not needed any more: Re-use chunk buffer of this block for reading
+  char* chunk = myChunk[blockIndex];
+  for( int ichunk = 0; ichunk < myChunkOffsetList[blockIndex]->size(); ichunk++ ) {
+    int numRecords = myChunkNumRecordsList[blockIndex]->at(ichunk);
+    myFile->seekg( (std::streamoff)myChunkOffsetList[blockIndex]->at(ichunk), std::ios_base::beg );
+    myFile->read( chunk, (std::streamsize)numRecords * byteSizeRecord );
+    if( myFile->fail() ) {
+      throw( csException("csTransposeBuffer: Error occurred when reading from temporary file '%s'", myTempFilename.c_str()) );
+    }
+    for( int irec = 0; irec < numRecords; irec++ ) {
+      char const* record = &chunk[(size_t)irec * (size_t)byteSizeRecord];
+      int column;
+      memcpy( &column, record, sizeof(int) );
+      float const* valuesRecord = reinterpret_cast<float const*>( record + sizeof(int) );
+      for( int irow = 0; irow < numRows; irow++ ) {
+        myBlock[(size_t)irow*(size_t)myNumColumns + column] = valuesRecord[irow];
+      }
+    }
+  }
+  myCurrentBlockIndex = blockIndex;
+}
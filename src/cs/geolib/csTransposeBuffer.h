@@ -0,0 +1,90 @@
+/* Copyright (c) Colorado School of Mines, 2013.*/
+/* All rights reserved.                       */
+
+#ifndef CS_TRANSPOSE_BUFFER_H
+#define CS_TRANSPOSE_BUFFER_H
+
+#include <string>
+#include <fstream>
+#include "geolib_defines.h"
+
+namespace cseis_geolib {
+
+template <typename T> class csVector;
+
+/**
+ * Blocked out-of-core transpose of a 2D float array
+ *
+ * Values are input column by column, in any column order: One value for each row.
+ * Values are output row by row.
+ * If the whole array fits into the given memory size, it is held in memory. Otherwise, rows are split into blocks
+ * so that one block of rows fits into half the memory size. Input columns are split into one record per row block,
+ * which is staged in memory and appended to a temporary file in large chunks. On output, all chunks of one row
+ * block are read back and scattered into memory. Each value is thus written to and read from disk once.
+ * Rows are best retrieved in increasing order, since the row block in memory is reloaded whenever a row outside
+ * the current block is requested.
+ * Array values for which no column has been input are zero.
+ *
+ * @author Bjorn Olofsson
+ * @date 2013
+ */
+class csTransposeBuffer {
+public:
+  /**
+   * @param numRows        Number of rows
+   * @param numColumns     Number of columns
+   * @param maxMemoryByteSize  Maximum memory to use [bytes]
+   * @param tempDir        Directory for temporary file
+   */
+  csTransposeBuffer( int numRows, int numColumns, csInt64_t maxMemoryByteSize, std::string const& tempDir );
+  ~csTransposeBuffer();
+  /**
+   * Input values of one column
+   * @param column  Column index
+   * @param values  Values of all numRows rows
+   */
+  void putColumn( int column, float const* values );
+  /**
+   * Retrieve values of one row. No further columns can be input after the first call to this method.
+   * @param row     Row index
+   * @param values  (o) Values of all numColumns columns
+   */
+  void getRow( int row, float* values );
+  int numRows() const { return myNumRows; }
+  int numColumns() const { return myNumColumns; }
+  /// @return Number of rows held in memory at once
+  int numRowsBlock() const { return myNumRowsBlock; }
+  /// @return true if values are buffered in temporary file
+  bool isOutOfCore() const { return myNumBlocks > 1; }
+  std::string const& tempFilename() const { return myTempFilename; }
+
+private:
+  void openTempFile( std::string const& tempDir );
+  void flushChunk( int blockIndex );
+  void loadBlock( int blockIndex );
+  int numRowsInBlock( int blockIndex ) const;
+
+  int myNumRows;
+  int myNumColumns;
+  int myNumRowsBlock;
+  int myNumBlocks;
+  /// Rows of current block, myNumRowsBlock x myNumColumns
+  float* myBlock;
+  int myCurrentBlockIndex;
+  bool myIsReading;
+
+  /// Out-of-core only: Staged records for each row block. One record = column index + one value per row in block
+  char** myChunk;
+  int* myNumRecordsInChunk;
+  int myMaxNumRecordsChunk;
+  /// Out-of-core only: File offset and number of records of all chunks written for each row block
+  csVector<csInt64_t>** myChunkOffsetList;
+  csVector<int>** myChunkNumRecordsList;
+  csInt64_t myFileSize;
+  std::fstream* myFile;
+  std::string myTempFilename;
+};
+
+} // end namespace
+
+#endif
@@ -4,9 +4,12 @@
 #include "csGeneralSeismicReader.h"
 #include "csSeismicReader_ver.h"
 #include "csSeismicIOConfig.h"
+#include "csOverviewReader.h"
+#include "csOverviewWriter.h"
 #include "csHeaderInfo.h"
 #include "csException.h"
 #include "csGeolibUtils.h"
+#include "csFileUtils.h"
 
 #include "csSuperHeader.h"
 #include "csTraceHeaderDef.h"
@@ -26,6 +29,8 @@ csGeneralSeismicReader::csGeneralSeismicReader( std::string filename, bool enabl
   catch( cseis_geolib::csException& e ) {
     throw( cseis_geolib::csException( e.getMessage()) );
   }
+  myFilename = filename;
+  myOverviewReader = NULL;
   myConfig = new csSeismicIOConfig();
   myHdrValueBlock = NULL;
   myTraceBuffer   = NULL;
@@ -60,6 +65,10 @@ csGeneralSeismicReader::~csGeneralSeismicReader() {
     delete myReader;
     myReader = NULL;
   }
+  if( myOverviewReader != NULL ) {
+    delete myOverviewReader;
+    myOverviewReader = NULL;
+  }
   if( myConfig != NULL ) {
     delete myConfig;
     myConfig = NULL;
@@ -93,6 +102,7 @@ bool csGeneralSeismicReader::readFileHeader() {
   myFloatPtr = reinterpret_cast<float*>( myHdrValueBlock );
 
   setByteLocation();
+  openOverviews();
 
   myIsFileHeaderRead = true; 
   
@@ -229,6 +239,123 @@ bool csGeneralSeismicReader::readTrace( float* samples ) {
   return myReader->readTrace( samples, myHdrValueBlock );
 }
 
+int csGeneralSeismicReader::numSamplesDecimated( int sampleStep ) const {
+  if( sampleStep < 1 ) sampleStep = 1;
+  return( ( myConfig->numSamples + sampleStep - 1 ) / sampleStep );
+}
+
+int csGeneralSeismicReader::readTraces( int firstTraceIndex, int numTraces, int traceStep, int sampleStep, float* samples, char* hdrTable ) {
+  if( !myIsFileHeaderRead ) {
+    throw( cseis_geolib::csException("csGeneralSeismicReader::readTraces: File header has not been read. This is a program bug in the calling function") );
+  }
+  if( traceStep < 1 ) traceStep = 1;
+  if( sampleStep < 1 ) sampleStep = 1;
+  int numTracesFile = myReader->numTraces();
+  if( firstTraceIndex < 0 || firstTraceIndex >= numTracesFile || numTraces <= 0 ) return 0;
+  int numTracesAvailable = ( numTracesFile - firstTraceIndex + traceStep - 1 ) / traceStep;
+  if( numTraces > numTracesAvailable ) numTraces = numTracesAvailable;
+
+  int numSamples    = myConfig->numSamples;
+  int numSamplesOut = numSamplesDecimated( sampleStep );
+  int numHeaders    = numTraceHeaders();
+  if( sampleStep > 1 && myTraceBuffer == NULL ) {
+    myTraceBuffer = new float[numSamples];
+  }
+  // Consecutive traces: One move, then buffered reading. Decimated traces: Move to each trace
+  if( traceStep == 1 ) {
+    if( !myReader->moveToTrace( firstTraceIndex, numTraces ) ) return 0;
+  }
+  for( int itrc = 0; itrc < numTraces; itrc++ ) {
+    if( traceStep > 1 ) {
+      if( !myReader->moveToTrace( firstTraceIndex + itrc*traceStep, 1 ) ) return itrc;
+    }
+    float* samplesOut = &samples[(size_t)itrc*numSamplesOut];
+    if( sampleStep == 1 ) {
+      if( !myReader->readTrace( samplesOut, myHdrValueBlock ) ) return itrc;
+    }
+    else {
+      if( !myReader->readTrace( myTraceBuffer, myHdrValueBlock ) ) return itrc;
+      for( int isampOut = 0; isampOut < numSamplesOut; isampOut++ ) {
+        samplesOut[isampOut] = myTraceBuffer[isampOut*sampleStep];
+      }
+    }
+    if( hdrTable != NULL ) {
+      packHeaderValues( &hdrTable[(size_t)itrc*numHeaders*8] );
+    }
+  }
+  return numTraces;
+}
+
+void csGeneralSeismicReader::packHeaderValues( char* hdrSlots ) const {
+  int numHeaders = numTraceHeaders();
+  for( int ihdr = 0; ihdr < numHeaders; ihdr++ ) {
+    char* slot = &hdrSlots[ihdr*8];
+    switch( myConfig->headerInfo( ihdr )->type ) {
+      case cseis_geolib::TYPE_DOUBLE: {
+        double value = hdrDoubleValue( ihdr );
+        memcpy( slot, &value, 8 );
+        break;
+      }
+      case cseis_geolib::TYPE_FLOAT: {
+        double value = (double)hdrFloatValue( ihdr );
+        memcpy( slot, &value, 8 );
+        break;
+      }
+      case cseis_geolib::TYPE_INT64: {
+        csInt64_t value = hdrInt64Value( ihdr );
+        memcpy( slot, &value, 8 );
+        break;
+      }
+      case cseis_geolib::TYPE_STRING:
+        memset( slot, 0, 8 );
+        break;
+      default: {
+        csInt64_t value = (csInt64_t)hdrIntValue( ihdr );
+        memcpy( slot, &value, 8 );
+        break;
+      }
+    }
+  }
+}
+
+//--------------------------------------------------------------------
+void csGeneralSeismicReader::openOverviews() {
+  std::string filename = csOverviewWriter::filename( myFilename );
+  if( !cseis_geolib::csFileUtils::fileExists( filename ) ) return;
+  try {
+    myOverviewReader = new csOverviewReader( filename );
+    // Only use overview file if it was written together with current version of seismic file
+    if( myOverviewReader->numTraces() != myConfig->numTraces || myOverviewReader->numSamples() != myConfig->numSamples ||
+        myOverviewReader->seismicFileSize() != cseis_geolib::csFileUtils::retrieveFileSize( myFilename ) ) {
+      delete myOverviewReader;
+      myOverviewReader = NULL;
+    }
+  }
+  catch( cseis_geolib::csException& e ) {
+    myOverviewReader = NULL;
+  }
+}
+int csGeneralSeismicReader::numOverviewLevels() const {
+  return( myOverviewReader != NULL ? myOverviewReader->numLevels() : 0 );
+}
+int csGeneralSeismicReader::overviewTraceStep( int level ) const {
+  return myOverviewReader->traceStep( level );
+}
+int csGeneralSeismicReader::overviewSampleStep( int level ) const {
+  return myOverviewReader->sampleStep( level );
+}
+int csGeneralSeismicReader::overviewNumSamples( int level ) const {
+  return myOverviewReader->numSamples( level );
+}
+int csGeneralSeismicReader::findOverviewLevel( int traceStep, int sampleStep ) const {
+  if( myOverviewReader == NULL ) return -1;
+  return myOverviewReader->findLevel( traceStep, sampleStep );
+}
+int csGeneralSeismicReader::readOverview( int level, int firstTraceIndex, int numTraces, float* minValues, float* maxValues, float* rmsValues ) {
+  if( myOverviewReader == NULL ) return 0;
+  return myOverviewReader->readWindow( level, firstTraceIndex, numTraces, minValues, maxValues, rmsValues );
+}
+
 bool csGeneralSeismicReader::performIOSelection() {
   bool success = false;
   int traceIndex = myIOSelection->getNextTraceIndex();
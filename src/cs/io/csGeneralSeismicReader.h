@@ -23,6 +23,7 @@ namespace cseis_system {
 namespace cseis_io {
   class csSeismicReader_ver;
   class csSeismicIOConfig;
+  class csOverviewReader;
 
 /**
  * General seismic file reader, Cseis format
@@ -40,6 +41,54 @@ public:
   bool moveToTrace( int traceIndex );
   float const* readTraceReturnPointer();
   bool readTrace( float* samples );
+  /**
+   * Read block of traces into contiguous caller-supplied buffers
+   * Reads traces firstTraceIndex, firstTraceIndex+traceStep, firstTraceIndex+2*traceStep..., keeping every sampleStep'th sample.
+   * Trace indexes refer to the input file: A trace selection set by setSelection() is not applied.
+   * Header values are stored in slots of 8 bytes (native byte order), numTraceHeaders() slots per trace:
+   *  - Floating point headers as double, integer headers as 64bit integer
+   *  - String headers are not stored (slot is set to zero)
+   * The current read position is undefined after this call. Call moveToTrace() before reading single traces.
+   *
+   * @param firstTraceIndex  Index of first trace to read
+   * @param numTraces        Maximum number of traces to read
+   * @param traceStep        Trace decimation step (1: Read all traces)
+   * @param sampleStep       Sample decimation step (1: Keep all samples)
+   * @param samples          (o) Trace samples, numTraces*numSamplesDecimated(sampleStep) values, one trace after the other
+   * @param hdrTable         (o) Header table, numTraces*numTraceHeaders()*8 bytes. Pass NULL if not required
+   * @return Number of traces read. May be less than numTraces at end of file
+   */
+  int readTraces( int firstTraceIndex, int numTraces, int traceStep, int sampleStep, float* samples, char* hdrTable );
+  /// @return Number of samples per trace after decimation with the given sample step
+  int numSamplesDecimated( int sampleStep ) const;
+
+  /**
+   * @return Number of overview levels. 0 if no valid overview file exists for this file, see cseis_io::csOverviewReader
+   */
+  int numOverviewLevels() const;
+  int overviewTraceStep( int level ) const;
+  int overviewSampleStep( int level ) const;
+  /// @return Number of samples per overview trace in given level
+  int overviewNumSamples( int level ) const;
+  /**
+   * Find coarsest overview level suitable for displaying data at the given resolution
+   * @param traceStep   Number of traces per display pixel (or other display unit)
+   * @param sampleStep  Number of samples per display pixel
+   * @return Overview level, or -1 if full resolution data shall be read
+   */
+  int findOverviewLevel( int traceStep, int sampleStep ) const;
+  /**
+   * Read window of overview traces
+   * The window is specified in trace indexes of the input file. All overview traces overlapping the window are read.
+   * @param level            Overview level
+   * @param firstTraceIndex  Index of first trace in window
+   * @param numTraces        Number of traces in window
+   * @param minValues        (o) Minimum values, overviewNumSamples(level) values per overview trace. Pass NULL if not required
+   * @param maxValues        (o) Maximum values. Pass NULL if not required
+   * @param rmsValues        (o) RMS values. Pass NULL if not required
+   * @return Number of overview traces read, 0 if no overview file exists
+   */
+  int readOverview( int level, int firstTraceIndex, int numTraces, float* minValues, float* maxValues, float* rmsValues );
    
   void closeFile();
 
@@ -83,9 +132,13 @@ public:
 
 private:
   void setByteLocation();
+  void packHeaderValues( char* hdrSlots ) const;
   bool performIOSelection();
+  void openOverviews();
 
+  std::string myFilename;
   csSeismicReader_ver* myReader;
+  csOverviewReader* myOverviewReader;
   csSeismicIOConfig* myConfig;
 
   bool    myIsFileHeaderRead;
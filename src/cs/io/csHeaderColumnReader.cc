@@ -0,0 +1,183 @@
+/* Copyright (c) Colorado School of Mines, 2013.*/
+/* All rights reserved.                       */
+
+#include "csHeaderColumnReader.h"
+#include "csHeaderColumnWriter.h"
+#include "csException.h"
+#include <cstring>
+#include <algorithm>
+
+using namespace cseis_io;
+
+csHeaderColumnReader::csHeaderColumnReader( std::string const& filename ) {
+  myFilename   = filename;
+  myNumTraces  = 0;
+  myNumTracesChunk = 0;
+  myNumHeaders = 0;
+  myHdrName    = NULL;
+  myHdrType    = NULL;
+  myHdrByteSize   = NULL;
+  myHdrByteOffset = NULL;
+  myByteSizeHdrValueBlock = 0;
+  myFirstChunkOffset = 0;
+  mySeismicFileSize  = 0;
+  myColumnBuffer     = NULL;
+  myColumnBufferByteSize = 0;
+  myColumnHdrIndex   = -1;
+  myColumnChunkIndex = -1;
+  myFile = NULL;
+
+  try {
+    readFileHeader();
+  }
+  catch( cseis_geolib::csException& e ) {
+    freeMemory();
+    throw;
+  }
+}
+csHeaderColumnReader::~csHeaderColumnReader() {
+  freeMemory();
+}
+void csHeaderColumnReader::freeMemory() {
+  if( myFile != NULL ) {
+    myFile->close();
+    delete myFile;
+    myFile = NULL;
+  }
+  if( myHdrName != NULL ) {
+    delete [] myHdrName;
+    myHdrName = NULL;
+  }
+  if( myHdrType != NULL ) {
+    delete [] myHdrType;
+    myHdrType = NULL;
+  }
+  if( myHdrByteSize != NULL ) {
+    delete [] myHdrByteSize;
+    myHdrByteSize = NULL;
+  }
+  if( myHdrByteOffset != NULL ) {
+    delete [] myHdrByteOffset;
+    myHdrByteOffset = NULL;
+  }
+  if( myColumnBuffer != NULL ) {
+    delete [] myColumnBuffer;
+    myColumnBuffer = NULL;
+  }
+}
+//--------------------------------------------------------------------
+void csHeaderColumnReader::readFileHeader() {
+  myFile = new std::ifstream();
+  myFile->open( myFilename.c_str(), std::ios::in | std::ios::binary );
+  if( myFile->fail() ) {
+    throw( cseis_geolib::csException("Could not open header column file '%s'", myFilename.c_str()) );
+  }
+
+  char idText[4];
+  int version = 0;
+  myFile->read( idText, 4 );
+  myFile->read( (char*)&version, 4 );
+  myFile->read( (char*)&myNumTracesChunk, 4 );
+  myFile->read( (char*)&myNumHeaders, 4 );
+  if( myFile->fail() || strncmp( idText, "CSHC", 4 ) || version != csHeaderColumnWriter::VERSION_HEADER_COLUMN ||
+      myNumTracesChunk <= 0 || myNumHeaders < 0 ) {
+    throw( cseis_geolib::csException("File '%s' is not a valid header column file", myFilename.c_str()) );
+  }
+  myHdrName       = new std::string[myNumHeaders > 0 ? myNumHeaders : 1];
+  myHdrType       = new cseis_geolib::type_t[myNumHeaders > 0 ? myNumHeaders : 1];
+  myHdrByteSize   = new int[myNumHeaders > 0 ? myNumHeaders : 1];
+  myHdrByteOffset = new int[myNumHeaders > 0 ? myNumHeaders : 1];
+  csInt64_t byteLoc = 16;
+  for( int ihdr = 0; ihdr < myNumHeaders; ihdr++ ) {
+    char type = 0;
+    int nElements = 0;
+    int sizeName  = 0;
+    myFile->read( &type, 1 );
+    myFile->read( (char*)&nElements, 4 );
+    myFile->read( (char*)&myHdrByteSize[ihdr], 4 );
+    myFile->read( (char*)&sizeName, 4 );
+    if( myFile->fail() || sizeName < 0 || sizeName > 10000 || myHdrByteSize[ihdr] <= 0 ) {
+      throw( cseis_geolib::csException("File '%s' is not a valid header column file", myFilename.c_str()) );
+    }
+    char* name = new char[sizeName+1];
+    name[sizeName] = '\0';
+    myFile->read( name, sizeName );
+    myHdrName[ihdr] = name;
+    delete [] name;
+    myHdrType[ihdr] = (cseis_geolib::type_t)type;
+    myHdrByteOffset[ihdr] = myByteSizeHdrValueBlock;
+    myByteSizeHdrValueBlock += myHdrByteSize[ihdr];
+    byteLoc += 13 + sizeName;
+  }
+  myFirstChunkOffset = byteLoc;
+
+  // Trailer
+  int const trailerSize = csHeaderColumnWriter::TRAILER_BYTE_SIZE;
+  myFile->clear();
+  myFile->seekg( 0, std::ios_base::end );
+  csInt64_t fileSize = (csInt64_t)myFile->tellg();
+  myFile->seekg( (std::streamoff)(fileSize - trailerSize), std::ios_base::beg );
+  char trailer[csHeaderColumnWriter::TRAILER_BYTE_SIZE];
+  myFile->read( trailer, trailerSize );
+  memcpy( &mySeismicFileSize, &trailer[0], 8 );
+  memcpy( &myNumTraces, &trailer[8], 4 );
+  if( myFile->fail() || strncmp( &trailer[12], "CSHE", 4 ) || myNumTraces < 0 ||
+      myFirstChunkOffset + (csInt64_t)myNumTraces*(csInt64_t)myByteSizeHdrValueBlock + (csInt64_t)trailerSize != fileSize ) {
+    throw( cseis_geolib::csException("Header column file '%s' is incomplete", myFilename.c_str()) );
+  }
+}
+//--------------------------------------------------------------------
+int csHeaderColumnReader::headerIndex( std::string const& name ) const {
+  for( int ihdr = 0; ihdr < myNumHeaders; ihdr++ ) {
+    if( !myHdrName[ihdr].compare( name ) ) return ihdr;
+  }
+  return -1;
+}
+void csHeaderColumnReader::readBytes( csInt64_t byteOffset, char* buffer, int numBytes ) {
+  myFile->clear();
+  myFile->seekg( (std::streamoff)byteOffset, std::ios_base::beg );
+  myFile->read( buffer, numBytes );
+  if( myFile->fail() ) {
+    throw( cseis_geolib::csException("Unexpected error occurred when reading from header column file '%s'", myFilename.c_str()) );
+  }
+}
+//--------------------------------------------------------------------
+void csHeaderColumnReader::readColumn( int hdrIndex, int firstTrace, int numTraces, char* buffer ) {
+  if( hdrIndex < 0 || hdrIndex >= myNumHeaders || firstTrace < 0 || numTraces < 0 || firstTrace + numTraces > myNumTraces ) {
+    throw( cseis_geolib::csException("csHeaderColumnReader::readColumn: Header index or trace range out of range. This is a program bug in the calling function") );
+  }
+  int byteSize = myHdrByteSize[hdrIndex];
+  int traceIndex = firstTrace;
+  int lastTrace  = firstTrace + numTraces;
+  while( traceIndex < lastTrace ) {
+    int ichunk = traceIndex / myNumTracesChunk;
+    int chunkFirstTrace   = ichunk * myNumTracesChunk;
+    int numTracesInChunk  = std::min( myNumTracesChunk, myNumTraces - chunkFirstTrace );
+    int numTracesToRead   = std::min( lastTrace, chunkFirstTrace + numTracesInChunk ) - traceIndex;
+    csInt64_t byteOffset = myFirstChunkOffset + (csInt64_t)chunkFirstTrace * (csInt64_t)myByteSizeHdrValueBlock +
+      (csInt64_t)numTracesInChunk * (csInt64_t)myHdrByteOffset[hdrIndex] + (csInt64_t)(traceIndex-chunkFirstTrace) * (csInt64_t)byteSize;
+    readBytes( byteOffset, &buffer[(traceIndex-firstTrace)*byteSize], numTracesToRead*byteSize );
+    traceIndex += numTracesToRead;
+  }
+}
+//--------------------------------------------------------------------
+void csHeaderColumnReader::readValue( int hdrIndex, int traceIndex, char* buffer ) {
+  if( hdrIndex < 0 || hdrIndex >= myNumHeaders || traceIndex < 0 || traceIndex >= myNumTraces ) {
+    throw( cseis_geolib::csException("csHeaderColumnReader::readValue: Header index or trace index out of range. This is a program bug in the calling function") );
+  }
+  int byteSize = myHdrByteSize[hdrIndex];
+  int ichunk   = traceIndex / myNumTracesChunk;
+  int chunkFirstTrace = ichunk * myNumTracesChunk;
+  if( myColumnHdrIndex != hdrIndex || myColumnChunkIndex != ichunk ) {
+    if( myColumnBufferByteSize < myNumTracesChunk * byteSize ) {
+      if( myColumnBuffer != NULL ) delete [] myColumnBuffer;
+      myColumnBufferByteSize = myNumTracesChunk * byteSize;
+      myColumnBuffer = new char[myColumnBufferByteSize];
+    }
+    myColumnHdrIndex = -1;
+    readColumn( hdrIndex, chunkFirstTrace, std::min( myNumTracesChunk, myNumTraces - chunkFirstTrace ), myColumnBuffer );
+    myColumnHdrIndex   = hdrIndex;
+    myColumnChunkIndex = ichunk;
+  }
+  memcpy( buffer, &myColumnBuffer[(traceIndex-chunkFirstTrace)*byteSize], byteSize );
+}
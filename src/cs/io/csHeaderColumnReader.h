@@ -0,0 +1,111 @@
+/* Copyright (c) Colorado School of Mines, 2013.*/
+/* All rights reserved.                       */
+
+#ifndef CS_HEADER_COLUMN_READER_H
+#define CS_HEADER_COLUMN_READER_H
+
+#include <cstdio>
+#include <string>
+#include <fstream>
+#include "geolib_defines.h"
+
+namespace cseis_io {
+
+/**
+ * Trace header column file reader
+ *
+ * Reads trace header columns written by csHeaderColumnWriter.
+ * Reading one header column only touches the bytes of that header, one contiguous read per chunk of traces.
+ *
+ * @author Bjorn Olofsson
+ * @date 2013
+ */
+class csHeaderColumnReader {
+ public:
+  /**
+   * Open header column file. Throws csException if file cannot be read, or is incomplete.
+   */
+  csHeaderColumnReader( std::string const& filename );
+  ~csHeaderColumnReader();
+  int numTraces() const { return myNumTraces; }
+  int numHeaders() const { return myNumHeaders; }
+  /**
+   * @return Byte size of seismic data file at the time the header column file was written
+   */
+  csInt64_t seismicFileSize() const { return mySeismicFileSize; }
+  /**
+   * @return Index of header with given name, or -1 if header is not stored
+   */
+  int headerIndex( std::string const& name ) const;
+  int headerByteSize( int hdrIndex ) const { return myHdrByteSize[hdrIndex]; }
+  cseis_geolib::type_t headerType( int hdrIndex ) const { return myHdrType[hdrIndex]; }
+  /**
+   * Read header values of consecutive traces
+   * @param hdrIndex   Header index
+   * @param firstTrace Index of first trace
+   * @param numTraces  Number of traces
+   * @param buffer     (o) Header values, numTraces * headerByteSize(hdrIndex) bytes
+   */
+  void readColumn( int hdrIndex, int firstTrace, int numTraces, char* buffer );
+  /**
+   * Read header value of single trace.
+   * The header column of the whole chunk holding the trace is buffered, so that subsequent calls for neighbouring traces are fast.
+   */
+  void readValue( int hdrIndex, int traceIndex, char* buffer );
+
+ private:
+  void readFileHeader();
+  void readBytes( csInt64_t byteOffset, char* buffer, int numBytes );
+  void freeMemory();
+
+  std::string myFilename;
+  std::ifstream* myFile;
+  int myNumTraces;
+  int myNumTracesChunk;
+  int myNumHeaders;
+  std::string* myHdrName;
+  cseis_geolib::type_t* myHdrType;
+  int* myHdrByteSize;
+  int* myHdrByteOffset;
+  int myByteSizeHdrValueBlock;
+  csInt64_t myFirstChunkOffset;
+  csInt64_t mySeismicFileSize;
+
+  /// Buffered column of one header & chunk
+  char* myColumnBuffer;
+  int myColumnBufferByteSize;
+  int myColumnHdrIndex;
+  int myColumnChunkIndex;
+};
+
+} // end namespace
+#endif
+
+/*
+
+Header column file format, version 1:
+
+Byte  Type   Size
+0     char*  4  ID text = "CSHC"
+4     int    4  Version
+8     int    4  Number of traces per chunk (=NTRC)
+12    int    4  Number of trace headers (=NHDR)
+X=16
+for( NHDR ) {
+  X    char   1  Header type
+  X+1  int    4  Number of 'elements' in header
+  X+5  int    4  Byte size of header value
+  X+9  int    4  Number of characters in header name (=NCHAR)
+  X+13 char*  NCHAR  Header name
+  X=X+13+NCHAR
+}
+Chunks: Each chunk holds NTRC traces, except the last chunk which may hold fewer traces (=N).
+for( NHDR ) {
+  X    byte   N * header byte size  Header values of all traces in chunk
+}
+Trailer, last 16 bytes of file:
+0     int64  8  Byte size of seismic data file
+8     int    4  Total number of traces
+12    char*  4  ID text = "CSHE"
+
+*/
@@ -0,0 +1,122 @@
+/* Copyright (c) Colorado School of Mines, 2013.*/
+/* All rights reserved.                       */
+
+#include "csHeaderColumnWriter.h"
+#include "csSeismicIOConfig.h"
+#include "csHeaderInfo.h"
+#include "csGeolibUtils.h"
+#include "csException.h"
+#include <cstring>
+
+using namespace cseis_io;
+
+csHeaderColumnWriter::csHeaderColumnWriter( std::string const& filename, int numTracesChunk ) {
+  myFilename = filename;
+  myNumTracesChunk = numTracesChunk > 0 ? numTracesChunk : DEFAULT_CHUNK_TRACES;
+  myNumHeaders    = 0;
+  myHdrByteSize   = NULL;
+  myHdrByteOffset = NULL;
+  myByteSizeHdrValueBlock = 0;
+  myChunkBuffer   = NULL;
+  myNumTracesInChunk = 0;
+  myNumTraces     = 0;
+
+  myFile = fopen( myFilename.c_str(), "wb" );
+  if( myFile == NULL ) {
+    throw( cseis_geolib::csException("Error occurred when opening header column file '%s'", myFilename.c_str() ) );
+  }
+}
+csHeaderColumnWriter::~csHeaderColumnWriter() {
+  if( myFile != NULL ) {
+    // File not closed properly: Leave without trailer, reader will reject it
+    fclose( myFile );
+    myFile = NULL;
+  }
+  if( myHdrByteSize != NULL ) {
+    delete [] myHdrByteSize;
+    myHdrByteSize = NULL;
+  }
+  if( myHdrByteOffset != NULL ) {
+    delete [] myHdrByteOffset;
+    myHdrByteOffset = NULL;
+  }
+  if( myChunkBuffer != NULL ) {
+    delete [] myChunkBuffer;
+    myChunkBuffer = NULL;
+  }
+}
+std::string csHeaderColumnWriter::filename( std::string const& seismicFilename ) {
+  return( seismicFilename + ".hdrcol" );
+}
+//--------------------------------------------------------------------
+void csHeaderColumnWriter::writeBytes( void const* buffer, int numBytes ) {
+  if( numBytes == 0 ) return;
+  if( fwrite( buffer, numBytes, 1, myFile ) != 1 ) {
+    throw( cseis_geolib::csException("Error occurred when writing to header column file '%s'", myFilename.c_str() ) );
+  }
+}
+//--------------------------------------------------------------------
+void csHeaderColumnWriter::writeFileHeader( csSeismicIOConfig const* config ) {
+  myNumHeaders    = config->numTrcHeaders();
+  myHdrByteSize   = new int[myNumHeaders > 0 ? myNumHeaders : 1];
+  myHdrByteOffset = new int[myNumHeaders > 0 ? myNumHeaders : 1];
+  myByteSizeHdrValueBlock = 0;
+
+  writeBytes( "CSHC", 4 );
+  int version = VERSION_HEADER_COLUMN;
+  writeBytes( &version, 4 );
+  writeBytes( &myNumTracesChunk, 4 );
+  writeBytes( &myNumHeaders, 4 );
+  for( int ihdr = 0; ihdr < myNumHeaders; ihdr++ ) {
+    cseis_geolib::csHeaderInfo const* info = config->headerInfo( ihdr );
+    if( info->type != cseis_geolib::TYPE_STRING ) {
+      myHdrByteSize[ihdr] = cseis_geolib::csGeolibUtils::numBytes( info->type );
+    }
+    else {
+      myHdrByteSize[ihdr] = info->nElements;
+    }
+    myHdrByteOffset[ihdr] = myByteSizeHdrValueBlock;
+    myByteSizeHdrValueBlock += myHdrByteSize[ihdr];
+
+    char type = (char)info->type;
+    int sizeName = (int)info->name.length();
+    writeBytes( &type, 1 );
+    writeBytes( &info->nElements, 4 );
+    writeBytes( &myHdrByteSize[ihdr], 4 );
+    writeBytes( &sizeName, 4 );
+    writeBytes( info->name.c_str(), sizeName );
+  }
+  if( myByteSizeHdrValueBlock != config->byteSizeHdrValueBlock ) {
+    throw( cseis_geolib::csException("csHeaderColumnWriter: Inconsistent trace header byte size: %d != %d. This is a program bug in the calling function",
+                                     myByteSizeHdrValueBlock, config->byteSizeHdrValueBlock) );
+  }
+  myChunkBuffer = new char[myNumTracesChunk * myByteSizeHdrValueBlock + 1];
+}
+//--------------------------------------------------------------------
+void csHeaderColumnWriter::writeTraceHeader( char const* hdrValueBlock ) {
+  for( int ihdr = 0; ihdr < myNumHeaders; ihdr++ ) {
+    int byteSize = myHdrByteSize[ihdr];
+    memcpy( &myChunkBuffer[myNumTracesChunk*myHdrByteOffset[ihdr] + myNumTracesInChunk*byteSize], &hdrValueBlock[myHdrByteOffset[ihdr]], byteSize );
+  }
+  myNumTracesInChunk += 1;
+  myNumTraces += 1;
+  if( myNumTracesInChunk == myNumTracesChunk ) flushChunk();
+}
+void csHeaderColumnWriter::flushChunk() {
+  if( myNumTracesInChunk == 0 ) return;
+  // Last chunk: Only write out columns up to number of traces in chunk
+  for( int ihdr = 0; ihdr < myNumHeaders; ihdr++ ) {
+    writeBytes( &myChunkBuffer[myNumTracesChunk*myHdrByteOffset[ihdr]], myNumTracesInChunk*myHdrByteSize[ihdr] );
+  }
+  myNumTracesInChunk = 0;
+}
+//--------------------------------------------------------------------
+void csHeaderColumnWriter::close( csInt64_t seismicFileSize ) {
+  if( myFile == NULL ) return;
+  flushChunk();
+  writeBytes( &seismicFileSize, 8 );
+  writeBytes( &myNumTraces, 4 );
+  writeBytes( "CSHE", 4 );
+  fclose( myFile );
+  myFile = NULL;
+}
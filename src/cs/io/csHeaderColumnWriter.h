@@ -0,0 +1,76 @@
+/* Copyright (c) Colorado School of Mines, 2013.*/
+/* All rights reserved.                       */
+
+#ifndef CS_HEADER_COLUMN_WRITER_H
+#define CS_HEADER_COLUMN_WRITER_H
+
+#include <cstdio>
+#include <string>
+#include "geolib_defines.h"
+
+namespace cseis_io {
+
+class csSeismicIOConfig;
+
+/**
+ * Trace header column file writer
+ *
+ * Writes all trace headers of a SeaSeis file into a separate 'sidecar' file, stored column-wise:
+ * Traces are grouped in chunks of N traces. Within each chunk, all values of the first header are stored
+ * contiguously, followed by all values of the second header etc.
+ * One header can thus be read across all traces of a data set without reading any trace samples, or other trace headers.
+ * The sidecar file is only valid once close() has been called, which writes the size of the seismic data file
+ * into the file trailer. See csHeaderColumnReader for file format.
+ *
+ * @author Bjorn Olofsson
+ * @date 2013
+ */
+class csHeaderColumnWriter {
+ public:
+  static int const VERSION_HEADER_COLUMN = 1;
+  static int const DEFAULT_CHUNK_TRACES = 65536;
+  static int const TRAILER_BYTE_SIZE = 16;
+ public:
+  /**
+   * @param filename       Name of header column file, see filename()
+   * @param numTracesChunk Number of traces per chunk
+   */
+  csHeaderColumnWriter( std::string const& filename, int numTracesChunk = DEFAULT_CHUNK_TRACES );
+  ~csHeaderColumnWriter();
+  /**
+   * Write file header. Trace headers are defined by the given config object
+   */
+  void writeFileHeader( csSeismicIOConfig const* config );
+  /**
+   * Write trace header values of next trace
+   */
+  void writeTraceHeader( char const* hdrValueBlock );
+  /**
+   * Write out remaining traces and file trailer, and close file.
+   * @param seismicFileSize Byte size of seismic data file that the header column file belongs to
+   */
+  void close( csInt64_t seismicFileSize );
+  /**
+   * @return Name of header column file belonging to the given SeaSeis file
+   */
+  static std::string filename( std::string const& seismicFilename );
+
+ private:
+  void flushChunk();
+  void writeBytes( void const* buffer, int numBytes );
+
+  std::string myFilename;
+  FILE* myFile;
+  int myNumTracesChunk;
+  int myNumHeaders;
+  int* myHdrByteSize;
+  int* myHdrByteOffset;
+  int myByteSizeHdrValueBlock;
+  /// Trace headers of current chunk, stored column-wise
+  char* myChunkBuffer;
+  int myNumTracesInChunk;
+  int myNumTraces;
+};
+
+} // end namespace
+#endif
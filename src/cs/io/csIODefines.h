@@ -9,6 +9,8 @@ namespace cseis_io {
   typedef unsigned char byte;
   static const char ID_TEXT_CSEIS[] = "CSEIS";
   static const char ID_TEXT_OSEIS[] = "OSEIS";
+  /// Identifier at end of SeaSeis file version 0.5 and later, following the block directory
+  static const char ID_TEXT_BLOCK_DIRECTORY[] = "CSBD";
 
  class csIODefines {
  public:
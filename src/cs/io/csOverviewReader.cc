@@ -0,0 +1,192 @@
+/* Copyright (c) Colorado School of Mines, 2013.*/
+/* All rights reserved.                       */
+
+#include "csOverviewReader.h"
+#include "csOverviewWriter.h"
+#include "csException.h"
+#include <cstring>
+#include <algorithm>
+
+using namespace cseis_io;
+
+csOverviewReader::csOverviewReader( std::string const& filename ) {
+  myFilename   = filename;
+  myNumTraces  = 0;
+  myNumTracesChunk = 0;
+  myNumSamples = 0;
+  mySampleInt  = 0;
+  myNumLevels  = 0;
+  myTraceStep  = NULL;
+  mySampleStep = NULL;
+  myNumSamplesLevel = NULL;
+  myRecordByteSize  = NULL;
+  myChunkByteSize    = 0;
+  myFirstChunkOffset = 0;
+  mySeismicFileSize  = 0;
+  myBuffer = NULL;
+  myBufferByteSize = 0;
+  myFile = NULL;
+
+  try {
+    readFileHeader();
+  }
+  catch( cseis_geolib::csException& e ) {
+    freeMemory();
+    throw;
+  }
+}
+csOverviewReader::~csOverviewReader() {
+  freeMemory();
+}
+void csOverviewReader::freeMemory() {
+  if( myFile != NULL ) {
+    myFile->close();
+    delete myFile;
+    myFile = NULL;
+  }
+  if( myTraceStep != NULL ) {
+    delete [] myTraceStep;
+    myTraceStep = NULL;
+  }
+  if( mySampleStep != NULL ) {
+    delete [] mySampleStep;
+    mySampleStep = NULL;
+  }
+  if( myNumSamplesLevel != NULL ) {
+    delete [] myNumSamplesLevel;
+    myNumSamplesLevel = NULL;
+  }
+  if( myRecordByteSize != NULL ) {
+    delete [] myRecordByteSize;
+    myRecordByteSize = NULL;
+  }
+  if( myBuffer != NULL ) {
+    delete [] myBuffer;
+    myBuffer = NULL;
+  }
+}
+//--------------------------------------------------------------------
+void csOverviewReader::readFileHeader() {
+  myFile = new std::ifstream();
+  myFile->open( myFilename.c_str(), std::ios::in | std::ios::binary );
+  if( myFile->fail() ) {
+    throw( cseis_geolib::csException("Could not open overview file '%s'", myFilename.c_str()) );
+  }
+
+  char idText[4];
+  int version = 0;
+  myFile->read( idText, 4 );
+  myFile->read( (char*)&version, 4 );
+  myFile->read( (char*)&myNumTracesChunk, 4 );
+  myFile->read( (char*)&myNumSamples, 4 );
+  myFile->read( (char*)&mySampleInt, 4 );
+  myFile->read( (char*)&myNumLevels, 4 );
+  if( myFile->fail() || strncmp( idText, "CSOV", 4 ) || version != csOverviewWriter::VERSION_OVERVIEW ||
+      myNumTracesChunk <= 0 || myNumSamples < 0 || myNumLevels <= 0 || myNumLevels > 100 ) {
+    throw( cseis_geolib::csException("File '%s' is not a valid overview file", myFilename.c_str()) );
+  }
+  myTraceStep       = new int[myNumLevels];
+  mySampleStep      = new int[myNumLevels];
+  myNumSamplesLevel = new int[myNumLevels];
+  myRecordByteSize  = new int[myNumLevels];
+  for( int level = 0; level < myNumLevels; level++ ) {
+    myFile->read( (char*)&myTraceStep[level], 4 );
+    myFile->read( (char*)&mySampleStep[level], 4 );
+    if( myFile->fail() || myTraceStep[level] <= 0 || mySampleStep[level] <= 0 || myNumTracesChunk % myTraceStep[level] != 0 ) {
+      throw( cseis_geolib::csException("File '%s' is not a valid overview file", myFilename.c_str()) );
+    }
+    myNumSamplesLevel[level] = ( myNumSamples + mySampleStep[level] - 1 ) / mySampleStep[level];
+    myRecordByteSize[level]  = 3 * myNumSamplesLevel[level] * (int)sizeof(float);
+  }
+  myFirstChunkOffset = 24 + 8 * myNumLevels;
+  myChunkByteSize    = levelByteOffset( myNumLevels, myNumTracesChunk );
+
+  // Trailer
+  int const trailerSize = csOverviewWriter::TRAILER_BYTE_SIZE;
+  myFile->clear();
+  myFile->seekg( 0, std::ios_base::end );
+  csInt64_t fileSize = (csInt64_t)myFile->tellg();
+  myFile->seekg( (std::streamoff)(fileSize - trailerSize), std::ios_base::beg );
+  char trailer[csOverviewWriter::TRAILER_BYTE_SIZE];
+  myFile->read( trailer, trailerSize );
+  memcpy( &mySeismicFileSize, &trailer[0], 8 );
+  memcpy( &myNumTraces, &trailer[8], 4 );
+  if( myFile->fail() || strncmp( &trailer[12], "CSOE", 4 ) || myNumTraces < 0 ) {
+    throw( cseis_geolib::csException("Overview file '%s' is incomplete", myFilename.c_str()) );
+  }
+  int numChunksFull = myNumTraces / myNumTracesChunk;
+  csInt64_t byteSizeExpected = myFirstChunkOffset + (csInt64_t)numChunksFull * myChunkByteSize +
+    levelByteOffset( myNumLevels, myNumTraces - numChunksFull * myNumTracesChunk ) + (csInt64_t)trailerSize;
+  if( byteSizeExpected != fileSize ) {
+    throw( cseis_geolib::csException("Overview file '%s' is incomplete", myFilename.c_str()) );
+  }
+}
+//--------------------------------------------------------------------
+csInt64_t csOverviewReader::levelByteOffset( int level, int numTracesInChunk ) const {
+  csInt64_t byteOffset = 0;
+  for( int ilev = 0; ilev < level; ilev++ ) {
+    int numRecords = ( numTracesInChunk + myTraceStep[ilev] - 1 ) / myTraceStep[ilev];
+    byteOffset += (csInt64_t)numRecords * (csInt64_t)myRecordByteSize[ilev];
+  }
+  return byteOffset;
+}
+int csOverviewReader::findLevel( int traceStep, int sampleStep ) const {
+  int levelFound = -1;
+  for( int level = 0; level < myNumLevels; level++ ) {
+    if( myTraceStep[level] <= traceStep && mySampleStep[level] <= sampleStep ) levelFound = level;
+  }
+  return levelFound;
+}
+void csOverviewReader::readBytes( csInt64_t byteOffset, char* buffer, csInt64_t numBytes ) {
+  myFile->clear();
+  myFile->seekg( (std::streamoff)byteOffset, std::ios_base::beg );
+  myFile->read( buffer, (std::streamsize)numBytes );
+  if( myFile->fail() ) {
+    throw( cseis_geolib::csException("Unexpected error occurred when reading from overview file '%s'", myFilename.c_str()) );
+  }
+}
+//--------------------------------------------------------------------
+int csOverviewReader::readWindow( int level, int firstTrace, int numTraces, float* minValues, float* maxValues, float* rmsValues ) {
+  if( level < 0 || level >= myNumLevels ) {
+    throw( cseis_geolib::csException("csOverviewReader::readWindow: Overview level out of range (=%d). This is a program bug in the calling function", level) );
+  }
+  if( firstTrace < 0 ) {
+    numTraces += firstTrace;
+    firstTrace = 0;
+  }
+  numTraces = std::min( numTraces, myNumTraces - firstTrace );
+  if( numTraces <= 0 ) return 0;
+
+  int traceStep  = myTraceStep[level];
+  int numSamples = myNumSamplesLevel[level];
+  int recordByteSize = myRecordByteSize[level];
+  int numRecordsChunk = myNumTracesChunk / traceStep;
+  int recordFirst = firstTrace / traceStep;
+  int recordLast  = ( firstTrace + numTraces - 1 ) / traceStep;
+  int record = recordFirst;
+  while( record <= recordLast ) {
+    int ichunk = record / numRecordsChunk;
+    int chunkFirstTrace  = ichunk * myNumTracesChunk;
+    int numTracesInChunk = std::min( myNumTracesChunk, myNumTraces - chunkFirstTrace );
+    int numRecordsInChunk = ( numTracesInChunk + traceStep - 1 ) / traceStep;
+    int numRecordsToRead  = std::min( recordLast + 1, ichunk * numRecordsChunk + numRecordsInChunk ) - record;
+    csInt64_t numBytes = (csInt64_t)numRecordsToRead * (csInt64_t)recordByteSize;
+    if( myBufferByteSize < numBytes ) {
+      if( myBuffer != NULL ) delete [] myBuffer;
+      myBufferByteSize = numBytes;
+      myBuffer = new char[myBufferByteSize];
+    }
+    csInt64_t byteOffset = myFirstChunkOffset + (csInt64_t)ichunk * myChunkByteSize + levelByteOffset( level, numTracesInChunk ) +
+      (csInt64_t)(record - ichunk*numRecordsChunk) * (csInt64_t)recordByteSize;
+    readBytes( byteOffset, myBuffer, numBytes );
+    for( int irec = 0; irec < numRecordsToRead; irec++ ) {
+      float const* values = reinterpret_cast<float const*>( &myBuffer[(size_t)irec*recordByteSize] );
+      size_t outIndex = (size_t)(record - recordFirst + irec) * numSamples;
+      if( minValues != NULL ) memcpy( &minValues[outIndex], &values[0], numSamples*sizeof(float) );
+      if( maxValues != NULL ) memcpy( &maxValues[outIndex], &values[numSamples], numSamples*sizeof(float) );
+      if( rmsValues != NULL ) memcpy( &rmsValues[outIndex], &values[2*numSamples], numSamples*sizeof(float) );
+    }
+    record += numRecordsToRead;
+  }
+  return( recordLast - recordFirst + 1 );
+}
@@ -0,0 +1,124 @@
+/* Copyright (c) Colorado School of Mines, 2013.*/
+/* All rights reserved.                       */
+
+#ifndef CS_OVERVIEW_READER_H
+#define CS_OVERVIEW_READER_H
+
+#include <cstdio>
+#include <string>
+#include <fstream>
+#include "geolib_defines.h"
+
+namespace cseis_io {
+
+/**
+ * Overview file reader
+ *
+ * Reads decimated overview traces written by csOverviewWriter.
+ * Reading a window of one overview level only touches the bytes of that level, one contiguous read per chunk of traces.
+ *
+ * @author Bjorn Olofsson
+ * @date 2013
+ */
+class csOverviewReader {
+ public:
+  /**
+   * Open overview file. Throws csException if file cannot be read, or is incomplete.
+   */
+  csOverviewReader( std::string const& filename );
+  ~csOverviewReader();
+  /// @return Number of full resolution traces
+  int numTraces() const { return myNumTraces; }
+  /// @return Number of full resolution samples
+  int numSamples() const { return myNumSamples; }
+  float sampleInt() const { return mySampleInt; }
+  int numLevels() const { return myNumLevels; }
+  int traceStep( int level ) const { return myTraceStep[level]; }
+  int sampleStep( int level ) const { return mySampleStep[level]; }
+  /// @return Number of overview traces in given level
+  int numTraces( int level ) const { return( (myNumTraces + myTraceStep[level] - 1) / myTraceStep[level] ); }
+  /// @return Number of samples per overview trace in given level
+  int numSamples( int level ) const { return myNumSamplesLevel[level]; }
+  /**
+   * @return Byte size of seismic data file at the time the overview file was written
+   */
+  csInt64_t seismicFileSize() const { return mySeismicFileSize; }
+  /**
+   * Find coarsest overview level whose decimation does not exceed the given trace and sample steps
+   * @return Overview level, or -1 if no overview level is fine enough
+   */
+  int findLevel( int traceStep, int sampleStep ) const;
+  /**
+   * Read window of overview traces
+   * The window is specified in full resolution trace indexes. All overview traces overlapping the window are read.
+   * @param level      Overview level
+   * @param firstTrace Index of first full resolution trace in window
+   * @param numTraces  Number of full resolution traces in window
+   * @param minValues  (o) Minimum values, numSamples(level) values per overview trace. Pass NULL if not required
+   * @param maxValues  (o) Maximum values, numSamples(level) values per overview trace. Pass NULL if not required
+   * @param rmsValues  (o) RMS values, numSamples(level) values per overview trace. Pass NULL if not required
+   * @return Number of overview traces read
+   */
+  int readWindow( int level, int firstTrace, int numTraces, float* minValues, float* maxValues, float* rmsValues );
+
+ private:
+  void readFileHeader();
+  void readBytes( csInt64_t byteOffset, char* buffer, csInt64_t numBytes );
+  void freeMemory();
+  /// @return Byte offset of given level within chunk holding the given number of traces
+  csInt64_t levelByteOffset( int level, int numTracesInChunk ) const;
+
+  std::string myFilename;
+  std::ifstream* myFile;
+  int myNumTraces;
+  int myNumTracesChunk;
+  int myNumSamples;
+  float mySampleInt;
+  int myNumLevels;
+  int* myTraceStep;
+  int* mySampleStep;
+  int* myNumSamplesLevel;
+  /// Byte size of one overview trace (min, max, RMS values), for each level
+  int* myRecordByteSize;
+  csInt64_t myChunkByteSize;
+  csInt64_t myFirstChunkOffset;
+  csInt64_t mySeismicFileSize;
+
+  char* myBuffer;
+  csInt64_t myBufferByteSize;
+};
+
+} // end namespace
+#endif
+
+/*
+
+Overview file format, version 1:
+
+Byte  Type   Size
+0     char*  4  ID text = "CSOV"
+4     int    4  Version
+8     int    4  Number of full resolution traces per chunk (=NTRC)
+12    int    4  Number of full resolution samples (=NSAMP)
+16    float  4  Sample interval [ms]
+20    int    4  Number of overview levels (=NLEV)
+X=24
+for( NLEV ) {
+  X    int    4  Trace step of level (=TSTEP)
+  X+4  int    4  Sample step of level (=SSTEP)
+  X=X+8
+}
+Chunks: Each chunk holds overview traces of NTRC full resolution traces, except the last chunk which may hold fewer traces (=N).
+for( NLEV ) {
+  for( (N+TSTEP-1)/TSTEP overview traces ) {
+    X    float  NS*4  Minimum values, NS = (NSAMP+SSTEP-1)/SSTEP
+    X    float  NS*4  Maximum values
+    X    float  NS*4  RMS values
+  }
+}
+Trailer, last 16 bytes of file:
+0     int64  8  Byte size of seismic data file
+8     int    4  Total number of full resolution traces
+12    char*  4  ID text = "CSOE"
+
+*/
@@ -0,0 +1,201 @@
+/* Copyright (c) Colorado School of Mines, 2013.*/
+/* All rights reserved.                       */
+
+#include "csOverviewWriter.h"
+#include "csSeismicIOConfig.h"
+#include "csException.h"
+#include <cstring>
+#include <cmath>
+
+using namespace cseis_io;
+
+csOverviewWriter::csOverviewWriter( std::string const& filename, int numLevels, int factor ) {
+  myFilename   = filename;
+  myNumLevels  = numLevels;
+  myNumSamples = 0;
+  myNumTracesChunk  = 0;
+  myChunkBuffer     = NULL;
+  mySumSquares      = NULL;
+  myNumTracesInChunk = 0;
+  myNumTraces  = 0;
+  myFile = NULL;
+  myTraceStep       = NULL;
+  mySampleStep      = NULL;
+  myNumSamplesLevel = NULL;
+
+  if( numLevels <= 0 || factor < 2 ) {
+    throw( cseis_geolib::csException("csOverviewWriter: Number of levels (=%d) must be positive and decimation factor (=%d) at least 2",
+                                     numLevels, factor) );
+  }
+  int stepMax = 1;
+  for( int level = 0; level < myNumLevels; level++ ) {
+    if( stepMax > MAX_DECIMATION / factor ) {
+      throw( cseis_geolib::csException("csOverviewWriter: Decimation of coarsest overview level exceeds %d. Reduce number of levels or decimation factor",
+                                       MAX_DECIMATION) );
+    }
+    stepMax *= factor;
+  }
+  myTraceStep       = new int[myNumLevels];
+  mySampleStep      = new int[myNumLevels];
+  myNumSamplesLevel = new int[myNumLevels];
+  int step = 1;
+  for( int level = 0; level < myNumLevels; level++ ) {
+    step *= factor;
+    myTraceStep[level]  = step;
+    mySampleStep[level] = step;
+    myNumSamplesLevel[level] = 0;
+  }
+
+  myFile = fopen( myFilename.c_str(), "wb" );
+  if( myFile == NULL ) {
+    freeMemory();
+    throw( cseis_geolib::csException("Error occurred when opening overview file '%s'", myFilename.c_str() ) );
+  }
+}
+csOverviewWriter::~csOverviewWriter() {
+  if( myFile != NULL ) {
+    // File not closed properly: Leave without trailer, reader will reject it
+    fclose( myFile );
+    myFile = NULL;
+  }
+  freeMemory();
+}
+void csOverviewWriter::freeMemory() {
+  if( myChunkBuffer != NULL ) {
+    for( int level = 0; level < myNumLevels; level++ ) {
+      delete [] myChunkBuffer[level];
+      delete [] mySumSquares[level];
+    }
+    delete [] myChunkBuffer;
+    delete [] mySumSquares;
+    myChunkBuffer = NULL;
+    mySumSquares  = NULL;
+  }
+  if( myTraceStep != NULL ) {
+    delete [] myTraceStep;
+    myTraceStep = NULL;
+  }
+  if( mySampleStep != NULL ) {
+    delete [] mySampleStep;
+    mySampleStep = NULL;
+  }
+  if( myNumSamplesLevel != NULL ) {
+    delete [] myNumSamplesLevel;
+    myNumSamplesLevel = NULL;
+  }
+}
+std::string csOverviewWriter::filename( std::string const& seismicFilename ) {
+  return( seismicFilename + ".ovr" );
+}
+//--------------------------------------------------------------------
+void csOverviewWriter::writeBytes( void const* buffer, csInt64_t numBytes ) {
+  char const* bufferPtr = reinterpret_cast<char const*>( buffer );
+  while( numBytes > 0 ) {
+    size_t numBytesWrite = numBytes < MAX_BYTES_PER_WRITE ? (size_t)numBytes : (size_t)MAX_BYTES_PER_WRITE;
+    if( fwrite( bufferPtr, numBytesWrite, 1, myFile ) != 1 ) {
+      throw( cseis_geolib::csException("Error occurred when writing to overview file '%s'", myFilename.c_str() ) );
+    }
+    bufferPtr += numBytesWrite;
+    numBytes  -= (csInt64_t)numBytesWrite;
+  }
+}
+//--------------------------------------------------------------------
+void csOverviewWriter::writeFileHeader( csSeismicIOConfig const* config ) {
+  myNumSamples = config->numSamples;
+  int stepMax = myTraceStep[myNumLevels-1];
+  myNumTracesChunk = ( (MIN_CHUNK_TRACES + stepMax - 1) / stepMax ) * stepMax;
+
+  myChunkBuffer = new float*[myNumLevels];
+  mySumSquares  = new double*[myNumLevels];
+  for( int level = 0; level < myNumLevels; level++ ) {
+    int numSamplesLevel = ( myNumSamples + mySampleStep[level] - 1 ) / mySampleStep[level];
+    myNumSamplesLevel[level] = numSamplesLevel;
+    myChunkBuffer[level] = new float[(size_t)(myNumTracesChunk / myTraceStep[level]) * 3 * numSamplesLevel + 1];
+    mySumSquares[level]  = new double[numSamplesLevel + 1];
+  }
+
+  float sampleInt = (float)config->sampleInt;
+  writeBytes( "CSOV", 4 );
+  int version = VERSION_OVERVIEW;
+  writeBytes( &version, 4 );
+  writeBytes( &myNumTracesChunk, 4 );
+  writeBytes( &myNumSamples, 4 );
+  writeBytes( &sampleInt, 4 );
+  writeBytes( &myNumLevels, 4 );
+  for( int level = 0; level < myNumLevels; level++ ) {
+    writeBytes( &myTraceStep[level], 4 );
+    writeBytes( &mySampleStep[level], 4 );
+  }
+}
+//--------------------------------------------------------------------
+void csOverviewWriter::writeTrace( float const* samples ) {
+  int itrc = myNumTracesInChunk;
+  for( int level = 0; level < myNumLevels; level++ ) {
+    int traceStep  = myTraceStep[level];
+    int sampleStep = mySampleStep[level];
+    int numSamplesLevel = myNumSamplesLevel[level];
+    float* minValues = &myChunkBuffer[level][(size_t)(itrc / traceStep) * 3 * numSamplesLevel];
+    float* maxValues = &minValues[numSamplesLevel];
+    double* sumSquares = mySumSquares[level];
+    bool isFirstTrace = ( itrc % traceStep ) == 0;
+    for( int ibin = 0; ibin < numSamplesLevel; ibin++ ) {
+      int isampStart = ibin * sampleStep;
+      int isampEnd   = isampStart + sampleStep < myNumSamples ? isampStart + sampleStep : myNumSamples;
+      float minValue = samples[isampStart];
+      float maxValue = samples[isampStart];
+      double sum = 0.0;
+      for( int isamp = isampStart; isamp < isampEnd; isamp++ ) {
+        float value = samples[isamp];
+        if( value < minValue ) minValue = value;
+        else if( value > maxValue ) maxValue = value;
+        sum += (double)value * (double)value;
+      }
+      if( isFirstTrace ) {
+        minValues[ibin]  = minValue;
+        maxValues[ibin]  = maxValue;
+        sumSquares[ibin] = sum;
+      }
+      else {
+        if( minValue < minValues[ibin] ) minValues[ibin] = minValue;
+        if( maxValue > maxValues[ibin] ) maxValues[ibin] = maxValue;
+        sumSquares[ibin] += sum;
+      }
+    }
+    if( (itrc+1) % traceStep == 0 ) finishRecord( level, itrc / traceStep, traceStep );
+  }
+  myNumTracesInChunk += 1;
+  myNumTraces += 1;
+  if( myNumTracesInChunk == myNumTracesChunk ) flushChunk();
+}
+void csOverviewWriter::finishRecord( int level, int irec, int numTracesInRecord ) {
+  int sampleStep = mySampleStep[level];
+  int numSamplesLevel = myNumSamplesLevel[level];
+  float* rmsValues = &myChunkBuffer[level][(size_t)irec * 3 * numSamplesLevel + 2 * numSamplesLevel];
+  double const* sumSquares = mySumSquares[level];
+  for( int ibin = 0; ibin < numSamplesLevel; ibin++ ) {
+    int isampStart = ibin * sampleStep;
+    int numSamplesBin = isampStart + sampleStep < myNumSamples ? sampleStep : myNumSamples - isampStart;
+    rmsValues[ibin] = (float)sqrt( sumSquares[ibin] / (double)( numTracesInRecord * numSamplesBin ) );
+  }
+}
+void csOverviewWriter::flushChunk() {
+  if( myNumTracesInChunk == 0 ) return;
+  // Last chunk: Complete last overview trace, and only write out overview traces up to number of traces in chunk
+  for( int level = 0; level < myNumLevels; level++ ) {
+    int numTracesInRecordLast = myNumTracesInChunk % myTraceStep[level];
+    if( numTracesInRecordLast != 0 ) finishRecord( level, myNumTracesInChunk / myTraceStep[level], numTracesInRecordLast );
+    int numRecords = ( myNumTracesInChunk + myTraceStep[level] - 1 ) / myTraceStep[level];
+    writeBytes( myChunkBuffer[level], (csInt64_t)numRecords * 3 * (csInt64_t)myNumSamplesLevel[level] * (csInt64_t)sizeof(float) );
+  }
+  myNumTracesInChunk = 0;
+}
+//--------------------------------------------------------------------
+void csOverviewWriter::close( csInt64_t seismicFileSize ) {
+  if( myFile == NULL ) return;
+  flushChunk();
+  writeBytes( &seismicFileSize, 8 );
+  writeBytes( &myNumTraces, 4 );
+  writeBytes( "CSOE", 4 );
+  fclose( myFile );
+  myFile = NULL;
+}
@@ -0,0 +1,89 @@
+/* Copyright (c) Colorado School of Mines, 2013.*/
+/* All rights reserved.                       */
+
+#ifndef CS_OVERVIEW_WRITER_H
+#define CS_OVERVIEW_WRITER_H
+
+#include <cstdio>
+#include <string>
+#include "geolib_defines.h"
+
+namespace cseis_io {
+
+class csSeismicIOConfig;
+
+/**
+ * Overview file writer
+ *
+ * Writes decimated 'overview' versions of a SeaSeis file into a separate 'sidecar' file.
+ * Overview level L (L=0,1,2...) decimates both traces and samples by factor^(L+1). Each overview sample holds the
+ * minimum, maximum and RMS value of all input samples in the decimated bin, so that a zoomed-out display
+ * retains the amplitude envelope of the data.
+ * Traces are processed in chunks of N input traces (N is a multiple of the trace step of the coarsest level). Within
+ * each chunk, all overview traces of level 0 are stored, followed by all overview traces of level 1 etc.
+ * The sidecar file is only valid once close() has been called, which writes the size of the seismic data file
+ * into the file trailer. See csOverviewReader for file format.
+ *
+ * @author Bjorn Olofsson
+ * @date 2013
+ */
+class csOverviewWriter {
+ public:
+  static int const VERSION_OVERVIEW = 1;
+  static int const MIN_CHUNK_TRACES = 1024;
+  static int const MAX_DECIMATION   = 1048576;
+  static int const TRAILER_BYTE_SIZE = 16;
+  /// Maximum number of bytes passed to a single fwrite call
+  static int const MAX_BYTES_PER_WRITE = 1073741824;
+ public:
+  /**
+   * @param filename   Name of overview file, see filename()
+   * @param numLevels  Number of overview levels
+   * @param factor     Decimation factor from one level to the next, for both traces and samples
+   * @throws csException if file cannot be opened, or if the decimation of the coarsest level exceeds MAX_DECIMATION
+   */
+  csOverviewWriter( std::string const& filename, int numLevels, int factor );
+  ~csOverviewWriter();
+  /**
+   * Write file header. Number of samples and sample interval are taken from the given config object
+   */
+  void writeFileHeader( csSeismicIOConfig const* config );
+  /**
+   * Add samples of next trace
+   */
+  void writeTrace( float const* samples );
+  /**
+   * Write out remaining traces and file trailer, and close file.
+   * @param seismicFileSize Byte size of seismic data file that the overview file belongs to
+   */
+  void close( csInt64_t seismicFileSize );
+  /**
+   * @return Name of overview file belonging to the given SeaSeis file
+   */
+  static std::string filename( std::string const& seismicFilename );
+
+ private:
+  /// Compute RMS values of overview trace irec in current chunk
+  void finishRecord( int level, int irec, int numTracesInRecord );
+  void flushChunk();
+  void writeBytes( void const* buffer, csInt64_t numBytes );
+  void freeMemory();
+
+  std::string myFilename;
+  FILE* myFile;
+  int myNumLevels;
+  int myNumSamples;
+  int myNumTracesChunk;
+  int* myTraceStep;
+  int* mySampleStep;
+  int* myNumSamplesLevel;
+  /// Overview traces of current chunk, for each level. Each overview trace: min, max and RMS values
+  float** myChunkBuffer;
+  /// Sum of squares of current overview trace, for each level
+  double** mySumSquares;
+  int myNumTracesInChunk;
+  int myNumTraces;
+};
+
+} // end namespace
+#endif
@@ -3,11 +3,31 @@
 
 #include "csP190Reader.h"
 #include "csVector.h"
+#include "csKeyTable.h"
+#include "csFileUtils.h"
+#include "csException.h"
 #include "limits"
 
 using namespace cseis_io;
 
+namespace {
+  /// Values of one source record in source table
+  int const SOURCE_ID    = 0;
+  int const SOURCE_WDEP  = 1;
+  int const SOURCE_DAY   = 2;
+  int const SOURCE_HOUR  = 3;
+  int const SOURCE_MIN   = 4;
+  int const SOURCE_SEC   = 5;
+  int const SOURCE_X     = 6;
+  int const SOURCE_Y     = 7;
+  int const SOURCE_Z     = 8;
+  int const SOURCE_LINE  = 9;
+  int const SOURCE_FILEPOS = 10;
+  int const SOURCE_NUM_VALUES = 11;
+}
+
 csP190Reader::csP190Reader( std::string const& filename ) {
+  myFilename = filename;
   myFile = new std::ifstream( filename.c_str() );
   
   if( myFile == NULL || !myFile->is_open()) {
@@ -15,9 +35,13 @@ csP190Reader::csP190Reader( std::string const& filename ) {
   }
   myCurrentChanData = new cseis_geolib::csVector<csDataChan*>();
   mySourceData      = new cseis_geolib::csVector<csDataSource*>();
+  mySourceTable     = new cseis_geolib::csKeyTable( 1, SOURCE_NUM_VALUES );
+  myChanTable       = new cseis_geolib::csKeyTable( 2, 0 );
+  myNumChannelReads = 0;
 
   myCurrentSource      = -1;
   myCurrentSourceIndex = -1;
+  myCurrentChanIndex   = 0;
 
   myCurrentMinChan = -1;
   myCurrentMaxChan = -1;
@@ -33,13 +57,21 @@ csP190Reader::~csP190Reader() {
     delete myCurrentChanData;
     myCurrentChanData = NULL;
   }
-  if( mySourceData->size() > 0 ) {
+  if( mySourceData != NULL ) {
     for( int i = 0; i < mySourceData->size(); i++ ) {
       delete mySourceData->at(i);
     }
     delete mySourceData;
     mySourceData = NULL;
   }
+  if( mySourceTable != NULL ) {
+    delete mySourceTable;
+    mySourceTable = NULL;
+  }
+  if( myChanTable != NULL ) {
+    delete myChanTable;
+    myChanTable = NULL;
+  }
   if( myFile != NULL ) {
     myFile->close();
     delete myFile;
@@ -47,26 +79,94 @@ csP190Reader::~csP190Reader() {
   }
 }
 
-void csP190Reader::initialize() {
+bool csP190Reader::initialize( std::string const& cacheFilename ) {
   if( mySourceData->size() > 0 ) {
     for( int i = 0; i < mySourceData->size(); i++ ) {
       delete mySourceData->at(i);
     }
   }
   mySourceData->clear();
-  if( !readAllSources() ) {
-    throw( cseis_geolib::csException("Unknown error occurred when trying to read in all source information from P190 file") );
+
+  myCacheSignature = "";
+  if( !cacheFilename.empty() ) {
+    csInt64_t fileSize = 0;
+    int timeStamp_s = 0;
+    if( !cseis_geolib::csFileUtils::retrieveFileInfo( myFilename, &fileSize, &timeStamp_s ) ) {
+      throw( cseis_geolib::csException("Could not open P190 file '%s'", myFilename.c_str()) );
+    }
+    char buffer[64];
+    sprintf( buffer, "|%lld|%d", fileSize, timeStamp_s );
+    myCacheSignature = std::string("P190|") + myFilename + std::string(buffer);
+  }
+
+  bool isCached = !cacheFilename.empty() && mySourceTable->readCache( cacheFilename, myCacheSignature );
+  if( isCached ) {
+    retrieveSources( mySourceTable );
+  }
+  else {
+    if( !readAllSources() ) {
+      throw( cseis_geolib::csException("Unknown error occurred when trying to read in all source information from P190 file") );
+    }
+    storeSources( mySourceTable );
   }
+  mySourceTable->buildIndex();
 
   myCurrentSource      = -1;
   myCurrentSourceIndex = -1;
   myCurrentChanIndex   = 0;
+  return isCached;
+}
+void csP190Reader::writeCache( std::string const& cacheFilename ) const {
+  mySourceTable->writeCache( cacheFilename, myCacheSignature );
+}
+int csP190Reader::numSources() const {
+  return mySourceData->size();
+}
+//----------------------------------------------------------------------
+//
+void csP190Reader::storeSources( cseis_geolib::csKeyTable* table ) const {
+  table->clear();
+  double values[SOURCE_NUM_VALUES];
+  for( int i = 0; i < mySourceData->size(); i++ ) {
+    csDataSource const* ds = mySourceData->at(i);
+    double key = (double)ds->point;
+    values[SOURCE_ID]   = ds->id;
+    values[SOURCE_WDEP] = ds->wdep;
+    values[SOURCE_DAY]  = ds->day;
+    values[SOURCE_HOUR] = ds->hour;
+    values[SOURCE_MIN]  = ds->min;
+    values[SOURCE_SEC]  = ds->sec;
+    values[SOURCE_X]    = ds->x;
+    values[SOURCE_Y]    = ds->y;
+    values[SOURCE_Z]    = ds->z;
+    values[SOURCE_LINE] = ds->lineNumber;
+    values[SOURCE_FILEPOS] = (double)ds->filePos;
+    table->addRecord( &key, values );
+  }
+}
+void csP190Reader::retrieveSources( cseis_geolib::csKeyTable const* table ) {
+  for( int i = 0; i < table->numRecords(); i++ ) {
+    csDataSource* ds = new csDataSource();
+    ds->point = (int)table->key( i, 0 );
+    ds->id    = (int)table->value( i, SOURCE_ID );
+    ds->wdep  = table->value( i, SOURCE_WDEP );
+    ds->day   = (int)table->value( i, SOURCE_DAY );
+    ds->hour  = (int)table->value( i, SOURCE_HOUR );
+    ds->min   = (int)table->value( i, SOURCE_MIN );
+    ds->sec   = (int)table->value( i, SOURCE_SEC );
+    ds->x     = table->value( i, SOURCE_X );
+    ds->y     = table->value( i, SOURCE_Y );
+    ds->z     = table->value( i, SOURCE_Z );
+    ds->lineNumber = (int)table->value( i, SOURCE_LINE );
+    ds->filePos    = (csInt64_t)table->value( i, SOURCE_FILEPOS );
+    mySourceData->insertEnd( ds );
+  }
 }
 //----------------------------------------------------------------------
 //
 csDataSource const* csP190Reader::getSource( int source ) {
   if( source != myCurrentSource ) {
-    int sourceIndexNew = getSourceIndex( source, myCurrentSourceIndex );
+    int sourceIndexNew = getSourceIndex( source );
     if( sourceIndexNew < 0 ) return NULL;
     bool success = readChannels( source );
     if( !success ) throw( cseis_geolib::csException("Unknown problem occurred when trying to read in channel information for source %d", source) );
@@ -84,65 +184,30 @@ csDataChan const* csP190Reader::getChan( int source, int chan, int cable ) {
     csDataSource const* ds = getSource( source );
     if( ds == NULL ) return NULL;
   }
+  // Channels are usually requested in the order they appear in the file: Check next channel first
   if( myCurrentChanIndex < myCurrentChanData->size() ) {
     csDataChan* dc = myCurrentChanData->at( myCurrentChanIndex );
-    if( chan == dc->chan && cable == dc->cable ) return dc;
-  }
-  else {
-    myCurrentChanIndex = 0;
-  } 
-  // Search matching cable/channel starting at current position
-  for( int ichan = myCurrentChanIndex; ichan < myCurrentChanData->size(); ichan++ ) {
-    csDataChan* dc = myCurrentChanData->at( ichan );
     if( chan == dc->chan && cable == dc->cable ) {
-      myCurrentChanIndex = ichan;
+      myCurrentChanIndex += 1;
       return dc;
     }
   }
-  // Search again starting at first position
-  for( int ichan = 0; ichan < myCurrentChanIndex; ichan++ ) {
-    csDataChan* dc = myCurrentChanData->at( ichan );
-    if( chan == dc->chan && cable == dc->cable ) {
-      myCurrentChanIndex = ichan;
-      return dc;
-    }
-  }
- return NULL;
-}
-//----------------------------------------------------------------------
-//
-int csP190Reader::getSourceIndex( int source, int startIndex ) const {
-  for( int i = std::max(startIndex,0); i < mySourceData->size(); i++ ) {
-    if( mySourceData->at(i)->point == source ) {
-      return i;
-    }
-  }
-  for( int i = 0; i < startIndex; i++ ) {
-    if( mySourceData->at(i)->point == source ) {
-      return i;
-    }
-  }
-  return -1;
+  double keys[2];
+  keys[0] = chan;
+  keys[1] = cable;
+  int ichan = myChanTable->find( keys );
+  if( ichan < 0 ) return NULL;
+  myCurrentChanIndex = ichan + 1;
+  return myCurrentChanData->at( ichan );
 }
 
 //----------------------------------------------------------------------
-// lineNum starts at 0 for first line
 //
-void csP190Reader::setFilePointerToStartOfLine( int lineNum ) {
-  if( lineNum < myCurrentLineNumber ) {
-    myFile->clear();                 // clear fail and eof bits
-    myFile->seekg( 0, std::ios::beg); // back to the start
-    myCurrentLineNumber = 0;
-  }
-  fprintf(stderr,"Line number: requested=%d, current=%d, EOF: %d\n", lineNum, myCurrentLineNumber, myFile->eof());
-  for( int iline = myCurrentLineNumber; iline < lineNum; iline++ ) {
-    if( myFile->eof() ) throw( cseis_geolib::csException("Unexpected end of file encountered in input P190 file. Line number = %d", iline+1) );
-    if( !myFile->ignore( std::numeric_limits<std::streamsize>::max(), myFile->widen('\n') ) ) {
-      throw( cseis_geolib::csException("Unexpected end of file encountered in input P190 file. Line number = %d", iline+1) );
-    }
-  }
-  myCurrentLineNumber = lineNum;
+int csP190Reader::getSourceIndex( int source ) {
+  double key = (double)source;
+  return mySourceTable->find( &key );
 }
+
 //--------------------------------------------------
 //
 bool csP190Reader::readAllSources() {
@@ -152,11 +217,13 @@ bool csP190Reader::readAllSources() {
 
   while( !myFile->eof() ) {
     std::string line;
+    csInt64_t filePos = (csInt64_t)myFile->tellg();
     std::getline( *myFile, line );
     if( line[0] == 'S' ) {
       csDataSource* dataSource = new csDataSource();
       scanSource( line, dataSource );
       dataSource->lineNumber = lineCounter;
+      dataSource->filePos    = filePos;
       mySourceData->insertEnd( dataSource );
     }
     lineCounter += 1;
@@ -164,6 +231,7 @@ bool csP190Reader::readAllSources() {
 
   myFile->clear();                 // clear fail and eof bits
   myFile->seekg( 0, std::ios::beg); // back to the start
+  myCurrentLineNumber = 0;
   return true;
 }
 //--------------------------------------------------
@@ -171,11 +239,13 @@ bool csP190Reader::readAllSources() {
 bool csP190Reader::readChannels( int source ) {
   if( myCurrentSource == source ) return true;
 
-  int sourceIndexNew = getSourceIndex( source, myCurrentSourceIndex );
+  int sourceIndexNew = getSourceIndex( source );
   if( sourceIndexNew < 0 ) return false; // Source not found
 
   csDataSource* dsNew = mySourceData->at(sourceIndexNew);
-  setFilePointerToStartOfLine( dsNew->lineNumber );
+  myFile->clear();                 // clear fail and eof bits
+  myFile->seekg( (std::streamoff)dsNew->filePos, std::ios::beg );
+  myCurrentLineNumber = dsNew->lineNumber;
   int endLine = (sourceIndexNew == mySourceData->size()-1) ? std::numeric_limits<int>::max() : mySourceData->at(sourceIndexNew+1)->lineNumber;
 
   int counterChannels = 0;
@@ -195,6 +265,16 @@ bool csP190Reader::readChannels( int source ) {
   }
   myCurrentChanData->remove( counterChannels, myCurrentChanData->size()-counterChannels );
 
+  myChanTable->clear();
+  double keys[2];
+  for( int ichan = 0; ichan < counterChannels; ichan++ ) {
+    keys[0] = myCurrentChanData->at(ichan)->chan;
+    keys[1] = myCurrentChanData->at(ichan)->cable;
+    myChanTable->addRecord( keys, NULL );
+  }
+  myChanTable->buildIndex();
+  myNumChannelReads += 1;
+
   //  myCurrentMinChan = myCurrentChanData->at(0)->chan;
   //  myCurrentMaxChan = myCurrentChanData->at( myCurrentChanData->size()-1 )->chan;
 
@@ -7,9 +7,11 @@
 #include <cstdio>
 #include <string>
 #include <fstream>
+#include "geolib_defines.h"
 
 namespace cseis_geolib {
   template <typename T> class csVector;
+  class csKeyTable;
 }
 
 namespace cseis_io {
@@ -27,6 +29,8 @@ class csDataSource {
   double y;
   double z;
   int lineNumber;
+  /// Byte position of source line in file
+  csInt64_t filePos;
 };
 
 class csDataChan {
@@ -39,14 +43,38 @@ class csDataChan {
 };
 
 
+/**
+ * P1/90 navigation file reader
+ *
+ * All source records are read in on initialization, together with the file position of each source record.
+ * Receiver records of one source are read in when a channel of this source is requested, by seeking directly to
+ * the source record. Sources, and channels/cables of the current source, are found through hash indexes
+ * (csKeyTable), so that traces may be requested in any order.
+ * Optionally, source records are stored in a binary cache file, so that the P1/90 file is not scanned again in a
+ * later run.
+ */
 class csP190Reader {
  public:
   csP190Reader( std::string const& filename );
   ~csP190Reader();
 
-  void initialize();
+  /**
+   * Read in all source records
+   * @param cacheFilename  Name of binary cache file for source records. Pass empty string to not use a cache file
+   * @return true if source records were read in from cache file
+   * @throws csException if the P1/90 file cannot be read
+   */
+  bool initialize( std::string const& cacheFilename = "" );
+  /**
+   * Write source records to binary cache file. Call after initialize() with the same cache file name
+   * @throws csException if cache file cannot be written
+   */
+  void writeCache( std::string const& cacheFilename ) const;
   csDataSource const* getSource( int source );
   csDataChan const* getChan( int source, int chan, int cable );
+  int numSources() const;
+  /// @return Number of times receiver records of a source were read in
+  int numChannelReads() const { return myNumChannelReads; }
 
   void dump() const;
   void dumpAllSourceInfo() const;
@@ -55,8 +83,13 @@ class csP190Reader {
   bool readChannels( int source );
   int scanChan( std::string& line, int index );
   void scanSource( std::string& line, csDataSource* data );
-  void setFilePointerToStartOfLine( int lineNum );
-  int getSourceIndex( int source, int startIndex ) const;
+  int getSourceIndex( int source );
+  void storeSources( cseis_geolib::csKeyTable* table ) const;
+  void retrieveSources( cseis_geolib::csKeyTable const* table );
+
+  std::string myFilename;
+  /// Signature of cache file: Input file name, size and time stamp
+  std::string myCacheSignature;
 
   std::ifstream* myFile;
   //  FILE* myFile;
@@ -70,6 +103,11 @@ class csP190Reader {
   //  csDataSource myCurrentSourceData;
   cseis_geolib::csVector<csDataChan*>* myCurrentChanData;
   cseis_geolib::csVector<csDataSource*>* mySourceData;
+  /// Index of sources: Key = source point. Record index = source index
+  cseis_geolib::csKeyTable* mySourceTable;
+  /// Index of receivers of current source: Key = channel, cable. Record index = channel index
+  cseis_geolib::csKeyTable* myChanTable;
+  int myNumChannelReads;
 };
 
 
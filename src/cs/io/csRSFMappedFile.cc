@@ -0,0 +1,327 @@
+/* Copyright (c) Colorado School of Mines, 2013.*/
+/* All rights reserved.                       */
+
+#include "csRSFMappedFile.h"
+#include "csException.h"
+#include "geolib_endian.h"
+#include "geolib_platform_dependent.h"
+#include <string>
+#include <cstring>
+#include <cerrno>
+
+#ifndef PLATFORM_WINDOWS
+extern "C" {
+  #include <fcntl.h>
+  #include <unistd.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+}
+#endif
+
+using namespace cseis_io;
+using namespace cseis_geolib;
+
+csRSFMappedFile::csRSFMappedFile( std::string const& filename, int n1, int n2, int n3, bool doSwapEndian ) {
+  myFilename   = filename;
+  myN1 = n1;
+  myN2 = n2;
+  myN3 = ( n3 > 0 ) ? n3 : 1;
+  myNumTraces  = myN2 * myN3;
+  myTraceByteSize = (csInt64_t)myN1 * 4LL;
+  myFileSize   = myTraceByteSize * (csInt64_t)myNumTraces;
+  myDoSwapEndian = doSwapEndian;
+  myIsOpen     = false;
+  myIsWrite    = false;
+  myData       = NULL;
+  myDirtyStart = 0;
+  myDirtyEnd   = 0;
+  myNumDirtyBytes = 0;
+  myPageSize   = 4096;
+  myFile       = NULL;
+  myTraceBuffer = NULL;
+}
+//-----------------------------------------------------------------------------------------
+csRSFMappedFile::~csRSFMappedFile() {
+  try {
+    close();
+  }
+  catch( csException& e ) {
+    // nothing
+  }
+  if( myTraceBuffer != NULL ) {
+    delete [] myTraceBuffer;
+    myTraceBuffer = NULL;
+  }
+}
+//-----------------------------------------------------------------------------------------
+void csRSFMappedFile::openRead() {
+  if( myIsOpen ) return;
+  myIsWrite = false;
+#ifdef PLATFORM_WINDOWS
+  myFile = fopen( myFilename.c_str(), "rb" );
+  if( myFile == NULL ) {
+    throw csException("Cannot open RSF binary file for reading: %s", myFilename.c_str());
+  }
+  _fseeki64( myFile, 0, SEEK_END );
+  csInt64_t fileSize = _ftelli64( myFile );
+  if( fileSize < myFileSize ) {
+    fclose( myFile );
+    myFile = NULL;
+    throw csException("RSF binary file %s is too small: %lld bytes. Expected %lld bytes (%d traces)", myFilename.c_str(), fileSize, myFileSize, myNumTraces);
+  }
+  myTraceBuffer = new char[myTraceByteSize > 0 ? myTraceByteSize : 1];
+#else
+  int fd = open( myFilename.c_str(), O_RDONLY );
+  if( fd < 0 ) {
+    throw csException("Cannot open RSF binary file for reading: %s", myFilename.c_str());
+  }
+  struct stat fileStat;
+  if( fstat( fd, &fileStat ) != 0 ) {
+    ::close( fd );
+    throw csException("Cannot retrieve size of RSF binary file %s", myFilename.c_str());
+  }
+  if( (csInt64_t)fileStat.st_size < myFileSize ) {
+    ::close( fd );
+    throw csException("RSF binary file %s is too small: %lld bytes. Expected %lld bytes (%d traces)", myFilename.c_str(), (csInt64_t)fileStat.st_size, myFileSize, myNumTraces);
+  }
+  if( myFileSize > 0 ) {
+    void* ptr = mmap( NULL, (size_t)myFileSize, PROT_READ, MAP_SHARED, fd, 0 );
+    if( ptr == MAP_FAILED ) {
+      ::close( fd );
+      throw csException("Cannot memory map RSF binary file %s: %s", myFilename.c_str(), strerror(errno));
+    }
+    myData = (char*)ptr;
+  }
+  ::close( fd );
+#endif
+  myIsOpen = true;
+}
+//-----------------------------------------------------------------------------------------
+void csRSFMappedFile::openWrite() {
+  if( myIsOpen ) return;
+  myIsWrite = true;
+  myDirtyStart = 0;
+  myDirtyEnd   = 0;
+  myNumDirtyBytes = 0;
+#ifdef PLATFORM_WINDOWS
+  myFile = fopen( myFilename.c_str(), "wb+" );
+  if( myFile == NULL ) {
+    throw csException("Cannot open RSF binary file for writing: %s", myFilename.c_str());
+  }
+  // Extend file to full size. Traces which are never written remain zero
+  if( myFileSize > 0 ) {
+    char zero = 0;
+    if( _fseeki64( myFile, myFileSize-1, SEEK_SET ) != 0 || fwrite( &zero, 1, 1, myFile ) != 1 ) {
+      fclose( myFile );
+      myFile = NULL;
+      throw csException("Cannot create RSF binary file %s of size %lld bytes", myFilename.c_str(), myFileSize);
+    }
+  }
+  myTraceBuffer = new char[myTraceByteSize > 0 ? myTraceByteSize : 1];
+#else
+  int fd = open( myFilename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666 );
+  if( fd < 0 ) {
+    throw csException("Cannot open RSF binary file for writing: %s", myFilename.c_str());
+  }
+  if( ftruncate( fd, (off_t)myFileSize ) != 0 ) {
+    ::close( fd );
+    throw csException("Cannot create RSF binary file %s of size %lld bytes: %s", myFilename.c_str(), myFileSize, strerror(errno));
+  }
+#ifdef PLATFORM_LINUX
+  // Allocate disk space up front: A full disk would otherwise only be noticed by a bus error when a page is written back
+  if( myFileSize > 0 ) {
+    int err = posix_fallocate( fd, 0, (off_t)myFileSize );
+    if( err == ENOSPC ) {
+      ::close( fd );
+      throw csException("Not enough disk space to write RSF binary file %s (%lld bytes)", myFilename.c_str(), myFileSize);
+    }
+  }
+#endif
+  if( myFileSize > 0 ) {
+    void* ptr = mmap( NULL, (size_t)myFileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+    if( ptr == MAP_FAILED ) {
+      ::close( fd );
+      throw csException("Cannot memory map RSF binary file %s: %s", myFilename.c_str(), strerror(errno));
+    }
+    myData = (char*)ptr;
+  }
+  ::close( fd );
+  long pageSize = sysconf( _SC_PAGESIZE );
+  if( pageSize > 0 ) myPageSize = (csInt64_t)pageSize;
+#endif
+  myIsOpen = true;
+}
+//-----------------------------------------------------------------------------------------
+void csRSFMappedFile::close() {
+  if( !myIsOpen ) return;
+  myIsOpen = false;
+#ifdef PLATFORM_WINDOWS
+  if( myFile != NULL ) {
+    int err = fclose( myFile );
+    myFile = NULL;
+    if( myIsWrite && err != 0 ) {
+      throw csException("Error occurred when closing RSF binary file %s", myFilename.c_str());
+    }
+  }
+#else
+  if( myData != NULL ) {
+    bool success = true;
+    if( myIsWrite ) {
+      success = ( msync( myData, (size_t)myFileSize, MS_SYNC ) == 0 );
+    }
+    munmap( myData, (size_t)myFileSize );
+    myData = NULL;
+    if( !success ) {
+      throw csException("Error occurred when writing RSF binary file %s: %s", myFilename.c_str(), strerror(errno));
+    }
+  }
+#endif
+}
+//-----------------------------------------------------------------------------------------
+void csRSFMappedFile::checkTraceRange( int firstTrace, int numTraces, int traceStride ) const {
+  if( !myIsOpen ) {
+    throw csException("csRSFMappedFile: RSF binary file %s has not been opened. This is a program bug in the calling function", myFilename.c_str());
+  }
+  if( numTraces <= 0 ) return;
+  csInt64_t lastTrace = (csInt64_t)firstTrace + (csInt64_t)(numTraces-1) * (csInt64_t)traceStride;
+  if( firstTrace < 0 || traceStride <= 0 || lastTrace >= (csInt64_t)myNumTraces ) {
+    throw csException("csRSFMappedFile: Trace range out of bounds: first trace %d, %d traces, stride %d (number of traces in file: %d). This is a program bug in the calling function",
+                      firstTrace, numTraces, traceStride, myNumTraces);
+  }
+}
+//-----------------------------------------------------------------------------------------
+void csRSFMappedFile::readTraces( int firstTrace, int numTraces, int traceStride, float* buffer, int numSamples ) const {
+  checkTraceRange( firstTrace, numTraces, traceStride );
+  int numSamplesCopy = numSamples < myN1 ? numSamples : myN1;
+  int numBytesCopy   = numSamplesCopy * 4;
+  for( int itrc = 0; itrc < numTraces; itrc++ ) {
+    csInt64_t bytePos = (csInt64_t)( firstTrace + itrc*traceStride ) * myTraceByteSize;
+    char* samplesOut = (char*)&buffer[(csInt64_t)itrc*numSamples];
+#ifdef PLATFORM_WINDOWS
+    if( _fseeki64( myFile, bytePos, SEEK_SET ) != 0 || fread( samplesOut, 1, numBytesCopy, myFile ) != (size_t)numBytesCopy ) {
+      throw csException("Error occurred when reading from RSF binary file %s", myFilename.c_str());
+    }
+#else
+    memcpy( samplesOut, &myData[bytePos], numBytesCopy );
+#endif
+    if( myDoSwapEndian ) swapEndian4( samplesOut, numBytesCopy );
+    if( numSamples > numSamplesCopy ) {
+      memset( &samplesOut[numBytesCopy], 0, (numSamples-numSamplesCopy)*4 );
+    }
+  }
+}
+//-----------------------------------------------------------------------------------------
+void csRSFMappedFile::writeTraces( int firstTrace, int numTraces, int traceStride, float const* buffer, int numSamples ) {
+  if( !myIsWrite ) {
+    throw csException("csRSFMappedFile: RSF binary file %s has not been opened for writing. This is a program bug in the calling function", myFilename.c_str());
+  }
+  checkTraceRange( firstTrace, numTraces, traceStride );
+  int numSamplesCopy = numSamples < myN1 ? numSamples : myN1;
+  int numBytesCopy   = numSamplesCopy * 4;
+  for( int itrc = 0; itrc < numTraces; itrc++ ) {
+    csInt64_t bytePos = (csInt64_t)( firstTrace + itrc*traceStride ) * myTraceByteSize;
+    char const* samplesIn = (char const*)&buffer[(csInt64_t)itrc*numSamples];
+#ifdef PLATFORM_WINDOWS
+    char* samplesOut = myTraceBuffer;
+#else
+    char* samplesOut = &myData[bytePos];
+#endif
+    memcpy( samplesOut, samplesIn, numBytesCopy );
+    if( myTraceByteSize > numBytesCopy ) {
+      memset( &samplesOut[numBytesCopy], 0, myTraceByteSize-numBytesCopy );
+    }
+    if( myDoSwapEndian ) swapEndian4( samplesOut, numBytesCopy );
+#ifdef PLATFORM_WINDOWS
+    if( _fseeki64( myFile, bytePos, SEEK_SET ) != 0 || fwrite( samplesOut, 1, myTraceByteSize, myFile ) != (size_t)myTraceByteSize ) {
+      throw csException("Error occurred when writing to RSF binary file %s", myFilename.c_str());
+    }
+#else
+    markDirty( bytePos, bytePos + myTraceByteSize );
+#endif
+  }
+}
+//-----------------------------------------------------------------------------------------
+void csRSFMappedFile::readSlice( int sampleIndex, int firstTrace, int numTraces, int traceStride, float* values ) const {
+  checkTraceRange( firstTrace, numTraces, traceStride );
+  if( sampleIndex < 0 || sampleIndex >= myN1 ) {
+    throw csException("csRSFMappedFile: Sample index out of bounds: %d (number of samples: %d). This is a program bug in the calling function", sampleIndex, myN1);
+  }
+  csInt64_t bytePos  = (csInt64_t)firstTrace * myTraceByteSize + (csInt64_t)sampleIndex * 4LL;
+  csInt64_t byteStep = (csInt64_t)traceStride * myTraceByteSize;
+  for( int itrc = 0; itrc < numTraces; itrc++ ) {
+#ifdef PLATFORM_WINDOWS
+    if( _fseeki64( myFile, bytePos, SEEK_SET ) != 0 || fread( &values[itrc], 4, 1, myFile ) != 1 ) {
+      throw csException("Error occurred when reading from RSF binary file %s", myFilename.c_str());
+    }
+#else
+    memcpy( &values[itrc], &myData[bytePos], 4 );
+#endif
+    bytePos += byteStep;
+  }
+  if( myDoSwapEndian ) swapEndian4( (char*)values, numTraces*4 );
+}
+//-----------------------------------------------------------------------------------------
+void csRSFMappedFile::readSlices( int firstSampleIndex, int numSlices, int firstTrace, int numTraces, int traceStride, float* values ) const {
+  checkTraceRange( firstTrace, numTraces, traceStride );
+  if( numSlices <= 0 ) return;
+  if( firstSampleIndex < 0 || firstSampleIndex + numSlices > myN1 ) {
+    throw csException("csRSFMappedFile: Sample index range out of bounds: %d-%d (number of samples: %d). This is a program bug in the calling function",
+                      firstSampleIndex, firstSampleIndex + numSlices - 1, myN1);
+  }
+  csInt64_t bytePos  = (csInt64_t)firstTrace * myTraceByteSize + (csInt64_t)firstSampleIndex * 4LL;
+  csInt64_t byteStep = (csInt64_t)traceStride * myTraceByteSize;
+  for( int itrc = 0; itrc < numTraces; itrc++ ) {
+#ifdef PLATFORM_WINDOWS
+    if( _fseeki64( myFile, bytePos, SEEK_SET ) != 0 || fread( myTraceBuffer, 4, numSlices, myFile ) != (size_t)numSlices ) {
+      throw csException("Error occurred when reading from RSF binary file %s", myFilename.c_str());
+    }
+    char const* samplesIn = myTraceBuffer;
+#else
+    char const* samplesIn = &myData[bytePos];
+#endif
+    for( int islice = 0; islice < numSlices; islice++ ) {
+      memcpy( &values[(csInt64_t)islice*numTraces + itrc], &samplesIn[islice*4], 4 );
+    }
+    bytePos += byteStep;
+  }
+  if( myDoSwapEndian ) swapEndian4( (char*)values, numSlices*numTraces*4 );
+}
+//-----------------------------------------------------------------------------------------
+void csRSFMappedFile::prefetch( int firstTrace, int numTraces ) const {
+#ifndef PLATFORM_WINDOWS
+  if( myData == NULL || numTraces <= 0 ) return;
+  if( firstTrace < 0 ) firstTrace = 0;
+  if( firstTrace + numTraces > myNumTraces ) numTraces = myNumTraces - firstTrace;
+  if( numTraces <= 0 ) return;
+  csInt64_t bytePosStart = (csInt64_t)firstTrace * myTraceByteSize;
+  bytePosStart -= bytePosStart % myPageSize;
+  csInt64_t bytePosEnd = (csInt64_t)( firstTrace + numTraces ) * myTraceByteSize;
+  madvise( &myData[bytePosStart], (size_t)(bytePosEnd - bytePosStart), MADV_WILLNEED );
+#endif
+}
+//-----------------------------------------------------------------------------------------
+void csRSFMappedFile::markDirty( csInt64_t bytePosStart, csInt64_t bytePosEnd ) {
+  bytePosStart -= bytePosStart % myPageSize;
+  if( myNumDirtyBytes == 0 ) {
+    myDirtyStart = bytePosStart;
+    myDirtyEnd   = bytePosEnd;
+  }
+  else {
+    if( bytePosStart < myDirtyStart ) myDirtyStart = bytePosStart;
+    if( bytePosEnd > myDirtyEnd ) myDirtyEnd = bytePosEnd;
+  }
+  myNumDirtyBytes += bytePosEnd - bytePosStart;
+  if( myNumDirtyBytes >= ASYNC_FLUSH_BYTE_SIZE ) {
+    flushAsync();
+  }
+}
+//-----------------------------------------------------------------------------------------
+void csRSFMappedFile::flushAsync() {
+#ifndef PLATFORM_WINDOWS
+  // Schedule write-back of modified pages without waiting for completion
+  if( myNumDirtyBytes > 0 && myData != NULL ) {
+    msync( &myData[myDirtyStart], (size_t)(myDirtyEnd - myDirtyStart), MS_ASYNC );
+  }
+#endif
+  myNumDirtyBytes = 0;
+}
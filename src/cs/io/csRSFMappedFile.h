@@ -0,0 +1,130 @@
+/* Copyright (c) Colorado School of Mines, 2013.*/
+/* All rights reserved.                       */
+
+#ifndef CS_RSF_MAPPED_FILE_H
+#define CS_RSF_MAPPED_FILE_H
+
+#include <cstdio>
+#include <string>
+#include "geolib_defines.h"
+
+namespace cseis_io {
+
+/**
+ * Memory mapped RSF binary file
+ *
+ * Provides random access to the RSF hypercube n1 x n2 x n3 (4 byte floating point samples) without explicit seek
+ * operations: The binary file is mapped into memory, and traces are copied directly from/to the mapped file.
+ * Traces are addressed by trace index = i3*n2 + i2.
+ *  - Slab access: Read/write a number of traces in one go. A trace stride of 1 accesses consecutive traces
+ *    along dimension 2, a trace stride of n2 accesses traces along dimension 3.
+ *  - Time slice access: Read one sample from a number of (strided) traces, or a block of consecutive
+ *    time slices in one pass over the traces.
+ * When writing, modified pages are flushed to disk asynchronously every ASYNC_FLUSH_BYTE_SIZE bytes, and
+ * synchronously when the file is closed.
+ * On Windows, the file is accessed by seek/read/write operations instead of memory mapping.
+ *
+ * @author Bjorn Olofsson
+ * @date 2013
+ */
+class csRSFMappedFile {
+public:
+  /// Number of written bytes after which modified pages are scheduled to be written to disk
+  static csInt64_t const ASYNC_FLUSH_BYTE_SIZE = 64*1024*1024;
+
+  /**
+   * @param filename     Name of RSF binary file
+   * @param n1           Number of samples per trace
+   * @param n2           Number of traces in dimension 2
+   * @param n3           Number of traces in dimension 3
+   * @param doSwapEndian True if samples shall be endian swapped when copied from/to file
+   */
+  csRSFMappedFile( std::string const& filename, int n1, int n2, int n3, bool doSwapEndian );
+  ~csRSFMappedFile();
+  /**
+   * Open existing file for reading
+   * @throws csException if file cannot be opened or is too small for the given dimensions
+   */
+  void openRead();
+  /**
+   * Create file of full hypercube size for writing. Existing file is overwritten.
+   * @throws csException if file cannot be created, for example if there is not enough disk space
+   */
+  void openWrite();
+  /**
+   * Write back all modified pages and close file
+   * @throws csException if modified data cannot be written to disk
+   */
+  void close();
+  /**
+   * Read traces
+   * @param firstTrace   Index of first trace
+   * @param numTraces    Number of traces to read
+   * @param traceStride  Trace index increment between consecutive traces
+   * @param buffer       (o) Trace samples, numSamples per trace
+   * @param numSamples   Number of samples per trace in buffer. Samples beyond n1 are set to zero.
+   */
+  void readTraces( int firstTrace, int numTraces, int traceStride, float* buffer, int numSamples ) const;
+  /**
+   * Write traces
+   * @param numSamples   Number of samples per trace in buffer. Samples beyond numSamples are set to zero in file.
+   */
+  void writeTraces( int firstTrace, int numTraces, int traceStride, float const* buffer, int numSamples );
+  /**
+   * Read time slice: One sample value from each of a number of traces
+   * @param sampleIndex  Sample index
+   * @param values       (o) Sample values, one for each trace
+   */
+  void readSlice( int sampleIndex, int firstTrace, int numTraces, int traceStride, float* values ) const;
+  /**
+   * Read block of consecutive time slices, transposed: Each trace is accessed once for all slices
+   * @param firstSampleIndex  Sample index of first slice
+   * @param numSlices         Number of slices
+   * @param values            (o) Sample values, numTraces values for each slice: values[islice*numTraces + itrc]
+   */
+  void readSlices( int firstSampleIndex, int numSlices, int firstTrace, int numTraces, int traceStride, float* values ) const;
+  /**
+   * Advise the system that the given traces will be accessed soon
+   */
+  void prefetch( int firstTrace, int numTraces ) const;
+
+  inline int n1() const { return myN1; }
+  inline int n2() const { return myN2; }
+  inline int n3() const { return myN3; }
+  inline int numTraces() const { return myNumTraces; }
+  inline char const* filename() const { return myFilename.c_str(); }
+  inline bool isOpen() const { return myIsOpen; }
+
+private:
+  void checkTraceRange( int firstTrace, int numTraces, int traceStride ) const;
+  void markDirty( csInt64_t bytePosStart, csInt64_t bytePosEnd );
+  void flushAsync();
+
+  std::string myFilename;
+  int myN1;
+  int myN2;
+  int myN3;
+  int myNumTraces;
+  csInt64_t myTraceByteSize;
+  csInt64_t myFileSize;
+  bool myDoSwapEndian;
+  bool myIsOpen;
+  bool myIsWrite;
+  /// Start of mapped file
+  char* myData;
+  /// Page aligned byte range of modified data that has not been scheduled for write-back yet
+  csInt64_t myDirtyStart;
+  csInt64_t myDirtyEnd;
+  csInt64_t myNumDirtyBytes;
+  csInt64_t myPageSize;
+  /// Only used if file is not memory mapped
+  FILE* myFile;
+  char* myTraceBuffer;
+
+  csRSFMappedFile( csRSFMappedFile const& obj );
+  csRSFMappedFile& operator=( csRSFMappedFile const& obj );
+};
+
+} // namespace
+
+#endif
@@ -3,6 +3,7 @@
 
 #include "csRSFReader.h"
 #include "csRSFHeader.h"
+#include "csRSFMappedFile.h"
 #include "csException.h"
 #include "csVector.h"
 #include "csFileUtils.h"
@@ -44,7 +45,6 @@ csRSFReader::csRSFReader( std::string filenameRSF, int numTracesBuffer, bool rev
 
   mySampleByteSize = 0;
   myTraceByteSize = 0;
-  myFileSize = cseis_geolib::csFileUtils::FILESIZE_UNKNOWN;
 
   myBufferNumTraces = 0;
   // Index pointer to current trace in buffer
@@ -57,7 +57,8 @@ csRSFReader::csRSFReader( std::string filenameRSF, int numTracesBuffer, bool rev
   myCurrentFileTraceIndex = 0;
   myCurrentTraceIndex = 0;
 
-  myFileBin = NULL;
+  myReadOrder  = csRSFReader::ORDER_DIM2;
+  myMappedFile = NULL;
 }
 //-----------------------------------------------------------------------------------------
 csRSFReader::~csRSFReader() {
@@ -74,11 +75,6 @@ csRSFReader::~csRSFReader() {
     delete [] myDataBuffer;
     myDataBuffer = NULL;
   }
-  if( myFileBin ) {
-    myFileBin->close();
-    delete myFileBin;
-    myFileBin = NULL;
-  }
   if( myHdr ) {
     delete myHdr;
     myHdr = NULL;
@@ -151,23 +147,21 @@ void csRSFReader::initialize( csRSFHeader* hdr ) {
 
 //-----------------------------------------------------------------------------------------
 void csRSFReader::openBinFile() {
-  myFileBin = new std::ifstream();
-  myFileBin->open( myHdr->filename_bin_full_path.c_str(), std::ios::in | std::ios::binary );
-  if( myFileBin->fail() ) {
-    throw csException("Cannot open RSF binary file for reading: %s", myHdr->filename_bin_full_path.c_str());
-  }
+  myMappedFile = new csRSFMappedFile( myHdr->filename_bin_full_path, myNumSamples, myHdr->n2, myHdr->n3, myDoSwapEndian );
   try {
-    myFileSize = cseis_geolib::csFileUtils::retrieveFileSize( myHdr->filename_bin_full_path );
+    myMappedFile->openRead();
   }
-  catch( cseis_geolib::csException& e ) {
-    throw cseis_geolib::csException("Error occurred while determining file size. System message: %s\n", e.getMessage() );
+  catch( csException& e ) {
+    delete myMappedFile;
+    myMappedFile = NULL;
+    throw;
   }
 }
 void csRSFReader::closeFile() {
-  if( myFileBin != NULL ) {
-    myFileBin->close();
-    delete myFileBin;
-    myFileBin = NULL;
+  if( myMappedFile != NULL ) {
+    myMappedFile->close();
+    delete myMappedFile;
+    myMappedFile = NULL;
   }
 }
 
@@ -260,7 +254,6 @@ bool csRSFReader::getNextTrace( byte_t* theBuffer, int numSamplesToRead ) {
   }
 
   if( myBufferCurrentTrace == myBufferNumTraces ) {
-    if( myFileBin->eof() ) return false;
     bool success = readDataBuffer();
     if( !success ) return false;
   }
@@ -273,7 +266,7 @@ bool csRSFReader::getNextTrace( byte_t* theBuffer, int numSamplesToRead ) {
     memset( &theBuffer[minNumSamples*mySampleByteSize], 0, (numSamplesToRead-minNumSamples)*mySampleByteSize );
   }
 
-  myCurrentTraceIndex = myCurrentFileTraceIndex - (myBufferNumTraces-myBufferCurrentTrace);
+  myCurrentTraceIndex = traceIndexAt( myCurrentFileTraceIndex - (myBufferNumTraces-myBufferCurrentTrace) );
   myBufferCurrentTrace += 1;
 
   return true;
@@ -288,19 +281,22 @@ bool csRSFReader::readDataBuffer() {
   myBufferNumTraces = std::min( myBufferCapacityNumTraces, myTotalNumTraces - myCurrentFileTraceIndex );
   //  fprintf(stdout,"readDataBuffer, capacity: %d, totNumTraces: %d, bufferNumTraces: %d, total num bytes: %d\n", myBufferCapacityNumTraces, myTotalNumTraces, myBufferNumTraces, myTraceByteSize*myBufferNumTraces );
 
-  myFileBin->clear(); // Clear all flags
-  myFileBin->read( myDataBuffer, myTraceByteSize*myBufferNumTraces );
-  if( myFileBin->fail() ) {
-    closeFile();
-    throw( cseis_geolib::csException("csRSFReader::readDataBuffer: Unexpected error (1) occurred when reading in data from input file '%s'", myFilenameRSF.c_str()) );
+  // Traces in one buffer are equidistant in the file: Consecutive traces in dimension 2, or every n2'th trace in dimension 3
+  int traceStride = 1;
+  if( myReadOrder == csRSFReader::ORDER_DIM3 ) {
+    int numTracesDim3 = myTotalNumTraces / myHdr->n2;
+    myBufferNumTraces = std::min( myBufferNumTraces, numTracesDim3 - (myCurrentFileTraceIndex % numTracesDim3) );
+    traceStride = myHdr->n2;
   }
-  else if( myFileBin->eof() ) {
-    return false;
+  try {
+    myMappedFile->readTraces( traceIndexAt(myCurrentFileTraceIndex), myBufferNumTraces, traceStride, (float*)myDataBuffer, myNumSamples );
   }
-  if( myDoSwapEndian ) {
-    for( int itrc = 0; itrc < myBufferNumTraces; itrc++ ) {
-      swapEndian4( myDataBuffer+myTraceByteSize*itrc, myTraceByteSize );
-    }
+  catch( csException& e ) {
+    closeFile();
+    throw( cseis_geolib::csException("csRSFReader::readDataBuffer: Unexpected error occurred when reading in data from input file '%s': %s", myFilenameRSF.c_str(), e.getMessage()) );
+  }
+  if( myReadOrder == csRSFReader::ORDER_DIM2 ) {
+    myMappedFile->prefetch( myCurrentFileTraceIndex + myBufferNumTraces, myBufferCapacityNumTraces );
   }
 
   myBufferCurrentTrace = 0;
@@ -339,20 +335,21 @@ bool csRSFReader::moveToTrace( int traceIndex, int numTracesToRead ) {
   if( !myHasBeenInitialized ) {
     throw( cseis_geolib::csException("csRSFReader::moveToTrace: Input file has not been initialized yet. This is a program bug in the calling function") );
   }
-  else if( myFileSize == cseis_geolib::csFileUtils::FILESIZE_UNKNOWN ) {
-    throw( cseis_geolib::csException("csRSFReader::moveToTrace: File size unknown. This may be due to a compatibility problem of this compiled version of the program on the current platform." ) );
-  }
   else if( traceIndex < 0 || traceIndex >= myTotalNumTraces ) {
     throw( cseis_geolib::csException("csRSFReader::moveToTrace: Incorrect trace index: %d (number of traces in input file: %d). This is a program bug in the calling method", traceIndex, myTotalNumTraces) );
   }
 
-  if( myCurrentFileTraceIndex != traceIndex ) {
-    csInt64_t bytePosRelative = (csInt64_t)(traceIndex-myCurrentFileTraceIndex) * (csInt64_t)myTraceByteSize;
-    if( !seekg_relative( bytePosRelative ) ) return false;
+  int readPosition = readPositionOf( traceIndex );
+  int bufferStartPosition = myCurrentFileTraceIndex - myBufferNumTraces;
+  if( readPosition >= bufferStartPosition && readPosition < myCurrentFileTraceIndex ) {
+    // Trace is already in buffer
+    myBufferCurrentTrace = readPosition - bufferStartPosition;
+  }
+  else {
     myBufferNumTraces    = 0;
     myBufferCurrentTrace = 0;
+    myCurrentFileTraceIndex = readPosition;
   }
-  myCurrentFileTraceIndex  = traceIndex;
   myCurrentTraceIndex  = traceIndex;
 
   // Index of last trace that will be read in one go by consecutive calls to getNextTrace()
@@ -382,9 +379,6 @@ bool csRSFReader::peekHeaderValue( cseis_geolib::csFlexHeader* hdrValue, int tra
   if( !myHasBeenInitialized ) {
     throw( cseis_geolib::csException("csRSFReader::peek: Reader object has not been initialized. This is a program bug in the calling function") );
   }
-  else if( myFileSize == cseis_geolib::csFileUtils::FILESIZE_UNKNOWN ) {
-    throw( cseis_geolib::csException("csRSFReader::peek: File size unknown. This may be due to a compatibility problem of this compiled version of the program on the current platform." ) );
-  }
   else if( myPeekHdr == csRSFHeader::HDR_NONE ) {
     throw(cseis_geolib::csException("csRSFReader::peekHeaderValue: No header has been set for checking. This is a program bug in the calling function"));
   }
@@ -405,24 +399,37 @@ bool csRSFReader::peekHeaderValue( cseis_geolib::csFlexHeader* hdrValue, int tra
   return true;;
 }
 
-bool csRSFReader::seekg_relative( csInt64_t bytePosRelative ) {
-  // Complex algorithm to be able to make step that is larger than 2Gb : Make several smaller steps instead
-  
-  int maxInt = std::numeric_limits<int>::max() - 1;   // -1 to be on the safe side, also for negative byte positions
-  if( bytePosRelative < 0 ) maxInt *= -1;
-  
-  csInt64_t numSteps  = bytePosRelative / (csInt64_t)maxInt + 1LL;
-  int bytePosResidual = (int)(bytePosRelative % (csInt64_t)maxInt);
-  
-  for( csInt64_t istep = 0; istep < numSteps - 1; ++istep ) { 
-    myFileBin->clear(); // Clear all flags
-    myFileBin->seekg( maxInt, std::ios_base::cur );
-    if( myFileBin->fail() ) return false;
+void csRSFReader::setReadOrder( int order ) {
+  if( order != csRSFReader::ORDER_DIM2 && order != csRSFReader::ORDER_DIM3 ) {
+    throw( cseis_geolib::csException("csRSFReader::setReadOrder: Unknown read order: %d. This is a program bug in the calling function", order) );
   }
-  
-  myFileBin->seekg( bytePosResidual, std::ios_base::cur );
-  
-  return true;
+  myReadOrder = order;
+  myBufferNumTraces       = 0;
+  myBufferCurrentTrace    = 0;
+  myCurrentFileTraceIndex = 0;
+  myCurrentTraceIndex     = 0;
+}
+int csRSFReader::traceIndexAt( int readPosition ) const {
+  if( myReadOrder == csRSFReader::ORDER_DIM2 ) return readPosition;
+  int numTracesDim3 = myTotalNumTraces / myHdr->n2;
+  return( (readPosition % numTracesDim3) * myHdr->n2 + readPosition / numTracesDim3 );
+}
+int csRSFReader::readPositionOf( int traceIndex ) const {
+  if( myReadOrder == csRSFReader::ORDER_DIM2 ) return traceIndex;
+  int numTracesDim3 = myTotalNumTraces / myHdr->n2;
+  return( (traceIndex % myHdr->n2) * numTracesDim3 + traceIndex / myHdr->n2 );
+}
+void csRSFReader::readTimeSlice( int sampleIndex, int index_dim3, float* values ) {
+  if( !myHasBeenInitialized ) {
+    throw( csException("Accessing method to read time slice before initializing RSF Reader. This is a program bug in the calling method") );
+  }
+  myMappedFile->readSlice( sampleIndex, index_dim3*myHdr->n2, myHdr->n2, 1, values );
+}
+void csRSFReader::readTimeSlices( int firstSampleIndex, int numSlices, float* values ) {
+  if( !myHasBeenInitialized ) {
+    throw( csException("Accessing method to read time slices before initializing RSF Reader. This is a program bug in the calling method") );
+  }
+  myMappedFile->readSlices( firstSampleIndex, numSlices, 0, myTotalNumTraces, 1, values );
 }
 //********************************************************************************
 
@@ -6,7 +6,6 @@
 
 #include "csIReader.h"
 #include <cstdio>
-#include <fstream>
 #include <string>
 #include "geolib_defines.h"
 
@@ -19,10 +18,22 @@ namespace cseis_geolib {
 namespace cseis_io {
 
   class csRSFHeader;
-
+  class csRSFMappedFile;
+
+/**
+ * RSF (Madagascar) file reader
+ *
+ * The binary data file is memory mapped. Traces are read in one of two orders, without seek operations:
+ *  ORDER_DIM2: File order. Dimension 2 is the fast dimension (for example inline sections)
+ *  ORDER_DIM3: Dimension 3 is the fast dimension (for example crossline sections)
+ * Time slices can be read directly using methods readTimeSlice() and readTimeSlices().
+ */
 class csRSFReader : public cseis_geolib::csIReader {
 //---------------------------------------------------------------------------------------
 public:
+  static int const ORDER_DIM2 = 0;
+  static int const ORDER_DIM3 = 1;
+
   csRSFReader( std::string filename, int nTracesBuffer, bool reverseByteOrder );
   ~csRSFReader();
   //
@@ -49,6 +60,27 @@ public:
   bool setHeaderToPeek( std::string const& headerName, cseis_geolib::type_t& headerType );
   bool peekHeaderValue( cseis_geolib::csFlexHeader* hdrValue, int traceIndex = -1 );   
 
+  /**
+   * Set order in which traces are read by getNextTrace(). Resets read position to first trace.
+   * @param order  ORDER_DIM2 or ORDER_DIM3
+   */
+  void setReadOrder( int order );
+  inline int readOrder() const { return myReadOrder; }
+  /**
+   * Read one line of a time slice: Sample with given index from all traces in dimension 2
+   * @param sampleIndex  Sample index (0 for first sample)
+   * @param index_dim3   Index in dimension 3 (0 for first line)
+   * @param values       (o) Sample values, n2 values
+   */
+  void readTimeSlice( int sampleIndex, int index_dim3, float* values );
+  /**
+   * Read block of consecutive time slices of the whole cube, in one pass over all traces
+   * @param firstSampleIndex  Sample index of first time slice (0 for first sample)
+   * @param numSlices         Number of time slices
+   * @param values            (o) Sample values, numTraces() values for each time slice, in file trace order.
+   *                              Line index_dim3 of slice islice starts at values[islice*numTraces() + index_dim3*n2]
+   */
+  void readTimeSlices( int firstSampleIndex, int numSlices, float* values );
   bool getNextTrace( cseis_geolib::byte_t* buffer, int numSamplesToRead );
   float const* getNextTracePointer();
   void dump( FILE* stream );
@@ -91,8 +123,11 @@ public:
   int getCurrentTraceIndex() const { return myCurrentTraceIndex; }
 private:
 
-  bool seekg_relative( csInt64_t bytePosRelative );
   void convert2standardUnit();
+  /// @return Index of trace in file at given position in read order
+  int traceIndexAt( int readPosition ) const;
+  /// @return Position in read order of trace with given index in file
+  int readPositionOf( int traceIndex ) const;
   
   csRSFHeader* myHdr;
   int myPeekHdr;
@@ -100,8 +135,6 @@ private:
 
   int   mySampleByteSize;
   int   myTraceByteSize;
-  /// File size in bytes
-  csInt64_t myFileSize;
 
   bool  myIsAtEOF;
   char* myDataBuffer;
@@ -114,8 +147,8 @@ private:
 
   /// Total trace counter of all traces accessed via the getNextTrace() method
   int myTotalTraceCounter;
-  /// Current file pointer: Points to trace with given index in input file
-  /// This is the trace that the file pointer points at, not the trace which has just been retrieved with getNextTrace()
+  /// Current read position: Position in read order of next trace to read into the buffer
+  /// This is not the trace which has just been retrieved with getNextTrace()
   int myCurrentFileTraceIndex;
   /// The current trace that has most recently been retrieved by getNextTrace(), or which is about to be retrieved after a moveTo operation
   int myCurrentTraceIndex;
@@ -124,7 +157,10 @@ private:
   /// true if endian swapping shall be performed.
   bool myDoSwapEndian;
 
-  std::ifstream*  myFileBin;
+  /// Read order, ORDER_DIM2 or ORDER_DIM3
+  int myReadOrder;
+
+  csRSFMappedFile* myMappedFile;
   std::string myFilenameRSF;
 
   float mySampleInt;
@@ -3,6 +3,7 @@
 
 #include "csRSFWriter.h"
 #include "csRSFHeader.h"
+#include "csRSFMappedFile.h"
 #include "csException.h"
 #include "csVector.h"
 #include "csFileUtils.h"
@@ -10,6 +11,7 @@
 #include "csByteConversions.h"
 #include <string>
 #include <cstring>
+#include <cmath>
 
 using namespace cseis_io;
 using namespace cseis_geolib;
@@ -21,21 +23,27 @@ csRSFWriter::csRSFWriter( std::string filename, int nTracesBuffer, bool reverseB
   //  mySwapDim3 = swapDim3;
   myOutputGrid = outputGrid;
   myHdr       = NULL;
+  myFile      = NULL;
+  myIsMapped  = false;
+  myMappedFile = NULL;
   myStage = csRSFWriter::STAGE_1_INIT;
 
   myFilename     = filename;
   myIsAtEOF      = false;
   myDoSwapEndian = reverseByteOrder;
 
-  // Create output files if they do not exist yet. Do not overwrite.
-  bool fileExists = csFileUtils::createDoNotOverwrite( myHdr->filename_bin_full_path );
-  if( !fileExists ) throw( csException("Cannot open RSF binary file for writing: %s", myHdr->filename_bin_full_path.c_str() ) );
-  fileExists = csFileUtils::createDoNotOverwrite( myFilename );
+  // Create output file if it does not exist yet. Do not overwrite. Binary file name is only known after initialization
+  bool fileExists = csFileUtils::createDoNotOverwrite( myFilename );
   if( !fileExists ) throw csException("Cannot open RSF header file for writing: %s", myFilename.c_str());
 }
 //-----------------------------------------------------------------------------------------
 csRSFWriter::~csRSFWriter() {
-  closeFile();
+  try {
+    closeFile();
+  }
+  catch(...) {
+    // nothing
+  }
   try {
     if( myStage == csRSFWriter::STAGE_6_COMPLETE ) {
       finalize();
@@ -63,6 +71,9 @@ void csRSFWriter::initialize( csRSFHeader const* hdr ) {
   myHdr = new csRSFHeader();
   myHdr->set( *hdr );
 
+  bool fileExists = csFileUtils::createDoNotOverwrite( myHdr->filename_bin_full_path );
+  if( !fileExists ) throw( csException("Cannot open RSF binary file for writing: %s", myHdr->filename_bin_full_path.c_str() ) );
+
   myNumSamples = myHdr->n1;
   mySampleInt  = myHdr->d1;
 
@@ -94,6 +105,13 @@ void csRSFWriter::initialize( csRSFHeader const* hdr ) {
   myNumSavedTraces = 0;
 
   myStage = csRSFWriter::STAGE_2_SET_ORIG;
+  if( myHdr->n2 > 0 && myHdr->n3 > 0 ) {
+    if( (myHdr->n2 > 1 && myHdr->d2 == 0) || (myHdr->n3 > 1 && myHdr->d3 == 0) ) {
+      throw( csException("Step/increment of dimension 2 or 3 is zero. Cannot compute trace positions in RSF file") );
+    }
+    myIsMapped = true;
+    myStage = csRSFWriter::STAGE_5_WRITE_RSF;
+  }
   //  myHasBeenInitialized = true;
 }
 //-----------------------------------------------------------------------------------------
@@ -106,6 +124,18 @@ void csRSFWriter::finalize() {
 }
 //-----------------------------------------------------------------------------------------
 void csRSFWriter::openFile() {
+  if( myIsMapped ) {
+    myMappedFile = new csRSFMappedFile( myHdr->filename_bin_full_path, myNumSamples, myHdr->n2, myHdr->n3, myDoSwapEndian );
+    try {
+      myMappedFile->openWrite();
+    }
+    catch( csException& e ) {
+      delete myMappedFile;
+      myMappedFile = NULL;
+      throw;
+    }
+    return;
+  }
   myFile = new std::ofstream();
   myFile->open( myHdr->filename_bin_full_path.c_str(), std::ios::out | std::ios::binary );
   if( myFile->fail() ) {
@@ -124,16 +154,46 @@ void csRSFWriter::openFile() {
   */
 }
 void csRSFWriter::closeFile() {
+  if( myMappedFile != NULL ) {
+    csRSFMappedFile* mappedFile = myMappedFile;
+    myMappedFile = NULL;
+    try {
+      mappedFile->close();
+    }
+    catch( csException& e ) {
+      delete mappedFile;
+      throw;
+    }
+    delete mappedFile;
+  }
   if( myFile != NULL ) {
     if( myNumSavedTraces > 0 ) {
+      if( myDoSwapEndian ) {
+        for( int itrc = 0; itrc < myNumSavedTraces; itrc++ ) {
+          swapEndian4( myBigBuffer+myTotalTraceSize*itrc, myTotalTraceSize );
+        }
+      }
       myFile->write( myBigBuffer, myTotalTraceSize*myNumSavedTraces );
+      myNumSavedTraces = 0;
+      myCurrentTrace   = 0;
     }
-    writeNextTrace( NULL, 0, 0, 0 );
+    bool success = !myFile->fail();
     myFile->close();
     delete myFile;
     myFile = NULL;
+    if( !success ) throw( csException("Unexpected error occurred when writing to RSF file") );
   }
 }
+int csRSFWriter::computeIndex( double value, double origin, double step, int numValues, int dim ) const {
+  if( numValues == 1 && fabs( value - origin ) <= TOLERANCE ) return 0;
+  double position = ( value - origin ) / step;
+  int index = (int)round( position );
+  if( fabs( (position - (double)index) * step ) > TOLERANCE || index < 0 || index >= numValues ) {
+    throw( csException("Trace #%d: Value for dimension%d (%f) does not fall onto output grid (origin: %f, step: %f, number of values: %d)",
+                       myTraceCounter+1, dim, value, origin, step, numValues) );
+  }
+  return index;
+}
 //--------------------------------------------------------------------------------
 //
 bool csRSFWriter::check( double valDim2, double valDim3 ) {
@@ -265,6 +325,18 @@ void csRSFWriter::writeNextTrace( byte_t const* theBuffer, int nSamples, double
   }
   if( nSamples == 0 || nSamples > myNumSamples ) nSamples = myNumSamples;
 
+  if( myIsMapped ) {
+    if( theBuffer == NULL ) return;
+    if( myMappedFile == NULL ) {
+      throw( csException("Accessing method to write trace before opening RSF file. This is a program bug in the calling method") );
+    }
+    int index_dim2 = computeIndex( valDim2, myHdr->o2, myHdr->d2, myHdr->n2, 2 );
+    int index_dim3 = computeIndex( valDim3, myHdr->o3, myHdr->d3, myHdr->n3, 3 );
+    myMappedFile->writeTraces( index_dim3*myHdr->n2 + index_dim2, 1, 1, (float const*)theBuffer, nSamples );
+    myTraceCounter++;
+    return;
+  }
+
   if( myCurrentTrace == NTRACES_BUFFER ) {
     if( myDoSwapEndian ) {
       for( int itrc = 0; itrc < myNumSavedTraces; itrc++ ) {
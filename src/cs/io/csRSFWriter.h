@@ -13,7 +13,17 @@ namespace cseis_io {
 
   template<typename T> class csVector;
   class csRSFHeader;
-
+  class csRSFMappedFile;
+
+/**
+ * RSF (Madagascar) file writer
+ *
+ * If the RSF header passed to initialize() defines dimensions 2 and 3 (n2 > 0 and n3 > 0), the binary file is
+ * created in full size and memory mapped. Every trace is then written to the position defined by its dimension 2
+ * and 3 values, so traces can be written in any order, for example inline or crossline sections.
+ * Traces that are never written are zero.
+ * Otherwise, traces are written sequentially, and dimensions 2 and 3 are determined from the trace values.
+ */
 class csRSFWriter {
 //---------------------------------------------------------------------------------------
 public:
@@ -32,6 +42,8 @@ public:
 
   void writeNextTrace( cseis_geolib::byte_t const* buffer, int nSamples, double valDim2, double valDim3 );
   void finalize();
+  /// @return true if binary file is memory mapped, i.e. dimensions 2 and 3 have been defined in advance
+  inline bool isMapped() const { return myIsMapped; }
 
 private:
   static int const STAGE_1_INIT      = 1;
@@ -41,6 +53,8 @@ private:
   static int const STAGE_5_WRITE_RSF = 5;
   static int const STAGE_6_COMPLETE  = 6;
   bool check( double valDim2, double valDim3 );
+  /// @return Index in given dimension of given value, for memory mapped writing
+  int computeIndex( double value, double origin, double step, int numValues, int dim ) const;
 
   csRSFHeader* myHdr;
 
@@ -67,6 +81,9 @@ private:
   int myCurrentCounterDim2;
 
   std::ofstream*  myFile;
+  /// true if binary file is memory mapped
+  bool myIsMapped;
+  csRSFMappedFile* myMappedFile;
   std::string myFilename;
 
   float mySampleInt;
@@ -0,0 +1,171 @@
+/* Copyright (c) Colorado School of Mines, 2013.*/
+/* All rights reserved.                       */
+
+#include "csSeismicBlock.h"
+#include "csSeismicBlockCodec.h"
+#include "csException.h"
+#include <cstring>
+
+using namespace cseis_io;
+
+csSeismicBlock::csSeismicBlock( int numTracesCapacity, int numSamples, int numHeaders, int const* hdrByteSize, int codec, float tolerance ) {
+  myNumTracesCapacity = numTracesCapacity;
+  myNumTraces  = 0;
+  myNumSamples = numSamples;
+  myNumHeaders = numHeaders;
+  myCodec      = codec;
+  myQuantizationStep = 2.0 * (double)tolerance;
+
+  myHdrByteSize   = new int[myNumHeaders];
+  myHdrByteOffset = new int[myNumHeaders];
+  myByteSizeHdrValueBlock = 0;
+  for( int ihdr = 0; ihdr < myNumHeaders; ihdr++ ) {
+    myHdrByteSize[ihdr]   = hdrByteSize[ihdr];
+    myHdrByteOffset[ihdr] = myByteSizeHdrValueBlock;
+    myByteSizeHdrValueBlock += hdrByteSize[ihdr];
+  }
+
+  int byteSizeHdrs    = myNumTracesCapacity * myByteSizeHdrValueBlock;
+  int byteSizeSamples = myNumTracesCapacity * myNumSamples * 4;
+  int byteSizeWork    = byteSizeHdrs > byteSizeSamples ? byteSizeHdrs : byteSizeSamples;
+
+  myHdrValues = new char[byteSizeHdrs > 0 ? byteSizeHdrs : 1];
+  mySamples   = new float[myNumTracesCapacity * myNumSamples];
+  myEncodedCapacity = csSeismicBlockCodec::lzMaxCompressedSize( byteSizeHdrs ) + csSeismicBlockCodec::lzMaxCompressedSize( byteSizeSamples );
+  myEncoded     = new byte[myEncodedCapacity];
+  myWorkBuffer1 = new byte[byteSizeWork];
+  myWorkBuffer2 = new byte[byteSizeSamples];
+
+  myBlockCodec = myCodec;
+  myByteSizeHdrSection    = 0;
+  myByteSizeSampleSection = 0;
+}
+csSeismicBlock::~csSeismicBlock() {
+  delete [] myHdrByteSize;
+  delete [] myHdrByteOffset;
+  delete [] myHdrValues;
+  delete [] mySamples;
+  delete [] myEncoded;
+  delete [] myWorkBuffer1;
+  delete [] myWorkBuffer2;
+}
+//--------------------------------------------------------------------------------
+//
+void csSeismicBlock::setEncodedInfo( int numTraces, int blockCodec, int byteSizeHdrSection, int byteSizeSampleSection ) {
+  if( numTraces < 0 || numTraces > myNumTracesCapacity || byteSizeHdrSection < 0 || byteSizeSampleSection < 0 ||
+      byteSizeHdrSection + byteSizeSampleSection > myEncodedCapacity ) {
+    throw( cseis_geolib::csException("csSeismicBlock: Inconsistent block directory entry. File corrupt?") );
+  }
+  myNumTraces  = numTraces;
+  myBlockCodec = blockCodec;
+  myByteSizeHdrSection    = byteSizeHdrSection;
+  myByteSizeSampleSection = byteSizeSampleSection;
+}
+//--------------------------------------------------------------------------------
+//
+void csSeismicBlock::encode() {
+  //--------------------------------------------------
+  // Header section: Transpose trace header values into columns
+  int byteSizeHdrs = myNumTraces * myByteSizeHdrValueBlock;
+  for( int ihdr = 0; ihdr < myNumHeaders; ihdr++ ) {
+    int byteSize = myHdrByteSize[ihdr];
+    byte* column = &myWorkBuffer1[myNumTraces*myHdrByteOffset[ihdr]];
+    char const* hdrPtr = &myHdrValues[myHdrByteOffset[ihdr]];
+    for( int itrc = 0; itrc < myNumTraces; itrc++ ) {
+      memcpy( &column[itrc*byteSize], &hdrPtr[itrc*myByteSizeHdrValueBlock], byteSize );
+    }
+  }
+  myByteSizeHdrSection = byteSizeHdrs;
+  if( myCodec != csSeismicBlockCodec::CODEC_NONE ) {
+    myByteSizeHdrSection = csSeismicBlockCodec::lzCompress( myWorkBuffer1, byteSizeHdrs, myEncoded );
+  }
+  if( myByteSizeHdrSection >= byteSizeHdrs ) {
+    myByteSizeHdrSection = byteSizeHdrs;
+    memcpy( myEncoded, myWorkBuffer1, byteSizeHdrs );
+  }
+
+  //--------------------------------------------------
+  // Sample section
+  int numSamplesBlock = myNumTraces * myNumSamples;
+  int byteSizeSamples = numSamplesBlock * 4;
+  byte* samplePtr = &myEncoded[myByteSizeHdrSection];
+  myBlockCodec = myCodec;
+  if( myCodec == csSeismicBlockCodec::CODEC_NONE ) {
+    memcpy( samplePtr, mySamples, byteSizeSamples );
+    myByteSizeSampleSection = byteSizeSamples;
+    return;
+  }
+  byte const* bufferToShuffle = (byte const*)mySamples;
+  if( myCodec == csSeismicBlockCodec::CODEC_LOSSY ) {
+    unsigned int* valuesPtr = (unsigned int*)myWorkBuffer2;
+    for( int itrc = 0; itrc < myNumTraces; itrc++ ) {
+      if( !csSeismicBlockCodec::quantize( &mySamples[itrc*myNumSamples], myNumSamples, myQuantizationStep, &valuesPtr[itrc*myNumSamples] ) ) {
+        // Sample values out of range for given error tolerance: Store this block losslessly
+        myBlockCodec = csSeismicBlockCodec::CODEC_LOSSLESS;
+        break;
+      }
+    }
+    if( myBlockCodec == csSeismicBlockCodec::CODEC_LOSSY ) bufferToShuffle = myWorkBuffer2;
+  }
+  csSeismicBlockCodec::shuffle( bufferToShuffle, myWorkBuffer1, numSamplesBlock, 4 );
+  myByteSizeSampleSection = csSeismicBlockCodec::lzCompress( myWorkBuffer1, byteSizeSamples, samplePtr );
+  if( myByteSizeSampleSection >= byteSizeSamples ) {
+    myByteSizeSampleSection = byteSizeSamples;
+    memcpy( samplePtr, myWorkBuffer1, byteSizeSamples );
+  }
+}
+//--------------------------------------------------------------------------------
+//
+void csSeismicBlock::decodeSection( byte const* bufferIn, int numBytesIn, byte* bufferOut, int numBytesOut, bool isCompressed ) {
+  if( !isCompressed ) {
+    if( numBytesIn != numBytesOut ) {
+      throw( cseis_geolib::csException("csSeismicBlock: Unexpected byte size of uncompressed block section: %d != %d. File corrupt?", numBytesIn, numBytesOut) );
+    }
+    memcpy( bufferOut, bufferIn, numBytesOut );
+  }
+  else if( !csSeismicBlockCodec::lzDecompress( bufferIn, numBytesIn, bufferOut, numBytesOut ) ) {
+    throw( cseis_geolib::csException("csSeismicBlock: Error occurred when decompressing block. File corrupt?") );
+  }
+}
+void csSeismicBlock::decodeHeaders() {
+  int byteSizeHdrs = myNumTraces * myByteSizeHdrValueBlock;
+  decodeSection( myEncoded, myByteSizeHdrSection, myWorkBuffer1, byteSizeHdrs, myByteSizeHdrSection != byteSizeHdrs );
+  for( int ihdr = 0; ihdr < myNumHeaders; ihdr++ ) {
+    int byteSize = myHdrByteSize[ihdr];
+    byte const* column = &myWorkBuffer1[myNumTraces*myHdrByteOffset[ihdr]];
+    char* hdrPtr = &myHdrValues[myHdrByteOffset[ihdr]];
+    for( int itrc = 0; itrc < myNumTraces; itrc++ ) {
+      memcpy( &hdrPtr[itrc*myByteSizeHdrValueBlock], &column[itrc*byteSize], byteSize );
+    }
+  }
+}
+void csSeismicBlock::decode() {
+  decodeHeaders();
+
+  int numSamplesBlock = myNumTraces * myNumSamples;
+  int byteSizeSamples = numSamplesBlock * 4;
+  byte const* samplePtr = &myEncoded[myByteSizeHdrSection];
+  if( myBlockCodec == csSeismicBlockCodec::CODEC_NONE ) {
+    decodeSection( samplePtr, myByteSizeSampleSection, (byte*)mySamples, byteSizeSamples, false );
+    return;
+  }
+  decodeSection( samplePtr, myByteSizeSampleSection, myWorkBuffer1, byteSizeSamples, myByteSizeSampleSection != byteSizeSamples );
+  if( myBlockCodec == csSeismicBlockCodec::CODEC_LOSSY ) {
+    csSeismicBlockCodec::unshuffle( myWorkBuffer1, myWorkBuffer2, numSamplesBlock, 4 );
+    unsigned int const* valuesPtr = (unsigned int const*)myWorkBuffer2;
+    for( int itrc = 0; itrc < myNumTraces; itrc++ ) {
+      csSeismicBlockCodec::dequantize( &valuesPtr[itrc*myNumSamples], myNumSamples, myQuantizationStep, &mySamples[itrc*myNumSamples] );
+    }
+  }
+  else if( myBlockCodec == csSeismicBlockCodec::CODEC_LOSSLESS ) {
+    csSeismicBlockCodec::unshuffle( myWorkBuffer1, (byte*)mySamples, numSamplesBlock, 4 );
+  }
+  else {
+    throw( cseis_geolib::csException("csSeismicBlock: Unknown block codec: %d. File corrupt?", myBlockCodec) );
+  }
+}
+//--------------------------------------------------------------------------------
+//
+void csSeismicBlock::getHdrBytes( int traceIndex, int byteOffset, int byteSize, char* buffer ) const {
+  memcpy( buffer, &myHdrValues[traceIndex*myByteSizeHdrValueBlock + byteOffset], byteSize );
+}
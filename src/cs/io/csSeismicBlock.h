@@ -0,0 +1,125 @@
+/* Copyright (c) Colorado School of Mines, 2013.*/
+/* All rights reserved.                       */
+
+#ifndef CS_SEISMIC_BLOCK_H
+#define CS_SEISMIC_BLOCK_H
+
+#include <cstdio>
+#include "csIODefines.h"
+#include "csThreadPool.h"
+
+namespace cseis_io {
+
+/**
+ * Block of traces, SeaSeis format version 0.5
+ *
+ * Holds decoded trace headers and samples of up to N consecutive traces, and the encoded block as stored on disk.
+ * Encoded block = [header section][sample section]:
+ * - Header section: Trace header values stored by column, i.e. the values of one trace header for all traces in the block
+ *   are stored next to each other. LZ compressed unless codec is CODEC_NONE.
+ * - Sample section: Trace samples, encoded with the block's codec.
+ * A section whose byte size equals its uncompressed byte size is stored uncompressed.
+ *
+ * @author Bjorn Olofsson
+ * @date 2013
+ */
+class csSeismicBlock {
+public:
+  /**
+   * @param numTracesCapacity     Maximum number of traces in block
+   * @param numSamples            Number of samples per trace
+   * @param numHeaders            Number of trace headers
+   * @param hdrByteSize           Byte size of each trace header in header value block
+   * @param codec                 Sample codec, see csSeismicBlockCodec
+   * @param tolerance             Maximum absolute sample error for CODEC_LOSSY
+   */
+  csSeismicBlock( int numTracesCapacity, int numSamples, int numHeaders, int const* hdrByteSize, int codec, float tolerance );
+  ~csSeismicBlock();
+  /**
+   * Encode traces currently held in block
+   */
+  void encode();
+  /**
+   * Decode header and sample sections. Encoded block must have been set beforehand.
+   */
+  void decode();
+  /**
+   * Decode header section only
+   */
+  void decodeHeaders();
+  /**
+   * Set information on encoded block, as read from block directory.
+   * Encoded bytes must be copied to encodedBuffer().
+   */
+  void setEncodedInfo( int numTraces, int blockCodec, int byteSizeHdrSection, int byteSizeSampleSection );
+
+  inline int numTraces() const { return myNumTraces; }
+  inline void setNumTraces( int numTraces ) { myNumTraces = numTraces; }
+  inline int numTracesCapacity() const { return myNumTracesCapacity; }
+  inline int byteSizeHdrValueBlock() const { return myByteSizeHdrValueBlock; }
+  inline char* hdrValueBlock( int traceIndex ) { return &myHdrValues[traceIndex*myByteSizeHdrValueBlock]; }
+  inline float* traceSamples( int traceIndex ) { return &mySamples[traceIndex*myNumSamples]; }
+  /**
+   * Retrieve bytes from header value block of one trace. Only requires header section to be decoded.
+   */
+  void getHdrBytes( int traceIndex, int byteOffset, int byteSize, char* buffer ) const;
+
+  inline byte* encodedBuffer() { return myEncoded; }
+  inline int blockCodec() const { return myBlockCodec; }
+  inline int byteSizeHdrSection() const { return myByteSizeHdrSection; }
+  inline int byteSizeSampleSection() const { return myByteSizeSampleSection; }
+  inline int byteSizeEncoded() const { return myByteSizeHdrSection + myByteSizeSampleSection; }
+  /// @return Maximum byte size of encoded block
+  inline int byteSizeEncodedCapacity() const { return myEncodedCapacity; }
+
+private:
+  void decodeSection( byte const* bufferIn, int numBytesIn, byte* bufferOut, int numBytesOut, bool isCompressed );
+  int myNumTracesCapacity;
+  int myNumTraces;
+  int myNumSamples;
+  int myNumHeaders;
+  int* myHdrByteSize;
+  int* myHdrByteOffset;
+  int myByteSizeHdrValueBlock;
+  int myCodec;
+  double myQuantizationStep;
+
+  /// Decoded header values, trace by trace
+  char* myHdrValues;
+  /// Decoded samples, trace by trace
+  float* mySamples;
+
+  byte* myEncoded;
+  int myEncodedCapacity;
+  int myBlockCodec;
+  int myByteSizeHdrSection;
+  int myByteSizeSampleSection;
+
+  byte* myWorkBuffer1;
+  byte* myWorkBuffer2;
+};
+
+/**
+ * Encodes or decodes one block, for execution in csThreadPool
+ */
+class csSeismicBlockTask : public cseis_geolib::csRunnable {
+public:
+  csSeismicBlockTask( csSeismicBlock* block, bool isEncode ) {
+    myBlock    = block;
+    myIsEncode = isEncode;
+  }
+  virtual void run() {
+    if( myIsEncode ) {
+      myBlock->encode();
+    }
+    else {
+      myBlock->decode();
+    }
+  }
+private:
+  csSeismicBlock* myBlock;
+  bool myIsEncode;
+};
+
+} // end namespace
+#endif
@@ -0,0 +1,174 @@
+/* Copyright (c) Colorado School of Mines, 2013.*/
+/* All rights reserved.                       */
+
+#include "csSeismicBlockCodec.h"
+#include <cstring>
+#include <cmath>
+
+using namespace cseis_io;
+
+namespace {
+  int const LZ_MIN_MATCH  = 4;
+  int const LZ_HASH_BITS  = 14;
+  int const LZ_MAX_OFFSET = 65535;
+  /// Number of bytes at end of input that are always stored as literals
+  int const LZ_LAST_LITERALS = 5;
+
+  inline unsigned int read32( byte const* ptr ) {
+    unsigned int value;
+    memcpy( &value, ptr, 4 );
+    return value;
+  }
+  inline int writeLength( byte* out, int op, int length ) {
+    while( length >= 255 ) {
+      out[op++] = 255;
+      length -= 255;
+    }
+    out[op++] = (byte)length;
+    return op;
+  }
+  inline bool readLength( byte const* in, int& ip, int numBytesIn, int& length ) {
+    byte value;
+    do {
+      if( ip >= numBytesIn ) return false;
+      value = in[ip++];
+      length += value;
+    } while( value == 255 );
+    return true;
+  }
+  inline int writeSequence( byte* out, int op, byte const* literals, int numLiterals, int offset, int matchLength ) {
+    int matchCode = matchLength - LZ_MIN_MATCH;
+    byte token = (byte)( ((numLiterals < 15 ? numLiterals : 15) << 4) | (matchCode < 15 ? matchCode : 15) );
+    out[op++] = token;
+    if( numLiterals >= 15 ) op = writeLength( out, op, numLiterals-15 );
+    memcpy( &out[op], literals, numLiterals );
+    op += numLiterals;
+    out[op++] = (byte)(offset & 0xff);
+    out[op++] = (byte)(offset >> 8);
+    if( matchCode >= 15 ) op = writeLength( out, op, matchCode-15 );
+    return op;
+  }
+}
+
+int csSeismicBlockCodec::lzMaxCompressedSize( int numBytes ) {
+  return( numBytes + numBytes/255 + 16 );
+}
+//--------------------------------------------------------------------------------
+//
+int csSeismicBlockCodec::lzCompress( byte const* in, int numBytes, byte* out ) {
+  int const hashSize = 1 << LZ_HASH_BITS;
+  int* hashTable = new int[hashSize];
+  for( int i = 0; i < hashSize; i++ ) {
+    hashTable[i] = -1;
+  }
+  int ip     = 0;
+  int anchor = 0;
+  int op     = 0;
+  int const matchLimit = numBytes - LZ_LAST_LITERALS;
+
+  while( ip + LZ_MIN_MATCH <= matchLimit ) {
+    unsigned int sequence = read32( &in[ip] );
+    int hash = (int)( (sequence * 2654435761U) >> (32-LZ_HASH_BITS) );
+    int ref  = hashTable[hash];
+    hashTable[hash] = ip;
+    if( ref >= 0 && ip - ref <= LZ_MAX_OFFSET && read32( &in[ref] ) == sequence ) {
+      int matchLength = LZ_MIN_MATCH;
+      while( ip + matchLength < matchLimit && in[ref+matchLength] == in[ip+matchLength] ) {
+        matchLength += 1;
+      }
+      op = writeSequence( out, op, &in[anchor], ip-anchor, ip-ref, matchLength );
+      ip    += matchLength;
+      anchor = ip;
+    }
+    else {
+      ip += 1;
+    }
+  }
+  // Last literals
+  int numLiterals = numBytes - anchor;
+  out[op++] = (byte)( (numLiterals < 15 ? numLiterals : 15) << 4 );
+  if( numLiterals >= 15 ) op = writeLength( out, op, numLiterals-15 );
+  memcpy( &out[op], &in[anchor], numLiterals );
+  op += numLiterals;
+
+  delete [] hashTable;
+  return op;
+}
+//--------------------------------------------------------------------------------
+//
+bool csSeismicBlockCodec::lzDecompress( byte const* in, int numBytesIn, byte* out, int numBytesOut ) {
+  int ip = 0;
+  int op = 0;
+  while( ip < numBytesIn ) {
+    byte token = in[ip++];
+    int numLiterals = token >> 4;
+    if( numLiterals == 15 && !readLength( in, ip, numBytesIn, numLiterals ) ) return false;
+    if( ip + numLiterals > numBytesIn || op + numLiterals > numBytesOut ) return false;
+    memcpy( &out[op], &in[ip], numLiterals );
+    ip += numLiterals;
+    op += numLiterals;
+    if( ip == numBytesIn ) break;  // Last sequence consists of literals only
+
+    if( ip + 2 > numBytesIn ) return false;
+    int offset = (int)in[ip] | ((int)in[ip+1] << 8);
+    ip += 2;
+    int matchLength = token & 0x0f;
+    if( matchLength == 15 && !readLength( in, ip, numBytesIn, matchLength ) ) return false;
+    matchLength += LZ_MIN_MATCH;
+    if( offset == 0 || offset > op || op + matchLength > numBytesOut ) return false;
+    int ref = op - offset;
+    if( offset >= matchLength ) {
+      memcpy( &out[op], &out[ref], matchLength );
+    }
+    else {
+      // Overlapping copy: Repeat pattern byte by byte
+      for( int i = 0; i < matchLength; i++ ) {
+        out[op+i] = out[ref+i];
+      }
+    }
+    op += matchLength;
+  }
+  return( op == numBytesOut );
+}
+//--------------------------------------------------------------------------------
+//
+void csSeismicBlockCodec::shuffle( byte const* in, byte* out, int numElements, int elementByteSize ) {
+  for( int ibyte = 0; ibyte < elementByteSize; ibyte++ ) {
+    byte* outPtr = &out[ibyte*numElements];
+    for( int i = 0; i < numElements; i++ ) {
+      outPtr[i] = in[i*elementByteSize + ibyte];
+    }
+  }
+}
+void csSeismicBlockCodec::unshuffle( byte const* in, byte* out, int numElements, int elementByteSize ) {
+  for( int ibyte = 0; ibyte < elementByteSize; ibyte++ ) {
+    byte const* inPtr = &in[ibyte*numElements];
+    for( int i = 0; i < numElements; i++ ) {
+      out[i*elementByteSize + ibyte] = inPtr[i];
+    }
+  }
+}
+//--------------------------------------------------------------------------------
+//
+bool csSeismicBlockCodec::quantize( float const* samples, int numSamples, double step, unsigned int* valuesOut ) {
+  double const limit = 1073741823.0;  // 2^30-1: First differences then still fit into 32bit integer
+  double scalar = 1.0 / step;
+  int prevValue = 0;
+  for( int isamp = 0; isamp < numSamples; isamp++ ) {
+    double value = (double)samples[isamp] * scalar;
+    if( !(fabs(value) <= limit) ) return false;
+    int intValue = (int)floor( value + 0.5 );
+    int diff = intValue - prevValue;
+    prevValue = intValue;
+    valuesOut[isamp] = ((unsigned int)diff << 1) ^ (unsigned int)(diff >> 31);
+  }
+  return true;
+}
+void csSeismicBlockCodec::dequantize( unsigned int const* valuesIn, int numSamples, double step, float* samples ) {
+  int value = 0;
+  for( int isamp = 0; isamp < numSamples; isamp++ ) {
+    unsigned int zigzag = valuesIn[isamp];
+    value += (int)( (zigzag >> 1) ^ (0U - (zigzag & 1U)) );
+    samples[isamp] = (float)( (double)value * step );
+  }
+}
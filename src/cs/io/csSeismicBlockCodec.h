@@ -0,0 +1,68 @@
+/* Copyright (c) Colorado School of Mines, 2013.*/
+/* All rights reserved.                       */
+
+#ifndef CS_SEISMIC_BLOCK_CODEC_H
+#define CS_SEISMIC_BLOCK_CODEC_H
+
+#include <cstdio>
+#include "csIODefines.h"
+
+namespace cseis_io {
+
+/**
+ * Sample and header codecs used by SeaSeis format version 0.5
+ *
+ * - Byte shuffle: Groups the n-th byte of all elements together. Neighbouring float samples mostly differ
+ *   in the low mantissa bytes only, so the shuffled exponent/high mantissa planes compress well.
+ * - LZ: Byte oriented LZ77 compressor with 64k window (sequence format similar to LZ4).
+ * - Quantization: Bounded error quantization to integer steps, stored as zigzag encoded first differences.
+ *
+ * @author Bjorn Olofsson
+ * @date 2013
+ */
+class csSeismicBlockCodec {
+public:
+  /// No compression: Raw samples, column stored headers
+  static int const CODEC_NONE     = 0;
+  /// Lossless compression: Byte shuffle + LZ
+  static int const CODEC_LOSSLESS = 1;
+  /// Lossy compression with bounded absolute error: Quantization + byte shuffle + LZ
+  static int const CODEC_LOSSY    = 2;
+
+public:
+  /**
+   * @return Maximum byte size of LZ compressed output for input of given byte size
+   */
+  static int lzMaxCompressedSize( int numBytes );
+  /**
+   * LZ compress byte array
+   * @param bufferIn   Input bytes
+   * @param numBytes   Number of input bytes
+   * @param bufferOut  Output buffer, at least lzMaxCompressedSize(numBytes) bytes
+   * @return Number of compressed bytes written to output buffer
+   */
+  static int lzCompress( byte const* bufferIn, int numBytes, byte* bufferOut );
+  /**
+   * LZ decompress byte array
+   * @param bufferIn    Compressed bytes
+   * @param numBytesIn  Number of compressed bytes
+   * @param bufferOut   Output buffer
+   * @param numBytesOut Expected number of decompressed bytes
+   * @return false if compressed data is corrupt
+   */
+  static bool lzDecompress( byte const* bufferIn, int numBytesIn, byte* bufferOut, int numBytesOut );
+
+  static void shuffle( byte const* bufferIn, byte* bufferOut, int numElements, int elementByteSize );
+  static void unshuffle( byte const* bufferIn, byte* bufferOut, int numElements, int elementByteSize );
+
+  /**
+   * Quantize samples to multiples of step size. Store zigzag encoded differences between consecutive values.
+   * Absolute error of reconstructed samples is <= 0.5*step, plus rounding to single precision.
+   * @return false if a sample cannot be represented (too large compared to step size, or NaN)
+   */
+  static bool quantize( float const* samples, int numSamples, double step, unsigned int* valuesOut );
+  static void dequantize( unsigned int const* valuesIn, int numSamples, double step, float* samples );
+};
+
+} // end namespace
+#endif
@@ -7,6 +7,7 @@
 #include "csSeismicReader_ver02.h"
 #include "csSeismicReader_ver03.h"
 #include "csSeismicReader_ver04.h"
+#include "csSeismicReader_ver05.h"
 #include "csSeismicIOConfig.h"
 #include "csException.h"
 #include "csHeaderInfo.h"
@@ -63,7 +64,10 @@ csSeismicReader_ver::csSeismicReader_ver( std::string filename, bool enableRando
 csSeismicReader_ver* csSeismicReader_ver::createReaderObject( std::string filename, bool enableRandomAccess, int numTracesBuffer ) {
   std::string versionString;
   csSeismicReader_ver::extractVersionString( filename, versionString );
-  if( !versionString.substr(5,3).compare("0.4") ) {
+  if( !versionString.substr(5,3).compare("0.5") ) {
+    return new csSeismicReader_ver05( filename, enableRandomAccess, numTracesBuffer );
+  }
+  else if( !versionString.substr(5,3).compare("0.4") ) {
     return new csSeismicReader_ver04( filename, enableRandomAccess, numTracesBuffer );
   }
   else if( !versionString.substr(5,3).compare("0.3") ) {
@@ -596,6 +600,32 @@ bool csSeismicReader_ver::readTrace( float* samples, char* hdrValueBlock, int nu
   myBufferCurrentTrace += 1;
   return true;
 }
+//----------------------------------------------------------------
+bool csSeismicReader_ver::readTraceHeader( char* hdrValueBlock ) {
+  if( !myIsReadFileHeader ) throw( cseis_geolib::csException("csSeismicReader_ver::readTraceHeader(): File header has not been read. This is a program bug in the calling function") );
+  if (myPeekIsInProgress ) revertFromPeekPosition();
+
+  // Trace has already been read into buffer
+  if( myBufferCapacityNumTraces > 1 && myBufferCurrentTrace < myBufferNumTraces ) {
+    memcpy( hdrValueBlock, &myDataBuffer[myBufferCurrentTrace*myTraceByteSize], myByteSizeHdrValueBlock );
+    myBufferCurrentTrace += 1;
+    return true;
+  }
+  if( myFileSize != cseis_geolib::csFileUtils::FILESIZE_UNKNOWN && myCurrentTraceIndex >= myNumTraces ) return false;
+
+  // Read header value block only, skip trace samples
+  myFile->clear();
+  myFile->read( hdrValueBlock, myByteSizeHdrValueBlock );
+  if( myFile->fail() ) {
+    return false;
+  }
+  myFile->seekg( myTraceByteSize - myByteSizeHdrValueBlock, std::ios_base::cur );
+  if( myFile->fail() ) {
+    return false;
+  }
+  myCurrentTraceIndex += 1;
+  return true;
+}
 //----------------------------------------------------------------------
 void csSeismicReader_ver::decompressBuffer( float* samples, int numSamples ) {
   float minValue;
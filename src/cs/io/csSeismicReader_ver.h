@@ -39,6 +39,12 @@ class csSeismicReader_ver {
   
   virtual bool readTrace( float* samples, char* hdrValueBlock );
   virtual bool readTrace( float* samples, char* hdrValueBlock, int numSamples );
+  /**
+   * Read trace header of next trace, skip trace samples
+   * @param hdrValueBlock (o) Buffer to hold all trace header values
+   * @return false if end of file has been reached
+   */
+  virtual bool readTraceHeader( char* hdrValueBlock );
   virtual bool moveToTrace( int firstTraceIndex );
   virtual bool moveToTrace( int firstTraceIndex, int numTracesToRead );
   virtual bool moveToNextTrace();
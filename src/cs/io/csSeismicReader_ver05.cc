@@ -0,0 +1,560 @@
+/* Copyright (c) Colorado School of Mines, 2013.*/
+/* All rights reserved.                       */
+
+#include "csSeismicReader_ver05.h"
+#include "csSeismicWriter_ver05.h"
+#include "csSeismicIOConfig.h"
+#include "csSeismicBlock.h"
+#include "csSeismicBlockCodec.h"
+#include "csThreadPool.h"
+#include "csException.h"
+#include "csGeolibUtils.h"
+#include "csHeaderInfo.h"
+#include "csIODefines.h"
+#include "csFileUtils.h"
+#include "csVector.h"
+#include <cstring>
+#include <algorithm>
+
+using namespace cseis_io;
+
+csSeismicReader_ver05::csSeismicReader_ver05( std::string filename, bool enableRandomAccess, int numTracesBuffer ) :
+  csSeismicReader_ver( filename, enableRandomAccess, numTracesBuffer ) {
+  cseis_io::csIODefines::createVersionString( VERSION_SEISMIC_READER, myVersionText );
+
+  int versionNumber = VERSION_SEISMIC_READER % 100;
+  myVersionMajor = (short int)(versionNumber/10);
+  myVersionMinor = (short int)(versionNumber - myVersionMajor*10);
+
+  myCodec     = csSeismicBlockCodec::CODEC_NONE;
+  myTolerance = 0.0f;
+  myNumTracesBlock = 0;
+  myNumHeaders     = 0;
+  myHdrByteSize    = NULL;
+  myFirstBlockOffset = 0;
+
+  myNumBlocks        = 0;
+  myBlockOffset      = NULL;
+  myBlockFirstTrace  = NULL;
+  myBlockNumTraces   = NULL;
+  myBlockCodec       = NULL;
+  myBlockByteSizeHdrs    = NULL;
+  myBlockByteSizeSamples = NULL;
+
+  myThreadPool = NULL;
+  myNumSlots   = 0;
+  myBlocks     = NULL;
+  myTasks      = NULL;
+  mySlotBlockIndex  = NULL;
+  myIsSlotSubmitted = NULL;
+
+  myPeekBlock      = NULL;
+  myPeekBlockIndex = -1;
+
+  initialize();
+}
+//----------------------------------------------------------------
+csSeismicReader_ver05::~csSeismicReader_ver05() {
+  if( myThreadPool != NULL ) {
+    myThreadPool->waitAll();
+    delete myThreadPool;
+    myThreadPool = NULL;
+  }
+  if( myBlocks != NULL ) {
+    for( int islot = 0; islot < myNumSlots; islot++ ) {
+      delete myTasks[islot];
+      delete myBlocks[islot];
+    }
+    delete [] myTasks;
+    delete [] myBlocks;
+    delete [] mySlotBlockIndex;
+    delete [] myIsSlotSubmitted;
+    myBlocks = NULL;
+  }
+  if( myPeekBlock != NULL ) {
+    delete myPeekBlock;
+    myPeekBlock = NULL;
+  }
+  if( myHdrByteSize != NULL ) {
+    delete [] myHdrByteSize;
+    myHdrByteSize = NULL;
+  }
+  if( myBlockOffset != NULL ) {
+    delete [] myBlockOffset;
+    delete [] myBlockFirstTrace;
+    delete [] myBlockNumTraces;
+    delete [] myBlockCodec;
+    delete [] myBlockByteSizeHdrs;
+    delete [] myBlockByteSizeSamples;
+    myBlockOffset = NULL;
+  }
+}
+//--------------------------------------------------------------------
+bool csSeismicReader_ver05::readFileHeader( csSeismicIOConfig* config ) {
+  if( myFile == NULL ) return false;
+  if( myIsReadFileHeader ) throw( cseis_geolib::csException("csSeismicReader_ver05::readFileHeader: Attempt to re-read file header. This is probably a program bug in the calling function") );
+  myIsReadFileHeader = true;
+
+  char byteSizeChar[4];
+  myFile->read( byteSizeChar, 4 );
+  int byteSize = 0;
+  memcpy( &byteSize, byteSizeChar, 4 );
+  if( myFile->fail() ) {
+    throw cseis_geolib::csException("Unexpected error occurred when reading SeaSeis header");
+  }
+  myHeaderByteSize += 4;
+
+  myTempBuffer = new char[byteSize];
+  myFile->read( myTempBuffer, byteSize );
+  if( myFile->fail() ) {
+    throw cseis_geolib::csException("Unexpected error occurred when reading SeaSeis header");
+  }
+  myHeaderByteSize += byteSize;
+
+  // Set super header
+  int byteLoc = 0;
+  memcpy( &config->numSamples, &myTempBuffer[byteLoc], 4 );
+  memcpy( &config->sampleInt, &myTempBuffer[byteLoc+4], 4 );
+  memcpy( &config->domain, &myTempBuffer[byteLoc+8], 4 );
+  memcpy( &config->fftDataType, &myTempBuffer[byteLoc+12], 4 );
+  memcpy( &config->numSamplesXT, &myTempBuffer[byteLoc+16], 4 );
+  memcpy( &config->sampleIntXT, &myTempBuffer[byteLoc+20], 4 );
+  memcpy( &config->grid_orig_x, &myTempBuffer[byteLoc+24], 8 );
+  memcpy( &config->grid_orig_y, &myTempBuffer[byteLoc+32], 8 );
+  memcpy( &config->grid_orig_il, &myTempBuffer[byteLoc+40], 4 );
+  memcpy( &config->grid_orig_xl, &myTempBuffer[byteLoc+44], 4 );
+  memcpy( &config->grid_binsize_il, &myTempBuffer[byteLoc+48], 8 );
+  memcpy( &config->grid_binsize_xl, &myTempBuffer[byteLoc+56], 8 );
+  memcpy( &config->grid_azim_il, &myTempBuffer[byteLoc+64], 8 );
+  memcpy( &config->grid_azim_xl, &myTempBuffer[byteLoc+72], 8 );
+  myNumSamples = config->numSamples;
+  int numEnsKeys = 0;
+  memcpy( &numEnsKeys, &myTempBuffer[byteLoc+80], 4 );
+  byteLoc += 84;
+
+  for( int ikey = 0; ikey < numEnsKeys; ikey++ ) {
+    int sizeText;
+    memcpy( &sizeText, &myTempBuffer[byteLoc], 4 );
+    char* text = new char[sizeText+1];
+    text[sizeText] = '\0';
+    memcpy( text, &myTempBuffer[byteLoc+4], sizeText );
+    config->ensKeyNames.insertEnd( text );
+    delete [] text;
+    byteLoc += 4 + sizeText;
+  }
+
+  memcpy( &myCodec, &myTempBuffer[byteLoc], 4 );
+  memcpy( &myTolerance, &myTempBuffer[byteLoc+4], 4 );
+  memcpy( &myNumTracesBlock, &myTempBuffer[byteLoc+8], 4 );
+  memcpy( &config->byteSizeHdrValueBlock, &myTempBuffer[byteLoc+12], 4 );
+  memcpy( &myNumHeaders, &myTempBuffer[byteLoc+16], 4 );
+  byteLoc += 20;
+
+  if( myNumTracesBlock <= 0 ) {
+    throw cseis_geolib::csException("Inconsistent SeaSeis header: Number of traces per block = %d", myNumTracesBlock);
+  }
+
+  myHdrByteSize = new int[myNumHeaders > 0 ? myNumHeaders : 1];
+  for( int ihdr = 0; ihdr < myNumHeaders; ihdr++ ) {
+    cseis_geolib::type_t type = (cseis_geolib::type_t)myTempBuffer[byteLoc];
+    byteLoc += 1;
+
+    int nElements;
+    memcpy( &nElements, &myTempBuffer[byteLoc], 4 );
+    byteLoc += 4;
+
+    int sizeName;
+    memcpy( &sizeName, &myTempBuffer[byteLoc], 4 );
+    byteLoc += 4;
+    char* name = new char[sizeName+1];
+    name[sizeName] = '\0';
+    memcpy( name, &myTempBuffer[byteLoc], sizeName );
+    byteLoc += sizeName;
+
+    int sizeDesc;
+    memcpy( &sizeDesc, &myTempBuffer[byteLoc], 4 );
+    byteLoc += 4;
+    char* desc = new char[sizeDesc+1];
+    desc[sizeDesc] = '\0';
+    memcpy( desc, &myTempBuffer[byteLoc], sizeDesc );
+    byteLoc += sizeDesc;
+
+    config->addHeader( type, name, desc, nElements );
+    myHdrByteSize[ihdr] = ( type != cseis_geolib::TYPE_STRING ) ? cseis_geolib::csGeolibUtils::numBytes( type ) : nElements;
+
+    delete [] name;
+    delete [] desc;
+  }
+
+  config->byteSizeSamples = 4 * config->numSamples;
+  myByteSizeSamples       = config->byteSizeSamples;
+  myByteSizeHdrValueBlock = config->byteSizeHdrValueBlock;
+  myTraceByteSize         = myByteSizeSamples + myByteSizeHdrValueBlock;
+  myFirstBlockOffset      = (csInt64_t)myHeaderByteSize;
+
+  readDirectory();
+
+  myBufferCapacityNumTraces = myNumTracesBlock;
+  myCurrentTraceIndex = 0;
+  myLastTraceIndex    = myNumTraces-1;
+  config->numTraces   = myNumTraces;
+
+  return true;
+}
+//--------------------------------------------------------------------
+// Read block directory from end of file
+//
+void csSeismicReader_ver05::readDirectory() {
+  int const trailerSize = csSeismicWriter_ver05::TRAILER_BYTE_SIZE;
+  int const entrySize   = csSeismicWriter_ver05::DIRECTORY_ENTRY_BYTE_SIZE;
+
+  myFile->clear();
+  myFile->seekg( 0, std::ios_base::end );
+  csInt64_t fileSize = (csInt64_t)myFile->tellg();
+  if( myFile->fail() || fileSize < myFirstBlockOffset + (csInt64_t)trailerSize ) {
+    scanBlocks();
+    return;
+  }
+  char trailer[csSeismicWriter_ver05::TRAILER_BYTE_SIZE];
+  myFile->seekg( (std::streamoff)(fileSize - trailerSize), std::ios_base::beg );
+  myFile->read( trailer, trailerSize );
+  csInt64_t directoryOffset = 0;
+  int numBlocks = 0;
+  int numTraces = 0;
+  memcpy( &directoryOffset, &trailer[0], 8 );
+  memcpy( &numBlocks, &trailer[8], 4 );
+  memcpy( &numTraces, &trailer[12], 4 );
+  if( myFile->fail() || strncmp( &trailer[16], ID_TEXT_BLOCK_DIRECTORY, 4 ) || numBlocks < 0 ||
+      directoryOffset + (csInt64_t)numBlocks*(csInt64_t)entrySize + (csInt64_t)trailerSize != fileSize ) {
+    // Directory missing, for example if writing was interrupted
+    scanBlocks();
+    return;
+  }
+
+  myNumBlocks = numBlocks;
+  myBlockOffset      = new csInt64_t[myNumBlocks+1];
+  myBlockFirstTrace  = new int[myNumBlocks+1];
+  myBlockNumTraces   = new int[myNumBlocks+1];
+  myBlockCodec       = new int[myNumBlocks+1];
+  myBlockByteSizeHdrs    = new int[myNumBlocks+1];
+  myBlockByteSizeSamples = new int[myNumBlocks+1];
+
+  char* buffer = new char[myNumBlocks*entrySize+1];
+  myFile->seekg( (std::streamoff)directoryOffset, std::ios_base::beg );
+  myFile->read( buffer, myNumBlocks*entrySize );
+  if( myFile->fail() ) {
+    delete [] buffer;
+    throw cseis_geolib::csException("Unexpected error occurred when reading block directory of SeaSeis file '%s'", myFilename.c_str());
+  }
+  myNumTraces = 0;
+  for( int iblock = 0; iblock < myNumBlocks; iblock++ ) {
+    char const* entry = &buffer[iblock*entrySize];
+    memcpy( &myBlockOffset[iblock], &entry[0], 8 );
+    memcpy( &myBlockNumTraces[iblock], &entry[8], 4 );
+    memcpy( &myBlockCodec[iblock], &entry[12], 4 );
+    memcpy( &myBlockByteSizeHdrs[iblock], &entry[16], 4 );
+    memcpy( &myBlockByteSizeSamples[iblock], &entry[20], 4 );
+    myBlockFirstTrace[iblock] = myNumTraces;
+    myNumTraces += myBlockNumTraces[iblock];
+  }
+  myBlockFirstTrace[myNumBlocks] = myNumTraces;
+  delete [] buffer;
+  if( myNumTraces != numTraces ) {
+    throw cseis_geolib::csException("Inconsistent block directory in SeaSeis file '%s': Number of traces %d != %d", myFilename.c_str(), myNumTraces, numTraces);
+  }
+}
+//--------------------------------------------------------------------
+// Build block directory by stepping through all block headers
+//
+void csSeismicReader_ver05::scanBlocks() {
+  int const blockHeaderSize = csSeismicWriter_ver05::BLOCK_HEADER_BYTE_SIZE;
+  cseis_geolib::csVector<csInt64_t> offsetList;
+  cseis_geolib::csVector<int> valueList;
+
+  myFile->clear();
+  myFile->seekg( 0, std::ios_base::end );
+  csInt64_t fileSize = (csInt64_t)myFile->tellg();
+
+  csInt64_t offset = myFirstBlockOffset;
+  int blockHeader[4];
+  while( offset + blockHeaderSize <= fileSize ) {
+    myFile->seekg( (std::streamoff)offset, std::ios_base::beg );
+    myFile->read( (char*)blockHeader, blockHeaderSize );
+    if( myFile->fail() ) break;
+    if( blockHeader[0] <= 0 || blockHeader[0] > myNumTracesBlock || blockHeader[2] < 0 || blockHeader[3] < 0 ) break;
+    csInt64_t nextOffset = offset + (csInt64_t)blockHeaderSize + (csInt64_t)blockHeader[2] + (csInt64_t)blockHeader[3];
+    if( nextOffset > fileSize ) break;  // Incomplete block
+    offsetList.insertEnd( offset );
+    for( int i = 0; i < 4; i++ ) {
+      valueList.insertEnd( blockHeader[i] );
+    }
+    offset = nextOffset;
+  }
+  myFile->clear();
+
+  myNumBlocks = offsetList.size();
+  myBlockOffset      = new csInt64_t[myNumBlocks+1];
+  myBlockFirstTrace  = new int[myNumBlocks+1];
+  myBlockNumTraces   = new int[myNumBlocks+1];
+  myBlockCodec       = new int[myNumBlocks+1];
+  myBlockByteSizeHdrs    = new int[myNumBlocks+1];
+  myBlockByteSizeSamples = new int[myNumBlocks+1];
+  myNumTraces = 0;
+  for( int iblock = 0; iblock < myNumBlocks; iblock++ ) {
+    myBlockOffset[iblock]     = offsetList.at(iblock);
+    myBlockNumTraces[iblock]  = valueList.at(4*iblock);
+    myBlockCodec[iblock]      = valueList.at(4*iblock+1);
+    myBlockByteSizeHdrs[iblock]    = valueList.at(4*iblock+2);
+    myBlockByteSizeSamples[iblock] = valueList.at(4*iblock+3);
+    myBlockFirstTrace[iblock] = myNumTraces;
+    myNumTraces += myBlockNumTraces[iblock];
+  }
+  myBlockFirstTrace[myNumBlocks] = myNumTraces;
+}
+//--------------------------------------------------------------------
+int csSeismicReader_ver05::blockIndex( int traceIndex ) const {
+  // All blocks except the last one are normally full
+  int iblock = std::min( traceIndex / myNumTracesBlock, myNumBlocks-1 );
+  while( iblock > 0 && myBlockFirstTrace[iblock] > traceIndex ) iblock--;
+  while( iblock < myNumBlocks-1 && myBlockFirstTrace[iblock+1] <= traceIndex ) iblock++;
+  return iblock;
+}
+//--------------------------------------------------------------------
+void csSeismicReader_ver05::loadBlock( int iblock, csSeismicBlock* block, bool headerOnly ) {
+  int byteSizeSamples = headerOnly ? 0 : myBlockByteSizeSamples[iblock];
+  block->setEncodedInfo( myBlockNumTraces[iblock], myBlockCodec[iblock], myBlockByteSizeHdrs[iblock], byteSizeSamples );
+  myFile->clear();
+  myFile->seekg( (std::streamoff)(myBlockOffset[iblock] + csSeismicWriter_ver05::BLOCK_HEADER_BYTE_SIZE), std::ios_base::beg );
+  myFile->read( (char*)block->encodedBuffer(), block->byteSizeEncoded() );
+  if( myFile->fail() ) {
+    throw( cseis_geolib::csException("csSeismicReader_ver05: Unexpected error occurred when reading in block #%d from input file '%s'", iblock+1, myFilename.c_str()) );
+  }
+}
+//--------------------------------------------------------------------
+void csSeismicReader_ver05::initDecoder() {
+  int numThreads = std::min( std::min( cseis_geolib::csThreadPool::numProcessors(), (int)MAX_DECODE_THREADS ), myNumBlocks );
+  if( numThreads > 1 ) {
+    myThreadPool = new cseis_geolib::csThreadPool( numThreads );
+    myNumSlots = myThreadPool->numThreads() + 1;
+  }
+  else {
+    myNumSlots = 1;
+  }
+  myBlocks = new csSeismicBlock*[myNumSlots];
+  myTasks  = new csSeismicBlockTask*[myNumSlots];
+  mySlotBlockIndex  = new int[myNumSlots];
+  myIsSlotSubmitted = new bool[myNumSlots];
+  for( int islot = 0; islot < myNumSlots; islot++ ) {
+    myBlocks[islot] = new csSeismicBlock( myNumTracesBlock, myNumSamples, myNumHeaders, myHdrByteSize, myCodec, myTolerance );
+    myTasks[islot]  = new csSeismicBlockTask( myBlocks[islot], false );
+    mySlotBlockIndex[islot]  = -1;
+    myIsSlotSubmitted[islot] = false;
+  }
+}
+void csSeismicReader_ver05::waitSlot( int slot ) {
+  if( myIsSlotSubmitted[slot] ) {
+    myThreadPool->wait( myTasks[slot] );
+    myIsSlotSubmitted[slot] = false;
+    if( myTasks[slot]->hasError() ) {
+      int iblock = mySlotBlockIndex[slot];
+      mySlotBlockIndex[slot] = -1;
+      throw( cseis_geolib::csException("csSeismicReader_ver05: Error occurred when decoding block #%d of input file '%s': %s", iblock+1, myFilename.c_str(), myTasks[slot]->errorMessage()) );
+    }
+  }
+}
+csSeismicBlock* csSeismicReader_ver05::getBlock( int iblock ) {
+  if( myBlocks == NULL ) initDecoder();
+
+  // Decode ahead, but not beyond last trace that is going to be read
+  int lastBlock = std::max( blockIndex( std::max( myLastTraceIndex, 0 ) ), iblock );
+  lastBlock = std::min( std::min( lastBlock, iblock + myNumSlots - 1 ), myNumBlocks - 1 );
+  for( int jblock = iblock; jblock <= lastBlock; jblock++ ) {
+    int slot = jblock % myNumSlots;
+    if( mySlotBlockIndex[slot] == jblock ) continue;
+    if( myIsSlotSubmitted[slot] ) {
+      try {
+        waitSlot( slot );
+      }
+      catch( cseis_geolib::csException& e ) {
+        // Decoding error of block that is not needed anymore
+      }
+    }
+    mySlotBlockIndex[slot] = -1;
+    loadBlock( jblock, myBlocks[slot], false );
+    if( myThreadPool != NULL ) {
+      myThreadPool->submit( myTasks[slot] );
+      myIsSlotSubmitted[slot] = true;
+    }
+    else {
+      myBlocks[slot]->decode();
+    }
+    mySlotBlockIndex[slot] = jblock;
+  }
+  int slot = iblock % myNumSlots;
+  waitSlot( slot );
+  return myBlocks[slot];
+}
+//----------------------------------------------------------------
+bool csSeismicReader_ver05::readTrace( float* samples, char* hdrValueBlock ) {
+  return readTrace( samples, hdrValueBlock, myNumSamples );
+}
+bool csSeismicReader_ver05::readTrace( float* samples, char* hdrValueBlock, int numSamples ) {
+  if( !myIsReadFileHeader ) throw( cseis_geolib::csException("csSeismicReader_ver05::readTrace(): File header has not been read. This is a program bug in the calling function") );
+  if( myCurrentTraceIndex >= myNumTraces ) return false;
+
+  int iblock = blockIndex( myCurrentTraceIndex );
+  csSeismicBlock* block = getBlock( iblock );
+  int traceIndexBlock = myCurrentTraceIndex - myBlockFirstTrace[iblock];
+
+  memcpy( hdrValueBlock, block->hdrValueBlock(traceIndexBlock), myByteSizeHdrValueBlock );
+  int numSamplesToCopy = std::min( numSamples, myNumSamples );
+  memcpy( samples, block->traceSamples(traceIndexBlock), numSamplesToCopy*sizeof(float) );
+  for( int isamp = numSamplesToCopy; isamp < numSamples; isamp++ ) {
+    samples[isamp] = 0.0f;
+  }
+  myCurrentTraceIndex += 1;
+  return true;
+}
+//----------------------------------------------------------------
+bool csSeismicReader_ver05::moveToTrace( int traceIndex ) {
+  return moveToTrace( traceIndex, myNumTraces-traceIndex );
+}
+bool csSeismicReader_ver05::moveToTrace( int traceIndex, int numTracesToRead ) {
+  if( !myIsReadFileHeader ) throw( cseis_geolib::csException("csSeismicReader_ver05::moveToTrace: File header has not been read. This is a program bug in the calling function") );
+  if( myEnableRandomAccess == false ) {
+    throw( cseis_geolib::csException("csSeismicReader_ver05::moveToTrace: Random access not enabled. Set enableRandomAccess to true. This is a program bug in the calling function." ) );
+  }
+  else if( traceIndex < 0 || traceIndex >= myNumTraces ) {
+    throw( cseis_geolib::csException("csSeismicReader_ver05::moveToTrace: Incorrect trace index: %d (number of traces in input file: %d). This is a program bug in the calling method",
+                                     traceIndex, myNumTraces) );
+  }
+  myCurrentTraceIndex = traceIndex;
+  // Index of last trace that will be read in one go by consecutive calls to readTrace()
+  myLastTraceIndex = std::min( traceIndex + numTracesToRead - 1, myNumTraces-1 );
+  return true;
+}
+//--------------------------------------------------------------------
+bool csSeismicReader_ver05::peek( int byteOffset, int byteSize, char* buffer, int traceIndex ) {
+  if( !myIsReadFileHeader ) {
+    throw( cseis_geolib::csException("csSeismicReader_ver05::peek: File header has not been read. This is a program bug in the calling function") );
+  }
+  if( myEnableRandomAccess == false ) {
+    throw( cseis_geolib::csException("csSeismicReader_ver05::peek: Random access not enabled. Set enableRandomAccess to true. This is a program bug in the calling function." ) );
+  }
+  if( byteOffset < 0 || byteOffset + byteSize > myByteSizeHdrValueBlock ) {
+    throw( cseis_geolib::csException("csSeismicReader_ver05::peek: Byte range outside of trace header block. This is a program bug in the calling function.") );
+  }
+  if( traceIndex < 0 ) traceIndex = myCurrentTraceIndex;
+  if( traceIndex >= myNumTraces ) return false;  // Last trace has been reached. Cannot peek ahead.
+
+  int iblock = blockIndex( traceIndex );
+  getHeaderBlock( iblock )->getHdrBytes( traceIndex - myBlockFirstTrace[iblock], byteOffset, byteSize, buffer );
+  return true;
+}
+//--------------------------------------------------------------------
+bool csSeismicReader_ver05::readTraceHeader( char* hdrValueBlock ) {
+  if( !myIsReadFileHeader ) throw( cseis_geolib::csException("csSeismicReader_ver05::readTraceHeader(): File header has not been read. This is a program bug in the calling function") );
+  if( myCurrentTraceIndex >= myNumTraces ) return false;
+
+  int iblock = blockIndex( myCurrentTraceIndex );
+  getHeaderBlock( iblock )->getHdrBytes( myCurrentTraceIndex - myBlockFirstTrace[iblock], 0, myByteSizeHdrValueBlock, hdrValueBlock );
+  myCurrentTraceIndex += 1;
+  return true;
+}
+//--------------------------------------------------------------------
+csSeismicBlock* csSeismicReader_ver05::getHeaderBlock( int iblock ) {
+  // Use fully decoded block if available
+  if( myBlocks != NULL ) {
+    int slot = iblock % myNumSlots;
+    if( mySlotBlockIndex[slot] == iblock && !myIsSlotSubmitted[slot] ) {
+      return myBlocks[slot];
+    }
+  }
+  // ...otherwise read and decode header section only
+  if( myPeekBlockIndex != iblock ) {
+    if( myPeekBlock == NULL ) {
+      myPeekBlock = new csSeismicBlock( myNumTracesBlock, 0, myNumHeaders, myHdrByteSize, myCodec, myTolerance );
+    }
+    myPeekBlockIndex = -1;
+    loadBlock( iblock, myPeekBlock, true );
+    myPeekBlock->decodeHeaders();
+    myPeekBlockIndex = iblock;
+  }
+  return myPeekBlock;
+}
+
+/*
+
+CSeis file header format, version 0.5
+
+Byte  Type   Size
+0     char*  8 - ID text = "CSEISX.X" where X.X is the version number
+8     int    4 - Number of bytes in file header block  (NBYTES_FILEHDR)
+X=0
+File header block, consisting of:
+0     int    4  Number of samples
+4     float  4  Sample interval
+8     int    4  Data domain  (geolib_defines.h: DOMAIN_XT, DOMAIN_FX, DOMAIN_FK, DOMAIN_KT)
+12    int    4  FFT data type  (geolib_defines.h: FK_AMP_PHASE, FK_REAL_IMAG, FK_COMPLEX, FK_AMP, FK_PSD)
+16    int    4  Number of samples in XT domain
+20    float  4  Sample interval in XT domain
+24    double 8  Grid origin X
+32    double 8  Grid origin Y
+40    int    4  Grid origin inline
+44    int    4  Grid origin xline
+48    double 8  Grid bin size in inline direction
+56    double 8  Grid bin size in xline direction
+64    double 8  Grid azimuth of inline direction
+72    double 8  Grid azimuth of xline direction
+80    int    4  Number of ensemble keys (=NKEYS)
+X=X+84
+Ensemble headers:
+for( NKEYS ) {
+  X    int    4  Number of characters/bytes in key name (=NCHAR1)
+  X+4  char* NCHAR1  Key name
+  X=X+4+NCHAR1
+}
+X     int    4  Sample codec (csSeismicBlockCodec: 0: none, 1: lossless, 2: lossy)
+X+4   float  4  Maximum absolute sample error of lossy codec
+X+8   int    4  Number of traces per block (=NTRC)
+X+12  int    4  Byte size of 'header value block'
+X+16  int    4  Number of trace headers (=NHDR)
+X=X+20
+for( NHDR ) {
+  X    char   1  Header type
+  X+1  int    4  Number of 'elements' in header (only more than 1 in string and array headers)
+  X+5  int    4  Byte size of header name = number of characters/bytes in header name  (=NCHAR2)
+  X+9  char*  NCHAR2  Header name
+  X=X+9+NCHAR2
+  X    int    4  Byte size of header description = number of bytes in header description (=NCHAR3)
+  X+4  char*  NCHAR3  Header description
+  X=X+NCHAR3
+}
+
+Trace blocks, following the file header. Each block holds NTRC traces, except the last block which may hold fewer:
+0     int    4  Number of traces in block (=N)
+4     int    4  Block codec. Differs from file codec if block could not be encoded with lossy codec.
+8     int    4  Byte size of header section (=NBH)
+12    int    4  Byte size of sample section (=NBS)
+16    byte   NBH  Header section: Header values stored column-wise, LZ compressed if NBH < N * header value block size
+16+NBH byte  NBS  Sample section: Samples, encoded with block codec, LZ compressed if NBS < N * number of samples * 4
+
+Block directory, following the last block:
+for( NBLOCKS ) {
+  X    int64  8  Byte offset of block from start of file
+  X+8  int    4  Number of traces in block
+  X+12 int    4  Block codec
+  X+16 int    4  Byte size of header section
+  X+20 int    4  Byte size of sample section
+  X=X+24
+}
+
+Trailer, last 20 bytes of file:
+0     int64  8  Byte offset of block directory from start of file
+8     int    4  Number of blocks (=NBLOCKS)
+12    int    4  Total number of traces
+16    char*  4  ID text = "CSBD"
+
+If the block directory is missing (for example if writing was interrupted), the reader steps through all block headers instead.
+
+*/
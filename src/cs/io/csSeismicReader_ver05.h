@@ -0,0 +1,93 @@
+/* Copyright (c) Colorado School of Mines, 2013.*/
+/* All rights reserved.                       */
+
+#ifndef CS_SEISMIC_READER_VER05_H
+#define CS_SEISMIC_READER_VER05_H
+
+#include <cstdio>
+#include <string>
+#include <fstream>
+#include "geolib_defines.h"
+#include "csSeismicReader_ver.h"
+
+namespace cseis_geolib {
+  class csThreadPool;
+}
+
+namespace cseis_io {
+
+class csSeismicBlock;
+class csSeismicBlockTask;
+
+/**
+ * Seismic file Reader, Cseis format
+ *
+ * Version 0.5: Block format with block directory, see csSeismicWriter_ver05.
+ * The block directory gives direct access to any trace without scanning the file.
+ * During sequential read, the following blocks are decoded ahead of time in parallel worker threads.
+ * Peeking trace headers only decodes the (column stored) header section of a block, the sample section is skipped.
+ *
+ * @author Bjorn Olofsson
+ * @date 2013
+ */
+class csSeismicReader_ver05 : public csSeismicReader_ver {
+ public:
+  static int const VERSION_SEISMIC_READER = 05;
+  /// Maximum number of decoder threads per reader object
+  static int const MAX_DECODE_THREADS = 4;
+
+ public:
+  csSeismicReader_ver05( std::string filename, bool enableRandomAccess, int numTracesBuffer = 0 );
+  virtual ~csSeismicReader_ver05();
+  virtual bool readFileHeader( csSeismicIOConfig* config );
+  virtual bool readTrace( float* samples, char* hdrValueBlock );
+  virtual bool readTrace( float* samples, char* hdrValueBlock, int numSamples );
+  virtual bool readTraceHeader( char* hdrValueBlock );
+  virtual bool moveToTrace( int firstTraceIndex );
+  virtual bool moveToTrace( int firstTraceIndex, int numTracesToRead );
+  virtual bool peek( int byteOffset, int byteSize, char* buffer, int traceIndex = -1 );
+
+ private:
+  void readDirectory();
+  void scanBlocks();
+  int blockIndex( int traceIndex ) const;
+  /// Read encoded block from file into given block object
+  void loadBlock( int blockIndex, csSeismicBlock* block, bool headerOnly );
+  /// Retrieve fully decoded block. Submits decoding of subsequent blocks.
+  csSeismicBlock* getBlock( int blockIndex );
+  /// Retrieve block with decoded trace headers. Sample section is only decoded if already available.
+  csSeismicBlock* getHeaderBlock( int blockIndex );
+  void waitSlot( int slot );
+  void initDecoder();
+
+  int myCodec;
+  float myTolerance;
+  int myNumTracesBlock;
+  int myNumHeaders;
+  int* myHdrByteSize;
+  /// Byte offset in file where trace blocks start
+  csInt64_t myFirstBlockOffset;
+
+  int myNumBlocks;
+  csInt64_t* myBlockOffset;
+  int* myBlockFirstTrace;
+  int* myBlockNumTraces;
+  int* myBlockCodec;
+  int* myBlockByteSizeHdrs;
+  int* myBlockByteSizeSamples;
+
+  cseis_geolib::csThreadPool* myThreadPool;
+  int myNumSlots;
+  csSeismicBlock** myBlocks;
+  csSeismicBlockTask** myTasks;
+  /// Index of block held in slot, or -1 if slot is empty
+  int* mySlotBlockIndex;
+  bool* myIsSlotSubmitted;
+
+  /// Block holding decoded trace headers, used for header peeking
+  csSeismicBlock* myPeekBlock;
+  int myPeekBlockIndex;
+};
+
+} // end namespace
+#endif
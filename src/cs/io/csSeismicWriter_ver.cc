@@ -40,7 +40,12 @@ csSeismicWriter_ver::csSeismicWriter_ver( std::string filename, int numTracesBuf
 }
 //----------------------------------------------------------------
 csSeismicWriter_ver::~csSeismicWriter_ver() {
-  close();
+  try {
+    close();
+  }
+  catch( ... ) {
+    // Nothing to be done
+  }
   if( myTempBuffer != NULL ) {
     delete [] myTempBuffer;
     myTempBuffer = NULL;
@@ -82,12 +87,16 @@ void csSeismicWriter_ver::open( bool overwrite ) {
 //----------------------------------------------------------------
 void csSeismicWriter_ver::close() {
   if( myFile != NULL ) {
+    bool isSuccess = true;
     if( myCurrentDataBufferSize != 0 ) {
       // Some traces are still buffered and haven't been flushed yet --> Write them out now
-      writeCurrentDataBuffer();
+      isSuccess = writeCurrentDataBuffer();
     }
     fclose( myFile );
     myFile = NULL;
+    if( !isSuccess ) {
+      throw( cseis_geolib::csException("Error occurred when writing buffered traces to file '%s'", myFileName.c_str()) );
+    }
   }
 }
 bool csSeismicWriter_ver::writeCurrentDataBuffer() {
@@ -0,0 +1,370 @@
+/* Copyright (c) Colorado School of Mines, 2013.*/
+/* All rights reserved.                       */
+
+#include "csSeismicWriter_ver05.h"
+#include "csSeismicIOConfig.h"
+#include "csSeismicBlock.h"
+#include "csSeismicBlockCodec.h"
+#include "csThreadPool.h"
+#include "csException.h"
+#include "csGeolibUtils.h"
+#include "csHeaderInfo.h"
+#include "csIODefines.h"
+#include <cstring>
+#include <algorithm>
+
+using namespace cseis_io;
+using namespace std;
+
+csSeismicWriter_ver05::csSeismicWriter_ver05( std::string filename, int numTracesBlock, int codec, float tolerance, int numThreads, bool overwrite ) {
+  cseis_io::csIODefines::createVersionString( VERSION_SEISMIC_WRITER, myVersionText );
+
+  if( codec != csSeismicBlockCodec::CODEC_NONE && codec != csSeismicBlockCodec::CODEC_LOSSLESS && codec != csSeismicBlockCodec::CODEC_LOSSY ) {
+    throw( cseis_geolib::csException("csSeismicWriter_ver05: Unknown codec: %d", codec) );
+  }
+  if( codec == csSeismicBlockCodec::CODEC_LOSSY && !(tolerance > 0.0f) ) {
+    throw( cseis_geolib::csException("csSeismicWriter_ver05: Error tolerance for lossy compression must be larger than 0. Specified: %f", tolerance) );
+  }
+  myFileName = filename;
+  myFile     = NULL;
+  myNumSamples = 0;
+  myByteSizeHdrValueBlock = 0;
+  myCodec     = codec;
+  myTolerance = tolerance;
+  myNumTracesBlock = numTracesBlock;
+  myNumThreads = numThreads > 0 ? numThreads : cseis_geolib::csThreadPool::numProcessors();
+  myNumTraces  = 0;
+  myFileOffset = 0;
+
+  myTempByteSize = 0;
+  myTempBuffer   = NULL;
+  myByteLoc      = 0;
+
+  myThreadPool = NULL;
+  myNumSlots   = 0;
+  myBlocks     = NULL;
+  myTasks      = NULL;
+  myIsSlotPending = NULL;
+  myCurrentSlot   = 0;
+
+  open( overwrite );
+}
+//----------------------------------------------------------------
+csSeismicWriter_ver05::~csSeismicWriter_ver05() {
+  try {
+    close();
+  }
+  catch( ... ) {
+    // Nothing to be done
+  }
+  if( myThreadPool != NULL ) {
+    delete myThreadPool;
+    myThreadPool = NULL;
+  }
+  if( myBlocks != NULL ) {
+    for( int islot = 0; islot < myNumSlots; islot++ ) {
+      delete myTasks[islot];
+      delete myBlocks[islot];
+    }
+    delete [] myTasks;
+    delete [] myBlocks;
+    delete [] myIsSlotPending;
+    myBlocks = NULL;
+  }
+  if( myTempBuffer != NULL ) {
+    delete [] myTempBuffer;
+    myTempBuffer = NULL;
+  }
+}
+//----------------------------------------------------------------
+void csSeismicWriter_ver05::open( bool overwrite ) {
+  if( !overwrite ) {
+    myFile = fopen( myFileName.c_str(), "rb" );
+    if( myFile != NULL ) {
+      fclose( myFile );
+      myFile = NULL;
+      throw( cseis_geolib::csException("File exists and shall NOT be overwritten: '%s'", myFileName.c_str() ) );
+    }
+  }
+  myFile = fopen( myFileName.c_str(), "wb" );
+  if( myFile == NULL ) {
+    throw( cseis_geolib::csException("Error occurred when opening file '%s'", myFileName.c_str() ) );
+  }
+}
+//----------------------------------------------------------------
+void csSeismicWriter_ver05::close() {
+  if( myFile == NULL ) return;
+  FILE* file = myFile;
+  try {
+    if( myBlocks != NULL ) {
+      if( myBlocks[myCurrentSlot]->numTraces() > 0 ) {
+        submitCurrentBlock();
+      }
+      // Write out remaining blocks, oldest first
+      for( int i = 0; i < myNumSlots; i++ ) {
+        int slot = (myCurrentSlot + i) % myNumSlots;
+        if( myIsSlotPending[slot] ) writeBlock( slot );
+      }
+      writeDirectory();
+    }
+  }
+  catch( ... ) {
+    if( myThreadPool != NULL ) myThreadPool->waitAll();
+    myFile = NULL;
+    fclose( file );
+    throw;
+  }
+  myFile = NULL;
+  fclose( file );
+}
+//----------------------------------------------------------------
+void csSeismicWriter_ver05::writeBytes( void const* buffer, int numBytes ) {
+  if( numBytes == 0 ) return;
+  if( fwrite( buffer, numBytes, 1, myFile ) != 1 ) {
+    throw( cseis_geolib::csException("Error occurred when writing to file '%s'", myFileName.c_str() ) );
+  }
+  myFileOffset += (csInt64_t)numBytes;
+}
+//--------------------------------------------------------------------
+bool csSeismicWriter_ver05::writeFileHeader( csSeismicIOConfig const* config ) {
+  if( myFile == NULL ) return false;
+
+  std::string text;
+  text.append( ID_TEXT_CSEIS );
+  text.append( myVersionText );
+  writeBytes( text.c_str(), (int)text.length() );
+
+  myNumSamples            = config->numSamples;
+  myByteSizeHdrValueBlock = config->byteSizeHdrValueBlock;
+
+  int numTrcHdrs = config->numTrcHeaders();
+  int* hdrByteSize = new int[numTrcHdrs > 0 ? numTrcHdrs : 1];
+  int byteSizeTotal = 0;
+  for( int ihdr = 0; ihdr < numTrcHdrs; ihdr++ ) {
+    cseis_geolib::csHeaderInfo const* info = config->headerInfo( ihdr );
+    if( info->type != cseis_geolib::TYPE_STRING ) {
+      hdrByteSize[ihdr] = cseis_geolib::csGeolibUtils::numBytes( info->type );
+    }
+    else {
+      hdrByteSize[ihdr] = info->nElements;
+    }
+    byteSizeTotal += hdrByteSize[ihdr];
+  }
+  if( byteSizeTotal != myByteSizeHdrValueBlock ) {
+    delete [] hdrByteSize;
+    throw( cseis_geolib::csException("csSeismicWriter_ver05: Inconsistent trace header byte size: %d != %d. This is a program bug in the calling function",
+                                     byteSizeTotal, myByteSizeHdrValueBlock) );
+  }
+
+  int byteSizeTrace = myNumSamples*4 + myByteSizeHdrValueBlock;
+  if( myNumTracesBlock <= 0 ) {
+    myNumTracesBlock = DEFAULT_BLOCK_BYTES / (myNumSamples*4 > 0 ? myNumSamples*4 : 1);
+  }
+  int maxNumTracesBlock = 500000000 / (byteSizeTrace > 0 ? byteSizeTrace : 1);
+  if( myNumTracesBlock > maxNumTracesBlock ) myNumTracesBlock = maxNumTracesBlock;
+  if( myNumTracesBlock <= 0 ) myNumTracesBlock = 1;
+
+  myByteLoc = 0;
+  myTempByteSize = 200;
+  myTempBuffer = new char[myTempByteSize];
+
+// Set super header
+  appendInt(    config->numSamples );
+  appendFloat(  config->sampleInt );
+  appendInt(    config->domain );
+  appendInt(    config->fftDataType );
+  appendInt(    config->numSamplesXT );
+  appendFloat(  config->sampleIntXT );
+  appendDouble( config->grid_orig_x );
+  appendDouble( config->grid_orig_y );
+  appendInt(    config->grid_orig_il );
+  appendInt(    config->grid_orig_xl );
+  appendDouble( config->grid_binsize_il );
+  appendDouble( config->grid_binsize_xl );
+  appendDouble( config->grid_azim_il );
+  appendDouble( config->grid_azim_xl );
+  int numEnsKeys = config->ensKeyNames.size();
+  appendInt(   numEnsKeys );
+  for( int ikey = 0; ikey < numEnsKeys; ikey++ ) {
+    std::string name = config->ensKeyNames.at(ikey);
+    int sizeName = (int)name.length();
+    appendInt( sizeName );
+    appendString( name.c_str(), sizeName );
+  }
+
+  appendInt(   myCodec );
+  appendFloat( myTolerance );
+  appendInt(   myNumTracesBlock );
+// Set trace header
+  appendInt( myByteSizeHdrValueBlock );
+
+  appendInt( numTrcHdrs );
+  char randomName[4];
+  int randomCounter = 0;
+  for( int ihdr = 0; ihdr < numTrcHdrs; ihdr++ ) {
+    cseis_geolib::csHeaderInfo const* info = config->headerInfo( ihdr );
+    appendChar( info->type );
+    appendInt( info->nElements );
+    int sizeName = (int)info->name.length();
+    int sizeDesc = (int)info->description.length();
+    if( sizeName > 0 ) {
+      appendInt( sizeName );
+      appendString( info->name.c_str(), sizeName );
+    }
+    else {
+      // Zero length header name. Give this header a random name...
+      sprintf(randomName,"A%-2d", (randomCounter++) % 100);
+      appendInt( 3 );
+      appendString( randomName, 3 );
+    }
+    appendInt( sizeDesc );
+    if( sizeDesc > 0 ) {
+      appendString( info->description.c_str(), sizeDesc );
+    }
+  }
+
+  writeBytes( &myByteLoc, 4 );
+  writeBytes( myTempBuffer, myByteLoc );
+
+  delete [] myTempBuffer;
+  myTempBuffer = NULL;
+
+  //--------------------------------------------------
+  // Set up encoder blocks
+  //
+  if( myNumThreads > 1 ) {
+    myThreadPool = new cseis_geolib::csThreadPool( myNumThreads );
+    myNumSlots = myThreadPool->numThreads() + 1;
+  }
+  else {
+    myNumSlots = 1;
+  }
+  myBlocks = new csSeismicBlock*[myNumSlots];
+  myTasks  = new csSeismicBlockTask*[myNumSlots];
+  myIsSlotPending = new bool[myNumSlots];
+  for( int islot = 0; islot < myNumSlots; islot++ ) {
+    myBlocks[islot] = new csSeismicBlock( myNumTracesBlock, myNumSamples, numTrcHdrs, hdrByteSize, myCodec, myTolerance );
+    myTasks[islot]  = new csSeismicBlockTask( myBlocks[islot], true );
+    myIsSlotPending[islot] = false;
+  }
+  myCurrentSlot = 0;
+  delete [] hdrByteSize;
+
+  return true;
+}
+
+//----------------------------------------------------------------
+bool csSeismicWriter_ver05::writeTrace( float* samples, char const* hdrValueBlock ) {
+  if( myFile == NULL || myBlocks == NULL ) return false;
+  csSeismicBlock* block = myBlocks[myCurrentSlot];
+  int traceIndex = block->numTraces();
+  memcpy( block->hdrValueBlock(traceIndex), hdrValueBlock, myByteSizeHdrValueBlock );
+  memcpy( block->traceSamples(traceIndex), samples, myNumSamples*sizeof(float) );
+  block->setNumTraces( traceIndex+1 );
+  myNumTraces += 1;
+  if( block->numTraces() == myNumTracesBlock ) {
+    submitCurrentBlock();
+  }
+  return true;
+}
+//----------------------------------------------------------------
+void csSeismicWriter_ver05::submitCurrentBlock() {
+  int slot = myCurrentSlot;
+  myIsSlotPending[slot] = true;
+  if( myThreadPool != NULL ) {
+    myThreadPool->submit( myTasks[slot] );
+  }
+  else {
+    myBlocks[slot]->encode();
+  }
+  myCurrentSlot = (myCurrentSlot + 1) % myNumSlots;
+  // Next block to fill is oldest block in ring: Write it out first
+  if( myIsSlotPending[myCurrentSlot] ) {
+    writeBlock( myCurrentSlot );
+  }
+}
+//----------------------------------------------------------------
+void csSeismicWriter_ver05::writeBlock( int slot ) {
+  if( myThreadPool != NULL ) {
+    myThreadPool->wait( myTasks[slot] );
+    if( myTasks[slot]->hasError() ) {
+      throw( cseis_geolib::csException("csSeismicWriter_ver05: Error occurred when encoding trace block: %s", myTasks[slot]->errorMessage()) );
+    }
+  }
+  csSeismicBlock* block = myBlocks[slot];
+  DirectoryEntry entry;
+  entry.byteOffset = myFileOffset;
+  entry.numTraces  = block->numTraces();
+  entry.blockCodec = block->blockCodec();
+  entry.byteSizeHdrSection    = block->byteSizeHdrSection();
+  entry.byteSizeSampleSection = block->byteSizeSampleSection();
+
+  int blockHeader[4];
+  blockHeader[0] = entry.numTraces;
+  blockHeader[1] = entry.blockCodec;
+  blockHeader[2] = entry.byteSizeHdrSection;
+  blockHeader[3] = entry.byteSizeSampleSection;
+  writeBytes( blockHeader, BLOCK_HEADER_BYTE_SIZE );
+  writeBytes( block->encodedBuffer(), block->byteSizeEncoded() );
+  myDirectory.insertEnd( entry );
+
+  block->setNumTraces( 0 );
+  myIsSlotPending[slot] = false;
+}
+//----------------------------------------------------------------
+void csSeismicWriter_ver05::writeDirectory() {
+  csInt64_t directoryOffset = myFileOffset;
+  int numBlocks = myDirectory.size();
+  char entryBuffer[DIRECTORY_ENTRY_BYTE_SIZE];
+  for( int iblock = 0; iblock < numBlocks; iblock++ ) {
+    DirectoryEntry const& entry = myDirectory.at(iblock);
+    memcpy( &entryBuffer[0],  &entry.byteOffset, 8 );
+    memcpy( &entryBuffer[8],  &entry.numTraces, 4 );
+    memcpy( &entryBuffer[12], &entry.blockCodec, 4 );
+    memcpy( &entryBuffer[16], &entry.byteSizeHdrSection, 4 );
+    memcpy( &entryBuffer[20], &entry.byteSizeSampleSection, 4 );
+    writeBytes( entryBuffer, DIRECTORY_ENTRY_BYTE_SIZE );
+  }
+  char trailer[TRAILER_BYTE_SIZE];
+  memcpy( &trailer[0],  &directoryOffset, 8 );
+  memcpy( &trailer[8],  &numBlocks, 4 );
+  memcpy( &trailer[12], &myNumTraces, 4 );
+  memcpy( &trailer[16], ID_TEXT_BLOCK_DIRECTORY, 4 );
+  writeBytes( trailer, TRAILER_BYTE_SIZE );
+}
+//----------------------------------------------------------------
+void csSeismicWriter_ver05::checkBufferSize( int sizeAdd ) {
+  if( myByteLoc+sizeAdd >= myTempByteSize ) {
+    int newSize = std::max( myByteLoc + sizeAdd, 2*myTempByteSize );
+    char* newBuffer = new char[newSize];
+    memcpy( newBuffer, myTempBuffer, myByteLoc );
+    delete [] myTempBuffer;
+    myTempBuffer = newBuffer;
+    myTempByteSize = newSize;
+  }
+}
+void csSeismicWriter_ver05::appendChar( char value ) {
+  checkBufferSize( 1 );
+  myTempBuffer[myByteLoc] = value;
+  myByteLoc += 1;
+}
+void csSeismicWriter_ver05::appendInt( int value ) {
+  checkBufferSize( 4 );
+  memcpy( &myTempBuffer[myByteLoc], &value, 4 );
+  myByteLoc += 4;
+}
+void csSeismicWriter_ver05::appendFloat( float value ) {
+  checkBufferSize( 4 );
+  memcpy( &myTempBuffer[myByteLoc], &value, 4 );
+  myByteLoc += 4;
+}
+void csSeismicWriter_ver05::appendDouble( double value ) {
+  checkBufferSize( 8 );
+  memcpy( &myTempBuffer[myByteLoc], &value, 8 );
+  myByteLoc += 8;
+}
+void csSeismicWriter_ver05::appendString( char const* value, int size ) {
+  checkBufferSize( size );
+  memcpy( &myTempBuffer[myByteLoc], value, size );
+  myByteLoc += size;
+}
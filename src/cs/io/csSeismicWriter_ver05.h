@@ -0,0 +1,110 @@
+/* Copyright (c) Colorado School of Mines, 2013.*/
+/* All rights reserved.                       */
+
+#ifndef CS_SEISMIC_WRITER_VER05_H
+#define CS_SEISMIC_WRITER_VER05_H
+
+#include <cstdio>
+#include <string>
+#include "geolib_defines.h"
+#include "csVector.h"
+
+namespace cseis_geolib {
+  class csThreadPool;
+}
+
+namespace cseis_io {
+
+class csSeismicIOConfig;
+class csSeismicBlock;
+class csSeismicBlockTask;
+
+/**
+ * Seismic file writer, Cseis format
+ *
+ * Version 0.5: Traces are stored in blocks of N traces, with a block directory at the end of the file.
+ * Trace headers are stored column-wise inside each block. Samples are stored raw, or compressed by a
+ * lossless or lossy codec (see csSeismicBlockCodec).
+ * Blocks are encoded in parallel worker threads, and written to disk in trace order.
+ *
+ * @author Bjorn Olofsson
+ * @date 2013
+ */
+class csSeismicWriter_ver05 {
+ public:
+  static int const VERSION_SEISMIC_WRITER = 05;
+  /// Default byte size of uncompressed trace samples held in one block
+  static int const DEFAULT_BLOCK_BYTES = 2000000;
+  /// Byte size of block header preceding each block
+  static int const BLOCK_HEADER_BYTE_SIZE = 16;
+  /// Byte size of one block directory entry
+  static int const DIRECTORY_ENTRY_BYTE_SIZE = 24;
+  /// Byte size of trailer at end of file
+  static int const TRAILER_BYTE_SIZE = 20;
+ public:
+  /**
+   * @param filename        Output file name
+   * @param numTracesBlock  Number of traces per block. Set to 0 to determine from DEFAULT_BLOCK_BYTES
+   * @param codec           Sample codec, see csSeismicBlockCodec
+   * @param tolerance       Maximum absolute sample error for lossy codec
+   * @param numThreads      Number of encoder threads. Set to 0 to use number of processors.
+   * @param overwrite       true to overwrite even if file exists
+   */
+  csSeismicWriter_ver05( std::string filename, int numTracesBlock, int codec, float tolerance, int numThreads, bool overwrite = true );
+  ~csSeismicWriter_ver05();
+  bool writeFileHeader( csSeismicIOConfig const* config );
+  bool writeTrace( float* samples, char const* hdrValueBlock );
+  /**
+   * Write out all remaining blocks, block directory and trailer, and close file
+   */
+  void close();
+
+private:
+  struct DirectoryEntry {
+    csInt64_t byteOffset;
+    int numTraces;
+    int blockCodec;
+    int byteSizeHdrSection;
+    int byteSizeSampleSection;
+  };
+  void open( bool overwrite );
+  void submitCurrentBlock();
+  void writeBlock( int slot );
+  void writeDirectory();
+  void writeBytes( void const* buffer, int numBytes );
+
+  void checkBufferSize( int sizeAdd );
+  void appendChar( char value );
+  void appendInt( int value );
+  void appendFloat( float value );
+  void appendDouble( double value );
+  void appendString( char const* value, int size );
+
+  char myVersionText[4];
+  std::string myFileName;
+  FILE* myFile;
+  int myNumSamples;
+  int myByteSizeHdrValueBlock;
+  int myCodec;
+  float myTolerance;
+  int myNumTracesBlock;
+  int myNumThreads;
+  int myNumTraces;
+  csInt64_t myFileOffset;
+
+  char* myTempBuffer;
+  int myTempByteSize;
+  int myByteLoc;
+
+  cseis_geolib::csThreadPool* myThreadPool;
+  /// Ring of blocks: One block is being filled, others are being encoded or wait to be written
+  int myNumSlots;
+  csSeismicBlock** myBlocks;
+  csSeismicBlockTask** myTasks;
+  bool* myIsSlotPending;
+  int myCurrentSlot;
+  cseis_geolib::csVector<DirectoryEntry> myDirectory;
+};
+
+} // end namespace
+#endif
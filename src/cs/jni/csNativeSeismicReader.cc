@@ -304,6 +304,59 @@ JNIEXPORT jboolean JNICALL Java_cseis_jni_csNativeSeismicReader_native_1getNextT
   return JNI_TRUE;
 }
 
+/*
+ * Class:     cseis_jni_csNativeSeismicReader
+ * Method:    native_readTraces
+ * Signature: (JIIIILjava/nio/ByteBuffer;Ljava/nio/ByteBuffer;)I
+ *
+ * Read block of traces into direct byte buffers, see csGeneralSeismicReader::readTraces()
+ */
+JNIEXPORT jint JNICALL Java_cseis_jni_csNativeSeismicReader_native_1readTraces
+(JNIEnv *env, jobject obj, jlong ptr_in, jint firstTraceIndex, jint numTraces, jint traceStep, jint sampleStep,
+ jobject sampleBuffer_in, jobject hdrBuffer_in )
+{
+  csGeneralSeismicReader* ptr = reinterpret_cast<csGeneralSeismicReader*>(ptr_in);
+
+  float* samples = reinterpret_cast<float*>( env->GetDirectBufferAddress( sampleBuffer_in ) );
+  char* hdrTable = NULL;
+  if( hdrBuffer_in != NULL ) {
+    hdrTable = reinterpret_cast<char*>( env->GetDirectBufferAddress( hdrBuffer_in ) );
+  }
+  jlong byteSizeSamples = (jlong)numTraces * (jlong)ptr->numSamplesDecimated( sampleStep ) * (jlong)sizeof(float);
+  jlong byteSizeHeaders = (jlong)numTraces * (jlong)ptr->numTraceHeaders() * 8;
+  char const* message = NULL;
+  if( samples == NULL || ( hdrBuffer_in != NULL && hdrTable == NULL ) ) {
+    message = "csNativeSeismicReader.readTraces: Sample and header buffers must be direct byte buffers";
+  }
+  else if( env->GetDirectBufferCapacity( sampleBuffer_in ) < byteSizeSamples ||
+           ( hdrTable != NULL && env->GetDirectBufferCapacity( hdrBuffer_in ) < byteSizeHeaders ) ) {
+    message = "csNativeSeismicReader.readTraces: Sample or header buffer too small for requested number of traces";
+  }
+  if( message != NULL ) {
+    jclass newExcCls = (env)->FindClass( "java/lang/Exception");
+    if( newExcCls != NULL ) (env)->ThrowNew( newExcCls, message );
+    return 0;
+  }
+
+  int numTracesRead = 0;
+  try {
+    numTracesRead = ptr->readTraces( firstTraceIndex, numTraces, traceStep, sampleStep, samples, hdrTable );
+  }
+  catch( csException& e ) {
+    fprintf( stderr, "Error when reading traces: %s\n", e.getMessage() );
+    fflush(stderr);
+    jclass newExcCls = (env)->FindClass( "java/lang/Exception");
+    if( newExcCls == NULL ) {
+      return 0;
+    }
+    else {
+      (env)->ThrowNew( newExcCls, e.getMessage() );
+      return 0;
+    }
+  }
+  return numTracesRead;
+}
+
 /*
  * Class:     cseis_jni_csNativeSeismicReader
  * Method:    native_moveToTrace
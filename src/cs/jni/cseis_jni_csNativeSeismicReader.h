@@ -106,6 +106,14 @@ JNIEXPORT jstring JNICALL Java_cseis_jni_csNativeSeismicReader_native_1hdrString
 JNIEXPORT jboolean JNICALL Java_cseis_jni_csNativeSeismicReader_native_1getNextTrace
   (JNIEnv *, jobject, jlong, jfloatArray, jobject);
 
+/*
+ * Class:     cseis_jni_csNativeSeismicReader
+ * Method:    native_readTraces
+ * Signature: (JIIIILjava/nio/ByteBuffer;Ljava/nio/ByteBuffer;)I
+ */
+JNIEXPORT jint JNICALL Java_cseis_jni_csNativeSeismicReader_native_1readTraces
+  (JNIEnv *, jobject, jlong, jint, jint, jint, jint, jobject, jobject);
+
 /*
  * Class:     cseis_jni_csNativeSeismicReader
  * Method:    native_moveToTrace
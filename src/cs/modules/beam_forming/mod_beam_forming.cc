@@ -2,7 +2,10 @@
 /* All rights reserved.                       */
 
 #include "cseis_includes.h"
+#include "csThreadPool.h"
+#include "csFFTTools.h"
 #include <cmath>
+#include <cstring>
 
 using namespace cseis_system;
 using namespace cseis_geolib;
@@ -51,12 +54,157 @@ namespace mod_beam_forming {
     int numSamples_in;
     int method;
     int outputOption;
+
+    int domain;
+    float minFreq; // Hz
+    float maxFreq; // Hz
+    int numThreads;
+    csThreadPool* threadPool;
   };
   static int const METHOD_PLANE_WAVE_FAN  = 1;
   static int const METHOD_PLANE_WAVE_GRID = 2;
   static int const METHOD_POINT_SOURCE    = 3;
   static int const WINDOW_CUT  = 11;
   static int const WINDOW_ZERO = 12;
+  static int const DOMAIN_TIME      = 21;
+  static int const DOMAIN_FREQUENCY = 22;
+
+  /**
+   * Input traces and beam geometry, shared by all beam stacking tasks.
+   * Each beam is the weighted sum of all input traces, each trace shifted by its delay time for this beam.
+   */
+  struct BeamInput {
+    int numTraces;
+    float const* const* inSamples;
+    /// Delay time [ms] of trace itrc in beam ibeam: delay_ms[ibeam*numTraces+itrc]
+    float const* delay_ms;
+    /// Weight of trace in beam, same indexing as delay_ms. 0: Trace is not used in beam
+    float const* gain;
+    /// Normalisation of beam. 0: No normalisation
+    float const* norm;
+    float** outSamples;
+    float sampleInt;
+    int startSamp;
+    int endSamp;
+    int sampShift;
+    /// Frequency domain only: FFT length, and spectra of all input traces for frequency bins firstFreq-lastFreq
+    int numFFTSamples;
+    int firstFreq;
+    int lastFreq;
+    double const* specReal;
+    double const* specImag;
+  };
+
+  /**
+   * Stacks beams firstBeam-lastBeam (inclusive). Executed in worker thread.
+   */
+  class BeamStackTask : public csRunnable {
+  public:
+    BeamStackTask( int domain, BeamInput const* input, int firstBeam, int lastBeam ) {
+      myDomain = domain;
+      myInput = input;
+      myFirstBeam = firstBeam;
+      myLastBeam  = lastBeam;
+    }
+    virtual void run() {
+      if( myDomain == DOMAIN_FREQUENCY ) {
+        runFrequency();
+      }
+      else {
+        runTime();
+      }
+    }
+  private:
+    /// Time shifts are rounded to the nearest sample
+    void runTime() {
+      BeamInput const* in = myInput;
+      for( int ibeam = myFirstBeam; ibeam <= myLastBeam; ibeam++ ) {
+        float* outSamples = in->outSamples[ibeam];
+        float const* delay_ms = &in->delay_ms[ibeam*in->numTraces];
+        float const* gain = &in->gain[ibeam*in->numTraces];
+        for( int itrc = 0; itrc < in->numTraces; itrc++ ) {
+          if( gain[itrc] == 0.0f ) continue;
+          float const* inSamples = in->inSamples[itrc];
+          int nearestSamp = (int)round( delay_ms[itrc] / in->sampleInt );
+          int minSamp = min( max(in->startSamp,-nearestSamp), in->endSamp );
+          int maxSamp = max( min(in->endSamp,in->endSamp-nearestSamp), in->startSamp );
+          for( int isamp = minSamp; isamp <= maxSamp; isamp++ ) {
+            outSamples[isamp-in->sampShift] += gain[itrc]*inSamples[isamp+nearestSamp];
+          }
+        }
+        float norm = in->norm[ibeam];
+        if( norm != 0.0f ) {
+          for( int isamp = in->startSamp; isamp <= in->endSamp; isamp++ ) {
+            outSamples[isamp-in->sampShift] /= norm;
+          }
+        }
+      }
+    }
+    /// Time shifts are applied as phase shifts to the input spectra
+    void runFrequency() {
+      BeamInput const* in = myInput;
+      int nfft = in->numFFTSamples;
+      int numFreqs = in->lastFreq - in->firstFreq + 1;
+      csFFTTools fftTool( nfft );
+      double* beamReal = new double[numFreqs];
+      double* beamImag = new double[numFreqs];
+      double angleSamp = 2.0 * M_PI / (double)nfft;
+      for( int ibeam = myFirstBeam; ibeam <= myLastBeam; ibeam++ ) {
+        float const* delay_ms = &in->delay_ms[ibeam*in->numTraces];
+        float const* gain = &in->gain[ibeam*in->numTraces];
+        for( int ifreq = 0; ifreq < numFreqs; ifreq++ ) {
+          beamReal[ifreq] = 0.0;
+          beamImag[ifreq] = 0.0;
+        }
+        for( int itrc = 0; itrc < in->numTraces; itrc++ ) {
+          if( gain[itrc] == 0.0f ) continue;
+          double g = gain[itrc];
+          // Phase shift exp(i*w*delay), stepped from one frequency bin to the next by complex multiplication
+          double angle  = angleSamp * (double)delay_ms[itrc] / (double)in->sampleInt;
+          double stepRe = cos( angle );
+          double stepIm = sin( angle );
+          double phaseRe = cos( angle * (double)in->firstFreq );
+          double phaseIm = sin( angle * (double)in->firstFreq );
+          double const* specReal = &in->specReal[itrc*numFreqs];
+          double const* specImag = &in->specImag[itrc*numFreqs];
+          for( int ifreq = 0; ifreq < numFreqs; ifreq++ ) {
+            beamReal[ifreq] += g * ( specReal[ifreq]*phaseRe - specImag[ifreq]*phaseIm );
+            beamImag[ifreq] += g * ( specReal[ifreq]*phaseIm + specImag[ifreq]*phaseRe );
+            double tmp = phaseRe*stepRe - phaseIm*stepIm;
+            phaseIm    = phaseRe*stepIm + phaseIm*stepRe;
+            phaseRe    = tmp;
+          }
+        }
+        double scalar = ( in->norm[ibeam] != 0.0f ) ? 1.0 / (double)in->norm[ibeam] : 1.0;
+        double* bufferReal = fftTool.getRealDataPointer();
+        double* bufferImag = fftTool.getImagDataPointer();
+        for( int i = 0; i < nfft; i++ ) {
+          bufferReal[i] = 0.0;
+          bufferImag[i] = 0.0;
+        }
+        for( int ifreq = 0; ifreq < numFreqs; ifreq++ ) {
+          int ibin = ifreq + in->firstFreq;
+          bufferReal[ibin] = scalar * beamReal[ifreq];
+          if( ibin == 0 || ibin == nfft/2 ) continue;
+          bufferImag[ibin] = scalar * beamImag[ifreq];
+          bufferReal[nfft-ibin] =  bufferReal[ibin];
+          bufferImag[nfft-ibin] = -bufferImag[ibin];
+        }
+        fftTool.fft_inverse();
+        float* outSamples = in->outSamples[ibeam];
+        for( int isamp = in->startSamp; isamp <= in->endSamp; isamp++ ) {
+          outSamples[isamp-in->sampShift] = (float)bufferReal[isamp];
+        }
+      }
+      delete [] beamReal;
+      delete [] beamImag;
+    }
+
+    int myDomain;
+    BeamInput const* myInput;
+    int myFirstBeam;
+    int myLastBeam;
+  };
 }
 
 //*************************************************************************************************
@@ -105,6 +253,11 @@ void init_mod_beam_forming_( csParamManager* param, csInitPhaseEnv* env, csLogWr
   vars->endSamp   = shdr->numSamples - 1;
   vars->outputOption = mod_beam_forming::WINDOW_ZERO;
   vars->numSamples_in = shdr->numSamples;
+  vars->domain     = mod_beam_forming::DOMAIN_TIME;
+  vars->minFreq    = 0.0;
+  vars->maxFreq    = 0.0;
+  vars->numThreads = 1;
+  vars->threadPool = NULL;
 
   //------------------------------------------------------------------------------
   if( param->exists("plane_wave") ) {
@@ -186,6 +339,43 @@ void init_mod_beam_forming_( csParamManager* param, csInitPhaseEnv* env, csLogWr
     }
   }
 
+  if( param->exists("domain") ) {
+    std::string text;
+    param->getString("domain",&text,0);
+    if( !text.compare("time") ) {
+      vars->domain = mod_beam_forming::DOMAIN_TIME;
+    }
+    else if( !text.compare("frequency") ) {
+      vars->domain = mod_beam_forming::DOMAIN_FREQUENCY;
+      if( param->getNumValues("domain") > 1 ) {
+        param->getFloat("domain",&vars->minFreq,1);
+      }
+      if( param->getNumValues("domain") > 2 ) {
+        param->getFloat("domain",&vars->maxFreq,2);
+      }
+      if( vars->minFreq < 0.0 || (vars->maxFreq > 0.0 && vars->maxFreq <= vars->minFreq) ) {
+        log->error("Inconsistent frequency range: %f to %f", vars->minFreq, vars->maxFreq);
+      }
+    }
+    else {
+      log->error("Unknown option: %s", text.c_str());
+    }
+  }
+  if( param->exists("nthreads") ) {
+    param->getInt("nthreads",&vars->numThreads);
+    if( vars->numThreads < 0 ) log->error("Number of threads must be >= 0. Specified: %d", vars->numThreads );
+    if( vars->numThreads == 0 ) vars->numThreads = csThreadPool::numProcessors();
+  }
+  if( vars->numThreads > 1 ) {
+    try {
+      vars->threadPool = new csThreadPool( vars->numThreads );
+    }
+    catch( csException& e ) {
+      log->error("Error when starting beam forming threads.\nSystem message: %s", e.getMessage() );
+    }
+    log->line("Compute beams using %d threads", vars->threadPool->numThreads() );
+  }
+
 //  vars->hdrId_rcv   = hdef->addHeader( csStandardHeaders::get("rcv") );
 //  vars->hdrId_rec_x = hdef->addHeader( csStandardHeaders::get("rec_x") );
 //  vars->hdrId_rec_y = hdef->addHeader( csStandardHeaders::get("rec_y") );
@@ -213,6 +403,10 @@ void exec_mod_beam_forming_(
   csTraceHeaderDef const* hdef = env->headerDef;
 
   if( edef->isCleanup() ) {
+    if( vars->threadPool != NULL ) {
+      delete vars->threadPool;
+      vars->threadPool = NULL;
+    }
     delete vars; vars = NULL;
     return;
   }
@@ -244,6 +438,10 @@ void exec_mod_beam_forming_(
       outSamples[isamp] = 0.0;
     }
   }
+  // Delay time, gain and normalisation of all traces in all beams
+  float* delay_ms = new float[nBeams*nTraces];
+  float* gain = new float[nBeams*nTraces];
+  float* norm = new float[nBeams];
   int beamCounter = 0;
   int sampShift = 0;
   if( vars->outputOption == mod_beam_forming::WINDOW_CUT ) {
@@ -261,26 +459,15 @@ void exec_mod_beam_forming_(
       float cos_azim = cos(azim_rad);
       for( int islow = 0; islow < vars->numSlownesses; islow++ ) {
         float slowness_spkm = (float)islow * slownessStep;  // [s/km]
-        float* outSamples = traceGather->trace(nTraces+beamCounter)->getTraceSamples();
         csTraceHeader* trcHdr = traceGather->trace(nTraces+beamCounter)->getTraceHeader();
         trcHdr->setFloatValue(vars->hdrId_azim, (float)(azim_rad*180.0/M_PI));
         trcHdr->setFloatValue(vars->hdrId_slowness, slowness_spkm);
-        //  memcpy(outSamples,traceGather->trace(0)->getTraceSamples(),nSamples*sizeof(float));
         for( int itrc = 0; itrc < nTraces; itrc++ ) {
-          float* inSamples = traceGather->trace(itrc)->getTraceSamples();
           double projection = rec_dx[itrc] * sin_azim + rec_dy[itrc] * cos_azim;
-          float delayTime_ms = 0.0f;
-          delayTime_ms = (float)(projection * slowness_spkm);  // [ms]
-          int nearestSamp = (int)round( delayTime_ms / shdr->sampleInt );
-          int minSamp = min( max(vars->startSamp,-nearestSamp), vars->endSamp );
-          int maxSamp = max( min(vars->endSamp,vars->endSamp-nearestSamp), vars->startSamp );
-          for( int isamp = minSamp; isamp <= maxSamp; isamp++ ) {
-            outSamples[isamp-sampShift] += inSamples[isamp+nearestSamp];
-          }
-        }
-        for( int isamp = vars->startSamp; isamp <= vars->endSamp; isamp++ ) {
-          outSamples[isamp-sampShift] /= (float)nTraces;
+          delay_ms[beamCounter*nTraces+itrc] = (float)(projection * slowness_spkm);  // [ms]
+          gain[beamCounter*nTraces+itrc] = 1.0f;
         }
+        norm[beamCounter] = (float)nTraces;
         beamCounter += 1;
       }
     }
@@ -298,28 +485,17 @@ void exec_mod_beam_forming_(
         float azim_rad = atan2( slowness_x, slowness_y );
         float sin_azim = sin(azim_rad);
         float cos_azim = cos(azim_rad);
-        float* outSamples = traceGather->trace(nTraces+beamCounter)->getTraceSamples();
         csTraceHeader* trcHdr = traceGather->trace(nTraces+beamCounter)->getTraceHeader();
         trcHdr->setFloatValue(vars->hdrId_azim, (float)(azim_rad*180.0/M_PI));
         trcHdr->setFloatValue(vars->hdrId_slowness, slowness_spkm);
         trcHdr->setFloatValue(vars->hdrId_slowness_x, slowness_x);
         trcHdr->setFloatValue(vars->hdrId_slowness_y, slowness_y);
-        //  memcpy(outSamples,traceGather->trace(0)->getTraceSamples(),nSamples*sizeof(float));
         for( int itrc = 0; itrc < nTraces; itrc++ ) {
-          float* inSamples = traceGather->trace(itrc)->getTraceSamples();
           double projection = rec_dx[itrc] * sin_azim + rec_dy[itrc] * cos_azim;
-          float delayTime_ms = 0.0;
-          delayTime_ms = (float)(projection * slowness_spkm); // [ms]
-          int nearestSamp = (int)round( delayTime_ms / shdr->sampleInt );
-          int minSamp = min( max(vars->startSamp,-nearestSamp), vars->endSamp );
-          int maxSamp = max( min(vars->endSamp,vars->endSamp-nearestSamp), vars->startSamp );
-          for( int isamp = minSamp; isamp <= maxSamp; isamp++ ) {
-            outSamples[isamp-sampShift] += inSamples[isamp+nearestSamp];
-          }
-        }
-        for( int isamp = vars->startSamp; isamp <= vars->endSamp; isamp++ ) {
-          outSamples[isamp-sampShift] /= (float)nTraces;
+          delay_ms[beamCounter*nTraces+itrc] = (float)(projection * slowness_spkm); // [ms]
+          gain[beamCounter*nTraces+itrc] = 1.0f;
         }
+        norm[beamCounter] = (float)nTraces;
         beamCounter += 1;
       }
     }
@@ -332,55 +508,151 @@ void exec_mod_beam_forming_(
 //      fprintf(stderr,"Test X coordinate: %f\n", xp);
       for( int iy = 0; iy < vars->numStepsY; iy++ ) {
         float yp = (float)((double)iy * vars->incXY + vars->minY);
-        float* outSamples = traceGather->trace(nTraces+beamCounter)->getTraceSamples();
         csTraceHeader* trcHdr = traceGather->trace(nTraces+beamCounter)->getTraceHeader();
         trcHdr->setFloatValue(vars->hdrId_slowness, vars->ps_slowness);
         trcHdr->setFloatValue(vars->hdrId_beam_sou_x, xp);
         trcHdr->setFloatValue(vars->hdrId_beam_sou_y, yp);
-        //  memcpy(outSamples,traceGather->trace(0)->getTraceSamples(),nSamples*sizeof(float));
         int numStackedTraces = 0;
         float numStackedGain = 0.0;
         for( int itrc = 0; itrc < nTraces; itrc++ ) {
-          float* inSamples = traceGather->trace(itrc)->getTraceSamples();
           double dx = rec_dx[itrc]+rec_dx[0] - xp;
           double dy = rec_dy[itrc]+rec_dy[0] - yp;
           double offset = sqrt( dx*dx + dy*dy );
+          delay_ms[beamCounter*nTraces+itrc] = (float)( offset * vars->ps_slowness ); // [ms]
+          gain[beamCounter*nTraces+itrc] = 0.0f;
           if( vars->isOffsetSet ) {
             if( offset < vars->ps_minOffset || offset > vars->ps_maxOffset ) {
               continue;
             }
           }
           numStackedTraces += 1;
-          float gain = 1.0f;
+          float gainTrace = 1.0f;
           if( vars->ps_gain > 0.0 ) {
-            gain = (float)pow( max( 1.0, offset), (double)vars->ps_gain );
-          }
-          numStackedGain += gain;
-          float delayTime_ms = (float)( offset * vars->ps_slowness ); // [ms]
-          int nearestSamp = (int)round( delayTime_ms / shdr->sampleInt );
-          int minSamp = min( max(vars->startSamp,-nearestSamp), vars->endSamp );
-          int maxSamp = max( min(vars->endSamp,vars->endSamp-nearestSamp), vars->startSamp );
-          for( int isamp = minSamp; isamp <= maxSamp; isamp++ ) {
-            outSamples[isamp-sampShift] += gain*inSamples[isamp+nearestSamp];
+            gainTrace = (float)pow( max( 1.0, offset), (double)vars->ps_gain );
           }
+          numStackedGain += gainTrace;
+          gain[beamCounter*nTraces+itrc] = gainTrace;
         }
+        norm[beamCounter] = 0.0f;
         if( numStackedTraces > 0 ) {
-          if( vars->ps_gain == 0.0 ) {
-            for( int isamp = vars->startSamp; isamp <= vars->endSamp; isamp++ ) {
-              outSamples[isamp-sampShift] /= (float)numStackedTraces;
-            }
-          }
-          else {
-            for( int isamp = vars->startSamp; isamp <= vars->endSamp; isamp++ ) {
-              outSamples[isamp-sampShift] /= numStackedGain;
-            }
-          }
+          norm[beamCounter] = ( vars->ps_gain == 0.0 ) ? (float)numStackedTraces : numStackedGain;
         }
         beamCounter += 1;
       }
     }
   } // END point source
 
+  //----------------------------------------------------------------------------------
+  // Stack beams
+  //
+  mod_beam_forming::BeamInput input;
+  float const** inSamples = new float const*[nTraces];
+  float** outSamples = new float*[nBeams];
+  for( int itrc = 0; itrc < nTraces; itrc++ ) {
+    inSamples[itrc] = traceGather->trace(itrc)->getTraceSamples();
+  }
+  for( int ibeam = 0; ibeam < nBeams; ibeam++ ) {
+    outSamples[ibeam] = traceGather->trace(nTraces+ibeam)->getTraceSamples();
+  }
+  input.numTraces  = nTraces;
+  input.inSamples  = inSamples;
+  input.delay_ms   = delay_ms;
+  input.gain       = gain;
+  input.norm       = norm;
+  input.outSamples = outSamples;
+  input.sampleInt  = shdr->sampleInt;
+  input.startSamp  = vars->startSamp;
+  input.endSamp    = vars->endSamp;
+  input.sampShift  = sampShift;
+  input.numFFTSamples = 0;
+  input.firstFreq  = 0;
+  input.lastFreq   = 0;
+  input.specReal   = NULL;
+  input.specImag   = NULL;
+  double* specReal = NULL;
+  double* specImag = NULL;
+
+  if( vars->domain == mod_beam_forming::DOMAIN_FREQUENCY ) {
+    // Input samples after the analysis window are not used, same as in the time domain.
+    // Pad FFT by the largest time shift, to avoid wrap-around
+    float maxShift = 0.0;
+    for( int i = 0; i < nBeams*nTraces; i++ ) {
+      if( gain[i] != 0.0f ) maxShift = max( maxShift, (float)fabs(delay_ms[i]) );
+    }
+    int numSamplesUsed = vars->endSamp + 1;
+    int nfft = 1;
+    while( nfft < numSamplesUsed + (int)ceil(maxShift/shdr->sampleInt) + 1 ) nfft *= 2;
+    float df = 1000.0f / ( (float)nfft * shdr->sampleInt ); // [Hz]
+    int firstFreq = (int)ceil( vars->minFreq / df );
+    int lastFreq  = nfft/2;
+    if( vars->maxFreq > 0.0 ) lastFreq = min( lastFreq, (int)floor( vars->maxFreq / df ) );
+    firstFreq = min( firstFreq, lastFreq );
+    int numFreqs = lastFreq - firstFreq + 1;
+
+    csFFTTools fftTool( nfft );
+    float* buffer = new float[nfft];
+    specReal = new double[nTraces*numFreqs];
+    specImag = new double[nTraces*numFreqs];
+    for( int isamp = numSamplesUsed; isamp < nfft; isamp++ ) {
+      buffer[isamp] = 0.0;
+    }
+    for( int itrc = 0; itrc < nTraces; itrc++ ) {
+      memcpy( buffer, inSamples[itrc], numSamplesUsed*sizeof(float) );
+      fftTool.fft_forward( buffer );
+      double const* real = fftTool.realData();
+      double const* imag = fftTool.imagData();
+      for( int ifreq = 0; ifreq < numFreqs; ifreq++ ) {
+        specReal[itrc*numFreqs+ifreq] = real[ifreq+firstFreq];
+        specImag[itrc*numFreqs+ifreq] = imag[ifreq+firstFreq];
+      }
+    }
+    delete [] buffer;
+    input.numFFTSamples = nfft;
+    input.firstFreq = firstFreq;
+    input.lastFreq  = lastFreq;
+    input.specReal  = specReal;
+    input.specImag  = specImag;
+  }
+
+  int numTasks = 1;
+  if( vars->threadPool != NULL ) numTasks = min( nBeams, 4*vars->threadPool->numThreads() );
+  if( numTasks < 1 ) numTasks = 1;
+  mod_beam_forming::BeamStackTask** tasks = new mod_beam_forming::BeamStackTask*[numTasks];
+  for( int itask = 0; itask < numTasks; itask++ ) {
+    int firstBeam = (int)( ( (long)itask * (long)nBeams ) / numTasks );
+    int lastBeam  = (int)( ( (long)(itask+1) * (long)nBeams ) / numTasks ) - 1;
+    tasks[itask] = new mod_beam_forming::BeamStackTask( vars->domain, &input, firstBeam, lastBeam );
+  }
+  std::string errorMessage;
+  if( vars->threadPool != NULL ) {
+    for( int itask = 0; itask < numTasks; itask++ ) {
+      vars->threadPool->submit( tasks[itask] );
+    }
+    vars->threadPool->waitAll();
+    for( int itask = 0; itask < numTasks; itask++ ) {
+      if( tasks[itask]->hasError() ) errorMessage = tasks[itask]->errorMessage();
+    }
+  }
+  else {
+    tasks[0]->run();
+  }
+  for( int itask = 0; itask < numTasks; itask++ ) {
+    delete tasks[itask];
+  }
+  delete [] tasks;
+  delete [] inSamples;
+  delete [] outSamples;
+  delete [] delay_ms;
+  delete [] gain;
+  delete [] norm;
+  if( specReal != NULL ) delete [] specReal;
+  if( specImag != NULL ) delete [] specImag;
+  delete [] rec_dx;
+  delete [] rec_dy;
+  if( !errorMessage.empty() ) {
+    log->error("Beam forming failed: %s", errorMessage.c_str());
+  }
+
   traceGather->freeTraces( 0, nTraces );
 }
 
@@ -435,6 +707,18 @@ void params_mod_beam_forming_( csParamDef* pdef ) {
   pdef->addValue( "zero", VALTYPE_OPTION, "Output trace option" );
   pdef->addOption( "zero", "Sample values outside of the analysis window are set to 0" );
   pdef->addOption( "cut", "Only samples in analysis window are output to output trace" );
+
+  pdef->addParam( "domain", "Domain in which beams are computed", NUM_VALUES_VARIABLE );
+  pdef->addValue( "time", VALTYPE_OPTION );
+  pdef->addOption( "time", "Stack time shifted traces. Time shifts are rounded to the nearest sample" );
+  pdef->addOption( "frequency", "Apply exact time shifts as phase shifts to the trace spectra, and stack in the frequency domain",
+                   "Each input trace is transformed once. Only frequencies in the specified range contribute to the beams" );
+  pdef->addValue( "0", VALTYPE_NUMBER, "Minimum frequency [Hz] (frequency domain only)" );
+  pdef->addValue( "0", VALTYPE_NUMBER, "Maximum frequency [Hz] (frequency domain only). 0: Nyquist" );
+
+  pdef->addParam( "nthreads", "Number of threads", NUM_VALUES_FIXED,
+                  "Beams are split among threads. Output does not depend on the number of threads" );
+  pdef->addValue( "1", VALTYPE_NUMBER, "Number of threads (0: Use number of processors)" );
 }
 
 extern "C" void _params_mod_beam_forming_( csParamDef* pdef ) {
@@ -1,50 +1,159 @@
 #include <cstdio>
 #include <cstring>
 #include <cstdlib>
+#include <string>
 #include "csFXDecon.h"
 #include "csException.h"
 #include "csFFTTools.h"
+#include "csThreadPool.h"
 #include "geolib_defines.h"
 
 using namespace mod_fxdecon;
 using namespace std;
 
+namespace mod_fxdecon {
+/**
+ * One task of the FX deconvolution, with its own work arrays
+ * Work arrays are allocated once and re-used for all ensembles.
+ */
+class csFXDeconTask : public cseis_geolib::csRunnable {
+ public:
+  csFXDeconTask( csFXDecon* fxdecon, int numSamplesFFT, int ntraces_design, int ntraces_filter ) {
+    myFXDecon = fxdecon;
+    myStage = 0;
+    myFirst = 0;
+    myLast  = -1;
+    int nfilt2 = 2*ntraces_filter;
+    bufferReal = new double[ numSamplesFFT ];
+    bufferImag = new double[ numSamplesFFT ];
+    ttodataw1  = new float[ numSamplesFFT ];
+    ttodataw2  = new float[ numSamplesFFT ];
+    sfreq      = new complex<float>[ 2*ntraces_design+nfilt2 ];
+    xcorWork   = new complex<float>[ 2*ntraces_design+nfilt2 ];
+    autocorr   = new complex<float>[ ntraces_filter+1 ];
+    fvector    = new complex<float>[ nfilt2+1 ];
+    sfreqout   = new complex<float>[ 2*ntraces_design ];
+    gvector    = new float[ nfilt2 > 0 ? nfilt2 : 1 ];
+    luWork     = new float[ nfilt2 > 0 ? nfilt2 : 1 ];
+    ipvt       = new int[ nfilt2 > 0 ? nfilt2 : 1 ];
+    rmatrix    = new float*[ nfilt2 > 0 ? nfilt2 : 1 ];
+    for( int itrc = 0; itrc < nfilt2; itrc++ ) {
+      rmatrix[itrc] = new float[ nfilt2 ];
+    }
+    myNumRowsMatrix = nfilt2;
+  }
+  ~csFXDeconTask() {
+    delete [] bufferReal;
+    delete [] bufferImag;
+    delete [] ttodataw1;
+    delete [] ttodataw2;
+    delete [] sfreq;
+    delete [] xcorWork;
+    delete [] autocorr;
+    delete [] fvector;
+    delete [] sfreqout;
+    delete [] gvector;
+    delete [] luWork;
+    delete [] ipvt;
+    for( int itrc = 0; itrc < myNumRowsMatrix; itrc++ ) {
+      delete [] rmatrix[itrc];
+    }
+    delete [] rmatrix;
+  }
+  void set( int stage, int first, int last ) {
+    myStage = stage;
+    myFirst = first;
+    myLast  = last;
+  }
+  virtual void run() {
+    if( myStage == csFXDecon::STAGE_FORWARD ) {
+      myFXDecon->forwardTraces( myFirst, myLast, this );
+    }
+    else if( myStage == csFXDecon::STAGE_FILTER ) {
+      myFXDecon->filterFrequencies( myFirst, myLast, this );
+    }
+    else if( myStage == csFXDecon::STAGE_INVERSE ) {
+      myFXDecon->inverseTraces( myFirst, myLast, this );
+    }
+  }
+
+  double* bufferReal;
+  double* bufferImag;
+  float* ttodataw1;
+  float* ttodataw2;
+  complex<float>* sfreq;
+  complex<float>* xcorWork;
+  complex<float>* autocorr;
+  complex<float>* fvector;
+  complex<float>* sfreqout;
+  float* gvector;
+  float* luWork;
+  int* ipvt;
+  float** rmatrix;
+
+ private:
+  csFXDecon* myFXDecon;
+  int myStage;
+  int myFirst;
+  int myLast;
+  int myNumRowsMatrix;
+};
+} // end namespace
+
 csFXDecon::csFXDecon() {
-  myFFT = NULL;
-  myNumTraces = 0;
-
-  fdata = NULL;
-  fdataw = NULL;
-  ffreq = NULL;
-  rmatrix = NULL;
-
-  fvector = NULL;
-  sfreq = NULL;
-  autocorr = NULL;
-  rautoc = NULL;
-  iautoc = NULL;
-  gvector = NULL;
-
-  info = NULL;
-  ipvt = NULL;
-  bufferRealImag = NULL;
-
- sfreqout = NULL;
- tidataw  = NULL;
- ttodataw = NULL;
+  myNumSamplesFFT = 0;
+  myTwoPowerFFT   = 0;
+  myNumFreq       = 0;
+  myFirstFreq     = 0;
+  myLastFreq      = -1;
+
+  mySpec     = NULL;
+  myFiltSpec = NULL;
+  myMaxNumTraces = 0;
+
+  myThreadPool = NULL;
+  myTasks      = NULL;
+  myNumTasks   = 0;
+
+  mySamplesIn  = NULL;
+  mySamplesOut = NULL;
+  myNumTraces  = 0;
+  myNumSamples = 0;
+  myNumWinSpatial = 0;
+  myCurrentWin    = 0;
+  myNumSamplesWinCurrent = 0;
 }
 csFXDecon::~csFXDecon() {
-  if( myFFT != NULL ) {
-    delete myFFT;
-    myFFT = NULL;
+  if( myThreadPool != NULL ) {
+    delete myThreadPool;
+    myThreadPool = NULL;
+  }
+  if( myTasks != NULL ) {
+    for( int itask = 0; itask < myNumTasks; itask++ ) {
+      delete myTasks[itask];
+    }
+    delete [] myTasks;
+    myTasks = NULL;
+  }
+  if( mySpec != NULL ) {
+    delete [] mySpec;
+    mySpec = NULL;
+  }
+  if( myFiltSpec != NULL ) {
+    delete [] myFiltSpec;
+    myFiltSpec = NULL;
   }
-  freeMem( myNumTraces );
 }
 //--------------------------------------------------------------------------------
 //
 void csFXDecon::initialize( float sampleInt_ms, int numSamplesIn, mod_fxdecon::Attr const& attr ) {
-  myFFT = new cseis_geolib::csFFTTools( numSamplesIn );
-  myNumSamplesFFT = myFFT->numFFTSamples();
+  int twoPower_m = 0;
+  cseis_geolib::csFFTTools::Powerof2( numSamplesIn, &myTwoPowerFFT, &twoPower_m );
+  myNumSamplesFFT = twoPower_m;
+  if( myNumSamplesFFT != numSamplesIn ) {
+    myNumSamplesFFT = twoPower_m * 2;
+    myTwoPowerFFT  += 1;
+  }
   // !CHANGE!    Try to reduce the number of samples in FFT: Feed fftTool maximum length of window (numSamplesWinF??) instead of full trace length (numSamples)
   myNumFreq = myNumSamplesFFT/2 + 1;
   myFreqStep_hz = 1000.0/(float)(myNumSamplesFFT*sampleInt_ms);
@@ -62,398 +171,364 @@ void csFXDecon::initialize( float sampleInt_ms, int numSamplesIn, mod_fxdecon::A
   myNumSamplesWinF = winLen_samp + taperLen_samp/2;
   myNumSamplesWinI = winLen_samp + taperLen_samp;
 
-  
-  ntraces_fdataw = 2*ntraces_design+2*ntraces_filter;
-}
-void csFXDecon::freeMem( int numTraces ) {
-  for( int itrc = 0; itrc < numTraces; itrc++ ) {
-    delete [] fdata[itrc];
+  myFirstFreq = myNumFreq;
+  myLastFreq  = -1;
+  for( int ifq = 0; ifq < myNumFreq; ifq++ ) {
+    float freqCurrent = (float)ifq*myFreqStep_hz;
+    if( freqCurrent >= fmin && freqCurrent <= fmax ) {
+      if( ifq < myFirstFreq ) myFirstFreq = ifq;
+      myLastFreq = ifq;
+    }
   }
 
-  delete [] fdata;
-  delete [] sfreq;
-  delete [] autocorr;
-  delete [] rautoc;
-  delete [] gvector;
-  delete [] fvector;
-
-  for( int itrc = 0; itrc < 2*ntraces_filter; itrc++ ) {
-    delete [] rmatrix[itrc];
-  }
-  delete [] rmatrix;
-  delete [] info;
-  delete [] ipvt;
-  delete [] sfreqout;
-  for( int itrc = 0; itrc < 2*ntraces_design; itrc++ ) {
-    delete [] ffreq[itrc];
+  myNumTasks = 1;
+  if( attr.numThreads > 1 ) {
+    myThreadPool = new cseis_geolib::csThreadPool( attr.numThreads );
+    myNumTasks   = 4 * myThreadPool->numThreads();
   }
-  delete [] ffreq;
-  delete [] ttodataw;
-  delete [] bufferRealImag;
-  delete [] iautoc;
-  delete [] tidataw;
-  for( int itrc = 0; itrc < ntraces_fdataw; itrc++ ) {
-    delete [] fdataw[itrc];
+  myTasks = new csFXDeconTask*[myNumTasks];
+  for( int itask = 0; itask < myNumTasks; itask++ ) {
+    myTasks[itask] = new csFXDeconTask( this, myNumSamplesFFT, ntraces_design, ntraces_filter );
   }
-  delete [] fdataw;
-
-  fdata = NULL;
-  fdataw = NULL;
-  ffreq = NULL;
-  rmatrix = NULL;
-
-  fvector = NULL;
-  sfreq = NULL;
-  autocorr = NULL;
-  rautoc = NULL;
-  iautoc = NULL;
-  gvector = NULL;
-
-  info = NULL;
-  ipvt = NULL;
-  bufferRealImag = NULL;
-
-  sfreqout = NULL;
-  tidataw = NULL;
-  ttodataw = NULL;
+}
+int csFXDecon::numThreads() const {
+  return( myThreadPool != NULL ? myThreadPool->numThreads() : 1 );
 }
 //--------------------------------------------------------------------------------
 //
-void csFXDecon::initialize_internal( int numTraces, int numSamples ) {
-  if( fdata != NULL ) {
-    if( myNumTraces == numTraces ) {
-      return;
-    }
-    freeMem( myNumTraces );
-  }
-  myNumTraces = numTraces;
-
-  fdata  = new complex<float>*[ myNumTraces ];
-  fdataw = new complex<float>*[ ntraces_fdataw ];
-  ffreq  = new complex<float>*[ 2*ntraces_design ];
-  rmatrix         = new float*[ 2*ntraces_filter ];
-
-  for( int itrc = 0; itrc < numTraces; itrc++ ) {
-    fdata[itrc]      = new complex<float>[myNumFreq];
-  }
-  for( int itrc = 0; itrc < ntraces_fdataw; itrc++ ) {
-    fdataw[itrc]     = new complex<float>[myNumFreq];
-  }
-  for( int itrc = 0; itrc < 2*ntraces_filter; itrc++ ) {
-    rmatrix[itrc]    = new float[ 2*ntraces_filter ];
+void csFXDecon::allocateSpectra( int numTraces ) {
+  if( numTraces <= myMaxNumTraces ) return;
+  if( mySpec != NULL ) delete [] mySpec;
+  if( myFiltSpec != NULL ) delete [] myFiltSpec;
+  myMaxNumTraces = numTraces;
+  mySpec     = new complex<float>[ (size_t)myNumFreq * (size_t)myMaxNumTraces ];
+  myFiltSpec = new complex<float>[ (size_t)myNumFreq * (size_t)myMaxNumTraces ];
+}
+//--------------------------------------------------------------------------------
+// Split numItems items (trace pairs or frequencies) into tasks, run tasks and wait until all are done
+//
+void csFXDecon::runStage( int stage, int numItems ) {
+  if( numItems <= 0 ) return;
+  int numTasks = myNumTasks < numItems ? myNumTasks : numItems;
+  if( myThreadPool == NULL || numTasks == 1 ) {
+    myTasks[0]->set( stage, 0, numItems-1 );
+    myTasks[0]->run();
+    return;
   }
-  for( int itrc = 0; itrc < 2*ntraces_design; itrc++ ) {
-    ffreq[itrc] = new std::complex<float>[ myNumFreq ];
+  for( int itask = 0; itask < numTasks; itask++ ) {
+    int first = (int)( ( (long)itask * (long)numItems ) / numTasks );
+    int last  = (int)( ( (long)(itask+1) * (long)numItems ) / numTasks ) - 1;
+    myTasks[itask]->set( stage, first, last );
+    myThreadPool->submit( myTasks[itask] );
   }
-
-  fvector  = new complex<float>[ 2*ntraces_filter+1 ];
-  sfreq   = new complex<float>[2*ntraces_design+2*ntraces_filter];
-  for( int itrc = 0; itrc < 2*ntraces_design+2*ntraces_filter; itrc++ ) {
-    sfreq[itrc] = std::complex<float>(0,0);
+  myThreadPool->waitAll();
+  for( int itask = 0; itask < numTasks; itask++ ) {
+    if( myTasks[itask]->hasError() ) {
+      throw( cseis_geolib::csException("csFXDecon::apply(): %s", myTasks[itask]->errorMessage()) );
+    }
   }
-  autocorr = new complex<float>[ntraces_filter+1];
-  rautoc  = new float[ ntraces_filter+1 ];
-  iautoc  = new float[ ntraces_filter+1 ];
-  gvector = new float[ 2*ntraces_filter ];
-
-  info = new float[ 4*ntraces_design ];
-  ipvt  = new int[ 4*ntraces_design ];
-  bufferRealImag = new float[ 2*myNumSamplesFFT ];
-
-  sfreqout = new std::complex<float>[ 2*ntraces_design ];
-  tidataw  = new float[ numSamples ];
-  ttodataw = new float[ myNumSamplesFFT ];
 }
 //--------------------------------------------------------------------------------
 //
 void csFXDecon::apply( float** samplesIn, float** samplesOut, int numTraces, int numSamples ) {
-  initialize_internal( numTraces, numSamples );
-
-  int numWinSpatial = numTraces / ntraces_design;
+  allocateSpectra( numTraces );
+  mySamplesIn  = samplesIn;
+  mySamplesOut = samplesOut;
+  myNumTraces  = numTraces;
+  myNumSamples = numSamples;
+  myNumWinSpatial = numTraces / ntraces_design;
 
-  int numSamplesWinCurrent = 0;
+  // Traces are only output if there is at least one full spatial window
+  int numPairs = ( myNumWinSpatial > 0 ) ? ( numTraces + 1 ) / 2 : 0;
+  int numFreqFilter = myLastFreq - myFirstFreq + 1;
 
   // Loop over time windows
   for( int iwin = 0; iwin < numWin; iwin++ ) {
-
-    // Zero arrays:
-    for( int itrc = 0; itrc < numTraces; itrc++ ) {
-      for( int ifq = 0; ifq < myNumFreq; ifq++ ) {
-        fdata[itrc][ifq] = std::complex<float>(0,0);
-      }
-    }
-    for( int itrc = 0; itrc < ntraces_design+2*ntraces_filter; itrc++ ) {
-      for( int ifq = 0; ifq < myNumFreq; ifq++ ) {
-        fdataw[itrc][ifq] = std::complex<float>(0,0);
-      }
-    }
-
     if( iwin > 0 && iwin < numWin-1 ) {
-      numSamplesWinCurrent = myNumSamplesWinI;
+      myNumSamplesWinCurrent = myNumSamplesWinI;
     }
     else if ( iwin == 0 ) {
       if( numWin > 1 ) {
-        numSamplesWinCurrent = myNumSamplesWinF;
+        myNumSamplesWinCurrent = myNumSamplesWinF;
       }
       else {
-        numSamplesWinCurrent = numSamples;
+        myNumSamplesWinCurrent = numSamples;
       }
     }
     else {
-      numSamplesWinCurrent = numSamples - winLen_samp*iwin + taperLen_samp/2;
+      myNumSamplesWinCurrent = numSamples - winLen_samp*iwin + taperLen_samp/2;
     }
+    myCurrentWin = iwin;
 
-    // select data
-    for( int itrc = 0; itrc < numTraces; itrc++ ) {
-      if( iwin > 0 ) {
-        memcpy( tidataw, &samplesIn[itrc][iwin*winLen_samp - taperLen_samp/2], numSamplesWinCurrent*sizeof(float) );
-      }
-      else {
-        memcpy( tidataw, &samplesIn[itrc][0], numSamplesWinCurrent*sizeof(float) );
-      }
-      if( numSamples > numSamplesWinCurrent ) {
-        memset( &tidataw[numSamplesWinCurrent], 0, (numSamples-numSamplesWinCurrent)*sizeof(float) );
-      }
-      bool success = myFFT->fft_forward( tidataw );
-      if( !success ) {
-        throw( cseis_geolib::csException("csFXDecon::apply(): FFT forward transform failed for unknown reasons") );
+    runStage( STAGE_FORWARD, numPairs );
+    runStage( STAGE_FILTER, numFreqFilter );
+    runStage( STAGE_INVERSE, numPairs );
+  } // END for iwin
+}
+//--------------------------------------------------------------------------------
+// Forward FFT of current time window, two traces per complex FFT
+//
+void csFXDecon::forwardTraces( int firstPair, int lastPair, csFXDeconTask* task ) {
+  double* bufReal = task->bufferReal;
+  double* bufImag = task->bufferImag;
+  int firstSample = ( myCurrentWin > 0 ) ? myCurrentWin*winLen_samp - taperLen_samp/2 : 0;
+  for( int ipair = firstPair; ipair <= lastPair; ipair++ ) {
+    int itrc1 = 2*ipair;
+    int itrc2 = itrc1 + 1;
+    float const* samples1 = &mySamplesIn[itrc1][firstSample];
+    for( int isamp = 0; isamp < myNumSamplesWinCurrent; isamp++ ) {
+      bufReal[isamp] = samples1[isamp];
+    }
+    if( itrc2 < myNumTraces ) {
+      float const* samples2 = &mySamplesIn[itrc2][firstSample];
+      for( int isamp = 0; isamp < myNumSamplesWinCurrent; isamp++ ) {
+        bufImag[isamp] = samples2[isamp];
       }
+    }
+    else {
+      memset( bufImag, 0, myNumSamplesWinCurrent*sizeof(double) );
+    }
+    memset( &bufReal[myNumSamplesWinCurrent], 0, (myNumSamplesFFT-myNumSamplesWinCurrent)*sizeof(double) );
+    memset( &bufImag[myNumSamplesWinCurrent], 0, (myNumSamplesFFT-myNumSamplesWinCurrent)*sizeof(double) );
 
-      // Store values
-      double const* realPtr = myFFT->realData();
-      double const* imagPtr = myFFT->imagData();
-      for( int ifq = 0; ifq < myNumFreq; ifq++ ) {
-        fdata[itrc][ifq] = std::complex<float>( (float)realPtr[ifq] ,(float)imagPtr[ifq] );
-        //  float amp = sqrt( fdata[itrc][ifq].real()*fdata[itrc][ifq].real() + fdata[itrc][ifq].imag()*fdata[itrc][ifq].imag() );
-        //  float phase = atan2( -fdata[itrc][ifq].imag(), fdata[itrc][ifq].real() );
-        //  fprintf(stdout,"%d %f  %f  %f  %f  %f\n",itrc,ifq*myFreqStep_hz,realPtr[ifq],imagPtr[ifq],amp,phase);
+    if( !cseis_geolib::csFFTTools::fft( cseis_geolib::csFFTTools::FORWARD, myTwoPowerFFT, bufReal, bufImag, false ) ) {
+      throw( cseis_geolib::csException("csFXDecon::apply(): FFT forward transform failed for unknown reasons") );
+    }
+    // Separate spectra of the two real traces: X1 = (Z(k) + conj(Z(N-k)))/2,  X2 = (Z(k) - conj(Z(N-k)))/2i
+    for( int ifq = myFirstFreq; ifq <= myLastFreq; ifq++ ) {
+      int ifqNeg = ( myNumSamplesFFT - ifq ) % myNumSamplesFFT;
+      double sumReal  = bufReal[ifq] + bufReal[ifqNeg];
+      double sumImag  = bufImag[ifq] - bufImag[ifqNeg];
+      double diffReal = bufReal[ifq] - bufReal[ifqNeg];
+      double diffImag = bufImag[ifq] + bufImag[ifqNeg];
+      complex<float>* spec = &mySpec[(size_t)ifq*(size_t)myMaxNumTraces];
+      spec[itrc1] = complex<float>( (float)(0.5*sumReal), (float)(0.5*sumImag) );
+      if( itrc2 < myNumTraces ) {
+        spec[itrc2] = complex<float>( (float)(0.5*diffImag), (float)(-0.5*diffReal) );
       }
-    } // END for itrc
+    }
+  }
+}
+//--------------------------------------------------------------------------------
+// Input trace index of trace itrc in spatial window jx, including the filter traces at both sides
+//
+int csFXDecon::inputTraceIndex( int jx, int itrc, int ntrwu ) const {
+  int index;
+  if( jx > 0 && jx < myNumWinSpatial-1 ) {
+    index = itrc + jx*ntraces_design - ntraces_filter;
+  }
+  else if( jx == 0 ) {
+    if( itrc >= ntraces_filter && itrc < ntraces_design+ntraces_filter ) {
+      index = itrc - ntraces_filter;
+    }
+    else if( itrc < ntraces_filter ) {
+      index = 0;
+    }
+    else if( myNumWinSpatial > 1 ) {
+      index = itrc - ntraces_filter;
+    }
+    else {
+      index = myNumTraces-1;
+    }
+  }
+  else {
+    if( itrc < ntrwu+ntraces_filter ) {
+      index = itrc + jx*ntraces_design - ntraces_filter;
+    }
+    else {
+      index = myNumTraces-1;
+    }
+  }
+  if( index >= myNumTraces ) index = myNumTraces-1;
+  return index;
+}
+//--------------------------------------------------------------------------------
+// Compute and apply prediction filters for all spatial windows, for frequencies firstFreq to lastFreq
+// (counted from the first filtered frequency)
+//
+void csFXDecon::filterFrequencies( int firstFreq, int lastFreq, csFXDeconTask* task ) {
+  complex<float>* sfreq    = task->sfreq;
+  complex<float>* autocorr = task->autocorr;
+  complex<float>* fvector  = task->fvector;
+  complex<float>* sfreqout = task->sfreqout;
+  float** rmatrix = task->rmatrix;
+  float* gvector  = task->gvector;
+
+  for( int ifq = myFirstFreq+firstFreq; ifq <= myFirstFreq+lastFreq; ifq++ ) {
+    complex<float> const* spec = &mySpec[(size_t)ifq*(size_t)myMaxNumTraces];
+    complex<float>* filtSpec   = &myFiltSpec[(size_t)ifq*(size_t)myMaxNumTraces];
 
-    //----------------------------------------------------------------------
     // Loop over space windows
-
-    int ntrwu = 0;
-    for( int jx = 0; jx < numWinSpatial; jx++ ) {
-
+    for( int jx = 0; jx < myNumWinSpatial; jx++ ) {
       // to take care of a possible incomplete last window
-      if( numTraces < jx*ntraces_design+2*ntraces_design ) {
-        ntrwu = numTraces - jx*ntraces_design;
-      }
-      else {
-        ntrwu = ntraces_design;
+      int ntrwu = ntraces_design;
+      if( myNumTraces < jx*ntraces_design+2*ntraces_design ) {
+        ntrwu = myNumTraces - jx*ntraces_design;
       }
-
-      // Select data
       for( int itrc = 0; itrc < ntrwu+2*ntraces_filter; itrc++ ) {
-        for( int ifq = 0; ifq < myNumFreq; ifq++) {
-          if( jx > 0 && jx < numWinSpatial-1 ) {
-            fdataw[itrc][ifq] = fdata[itrc + jx*ntraces_design - ntraces_filter][ifq];
-          }
-          else if (jx==0) {
-            if( itrc >= ntraces_filter && itrc < ntraces_design+ntraces_filter ) {
-              fdataw[itrc][ifq] = fdata[itrc - ntraces_filter][ifq];
-            }
-            else if( itrc < ntraces_filter ) {
-              fdataw[itrc][ifq] = fdata[0][ifq];
-            }
-            else {
-              if( numWinSpatial > 1 ) {
-                fdataw[itrc][ifq] = fdata[itrc - ntraces_filter][ifq];
-              }
-              else {
-                fdataw[itrc][ifq] = fdata[numTraces-1][ifq];
-              }
-            }
-          }
-          else {
-            if( itrc < ntrwu+ntraces_filter ) {
-              fdataw[itrc][ifq] = fdata[itrc + jx*ntraces_design - ntraces_filter][ifq];
-            }
-            else {
-              fdataw[itrc][ifq] = fdata[numTraces-1][ifq];
-            }
-          }
-	} // for ifq
-      } // for itrc
-
-
-      // loop over frequencies
-      for( int ifq = 0; ifq < myNumFreq; ifq++ ) {
-        float freqCurrent = (float)ifq*myFreqStep_hz;
-        if( freqCurrent >= fmin && freqCurrent <= fmax ) {
-          
-          // sfreq   = new complex<float>[2*ntraces_design+2*ntraces_filter];
-
-          // Loop over space window
-          for( int itrc = 0; itrc < ntrwu+2*ntraces_filter; itrc++ ) {
-            sfreq[itrc]   = fdataw[itrc][ifq];
-            //            fprintf(stdout,"%d %d  %f %d %f\n", iwin, jx, ifq*myFreqStep_hz, itrc, sfreq[itrc].real() );
-          }
-          
-          // complex autocorrelation
-          cxcor( ntrwu, 0, sfreq,   ntrwu, 0, sfreq,   ntraces_filter+1, 0, autocorr );
-          
-          // taking real and imaginary parts
-          for( int itrc = 0; itrc < ntraces_filter+1; itrc++ ) {
-            rautoc[itrc] = autocorr[itrc].real();
-            iautoc[itrc] = autocorr[itrc].imag();
-            //            fprintf(stdout,"%f %d %f %f\n", ifq*myFreqStep_hz, itrc, rautoc[itrc], iautoc[itrc]);
-          }
-
-          // zeroing files
-          memset( (void*)gvector, 0, 2*ntraces_filter*sizeof(float) );
-          for( int itrc = 0; itrc < 2*ntraces_filter+1; itrc++ ) {
-            fvector[itrc] = std::complex<float>(0,0);
-          }
-          for( int itrc = 0; itrc < 2*ntraces_filter; itrc++ ) {
-            memset( (void*)rmatrix[itrc], 0, 2*ntraces_filter*sizeof(float) );
-          }
-
-          // matrix problem
-          for( int itrc = 0; itrc < ntraces_filter; itrc++ ) {
-            for( int jtrc = 0; jtrc < ntraces_filter; jtrc++ ) { 
-              if( itrc >= jtrc ) rmatrix[itrc][jtrc] = autocorr[itrc-jtrc].real();
-              else        rmatrix[itrc][jtrc] = autocorr[jtrc-itrc].real();
-            }
-          }
-
-          for( int itrc = ntraces_filter;itrc<2*ntraces_filter;itrc++) {
-            for( int jtrc = 0;jtrc<ntraces_filter;jtrc++) {
-              if( itrc-ntraces_filter < jtrc ) rmatrix[itrc][jtrc] = -autocorr[jtrc-itrc+ntraces_filter].imag();
-              else            rmatrix[itrc][jtrc]= autocorr[itrc-jtrc-ntraces_filter].imag();
-            }
-          }
-
-          for( int itrc = ntraces_filter; itrc < 2*ntraces_filter; itrc++ ) {
-            for( int jtrc = ntraces_filter; jtrc < 2*ntraces_filter; jtrc++ )
-              rmatrix[itrc][jtrc]=rmatrix[itrc-ntraces_filter][jtrc-ntraces_filter];
-          }
-          for( int itrc = 0;itrc<ntraces_filter;itrc++) {
-            for( int jtrc = ntraces_filter; jtrc < 2*ntraces_filter; jtrc++ )
-              rmatrix[itrc][jtrc] = -rmatrix[itrc+ntraces_filter][jtrc-ntraces_filter];
-          }
-          for( int itrc = 0; itrc < 2*ntraces_filter; itrc++ ) {
-            if( itrc < ntraces_filter ) gvector[itrc] = autocorr[itrc+1].real();
-            else gvector[itrc] = autocorr[itrc-ntraces_filter+1].imag();
-          }
-
-          csFXDecon::LUDecomposition( rmatrix, 2*ntraces_filter, ipvt, info );
-          csFXDecon::LUBackSub( rmatrix, 2*ntraces_filter, ipvt, gvector );
-
-          //for( int ii = 0; ii < 2*ntraces_filter; ii++ ) {
-          //   for( int jj = 0; jj < 2*ntraces_filter; jj++ ) {
-          //     fprintf(stdout,"%d %f %d %d %d %f  %f\n", jx, ifq*myFreqStep_hz, ii, jj, ipvt[ii*2*ntraces_filter+jj], info[ii*2*ntraces_filter+jj], rmatrix[ii][jj]);
-          //   }
-          //  }
-
-          /* construct filter */
-          for( int ifv = 0, ig = ntraces_filter-1; ifv < ntraces_filter; ifv++, ig-- ) {
-            fvector[ifv] = std::conj( std::complex<float>( 0.5*gvector[ig], 0.5*gvector[ig+ntraces_filter] ) );
-          }
-
-          for( int ifv = ntraces_filter+1,ig=0 ;ifv < 2*ntraces_filter+1; ifv++,ig++ ) {
-            fvector[ifv] = std::complex<float>( 0.5*gvector[ig], 0.5*gvector[ig+ntraces_filter] );
-          }
-          for( int itrc = 0; itrc < ntrwu; itrc++ ) {
-            sfreqout[itrc] = std::complex<float>(0,0);
-          }
-
-          //for( int ifv = 0; ifv < 2*ntraces_filter+1; ifv++ ) {
-          //  fprintf(stdout,"%d %f %d  %f %f\n", jx, ifq*myFreqStep_hz, ifv, fvector[ifv].real(), fvector[ifv].imag());
-          //  }
-
-          // convolution of data with filter
-          // output is one sample ahead
-          cconv( ntrwu+2*ntraces_filter, -ntraces_filter, sfreq,
-                 2*ntraces_filter+1, -ntraces_filter, fvector,
-                 ntrwu, 0, sfreqout ); 
-
-          // store filtered values
-          for( int itrc = 0; itrc < ntrwu; itrc++ ) {
-            ffreq[itrc][ifq] = sfreqout[itrc];
-            // fprintf(stdout,"%d %d %f  %f %f\n", jx, itrc, ifq*myFreqStep_hz, ffreq[itrc][ifq].real(), ffreq[itrc][ifq].imag());
-          }
-
-        }
-      } // END for ifq frequencies loop
-
+        sfreq[itrc] = spec[ inputTraceIndex( jx, itrc, ntrwu ) ];
+      }
 
-      // Loop along space windows
-      for( int itrc = 0; itrc < ntrwu; itrc++ ) {
-    
-        for( int isamp = 0; isamp < myNumFreq; isamp++ ) {
-          bufferRealImag[isamp]      = ffreq[itrc][isamp].real();
-          bufferRealImag[isamp+myNumSamplesFFT] = ffreq[itrc][isamp].imag();
-        }
+      // complex autocorrelation
+      cxcor( ntrwu, 0, sfreq,   ntrwu, 0, sfreq,   ntraces_filter+1, 0, autocorr, task->xcorWork );
 
-        memset( &bufferRealImag[myNumFreq], 0, (myNumSamplesFFT-myNumFreq)*sizeof(float) );
-        memset( &bufferRealImag[myNumFreq+myNumSamplesFFT], 0, (myNumSamplesFFT-myNumFreq)*sizeof(float) );
+      // zeroing files
+      memset( (void*)gvector, 0, 2*ntraces_filter*sizeof(float) );
+      for( int itrc = 0; itrc < 2*ntraces_filter+1; itrc++ ) {
+        fvector[itrc] = std::complex<float>(0,0);
+      }
+      for( int itrc = 0; itrc < 2*ntraces_filter; itrc++ ) {
+        memset( (void*)rmatrix[itrc], 0, 2*ntraces_filter*sizeof(float) );
+      }
 
-        bool success = myFFT->fft_inverse( bufferRealImag, cseis_geolib::FX_REAL_IMAG );
-        if( !success ) {
-          throw( cseis_geolib::csException("csFXDecon::apply(): FFT inverse transform failed for unknown reasons") );
+      // matrix problem
+      for( int itrc = 0; itrc < ntraces_filter; itrc++ ) {
+        for( int jtrc = 0; jtrc < ntraces_filter; jtrc++ ) {
+          if( itrc >= jtrc ) rmatrix[itrc][jtrc] = autocorr[itrc-jtrc].real();
+          else        rmatrix[itrc][jtrc] = autocorr[jtrc-itrc].real();
         }
-        double const* real = myFFT->realData();
-        int minNumSamples = std::min(numSamples,myNumSamplesFFT);
-        for( int isamp = 0; isamp < minNumSamples; isamp++ ) {
-          ttodataw[isamp] = 2.0 * real[isamp];
+      }
+      for( int itrc = ntraces_filter;itrc<2*ntraces_filter;itrc++) {
+        for( int jtrc = 0;jtrc<ntraces_filter;jtrc++) {
+          if( itrc-ntraces_filter < jtrc ) rmatrix[itrc][jtrc] = -autocorr[jtrc-itrc+ntraces_filter].imag();
+          else            rmatrix[itrc][jtrc]= autocorr[itrc-jtrc-ntraces_filter].imag();
         }
+      }
+      for( int itrc = ntraces_filter; itrc < 2*ntraces_filter; itrc++ ) {
+        for( int jtrc = ntraces_filter; jtrc < 2*ntraces_filter; jtrc++ )
+          rmatrix[itrc][jtrc]=rmatrix[itrc-ntraces_filter][jtrc-ntraces_filter];
+      }
+      for( int itrc = 0;itrc<ntraces_filter;itrc++) {
+        for( int jtrc = ntraces_filter; jtrc < 2*ntraces_filter; jtrc++ )
+          rmatrix[itrc][jtrc] = -rmatrix[itrc+ntraces_filter][jtrc-ntraces_filter];
+      }
+      for( int itrc = 0; itrc < 2*ntraces_filter; itrc++ ) {
+        if( itrc < ntraces_filter ) gvector[itrc] = autocorr[itrc+1].real();
+        else gvector[itrc] = autocorr[itrc-ntraces_filter+1].imag();
+      }
 
-        if( numSamples != myNumSamplesFFT ) {
-          memset( &ttodataw[minNumSamples], 0, (std::max(numSamples,myNumSamplesFFT)-minNumSamples)*sizeof(float) );
-        }
+      float dd;
+      csFXDecon::LUDecomposition( rmatrix, 2*ntraces_filter, task->ipvt, &dd, task->luWork );
+      csFXDecon::LUBackSub( rmatrix, 2*ntraces_filter, task->ipvt, gvector );
 
-        // Loop along time
-        if( numWin > 1 ) {
-          // first portion of time window
-          if( iwin > 0 ) {
-            for( int isamp = 0; isamp < taperLen_samp; isamp++ ) {
-              samplesOut[jx*ntraces_design+itrc][isamp+iwin*winLen_samp-taperLen_samp/2] +=
-                ttodataw[isamp] * ( (float)isamp * mySampleInt_s / taperLen_s );
-            }
-          }
-          else {
-            for( int isamp = 0; isamp < taperLen_samp; isamp++ ) {
-              samplesOut[jx*ntraces_design+itrc][isamp] = ttodataw[isamp];
-            }
-          }
-          // intermediate portion of time window
-          if( iwin > 0 ) {
-            for( int isamp = taperLen_samp; isamp < numSamplesWinCurrent - taperLen_samp; isamp++ )
-              samplesOut[jx*ntraces_design+itrc][isamp+iwin*winLen_samp-taperLen_samp/2] = ttodataw[isamp];
-          }
-          else {
-            for( int isamp = taperLen_samp; isamp < numSamplesWinCurrent-taperLen_samp; isamp++ )
-              samplesOut[jx*ntraces_design+itrc][isamp] = ttodataw[isamp];
-          }
-          // last portion of time window
-          if( iwin > 0 && iwin < numWin-1 ) {
-            for( int isamp = numSamplesWinCurrent-taperLen_samp; isamp < numSamplesWinCurrent; isamp++ )
-              samplesOut[jx*ntraces_design+itrc][isamp+iwin*winLen_samp-taperLen_samp/2] +=
-                ttodataw[isamp] * (1.0-((float)(isamp-numSamplesWinCurrent+taperLen_samp)) * mySampleInt_s / taperLen_s );
-          }
-          else if( iwin == numWin-1 ) {
-            for( int isamp = numSamplesWinCurrent-taperLen_samp; isamp < numSamplesWinCurrent; isamp++ )
-              samplesOut[jx*ntraces_design+itrc][isamp+iwin*winLen_samp-taperLen_samp/2] = ttodataw[isamp];
-          }
-          else {
-            for( int isamp = numSamplesWinCurrent - taperLen_samp; isamp < numSamplesWinCurrent; isamp++ ) {
-              samplesOut[jx*ntraces_design+itrc][isamp] += ttodataw[isamp] * ( 1.0 - ( (float)(isamp-numSamplesWinCurrent+taperLen_samp) ) * mySampleInt_s / taperLen_s );
-            }
-          }
-        } // END if numWin > 1
-        else {
-          for( int isamp = 0; isamp < numSamples; isamp++ ) {
-            samplesOut[jx*ntraces_design+itrc][isamp]=ttodataw[isamp];
-          }
-        }
+      /* construct filter */
+      for( int ifv = 0, ig = ntraces_filter-1; ifv < ntraces_filter; ifv++, ig-- ) {
+        fvector[ifv] = std::conj( std::complex<float>( 0.5*gvector[ig], 0.5*gvector[ig+ntraces_filter] ) );
+      }
+      for( int ifv = ntraces_filter+1,ig=0 ;ifv < 2*ntraces_filter+1; ifv++,ig++ ) {
+        fvector[ifv] = std::complex<float>( 0.5*gvector[ig], 0.5*gvector[ig+ntraces_filter] );
+      }
 
-      } // END for itrc - space windows
+      // convolution of data with filter
+      // output is one sample ahead
+      cconv( ntrwu+2*ntraces_filter, -ntraces_filter, sfreq,
+             2*ntraces_filter+1, -ntraces_filter, fvector,
+             ntrwu, 0, sfreqout );
 
+      // store filtered values
+      for( int itrc = 0; itrc < ntrwu; itrc++ ) {
+        filtSpec[jx*ntraces_design+itrc] = sfreqout[itrc];
+      }
     } // END for jx - space windows
-  } // END for iwin
-
+  } // END for ifq frequencies loop
+}
+//--------------------------------------------------------------------------------
+// Inverse FFT of filtered one-sided spectra, two traces per complex FFT, and merge into output traces.
+// Output trace = 2 * Re( IFFT(one-sided spectrum) ) = IFFT(G), with G(k) = X(k), G(N-k) = conj(X(k)), and twice the real part at 0 and N/2
+//
+void csFXDecon::inverseTraces( int firstPair, int lastPair, csFXDeconTask* task ) {
+  double* bufReal = task->bufferReal;
+  double* bufImag = task->bufferImag;
+  int nyquist = myNumSamplesFFT/2;
+  int minNumSamples = std::min( myNumSamples, myNumSamplesFFT );
+  for( int ipair = firstPair; ipair <= lastPair; ipair++ ) {
+    int itrc1 = 2*ipair;
+    int itrc2 = itrc1 + 1;
+    bool isPair = ( itrc2 < myNumTraces );
+    memset( bufReal, 0, myNumSamplesFFT*sizeof(double) );
+    memset( bufImag, 0, myNumSamplesFFT*sizeof(double) );
+    for( int ifq = myFirstFreq; ifq <= myLastFreq; ifq++ ) {
+      complex<float> const* filtSpec = &myFiltSpec[(size_t)ifq*(size_t)myMaxNumTraces];
+      double real1 = filtSpec[itrc1].real();
+      double imag1 = filtSpec[itrc1].imag();
+      double real2 = isPair ? filtSpec[itrc2].real() : 0.0;
+      double imag2 = isPair ? filtSpec[itrc2].imag() : 0.0;
+      if( ifq == 0 || ifq == nyquist ) {
+        bufReal[ifq] = 2.0*real1;
+        bufImag[ifq] = 2.0*real2;
+      }
+      else {
+        bufReal[ifq] = real1 - imag2;
+        bufImag[ifq] = imag1 + real2;
+        bufReal[myNumSamplesFFT-ifq] = real1 + imag2;
+        bufImag[myNumSamplesFFT-ifq] = real2 - imag1;
+      }
+    }
+    if( !cseis_geolib::csFFTTools::fft( cseis_geolib::csFFTTools::INVERSE, myTwoPowerFFT, bufReal, bufImag, true ) ) {
+      throw( cseis_geolib::csException("csFXDecon::apply(): FFT inverse transform failed for unknown reasons") );
+    }
+    for( int isamp = 0; isamp < minNumSamples; isamp++ ) {
+      task->ttodataw1[isamp] = (float)bufReal[isamp];
+      task->ttodataw2[isamp] = (float)bufImag[isamp];
+    }
+    if( minNumSamples < myNumSamplesFFT ) {
+      memset( &task->ttodataw1[minNumSamples], 0, (myNumSamplesFFT-minNumSamples)*sizeof(float) );
+      memset( &task->ttodataw2[minNumSamples], 0, (myNumSamplesFFT-minNumSamples)*sizeof(float) );
+    }
+    mergeTimeWindow( task->ttodataw1, itrc1 );
+    if( isPair ) mergeTimeWindow( task->ttodataw2, itrc2 );
+  }
+}
+//--------------------------------------------------------------------------------
+// Merge filtered time window into output trace, with linear tapers in overlap zones
+//
+void csFXDecon::mergeTimeWindow( float const* ttodataw, int traceIndex ) {
+  float* samplesOut = mySamplesOut[traceIndex];
+  int iwin = myCurrentWin;
+  int numSamplesWinCurrent = myNumSamplesWinCurrent;
+  if( numWin > 1 ) {
+    // first portion of time window
+    if( iwin > 0 ) {
+      for( int isamp = 0; isamp < taperLen_samp; isamp++ ) {
+        samplesOut[isamp+iwin*winLen_samp-taperLen_samp/2] +=
+          ttodataw[isamp] * ( (float)isamp * mySampleInt_s / taperLen_s );
+      }
+    }
+    else {
+      for( int isamp = 0; isamp < taperLen_samp; isamp++ ) {
+        samplesOut[isamp] = ttodataw[isamp];
+      }
+    }
+    // intermediate portion of time window
+    if( iwin > 0 ) {
+      for( int isamp = taperLen_samp; isamp < numSamplesWinCurrent - taperLen_samp; isamp++ )
+        samplesOut[isamp+iwin*winLen_samp-taperLen_samp/2] = ttodataw[isamp];
+    }
+    else {
+      for( int isamp = taperLen_samp; isamp < numSamplesWinCurrent-taperLen_samp; isamp++ )
+        samplesOut[isamp] = ttodataw[isamp];
+    }
+    // last portion of time window
+    if( iwin > 0 && iwin < numWin-1 ) {
+      for( int isamp = numSamplesWinCurrent-taperLen_samp; isamp < numSamplesWinCurrent; isamp++ )
+        samplesOut[isamp+iwin*winLen_samp-taperLen_samp/2] +=
+          ttodataw[isamp] * (1.0-((float)(isamp-numSamplesWinCurrent+taperLen_samp)) * mySampleInt_s / taperLen_s );
+    }
+    else if( iwin == numWin-1 ) {
+      for( int isamp = numSamplesWinCurrent-taperLen_samp; isamp < numSamplesWinCurrent; isamp++ )
+        samplesOut[isamp+iwin*winLen_samp-taperLen_samp/2] = ttodataw[isamp];
+    }
+    else {
+      for( int isamp = numSamplesWinCurrent - taperLen_samp; isamp < numSamplesWinCurrent; isamp++ ) {
+        samplesOut[isamp] += ttodataw[isamp] * ( 1.0 - ( (float)(isamp-numSamplesWinCurrent+taperLen_samp) ) * mySampleInt_s / taperLen_s );
+      }
+    }
+  } // END if numWin > 1
+  else {
+    for( int isamp = 0; isamp < myNumSamples; isamp++ ) {
+      samplesOut[isamp]=ttodataw[isamp];
+    }
+  }
 }
 void csFXDecon::dump() const {
   fprintf(stderr," --- FXDecon DUMP ---\n");
@@ -470,24 +545,32 @@ void csFXDecon::dump() const {
   fprintf(stderr,"taperLen_s:     %f\n", taperLen_s);       // taper
   fprintf(stderr,"numSamplesWinF: %d\n", myNumSamplesWinF );// nspwf
   fprintf(stderr,"numSamplesWinI: %d\n", myNumSamplesWinI );// nspwi
+  fprintf(stderr,"numThreads:     %d\n", numThreads() );
 }
 
 // complex correlation
 void csFXDecon::cxcor( int num1, int index1, std::complex<float>* in1,
-                       int num2, int index2, std::complex<float>* in2, 
+                       int num2, int index2, std::complex<float>* in2,
                        int numCorr, int indexCorr, std::complex<float>* corr )
 {
   complex<float>* xr = new complex<float>[ num1 ];
+  csFXDecon::cxcor( num1, index1, in1, num2, index2, in2, numCorr, indexCorr, corr, xr );
+  delete [] xr;
+}
+void csFXDecon::cxcor( int num1, int index1, std::complex<float>* in1,
+                       int num2, int index2, std::complex<float>* in2,
+                       int numCorr, int indexCorr, std::complex<float>* corr, std::complex<float>* work )
+{
+  complex<float>* xr = work;
   for( int i = 0, j = num1-1; i < num1; ++i,--j ) {
     xr[i] = std::conj( in1[j] );
   }
   csFXDecon::cconv( num1, 1-index1-num1, xr, num2, index2, in2,  numCorr, indexCorr, corr );
-  delete [] xr;
 }
 
 // complex convolution
 void csFXDecon::cconv( int num1, int index1, std::complex<float>* in1,
-                       int num2, int index2, std::complex<float>* in2, 
+                       int num2, int index2, std::complex<float>* in2,
                        int numCorr, int indexCorr, std::complex<float>* corr )
 {
   int ilx = index1+num1-1;
@@ -509,13 +592,16 @@ void csFXDecon::cconv( int num1, int index1, std::complex<float>* in1,
 
 
 void csFXDecon::LUDecomposition( float** AA, int nIn, int* indx, float* dd )
+{
+  float* vv = new float[ nIn ];
+  csFXDecon::LUDecomposition( AA, nIn, indx, dd, vv );
+  delete [] vv;
+}
+void csFXDecon::LUDecomposition( float** AA, int nIn, int* indx, float* dd, float* vv )
 {
   float dum, sum, temp;
   int imax = 0;
 
-  float* vv = new float[ nIn ];
-  if( !vv ) fprintf(stderr,"Allocation failure in ludcmpBO\n");
-
   *dd = 1.0;
   for( int i = 0; i < nIn; i++ ) {
     float big = 0.0;
@@ -560,8 +646,6 @@ void csFXDecon::LUDecomposition( float** AA, int nIn, int* indx, float* dd )
       for( int i = j+1; i < nIn; i++ ) AA[i][j] *= dum;
     }
   }
-
-  delete [] vv;
 }
 
 void csFXDecon::LUBackSub( float** AA, int nIn, int* indx, float* bb )
@@ -4,7 +4,7 @@
 #include <complex>
 
 namespace cseis_geolib {
-  class csFFTTools;
+  class csThreadPool;
 }
 
 namespace mod_fxdecon {
@@ -18,8 +18,22 @@ struct Attr {
   int ntraces_filter;
   int numWin;
   float taperLen_s;
+  /// Number of threads. 1: Run in calling thread
+  int numThreads;
 };
 
+class csFXDeconTask;
+
+/**
+ * FX deconvolution
+ *
+ * Per time window, all traces of the ensemble are transformed to the frequency domain, two traces per complex FFT.
+ * Spectra are stored frequency by frequency, so that the prediction filters of one frequency slice are computed from
+ * contiguous memory. The three stages (forward FFT, filter, inverse FFT) are split into tasks over trace pairs or
+ * frequency ranges, which run on a thread pool if more than one thread is requested.
+ * Each task owns its work arrays, and all arrays are kept from one ensemble to the next. Spectrum arrays only grow
+ * when an ensemble with more traces than any previous ensemble is input.
+ */
 class csFXDecon {
  public:
   csFXDecon();
@@ -27,29 +41,48 @@ class csFXDecon {
   void initialize( float sampleInt_ms, int numSamplesIn, mod_fxdecon::Attr const& attr );
   void apply( float** samplesIn, float** samplesOut, int numTraces, int numSamples );
   void dump() const;
+  int numThreads() const;
 
   static void cxcor( int num1, int index1, std::complex<float> *in1,
-                     int num2, int index2, std::complex<float> *in2, 
+                     int num2, int index2, std::complex<float> *in2,
                      int numCorr, int indexCorr, std::complex<float> *corr );
+  /// Same as above, using given work array of num1 values
+  static void cxcor( int num1, int index1, std::complex<float> *in1,
+                     int num2, int index2, std::complex<float> *in2,
+                     int numCorr, int indexCorr, std::complex<float> *corr, std::complex<float>* work );
   static void cconv( int num1, int index1, std::complex<float>* in1,
-                     int num2, int index2, std::complex<float>* in2, 
+                     int num2, int index2, std::complex<float>* in2,
                      int numCorr, int indexCorr, std::complex<float>* corr );
   static void LUDecomposition( float** AA, int nIn, int* indx, float* dd );
+  /// Same as above, using given work array of nIn values
+  static void LUDecomposition( float** AA, int nIn, int* indx, float* dd, float* work );
   static void LUBackSub( float** AA, int nIn, int* indx, float* bb );
 
  private:
-  void initialize_internal( int numTraces, int numSamples );
-  void freeMem( int numTraces );
+  friend class csFXDeconTask;
+  static int const STAGE_FORWARD = 1;
+  static int const STAGE_FILTER  = 2;
+  static int const STAGE_INVERSE = 3;
+
+  void allocateSpectra( int numTraces );
+  void runStage( int stage, int numItems );
+  void forwardTraces( int firstPair, int lastPair, csFXDeconTask* task );
+  void filterFrequencies( int firstFreq, int lastFreq, csFXDeconTask* task );
+  void inverseTraces( int firstPair, int lastPair, csFXDeconTask* task );
+  void mergeTimeWindow( float const* ttodataw, int traceIndex );
+  int inputTraceIndex( int jx, int itrc, int ntrwu ) const;
 
  private:
-  cseis_geolib::csFFTTools* myFFT;
   int myNumSamplesFFT;
+  int myTwoPowerFFT;
   int myNumFreq;
   float myFreqStep_hz;
   float mySampleInt_s;
   int myNumSamplesWinF;
   int myNumSamplesWinI;
-  int myNumTraces;
+  /// First and last frequency index within fmin-fmax. myLastFreq < myFirstFreq if no frequency is filtered
+  int myFirstFreq;
+  int myLastFreq;
 
   float fmin;
   float fmax;
@@ -60,29 +93,23 @@ class csFXDecon {
   int numWin;
   float taperLen_s;
 
-  int ntraces_fdataw;
+  /// Input and filtered spectra, frequency by frequency: [ifreq*myMaxNumTraces + itrc]
+  std::complex<float>* mySpec;
+  std::complex<float>* myFiltSpec;
+  int myMaxNumTraces;
 
- private:
-  std::complex<float>** fdata;
-  std::complex<float>** fdataw;
-  std::complex<float>** ffreq;
-  float** rmatrix;
-
-  std::complex<float>* fvector;
-  std::complex<float>*  sfreq;
-  std::complex<float>* autocorr;
-  float* rautoc;
-  float* iautoc;
-  float* gvector;
-
-  float* info;
-  int* ipvt;
-  float* bufferRealImag;
-
-  std::complex<float>* sfreqout;
-  float* tidataw;
-  float* ttodataw;
+  cseis_geolib::csThreadPool* myThreadPool;
+  csFXDeconTask** myTasks;
+  int myNumTasks;
 
+  /// Current ensemble & time window
+  float** mySamplesIn;
+  float** mySamplesOut;
+  int myNumTraces;
+  int myNumSamples;
+  int myNumWinSpatial;
+  int myCurrentWin;
+  int myNumSamplesWinCurrent;
 };
 
 } // end namespace
@@ -4,6 +4,7 @@
 #include <cstring>
 #include "cseis_includes.h"
 #include "csFXDecon.h"
+#include "csThreadPool.h"
 
 using namespace cseis_system;
 using namespace cseis_geolib;
@@ -52,6 +53,7 @@ void init_mod_fxdecon_( csParamManager* param, csInitPhaseEnv* env, csLogWriter*
   attr.numWin         = 0;
   attr.ntraces_design = 0;
   attr.ntraces_filter = 0;
+  attr.numThreads     = 1;
 
   if( param->exists( "freq_range" ) ) {
     param->getFloat( "freq_range", &attr.fmin, 0 );
@@ -78,11 +80,25 @@ void init_mod_fxdecon_( csParamManager* param, csInitPhaseEnv* env, csLogWriter*
     param->getInt( "win_traces", &attr.ntraces_filter, 1 );
   }
 
+  if( param->exists( "nthreads" ) ) {
+    param->getInt( "nthreads", &attr.numThreads );
+    if( attr.numThreads < 0 ) log->error("Number of threads must be >= 0. Specified: %d", attr.numThreads );
+    if( attr.numThreads == 0 ) attr.numThreads = csThreadPool::numProcessors();
+  }
+
   vars->fxdecon = new mod_fxdecon::csFXDecon();
   attr.taperLen_s = attr.taperLen_samp * shdr->sampleInt / 1000.0;
   if( attr.numWin == 0 ) attr.taperLen_s = 0;
 
-  vars->fxdecon->initialize( shdr->sampleInt, shdr->numSamples, attr );
+  try {
+    vars->fxdecon->initialize( shdr->sampleInt, shdr->numSamples, attr );
+  }
+  catch( csException& e ) {
+    log->error("Error when starting FX deconvolution threads.\nSystem message: %s", e.getMessage() );
+  }
+  if( vars->fxdecon->numThreads() > 1 ) {
+    log->line("Apply FX deconvolution using %d threads", vars->fxdecon->numThreads() );
+  }
 
   if( edef->isDebug() ) {
     vars->fxdecon->dump();
@@ -162,6 +178,9 @@ void params_mod_fxdecon_( csParamDef* pdef ) {
 
   pdef->addParam( "taper_len", "Taper length [ms]", NUM_VALUES_FIXED );
   pdef->addValue( "100", VALTYPE_NUMBER );
+
+  pdef->addParam( "nthreads", "Number of threads", NUM_VALUES_FIXED, "Frequencies and traces of each ensemble are split among threads. Output does not depend on the number of threads" );
+  pdef->addValue( "1", VALTYPE_NUMBER, "Number of threads. 0: Use number of processors" );
 }
 
 extern "C" void _params_mod_fxdecon_( csParamDef* pdef ) {
@@ -339,7 +339,7 @@ bool exec_mod_gain_(
           }
         }
       }
-      memcpy( vars->keyValueBuffer, keyValueBuffer, vars->table->numKeys() );
+      memcpy( vars->keyValueBuffer, keyValueBuffer, vars->table->numKeys()*sizeof(double) );
       if( !vars->isVelSet ) velTimeFunc = vars->table->getFunction( keyValueBuffer, false );
       delete [] keyValueBuffer;
     }
@@ -332,15 +332,7 @@ void exec_mod_hdr_math_ens_(
     nTracesSelected = nTracesIn;
   }
   else {
-    for( int itrc = 0; itrc < nTracesIn; itrc++) {
-      if( vars->selectionManager->contains( traceGather->trace(itrc)->getTraceHeader() ) ) {
-        isSelected[itrc] = true;
-        nTracesSelected += 1;
-      }
-      else {
-        isSelected[itrc] = false;
-      }
-    }
+    nTracesSelected = vars->selectionManager->contains( traceGather, isSelected );
   }
   double* values  = NULL;
   double* values2 = NULL;
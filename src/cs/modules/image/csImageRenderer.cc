@@ -0,0 +1,657 @@
+/* Copyright (c) Colorado School of Mines, 2013.*/
+/* All rights reserved.                       */
+
+#include "csImageRenderer.h"
+#include "csThreadPool.h"
+#include "csPNGWriter.h"
+#include "csException.h"
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+
+using namespace mod_image;
+
+namespace mod_image {
+/**
+ * Renders one tile of image rows
+ */
+class csImageRendererTask : public cseis_geolib::csRunnable {
+ public:
+  csImageRendererTask( csImageRenderer* renderer, int rowStart, int rowEnd ) :
+    myRenderer( renderer ), myRowStart( rowStart ), myRowEnd( rowEnd ) {}
+  void run() {
+    myRenderer->renderRows( myRowStart, myRowEnd );
+  }
+ private:
+  csImageRenderer* myRenderer;
+  int myRowStart;
+  int myRowEnd;
+};
+}
+
+namespace {
+  /// Colour map knee point: Colour and relative position in colour map. Negative weight: Evenly spaced knee points
+  struct ColorKnee {
+    unsigned char r;
+    unsigned char g;
+    unsigned char b;
+    float weight;
+  };
+  struct ColorMapDef {
+    char const* name;
+    int firstKnee;
+    int numKnees;
+  };
+  // Same colour maps as csColorMap in Java library
+  ColorKnee const COLOR_KNEES[] = {
+    // default (0)
+    {0,255,255,0.0f}, {0,0,0,0.05f}, {255,255,255,0.5f}, {255,0,0,0.95f}, {255,255,0,1.0f},
+    // gray_w2b (5)
+    {255,255,255,-1}, {0,0,0,-1},
+    // gray_b2w (7)
+    {0,0,0,-1}, {255,255,255,-1},
+    // blue_white_red (9)
+    {0,0,255,-1}, {255,255,255,-1}, {255,0,0,-1},
+    // rainbow (12)
+    {0,0,255,-1}, {0,255,255,-1}, {0,255,0,-1}, {255,255,0,-1}, {255,0,0,-1}, {255,0,255,-1},
+    // black_white_orange (18)
+    {0,0,0,-1}, {255,255,255,-1}, {255,130,0,-1},
+    // gray_bwb (21)
+    {0,0,0,-1}, {255,255,255,-1}, {0,0,0,-1},
+    // gray_wbw (24)
+    {255,255,255,-1}, {0,0,0,-1}, {255,255,255,-1},
+    // rainbow_black (27)
+    {0,0,0,-1}, {0,0,255,-1}, {0,255,255,-1}, {0,255,0,-1}, {255,255,0,-1}, {255,0,0,-1}, {255,0,255,-1},
+    // rainbow_2 (34)
+    {0,0,255,-1}, {0,255,0,-1}, {255,255,0,-1}, {255,0,0,-1}, {255,0,255,-1}, {0,0,0,-1},
+    // rainbow_mirror (40)
+    {255,0,255,-1}, {255,0,0,-1}, {255,255,0,-1}, {0,255,0,-1}, {0,255,255,-1}, {0,0,255,-1},
+    {0,255,255,-1}, {0,255,0,-1}, {255,255,0,-1}, {255,0,0,-1}, {255,0,255,-1},
+    // cold_warm (51)
+    {0,0,0,0.0f}, {0,0,255,0.24f}, {255,255,255,0.48f}, {255,255,0,0.76f}, {255,0,0,0.90f}, {255,0,255,1.0f},
+    // blue_white_red2 (57)
+    {0,0,144,0.0f}, {5,5,154,0.1f}, {10,10,164,0.2f}, {16,16,174,0.3f}, {120,120,184,0.35f}, {165,165,216,0.4f},
+    {215,215,245,0.45f}, {255,255,255,0.5f}, {255,215,215,0.55f}, {246,165,165,0.6f}, {224,120,120,0.65f},
+    {214,16,16,0.7f}, {204,10,10,0.8f}, {194,5,5,0.9f}, {184,0,0,1.0f},
+    // black_white_red (72)
+    {0,0,0,0.0f}, {64,64,64,0.4f}, {255,255,255,0.5f}, {255,255,0,0.55f}, {224,30,30,0.6f}, {204,10,10,1.0f},
+    // brown (78)
+    {255,255,0,-1}, {238,224,3,-1}, {220,193,6,-1}, {203,162,9,-1}, {185,131,13,-1}, {168,100,16,-1}, {150,69,19,-1},
+    {155,76,28,-1}, {159,84,38,-1}, {163,91,47,-1}, {167,98,56,-1}, {171,106,66,-1}, {175,113,75,-1}, {179,121,84,-1},
+    {184,128,94,-1}, {188,135,103,-1}, {192,143,112,-1}, {196,150,122,-1}, {200,157,131,-1}, {204,165,140,-1},
+    {208,172,150,-1}, {213,179,159,-1}, {217,187,169,-1}, {221,194,178,-1}, {225,202,187,-1}, {229,209,197,-1},
+    {233,216,206,-1}, {237,224,215,-1}, {242,231,225,-1}, {246,238,234,-1}, {250,246,243,-1}, {254,253,253,-1},
+    {247,247,247,-1}, {237,237,237,-1}, {226,226,226,-1}, {216,216,216,-1}, {206,206,206,-1}, {195,195,195,-1},
+    {185,185,185,-1}, {174,174,174,-1}, {164,164,164,-1}, {153,153,153,-1}, {143,143,143,-1}, {133,133,133,-1},
+    {122,122,122,-1}, {112,112,112,-1}, {101,101,101,-1}, {91,91,91,-1}, {81,81,81,-1}, {70,70,70,-1},
+    {60,60,60,-1}, {49,49,49,-1}, {39,39,39,-1}, {29,29,29,-1}, {18,18,18,-1}, {8,8,8,-1},
+    {0,4,10,-1}, {0,21,49,-1}, {0,38,88,-1}, {0,55,127,-1}, {0,72,167,-1}, {0,89,206,-1}, {0,107,245,-1}, {0,111,255,-1}
+  };
+  ColorMapDef const COLOR_MAPS[] = {
+    { "default", 0, 5 },
+    { "gray_w2b", 5, 2 },
+    { "gray_b2w", 7, 2 },
+    { "blue_white_red", 9, 3 },
+    { "rainbow", 12, 6 },
+    { "black_white_orange", 18, 3 },
+    { "gray_bwb", 21, 3 },
+    { "gray_wbw", 24, 3 },
+    { "rainbow_black", 27, 7 },
+    { "rainbow_2", 34, 6 },
+    { "rainbow_mirror", 40, 11 },
+    { "cold_warm", 51, 6 },
+    { "blue_white_red2", 57, 15 },
+    { "black_white_red", 72, 6 },
+    { "brown", 78, 64 }
+  };
+  int const NUM_COLOR_MAPS = (int)( sizeof(COLOR_MAPS) / sizeof(ColorMapDef) );
+
+  // 5x7 pixel font. One byte per glyph row, bit 4 is the leftmost pixel
+  char const FONT_CHARS[] = " 0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ-.:/()_+,=";
+  unsigned char const FONT_GLYPHS[][7] = {
+    {0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+    {0x0E,0x11,0x13,0x15,0x19,0x11,0x0E}, {0x04,0x0C,0x04,0x04,0x04,0x04,0x0E}, {0x0E,0x11,0x01,0x02,0x04,0x08,0x1F},
+    {0x1F,0x02,0x04,0x02,0x01,0x11,0x0E}, {0x02,0x06,0x0A,0x12,0x1F,0x02,0x02}, {0x1F,0x10,0x1E,0x01,0x01,0x11,0x0E},
+    {0x06,0x08,0x10,0x1E,0x11,0x11,0x0E}, {0x1F,0x01,0x02,0x04,0x08,0x08,0x08}, {0x0E,0x11,0x11,0x0E,0x11,0x11,0x0E},
+    {0x0E,0x11,0x11,0x0F,0x01,0x02,0x0C},
+    {0x0E,0x11,0x11,0x11,0x1F,0x11,0x11}, {0x1E,0x11,0x11,0x1E,0x11,0x11,0x1E}, {0x0E,0x11,0x10,0x10,0x10,0x11,0x0E},
+    {0x1C,0x12,0x11,0x11,0x11,0x12,0x1C}, {0x1F,0x10,0x10,0x1E,0x10,0x10,0x1F}, {0x1F,0x10,0x10,0x1E,0x10,0x10,0x10},
+    {0x0E,0x11,0x10,0x17,0x11,0x11,0x0F}, {0x11,0x11,0x11,0x1F,0x11,0x11,0x11}, {0x0E,0x04,0x04,0x04,0x04,0x04,0x0E},
+    {0x07,0x02,0x02,0x02,0x02,0x12,0x0C}, {0x11,0x12,0x14,0x18,0x14,0x12,0x11}, {0x10,0x10,0x10,0x10,0x10,0x10,0x1F},
+    {0x11,0x1B,0x15,0x15,0x11,0x11,0x11}, {0x11,0x11,0x19,0x15,0x13,0x11,0x11}, {0x0E,0x11,0x11,0x11,0x11,0x11,0x0E},
+    {0x1E,0x11,0x11,0x1E,0x10,0x10,0x10}, {0x0E,0x11,0x11,0x11,0x15,0x12,0x0D}, {0x1E,0x11,0x11,0x1E,0x14,0x12,0x11},
+    {0x0F,0x10,0x10,0x0E,0x01,0x01,0x1E}, {0x1F,0x04,0x04,0x04,0x04,0x04,0x04}, {0x11,0x11,0x11,0x11,0x11,0x11,0x0E},
+    {0x11,0x11,0x11,0x11,0x11,0x0A,0x04}, {0x11,0x11,0x11,0x15,0x15,0x15,0x0A}, {0x11,0x11,0x0A,0x04,0x0A,0x11,0x11},
+    {0x11,0x11,0x11,0x0A,0x04,0x04,0x04}, {0x1F,0x01,0x02,0x04,0x08,0x10,0x1F},
+    {0x00,0x00,0x00,0x1F,0x00,0x00,0x00}, {0x00,0x00,0x00,0x00,0x00,0x0C,0x0C}, {0x00,0x0C,0x0C,0x00,0x0C,0x0C,0x00},
+    {0x00,0x01,0x02,0x04,0x08,0x10,0x00}, {0x02,0x04,0x08,0x08,0x08,0x04,0x02}, {0x08,0x04,0x02,0x02,0x02,0x04,0x08},
+    {0x00,0x00,0x00,0x00,0x00,0x00,0x1F}, {0x00,0x04,0x04,0x1F,0x04,0x04,0x00}, {0x00,0x00,0x00,0x00,0x0C,0x04,0x08},
+    {0x00,0x00,0x1F,0x00,0x1F,0x00,0x00}
+  };
+  unsigned char const COLOR_BLACK[3]      = { 0, 0, 0 };
+  unsigned char const COLOR_WHITE[3]      = { 255, 255, 255 };
+  unsigned char const COLOR_LIGHT_GRAY[3] = { 192, 192, 192 };
+  unsigned char const COLOR_MINOR_LINE[3] = { 210, 210, 210 };
+  unsigned char const COLOR_MAJOR_LINE[3] = { 140, 140, 140 };
+  unsigned char const COLOR_ZERO_LINE[3]  = { 100, 100, 100 };
+
+  unsigned char const* glyph( char c ) {
+    if( c >= 'a' && c <= 'z' ) c = c - 'a' + 'A';
+    char const* pos = strchr( FONT_CHARS, c );
+    if( pos == NULL || c == '\0' ) return FONT_GLYPHS[0];
+    return FONT_GLYPHS[pos - FONT_CHARS];
+  }
+  /// @return Smallest 'nice' number (1, 2 or 5 times a power of 10) which is larger or equal to value
+  double niceNumber( double value, double* mantissa ) {
+    double powerOf10 = pow( 10.0, floor( log10( value ) ) );
+    double reduced = value / powerOf10;
+    if( reduced <= 1.0 + 1e-9 )      *mantissa = 1.0;
+    else if( reduced <= 2.0 + 1e-9 ) *mantissa = 2.0;
+    else if( reduced <= 5.0 + 1e-9 ) *mantissa = 5.0;
+    else                             *mantissa = 10.0;
+    return( *mantissa * powerOf10 );
+  }
+  std::string formatValue( double value, int numDecimals ) {
+    char text[64];
+    sprintf( text, "%.*f", numDecimals, value );
+    return std::string( text );
+  }
+  std::string formatHeaderValue( double value ) {
+    char text[64];
+    if( value == floor( value ) && fabs( value ) < 1e15 ) sprintf( text, "%.0f", value );
+    else sprintf( text, "%g", value );
+    return std::string( text );
+  }
+}
+
+//--------------------------------------------------------------------
+RenderAttr::RenderAttr() {
+  width    = 600;
+  height   = 800;
+  fontSize = 0;
+  title    = "";
+  minTime  = 0;
+  maxTime  = 0;
+  scaleType  = SCALE_TYPE_SCALAR;
+  dispScalar = 1.0f;
+  minValue   = 0.0f;
+  maxValue   = 0.0f;
+  polarity   = POLARITY_NORMAL;
+  doTraceClipping = true;
+  traceClip       = 2.0f;
+  showWiggle      = true;
+  isPosFill       = true;
+  isNegFill       = false;
+  isVariableColor = false;
+  isVIDisplay     = false;
+  viType          = VA_TYPE_DISCRETE;
+  showZeroLines   = false;
+  showTimeLines   = true;
+  isTimeLinesAuto = true;
+  timeLineMajorInc = 500;
+  timeLineMinorInc = 100;
+  viColorMap     = 0;
+  wiggleColorMap = 1;
+  showTraceAnnotation = false;
+  numThreads = 0;
+}
+
+//--------------------------------------------------------------------
+csImageRenderer::csImageRenderer( RenderAttr const& attr, int numSamples, float sampleInt ) {
+  myAttr = attr;
+  myNumSamples = numSamples;
+  mySampleInt  = sampleInt;
+  myNumTraces  = 0;
+  myNumTracesAlloc = 0;
+  myTraceData   = NULL;
+  myAnnotation  = NULL;
+  myTraceScalar = NULL;
+  myCentreValue = 0.0f;
+  myPixels = NULL;
+
+  myPlotLeft   = 0;
+  myPlotTop    = 0;
+  myPlotWidth  = 1;
+  myPlotHeight = 1;
+  myFontScale  = 1;
+  myTraceSpacing = 1.0f;
+  myMinTime  = 0.0f;
+  myMaxTime  = 0.0f;
+  myMajorInc = 0.0f;
+  myMinorInc = 0.0f;
+  myAnnotationStep = 1;
+
+  setColorTable( myAttr.viColorMap, myVIColors );
+  setColorTable( myAttr.wiggleColorMap, myWiggleColors );
+}
+csImageRenderer::~csImageRenderer() {
+  if( myTraceData != NULL ) {
+    delete [] myTraceData;
+    myTraceData = NULL;
+  }
+  if( myAnnotation != NULL ) {
+    delete [] myAnnotation;
+    myAnnotation = NULL;
+  }
+  if( myTraceScalar != NULL ) {
+    delete [] myTraceScalar;
+    myTraceScalar = NULL;
+  }
+  if( myPixels != NULL ) {
+    delete [] myPixels;
+    myPixels = NULL;
+  }
+}
+//--------------------------------------------------------------------
+int csImageRenderer::colorMapIndex( std::string const& name ) {
+  for( int imap = 0; imap < NUM_COLOR_MAPS; imap++ ) {
+    if( !name.compare( COLOR_MAPS[imap].name ) ) return imap;
+  }
+  return -1;
+}
+void csImageRenderer::setColorTable( int colorMapIndex, unsigned char* table ) const {
+  if( colorMapIndex < 0 || colorMapIndex >= NUM_COLOR_MAPS ) colorMapIndex = 0;
+  ColorKnee const* knees = &COLOR_KNEES[COLOR_MAPS[colorMapIndex].firstKnee];
+  int numKnees = COLOR_MAPS[colorMapIndex].numKnees;
+  int iknee = 0;
+  for( int icol = 0; icol < NUM_COLORS; icol++ ) {
+    float weight = (float)icol / (float)(NUM_COLORS-1);
+    float weightNext = 0.0f;
+    while( iknee < numKnees-2 ) {
+      weightNext = knees[iknee+1].weight >= 0.0f ? knees[iknee+1].weight : (float)(iknee+1) / (float)(numKnees-1);
+      if( weight <= weightNext ) break;
+      iknee += 1;
+    }
+    float weight1 = knees[iknee].weight >= 0.0f ? knees[iknee].weight : (float)iknee / (float)(numKnees-1);
+    float weight2 = knees[iknee+1].weight >= 0.0f ? knees[iknee+1].weight : (float)(iknee+1) / (float)(numKnees-1);
+    float w = weight2 > weight1 ? ( weight - weight1 ) / ( weight2 - weight1 ) : 0.0f;
+    if( w < 0.0f ) w = 0.0f;
+    else if( w > 1.0f ) w = 1.0f;
+    table[3*icol]   = (unsigned char)( (1.0f-w)*knees[iknee].r + w*knees[iknee+1].r + 0.5f );
+    table[3*icol+1] = (unsigned char)( (1.0f-w)*knees[iknee].g + w*knees[iknee+1].g + 0.5f );
+    table[3*icol+2] = (unsigned char)( (1.0f-w)*knees[iknee].b + w*knees[iknee+1].b + 0.5f );
+  }
+}
+//--------------------------------------------------------------------
+void csImageRenderer::addTrace( float const* samples, double annotationValue ) {
+  if( myNumTraces == myNumTracesAlloc ) {
+    int numTracesAlloc = myNumTracesAlloc > 0 ? 2*myNumTracesAlloc : 256;
+    float* traceDataNew  = new float[(size_t)numTracesAlloc * myNumSamples];
+    double* annotationNew = new double[numTracesAlloc];
+    if( myNumTraces > 0 ) {
+      memcpy( traceDataNew, myTraceData, (size_t)myNumTraces * myNumSamples * sizeof(float) );
+      memcpy( annotationNew, myAnnotation, myNumTraces * sizeof(double) );
+    }
+    if( myTraceData != NULL ) delete [] myTraceData;
+    if( myAnnotation != NULL ) delete [] myAnnotation;
+    myTraceData  = traceDataNew;
+    myAnnotation = annotationNew;
+    myNumTracesAlloc = numTracesAlloc;
+  }
+  memcpy( &myTraceData[(size_t)myNumTraces * myNumSamples], samples, myNumSamples * sizeof(float) );
+  myAnnotation[myNumTraces] = annotationValue;
+  myNumTraces += 1;
+}
+//--------------------------------------------------------------------
+void csImageRenderer::setScaling() {
+  if( myTraceScalar != NULL ) delete [] myTraceScalar;
+  myTraceScalar = new float[myNumTraces > 0 ? myNumTraces : 1];
+  myCentreValue = 0.0f;
+  float scalar = 1.0f;
+  if( myAttr.scaleType == SCALE_TYPE_SCALAR ) {
+    scalar = myAttr.dispScalar;
+  }
+  else if( myAttr.scaleType == SCALE_TYPE_RANGE ) {
+    myCentreValue = 0.5f * ( myAttr.minValue + myAttr.maxValue );
+    if( myAttr.maxValue > myAttr.minValue ) scalar = 2.0f / ( myAttr.maxValue - myAttr.minValue );
+  }
+  for( int itrc = 0; itrc < myNumTraces; itrc++ ) {
+    myTraceScalar[itrc] = scalar;
+    if( myAttr.scaleType == SCALE_TYPE_TRACE ) {
+      // Same as TRACE_SCALING_AVERAGE in Java display: Mean absolute amplitude is scaled to 0.1
+      float const* samples = &myTraceData[(size_t)itrc * myNumSamples];
+      double sum = 0.0;
+      for( int isamp = 0; isamp < myNumSamples; isamp++ ) {
+        sum += fabs( samples[isamp] );
+      }
+      double mean = myNumSamples > 0 ? sum / (double)myNumSamples : 0.0;
+      myTraceScalar[itrc] = mean > 0.0 ? (float)( 0.1 / mean ) : 1.0f;
+    }
+  }
+}
+//--------------------------------------------------------------------
+void csImageRenderer::setTimeLines() {
+  myMinTime = 0.0f;
+  myMaxTime = (float)( myNumSamples > 1 ? myNumSamples-1 : 1 ) * mySampleInt;
+  if( myAttr.minTime < myAttr.maxTime ) {
+    myMinTime = myAttr.minTime;
+    myMaxTime = myAttr.maxTime;
+  }
+  if( !myAttr.isTimeLinesAuto ) {
+    myMajorInc = myAttr.timeLineMajorInc;
+    myMinorInc = myAttr.timeLineMinorInc;
+  }
+  else {
+    // Minor lines approximately every 12 pixels
+    double minorInc = 12.0 * (double)( myMaxTime - myMinTime ) / (double)myPlotHeight;
+    if( minorInc < mySampleInt ) minorInc = mySampleInt;
+    double mantissa = 1.0;
+    minorInc = niceNumber( minorInc, &mantissa );
+    myMinorInc = (float)minorInc;
+    myMajorInc = (float)( mantissa == 5.0 ? 4.0*minorInc : 5.0*minorInc );
+  }
+  if( myMinorInc <= 0.0f ) myMinorInc = myMajorInc;
+}
+//--------------------------------------------------------------------
+void csImageRenderer::setLayout() {
+  int width  = myAttr.width;
+  int height = myAttr.height;
+  if( myAttr.fontSize > 0 ) {
+    myFontScale = ( myAttr.fontSize + 4 ) / 8;
+  }
+  else {
+    myFontScale = height >= 500 && width >= 400 ? 2 : 1;
+  }
+  if( myFontScale < 1 ) myFontScale = 1;
+  int charHeight = 8 * myFontScale;
+  int tickLength = 4 * myFontScale;
+
+  myPlotTop = 6;
+  if( !myAttr.title.empty() ) myPlotTop += charHeight + 6;
+  if( myAttr.showTraceAnnotation ) myPlotTop += charHeight + tickLength + 2;
+  myPlotHeight = height - myPlotTop - 10;
+  if( myPlotHeight < 1 ) myPlotHeight = 1;
+
+  setTimeLines();
+  int labelWidth = 0;
+  if( myMajorInc > 0.0f ) {
+    int numDecimals = (int)ceil( -log10( myMajorInc ) - 1e-6 );
+    if( numDecimals < 0 ) numDecimals = 0;
+    if( numDecimals > 6 ) numDecimals = 6;
+    int width1 = textWidth( formatValue( myMinTime, numDecimals ) );
+    int width2 = textWidth( formatValue( myMaxTime, numDecimals ) );
+    labelWidth = width1 > width2 ? width1 : width2;
+  }
+  myPlotLeft  = labelWidth + tickLength + 8;
+  myPlotWidth = width - myPlotLeft - 10;
+  if( myPlotWidth < 1 ) myPlotWidth = 1;
+  myTraceSpacing = (float)myPlotWidth / (float)( myNumTraces > 0 ? myNumTraces : 1 );
+
+  if( myAttr.showTraceAnnotation && myNumTraces > 0 ) {
+    int labelWidthMax = 0;
+    for( int itrc = 0; itrc < myNumTraces; itrc++ ) {
+      int labelWidthTrace = textWidth( formatHeaderValue( myAnnotation[itrc] ) );
+      if( labelWidthTrace > labelWidthMax ) labelWidthMax = labelWidthTrace;
+    }
+    double mantissa = 1.0;
+    double step = niceNumber( (double)( labelWidthMax + 12*myFontScale ) / (double)myTraceSpacing, &mantissa );
+    myAnnotationStep = step < 1.0 ? 1 : (int)( step + 0.5 );
+  }
+}
+int csImageRenderer::textWidth( std::string const& text ) const {
+  return( (int)text.length() * 6 * myFontScale );
+}
+//--------------------------------------------------------------------
+void csImageRenderer::render( std::string const& filename ) {
+  int width  = myAttr.width;
+  int height = myAttr.height;
+  if( width <= 0 || height <= 0 ) {
+    throw( cseis_geolib::csException("Invalid image size %dx%d", width, height) );
+  }
+  setLayout();
+  setScaling();
+  if( myPixels != NULL ) delete [] myPixels;
+  myPixels = new unsigned char[(size_t)3 * width * height];
+
+  int numTiles = ( height + TILE_HEIGHT - 1 ) / TILE_HEIGHT;
+  int numThreads = myAttr.numThreads > 0 ? myAttr.numThreads : cseis_geolib::csThreadPool::numProcessors();
+  if( numThreads > numTiles ) numThreads = numTiles;
+  if( numThreads <= 1 ) {
+    renderRows( 0, height );
+  }
+  else {
+    cseis_geolib::csThreadPool pool( numThreads );
+    csImageRendererTask** tasks = new csImageRendererTask*[numTiles];
+    for( int itile = 0; itile < numTiles; itile++ ) {
+      int rowEnd = (itile+1) * TILE_HEIGHT < height ? (itile+1) * TILE_HEIGHT : height;
+      tasks[itile] = new csImageRendererTask( this, itile * TILE_HEIGHT, rowEnd );
+      pool.submit( tasks[itile] );
+    }
+    pool.waitAll();
+    std::string errorMessage;
+    for( int itile = 0; itile < numTiles; itile++ ) {
+      if( tasks[itile]->hasError() && errorMessage.empty() ) errorMessage = tasks[itile]->errorMessage();
+      delete tasks[itile];
+    }
+    delete [] tasks;
+    if( !errorMessage.empty() ) {
+      throw( cseis_geolib::csException("Error occurred when rendering image: %s", errorMessage.c_str()) );
+    }
+  }
+  cseis_geolib::csPNGWriter::writeRGB( filename, myPixels, width, height );
+  delete [] myPixels;
+  myPixels = NULL;
+}
+//--------------------------------------------------------------------
+inline void csImageRenderer::setPixel( int x, int y, unsigned char const* rgb ) {
+  unsigned char* pixel = &myPixels[3 * ( (size_t)y * myAttr.width + x )];
+  pixel[0] = rgb[0];
+  pixel[1] = rgb[1];
+  pixel[2] = rgb[2];
+}
+void csImageRenderer::fillSpan( int x1, int x2, int y, unsigned char const* rgb ) {
+  if( x1 > x2 ) {
+    int tmp = x1;
+    x1 = x2;
+    x2 = tmp;
+  }
+  if( x1 < myPlotLeft ) x1 = myPlotLeft;
+  if( x2 > myPlotLeft + myPlotWidth - 1 ) x2 = myPlotLeft + myPlotWidth - 1;
+  for( int x = x1; x <= x2; x++ ) {
+    setPixel( x, y, rgb );
+  }
+}
+float csImageRenderer::scaledValue( int itrc, float sampleIndex ) const {
+  if( sampleIndex < 0.0f || sampleIndex > (float)(myNumSamples-1) ) return 0.0f;
+  float const* samples = &myTraceData[(size_t)itrc * myNumSamples];
+  int isamp = (int)sampleIndex;
+  float value = samples[isamp];
+  if( isamp < myNumSamples-1 ) {
+    float w = sampleIndex - (float)isamp;
+    value = (1.0f-w) * value + w * samples[isamp+1];
+  }
+  return( ( value - myCentreValue ) * myTraceScalar[itrc] );
+}
+int csImageRenderer::colorIndex( float scaledValue ) const {
+  int index = (int)( ( scaledValue + 1.0f ) * 0.5f * (float)(NUM_COLORS-1) + 0.5f );
+  if( index < 0 ) return 0;
+  if( index >= NUM_COLORS ) return NUM_COLORS-1;
+  return index;
+}
+//--------------------------------------------------------------------
+void csImageRenderer::renderRows( int rowStart, int rowEnd ) {
+  memset( &myPixels[(size_t)3 * rowStart * myAttr.width], 255, (size_t)3 * (rowEnd - rowStart) * myAttr.width );
+  renderTraces( rowStart, rowEnd );
+  renderText( rowStart, rowEnd );
+}
+void csImageRenderer::renderTraces( int rowStart, int rowEnd ) {
+  int plotRowStart = rowStart > myPlotTop ? rowStart : myPlotTop;
+  int plotRowEnd   = rowEnd < myPlotTop + myPlotHeight ? rowEnd : myPlotTop + myPlotHeight;
+  if( myNumTraces == 0 ) return;
+  float timeScalar = ( myMaxTime - myMinTime ) / (float)myPlotHeight;
+
+  if( myAttr.isVIDisplay && plotRowStart < plotRowEnd ) {
+    float* rowValues = new float[myNumTraces];
+    for( int y = plotRowStart; y < plotRowEnd; y++ ) {
+      float sampleIndex = ( myMinTime + ( (float)(y - myPlotTop) + 0.5f ) * timeScalar ) / mySampleInt;
+      if( myAttr.viType == VA_TYPE_DISCRETE ) sampleIndex = floor( sampleIndex + 0.5f );
+      for( int itrc = 0; itrc < myNumTraces; itrc++ ) {
+        rowValues[itrc] = scaledValue( itrc, sampleIndex );
+      }
+      for( int x = myPlotLeft; x < myPlotLeft + myPlotWidth; x++ ) {
+        float traceIndex = ( (float)(x - myPlotLeft) + 0.5f ) / myTraceSpacing - 0.5f;
+        float value;
+        if( myAttr.viType == VA_TYPE_2DSPLINE ) {
+          int itrc = (int)floor( traceIndex );
+          float w = traceIndex - (float)itrc;
+          if( itrc < 0 ) {
+            itrc = 0;
+            w = 0.0f;
+          }
+          else if( itrc >= myNumTraces-1 ) {
+            itrc = myNumTraces-1;
+            w = 0.0f;
+          }
+          value = w > 0.0f ? (1.0f-w) * rowValues[itrc] + w * rowValues[itrc+1] : rowValues[itrc];
+        }
+        else {
+          int itrc = (int)floor( traceIndex + 0.5f );
+          if( itrc < 0 ) itrc = 0;
+          else if( itrc >= myNumTraces ) itrc = myNumTraces-1;
+          value = rowValues[itrc];
+        }
+        setPixel( x, y, &myVIColors[3*colorIndex( value )] );
+      }
+    }
+    delete [] rowValues;
+  }
+
+  // Time lines
+  if( myAttr.showTimeLines && myMinorInc > 0.0f ) {
+    int numMinorPerMajor = (int)( myMajorInc / myMinorInc + 0.5f );
+    if( numMinorPerMajor < 1 ) numMinorPerMajor = 1;
+    int lineFirst = (int)ceil( myMinTime / myMinorInc - 1e-4 );
+    int lineLast  = (int)floor( myMaxTime / myMinorInc + 1e-4 );
+    for( int line = lineFirst; line <= lineLast; line++ ) {
+      int y = myPlotTop + (int)( ( (float)line * myMinorInc - myMinTime ) / timeScalar );
+      if( y < plotRowStart || y >= plotRowEnd ) continue;
+      bool isMajor = ( line % numMinorPerMajor ) == 0;
+      fillSpan( myPlotLeft, myPlotLeft + myPlotWidth - 1, y, isMajor ? COLOR_MAJOR_LINE : COLOR_MINOR_LINE );
+    }
+  }
+
+  // Wiggles
+  if( myAttr.showWiggle || myAttr.showZeroLines ) {
+    float maxDeflection = myAttr.doTraceClipping ? myAttr.traceClip * myTraceSpacing : 1e30f;
+    for( int itrc = 0; itrc < myNumTraces; itrc++ ) {
+      float xCentre = (float)myPlotLeft + ( (float)itrc + 0.5f ) * myTraceSpacing;
+      int ixCentre = (int)xCentre;
+      int ixPrev = -1;
+      for( int y = plotRowStart; y < plotRowEnd; y++ ) {
+        if( myAttr.showZeroLines ) fillSpan( ixCentre, ixCentre, y, COLOR_ZERO_LINE );
+        if( !myAttr.showWiggle ) continue;
+        if( ixPrev < 0 && y > myPlotTop ) {
+          // First row of tile: Line continues from previous row, which is rendered by another tile
+          float sampleIndexPrev = ( myMinTime + ( (float)(y - 1 - myPlotTop) + 0.5f ) * timeScalar ) / mySampleInt;
+          float deflectionPrev = myAttr.polarity * scaledValue( itrc, sampleIndexPrev ) * myTraceSpacing;
+          if( deflectionPrev > maxDeflection ) deflectionPrev = maxDeflection;
+          else if( deflectionPrev < -maxDeflection ) deflectionPrev = -maxDeflection;
+          ixPrev = (int)floor( xCentre + deflectionPrev );
+        }
+        float sampleIndex = ( myMinTime + ( (float)(y - myPlotTop) + 0.5f ) * timeScalar ) / mySampleInt;
+        float value = scaledValue( itrc, sampleIndex );
+        float deflection = myAttr.polarity * value * myTraceSpacing;
+        if( deflection > maxDeflection ) deflection = maxDeflection;
+        else if( deflection < -maxDeflection ) deflection = -maxDeflection;
+        int ix = (int)floor( xCentre + deflection );
+        if( deflection > 0.0f && myAttr.isPosFill ) {
+          fillSpan( ixCentre, ix, y, myAttr.isVariableColor ? &myWiggleColors[3*colorIndex( value )] : COLOR_BLACK );
+        }
+        else if( deflection < 0.0f && myAttr.isNegFill ) {
+          fillSpan( ix, ixCentre, y, myAttr.isVariableColor ? &myWiggleColors[3*colorIndex( value )] : COLOR_LIGHT_GRAY );
+        }
+        fillSpan( ixPrev >= 0 ? ixPrev : ix, ix, y, COLOR_BLACK );
+        ixPrev = ix;
+      }
+    }
+  }
+}
+//--------------------------------------------------------------------
+void csImageRenderer::renderText( int rowStart, int rowEnd ) {
+  int charHeight = 8 * myFontScale;
+  int tickLength = 4 * myFontScale;
+  int width = myAttr.width;
+
+  // Frame around plot area
+  int xLeft   = myPlotLeft - 1;
+  int xRight  = myPlotLeft + myPlotWidth;
+  int yTop    = myPlotTop - 1;
+  int yBottom = myPlotTop + myPlotHeight;
+  for( int y = rowStart; y < rowEnd; y++ ) {
+    if( y == yTop || y == yBottom ) {
+      for( int x = xLeft; x <= xRight; x++ ) {
+        if( x >= 0 && x < width ) setPixel( x, y, COLOR_BLACK );
+      }
+    }
+    else if( y > yTop && y < yBottom ) {
+      if( xLeft >= 0 ) setPixel( xLeft, y, COLOR_BLACK );
+      if( xRight < width ) setPixel( xRight, y, COLOR_BLACK );
+    }
+  }
+
+  // Title
+  int yText = 6;
+  if( !myAttr.title.empty() ) {
+    drawText( myAttr.title, ( width - textWidth( myAttr.title ) ) / 2, yText, rowStart, rowEnd );
+    yText += charHeight + 6;
+  }
+
+  // Trace annotation
+  if( myAttr.showTraceAnnotation ) {
+    for( int itrc = 0; itrc < myNumTraces; itrc += myAnnotationStep ) {
+      int xCentre = myPlotLeft + (int)( ( (float)itrc + 0.5f ) * myTraceSpacing );
+      std::string text = formatHeaderValue( myAnnotation[itrc] );
+      int xText = xCentre - textWidth( text ) / 2;
+      if( xText < 0 ) xText = 0;
+      if( xText + textWidth( text ) > width ) xText = width - textWidth( text );
+      drawText( text, xText, yText, rowStart, rowEnd );
+      for( int y = myPlotTop - tickLength; y < myPlotTop; y++ ) {
+        if( y >= rowStart && y < rowEnd ) setPixel( xCentre, y, COLOR_BLACK );
+      }
+    }
+  }
+
+  // Time axis annotation at major time lines
+  if( myMajorInc > 0.0f ) {
+    int numDecimals = (int)ceil( -log10( myMajorInc ) - 1e-6 );
+    if( numDecimals < 0 ) numDecimals = 0;
+    if( numDecimals > 6 ) numDecimals = 6;
+    float timeScalar = ( myMaxTime - myMinTime ) / (float)myPlotHeight;
+    int lineFirst = (int)ceil( myMinTime / myMajorInc - 1e-4 );
+    int lineLast  = (int)floor( myMaxTime / myMajorInc + 1e-4 );
+    for( int line = lineFirst; line <= lineLast; line++ ) {
+      float time = (float)line * myMajorInc;
+      int y = myPlotTop + (int)( ( time - myMinTime ) / timeScalar );
+      if( y >= myPlotTop + myPlotHeight ) y = myPlotTop + myPlotHeight - 1;
+      std::string text = formatValue( time, numDecimals );
+      int yLabel = y - charHeight / 2;
+      drawText( text, myPlotLeft - tickLength - 4 - textWidth( text ), yLabel, rowStart, rowEnd );
+      if( y >= rowStart && y < rowEnd ) {
+        for( int x = myPlotLeft - tickLength; x < myPlotLeft; x++ ) {
+          if( x >= 0 ) setPixel( x, y, COLOR_BLACK );
+        }
+      }
+    }
+  }
+}
+void csImageRenderer::drawText( std::string const& text, int x, int y, int rowStart, int rowEnd ) {
+  int scale = myFontScale;
+  if( y + 7*scale <= rowStart || y >= rowEnd ) return;
+  for( int ichar = 0; ichar < (int)text.length(); ichar++ ) {
+    unsigned char const* rows = glyph( text[ichar] );
+    int xChar = x + ichar * 6 * scale;
+    for( int irow = 0; irow < 7; irow++ ) {
+      for( int icol = 0; icol < 5; icol++ ) {
+        if( ( rows[irow] & ( 0x10 >> icol ) ) == 0 ) continue;
+        for( int dy = 0; dy < scale; dy++ ) {
+          int yPixel = y + irow * scale + dy;
+          if( yPixel < rowStart || yPixel >= rowEnd || yPixel < 0 || yPixel >= myAttr.height ) continue;
+          for( int dx = 0; dx < scale; dx++ ) {
+            int xPixel = xChar + icol * scale + dx;
+            if( xPixel >= 0 && xPixel < myAttr.width ) setPixel( xPixel, yPixel, COLOR_BLACK );
+          }
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,162 @@
+/* Copyright (c) Colorado School of Mines, 2013.*/
+/* All rights reserved.                       */
+
+#ifndef CS_IMAGE_RENDERER_H
+#define CS_IMAGE_RENDERER_H
+
+#include <string>
+
+namespace mod_image {
+
+   static const int WIGGLE_FILL_NONE   = 0;
+   static const int WIGGLE_FILL_POS    = 1;
+   static const int WIGGLE_FILL_NEG    = 2;
+   static const int WIGGLE_FILL_POSNEG = 3;
+
+   static const int WIGGLE_COLOR_FIXED    = 41;
+   static const int WIGGLE_COLOR_VARIABLE = 42;
+
+   static const int SCALE_TYPE_SCALAR = 31;
+   static const int SCALE_TYPE_RANGE  = 32;
+   static const int SCALE_TYPE_TRACE  = 33;
+
+   static const int TRACE_SCALING_MAXIMUM = 51;
+   static const int TRACE_SCALING_AVERAGE = 52;
+
+   static const int WIGGLE_TYPE_LINEAR = 11;
+   static const int WIGGLE_TYPE_CUBIC  = 12;
+
+   static const float POLARITY_NORMAL    = 1.0f;
+   static const float POLARITY_REVERSED  = -1.0f;
+
+   static const int VA_TYPE_2DSPLINE = 21;
+   static const int VA_TYPE_VERTICAL = 22;
+   static const int VA_TYPE_DISCRETE = 23;
+
+   static const int PLOT_DIR_VERTICAL   = 0;
+   static const int PLOT_DIR_HORIZONTAL = 1;
+
+/**
+ * Display settings of native renderer. Defaults are the same as in the Java PlotImage program.
+ */
+struct RenderAttr {
+  RenderAttr();
+  int width;
+  int height;
+  int fontSize;
+  std::string title;
+  /// Time window to display [ms] or [Hz]. Full trace if minTime >= maxTime
+  float minTime;
+  float maxTime;
+  int scaleType;
+  float dispScalar;
+  float minValue;
+  float maxValue;
+  float polarity;
+  bool doTraceClipping;
+  float traceClip;
+  bool showWiggle;
+  bool isPosFill;
+  bool isNegFill;
+  bool isVariableColor;
+  bool isVIDisplay;
+  int viType;
+  bool showZeroLines;
+  bool showTimeLines;
+  bool isTimeLinesAuto;
+  float timeLineMajorInc;
+  float timeLineMinorInc;
+  int viColorMap;
+  int wiggleColorMap;
+  bool showTraceAnnotation;
+  /// Number of threads. 0: Use number of processors
+  int numThreads;
+};
+
+class csImageRendererTask;
+
+/**
+ * Native seismic image renderer
+ *
+ * Renders traces as wiggle and/or variable intensity display with time lines, time axis annotation, trace
+ * annotation and title, and writes the image as PNG file.
+ * Traces are stored in memory as they are added. The image is split into tiles of image rows, which are rendered
+ * in parallel: Every pixel is computed from the trace data alone, so tiles are independent of each other.
+ *
+ * @author Bjorn Olofsson
+ * @date 2013
+ */
+class csImageRenderer {
+ public:
+  csImageRenderer( RenderAttr const& attr, int numSamples, float sampleInt );
+  ~csImageRenderer();
+  /**
+   * Add next trace
+   * @param samples          Trace samples
+   * @param annotationValue  Trace header value used for trace annotation
+   */
+  void addTrace( float const* samples, double annotationValue );
+  int numTraces() const { return myNumTraces; }
+  /**
+   * Render image and write it to PNG file
+   * @throws csException if file cannot be written
+   */
+  void render( std::string const& filename );
+  /**
+   * @return Index of predefined colour map with given name, or -1 if name is unknown
+   */
+  static int colorMapIndex( std::string const& name );
+
+ private:
+  friend class csImageRendererTask;
+  static int const TILE_HEIGHT = 32;
+  static int const NUM_COLORS  = 256;
+
+  void setLayout();
+  void setScaling();
+  void setTimeLines();
+  void setColorTable( int colorMapIndex, unsigned char* table ) const;
+  void renderRows( int rowStart, int rowEnd );
+  void renderTraces( int rowStart, int rowEnd );
+  void renderText( int rowStart, int rowEnd );
+  /// @return Trace value at given sample index, linearly interpolated, scaled to range [-1,1] (wiggle scaling)
+  float scaledValue( int itrc, float sampleIndex ) const;
+  /// @return Colour table index for given scaled value
+  int colorIndex( float scaledValue ) const;
+  inline void setPixel( int x, int y, unsigned char const* rgb );
+  void fillSpan( int x1, int x2, int y, unsigned char const* rgb );
+  void drawText( std::string const& text, int x, int y, int rowStart, int rowEnd );
+  int textWidth( std::string const& text ) const;
+
+  RenderAttr myAttr;
+  int myNumSamples;
+  float mySampleInt;
+  int myNumTraces;
+  int myNumTracesAlloc;
+  float* myTraceData;
+  double* myAnnotation;
+  /// Trace scalars and centre amplitude, applied before display
+  float* myTraceScalar;
+  float myCentreValue;
+
+  // Layout
+  int myPlotLeft;
+  int myPlotTop;
+  int myPlotWidth;
+  int myPlotHeight;
+  int myFontScale;
+  float myTraceSpacing;
+  float myMinTime;
+  float myMaxTime;
+  float myMajorInc;
+  float myMinorInc;
+  int myAnnotationStep;
+
+  unsigned char* myPixels;
+  unsigned char myVIColors[3*NUM_COLORS];
+  unsigned char myWiggleColors[3*NUM_COLORS];
+};
+
+} // namespace
+
+#endif
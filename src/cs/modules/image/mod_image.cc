@@ -4,6 +4,7 @@
 #include "cseis_includes.h"
 #include "csSeismicWriter.h"
 #include "csFileUtils.h"
+#include "csImageRenderer.h"
 #include <sstream>
 #include <ctime>
 
@@ -32,39 +33,17 @@ namespace mod_image {
     cseis_system::csSeismicWriter* writer;
     int nTracesOut;
     bool isFirstCall;
+    /// Native renderer: Traces are rendered in-process, without temporary files and external PlotImage program
+    bool isNative;
+    csImageRenderer* renderer;
+    std::string imageFilename;
+    int hdrIndexAnnotation;
   };
-
-   static const int WIGGLE_FILL_NONE   = 0;
-   static const int WIGGLE_FILL_POS    = 1;
-   static const int WIGGLE_FILL_NEG    = 2;
-   static const int WIGGLE_FILL_POSNEG = 3;
-  
-   static const int WIGGLE_COLOR_FIXED    = 41;
-   static const int WIGGLE_COLOR_VARIABLE = 42;
-
-   static const int SCALE_TYPE_SCALAR = 31;
-   static const int SCALE_TYPE_RANGE  = 32;
-   static const int SCALE_TYPE_TRACE  = 33;
-
-   static const int TRACE_SCALING_MAXIMUM = 51;
-   static const int TRACE_SCALING_AVERAGE = 52;
-  
-   static const int WIGGLE_TYPE_LINEAR = 11;
-   static const int WIGGLE_TYPE_CUBIC  = 12;
-
-   static const float POLARITY_NORMAL    = 1.0f;
-   static const float POLARITY_REVERSED  = -1.0f;
-
-   static const int VA_TYPE_2DSPLINE = 21;
-   static const int VA_TYPE_VERTICAL = 22;
-   static const int VA_TYPE_DISCRETE = 23;
-
-   static const int PLOT_DIR_VERTICAL   = 0;
-   static const int PLOT_DIR_HORIZONTAL = 1;
 }
 using namespace mod_image;
 
 std::string random_name( std::string pre, int size, std::string post );
+void init_native( csParamManager* param, csInitPhaseEnv* env, csLogWriter* log, VariableStruct* vars );
 
 //*************************************************************************************************
 // Init phase
@@ -96,6 +75,9 @@ void init_mod_image_( csParamManager* param, csInitPhaseEnv* env, csLogWriter* l
   vars->propertiesFilename = "";
   vars->nTracesOut = 0;
   vars->isFirstCall = true;
+  vars->isNative    = false;
+  vars->renderer    = NULL;
+  vars->hdrIndexAnnotation = -1;
 
   int height = 800;
   int width  = 600;
@@ -111,6 +93,26 @@ void init_mod_image_( csParamManager* param, csInitPhaseEnv* env, csLogWriter* l
   param->getStringAtLine( "filename", &filename_image );
   vars->command.append( " -o " + filename_image );
 
+  if( param->exists( "renderer" ) ) {
+    param->getString( "renderer", &text );
+    if( !text.compare("native") ) {
+      vars->isNative = true;
+    }
+    else if( text.compare("java") ) {
+      log->error("Unknown option: %s", text.c_str() );
+    }
+  }
+  if( vars->isNative ) {
+    // Native renderer only writes PNG files
+    int length = filename_image.length();
+    if( length < 5 || toLowerCase( filename_image.substr(length-4) ).compare(".png") ) {
+      log->error("Native renderer only supports PNG output. Output image file name must have extension '.png': %s", filename_image.c_str());
+    }
+    vars->imageFilename = filename_image;
+    init_native( param, env, log, vars );
+    return;
+  }
+
   // Create random temporary file name
   // Make sure that file name is unique
   std::ostringstream pid;
@@ -562,6 +564,28 @@ bool exec_mod_image_(
   VariableStruct* vars = reinterpret_cast<VariableStruct*>( env->execPhaseDef->variables() );
 
   if( edef->isCleanup() ) {
+    if( vars->isNative ) {
+      bool success = true;
+      if( vars->renderer != NULL ) {
+        if( vars->renderer->numTraces() == 0 ) {
+          log->warning("No input traces. Image file '%s' not created.", vars->imageFilename.c_str());
+        }
+        else {
+          try {
+            vars->renderer->render( vars->imageFilename );
+            log->line("Image file '%s' created from %d traces.", vars->imageFilename.c_str(), vars->renderer->numTraces());
+          }
+          catch( csException& exc ) {
+            log->line("$IMAGE: Error occurred when creating image file '%s'. System message:\n%s", vars->imageFilename.c_str(), exc.getMessage());
+            success = false;
+          }
+        }
+        delete vars->renderer;
+        vars->renderer = NULL;
+      }
+      delete vars; vars = NULL;
+      return success;
+    }
     if( vars->writer != NULL ) {
       delete vars->writer;
       vars->writer = NULL;
@@ -603,6 +627,13 @@ bool exec_mod_image_(
     return true;
   } // END isCleanup
 
+  if( vars->isNative ) {
+    double annotationValue = 0.0;
+    if( vars->hdrIndexAnnotation >= 0 ) annotationValue = trace->getTraceHeader()->doubleValue( vars->hdrIndexAnnotation );
+    vars->renderer->addTrace( trace->getTraceSamples(), annotationValue );
+    return true;
+  }
+
   if( vars->isFirstCall ) {
     vars->isFirstCall = false;
     try {
@@ -646,9 +677,19 @@ void params_mod_image_( csParamDef* pdef ) {
   pdef->setModule( "IMAGE", "Create image file from seismic display.." );
 
   pdef->addParam( "filename", "Output image file name", NUM_VALUES_FIXED,
-                  "Supported extensions/formats: jpg/jpeg, png, bmp, gif (or upper case letters)" );
+                  "Supported extensions/formats: jpg/jpeg, png, bmp, gif (or upper case letters). Native renderer: png only" );
   pdef->addValue( "", VALTYPE_STRING, "Output image file name" );
 
+  pdef->addParam( "renderer", "Image renderer", NUM_VALUES_FIXED );
+  pdef->addValue( "java", VALTYPE_OPTION );
+  pdef->addOption( "java", "Render image with external Java program PlotImage (plotimage.sh)",
+                   "Traces are written to temporary SeaSeis file which is read by PlotImage" );
+  pdef->addOption( "native", "Render image in-process and write PNG file",
+                   "No temporary files and no Java VM. Not supported: color_bar, db, hdr_date_format, log_scale, horizontal plot direction, custom colour maps" );
+
+  pdef->addParam( "nthreads", "Number of threads used by native renderer", NUM_VALUES_FIXED );
+  pdef->addValue( "0", VALTYPE_NUMBER, "Number of threads. 0: Use number of processors" );
+
   pdef->addParam( "seismic_filename", "Input seismic file name", NUM_VALUES_FIXED );
   pdef->addValue( "", VALTYPE_STRING, "Input seismic file name" );
 
@@ -871,6 +912,167 @@ extern "C" bool _exec_mod_image_( csTrace* trace, int* port, csExecPhaseEnv* env
   return exec_mod_image_( trace, port, env, log );
 }
 
+//--------------------------------------------------------------------
+// Init phase, native renderer
+//
+static bool getYesNo( csParamManager* param, csLogWriter* log, char const* name, bool defaultValue ) {
+  if( !param->exists( name ) ) return defaultValue;
+  std::string text;
+  param->getString( name, &text );
+  if( !text.compare("yes") ) {
+    return true;
+  }
+  else if( text.compare("no") ) {
+    log->error("Unknown option: %s", text.c_str());
+  }
+  return false;
+}
+void init_native( csParamManager* param, csInitPhaseEnv* env, csLogWriter* log, VariableStruct* vars ) {
+  csTraceHeaderDef* hdef = env->headerDef;
+  csSuperHeader*    shdr = env->superHeader;
+  std::string text;
+  RenderAttr attr;
+
+  if( param->exists( "width" ) )    param->getInt( "width", &attr.width );
+  if( param->exists( "height" ) )   param->getInt( "height", &attr.height );
+  if( attr.width <= 0 || attr.height <= 0 ) {
+    log->error("Invalid image size: %dx%d", attr.width, attr.height);
+  }
+  if( param->exists( "fontsize" ) ) param->getInt( "fontsize", &attr.fontSize );
+  if( param->exists( "title" ) )    param->getString( "title", &attr.title );
+  if( param->exists( "window" ) ) {
+    param->getFloat( "window", &attr.minTime, 0 );
+    param->getFloat( "window", &attr.maxTime, 1 );
+    if( attr.minTime >= attr.maxTime ) log->error("Invalid window: %f - %f", attr.minTime, attr.maxTime);
+  }
+  if( param->exists( "header" ) ) {
+    param->getString( "header", &text );
+    if( !hdef->headerExists( text ) ) {
+      log->error("Trace header does not exist: %s", text.c_str());
+    }
+    vars->hdrIndexAnnotation = hdef->headerIndex( text );
+    if( hdef->headerType( vars->hdrIndexAnnotation ) == TYPE_STRING ) {
+      log->error("Trace header '%s' has string type. Only number type headers are supported for trace annotation.", text.c_str());
+    }
+    attr.showTraceAnnotation = true;
+  }
+  if( param->exists("disp_scalar") ) param->getFloat( "disp_scalar", &attr.dispScalar );
+  if( param->exists("min_value") )   param->getFloat( "min_value", &attr.minValue );
+  if( param->exists("max_value") )   param->getFloat( "max_value", &attr.maxValue );
+  if( param->exists("time_major_inc") || param->exists("time_minor_inc") ) {
+    if( !param->exists("time_major_inc") || !param->exists("time_minor_inc") ) {
+      log->error("Both time_major_inc and time_minor_inc need to be specified, or none (automatic setting).");
+    }
+    attr.isTimeLinesAuto = false;
+    param->getFloat( "time_major_inc", &attr.timeLineMajorInc );
+    param->getFloat( "time_minor_inc", &attr.timeLineMinorInc );
+    if( attr.timeLineMajorInc <= 0 || attr.timeLineMinorInc <= 0 ) {
+      log->error("Time line increments need to be larger than zero");
+    }
+  }
+  if( param->exists("trace_clip") ) {
+    param->getFloat( "trace_clip", &attr.traceClip );
+    attr.doTraceClipping = ( attr.traceClip != 0.0 );
+  }
+  if( param->exists("polarity") ) {
+    param->getString( "polarity", &text );
+    if( !text.compare("normal") ) {
+      attr.polarity = POLARITY_NORMAL;
+    }
+    else if( !text.compare("reverse") ) {
+      attr.polarity = POLARITY_REVERSED;
+    }
+    else {
+      log->error("Unknown option: %s", text.c_str());
+    }
+  }
+  if( param->exists("scale_type") ) {
+    param->getString( "scale_type", &text );
+    if( !text.compare("scalar") ) {
+      attr.scaleType = SCALE_TYPE_SCALAR;
+    }
+    else if( !text.compare("range") ) {
+      attr.scaleType = SCALE_TYPE_RANGE;
+      if( attr.minValue >= attr.maxValue ) log->error("Scale type 'range' requires min_value < max_value");
+    }
+    else if( !text.compare("full_trace") ) {
+      attr.scaleType = SCALE_TYPE_TRACE;
+    }
+    else {
+      log->error("Unknown option: %s", text.c_str());
+    }
+  }
+  if( param->exists("wiggle") ) {
+    param->getString( "wiggle", &text );
+    if( !text.compare("none") ) {
+      attr.showWiggle = false;
+    }
+    else if( !text.compare("cubic") ) {
+      log->warning("Native renderer: Cubic wiggle interpolation not supported, linear interpolation is used instead");
+    }
+    else if( text.compare("linear") ) {
+      log->error("Unknown option: %s", text.c_str());
+    }
+  }
+  if( param->exists("vi_type") ) {
+    param->getString( "vi_type", &text );
+    attr.isVIDisplay = true;
+    if( !text.compare("none") ) {
+      attr.isVIDisplay = false;
+    }
+    else if( !text.compare("discrete") ) {
+      attr.viType = VA_TYPE_DISCRETE;
+    }
+    else if( !text.compare("vertical") ) {
+      attr.viType = VA_TYPE_VERTICAL;
+    }
+    else if( !text.compare("spline") ) {
+      attr.viType = VA_TYPE_2DSPLINE;
+    }
+    else {
+      log->error("Unknown option: %s", text.c_str());
+    }
+  }
+  attr.showZeroLines   = getYesNo( param, log, "show_zero_lines", attr.showZeroLines );
+  attr.showTimeLines   = getYesNo( param, log, "show_time_lines", attr.showTimeLines );
+  attr.isPosFill       = getYesNo( param, log, "pos_fill", attr.isPosFill );
+  attr.isNegFill       = getYesNo( param, log, "neg_fill", attr.isNegFill );
+  attr.isVariableColor = getYesNo( param, log, "var_color", attr.isVariableColor );
+
+  if( param->exists("vi_color_map") ) {
+    param->getString( "vi_color_map", &text );
+    attr.viColorMap = csImageRenderer::colorMapIndex( text );
+    if( attr.viColorMap < 0 ) log->error("Unknown colour map: %s", text.c_str());
+  }
+  else {
+    attr.viColorMap = csImageRenderer::colorMapIndex( "gray_w2b" );
+  }
+  if( param->exists("wiggle_color_map") ) {
+    param->getString( "wiggle_color_map", &text );
+    attr.wiggleColorMap = csImageRenderer::colorMapIndex( text );
+    if( attr.wiggleColorMap < 0 ) log->error("Unknown colour map: %s", text.c_str());
+  }
+  else {
+    attr.wiggleColorMap = csImageRenderer::colorMapIndex( "blue_white_red" );
+  }
+  if( param->exists("nthreads") ) {
+    param->getInt( "nthreads", &attr.numThreads );
+    if( attr.numThreads < 0 ) log->error("Invalid number of threads: %d", attr.numThreads);
+  }
+
+  char const* unsupported[] = { "seismic_filename", "color_bar", "color_bar_ann", "db", "hdr_date_format", "log_scale",
+                                "plot_direction", "custom_vi_color_map", "custom_wiggle_color_map", "title_vert_axis",
+                                "time_max_decimals", "trace_spacing" };
+  for( int i = 0; i < (int)( sizeof(unsupported) / sizeof(char const*) ); i++ ) {
+    if( param->exists( unsupported[i] ) ) {
+      log->warning("Parameter '%s' is not supported by native renderer and will be ignored", unsupported[i]);
+    }
+  }
+
+  vars->renderer = new csImageRenderer( attr, shdr->numSamples, shdr->sampleInt );
+  log->line("Native renderer: Image size %dx%d, output file '%s'", attr.width, attr.height, vars->imageFilename.c_str());
+}
+
 std::string random_name( std::string pre, int size, std::string post ) {
   std::stringstream str;
   srand( time(NULL) );
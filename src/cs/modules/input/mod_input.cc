@@ -52,6 +52,8 @@ namespace mod_input {
     bool isHdrSelection;
     int sortOrder;
     int sortMethod;
+    /// false: Read trace headers only, skip trace samples
+    bool readSamples;
   };
   static int const MERGE_ALL    = 1;
   static int const MERGE_TRACE  = 2;
@@ -61,6 +63,8 @@ namespace mod_input {
   static int const MERGE_DECREASING = 22;
 
   static int const NOT_AVAILABLE = -1;
+
+  bool readTrace( VariableStruct* vars, float* samples, int numSamples );
 }
 using mod_input::VariableStruct;
 
@@ -110,6 +114,7 @@ void init_mod_input_( csParamManager* param, csInitPhaseEnv* env, csLogWriter* l
   vars->isHdrSelection = false;
   vars->sortOrder = cseis_geolib::csIOSelection::SORT_NONE;
   vars->sortMethod = cseis_geolib::csSortManager::SIMPLE_SORT;
+  vars->readSamples = true;
 
 //------------------------------------------------------------
   vars->numFiles = param->getNumLines( "filename" );
@@ -152,6 +157,20 @@ void init_mod_input_( csParamManager* param, csInitPhaseEnv* env, csLogWriter* l
     }
   }
 
+  if( param->exists( "samples" ) ) {
+    string text;
+    param->getString( "samples", &text );
+    if( !text.compare("yes") ) {
+      vars->readSamples = true;
+    }
+    else if( !text.compare("no") ) {
+      vars->readSamples = false;
+    }
+    else {
+      log->error("Unknown option: %s", text.c_str());
+    }
+  }
+
   //----------------------------------------------------
   string mergeHeaderName = ""; 
   bool enableRandomAccess = false;
@@ -367,6 +386,9 @@ void init_mod_input_( csParamManager* param, csInitPhaseEnv* env, csLogWriter* l
   }
   log->line("  Header block size:             %d", vars->hdrValueBlockSize );
   log->line("  Max number of buffered traces: %d", vars->readers[0]->numTracesCapacity() );
+  if( !vars->readSamples ) {
+    log->line("  Read trace headers only, trace samples are set to zero");
+  }
   shdr->dump( log->getFile() );
   log->line("");
   log->flush();
@@ -530,14 +552,14 @@ bool exec_mod_input_(
 
   try {
     bool success = true;
-    if( success ) success = vars->readers[vars->currentFile]->readTrace( samples, vars->hdrValueBlock, shdr->numSamples );
+    if( success ) success = mod_input::readTrace( vars, samples, shdr->numSamples );
     if( !success ) {
       if( vars->mergeOption == mod_input::MERGE_ALL ) {
         delete vars->readers[vars->currentFile];
         vars->readers[vars->currentFile] = NULL;
         vars->currentFile += 1;
         while( !success && vars->currentFile < vars->numFiles ) {
-          success = vars->readers[vars->currentFile]->readTrace( samples, vars->hdrValueBlock, shdr->numSamples );
+          success = mod_input::readTrace( vars, samples, shdr->numSamples );
 //          if( edef->isDebug() ) fprintf(stdout,"Read in next file(%d, success = %s): %s\n", vars->currentFile, success ? "true" : "false", vars->filenames[vars->currentFile].c_str());
           if( !success ) {
             delete vars->readers[vars->currentFile];
@@ -584,7 +606,7 @@ bool exec_mod_input_(
         }
         vars->currentMergeHdrValue = minValue;
         vars->currentFile = vars->fileIndexList->at(vars->currentFilePointerIndex);
-        success = vars->readers[vars->currentFile]->readTrace( samples, vars->hdrValueBlock, shdr->numSamples );
+        success = mod_input::readTrace( vars, samples, shdr->numSamples );
         if( !success ) log->error("Unexpected end of file encountered for file '%s'... File corrupted..?", vars->filenames[vars->currentFile].c_str());
         if( edef->isDebug() ) {
           log->line("Header value of first trace, file #%-2d:  %s\n", vars->currentFile+1, vars->mergeHdrValues[vars->currentFile].toString().c_str() );
@@ -669,6 +691,17 @@ bool exec_mod_input_(
   vars->traceCounter += 1;
   return true;
 }
+//--------------------------------------------------------------------------------
+// Read next trace from current input file
+//
+bool mod_input::readTrace( VariableStruct* vars, float* samples, int numSamples ) {
+  if( vars->readSamples ) {
+    return vars->readers[vars->currentFile]->readTrace( samples, vars->hdrValueBlock, numSamples );
+  }
+  if( !vars->readers[vars->currentFile]->readTraceHeader( vars->hdrValueBlock ) ) return false;
+  memset( samples, 0, numSamples*sizeof(float) );
+  return true;
+}
 //********************************************************************************
 // Parameter definition
 //
@@ -714,6 +747,12 @@ void params_mod_input_( csParamDef* pdef ) {
   pdef->addParam( "ntraces_buffer", "Number of traces to buffer", NUM_VALUES_FIXED,
                   "Reading a large number of traces at once may enhance performance, but requires more memory" );
   pdef->addValue( "0", VALTYPE_NUMBER, "Number of traces to buffer when reading" );
+
+  pdef->addParam( "samples", "Read in trace samples?", NUM_VALUES_FIXED,
+                  "Set to 'no' for flows that only operate on trace headers, e.g. HDR_PRINT or HDR_MATH. Trace samples are then skipped on disk" );
+  pdef->addValue( "yes", VALTYPE_OPTION );
+  pdef->addOption( "yes", "Read in trace samples" );
+  pdef->addOption( "no", "Read in trace headers only. Trace samples are set to zero" );
 }
 
 extern "C" void _params_mod_input_( csParamDef* pdef ) {
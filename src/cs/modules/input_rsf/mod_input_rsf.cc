@@ -23,6 +23,12 @@ using namespace std;
  */
 
 namespace mod_input_rsf {
+  static int const ORDER_DIM2 = 1;
+  static int const ORDER_DIM3 = 2;
+  static int const ORDER_TIME_SLICE = 3;
+  /// Maximum size of buffer holding a block of time slices
+  static int const SLICE_BUFFER_BYTE_SIZE = 64*1024*1024;
+
   struct VariableStruct {
     long traceCounter;
     csRSFReader* rsfReader;
@@ -43,8 +49,15 @@ namespace mod_input_rsf {
     double delayTime;
     bool atEOF;
 
-    int count_dim2;
-    int count_dim3;
+    int order;
+    int hdrId_slice_time;
+    /// Total number of traces to output
+    int numTracesOut;
+    /// Block of consecutive time slices of the whole cube, read in one pass over all traces
+    float* sliceBuffer;
+    int sliceBufferCapacity;
+    int sliceBufferFirstSample;
+    int sliceBufferNumSlices;
   };
 }
 using mod_input_rsf::VariableStruct;
@@ -82,8 +95,13 @@ void init_mod_input_rsf_( csParamManager* param, csInitPhaseEnv* env, csLogWrite
   vars->delayTime = 0;
   vars->atEOF = false;
   vars->rsfHdr = new csRSFHeader();
-  vars->count_dim2 = 0;
-  vars->count_dim3 = 0;
+  vars->order  = mod_input_rsf::ORDER_DIM2;
+  vars->hdrId_slice_time = -1;
+  vars->numTracesOut = 0;
+  vars->sliceBuffer  = NULL;
+  vars->sliceBufferCapacity    = 0;
+  vars->sliceBufferFirstSample = 0;
+  vars->sliceBufferNumSlices   = 0;
 
   //------------------------------------------------
   
@@ -133,12 +151,33 @@ void init_mod_input_rsf_( csParamManager* param, csInitPhaseEnv* env, csLogWrite
     param->getInt( "nsamples", &numSamplesOut );
   }
 
+  if( param->exists("order") ) {
+    string text;
+    param->getString( "order", &text );
+    if( !text.compare("dim2") ) {
+      vars->order = mod_input_rsf::ORDER_DIM2;
+    }
+    else if( !text.compare("dim3") ) {
+      vars->order = mod_input_rsf::ORDER_DIM3;
+    }
+    else if( !text.compare("time_slice") ) {
+      vars->order = mod_input_rsf::ORDER_TIME_SLICE;
+      if( numSamplesOut != 0 ) log->error("Number of samples cannot be specified when reading time slices");
+    }
+    else {
+      log->error("Unknown option: %s", text.c_str());
+    }
+  }
+
   //-------------------------------------------------------
   //
 
   try {
     vars->rsfReader = new csRSFReader( vars->filename, numTracesBuffer, rev_byte_order );
     vars->rsfReader->initialize( vars->rsfHdr );
+    if( vars->order == mod_input_rsf::ORDER_DIM3 ) {
+      vars->rsfReader->setReadOrder( csRSFReader::ORDER_DIM3 );
+    }
   }
   catch( csException& e ) {
     vars->rsfReader = NULL;
@@ -154,14 +193,31 @@ void init_mod_input_rsf_( csParamManager* param, csInitPhaseEnv* env, csLogWrite
   vars->hdrId_trcno = hdef->addStandardHeader( HDR_TRCNO.name );
   vars->hdrId_delay_time = hdef->addStandardHeader( HDR_DELAY_TIME.name );
 
-  if( numSamplesOut == 0 ) {
-    shdr->numSamples = vars->rsfReader->numSamples();
+  vars->numTracesOut = vars->rsfReader->numTraces();
+  if( vars->order == mod_input_rsf::ORDER_TIME_SLICE ) {
+    // One output trace per time slice and dimension 3 index. Trace samples run along dimension 2
+    vars->hdrId_slice_time = hdef->addHeader( cseis_geolib::TYPE_FLOAT, "slice_time", "Time slice" );
+    vars->numTracesOut = vars->rsfReader->numTraces() / vars->rsfHdr->n2 * vars->rsfReader->numSamples();
+    shdr->numSamples = vars->rsfHdr->n2;
+    shdr->sampleInt  = (float)vars->rsfHdr->d2;
+    vars->delayTime  = 0;
+    // Time slices are read in blocks, transposed into the slice buffer. Each pass over the cube yields a whole block of slices
+    int numTraces = vars->rsfReader->numTraces();
+    vars->sliceBufferCapacity = (int)( mod_input_rsf::SLICE_BUFFER_BYTE_SIZE / ( (csInt64_t)numTraces * 4 ) );
+    if( vars->sliceBufferCapacity < 1 ) vars->sliceBufferCapacity = 1;
+    if( vars->sliceBufferCapacity > vars->rsfReader->numSamples() ) vars->sliceBufferCapacity = vars->rsfReader->numSamples();
+    vars->sliceBuffer = new float[(csInt64_t)vars->sliceBufferCapacity * numTraces];
   }
   else {
-    shdr->numSamples = numSamplesOut;
+    if( numSamplesOut == 0 ) {
+      shdr->numSamples = vars->rsfReader->numSamples();
+    }
+    else {
+      shdr->numSamples = numSamplesOut;
+    }
+    shdr->sampleInt = vars->rsfReader->sampleInt();
+    vars->delayTime = vars->rsfHdr->o1;
   }
-  shdr->sampleInt = vars->rsfReader->sampleInt();
-  vars->delayTime = vars->rsfHdr->o1;
 
   log->line("");
   log->line( "  File name:            %s", vars->filename.c_str());
@@ -172,8 +228,6 @@ void init_mod_input_rsf_( csParamManager* param, csInitPhaseEnv* env, csLogWrite
   vars->rsfReader->dump( log->getFile() );
 
   vars->traceCounter = 0;
-  vars->count_dim2   = 1;
-  vars->count_dim3   = 1;
 }
 
 //*************************************************************************************************
@@ -200,6 +254,10 @@ bool exec_mod_input_rsf_(
       delete vars->rsfHdr;
       vars->rsfHdr = NULL;
     }
+    if( vars->sliceBuffer != NULL ) {
+      delete [] vars->sliceBuffer;
+      vars->sliceBuffer = NULL;
+    }
     delete vars; vars = NULL;
     return true;
   }
@@ -210,17 +268,52 @@ bool exec_mod_input_rsf_(
   csTraceHeader* trcHdr = trace->getTraceHeader();
   float* samples = trace->getTraceSamples();
 
-  if( (vars->nTracesToRead > 0 && vars->nTracesToRead == vars->traceCounter) ||
-      !vars->rsfReader->getNextTrace( (byte_t*)samples, shdr->numSamples ) ) {
-    if( vars->traceCounter == 0 ) {
-      log->warning("RSF file '%s' does not contain any data trace.", vars->rsfReader->filename() );
-    }
+  if( vars->nTracesToRead > 0 && vars->nTracesToRead == vars->traceCounter ) {
     vars->atEOF = true;
     return false;
   }
-  
-  double dim2 = vars->rsfHdr->o2 + (vars->count_dim2-1) * vars->rsfHdr->d2;
-  double dim3 = vars->rsfHdr->o3 + (vars->count_dim3-1) * vars->rsfHdr->d3;
+
+  double dim2 = 0.0;
+  double dim3 = 0.0;
+  try {
+    if( vars->order == mod_input_rsf::ORDER_TIME_SLICE ) {
+      if( vars->traceCounter == vars->numTracesOut ) {
+        vars->atEOF = true;
+        return false;
+      }
+      int numTracesDim3 = vars->rsfReader->numTraces() / vars->rsfHdr->n2;
+      int sampleIndex = (int)( vars->traceCounter / numTracesDim3 );
+      int index_dim3  = (int)( vars->traceCounter % numTracesDim3 );
+      if( sampleIndex >= vars->sliceBufferFirstSample + vars->sliceBufferNumSlices ) {
+        vars->sliceBufferFirstSample = sampleIndex;
+        vars->sliceBufferNumSlices   = vars->rsfReader->numSamples() - sampleIndex;
+        if( vars->sliceBufferNumSlices > vars->sliceBufferCapacity ) vars->sliceBufferNumSlices = vars->sliceBufferCapacity;
+        vars->rsfReader->readTimeSlices( vars->sliceBufferFirstSample, vars->sliceBufferNumSlices, vars->sliceBuffer );
+      }
+      int numTraces = vars->rsfReader->numTraces();
+      float const* sliceLine = &vars->sliceBuffer[(csInt64_t)( sampleIndex - vars->sliceBufferFirstSample ) * numTraces + (csInt64_t)index_dim3 * vars->rsfHdr->n2];
+      memcpy( samples, sliceLine, vars->rsfHdr->n2 * sizeof(float) );
+      dim2 = vars->rsfHdr->o2;
+      dim3 = vars->rsfHdr->o3 + index_dim3 * vars->rsfHdr->d3;
+      trcHdr->setFloatValue( vars->hdrId_slice_time, (float)( vars->rsfHdr->o1 + sampleIndex * vars->rsfHdr->d1 ) );
+    }
+    else {
+      if( !vars->rsfReader->getNextTrace( (byte_t*)samples, shdr->numSamples ) ) {
+        if( vars->traceCounter == 0 ) {
+          log->warning("RSF file '%s' does not contain any data trace.", vars->rsfReader->filename() );
+        }
+        vars->atEOF = true;
+        return false;
+      }
+      int traceIndex = vars->rsfReader->getCurrentTraceIndex();
+      dim2 = vars->rsfReader->computeDim2( traceIndex );
+      dim3 = vars->rsfReader->computeDim3( traceIndex );
+    }
+  }
+  catch( csException& e ) {
+    log->error("Error when reading RSF file '%s'.\nSystem message: %s", vars->filename.c_str(), e.getMessage() );
+  }
+
   trcHdr->setDoubleValue( vars->hdrId_dim2, dim2 );
   trcHdr->setDoubleValue( vars->hdrId_dim3, dim3 );
   trcHdr->setDoubleValue( vars->hdrId_delay_time, vars->delayTime );
@@ -228,14 +321,6 @@ bool exec_mod_input_rsf_(
   vars->traceCounter++;
   trcHdr->setIntValue( vars->hdrId_trcno, vars->traceCounter );
 
-  if( vars->count_dim2 == vars->rsfHdr->n2 ) {
-    vars->count_dim2 = 1;
-    vars->count_dim3 += 1;
-  }
-  else {
-    vars->count_dim2 += 1;
-  }
-
   return true;
 }
 //********************************************************************************
@@ -261,6 +346,14 @@ void params_mod_input_rsf_( csParamDef* pdef ) {
                   "Reading in a large number of traces at once may enhance performance, but requires more memory" );
   pdef->addValue( "20", VALTYPE_NUMBER, "Number of traces to buffer" );
 
+  pdef->addParam( "order", "Order in which traces are read in", NUM_VALUES_FIXED,
+                  "The input file is memory mapped: Traces are read in any order without seek operations" );
+  pdef->addValue( "dim2", VALTYPE_OPTION );
+  pdef->addOption( "dim2", "Read traces in file order: Dimension 2 is the fast dimension (for example inline sections)" );
+  pdef->addOption( "dim3", "Read traces with dimension 3 as the fast dimension (for example crossline sections)" );
+  pdef->addOption( "time_slice", "Read time slices",
+                   "Output one trace per time slice and dimension 3 value. Trace samples run along dimension 2. Slice time is stored in trace header 'slice_time'" );
+
   pdef->addParam( "reverse_byte_order", "Reverse byte order of input file (endian byte swapping)", NUM_VALUES_VARIABLE );
   pdef->addValue( "no", VALTYPE_OPTION );
   pdef->addOption( "yes", "Reverse byte order of input file" );
@@ -10,6 +10,7 @@
 #include "csFileUtils.h"
 #include "csGeolibUtils.h"
 #include "csSort.h"
+#include "csThreadPool.h"
 #include <string>
 #include <cstring>
 #include <cmath>
@@ -29,8 +30,56 @@ using namespace std;
  * @date   2007
  */
 namespace mod_input_segd {
+  /**
+   * Opens SEGD file, reads in file headers and first record.
+   * Executed in worker thread when files are read ahead of time.
+   */
+  class SegdFileLoader : public csRunnable {
+  public:
+    SegdFileLoader( char const* filename, csSegdReader::configuration const& config, int chanSetIndexToRead ) {
+      myFilename = filename;
+      myConfig   = config;
+      myChanSetIndexToRead = chanSetIndexToRead;
+      myReader   = NULL;
+      isSuccess  = false;
+    }
+    ~SegdFileLoader() {
+      if( myReader != NULL ) {
+        delete myReader;
+        myReader = NULL;
+      }
+    }
+    virtual void run() {
+      myReader = new csSegdReader();
+      myReader->setConfiguration( myConfig );
+      try {
+        myReader->open( myFilename );
+        myReader->readNewRecordHeaders();
+        if( myChanSetIndexToRead >= 0 ) myReader->setChanSetToRead( myChanSetIndexToRead );
+        isSuccess = myReader->readNextRecord( comRecordHdr );
+      }
+      catch( string text ) {
+        throw( csException( text ) );
+      }
+    }
+    /// Hand over ownership of reader object to caller
+    csSegdReader* releaseReader() {
+      csSegdReader* reader = myReader;
+      myReader = NULL;
+      return reader;
+    }
+    bool isSuccess;
+    cseis_segd::commonRecordHeaderStruct comRecordHdr;
+  private:
+    char const* myFilename;
+    csSegdReader::configuration myConfig;
+    int myChanSetIndexToRead;
+    csSegdReader* myReader;
+  };
+
   struct VariableStruct {
     csSegdReader* segdReader;
+    csSegdReader::configuration config;
     int recSystemID;
     cseis_segd::commonFileHeaderStruct const* comFileHdr;
     cseis_segd::commonRecordHeaderStruct comRecordHdr;
@@ -91,9 +140,30 @@ namespace mod_input_segd {
     int chanSetIndexToRead;
     std::string filenameDumpHeaders;
     bool isFirstCall;
+
+    csThreadPool* threadPool;
+    /// File loaders, one slot per input file. Non-NULL for files that are currently being read ahead
+    mod_input_segd::SegdFileLoader** loaders;
+    int numFilesAhead;
+    int nextFileToLoad;
+
+    /// Channel set gather: When only one channel set is read in, all its traces are decoded in one go for each record
+    bool useChanSetGather;
+    float* chanSetSamples;
+    cseis_segd::commonTraceHeaderStruct* chanSetTrcHdrs;
+    int chanSetMaxChannels;
+    int chanSetMaxSamples;
+    int chanSetNumSamples;
+    /// Number of traces in decoded channel set gather. -1: Current record has not been decoded yet
+    int chanSetNumTraces;
+    int chanSetTraceIndex;
   };
 }
 using mod_input_segd::VariableStruct;
+using mod_input_segd::SegdFileLoader;
+
+void submitFileLoaders( VariableStruct* vars );
+bool getNextTrace( VariableStruct* vars, float* samples, int numSamplesOut, cseis_segd::commonTraceHeaderStruct& comTrcHdr );
 
 //void dumpEssentialHeaders_record( essentialSegdHeaders const* essHdrs, csLogWriter* log );
 //void dumpEssentialHeaders_trace( essentialSegdHeaders const* essHdrs, csLogWriter* log );
@@ -179,8 +249,22 @@ void init_mod_input_segd_( csParamManager* param, csInitPhaseEnv* env, csLogWrit
   vars->filenameDumpHeaders = "";
   vars->isFirstCall = true;
 
+  vars->threadPool     = NULL;
+  vars->loaders        = NULL;
+  vars->numFilesAhead  = 0;
+  vars->nextFileToLoad = 0;
+
+  vars->useChanSetGather   = false;
+  vars->chanSetSamples     = NULL;
+  vars->chanSetTrcHdrs     = NULL;
+  vars->chanSetMaxChannels = 0;
+  vars->chanSetMaxSamples  = 0;
+  vars->chanSetNumSamples  = 0;
+  vars->chanSetNumTraces   = -1;
+  vars->chanSetTraceIndex  = 0;
+
   //---------------------------------------------------------------
-  csSegdReader::configuration config;
+  csSegdReader::configuration& config = vars->config;
   config.readAuxTraces     = false;
   config.isDebug           = edef->isDebug();
   config.navInterfaceID    = cseis_segd::UNKNOWN;
@@ -270,6 +354,18 @@ void init_mod_input_segd_( csParamManager* param, csInitPhaseEnv* env, csLogWrit
 
   //********************************************************************************
 
+  int numThreads = 0;
+  if( param->exists("prefetch") ) {
+    param->getInt( "prefetch", &vars->numFilesAhead, 0 );
+    if( vars->numFilesAhead < 0 ) {
+      log->error("Number of files to read ahead must be >= 0. Specified: %d", vars->numFilesAhead );
+    }
+    if( param->getNumValues("prefetch") > 1 ) {
+      param->getInt( "prefetch", &numThreads, 1 );
+      if( numThreads < 0 ) log->error("Number of threads must be >= 0. Specified: %d", numThreads );
+    }
+  }
+
   if( param->exists("ntraces") ) {
     param->getInt( "ntraces", &vars->numTracesToRead );
     if( vars->numTracesToRead <= 0 ) vars->numTracesToRead = -1;  // Do not bother how many traces, read in all
@@ -688,6 +784,8 @@ void init_mod_input_segd_( csParamManager* param, csInitPhaseEnv* env, csLogWrit
     vars->segdReader->retrieveChanSetInfo( vars->chanSetIndexToRead, info );   // -1 to convert to C-style index
     shdr->sampleInt  = info.sampleInt_us / 1000.0;
     shdr->numSamples = info.numSamples;
+    // Trace header dump requires sequential trace retrieval from reader
+    vars->useChanSetGather = !vars->dumpTrcHeaders;
   }
 
   log->line("");
@@ -696,6 +794,28 @@ void init_mod_input_segd_( csParamManager* param, csInitPhaseEnv* env, csLogWrit
   log->line("  Number of samples:     %d", shdr->numSamples);
   log->line("");
 
+  //----------------------------------------------------
+  // Start reading ahead subsequent input files
+  //
+  if( vars->numFilesAhead > 0 && vars->numFiles > 1 ) {
+    if( numThreads == 0 ) numThreads = csThreadPool::numProcessors();
+    numThreads = MIN( numThreads, MIN( vars->numFilesAhead, vars->numFiles-1 ) );
+    try {
+      vars->threadPool = new csThreadPool( numThreads );
+    }
+    catch( csException& e ) {
+      log->error("Error when starting file read-ahead threads.\nSystem message: %s", e.getMessage() );
+    }
+    vars->loaders = new SegdFileLoader*[vars->numFiles];
+    for( int i = 0; i < vars->numFiles; i++ ) {
+      vars->loaders[i] = NULL;
+    }
+    vars->nextFileToLoad = 1;
+    submitFileLoaders( vars );
+    log->line("  Read ahead %d files using %d threads", vars->numFilesAhead, vars->threadPool->numThreads() );
+    log->line("");
+  }
+
   vars->totalTraceCounter = 0;
   vars->traceCounter      = 0;
   vars->recordCounter     = 0;
@@ -720,10 +840,30 @@ bool exec_mod_input_segd_(
 
 
   if( edef->isCleanup() ){
+    if( vars->threadPool != NULL ) {
+      vars->threadPool->waitAll();
+      delete vars->threadPool;
+      vars->threadPool = NULL;
+    }
+    if( vars->loaders != NULL ) {
+      for( int i = 0; i < vars->numFiles; i++ ) {
+        if( vars->loaders[i] != NULL ) delete vars->loaders[i];
+      }
+      delete [] vars->loaders;
+      vars->loaders = NULL;
+    }
     if( vars->hdrId_extra ) {
       delete [] vars->hdrId_extra;
       vars->hdrId_extra = NULL;
     }
+    if( vars->chanSetSamples != NULL ) {
+      delete [] vars->chanSetSamples;
+      vars->chanSetSamples = NULL;
+    }
+    if( vars->chanSetTrcHdrs != NULL ) {
+      delete [] vars->chanSetTrcHdrs;
+      vars->chanSetTrcHdrs = NULL;
+    }
     if( vars->segdReader != NULL ) {
       delete vars->segdReader;
     }
@@ -786,22 +926,43 @@ bool exec_mod_input_segd_(
   //  float* buffer = new float[4*trace->numSamples()];
 
 
-  while( !vars->segdReader->getNextTrace( samples, comTrcHdr ) ) {
+  while( !getNextTrace( vars, samples, shdr->numSamples, comTrcHdr ) ) {
     try {
       if( edef->isDebug() ) log->write("Read next record... #%d", (vars->recordCounter+1) );
       cseis_segd::commonRecordHeaderStruct newComRecordHdr;
       bool isSuccess = vars->segdReader->readNextRecord( newComRecordHdr );
       while( !isSuccess && vars->currentFile < vars->numFiles-1 ) {
         vars->currentFile += 1;
-        vars->segdReader->open( vars->filenames[vars->currentFile] );
-        vars->segdReader->readNewRecordHeaders();
-        isSuccess = true;
-        if( vars->chanSetIndexToRead >= 0 ) vars->segdReader->setChanSetToRead( vars->chanSetIndexToRead );
-        isSuccess = vars->segdReader->readNextRecord( newComRecordHdr );
+        if( vars->threadPool != NULL ) {
+          // File has been read ahead of time: Swap in reader object from loader
+          SegdFileLoader* loader = vars->loaders[vars->currentFile];
+          vars->threadPool->wait( loader );
+          vars->loaders[vars->currentFile] = NULL;
+          submitFileLoaders( vars );
+          if( loader->hasError() ) {
+            csException e( "Error when opening SEGD file '%s'.\nSystem message: %s", vars->filenames[vars->currentFile], loader->errorMessage() );
+            delete loader;
+            throw( e );
+          }
+          delete vars->segdReader;
+          vars->segdReader = loader->releaseReader();
+          vars->comFileHdr = vars->segdReader->getCommonFileHeaders();
+          isSuccess = loader->isSuccess;
+          newComRecordHdr = loader->comRecordHdr;
+          delete loader;
+        }
+        else {
+          vars->segdReader->open( vars->filenames[vars->currentFile] );
+          vars->segdReader->readNewRecordHeaders();
+          isSuccess = true;
+          if( vars->chanSetIndexToRead >= 0 ) vars->segdReader->setChanSetToRead( vars->chanSetIndexToRead );
+          isSuccess = vars->segdReader->readNextRecord( newComRecordHdr );
+        }
         if( !isSuccess ) log->warning("INPUT_SEGD: Cannot read in first record form file %s", vars->filenames[vars->currentFile]);
       }
       if( isSuccess ) {
         vars->comRecordHdr = newComRecordHdr;
+        vars->chanSetNumTraces = -1;
         vars->recordCounter += 1;
         vars->traceCounter = 0;
         if( edef->isDebug() ) log->line(", ...read file number (total traces so far): %d (%ld)", vars->comRecordHdr.fileNum, vars->totalTraceCounter );
@@ -928,6 +1089,51 @@ bool exec_mod_input_segd_(
   
 }
 
+//--------------------------------------------------------------------------------
+// Submit file loaders until the requested number of files are being read ahead of the current file
+//
+void submitFileLoaders( VariableStruct* vars ) {
+  while( vars->nextFileToLoad < vars->numFiles && vars->nextFileToLoad <= vars->currentFile + vars->numFilesAhead ) {
+    SegdFileLoader* loader = new SegdFileLoader( vars->filenames[vars->nextFileToLoad], vars->config, vars->chanSetIndexToRead );
+    vars->loaders[vars->nextFileToLoad] = loader;
+    vars->threadPool->submit( loader );
+    vars->nextFileToLoad += 1;
+  }
+}
+//--------------------------------------------------------------------------------
+// Retrieve next trace of current record
+// If only one channel set is read in, the whole channel set is decoded on the first call for each record.
+// Subsequent traces are then copied from the decoded channel set gather.
+// @return false if no further trace is found in current record
+//
+bool getNextTrace( VariableStruct* vars, float* samples, int numSamplesOut, cseis_segd::commonTraceHeaderStruct& comTrcHdr ) {
+  if( !vars->useChanSetGather ) {
+    return vars->segdReader->getNextTrace( samples, comTrcHdr );
+  }
+  if( vars->chanSetNumTraces < 0 ) {
+    cseis_segd::commonChanSetStruct info;
+    vars->segdReader->retrieveChanSetInfo( vars->chanSetIndexToRead, info );
+    if( info.numChannels > vars->chanSetMaxChannels || info.numSamples > vars->chanSetMaxSamples ) {
+      if( vars->chanSetSamples != NULL ) delete [] vars->chanSetSamples;
+      if( vars->chanSetTrcHdrs != NULL ) delete [] vars->chanSetTrcHdrs;
+      vars->chanSetMaxChannels = MAX( info.numChannels, vars->chanSetMaxChannels );
+      vars->chanSetMaxSamples  = MAX( info.numSamples, vars->chanSetMaxSamples );
+      vars->chanSetSamples = new float[(size_t)vars->chanSetMaxChannels * (size_t)vars->chanSetMaxSamples];
+      vars->chanSetTrcHdrs = new cseis_segd::commonTraceHeaderStruct[vars->chanSetMaxChannels];
+    }
+    vars->chanSetNumSamples = info.numSamples;
+    vars->chanSetNumTraces  = vars->segdReader->getChanSetGather( vars->chanSetIndexToRead, vars->chanSetSamples, vars->chanSetTrcHdrs );
+    vars->chanSetTraceIndex = 0;
+  }
+  if( vars->chanSetTraceIndex >= vars->chanSetNumTraces ) {
+    return false;
+  }
+  int itrc = vars->chanSetTraceIndex++;
+  comTrcHdr = vars->chanSetTrcHdrs[itrc];
+  memcpy( samples, &vars->chanSetSamples[(size_t)itrc * (size_t)vars->chanSetNumSamples], MIN( comTrcHdr.numSamples, numSamplesOut ) * sizeof(float) );
+  return true;
+}
+
 //********************************************************************************
 // Parameter definition
 //
@@ -953,6 +1159,11 @@ void params_mod_input_segd_( csParamDef* pdef ) {
   pdef->addOption( "no", "Do not search subdirectories" );
   pdef->addOption( "yes", "Also search subdirectories for files" );
 
+  pdef->addParam( "prefetch", "Read input files ahead of time in parallel threads", NUM_VALUES_VARIABLE,
+                  "Worker threads open the next files, read in file headers and the first record while previous files are being processed. Files are always delivered in input order. Only one record per read-ahead file is held in memory. Useful when reading many small files, for example when reading a whole directory." );
+  pdef->addValue( "0", VALTYPE_NUMBER, "Number of files to read ahead of current file (0: Read files sequentially)" );
+  pdef->addValue( "0", VALTYPE_NUMBER, "Number of threads (0: Use number of processors, but not more than number of files to read ahead)" );
+
   pdef->addParam( "dump_filename", "Dump file name", NUM_VALUES_FIXED );
   pdef->addValue( "", VALTYPE_STRING, "Dump file name including full path name" );
 
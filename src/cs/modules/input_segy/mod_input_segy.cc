@@ -16,12 +16,66 @@
 #include "csGeolibUtils.h"
 #include "csIOSelection.h"
 #include "csSortManager.h"
+#include "csThreadPool.h"
  
 using namespace cseis_system;
 using namespace cseis_geolib;
 using namespace std;
  
 namespace mod_input_segy {
+  /**
+   * Opens SEGY file, reads in char & bin headers and sets up trace selection.
+   * Executed in worker thread when files are read ahead of time.
+   */
+  class SegyFileLoader : public csRunnable {
+  public:
+    SegyFileLoader( char const* filename, csSegyReader::SegyReaderConfig const& config, csSegyHdrMap const* hdrMap ) :
+      myConfig( config ) {
+      myFilename = filename;
+      myHdrMap   = hdrMap;
+      myReader   = NULL;
+      myIsHdrSelection = false;
+      isSelectionSuccess = true;
+    }
+    ~SegyFileLoader() {
+      if( myReader != NULL ) {
+        delete myReader;
+        myReader = NULL;
+      }
+    }
+    void setSelection( std::string const& selectionText, std::string const& selectionHdrName, int sortOrder, int sortMethod ) {
+      myIsHdrSelection = true;
+      mySelectionText  = selectionText;
+      mySelectionHdrName = selectionHdrName;
+      mySortOrder  = sortOrder;
+      mySortMethod = sortMethod;
+    }
+    virtual void run() {
+      myReader = new csSegyReader( myFilename, myConfig, myHdrMap );
+      if( myIsHdrSelection ) {
+        isSelectionSuccess = myReader->setSelection( mySelectionText, mySelectionHdrName, mySortOrder, mySortMethod );
+      }
+      myReader->initialize();
+    }
+    /// Hand over ownership of reader object to caller
+    csSegyReader* releaseReader() {
+      csSegyReader* reader = myReader;
+      myReader = NULL;
+      return reader;
+    }
+    bool isSelectionSuccess;
+  private:
+    char const* myFilename;
+    csSegyReader::SegyReaderConfig myConfig;
+    csSegyHdrMap const* myHdrMap;
+    csSegyReader* myReader;
+    bool myIsHdrSelection;
+    std::string mySelectionText;
+    std::string mySelectionHdrName;
+    int mySortOrder;
+    int mySortMethod;
+  };
+
   struct VariableStruct {
     long traceCounter;
     double startTimeUNIXsec;
@@ -61,11 +115,19 @@ namespace mod_input_segy {
     int sortMethod;
     std::string selectionText;
     std::string selectionHdrName;
+
+    csThreadPool* threadPool;
+    /// File loaders, one slot per input file. Non-NULL for files that are currently being read ahead
+    mod_input_segy::SegyFileLoader** loaders;
+    int numFilesAhead;
+    int nextFileToLoad;
   };
 }
 using mod_input_segy::VariableStruct;
+using mod_input_segy::SegyFileLoader;
  
 void dumpFileHeaders( csLogWriter* log, csSegyReader* reader, int hdr_mapping );
+void submitFileLoaders( VariableStruct* vars );
  
 //*************************************************************************************************
 // Init phase
@@ -127,6 +189,11 @@ void init_mod_input_segy_( csParamManager* param, csInitPhaseEnv* env, csLogWrit
   vars->selectionText = "";
   vars->selectionHdrName = "";
  
+  vars->threadPool     = NULL;
+  vars->loaders        = NULL;
+  vars->numFilesAhead  = 0;
+  vars->nextFileToLoad = 0;
+ 
   //------------------------------------------------
  
   std::string headerName;
@@ -260,6 +327,37 @@ void init_mod_input_segy_( csParamManager* param, csInitPhaseEnv* env, csLogWrit
   }
   log->line("");
  
+  int numThreads = 0;
+  if( param->exists("prefetch") ) {
+    param->getInt( "prefetch", &vars->numFilesAhead, 0 );
+    if( vars->numFilesAhead < 0 ) {
+      log->error("Number of files to read ahead must be >= 0. Specified: %d", vars->numFilesAhead );
+    }
+    if( param->getNumValues("prefetch") > 1 ) {
+      param->getInt( "prefetch", &numThreads, 1 );
+      if( numThreads < 0 ) log->error("Number of threads must be >= 0. Specified: %d", numThreads );
+    }
+  }
+ 
+  int numReadThreads = 1;
+  if( param->exists("nthreads") ) {
+    param->getInt( "nthreads", &numReadThreads );
+    if( numReadThreads < 0 ) log->error("Number of threads must be >= 0. Specified: %d", numReadThreads );
+  }
+  int partitionIndex = 0;
+  int numPartitions  = 1;
+  if( param->exists("partition") ) {
+    param->getInt( "partition", &partitionIndex, 0 );
+    param->getInt( "partition", &numPartitions, 1 );
+    if( numPartitions < 1 || partitionIndex < 1 || partitionIndex > numPartitions ) {
+      log->error("Incorrect partition: %d (number of partitions: %d). Partitions are numbered from 1 to the number of partitions", partitionIndex, numPartitions );
+    }
+    if( vars->isHdrSelection && numPartitions > 1 ) {
+      log->error("Reading file partitions cannot be combined with a trace selection ('select')");
+    }
+    partitionIndex -= 1;
+  }
+ 
   //----------------------------------------------------
  
   int numSamplesOut = 0;
@@ -600,6 +698,9 @@ void init_mod_input_segy_( csParamManager* param, csInitPhaseEnv* env, csLogWrit
   vars->config.overrideSampleFormat  = data_format;
   vars->config.isSUFormat            = isSUFormat;
   vars->config.enableRandomAccess    = vars->isHdrSelection;
+  vars->config.numThreads            = numReadThreads;
+  vars->config.partitionIndex        = partitionIndex;
+  vars->config.numPartitions         = numPartitions;
   try {
     vars->segyReader = new csSegyReader( vars->filenames[vars->currentFile], vars->config, vars->hdrMap );
   }
@@ -778,6 +879,27 @@ void init_mod_input_segy_( csParamManager* param, csInitPhaseEnv* env, csLogWrit
     log->line( "... %d trace headers\n", nHeaders );
     vars->segyReader->getTrcHdrMap()->dump( log->getFile() );
   }
+ 
+  //----------------------------------------------------
+  // Start reading ahead subsequent input files
+  //
+  if( vars->numFilesAhead > 0 && vars->numFiles > 1 ) {
+    if( numThreads == 0 ) numThreads = csThreadPool::numProcessors();
+    numThreads = MIN( numThreads, MIN( vars->numFilesAhead, vars->numFiles-1 ) );
+    try {
+      vars->threadPool = new csThreadPool( numThreads );
+    }
+    catch( csException& e ) {
+      log->error("Error when starting file read-ahead threads.\nSystem message: %s", e.getMessage() );
+    }
+    vars->loaders = new SegyFileLoader*[vars->numFiles];
+    for( int i = 0; i < vars->numFiles; i++ ) {
+      vars->loaders[i] = NULL;
+    }
+    vars->nextFileToLoad = vars->currentFile + 1;
+    submitFileLoaders( vars );
+    log->line("\nRead ahead %d files using %d threads", vars->numFilesAhead, vars->threadPool->numThreads() );
+  }
 }
  
 //*************************************************************************************************
@@ -796,6 +918,18 @@ bool exec_mod_input_segy_(
   csExecPhaseDef*         edef = env->execPhaseDef;
  
   if( edef->isCleanup() ) {
+    if( vars->threadPool != NULL ) {
+      vars->threadPool->waitAll();
+      delete vars->threadPool;
+      vars->threadPool = NULL;
+    }
+    if( vars->loaders != NULL ) {
+      for( int i = 0; i < vars->numFiles; i++ ) {
+        if( vars->loaders[i] != NULL ) delete vars->loaders[i];
+      }
+      delete [] vars->loaders;
+      vars->loaders = NULL;
+    }
     if( vars->segyReader != NULL ) {
       delete vars->segyReader;
       vars->segyReader = NULL;
@@ -843,19 +977,40 @@ bool exec_mod_input_segy_(
     delete vars->segyReader;
     vars->segyReader = NULL;
  
-    try {
-      vars->segyReader = new csSegyReader( vars->filenames[vars->currentFile], vars->config, vars->hdrMap );
-      if( vars->isHdrSelection ) {
-        bool success = vars->segyReader->setSelection( vars->selectionText, vars->selectionHdrName, vars->sortOrder, vars->sortMethod );
-        if( !success ) {
-          log->error("Error occurred when intializing header selection for input file '%s'.\n --> No input traces found that match specified selection '%s' for header '%s'.\n",
-                     vars->filenames[vars->currentFile], vars->selectionText.c_str(), vars->selectionHdrName.c_str() );
-        }
+    if( vars->threadPool != NULL ) {
+      // File has been read ahead of time: Take over reader object from loader
+      SegyFileLoader* loader = vars->loaders[vars->currentFile];
+      vars->threadPool->wait( loader );
+      vars->loaders[vars->currentFile] = NULL;
+      submitFileLoaders( vars );
+      bool isSelectionSuccess = loader->isSelectionSuccess;
+      if( loader->hasError() ) {
+        std::string message = loader->errorMessage();
+        delete loader;
+        log->error("Error when opening SEGY file '%s'.\nSystem message: %s", vars->filenames[vars->currentFile], message.c_str() );
+      }
+      vars->segyReader = loader->releaseReader();
+      delete loader;
+      if( !isSelectionSuccess ) {
+        log->error("Error occurred when intializing header selection for input file '%s'.\n --> No input traces found that match specified selection '%s' for header '%s'.\n",
+                   vars->filenames[vars->currentFile], vars->selectionText.c_str(), vars->selectionHdrName.c_str() );
       }
     }
-    catch( csException& e ) {
-      vars->segyReader = NULL;
-      log->error("Error when opening SEGY file '%s'.\nSystem message: %s", vars->filenames[vars->currentFile], e.getMessage() );
+    else {
+      try {
+        vars->segyReader = new csSegyReader( vars->filenames[vars->currentFile], vars->config, vars->hdrMap );
+        if( vars->isHdrSelection ) {
+          bool success = vars->segyReader->setSelection( vars->selectionText, vars->selectionHdrName, vars->sortOrder, vars->sortMethod );
+          if( !success ) {
+            log->error("Error occurred when intializing header selection for input file '%s'.\n --> No input traces found that match specified selection '%s' for header '%s'.\n",
+                       vars->filenames[vars->currentFile], vars->selectionText.c_str(), vars->selectionHdrName.c_str() );
+          }
+        }
+      }
+      catch( csException& e ) {
+        vars->segyReader = NULL;
+        log->error("Error when opening SEGY file '%s'.\nSystem message: %s", vars->filenames[vars->currentFile], e.getMessage() );
+      }
     }
     try {
       vars->segyReader->initialize();
@@ -959,6 +1114,20 @@ bool exec_mod_input_segy_(
   }
   return true;
 }
+//--------------------------------------------------------------------------------
+// Submit file loaders until the requested number of files are being read ahead of the current file
+//
+void submitFileLoaders( VariableStruct* vars ) {
+  while( vars->nextFileToLoad < vars->numFiles && vars->nextFileToLoad <= vars->currentFile + vars->numFilesAhead ) {
+    SegyFileLoader* loader = new SegyFileLoader( vars->filenames[vars->nextFileToLoad], vars->config, vars->hdrMap );
+    if( vars->isHdrSelection ) {
+      loader->setSelection( vars->selectionText, vars->selectionHdrName, vars->sortOrder, vars->sortMethod );
+    }
+    vars->loaders[vars->nextFileToLoad] = loader;
+    vars->threadPool->submit( loader );
+    vars->nextFileToLoad += 1;
+  }
+}
 //********************************************************************************
 // Parameter definition
 //
@@ -985,6 +1154,20 @@ void params_mod_input_segy_( csParamDef* pdef ) {
   pdef->addOption( "no", "Do not search subdirectories" );
   pdef->addOption( "yes", "Also search subdirectories for files" );
  
+  pdef->addParam( "prefetch", "Read input files ahead of time in parallel threads", NUM_VALUES_VARIABLE,
+                  "Worker threads open the next files, read in char & bin headers and set up the trace selection while previous files are being processed. Files are always delivered in input order. Useful when reading many small files, for example when reading a whole directory." );
+  pdef->addValue( "0", VALTYPE_NUMBER, "Number of files to read ahead of current file (0: Read files sequentially)" );
+  pdef->addValue( "0", VALTYPE_NUMBER, "Number of threads (0: Use number of processors, but not more than number of files to read ahead)" );
+ 
+  pdef->addParam( "nthreads", "Number of threads reading trace blocks of the current input file", NUM_VALUES_FIXED,
+                  "Worker threads read blocks of 'ntraces_buffer' traces (default: 8MB) ahead of time, each through its own file handle, and convert the sample values. Traces are always delivered in file order. Not used for trace selections, P-SEGY and 16bit integer data" );
+  pdef->addValue( "1", VALTYPE_NUMBER, "Number of threads (1: Read sequentially, 0: Use number of processors)" );
+ 
+  pdef->addParam( "partition", "Read only one partition of each input file", NUM_VALUES_FIXED,
+                  "The traces of each input file are split into the given number of consecutive ranges of equal size. Only the traces of the specified partition are read in. Use this to process one file in several independent flows, each reading a different partition" );
+  pdef->addValue( "1", VALTYPE_NUMBER, "Partition to read in (1: first partition)" );
+  pdef->addValue( "1", VALTYPE_NUMBER, "Number of partitions" );
+ 
   pdef->addParam( "nsamples", "Number of samples to read in", NUM_VALUES_VARIABLE,
                   "If number of samples in input data set is smaller, traces will be filled with zeros. Set 0 to set number of samples from input data set.");
   pdef->addValue( "0", VALTYPE_NUMBER, "Number of samples to read in" );
@@ -230,6 +230,13 @@ void init_mod_nmo_( csParamManager* param, csInitPhaseEnv* env, csLogWriter* log
     vars->table->addValue( colVel-1 );  // -1 to convert from 'user' column to 'C++' column
     if( colEta > 0 ) vars->table->addValue( colEta-1 );
 
+    if( param->exists("table_cache") ) {
+      int cacheSize = 0;
+      param->getInt("table_cache", &cacheSize );
+      if( cacheSize < 0 ) log->error("Number of cached velocity functions (user parameter 'table_cache') must not be negative");
+      vars->table->setFunctionCacheSize( cacheSize );
+    }
+
     bool sortTable = false;
     try {
       vars->table->initialize( tableFilename, sortTable );
@@ -364,6 +371,7 @@ bool exec_mod_nmo_( csTrace* trace, int* port, csExecPhaseEnv* env, csLogWriter*
       vars->nmo = NULL;
     }
     if( vars->table != NULL ) {
+      log->line("Velocity table function cache: %ld hits, %ld misses", vars->table->numFunctionCacheHits(), vars->table->numFunctionCacheMisses() );
       delete vars->table;
       vars->table = NULL;
     }
@@ -473,6 +481,10 @@ void params_mod_nmo_( csParamDef* pdef ) {
   pdef->addOption( "yes", "Use this key for interpolation of value" );
   pdef->addOption( "no", "Do not use this key for interpolation", "The input table is expected to contain the exact key values for this trace header" );
 
+  pdef->addParam( "table_cache", "Number of interpolated velocity functions kept in cache", NUM_VALUES_FIXED,
+                  "Consecutive traces at the same table key location reuse the cached velocity function instead of interpolating it again" );
+  pdef->addValue( "16", VALTYPE_NUMBER, "Number of cached velocity functions. Set to 0 to disable caching" );
+
   pdef->addParam( "mode", "Mode of NMO application", NUM_VALUES_FIXED );
   pdef->addValue( "apply", VALTYPE_OPTION );
   pdef->addOption( "apply", "Apply NMO." );
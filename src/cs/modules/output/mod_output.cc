@@ -4,6 +4,8 @@
 #include "cseis_includes.h"
 #include "csIODefines.h"
 #include "csSeismicWriter.h"
+#include "csSeismicBlockCodec.h"
+#include "csOverviewWriter.h"
 #include "csTimer.h"
 #include "csFileUtils.h"
 
@@ -26,6 +28,14 @@ namespace mod_output {
     bool isFirstCall;
     int numTracesBuffer;
     int sampleByteSize; //, doOverwrite
+    /// Block format only: Sample codec, or -1 if standard (non-block) format shall be written
+    int codec;
+    float tolerance;
+    int numThreads;
+    bool writeHeaderColumns;
+    /// Number of overview levels, 0 if no overview file shall be written
+    int numOverviewLevels;
+    int overviewFactor;
   };
 }
 using namespace mod_output;
@@ -51,6 +61,12 @@ void init_mod_output_( csParamManager* param, csInitPhaseEnv* env, csLogWriter*
   vars->nTracesOut = 0;
   vars->numTracesBuffer = 20;
   vars->sampleByteSize = 4;
+  vars->codec       = -1;
+  vars->tolerance   = 0.0f;
+  vars->numThreads  = 0;
+  vars->writeHeaderColumns = false;
+  vars->numOverviewLevels  = 0;
+  vars->overviewFactor     = 2;
   vars->isFirstCall = true;
 
   bool doOverwrite = true;
@@ -81,6 +97,19 @@ void init_mod_output_( csParamManager* param, csInitPhaseEnv* env, csLogWriter*
     else if( !text.compare("8bit") ) { 
       vars->sampleByteSize = 1;
     }
+    else if( !text.compare("lossless") ) { 
+      vars->codec = cseis_io::csSeismicBlockCodec::CODEC_LOSSLESS;
+    }
+    else if( !text.compare("lossy") ) { 
+      vars->codec = cseis_io::csSeismicBlockCodec::CODEC_LOSSY;
+      if( param->getNumValues("compress") < 2 ) {
+        log->error("Compression option 'lossy' requires the maximum sample error to be specified as second value");
+      }
+      param->getFloat("compress", &vars->tolerance, 1);
+      if( vars->tolerance <= 0.0f ) {
+        log->error("Maximum sample error for lossy compression must be larger than zero. Specified: %f", vars->tolerance);
+      }
+    }
     else {
       log->line("Unknown option for user parameter compress: '%s'", text.c_str());
       env->addError();
@@ -104,6 +133,51 @@ void init_mod_output_( csParamManager* param, csInitPhaseEnv* env, csLogWriter*
       vars->numTracesBuffer = 1;
     }
   }
+  else if( vars->codec >= 0 ) {
+    vars->numTracesBuffer = 0;  // Block format: Use default block size
+  }
+
+  if( param->exists("header_columns") ) {
+    std::string text;
+    param->getString("header_columns", &text);
+    if( !text.compare("yes") ) {
+      vars->writeHeaderColumns = true;
+    }
+    else if( !text.compare("no") ) { 
+      vars->writeHeaderColumns = false;
+    }
+    else {
+      log->line("Unknown option for user parameter header_columns: '%s'", text.c_str());
+      env->addError();
+    }
+  }
+
+  if( param->exists("overview") ) {
+    param->getInt( "overview", &vars->numOverviewLevels );
+    if( param->getNumValues("overview") > 1 ) {
+      param->getInt( "overview", &vars->overviewFactor, 1 );
+    }
+    if( vars->numOverviewLevels < 0 ) {
+      log->error("Number of overview levels must be positive, or 0 for no overview file. Specified: %d", vars->numOverviewLevels);
+    }
+    if( vars->overviewFactor < 2 ) {
+      log->error("Overview decimation factor must be at least 2. Specified: %d", vars->overviewFactor);
+    }
+    int decimation = 1;
+    for( int level = 0; level < vars->numOverviewLevels; level++ ) {
+      if( decimation > cseis_io::csOverviewWriter::MAX_DECIMATION / vars->overviewFactor ) {
+        log->error("Decimation of coarsest overview level exceeds %d. Reduce number of levels or decimation factor", cseis_io::csOverviewWriter::MAX_DECIMATION);
+      }
+      decimation *= vars->overviewFactor;
+    }
+  }
+
+  if( param->exists( "nthreads" ) ) {
+    param->getInt( "nthreads", &vars->numThreads );
+    if( vars->numThreads < 0 ) {
+      log->error("Number of threads must be positive, or 0 for number of processors. Specified: %d", vars->numThreads);
+    }
+  }
 
   if( !doOverwrite && csFileUtils::fileExists( vars->filename ) ) {
     log->error("File %s already exists but user parameter set to 'overwrite no'.", vars->filename.c_str() );
@@ -116,6 +190,15 @@ void init_mod_output_( csParamManager* param, csInitPhaseEnv* env, csLogWriter*
   log->line("  File name:             %s", vars->filename.c_str());
   log->line("  Sample interval [ms]:  %f", shdr->sampleInt);
   log->line("  Number of samples:     %d", shdr->numSamples);
+  if( vars->codec == cseis_io::csSeismicBlockCodec::CODEC_LOSSLESS ) {
+    log->line("  Block format, lossless compression");
+  }
+  else if( vars->codec == cseis_io::csSeismicBlockCodec::CODEC_LOSSY ) {
+    log->line("  Block format, lossy compression, maximum sample error: %g", vars->tolerance);
+  }
+  if( vars->numOverviewLevels > 0 ) {
+    log->line("  Overview levels:       %d, decimation factor %d per level", vars->numOverviewLevels, vars->overviewFactor);
+  }
   log->line("");
 
   vars->nTracesOut = 0;
@@ -138,18 +221,35 @@ bool exec_mod_output_(
   csTraceHeaderDef const* hdef = env->headerDef;
 
   if( edef->isCleanup() ) {
+    std::string errorMessage = "";
     if( vars->writer != NULL ) {
+      try {
+        vars->writer->close();
+      }
+      catch( csException& e ) {
+        errorMessage = e.getMessage();
+      }
       delete vars->writer;
       vars->writer = NULL;
     }
     delete vars; vars = NULL;
+    if( errorMessage.length() > 0 ) {
+      log->error("Error when closing SeaSeis output file.\nSystem message: %s", errorMessage.c_str() );
+    }
     return true;
   }
 
   if( vars->isFirstCall ) {
     vars->isFirstCall = false;
     try {
-      vars->writer = new csSeismicWriter( vars->filename, vars->numTracesBuffer, vars->sampleByteSize, true );
+      if( vars->codec >= 0 ) {
+        vars->writer = new csSeismicWriter( vars->filename, vars->numTracesBuffer, vars->codec, vars->tolerance, vars->numThreads, true );
+      }
+      else {
+        vars->writer = new csSeismicWriter( vars->filename, vars->numTracesBuffer, vars->sampleByteSize, true );
+      }
+      if( vars->writeHeaderColumns ) vars->writer->enableHeaderColumns();
+      if( vars->numOverviewLevels > 0 ) vars->writer->enableOverviews( vars->numOverviewLevels, vars->overviewFactor );
     }
     catch( csException& exc ) {
       log->error("Error occurred when opening SeaSeis file. System message:\n%s", exc.getMessage() );
@@ -201,12 +301,31 @@ void params_mod_output_( csParamDef* pdef ) {
   pdef->addOption( "no", "Do not overwrite file if it already exists");
 
 
-  pdef->addParam( "compress", "Compress data before output?", NUM_VALUES_FIXED );
+  pdef->addParam( "compress", "Compress data before output?", NUM_VALUES_VARIABLE,
+                  "Options 'lossless' and 'lossy' write the SeaSeis block format (version 0.5), with trace blocks compressed in parallel and a block directory for fast random access" );
   pdef->addValue( "no", VALTYPE_OPTION );
   pdef->addOption( "no", "No compression. Save data samples as 32bit floating point" );
   pdef->addOption( "32bit", "No compression. Same as option 'no'");
   pdef->addOption( "16bit", "Compress data samples to 16bit");
   pdef->addOption( "8bit", "Compress data samples to 8bit");
+  pdef->addOption( "lossless", "Block format, lossless compression of data samples and trace headers");
+  pdef->addOption( "lossy", "Block format, lossy compression of data samples with bounded error. Trace headers are compressed losslessly",
+                   "Specify maximum absolute sample error as second value" );
+  pdef->addValue( "", VALTYPE_NUMBER, "Maximum absolute sample error, for option 'lossy'" );
+
+  pdef->addParam( "header_columns", "Write trace headers also into column-wise header file?", NUM_VALUES_FIXED,
+                  "The header column file '<filename>.hdrcol' is written next to the output file. It speeds up header selection and sorting in INPUT, and other header-only access" );
+  pdef->addValue( "no", VALTYPE_OPTION );
+  pdef->addOption( "no", "Do not write header column file" );
+  pdef->addOption( "yes", "Write header column file" );
+
+  pdef->addParam( "overview", "Write decimated overview file for fast zoomed-out display?", NUM_VALUES_VARIABLE,
+                  "The overview file '<filename>.ovr' is written next to the output file. Each overview level decimates traces and samples by the given factor with respect to the previous level, storing the minimum, maximum and RMS amplitude of each decimated bin" );
+  pdef->addValue( "0", VALTYPE_NUMBER, "Number of overview levels. 0: Do not write overview file" );
+  pdef->addValue( "2", VALTYPE_NUMBER, "Decimation factor from one level to the next, for both traces and samples" );
+
+  pdef->addParam( "nthreads", "Number of threads used to compress trace blocks (block format only)", NUM_VALUES_FIXED );
+  pdef->addValue( "0", VALTYPE_NUMBER, "Number of threads. 0: Use number of processors" );
 }
 
 extern "C" void _params_mod_output_( csParamDef* pdef ) {
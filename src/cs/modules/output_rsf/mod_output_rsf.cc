@@ -145,26 +145,23 @@ void init_mod_output_rsf_( csParamManager* param, csInitPhaseEnv* env, csLogWrit
 
   cseis_io::csRSFHeader rsfHdr;
 
-  /*
-  param->getInt( "dim2", &rsfHdr.n2, 0 );
-  param->getDouble( "dim2", &rsfHdr.o2, 1 );
-  param->getDouble( "dim2", &rsfHdr.d2, 2 );
-  if( param->getNumValues( "dim2" ) > 3 ) {
-    param->getDouble( "dim2", &rsfHdr.e2, 3 );
-  }
-  else {
+  // Output grid defined in advance: Traces are written to memory mapped file, in any order
+  if( param->exists("dim2") || param->exists("dim3") ) {
+    if( !param->exists("dim2") || !param->exists("dim3") ) {
+      log->error("Both dimension 2 and dimension 3 need to be defined");
+    }
+    param->getInt( "dim2", &rsfHdr.n2, 0 );
+    param->getDouble( "dim2", &rsfHdr.o2, 1 );
+    param->getDouble( "dim2", &rsfHdr.d2, 2 );
     rsfHdr.e2 = rsfHdr.o2 + rsfHdr.d2 * (rsfHdr.n2-1);
-  }
-  param->getInt( "dim3", &rsfHdr.n3, 0 );
-  param->getDouble( "dim3", &rsfHdr.o3, 1 );
-  param->getDouble( "dim3", &rsfHdr.d3, 2 );
-  if( param->getNumValues( "dim3" ) > 3 ) {
-    param->getDouble( "dim3", &rsfHdr.e3, 3 );
-  }
-  else {
+    param->getInt( "dim3", &rsfHdr.n3, 0 );
+    param->getDouble( "dim3", &rsfHdr.o3, 1 );
+    param->getDouble( "dim3", &rsfHdr.d3, 2 );
     rsfHdr.e3 = rsfHdr.o3 + rsfHdr.d3 * (rsfHdr.n3-1);
+    if( rsfHdr.n2 <= 0 || rsfHdr.n3 <= 0 ) {
+      log->error("Inconsistent number of traces specified for dimension 2/3: %d/%d", rsfHdr.n2, rsfHdr.n3);
+    }
   }
-  */
 
   rsfHdr.n1 = shdr->numSamples;
   rsfHdr.o1 = 0;
@@ -256,6 +253,10 @@ void init_mod_output_rsf_( csParamManager* param, csInitPhaseEnv* env, csLogWrit
   log->line("  Sample interval [ms]: %f", shdr->sampleInt);
   log->line("  Number of samples:    %d", shdr->numSamples );
   log->line("  Sample data format:   %d", rsfHdr.data_format );
+  if( vars->rsfWriter->isMapped() ) {
+    log->line("  Output grid:          dim2: %d x %f (origin %f), dim3: %d x %f (origin %f)",
+              rsfHdr.n2, rsfHdr.d2, rsfHdr.o2, rsfHdr.n3, rsfHdr.d3, rsfHdr.o3 );
+  }
   log->line("");
 
   vars->traceCounter = 0;
@@ -277,12 +278,22 @@ bool exec_mod_output_rsf_(
   //  csSuperHeader const* shdr = env->superHeader;
 
   if( edef->isCleanup() ) {
+    std::string errorMessage = "";
     if( vars->rsfWriter != NULL ) {
-      vars->rsfWriter->finalize();
+      try {
+        vars->rsfWriter->closeFile();
+        vars->rsfWriter->finalize();
+      }
+      catch( csException& e ) {
+        errorMessage = e.getMessage();
+      }
       delete vars->rsfWriter;
       vars->rsfWriter = NULL;
     }
     delete vars; vars = NULL;
+    if( errorMessage.length() > 0 ) {
+      log->error("Error when closing RSF output file.\nSystem message: %s", errorMessage.c_str() );
+    }
     return true;
   }
   
@@ -331,19 +342,16 @@ void params_mod_output_rsf_( csParamDef* pdef ) {
   pdef->addParam( "hdr_dim3", "Trace header defining dimension 3", NUM_VALUES_FIXED, "dimension 3 is the 'slowest' dimension." );
   pdef->addValue( "", VALTYPE_STRING, "Name of trace header defining dimension 3" );
 
-  /*
-  pdef->addParam( "dim2", "Dimension 2 definition", NUM_VALUES_VARIABLE );
+  pdef->addParam( "dim2", "Dimension 2 definition", NUM_VALUES_FIXED,
+                  "If dimensions 2 and 3 are defined, the output file is memory mapped and every trace is written to the position given by its dimension 2 and 3 header values. Input traces may then come in any order, for example inline or crossline sections. Grid positions without input trace are set to zero." );
   pdef->addValue( "", VALTYPE_NUMBER, "n2: Number of traces in dimension 2" );
   pdef->addValue( "", VALTYPE_NUMBER, "o2: Dimension 2 origin" );
   pdef->addValue( "", VALTYPE_NUMBER, "d2: Dimension 2 step/increment" );
-  pdef->addValue( "", VALTYPE_NUMBER, "e2: Dimension 2 last coordinate" );
 
-  pdef->addParam( "dim3", "Dimension 3 definition", NUM_VALUES_VARIABLE );
+  pdef->addParam( "dim3", "Dimension 3 definition", NUM_VALUES_FIXED );
   pdef->addValue( "", VALTYPE_NUMBER, "n3: Number of traces in dimension 3" );
   pdef->addValue( "", VALTYPE_NUMBER, "o3: Dimension 3 origin" );
   pdef->addValue( "", VALTYPE_NUMBER, "d3: Dimension 3 step/increment" );
-  pdef->addValue( "", VALTYPE_NUMBER, "e3: Dimension 3 last coordinate" );
-  */
 
   pdef->addParam( "world_p1", "Grid definition: World point 1", NUM_VALUES_FIXED );
   pdef->addValue( "", VALTYPE_NUMBER, "X coordinate" );
@@ -70,6 +70,7 @@ void init_mod_output_segy_( csParamManager* param, csInitPhaseEnv* env, csLogWri
   std::string yesno;
   std::string filename;
   int numTracesBuffer;
+  int numThreads = 1;
 
   bool doForce = false;
   if( param->exists("force") ) {
@@ -308,10 +309,17 @@ void init_mod_output_segy_( csParamManager* param, csInitPhaseEnv* env, csLogWri
     numTracesBuffer = 20;
   }
 
+  if( param->exists( "nthreads" ) ) {
+    param->getInt( "nthreads", &numThreads );
+    if( numThreads < 0 ) {
+      log->error("Number of threads must be positive, or 0 for number of processors. Specified: %d", numThreads);
+    }
+  }
+
   //----------------------------------------------------
   //
   try {
-    vars->segyWriter = new csSegyWriter( filename, numTracesBuffer, rev_byte_order, autoscale_hdrs, isSUFormat );
+    vars->segyWriter = new csSegyWriter( filename, numTracesBuffer, rev_byte_order, autoscale_hdrs, isSUFormat, numThreads );
   }
   catch( csException& e ) {
     vars->segyWriter = NULL;
@@ -675,13 +683,23 @@ bool exec_mod_output_segy_(
   csExecPhaseDef* edef = env->execPhaseDef;
 
   if( edef->isCleanup() ) {
+    std::string errorMessage;
     if( vars->segyWriter != NULL ) {
+      try {
+        vars->segyWriter->closeFile();
+      }
+      catch( csException& e ) {
+        errorMessage = e.getMessage();
+      }
       delete vars->segyWriter;
       vars->segyWriter = NULL;
     }
     delete [] vars->hdrIndexSegy; vars->hdrIndexSegy = NULL;
     delete [] vars->hdrTypeSegy; vars->hdrTypeSegy = NULL;
     delete vars; vars = NULL;
+    if( !errorMessage.empty() ) {
+      log->error("Error when closing SEGY output file.\nSystem message: %s", errorMessage.c_str() );
+    }
     return true;
   }
 
@@ -854,6 +872,10 @@ void params_mod_output_segy_( csParamDef* pdef ) {
                   "Writing a large number of traces at once enhances performance, but requires more memory" );
   pdef->addValue( "20", VALTYPE_NUMBER, "Number of traces to buffer before writing" );
 
+  pdef->addParam( "nthreads", "Number of threads used to convert and write buffered traces", NUM_VALUES_FIXED,
+                  "With more than one thread, each buffer of 'ntraces_buffer' traces is converted and written to its position in the output file by a worker thread, and the file is preallocated on disk. Use a large trace buffer (e.g. 1000 traces) for best performance. Not available on Windows." );
+  pdef->addValue( "1", VALTYPE_NUMBER, "Number of threads. 1: Write sequentially, 0: Use number of processors" );
+
   pdef->addParam( "sample_int", "Override output sample interval", NUM_VALUES_FIXED );
   pdef->addValue( "0.0", VALTYPE_NUMBER, "Sample interval [ms]" );
 
@@ -35,6 +35,8 @@ namespace mod_p190 {
     int hdrID_time_hour;
     int hdrID_time_min;
     int hdrID_time_sec;
+
+    int numTraces;
   };
 }
 using namespace mod_p190;
@@ -69,6 +71,7 @@ void init_mod_p190_( csParamManager* param, csInitPhaseEnv* env, csLogWriter* lo
   vars->hdrID_time_hour = -1;
   vars->hdrID_time_min = -1;
   vars->hdrID_time_sec = -1;
+  vars->numTraces = 0;
 
   //----------------------------------------------------
 
@@ -76,6 +79,11 @@ void init_mod_p190_( csParamManager* param, csInitPhaseEnv* env, csLogWriter* lo
 
   param->getString( "filename", &filename );
 
+  std::string cacheFilename = "";
+  if( param->exists("cache") ) {
+    param->getString( "cache", &cacheFilename );
+  }
+
   std::string text;
   if( param->exists("hdr_source") ) {
     param->getString( "hdr_source", &text );
@@ -102,7 +110,17 @@ void init_mod_p190_( csParamManager* param, csInitPhaseEnv* env, csLogWriter* lo
 
   try {
     vars->reader = new cseis_io::csP190Reader( filename );
-    vars->reader->initialize();
+    bool isCached = vars->reader->initialize( cacheFilename );
+    log->line("Number of sources in P1/90 file: %d%s", vars->reader->numSources(), isCached ? " (read in from cache file)" : "");
+    if( !isCached && !cacheFilename.empty() ) {
+      try {
+        vars->reader->writeCache( cacheFilename );
+        log->line("Source records written to cache file '%s'", cacheFilename.c_str());
+      }
+      catch( csException& e ) {
+        log->warning("%s", e.getMessage());
+      }
+    }
   }
   catch( csException e ) {
     log->error("Error occurred when opening file %s. System message:\n%s", filename.c_str(), e.getMessage() );
@@ -172,6 +190,7 @@ bool exec_mod_p190_(
 
   if( edef->isCleanup()){
     if( vars->reader ) {
+      log->line("Number of traces matched: %d. Number of times receiver records were read in: %d", vars->numTraces, vars->reader->numChannelReads());
       delete vars->reader;
       vars->reader = NULL;
     }
@@ -208,6 +227,7 @@ bool exec_mod_p190_(
   trcHdr->setDoubleValue( vars->hdrID_recx, dataChan->x );
   trcHdr->setDoubleValue( vars->hdrID_recy, dataChan->y );
   trcHdr->setDoubleValue( vars->hdrID_recz, dataChan->z );
+  vars->numTraces += 1;
 
   return true;
 }
@@ -233,6 +253,10 @@ void params_mod_p190_( csParamDef* pdef ) {
 
   pdef->addParam( "hdr_cable", "Trace header containing cable number", NUM_VALUES_FIXED, "This must match the cable number in the P1/90 file" );
   pdef->addValue( "cable", VALTYPE_STRING, "Trace header name" );
+
+  pdef->addParam( "cache", "Binary cache file for source records", NUM_VALUES_FIXED,
+                  "If the cache file exists and was written for the same P1/90 file (size, time stamp), source records are read from the cache file instead of scanning the P1/90 file. Otherwise, the cache file is (re-)written" );
+  pdef->addValue( "", VALTYPE_STRING, "Cache file name" );
 }
 
 extern "C" void _params_mod_p190_( csParamDef* pdef ) {
@@ -3,8 +3,9 @@
 
 #include "cseis_includes.h"
 #include "csVector.h"
-#include "csSortManager.h"
-#include "csFlexNumber.h"
+#include "csKeyTable.h"
+#include "csASCIIParser.h"
+#include "csFileUtils.h"
 #include "csTime.h"
 #include <cstring>
 
@@ -22,16 +23,13 @@ using namespace std;
  * Bug fixes and updates
  *  2007-Oct-08 - Convert key position to C++ (start at 0). Correct key & header position during input
  *  2009-Apr-05 - Change second position given in parameter 'header' and 'key' to position (used to be length, wrongly documented)
+ *  2013        - Match keys through hash index (csKeyTable). Input file does not need to be sorted. Optional binary cache file
+ *  2013        - Parse input file with csASCIIParser (memory mapped, multi-threaded). No limit on line length
  */
 namespace mod_read_ascii {
   struct VariableStruct {
-    int npos;             // Number of lines in input ASCII file
-    int currentPos;       // Index of line from which last value was retrieved
-    double** keyValues;   // Key values as they appear in input ASCII file
-    double** headerValues;
-    double* keyDoubleBuffer;  // Key values of current trace
-    int* keyIntBuffer;        // Key values of current trace
-    std::string* keyStringBuffer;
+    cseis_geolib::csKeyTable* table;  // Key & header values as they appear in input ASCII file
+    double* keyBuffer;    // Key values of current trace
     cseis_geolib::csVector<int>* headerIndexList;
     cseis_geolib::csVector<int>* headerTypeList;
     cseis_geolib::csVector<int>* keyIndexList;
@@ -48,6 +46,9 @@ namespace mod_read_ascii {
 //    csDate_t  date;
     int       timeKeyYear;
     int       hdrId_time_key;
+
+    int numTracesMatched;
+    int numTracesUnmatched;
   };
 
 // Do not change index number! ...gives number of parameters for each method
@@ -58,6 +59,15 @@ struct Pos {
   int start;
   int length;
 };
+  /// Field at given character position, clipped to line length
+  std::string field( char const* line, int lineLength, Pos const& pos ) {
+    int start = std::min( pos.start, lineLength );
+    return std::string( &line[start], std::min( pos.length, lineLength - start ) );
+  }
+  double parseField( char const* line, int lineLength, Pos const& pos ) {
+    int start = std::min( pos.start, lineLength );
+    return csASCIIParser::parseDouble( &line[start], std::min( pos.length, lineLength - start ) );
+  }
 
 }
 using namespace mod_read_ascii;
@@ -76,13 +86,8 @@ void init_mod_read_ascii_( csParamManager* param, csInitPhaseEnv* env, csLogWrit
 
   edef->setExecType( EXEC_TYPE_SINGLETRACE );
 
-  vars->npos       = 0;
-  vars->currentPos = 0;
-  vars->keyValues       = NULL;
-  vars->headerValues    = NULL;
-  vars->keyDoubleBuffer = NULL;
-  vars->keyIntBuffer    = NULL;
-  vars->keyStringBuffer = NULL;
+  vars->table     = NULL;
+  vars->keyBuffer = NULL;
   vars->headerIndexList = NULL;
   vars->headerTypeList  = NULL;
   vars->keyIndexList    = NULL;
@@ -97,6 +102,9 @@ void init_mod_read_ascii_( csParamManager* param, csInitPhaseEnv* env, csLogWrit
   vars->isTimeKey    = false;
   vars->isTimeKey_us = false;
   vars->hdrId_time_key = -1;
+  vars->timeKeyYear    = 0;
+  vars->numTracesMatched   = 0;
+  vars->numTracesUnmatched = 0;
 
   //----------------------------------------------------
 
@@ -115,7 +123,7 @@ void init_mod_read_ascii_( csParamManager* param, csInitPhaseEnv* env, csLogWrit
   std::string keyName;
   int column;
 
-  FILE* f_in;
+  int numThreads = 0;
 
   vars->headerIndexList = new csVector<int>();
   vars->headerTypeList  = new csVector<int>();
@@ -173,6 +181,8 @@ void init_mod_read_ascii_( csParamManager* param, csInitPhaseEnv* env, csLogWrit
 //-------------------------------------------
 //
   Pos timeKeyPos;
+  timeKeyPos.start  = 0;
+  timeKeyPos.length = 0;
   if( param->exists("key_sps_time") ) {
     param->getInt( "time_year", &vars->timeKeyYear );
     string timeKeyName;
@@ -296,15 +306,6 @@ void init_mod_read_ascii_( csParamManager* param, csInitPhaseEnv* env, csLogWrit
     log->error("When time key is used, no other key is supported.");
   }
   else if( vars->numKeys > 0 ) {
-    vars->keyDoubleBuffer = new double[vars->numKeys];
-    vars->keyIntBuffer    = new int[vars->numKeys];
-//    vars->keyStringBuffer = new std::string[vars->numKeys];
-    for( int ikey = 0; ikey < vars->numKeys; ikey++ ) {
-      vars->keyIntBuffer[ikey] = 0;
-      vars->keyDoubleBuffer[ikey] = 0.0;
-//      vars->keyStringBuffer[ikey] = "";
-    }
-
     for( int ikey = 0; ikey < vars->numKeys; ikey++ ) {
       if( edef->isDebug() ) log->line("Reading parameters for key %d", ikey+1);
       valueList.clear();
@@ -387,6 +388,9 @@ void init_mod_read_ascii_( csParamManager* param, csInitPhaseEnv* env, csLogWrit
       }
       vars->keyIndexList->insertEnd( hdef->headerIndex(keyName.c_str()) );
       vars->keyTypeList->insertEnd( hdef->headerType(keyName.c_str()) );
+      if( hdef->headerType(keyName.c_str()) == TYPE_STRING ) {
+        log->error("String headers are currently not supported as key: Trace header %s", keyName.c_str());
+      }
     }
     else {
       log->line("Trace header %s does not exist.", keyName.c_str());
@@ -398,272 +402,272 @@ void init_mod_read_ascii_( csParamManager* param, csInitPhaseEnv* env, csLogWrit
   }
 
 //---------------------------------------------------------------
-// Read in ASCII file
+// Set up key table. Time key: Unix seconds, plus microseconds if requested
 //
-  if( (f_in = fopen( filename.c_str(), "r" )) == (FILE*) NULL ) {
-    log->error("Could not open file: '%s'", filename.c_str());
+  if( vars->isTimeKey ) {
+    vars->numKeys = vars->isTimeKey_us ? 2 : 1;
   }
+  vars->keyBuffer = new double[vars->numKeys];
+  vars->table     = new csKeyTable( vars->numKeys, vars->numHeaders );
 
-  char buffer[1024];
-  int counterLines = 0;
-  while( fgets( buffer, 1024, f_in ) != NULL ) {
-    if( strlen(buffer) <= 1 ) continue;  // Ignore empty lines (Allow 1 character for trailing newline)
-    if( isIgnore && buffer[0] == vars->ignoreChar ) continue;
-    if( isSelect && buffer[0] != vars->selectChar ) continue;
-    counterLines++;
+  std::string cacheFilename = "";
+  if( param->exists("nthreads") ) {
+    param->getInt( "nthreads", &numThreads );
   }
-  vars->npos = counterLines;
-  rewind( f_in );
-
-  if( vars->numKeys > 0 ) {
-    vars->keyValues = new double*[vars->numKeys];
-    for( int i = 0; i < vars->numKeys; i++ ) {
-      vars->keyValues[i] = new double[vars->npos];
-    }
+  if( param->exists("cache") ) {
+    param->getString( "cache", &cacheFilename );
   }
-  else {  // Time key:
-    if( vars->isTimeKey_us ) {
-      vars->keyValues    = new double*[2];
-      vars->keyValues[1] = new double[vars->npos];  // Allocate second key value 'just in case' microseconds are required
+  // Signature of cache file: Everything that the table content depends upon
+  std::string signature = "";
+  if( !cacheFilename.empty() ) {
+    csInt64_t fileSize = 0;
+    int timeStamp_s = 0;
+    if( !csFileUtils::retrieveFileInfo( filename, &fileSize, &timeStamp_s ) ) {
+      log->error("Could not open file: '%s'", filename.c_str());
     }
-    else {
-      vars->keyValues    = new double*[1];
+    char buffer[256];
+    sprintf( buffer, "READ_ASCII %lld %d %d %d %d %d %c %c %d %d %d %d %d|", fileSize, timeStamp_s, method, (int)isIgnore, (int)isSelect,
+             (int)vars->isTimeKey, vars->ignoreChar, vars->selectChar, (int)vars->isTimeKey_us, vars->timeKeyYear,
+             timeKeyPos.start, timeKeyPos.length, maxPosition );
+    signature = filename + std::string("|") + std::string(buffer);
+    for( int ikey = 0; ikey < keyColumnList.size(); ikey++ ) {
+      sprintf( buffer, "k%d ", keyColumnList.at(ikey) );
+      signature += buffer;
+    }
+    for( int ikey = 0; ikey < keyPosList.size(); ikey++ ) {
+      sprintf( buffer, "k%d,%d ", keyPosList.at(ikey).start, keyPosList.at(ikey).length );
+      signature += buffer;
+    }
+    for( int ihdr = 0; ihdr < headerColumnList.size(); ihdr++ ) {
+      sprintf( buffer, "h%d ", headerColumnList.at(ihdr) );
+      signature += buffer;
+    }
+    for( int ihdr = 0; ihdr < headerPosList.size(); ihdr++ ) {
+      sprintf( buffer, "h%d,%d ", headerPosList.at(ihdr).start, headerPosList.at(ihdr).length );
+      signature += buffer;
     }
-    vars->keyValues[0] = new double[vars->npos];
   }
-  vars->headerValues = new double*[vars->numHeaders];
-  for( int i = 0; i < vars->numHeaders; i++ ) {
-    vars->headerValues[i] = new double[vars->npos];
+
+  bool isCached = !cacheFilename.empty() && vars->table->readCache( cacheFilename, signature );
+  if( isCached ) {
+    log->line("Key/header values read in from cache file '%s' (%d lines)", cacheFilename.c_str(), vars->table->numRecords());
   }
 
-  csDate_t date;
-  date.year = vars->timeKeyYear;
+//---------------------------------------------------------------
+// Read in ASCII file
+//
+  if( !isCached ) {
+    csASCIIParser* parser = NULL;
+    try {
+      parser = new csASCIIParser( filename, numThreads );
+      parser->indexLines();
+    }
+    catch( csException& ) {
+      if( parser != NULL ) delete parser;
+      log->error("Could not open file: '%s'", filename.c_str());
+    }
+    double* keyValues    = vars->keyBuffer;
+    double* headerValues = new double[vars->numHeaders];
 
+    csDate_t date;
+    date.year = vars->timeKeyYear;
 
-  counterLines = 0;
+    int counterLines = 0;
 
-  if( method == METHOD_COLUMNS ) {
-    if( vars->isTimeKey ) {
-      if( timeKeyPos.start > maxNumColumn ) {
-        maxNumColumn = timeKeyPos.start;
-      }
-    }
-    while( fgets( buffer, 1024, f_in ) != NULL ) {
-      int bufferLength = strlen(buffer);
-      if( bufferLength <= 1 ) continue;  // Ignore empty lines (Allow 1 character for trailing newline)
-      if( isIgnore && buffer[0] == vars->ignoreChar ) continue;
-      if( isSelect && buffer[0] != vars->selectChar ) continue;
-      if( edef->isDebug() ) log->line("ASCII file, line #%3d: %s", counterLines, buffer);
-      valueList.clear();
-      tokenize( buffer, valueList );
-      if( valueList.size() < maxNumColumn+1 ) {
-        log->line("Input file contains too few columns. Number of columns found: %d. Maximum column number for key/header: %d. First line:\n%s", valueList.size(), maxNumColumn+1, buffer);
-        env->addError();
-        break;
-      }
-      for( int i = 0; i < vars->numKeys; i++ ) {
-        column = keyColumnList.at(i);
-        vars->keyValues[i][counterLines] = atof(valueList.at(column).c_str());
-      }
-      for( int ihdr = 0; ihdr < vars->numHeaders; ihdr++ ) {
-        column = headerColumnList.at(ihdr);
-        vars->headerValues[ihdr][counterLines] = atof(valueList.at(column).c_str());
-      }
+    if( method == METHOD_COLUMNS ) {
       if( vars->isTimeKey ) {
-        string dateString( valueList.at(timeKeyPos.start) );
-        date.julianDay = atoi( dateString.substr(0,3).c_str() );
-        date.hour      = atoi( dateString.substr(3,2).c_str() );
-        date.min       = atoi( dateString.substr(5,2).c_str() );
-        date.sec       = atoi( dateString.substr(7,2).c_str() );
-        vars->keyValues[0][counterLines] = (double)date.unixTime();
-        if( vars->isTimeKey_us ) {
-          date.usec = atoi( dateString.substr(10,6).c_str() );
-          vars->keyValues[1][counterLines] = (double)date.usec;
+        if( timeKeyPos.start > maxNumColumn ) {
+          maxNumColumn = timeKeyPos.start;
         }
-        if( edef->isDebug() ) log->line("Date: %s", date.getString() );
       }
-      counterLines++;
-    }
-  }
-  else if( method == METHOD_POSITIONS ) {
-    while( fgets( buffer, 1024, f_in ) != NULL ) {
-      int bufferLength = strlen(buffer);
-      if( bufferLength <= 1 ) continue;  // Ignore empty lines (Allow 1 character for trailing newline)
-      if( isIgnore && buffer[0] == vars->ignoreChar ) continue;
-      if( isSelect && buffer[0] != vars->selectChar ) continue;
-
-      valueList.clear();
-      std::string bufferString = buffer;
-      if( edef->isDebug() ) {
-        log->line("ASCII file, line #%3d: %s", counterLines, bufferString.c_str());
+      // Parser columns: Keys, then headers
+      int numKeyColumns = keyColumnList.size();
+      int* parseColumns = new int[numKeyColumns + vars->numHeaders];
+      for( int i = 0; i < numKeyColumns; i++ ) {
+        parseColumns[i] = keyColumnList.at(i);
       }
-      if( bufferLength < maxPosition ) {
-        log->line("Input line contains too few characters. Expected, according to specified key/header positions: %d, found: %d\nLine: %s",
-                  maxPosition, bufferLength, bufferString.c_str() );
-        env->addError();
-        break;
+      for( int ihdr = 0; ihdr < vars->numHeaders; ihdr++ ) {
+        parseColumns[numKeyColumns+ihdr] = headerColumnList.at(ihdr);
       }
-      for( int i = 0; i < vars->numKeys; i++ ) {
-        Pos pos = keyPosList.at(i);
-        if( pos.start+pos.length > bufferLength ) {
-          log->line("Error: Key %s, ASCII file line #%d: Start position/length exceeds line length", keyNameList.at(i).c_str(), counterLines+1 );
-          env->addError();
+      parser->setColumns( parseColumns, numKeyColumns + vars->numHeaders );
+      delete [] parseColumns;
+
+      int const numLinesBlock = 262144;
+      for( int iline = 0; iline < parser->numLines(); iline++ ) {
+        if( iline % numLinesBlock == 0 ) {
+          parser->parseColumns( iline, std::min( numLinesBlock, parser->numLines() - iline ) );
         }
-        vars->keyValues[i][counterLines] = atof(bufferString.substr(pos.start,pos.length).c_str());
-      }
-      for( int ihdr = 0; ihdr < vars->numHeaders; ihdr++ ) {
-        Pos pos = headerPosList.at(ihdr);
-        if( pos.start+pos.length > bufferLength ) {
-          log->line("Error: Header %s, ASCII file line #%d: Start position/length exceeds line length", headerNameList.at(ihdr).c_str(), counterLines+1 );
+        char const* line = parser->line( iline );
+        int lineLength   = parser->lineLength( iline );
+        if( lineLength == 0 ) continue;  // Ignore empty lines
+        if( isIgnore && line[0] == vars->ignoreChar ) continue;
+        if( isSelect && line[0] != vars->selectChar ) continue;
+        if( edef->isDebug() ) log->line("ASCII file, line #%3d: %s", counterLines, std::string(line,lineLength).c_str());
+        int numColumns = parser->numTokens( iline );
+        if( numColumns < maxNumColumn+1 ) {
+          log->line("Input file contains too few columns. Number of columns found: %d. Maximum column number for key/header: %d. First line:\n%s", numColumns, maxNumColumn+1, std::string(line,lineLength).c_str());
           env->addError();
+          break;
         }
-        vars->headerValues[ihdr][counterLines] = atof(bufferString.substr(pos.start,pos.length).c_str());
-      }
-      if( vars->isTimeKey ) {
-        if( timeKeyPos.start+timeKeyPos.length > bufferLength ) {
-          log->line("Error: Time key, ASCII file line #%d: Start position/length exceeds line length", counterLines+1 );
+        for( int i = 0; i < numKeyColumns; i++ ) {
+          keyValues[i] = parser->value( iline, i );
+        }
+        for( int ihdr = 0; ihdr < vars->numHeaders; ihdr++ ) {
+          headerValues[ihdr] = parser->value( iline, numKeyColumns+ihdr );
+        }
+        if( vars->isTimeKey ) {
+          char const* token = line;
+          int tokenLength = 0;
+          csASCIIParser::token( line, lineLength, timeKeyPos.start, &token, &tokenLength );
+          string dateString( token, tokenLength );
+          date.julianDay = atoi( dateString.substr(0,3).c_str() );
+          date.hour      = atoi( dateString.substr(3,2).c_str() );
+          date.min       = atoi( dateString.substr(5,2).c_str() );
+          date.sec       = atoi( dateString.substr(7,2).c_str() );
+          keyValues[0] = (double)date.unixTime();
+          if( vars->isTimeKey_us ) {
+            date.usec = atoi( dateString.substr(10,6).c_str() );
+            keyValues[1] = (double)date.usec;
+          }
+          if( edef->isDebug() ) log->line("Date: %s", date.getString() );
+        }
+        vars->table->addRecord( keyValues, headerValues );
+        counterLines++;
+      }
+    }
+    else if( method == METHOD_POSITIONS ) {
+      for( int iline = 0; iline < parser->numLines(); iline++ ) {
+        char const* line = parser->line( iline );
+        int lineLength   = parser->lineLength( iline );
+        if( lineLength == 0 ) continue;  // Ignore empty lines
+        if( isIgnore && line[0] == vars->ignoreChar ) continue;
+        if( isSelect && line[0] != vars->selectChar ) continue;
+        // Allow 1 character for trailing newline
+        int bufferLength = lineLength + 1;
+
+        if( edef->isDebug() ) {
+          log->line("ASCII file, line #%3d: %s", counterLines, std::string(line,lineLength).c_str());
+        }
+        if( bufferLength < maxPosition ) {
+          log->line("Input line contains too few characters. Expected, according to specified key/header positions: %d, found: %d\nLine: %s",
+                    maxPosition, bufferLength, std::string(line,lineLength).c_str() );
           env->addError();
+          break;
         }
-        string dateString = bufferString.substr(timeKeyPos.start,timeKeyPos.length);
-        date.julianDay = atoi( dateString.substr(0,3).c_str() );
-        date.hour      = atoi( dateString.substr(3,2).c_str() );
-        date.min       = atoi( dateString.substr(5,2).c_str() );
-        date.sec       = atoi( dateString.substr(7,2).c_str() );
-        vars->keyValues[0][counterLines] = (double)date.unixTime();
-        if( vars->isTimeKey_us ) {
-          date.usec = atoi( dateString.substr(10,6).c_str() );
-          vars->keyValues[1][counterLines] = (double)date.usec;
+        for( int i = 0; i < keyPosList.size(); i++ ) {
+          Pos pos = keyPosList.at(i);
+          if( pos.start+pos.length > bufferLength ) {
+            log->line("Error: Key %s, ASCII file line #%d: Start position/length exceeds line length", keyNameList.at(i).c_str(), counterLines+1 );
+            env->addError();
+          }
+          keyValues[i] = parseField( line, lineLength, pos );
+        }
+        for( int ihdr = 0; ihdr < vars->numHeaders; ihdr++ ) {
+          Pos pos = headerPosList.at(ihdr);
+          if( pos.start+pos.length > bufferLength ) {
+            log->line("Error: Header %s, ASCII file line #%d: Start position/length exceeds line length", headerNameList.at(ihdr).c_str(), counterLines+1 );
+            env->addError();
+          }
+          headerValues[ihdr] = parseField( line, lineLength, pos );
+        }
+        if( vars->isTimeKey ) {
+          if( timeKeyPos.start+timeKeyPos.length > bufferLength ) {
+            log->line("Error: Time key, ASCII file line #%d: Start position/length exceeds line length", counterLines+1 );
+            env->addError();
+          }
+          string dateString = field( line, lineLength, timeKeyPos );
+          date.julianDay = atoi( dateString.substr(0,3).c_str() );
+          date.hour      = atoi( dateString.substr(3,2).c_str() );
+          date.min       = atoi( dateString.substr(5,2).c_str() );
+          date.sec       = atoi( dateString.substr(7,2).c_str() );
+          keyValues[0] = (double)date.unixTime();
+          if( vars->isTimeKey_us ) {
+            date.usec = atoi( dateString.substr(10,6).c_str() );
+            keyValues[1] = (double)date.usec;
+          }
+          if( edef->isDebug() ) log->line("Date: %s   %d", date.getString(), date.unixTime() );
         }
-        if( edef->isDebug() ) log->line("Date: %s   %d", date.getString(), date.unixTime() );
+        vars->table->addRecord( keyValues, headerValues );
+        counterLines++;
       }
-      counterLines++;
     }
-  }
 
-  fclose( f_in );
+    delete parser;
+    delete [] headerValues;
 
-//-----------------------------------------------------------------------------
-// Set time key values
-//
-  if( vars->isTimeKey ) {
-    vars->numKeys = 1;
-    if( vars->isTimeKey_us ) vars->numKeys += 1;
-    vars->keyDoubleBuffer = new double[vars->numKeys];
-    vars->keyIntBuffer    = new int[vars->numKeys];
+    if( env->errorCount() != 0 ) {
+      return;
+    }
+    if( !cacheFilename.empty() ) {
+      try {
+        vars->table->writeCache( cacheFilename, signature );
+        log->line("Key/header values written to cache file '%s'", cacheFilename.c_str());
+      }
+      catch( csException& e ) {
+        log->warning("%s", e.getMessage());
+      }
+    }
   }
 
 //-----------------------------------------------------------------------------
-// Sort key values
+// Build key index. Input lines do not need to be sorted
 //
-        bool doSort = false;
-        if( param->exists("sort") ) {
-                string text;
-                param->getString("sort",&text);
-
-                if( !text.compare("yes") ) {
-                        doSort = true;
-                }
-                else if( !text.compare("no") ) {
-                        doSort = false;
-                }
-                else {
-                        log->error("Option not recognised: %s", text.c_str());
-                }
-        }
-
-        if( doSort ) {
+  if( param->exists("sort") ) {
+    log->line("Note: Parameter 'sort' is obsolete. Key values are matched through a hash index, whether they are sorted or not.");
+  }
+  int numDuplicates = vars->table->buildIndex();
+  log->line("Number of lines read in from ASCII file: %d. Number of lines with duplicate keys: %d", vars->table->numRecords(), numDuplicates);
 
-                cseis_geolib::csSortManager sortManager( vars->numKeys, csSortManager::TREE_SORT );
-                sortManager.resetValues( vars->npos );
-  
-                for( int ikey = 0; ikey < vars->numKeys; ikey++ ) {
-                        for( int ipos = 0; ipos < vars->npos; ipos++ ) {
-                                double value = vars->keyValues[ikey][ipos];
-                                sortManager.setValue( ipos, vars->numKeys-ikey-1, csFlexNumber(value) );
-                        }
-                }
-  
-                sortManager.sort();
-  
-                for( int ikey = 0; ikey < vars->numKeys; ikey++ ) {
-                        double* sortedValues = new double[vars->npos];
-                        for( int ipos = 0; ipos < vars->npos; ipos++ ) {
-                                sortedValues[ipos] = vars->keyValues[ikey][ sortManager.sortedIndex(ipos) ];
-                        }
-                        delete [] vars->keyValues[ikey];
-                        vars->keyValues[ikey] = sortedValues;
-                }
-
-                for( int ihdr = 0; ihdr < vars->numHeaders; ihdr++ ) {
-                        double* sortedValues = new double[vars->npos];
-                        for( int ipos = 0; ipos < vars->npos; ipos++ ) {
-                                sortedValues[ipos] = vars->headerValues[ihdr][ sortManager.sortedIndex(ipos) ];
-                        }
-                        delete [] vars->headerValues[ihdr];
-                        vars->headerValues[ihdr] = sortedValues;
-                }
-        }
 //-----------------------------------------------------------------------------
 //
-  if( checkConsistency ) {
-    bool abort = false;
-    for( int ipos = 1; ipos < vars->npos; ipos++ ) {
-      bool isSame = true;
-      for( int ikey = 0; ikey < vars->numKeys; ikey++ ) {
-        isSame = isSame && ( vars->keyValues[ikey][ipos] == vars->keyValues[ikey][ipos-1] );
-      }
-      if( isSame ) {
-        log->warning("Duplicate key(s) in input file:");
+  if( checkConsistency && numDuplicates > 0 ) {
+    log->warning("Duplicate key(s) in input file:");
+    for( int irec = 0; irec < vars->table->numRecords(); irec++ ) {
+      if( vars->table->isDuplicate( irec ) ) {
         for( int ikey = 0; ikey < vars->numKeys; ikey++ ) {
-          log->write("Key #%d: %f  ", ikey+1, vars->keyValues[ikey][ipos] );
+          log->write("Key #%d: %f  ", ikey+1, vars->table->key( irec, ikey ) );
         }
         log->write("\n");
-        abort = true;
       }
     }
-    if( abort ) {
-      log->error("Inconsistencies found in input file.");
-    }
+    log->error("Inconsistencies found in input file.");
   }
 
 //-----------------------------------------------------------------------------
 // Debug dump
 //
   if( edef->isDebug() ) {
-    for( int i = 0; i < vars->keyIndexList->size(); i++ ) {
+    for( int i = 0; i < keyNameList.size(); i++ ) {
       log->write( "%15s ", keyNameList.at(i).c_str() );
     }
     log->write(" ### ");
-    for( int i = 0; i < vars->headerIndexList->size(); i++ ) {
+    for( int i = 0; i < vars->numHeaders; i++ ) {
       log->write( "%15s ", headerNameList.at(i).c_str() );
     }
     if( vars->isTimeKey ) {
       log->write( "%15s ", "Time key" );
     }
     log->line("");
-    double value;
-    for( int iPos = 0; iPos < vars->npos; iPos++ ) {
-      for( int i = 0; i < vars->keyIndexList->size(); i++ ) {
-        value = vars->keyValues[i][iPos];
-        log->write( "%15.3f ", value );
+    for( int irec = 0; irec < vars->table->numRecords(); irec++ ) {
+      if( !vars->isTimeKey ) {
+        for( int i = 0; i < vars->numKeys; i++ ) {
+          log->write( "%15.3f ", vars->table->key( irec, i ) );
+        }
       }
       log->write(" ### ");
-      for( int i = 0; i < vars->headerIndexList->size(); i++ ) {
-        value = vars->headerValues[i][iPos];
-        log->write( "%15.3f ", value );
+      for( int i = 0; i < vars->numHeaders; i++ ) {
+        log->write( "%15.3f ", vars->table->value( irec, i ) );
       }
       if( vars->isTimeKey ) {
-        log->write( "%12d %s ", (int)vars->keyValues[0][iPos], csGeolibUtils::UNIXsec2dateString((int)vars->keyValues[0][iPos]).c_str() );
+        int time_s = (int)vars->table->key( irec, 0 );
+        log->write( "%12d %s ", time_s, csGeolibUtils::UNIXsec2dateString(time_s).c_str() );
         if( vars->isTimeKey_us ) {
-          log->write( "(%6d) ", (int)vars->keyValues[1][iPos] );
+          log->write( "(%6d) ", (int)vars->table->key( irec, 1 ) );
         }
       }
       log->line("");
     }
   }
-
-  vars->currentPos = 0;
-
 }
 
 //*************************************************************************************************
@@ -681,36 +685,23 @@ bool exec_mod_read_ascii_(
   csExecPhaseDef* edef = env->execPhaseDef;
 
   if( edef->isCleanup()){
-
-    if( vars->keyIntBuffer ) {
-      delete [] vars->keyIntBuffer;
-      vars->keyIntBuffer = NULL;
+    if( vars->table ) {
+      log->line("Number of traces matched: %d, unmatched: %d (%s)", vars->numTracesMatched, vars->numTracesUnmatched,
+                vars->dropUnmatchedTraces ? "dropped" : "passed on unchanged" );
+      delete vars->table;
+      vars->table = NULL;
     }
-    if( vars->keyStringBuffer ) {
-      delete [] vars->keyStringBuffer;
-      vars->keyStringBuffer = NULL;
-    }
-    if( vars->keyDoubleBuffer ) {
-      delete [] vars->keyDoubleBuffer;
-      vars->keyDoubleBuffer = NULL;
+    if( vars->keyBuffer ) {
+      delete [] vars->keyBuffer;
+      vars->keyBuffer = NULL;
     }
     if( vars->keyIndexList ) {
-      if( vars->keyValues ) {
-        for( int i = 0; i < vars->keyIndexList->size(); i++ ) {
-          delete [] vars->keyValues[i];
-        }
-        delete [] vars->keyValues;
-      }
       delete vars->keyIndexList;
+      vars->keyIndexList = NULL;
     }
     if( vars->headerIndexList ) {
-      if( vars->headerValues ) {
-        for( int i = 0; i < vars->headerIndexList->size(); i++ ) {
-          delete [] vars->headerValues[i];
-        }
-        delete [] vars->headerValues;
-      }
       delete vars->headerIndexList;
+      vars->headerIndexList = NULL;
     }
     if( vars->keyTypeList ) {
       delete vars->keyTypeList;
@@ -734,16 +725,13 @@ bool exec_mod_read_ascii_(
     switch( type ) {
       case TYPE_FLOAT:
       case TYPE_DOUBLE:
-        vars->keyDoubleBuffer[iKey] = trcHdr->doubleValue( keyIndex );
+        vars->keyBuffer[iKey] = trcHdr->doubleValue( keyIndex );
         break;
       case TYPE_INT:
-        vars->keyIntBuffer[iKey] = trcHdr->intValue( keyIndex );
+        vars->keyBuffer[iKey] = (double)trcHdr->intValue( keyIndex );
         break;
       case TYPE_INT64:
-        vars->keyDoubleBuffer[iKey] = (double)trcHdr->int64Value( keyIndex );
-        break;
-      case TYPE_STRING:
-        vars->keyStringBuffer[iKey] = trcHdr->stringValue( keyIndex );
+        vars->keyBuffer[iKey] = (double)trcHdr->int64Value( keyIndex );
         break;
       default:
         log->line("ERROR!!!");
@@ -753,124 +741,42 @@ bool exec_mod_read_ascii_(
   if( edef->isDebug() ) {
     log->write("Keys: ");
     for( int iKey = 0; iKey < vars->numKeys; iKey++ ) {
-      switch( vars->keyTypeList->at(iKey) ) {
-        case TYPE_FLOAT:
-        case TYPE_DOUBLE:
-        case TYPE_INT64:
-          log->write("#%d,float: %f, ", iKey, vars->keyDoubleBuffer[iKey] );
-        break;
-      case TYPE_INT:
-          log->write("#%d,int: %d, ", iKey, vars->keyIntBuffer[iKey] );
-        break;
-      case TYPE_STRING:
-          log->write("#%d,string: %s , ", iKey, vars->keyStringBuffer[iKey].c_str() );
-      }
+      log->write("#%d: %f, ", iKey, vars->keyBuffer[iKey] );
     }
     log->write("\n");
   }
 
-  int counterKey = 0;
-
-  vars->currentPos = 0;  // TEMP ...to make it work in a brute way
-
-  while( counterKey < vars->numKeys ) {
-    int type = vars->keyTypeList->at(counterKey);
-
-    if( type == TYPE_FLOAT || type == TYPE_DOUBLE || type == TYPE_INT64 ) {
-      while( vars->currentPos < vars->npos && vars->keyValues[counterKey][vars->currentPos] != vars->keyDoubleBuffer[counterKey] ) {
-        vars->currentPos++;
-      }
-      if( vars->currentPos == vars->npos ) {
-        vars->currentPos = 0;
-      }
-      while( vars->currentPos < vars->npos && vars->keyValues[counterKey][vars->currentPos] != vars->keyDoubleBuffer[counterKey] ) {
-        vars->currentPos++;
-      }
-      if( vars->currentPos == vars->npos ) {
-        if( vars->showWarnings ) {
-          log->write("Unable to find matching line in ASCII file for ");
-          for( int i = 0; i < vars->numKeys; i++ ) {
-            log->write("key #%d: %f  ", i+1, vars->keyDoubleBuffer[i] );
-          }
-          log->write("\n");
-        }
-        return !vars->dropUnmatchedTraces;
-      }
-      else {
-        for( int jKey = counterKey-1; jKey >= 0; jKey-- ) {
-          if( vars->keyValues[jKey][vars->currentPos] != vars->keyDoubleBuffer[jKey] ) {
-            if( vars->showWarnings ) {
-              log->write("Unable to find matching line in ASCII file for ");
-              for( int i = 0; i < vars->numKeys; i++ ) {
-                log->write("key #%d: %f  ", i+1, vars->keyDoubleBuffer[i] );
-              }
-              log->write("\n");
-            }
-            return !vars->dropUnmatchedTraces;
-          }
-        }
-      }
-
-    }
-    // TYPE_INT
-    else if( type == TYPE_INT ) {
-      while( vars->currentPos < vars->npos && vars->keyValues[counterKey][vars->currentPos] != (double)vars->keyIntBuffer[counterKey] ) {
-        vars->currentPos++;
-      }
-      if( vars->currentPos == vars->npos ) {
-        vars->currentPos = 0;
-      }
-      while( vars->currentPos < vars->npos && vars->keyValues[counterKey][vars->currentPos] != (double)vars->keyIntBuffer[counterKey] ) {
-        vars->currentPos++;
-      }
-      if( vars->currentPos == vars->npos ) {
-        if( vars->showWarnings ) {
-          log->write("Unable to find matching line in ASCII file for ");
-          for( int i = 0; i < vars->numKeys; i++ ) {
-            log->write("key #%d: %d  ", i+1, vars->keyIntBuffer[i] );
-          }
-          log->write("\n");
+  int record = vars->table->find( vars->keyBuffer );
+  if( record < 0 ) {
+    vars->numTracesUnmatched += 1;
+    if( vars->showWarnings ) {
+      log->write("Unable to find matching line in ASCII file for ");
+      for( int i = 0; i < vars->numKeys; i++ ) {
+        if( vars->keyTypeList->at(i) == TYPE_INT ) {
+          log->write("key #%d: %d  ", i+1, (int)vars->keyBuffer[i] );
         }
-        return !vars->dropUnmatchedTraces;
-      }
-      else {
-        for( int jKey = counterKey-1; jKey >= 0; jKey-- ) {
-          if( vars->keyValues[jKey][vars->currentPos] != (double)vars->keyIntBuffer[jKey] ) {
-            if( vars->showWarnings ) {
-              log->write("Unable to find matching line in ASCII file for ");
-              for( int i = 0; i < vars->numKeys; i++ ) {
-                log->write("key #%d: %d  ", i+1, vars->keyIntBuffer[i] );
-              }
-              log->write("\n");
-            }
-            return !vars->dropUnmatchedTraces;
-          }
+        else {
+          log->write("key #%d: %f  ", i+1, vars->keyBuffer[i] );
         }
       }
-
+      log->write("\n");
     }
-    // TYPE_STRING
-    else {
-      // Not implemented yet
-    }
-    counterKey += 1;
+    return !vars->dropUnmatchedTraces;
   }
-//  if( vars->isTimeKey ) {
-//    int currentTime_s = trcHdr->intValue( vars->hdrId_time_key );
-//    if( currentTime_s
-//  }
+  vars->numTracesMatched += 1;
 
   for( int i = 0; i < vars->numHeaders; i++ ) {
     int type = vars->headerTypeList->at(i);
     int index = vars->headerIndexList->at(i);
+    double value = vars->table->value( record, i );
     if( type == TYPE_INT ) {
-      trcHdr->setIntValue( index, (int)vars->headerValues[i][vars->currentPos] );
+      trcHdr->setIntValue( index, (int)value );
     }
     else if( type == TYPE_INT64 ) {
-      trcHdr->setInt64Value( index, (csInt64_t)vars->headerValues[i][vars->currentPos] );
+      trcHdr->setInt64Value( index, (csInt64_t)value );
     }
     else {
-      trcHdr->setDoubleValue( index, vars->headerValues[i][vars->currentPos] );
+      trcHdr->setDoubleValue( index, value );
     }
   }
 
@@ -935,11 +841,19 @@ void params_mod_read_ascii_( csParamDef* pdef ) {
   pdef->addOption( "yes", "Check input file for consistency");
   pdef->addOption( "no", "Do not perform consistency check." );
 
-  pdef->addParam( "sort", "Sort key values from input ASCII file?", NUM_VALUES_FIXED );
+  pdef->addParam( "sort", "Obsolete: Key values are matched through a hash index. Input ASCII file does not need to be sorted", NUM_VALUES_FIXED );
   pdef->addValue( "yes", VALTYPE_OPTION );
-  pdef->addOption( "yes", "Sort key values in input ASCII file");
-  pdef->addOption( "no", "Do not sort key values. WARNING: This assumes key values are already sorted on input, otherwise the method will not work" );
+  pdef->addOption( "yes", "Obsolete");
+  pdef->addOption( "no", "Obsolete" );
+
+  pdef->addParam( "cache", "Binary cache file for key/header values", NUM_VALUES_FIXED,
+                  "If the cache file exists and was written for the same input file (size, time stamp) and the same key/header specification, values are read from the cache file instead of the ASCII file. Otherwise, the cache file is (re-)written after reading the ASCII file" );
+  pdef->addValue( "", VALTYPE_STRING, "Cache file name" );
   
+  pdef->addParam( "nthreads", "Number of threads used to parse input ASCII file", NUM_VALUES_FIXED,
+                  "Lines are indexed and parsed in parallel. Key/header values do not depend on the number of threads" );
+  pdef->addValue( "0", VALTYPE_NUMBER, "Number of threads. 0: Use number of processors" );
+
   pdef->addParam( "drop_traces", "Drop unmatched traces?", NUM_VALUES_FIXED );
   pdef->addValue( "no", VALTYPE_OPTION );
   pdef->addOption( "yes", "Drop traces for which no match could be found in input ASCII file");
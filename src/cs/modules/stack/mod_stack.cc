@@ -6,6 +6,7 @@
 #include "csVector.h"
 #include "csStackUtil.h"
 #include <cmath>
+#include <map>
 
 using namespace cseis_system;
 using namespace cseis_geolib;
@@ -30,11 +31,18 @@ namespace mod_stack {
     float normFactor;
     cseis_system::csStackUtil* stackUtil;
     bool isFirstCall;
+    /// Unsorted mode: Map stack header value --> index of stacked trace in buffer
+    std::map<double,int>* stackIndexMap;
+    /// Unsorted mode: Expected fold. Stacked traces are output as soon as this fold is reached. 0: Output all stacked traces at end
+    int expectedFold;
   }; 
   static int const MODE_ENSEMBLE = 11;
   static int const MODE_SORTED   = 12;
   static int const MODE_UNSORTED = 13;
   static int const MODE_ALL      = 14;
+
+  void outputStackedTrace( VariableStruct* vars, int stackedTraceIndex, csTraceGather* traceGather );
+  void outputAllStackedTraces( VariableStruct* vars, csTraceGather* traceGather );
 }
 using namespace mod_stack;
 
@@ -65,6 +73,8 @@ void init_mod_stack_( csParamManager* param, csInitPhaseEnv* env, csLogWriter* l
   vars->hdrId_fold      = -1;
   vars->normFactor      = 1;
   vars->isFirstCall     = true;
+  vars->stackIndexMap   = NULL;
+  vars->expectedFold    = 0;
 
   std::string text;
   int outputOption = csStackUtil::OUTPUT_FIRST;
@@ -105,9 +115,10 @@ void init_mod_stack_( csParamManager* param, csInitPhaseEnv* env, csLogWriter* l
     }
     else if( !text.compare("unsorted") ) {
       vars->mode = MODE_UNSORTED;
+      vars->stackIndexMap = new std::map<double,int>();
     }
     else {
-      log->line("Unknown option: '%s'", text.c_str());
+      log->error("Unknown option: '%s'", text.c_str());
     }
     edef->setTraceSelectionMode( TRCMODE_FIXED, 1 );
     vars->stackedTraces        = new csTraceGather();
@@ -145,6 +156,15 @@ void init_mod_stack_( csParamManager* param, csInitPhaseEnv* env, csLogWriter* l
   if( param->exists("norm") ) {
     param->getFloat("norm", &vars->normFactor);
   }
+  if( param->exists("fold") ) {
+    param->getInt("fold", &vars->expectedFold);
+    if( vars->expectedFold < 0 ) {
+      log->error("Expected fold must be a positive number, or 0. Specified: %d", vars->expectedFold);
+    }
+    if( vars->mode != MODE_UNSORTED ) {
+      log->warning("Parameter 'fold' is only used in mode 'unsorted'. Parameter ignored.");
+    }
+  }
   if( !hdef->headerExists( HDR_FOLD.name ) ) {
     hdef->addStandardHeader( HDR_FOLD.name );
   }
@@ -199,6 +219,10 @@ void exec_mod_stack_(
       delete vars->stackUtil;
       vars->stackUtil = NULL;
     }
+    if( vars->stackIndexMap != NULL ) {
+      delete vars->stackIndexMap;
+      vars->stackIndexMap = NULL;
+    }
     delete vars; vars = NULL;
     return;
   }
@@ -244,16 +268,7 @@ void exec_mod_stack_(
       return;
     }
     else if( vars->mode == MODE_UNSORTED && numTracesIn == 0 ) {
-      int numTracesOut = vars->stackedTraces->numTraces();
-      vars->stackedTraces->moveTracesTo( 0, numTracesOut, traceGather );
-      for( int itrcOut = 0; itrcOut < numTracesOut; itrcOut++ ) {
-        csTrace* traceOut    = traceGather->trace(itrcOut);
-        int numStackedTraces = vars->numStackedTracesList->at(itrcOut);
-        vars->stackUtil->normStackedTrace( traceOut, numStackedTraces );
-        traceOut->getTraceHeader()->setIntValue( vars->hdrId_fold, numStackedTraces );
-      }
-      vars->hdrValueList->clear();
-      vars->numStackedTracesList->clear();
+      outputAllStackedTraces( vars, traceGather );
       return;
     }
   }
@@ -288,8 +303,9 @@ void exec_mod_stack_(
     if( vars->mode != MODE_ALL ) {
       hdrValueIn = traceIn->getTraceHeader()->doubleValue(vars->hdrId_stack);
     }
-    // This is the very first trace. --> Save trace in stacked trace buffer
-    if( vars->stackedTraces->numTraces() == 0 ) {
+    // This is the very first trace (sorted mode). --> Save trace in stacked trace buffer
+    // In unsorted mode, every new header value is added to the stack index map further below
+    if( vars->mode == MODE_SORTED && vars->stackedTraces->numTraces() == 0 ) {
       traceGather->moveTraceTo( 0, vars->stackedTraces );
       vars->stackUtil->stackTrace( vars->stackedTraces->trace(0) );  // Bug fix 150528: Stack in new trace only once (was done twice)
       vars->numStackedTracesList->insertEnd( 1 );
@@ -319,42 +335,32 @@ void exec_mod_stack_(
       }
     }
     //----------------------------------------------------------------------------
-    else {  // MODE_UNSORTED && MODE_ALL
-      int stackedTraceIndex = 0;
-      if( vars->mode != MODE_ALL ) {
-        stackedTraceIndex = -1;
-        // Search for header value, if available
-        for( int i = 0; i < vars->hdrValueList->size(); i++ ) {
-          if( vars->hdrValueList->at(i) == hdrValueIn ) {
-            stackedTraceIndex = i;
-            break;
-          }
-        }
-      }
-      if( stackedTraceIndex < 0 ) {  // Header value not found --> add new stack trace to buffer
+    else {  // MODE_UNSORTED
+      int stackedTraceIndex = -1;
+      int numStackedTraces  = 1;
+      std::map<double,int>::iterator iter = vars->stackIndexMap->find( hdrValueIn );
+      if( iter == vars->stackIndexMap->end() ) {  // Header value not found --> add new stack trace to buffer
+        stackedTraceIndex = vars->stackedTraces->numTraces();
         traceGather->moveTraceTo( 0, vars->stackedTraces );
         vars->hdrValueList->insertEnd( hdrValueIn );
         vars->numStackedTracesList->insertEnd( 1 ); 
-        vars->stackUtil->stackTrace( vars->stackedTraces->trace(vars->stackedTraces->numTraces()-1) );
+        vars->stackIndexMap->insert( std::pair<double,int>( hdrValueIn, stackedTraceIndex ) );
+        vars->stackUtil->stackTrace( vars->stackedTraces->trace(stackedTraceIndex) );
       }
       else {  // Header value found --> stack input trace into buffer
+        stackedTraceIndex = iter->second;
         csTrace* traceOut = vars->stackedTraces->trace(stackedTraceIndex);
         vars->stackUtil->stackTrace( traceOut, traceIn );
-        vars->numStackedTracesList->set( vars->numStackedTracesList->at(stackedTraceIndex)+1, stackedTraceIndex );
+        numStackedTraces = vars->numStackedTracesList->at(stackedTraceIndex) + 1;
+        vars->numStackedTracesList->set( numStackedTraces, stackedTraceIndex );
         traceGather->freeTrace( 0 );
       }
+      // Expected fold reached --> output stacked trace straight away
+      if( vars->expectedFold > 0 && numStackedTraces >= vars->expectedFold ) {
+        outputStackedTrace( vars, stackedTraceIndex, traceGather );
+      }
       if( edef->isLastCall() ) {
-        int numTracesOut = vars->stackedTraces->numTraces();
-        vars->stackedTraces->moveTracesTo( 0, numTracesOut, traceGather );
-        for( int itrcOut = 0; itrcOut < numTracesOut; itrcOut++ ) {
-          csTrace* traceOut    = traceGather->trace(itrcOut);
-          int numStackedTraces = vars->numStackedTracesList->at(itrcOut);
-          vars->stackUtil->normStackedTrace( traceOut, numStackedTraces );
-          traceOut->getTraceHeader()->setIntValue( vars->hdrId_fold, numStackedTraces );
-        }
-        vars->hdrValueList->clear();
-        vars->numStackedTracesList->clear();
-
+        outputAllStackedTraces( vars, traceGather );
         return;
       }
     }
@@ -383,11 +389,15 @@ void params_mod_stack_( csParamDef* pdef ) {
   pdef->addOption( "ensemble", "Stack each input ensemble." );
   pdef->addOption( "all", "Stack all incoming traces." );
   pdef->addOption( "sorted",   "Input data have already been pre-sorted by header(s) specified in parameter 'header'." );
-  pdef->addOption( "unsorted", "Input data have NOT been pre-sorted.", "This means that the stack module waits until all traces have been input before outputting the first trace. Note that output traces may not be sorted in (increasing,decreasing) order of the stack header.");
+  pdef->addOption( "unsorted", "Input data have NOT been pre-sorted.", "This means that the stack module waits until all traces have been input before outputting the first trace, unless the expected fold is specified (see parameter 'fold'). Note that output traces may not be sorted in (increasing,decreasing) order of the stack header.");
 
   pdef->addParam( "header", "Stack header", NUM_VALUES_FIXED );
   pdef->addValue( "", VALTYPE_STRING, "Trace 'stack' header name. Stack all traces with same stack header value." );
 
+  pdef->addParam( "fold", "Expected fold", NUM_VALUES_FIXED, "Only used in mode 'unsorted'" );
+  pdef->addValue( "0", VALTYPE_NUMBER, "Expected number of traces per stack header value. Stacked trace is output as soon as this number of traces has been stacked. 0: Output all stacked traces after the last input trace",
+                  "Buffer memory is then proportional to the number of stack header values still in progress, not the total number of stack header values. Traces arriving after the stacked trace was output start a new stacked trace with the same header value." );
+
   pdef->addParam( "norm", "Normalisation factor", NUM_VALUES_FIXED );
   pdef->addValue( "1", VALTYPE_NUMBER, "Output stack value is normalised by number of stacked traces to the power of the 'norm' factor.", "Specify 0.5 for sqrt(N) normalization, 0 for no normalization" );
 
@@ -401,6 +411,55 @@ void params_mod_stack_( csParamDef* pdef ) {
 }
 
 
+//--------------------------------------------------------------------------------
+// Output stacked trace from buffer (unsorted mode)
+// Normalise stacked trace, set fold header, and move it to the end of the output trace gather.
+// The last buffered trace takes its place in the buffer, so that all other stack indices remain unchanged.
+//
+void mod_stack::outputStackedTrace( VariableStruct* vars, int stackedTraceIndex, csTraceGather* traceGather ) {
+  int lastIndex = vars->stackedTraces->numTraces() - 1;
+  if( stackedTraceIndex != lastIndex ) {
+    csTrace* traceTmp = (*vars->stackedTraces)[stackedTraceIndex];
+    (*vars->stackedTraces)[stackedTraceIndex] = (*vars->stackedTraces)[lastIndex];
+    (*vars->stackedTraces)[lastIndex] = traceTmp;
+    double hdrValueLast = vars->hdrValueList->at(lastIndex);
+    double hdrValueOut  = vars->hdrValueList->at(stackedTraceIndex);
+    int numStackedTracesLast = vars->numStackedTracesList->at(lastIndex);
+    vars->hdrValueList->set( hdrValueOut, lastIndex );
+    vars->hdrValueList->set( hdrValueLast, stackedTraceIndex );
+    vars->numStackedTracesList->set( vars->numStackedTracesList->at(stackedTraceIndex), lastIndex );
+    vars->numStackedTracesList->set( numStackedTracesLast, stackedTraceIndex );
+    (*vars->stackIndexMap)[hdrValueLast] = stackedTraceIndex;
+  }
+  int numStackedTraces = vars->numStackedTracesList->at(lastIndex);
+  vars->stackIndexMap->erase( vars->hdrValueList->at(lastIndex) );
+  vars->hdrValueList->remove( lastIndex );
+  vars->numStackedTracesList->remove( lastIndex );
+
+  vars->stackedTraces->moveTraceTo( lastIndex, traceGather );
+  csTrace* traceOut = traceGather->trace( traceGather->numTraces()-1 );
+  vars->stackUtil->normStackedTrace( traceOut, numStackedTraces );
+  vars->stackUtil->resetNormTrace( traceOut );
+  traceOut->getTraceHeader()->setIntValue( vars->hdrId_fold, numStackedTraces );
+}
+//--------------------------------------------------------------------------------
+// Output all buffered stacked traces (unsorted mode), in the order in which they were buffered
+//
+void mod_stack::outputAllStackedTraces( VariableStruct* vars, csTraceGather* traceGather ) {
+  int firstTraceOut = traceGather->numTraces();
+  int numTracesOut  = vars->stackedTraces->numTraces();
+  vars->stackedTraces->moveTracesTo( 0, numTracesOut, traceGather );
+  for( int itrcOut = 0; itrcOut < numTracesOut; itrcOut++ ) {
+    csTrace* traceOut    = traceGather->trace(firstTraceOut+itrcOut);
+    int numStackedTraces = vars->numStackedTracesList->at(itrcOut);
+    vars->stackUtil->normStackedTrace( traceOut, numStackedTraces );
+    traceOut->getTraceHeader()->setIntValue( vars->hdrId_fold, numStackedTraces );
+  }
+  vars->hdrValueList->clear();
+  vars->numStackedTracesList->clear();
+  vars->stackIndexMap->clear();
+}
+
 extern "C" void _params_mod_stack_( csParamDef* pdef ) {
   params_mod_stack_( pdef );
 }
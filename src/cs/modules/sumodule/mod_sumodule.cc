@@ -41,6 +41,8 @@ extern "C" {
   #include <errno.h>
   #include <signal.h>
   #include <poll.h>
+  #include <sys/mman.h>
+  #include <sys/time.h>
 }
 
 void setHeaders( csSegyTraceHeader* segyTrcHdr, csSegyHdrMap* segyHdrMap, int* hdrIndexSegy, type_t* hdrTypeSegy,
@@ -58,6 +60,7 @@ pthread_mutex_t lock_x;
  * @author Bjorn Olofsson
  */
 namespace mod_sumodule {
+  class ShmTransport;
   class ThreadParam {
   public:
     ThreadParam() {}
@@ -112,15 +115,91 @@ namespace mod_sumodule {
     int outputCounter;
     int numSamplesIn;
     float sampleIntIn;
+
+    int transport;
+    ShmTransport* shm;
   };
   
   static int const READING  = -1;
   static int const BUFFER_READY = 1;
   static int const FINISHED = 0;
   static int COUNTER = 0;
+
+  static int const TRANSPORT_PIPE = 1;
+  static int const TRANSPORT_SHM  = 2;
+  /// Ring index: Traces passed from Seaseis to SU (parent to child)
+  static int const RING_P2C = 0;
+  /// Ring index: Traces passed from SU to Seaseis (child to parent)
+  static int const RING_C2P = 1;
+
+  /**
+   * Trace ring buffer control block, placed in shared memory
+   * Only the producer increases 'count', only the consumer advances 'head'. Trace slots are written
+   * and read in place without holding the mutex.
+   */
+  struct ShmRing {
+    int numSlots;
+    int slotSize;
+    int head;
+    int count;
+    int isEOF;
+  };
+  /**
+   * Shared memory transport between Seaseis and the adapter process which runs the external SU binary
+   *
+   * Memory layout: ShmControl block, followed by trace slots of ring P2C, followed by trace slots of ring C2P.
+   * The adapter process is forked from Seaseis and inherits the (anonymous) shared memory mapping.
+   * It feeds the SU binary's stdin directly from the P2C trace slots, and reads the SU binary's stdout directly into
+   * the C2P trace slots. Consumed traces are acknowledged in batches.
+   * Seaseis waits on the process-shared condition variable. The adapter waits in poll(): Seaseis wakes it up
+   * by writing one byte into the 'doorbell' pipe, but only if the adapter has announced that it is about to wait.
+   */
+  struct ShmControl {
+    pthread_mutex_t mutex;
+    pthread_cond_t  cond;
+    int isAdapterWaiting;
+    ShmRing ring[2];
+  };
+  class ShmTransport {
+  public:
+    ShmTransport( int numSlots, int slotSizeP2C, int slotSizeC2P );
+    ~ShmTransport();
+    byte_t* slot( int ringIndex, int index ) const {
+      ShmRing const* ring = &myControl->ring[ringIndex];
+      return( myBuffer[ringIndex] + (size_t)((ring->head + index) % ring->numSlots) * (size_t)ring->slotSize );
+    }
+    //---- Methods used by Seaseis
+    /// Wait until a trace can be pushed, or traces are ready to be pulled. @return true if trace can be pushed
+    bool waitForPush( pid_t pidAdapter );
+    /// Wait until traces are ready to be pulled, or adapter has finished. @return Number of traces ready
+    int waitForPull( pid_t pidAdapter );
+    /// @return Number of traces ready to be pulled
+    int numPull();
+    /// @return Pointer to first free trace slot. Only valid if ring is not full
+    byte_t* freeSlot( int ringIndex );
+    void commit( int ringIndex, int numTraces );
+    void release( int ringIndex, int numTraces );
+    void setEOF( int ringIndex );
+    bool isEOF( int ringIndex );
+    bool isFull( int ringIndex );
+    //---- Method run in adapter process
+    void runAdapter( int fdSUIn, int fdSUOut );
+    /// Doorbell pipe: Adapter reads from fd[0], Seaseis writes into fd[1]
+    int fdDoorbell[2];
+  private:
+    void ringDoorbell();
+    void timedWait( pid_t pidAdapter );
+    ShmControl* myControl;
+    byte_t* myBuffer[2];
+    size_t myMemorySize;
+  };
 }
 using mod_sumodule::VariableStruct;
 
+void setTraceFromBuffer( VariableStruct* vars, byte_t const* bufferPtr, csTraceGather* traceGather, csTraceHeaderDef const* hdef, int numSamples );
+void setBufferFromTrace( VariableStruct* vars, csTrace const* trace, byte_t* bufferPtr );
+int pullShmTraces( VariableStruct* vars, csTraceGather* traceGather, csTraceHeaderDef const* hdef, int numSamples, bool waitForTraces, bool isDebug );
+
 //*************************************************************************************************
 // Init phase
 //
@@ -165,6 +244,29 @@ void init_mod_sumodule_( csParamManager* param, csInitPhaseEnv* env, csLogWriter
   vars->outputCounter = 0;
   vars->numSamplesIn = shdr->numSamples;
   vars->sampleIntIn = shdr->sampleInt;
+  vars->transport = mod_sumodule::TRANSPORT_SHM;
+  vars->shm = NULL;
+
+  //--------------------------------------------------
+  //
+  int numSlots = 64;
+  if( param->exists("transport") ) {
+    std::string text;
+    param->getString("transport",&text);
+    if( !text.compare("shm") ) {
+      vars->transport = mod_sumodule::TRANSPORT_SHM;
+      if( param->getNumValues("transport") > 1 ) {
+        param->getInt("transport", &numSlots, 1);
+        if( numSlots < 1 ) log->error("Number of trace slots must be larger than 0. Specified: %d", numSlots);
+      }
+    }
+    else if( !text.compare("pipe") ) {
+      vars->transport = mod_sumodule::TRANSPORT_PIPE;
+    }
+    else {
+      log->error("Unknown option: %s", text.c_str());
+    }
+  }
 
   //--------------------------------------------------
   //
@@ -230,6 +332,87 @@ void init_mod_sumodule_( csParamManager* param, csInitPhaseEnv* env, csLogWriter
     }
   }
 
+  //--------------------------------------------------
+  // Shared memory transport: Set up adapter process
+  //
+  if( vars->transport == mod_sumodule::TRANSPORT_SHM ) {
+    vars->totalTraceSizeIn  = 240 + vars->numSamplesIn*4;
+    vars->totalTraceSizeOut = 240 + shdr->numSamples*4;
+    try {
+      vars->shm = new mod_sumodule::ShmTransport( numSlots, vars->totalTraceSizeIn, vars->totalTraceSizeOut );
+    }
+    catch( csException& e ) {
+      log->error("%s", e.getMessage());
+    }
+    fflush(stdout);
+    fflush(log->getFile());
+    vars->pid = fork();
+    if( vars->pid == -1 ) {
+      log->error("Unable to fork new process: %s", strerror(errno));
+    }
+    if( vars->pid == 0 ) { // Adapter process
+      close( vars->shm->fdDoorbell[1] );
+      vars->shm->fdDoorbell[1] = -1;
+      signal( SIGPIPE, SIG_IGN );
+      int fdIn[2];
+      int fdOut[2];
+      if( pipe(fdIn) != 0 || pipe(fdOut) != 0 ) {
+        fprintf(stdout,"SU adapter process: Error creating pipes: %s\n", strerror(errno));
+        vars->shm->setEOF( mod_sumodule::RING_C2P );
+        _exit(-1);
+      }
+      pid_t pidSU = fork();
+      if( pidSU == 0 ) {  // SU process
+        dup2( fdIn[0], fileno(stdin) );
+        dup2( fdOut[1], fileno(stdout) );
+        close( fdIn[0] );  close( fdIn[1] );
+        close( fdOut[0] ); close( fdOut[1] );
+        close( vars->shm->fdDoorbell[0] );
+        vars->shm->fdDoorbell[0] = -1;
+        signal( SIGPIPE, SIG_DFL );
+        execv( suModulePath.c_str(), argumentList );
+        fprintf(stderr,"External SU process failed: %s (%s)\n", suModulePath.c_str(), strerror(errno));
+        _exit(-1);
+      }
+      close( fdIn[0] );
+      close( fdOut[1] );
+      if( pidSU < 0 ) {
+        fprintf(stdout,"SU adapter process: Unable to fork SU process: %s\n", strerror(errno));
+        close( fdIn[1] );
+        close( fdOut[0] );
+      }
+      else {
+        vars->shm->runAdapter( fdIn[1], fdOut[0] );
+        int status = 0;
+        waitpid( pidSU, &status, 0 );
+      }
+      vars->shm->setEOF( mod_sumodule::RING_C2P );
+      _exit(0);
+    }
+    close( vars->shm->fdDoorbell[0] );
+    vars->shm->fdDoorbell[0] = -1;
+
+    log->write("External SU process (shared memory transport, %d trace slots):\n  %s", numSlots, suModulePath.c_str());
+    for( int i = 1; i < numArguments; i++ ) { // Skip first element which is the SU module name
+      log->write(" %s", argumentList[i]);
+    }
+    log->write("\n");
+    for( int i = 0; i < numArguments; i++ ) {
+      delete [] argumentList[i];
+    }
+    delete [] argumentList;
+
+    vars->segyHdrMap = new csSegyHdrMap(csSegyHdrMap::SEGY_SU,true);
+    vars->segyTrcHdrRead  = new cseis_geolib::csSegyTraceHeader(vars->segyHdrMap);
+    vars->segyTrcHdrWrite = new cseis_geolib::csSegyTraceHeader(vars->segyHdrMap);
+    int numHeaders = vars->segyTrcHdrWrite->numHeaders();
+    vars->hdrIndexSegy = new int[numHeaders];
+    vars->hdrTypeSegy  = new type_t[numHeaders];
+    setHeaders( vars->segyTrcHdrWrite, vars->segyHdrMap, vars->hdrIndexSegy, vars->hdrTypeSegy, vars->numSamplesIn, vars->sampleIntIn, hdef, 1 );
+    setHeaders( vars->segyTrcHdrRead, vars->segyHdrMap, vars->hdrIndexSegy, vars->hdrTypeSegy, shdr->numSamples, shdr->sampleInt, hdef, -1 );
+    return;
+  }
+
   //--------------------------------------------------
   // Set up child process
   //
@@ -394,6 +577,17 @@ void exec_mod_sumodule_(
   csTraceHeaderDef const* hdef  = env->headerDef;
 
   if( edef->isCleanup() ) {
+    if( vars->shm != NULL ) {
+      // Tell adapter process to finish, in case the flow terminated early
+      vars->shm->setEOF( mod_sumodule::RING_P2C );
+      vars->shm->setEOF( mod_sumodule::RING_C2P );
+      if( vars->pid > 0 ) {
+        int status = 0;
+        waitpid( vars->pid, &status, 0 );
+      }
+      delete vars->shm;
+      vars->shm = NULL;
+    }
     if( vars->fd_c2p >= 0 )  close(vars->fd_p2c);
     if( vars->fd_p2c >= 0 )  close(vars->fd_c2p);
 
@@ -432,6 +626,42 @@ void exec_mod_sumodule_(
     return;
   }
 
+  //********************************************************************************
+  // Shared memory transport
+  //
+  if( vars->transport == mod_sumodule::TRANSPORT_SHM ) {
+    mod_sumodule::ShmTransport* shm = vars->shm;
+    if( traceGather->numTraces() != 0 ) {
+      vars->traceCounter += 1;
+      // Make sure a trace slot is free. Meanwhile, pull traces that are ready
+      while( !shm->waitForPush( vars->pid ) ) {
+        if( pullShmTraces( vars, traceGather, hdef, shdr->numSamples, false, edef->isDebug() ) == 0 && shm->isEOF(mod_sumodule::RING_C2P) ) break;
+      }
+      csTrace* trace = traceGather->trace(0);
+      if( shm->isEOF(mod_sumodule::RING_C2P) && shm->isFull(mod_sumodule::RING_P2C) ) {
+        // SU process does not accept any more traces: Discard input trace
+        if( edef->isDebug() ) fprintf(stdout,"Discard trace %d\n", vars->traceCounter);
+      }
+      else {
+        // Write trace directly into free slot of shared memory ring buffer
+        setBufferFromTrace( vars, trace, shm->freeSlot( mod_sumodule::RING_P2C ) );
+        shm->commit( mod_sumodule::RING_P2C, 1 );
+        if( edef->isDebug() ) fprintf(stdout,"Pushed trace %d\n", vars->traceCounter);
+      }
+      traceGather->freeTrace(0);
+    }
+    pullShmTraces( vars, traceGather, hdef, shdr->numSamples, false, edef->isDebug() );
+    if( !edef->isLastCall() ) {
+      edef->setTracesAreWaiting();
+    }
+    else {
+      shm->setEOF( mod_sumodule::RING_P2C );
+      // Wait until adapter process has passed on all traces from SU process
+      while( pullShmTraces( vars, traceGather, hdef, shdr->numSamples, true, edef->isDebug() ) > 0 );
+    }
+    return;
+  }
+
   // TEMP
   fd_set wio;
   FD_ZERO(&wio);
@@ -444,33 +674,8 @@ void exec_mod_sumodule_(
     vars->traceCounter += 1;
     csTrace* trace = traceGather->trace(0);
 
-    // Prepare output trace header to be passed on to SU command
-    csTraceHeader* trcHdr = trace->getTraceHeader();
-    int nHeadersSegy = vars->segyTrcHdrWrite->numHeaders();
-    for( int ihdr = 0; ihdr < nHeadersSegy; ihdr++ ) {
-      int hdrIdOut = vars->hdrIndexSegy[ihdr];
-      if( hdrIdOut < 0 ) continue;
-      if( vars->hdrTypeSegy[ihdr] == TYPE_FLOAT ) {
-	vars->segyTrcHdrWrite->setFloatValue( ihdr, trcHdr->floatValue( hdrIdOut )  );
-      }
-      else if( vars->hdrTypeSegy[ihdr] == TYPE_DOUBLE ) {
-	vars->segyTrcHdrWrite->setDoubleValue( ihdr, trcHdr->doubleValue(hdrIdOut) );
-      }
-      else if( vars->hdrTypeSegy[ihdr] == TYPE_INT ) {
-	vars->segyTrcHdrWrite->setIntValue( ihdr, trcHdr->intValue(hdrIdOut) );
-      }
-      else if( vars->hdrTypeSegy[ihdr] == TYPE_INT64 ) {
-	vars->segyTrcHdrWrite->setIntValue( ihdr, (int)trcHdr->int64Value(hdrIdOut) );
-      }
-      else {
-	vars->segyTrcHdrWrite->setStringValue( ihdr, trcHdr->stringValue(hdrIdOut) );
-      }
-    }
-    vars->segyTrcHdrWrite->writeHeaderValues(vars->bufferOut,vars->swapEndian,true);
-    float* samples = trace->getTraceSamples();
-    memcpy( &vars->bufferOut[240], (byte_t*)samples, vars->numSamplesIn*sizeof(float));
-
-    if( vars->swapEndian ) swapEndian4( (char*)(&vars->bufferOut[240]), vars->numSamplesIn*4 );
+    // Prepare output trace to be passed on to SU command
+    setBufferFromTrace( vars, trace, vars->bufferOut );
     traceGather->freeTrace(0);
 
     if( vars->threadParam->getIOFlag() != mod_sumodule::READING ) {
@@ -480,37 +685,10 @@ void exec_mod_sumodule_(
       }
       pthread_mutex_lock(&lock_x);
       for( int i = 0; i < vars->threadParam->bufferList.size(); i++ ) {
-        vars->outputCounter += 1;
-        if( edef->isDebug() ) fprintf(stdout,"Output trace #%d\n", vars->outputCounter);
-        csTrace* newTrace = traceGather->createTrace( hdef, shdr->numSamples );
-        csTraceHeader* newTrcHdr = newTrace->getTraceHeader();
-        float* newSamples = newTrace->getTraceSamples();
         byte_t* bufferPtr = vars->threadParam->bufferList.at(i);
-        memcpy(newSamples,&bufferPtr[240],shdr->numSamples*sizeof(float));
-        vars->segyTrcHdrRead->readHeaderValues( bufferPtr, vars->swapEndian, true );
+        setTraceFromBuffer( vars, bufferPtr, traceGather, hdef, shdr->numSamples );
         delete [] bufferPtr;
-        int nHeaders = vars->segyTrcHdrRead->numHeaders();
-        for( int ihdr = 0; ihdr < nHeaders; ihdr++ ) {
-          int hdrIdOut = vars->hdrIndexSegy[ihdr];
-          if( hdrIdOut < 0 ) continue;
-          switch( vars->hdrTypeSegy[ihdr] ) {
-          case TYPE_FLOAT:
-            newTrcHdr->setFloatValue( hdrIdOut, vars->segyTrcHdrRead->floatValue(ihdr) );
-            break;
-          case TYPE_DOUBLE:
-            newTrcHdr->setDoubleValue( hdrIdOut, vars->segyTrcHdrRead->doubleValue(ihdr) );
-            break;
-          case TYPE_INT:
-            newTrcHdr->setIntValue( hdrIdOut, vars->segyTrcHdrRead->intValue(ihdr) );
-            break;
-          case TYPE_INT64:
-            newTrcHdr->setInt64Value( hdrIdOut, (csInt64_t)vars->segyTrcHdrRead->intValue(ihdr) );
-            break;
-          case TYPE_STRING:
-            newTrcHdr->setStringValue( hdrIdOut, vars->segyTrcHdrRead->stringValue(ihdr) );
-            break;
-          }
-        }
+        if( edef->isDebug() ) fprintf(stdout,"Output trace #%d\n", vars->outputCounter);
       }
       vars->threadParam->bufferList.clear();
       pthread_mutex_unlock(&lock_x);
@@ -575,38 +753,10 @@ void exec_mod_sumodule_(
 
         pthread_mutex_lock(&lock_x);
         for( int i = 0; i < vars->threadParam->bufferList.size(); i++ ) {
-          vars->outputCounter += 1;
-          if( edef->isDebug() ) fprintf(stdout,"LAST Output trace #%d\n", vars->outputCounter);
-          csTrace* newTrace = traceGather->createTrace( hdef, shdr->numSamples );
-          csTraceHeader* trcHdr = newTrace->getTraceHeader();
-          float* samples = newTrace->getTraceSamples();
           byte_t* bufferPtr = vars->threadParam->bufferList.at(i);
-          memcpy(samples,&bufferPtr[240],shdr->numSamples*sizeof(float));
-          vars->segyTrcHdrRead->readHeaderValues( bufferPtr, vars->swapEndian, true );
+          setTraceFromBuffer( vars, bufferPtr, traceGather, hdef, shdr->numSamples );
           delete [] bufferPtr;
-
-          int nHeaders = vars->segyTrcHdrRead->numHeaders();
-          for( int ihdr = 0; ihdr < nHeaders; ihdr++ ) {
-            int hdrIdOut = vars->hdrIndexSegy[ihdr];
-            if( hdrIdOut < 0 ) continue;
-            switch( vars->hdrTypeSegy[ihdr] ) {
-            case TYPE_FLOAT:
-              trcHdr->setFloatValue( hdrIdOut, vars->segyTrcHdrRead->floatValue(ihdr) );
-              break;
-            case TYPE_DOUBLE:
-              trcHdr->setDoubleValue( hdrIdOut, vars->segyTrcHdrRead->doubleValue(ihdr) );
-              break;
-            case TYPE_INT:
-              trcHdr->setIntValue( hdrIdOut, vars->segyTrcHdrRead->intValue(ihdr) );
-              break;
-            case TYPE_INT64:
-              trcHdr->setInt64Value( hdrIdOut, (csInt64_t)vars->segyTrcHdrRead->intValue(ihdr) );
-              break;
-            case TYPE_STRING:
-              trcHdr->setStringValue( hdrIdOut, vars->segyTrcHdrRead->stringValue(ihdr) );
-              break;
-            }
-          }
+          if( edef->isDebug() ) fprintf(stdout,"LAST Output trace #%d\n", vars->outputCounter);
         }
         vars->threadParam->bufferList.clear();
         pthread_mutex_unlock(&lock_x);
@@ -764,6 +914,357 @@ int is_writeable(int fd) {
   return p.revents & POLLOUT;
 }
 
+//--------------------------------------------------------------------------------
+// Create new trace in trace gather from SU trace buffer
+//
+void setTraceFromBuffer( VariableStruct* vars, byte_t const* bufferPtr, csTraceGather* traceGather, csTraceHeaderDef const* hdef, int numSamples ) {
+  vars->outputCounter += 1;
+  csTrace* newTrace = traceGather->createTrace( hdef, numSamples );
+  csTraceHeader* newTrcHdr = newTrace->getTraceHeader();
+  float* newSamples = newTrace->getTraceSamples();
+  memcpy(newSamples,&bufferPtr[240],numSamples*sizeof(float));
+  if( vars->swapEndian ) swapEndian4( (char*)newSamples, numSamples*4 );
+  vars->segyTrcHdrRead->readHeaderValues( bufferPtr, vars->swapEndian, true );
+  int nHeaders = vars->segyTrcHdrRead->numHeaders();
+  for( int ihdr = 0; ihdr < nHeaders; ihdr++ ) {
+    int hdrIdOut = vars->hdrIndexSegy[ihdr];
+    if( hdrIdOut < 0 ) continue;
+    switch( vars->hdrTypeSegy[ihdr] ) {
+    case TYPE_FLOAT:
+      newTrcHdr->setFloatValue( hdrIdOut, vars->segyTrcHdrRead->floatValue(ihdr) );
+      break;
+    case TYPE_DOUBLE:
+      newTrcHdr->setDoubleValue( hdrIdOut, vars->segyTrcHdrRead->doubleValue(ihdr) );
+      break;
+    case TYPE_INT:
+      newTrcHdr->setIntValue( hdrIdOut, vars->segyTrcHdrRead->intValue(ihdr) );
+      break;
+    case TYPE_INT64:
+      newTrcHdr->setInt64Value( hdrIdOut, (csInt64_t)vars->segyTrcHdrRead->intValue(ihdr) );
+      break;
+    case TYPE_STRING:
+      newTrcHdr->setStringValue( hdrIdOut, vars->segyTrcHdrRead->stringValue(ihdr) );
+      break;
+    }
+  }
+}
+
+//--------------------------------------------------------------------------------
+// Write SU trace header and samples of input trace to SU trace buffer
+//
+void setBufferFromTrace( VariableStruct* vars, csTrace const* trace, byte_t* bufferPtr ) {
+  csTraceHeader const* trcHdr = trace->getTraceHeader();
+  int nHeadersSegy = vars->segyTrcHdrWrite->numHeaders();
+  for( int ihdr = 0; ihdr < nHeadersSegy; ihdr++ ) {
+    int hdrIdOut = vars->hdrIndexSegy[ihdr];
+    if( hdrIdOut < 0 ) continue;
+    switch( vars->hdrTypeSegy[ihdr] ) {
+    case TYPE_FLOAT:
+      vars->segyTrcHdrWrite->setFloatValue( ihdr, trcHdr->floatValue(hdrIdOut) );
+      break;
+    case TYPE_DOUBLE:
+      vars->segyTrcHdrWrite->setDoubleValue( ihdr, trcHdr->doubleValue(hdrIdOut) );
+      break;
+    case TYPE_INT:
+      vars->segyTrcHdrWrite->setIntValue( ihdr, trcHdr->intValue(hdrIdOut) );
+      break;
+    case TYPE_INT64:
+      vars->segyTrcHdrWrite->setIntValue( ihdr, (int)trcHdr->int64Value(hdrIdOut) );
+      break;
+    default:
+      vars->segyTrcHdrWrite->setStringValue( ihdr, trcHdr->stringValue(hdrIdOut) );
+      break;
+    }
+  }
+  vars->segyTrcHdrWrite->writeHeaderValues( bufferPtr, vars->swapEndian, true );
+  memcpy( &bufferPtr[240], trace->getTraceSamples(), vars->numSamplesIn*sizeof(float) );
+  if( vars->swapEndian ) swapEndian4( (char*)(&bufferPtr[240]), vars->numSamplesIn*4 );
+}
+
+//--------------------------------------------------------------------------------
+// Pull all traces that are ready in shared memory ring buffer. Traces are read in place, and released in one go.
+// @return Number of pulled traces
+//
+int pullShmTraces( VariableStruct* vars, csTraceGather* traceGather, csTraceHeaderDef const* hdef, int numSamples, bool waitForTraces, bool isDebug ) {
+  mod_sumodule::ShmTransport* shm = vars->shm;
+  int numTraces = waitForTraces ? shm->waitForPull( vars->pid ) : shm->numPull();
+  for( int itrc = 0; itrc < numTraces; itrc++ ) {
+    setTraceFromBuffer( vars, shm->slot( mod_sumodule::RING_C2P, itrc ), traceGather, hdef, numSamples );
+    if( isDebug ) fprintf(stdout,"Output trace #%d\n", vars->outputCounter);
+  }
+  shm->release( mod_sumodule::RING_C2P, numTraces );
+  return numTraces;
+}
+
+//--------------------------------------------------------------------------------
+//
+mod_sumodule::ShmTransport::ShmTransport( int numSlots, int slotSizeP2C, int slotSizeC2P ) {
+  fdDoorbell[0] = -1;
+  fdDoorbell[1] = -1;
+  size_t sizeControl = ((sizeof(ShmControl) + 63) / 64) * 64;
+  size_t sizeP2C = (size_t)numSlots * (size_t)slotSizeP2C;
+  size_t sizeC2P = (size_t)numSlots * (size_t)slotSizeC2P;
+  myMemorySize = sizeControl + sizeP2C + sizeC2P;
+  void* ptr = mmap( NULL, myMemorySize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0 );
+  if( ptr == MAP_FAILED ) {
+    throw( csException("Unable to allocate %lld bytes of shared memory: %s", (long long)myMemorySize, strerror(errno)) );
+  }
+  myControl = (ShmControl*)ptr;
+  myBuffer[RING_P2C] = (byte_t*)ptr + sizeControl;
+  myBuffer[RING_C2P] = (byte_t*)ptr + sizeControl + sizeP2C;
+
+  pthread_mutexattr_t mutexAttr;
+  pthread_mutexattr_init( &mutexAttr );
+  pthread_mutexattr_setpshared( &mutexAttr, PTHREAD_PROCESS_SHARED );
+  pthread_mutex_init( &myControl->mutex, &mutexAttr );
+  pthread_mutexattr_destroy( &mutexAttr );
+  pthread_condattr_t condAttr;
+  pthread_condattr_init( &condAttr );
+  pthread_condattr_setpshared( &condAttr, PTHREAD_PROCESS_SHARED );
+  pthread_cond_init( &myControl->cond, &condAttr );
+  pthread_condattr_destroy( &condAttr );
+
+  myControl->isAdapterWaiting = 0;
+  myControl->ring[RING_P2C].slotSize = slotSizeP2C;
+  myControl->ring[RING_C2P].slotSize = slotSizeC2P;
+  for( int iring = 0; iring < 2; iring++ ) {
+    myControl->ring[iring].numSlots = numSlots;
+    myControl->ring[iring].head  = 0;
+    myControl->ring[iring].count = 0;
+    myControl->ring[iring].isEOF = 0;
+  }
+  if( pipe( fdDoorbell ) != 0 ) {
+    csException e( "Unable to create pipe: %s", strerror(errno) );
+    fdDoorbell[0] = -1;
+    fdDoorbell[1] = -1;
+    pthread_cond_destroy( &myControl->cond );
+    pthread_mutex_destroy( &myControl->mutex );
+    munmap( myControl, myMemorySize );
+    throw( e );
+  }
+  fcntl( fdDoorbell[0], F_SETFL, O_NONBLOCK );
+  fcntl( fdDoorbell[1], F_SETFL, O_NONBLOCK );
+}
+mod_sumodule::ShmTransport::~ShmTransport() {
+  if( fdDoorbell[0] >= 0 ) close( fdDoorbell[0] );
+  if( fdDoorbell[1] >= 0 ) close( fdDoorbell[1] );
+  pthread_cond_destroy( &myControl->cond );
+  pthread_mutex_destroy( &myControl->mutex );
+  munmap( myControl, myMemorySize );
+}
+// Must be called with mutex locked
+void mod_sumodule::ShmTransport::ringDoorbell() {
+  if( myControl->isAdapterWaiting && fdDoorbell[1] >= 0 ) {
+    myControl->isAdapterWaiting = 0;
+    char c = 0;
+    if( write( fdDoorbell[1], &c, 1 ) < 0 ) {
+      // Pipe full: Adapter will wake up anyway
+    }
+  }
+}
+// Must be called with mutex locked. Wait for state change. Adapter process is checked once per second, in case it has died
+void mod_sumodule::ShmTransport::timedWait( pid_t pidAdapter ) {
+  struct timeval now;
+  gettimeofday( &now, NULL );
+  struct timespec timeout;
+  timeout.tv_sec  = now.tv_sec + 1;
+  timeout.tv_nsec = now.tv_usec * 1000;
+  if( pthread_cond_timedwait( &myControl->cond, &myControl->mutex, &timeout ) == ETIMEDOUT ) {
+    int status = 0;
+    if( pidAdapter > 0 && waitpid( pidAdapter, &status, WNOHANG ) == pidAdapter ) {
+      myControl->ring[RING_C2P].isEOF = 1;
+    }
+  }
+}
+bool mod_sumodule::ShmTransport::waitForPush( pid_t pidAdapter ) {
+  ShmRing* in  = &myControl->ring[RING_P2C];
+  ShmRing* out = &myControl->ring[RING_C2P];
+  pthread_mutex_lock( &myControl->mutex );
+  while( in->count == in->numSlots && out->count == 0 && !out->isEOF ) {
+    timedWait( pidAdapter );
+  }
+  bool hasSpace = ( in->count < in->numSlots );
+  pthread_mutex_unlock( &myControl->mutex );
+  return hasSpace;
+}
+int mod_sumodule::ShmTransport::waitForPull( pid_t pidAdapter ) {
+  ShmRing* out = &myControl->ring[RING_C2P];
+  pthread_mutex_lock( &myControl->mutex );
+  while( out->count == 0 && !out->isEOF ) {
+    timedWait( pidAdapter );
+  }
+  int numTraces = out->count;
+  pthread_mutex_unlock( &myControl->mutex );
+  return numTraces;
+}
+int mod_sumodule::ShmTransport::numPull() {
+  pthread_mutex_lock( &myControl->mutex );
+  int numTraces = myControl->ring[RING_C2P].count;
+  pthread_mutex_unlock( &myControl->mutex );
+  return numTraces;
+}
+byte_t* mod_sumodule::ShmTransport::freeSlot( int ringIndex ) {
+  ShmRing* ring = &myControl->ring[ringIndex];
+  pthread_mutex_lock( &myControl->mutex );
+  int index = ( ring->head + ring->count ) % ring->numSlots;
+  pthread_mutex_unlock( &myControl->mutex );
+  return( myBuffer[ringIndex] + (size_t)index * (size_t)ring->slotSize );
+}
+void mod_sumodule::ShmTransport::commit( int ringIndex, int numTraces ) {
+  if( numTraces <= 0 ) return;
+  pthread_mutex_lock( &myControl->mutex );
+  myControl->ring[ringIndex].count += numTraces;
+  pthread_cond_broadcast( &myControl->cond );
+  ringDoorbell();
+  pthread_mutex_unlock( &myControl->mutex );
+}
+void mod_sumodule::ShmTransport::release( int ringIndex, int numTraces ) {
+  if( numTraces <= 0 ) return;
+  ShmRing* ring = &myControl->ring[ringIndex];
+  pthread_mutex_lock( &myControl->mutex );
+  ring->head   = ( ring->head + numTraces ) % ring->numSlots;
+  ring->count -= numTraces;
+  pthread_cond_broadcast( &myControl->cond );
+  ringDoorbell();
+  pthread_mutex_unlock( &myControl->mutex );
+}
+void mod_sumodule::ShmTransport::setEOF( int ringIndex ) {
+  pthread_mutex_lock( &myControl->mutex );
+  myControl->ring[ringIndex].isEOF = 1;
+  pthread_cond_broadcast( &myControl->cond );
+  ringDoorbell();
+  pthread_mutex_unlock( &myControl->mutex );
+}
+bool mod_sumodule::ShmTransport::isEOF( int ringIndex ) {
+  pthread_mutex_lock( &myControl->mutex );
+  bool isEOF = ( myControl->ring[ringIndex].isEOF != 0 );
+  pthread_mutex_unlock( &myControl->mutex );
+  return isEOF;
+}
+bool mod_sumodule::ShmTransport::isFull( int ringIndex ) {
+  pthread_mutex_lock( &myControl->mutex );
+  bool isFull = ( myControl->ring[ringIndex].count == myControl->ring[ringIndex].numSlots );
+  pthread_mutex_unlock( &myControl->mutex );
+  return isFull;
+}
+
+//--------------------------------------------------------------------------------
+// Adapter process main loop
+// Traces are written to SU stdin directly from the P2C trace slots, and read from SU stdout directly into the C2P trace slots.
+// Written and read traces are acknowledged in one batch per loop iteration.
+//
+void mod_sumodule::ShmTransport::runAdapter( int fdSUIn, int fdSUOut ) {
+  ShmRing* in  = &myControl->ring[RING_P2C];
+  ShmRing* out = &myControl->ring[RING_C2P];
+  fcntl( fdSUIn, F_SETFL, O_NONBLOCK );
+  fcntl( fdSUOut, F_SETFL, O_NONBLOCK );
+  int numWritten  = 0;
+  int writeOffset = 0;
+  int numRead     = 0;
+  int readOffset  = 0;
+  bool isInClosed = false;
+  bool isOutEOF   = false;
+
+  while( !isOutEOF ) {
+    pthread_mutex_lock( &myControl->mutex );
+    if( numWritten > 0 || numRead > 0 ) {
+      in->head   = ( in->head + numWritten ) % in->numSlots;
+      in->count -= numWritten;
+      out->count += numRead;
+      pthread_cond_broadcast( &myControl->cond );
+      numWritten = 0;
+      numRead    = 0;
+    }
+    int numAvailable = in->count;
+    bool isInEOF     = ( in->isEOF != 0 );
+    int numFree      = out->numSlots - out->count;
+    int outTail      = out->head + out->count;
+    bool isAborted   = ( out->isEOF != 0 );  // Seaseis has terminated
+    myControl->isAdapterWaiting = 1;
+    pthread_mutex_unlock( &myControl->mutex );
+    if( isAborted ) break;
+
+    if( !isInClosed && numAvailable == 0 && isInEOF ) {
+      close( fdSUIn );
+      isInClosed = true;
+    }
+    if( isInClosed && numAvailable > 0 ) {
+      // SU process does not read any more input traces: Discard
+      numWritten = numAvailable;
+      continue;
+    }
+
+    struct pollfd fds[3];
+    int numFds = 0;
+    fds[numFds].fd = fdDoorbell[0];
+    fds[numFds++].events = POLLIN;
+    int idIn  = -1;
+    int idOut = -1;
+    if( !isInClosed && numAvailable > 0 ) {
+      idIn = numFds;
+      fds[numFds].fd = fdSUIn;
+      fds[numFds++].events = POLLOUT;
+    }
+    if( numFree > 0 ) {
+      idOut = numFds;
+      fds[numFds].fd = fdSUOut;
+      fds[numFds++].events = POLLIN;
+    }
+    if( poll( fds, numFds, -1 ) < 0 ) {
+      if( errno == EINTR ) continue;
+      break;
+    }
+    if( fds[0].revents ) {
+      char buffer[64];
+      while( read( fdDoorbell[0], buffer, 64 ) > 0 );
+    }
+    if( idIn >= 0 && fds[idIn].revents ) {
+      int slotSize = in->slotSize;
+      while( numWritten < numAvailable ) {
+        byte_t const* ptr = slot( RING_P2C, numWritten );
+        int sizeWrite = (int)write( fdSUIn, ptr + writeOffset, slotSize - writeOffset );
+        if( sizeWrite < 0 ) {
+          if( errno == EAGAIN || errno == EINTR ) break;
+          // SU process has closed its input
+          close( fdSUIn );
+          isInClosed  = true;
+          writeOffset = 0;
+          break;
+        }
+        writeOffset += sizeWrite;
+        if( writeOffset == slotSize ) {
+          numWritten += 1;
+          writeOffset = 0;
+        }
+      }
+    }
+    if( idOut >= 0 && fds[idOut].revents ) {
+      int slotSize = out->slotSize;
+      while( numRead < numFree ) {
+        byte_t* ptr = myBuffer[RING_C2P] + (size_t)((outTail + numRead) % out->numSlots) * (size_t)slotSize;
+        int sizeRead = (int)read( fdSUOut, ptr + readOffset, slotSize - readOffset );
+        if( sizeRead < 0 && (errno == EAGAIN || errno == EINTR) ) break;
+        if( sizeRead <= 0 ) {
+          isOutEOF = true;
+          break;
+        }
+        readOffset += sizeRead;
+        if( readOffset == slotSize ) {
+          numRead += 1;
+          readOffset = 0;
+        }
+      }
+    }
+  }
+  commit( RING_C2P, numRead );
+  pthread_mutex_lock( &myControl->mutex );
+  in->head   = ( in->head + numWritten ) % in->numSlots;
+  in->count -= numWritten;
+  pthread_mutex_unlock( &myControl->mutex );
+  if( !isInClosed ) close( fdSUIn );
+  close( fdSUOut );
+}
+
 #endif
 // END: LINUX SYSTEM
 
@@ -787,6 +1288,12 @@ void params_mod_sumodule_( csParamDef* pdef ) {
 
   pdef->addParam( "cwproot", "SU root directory", NUM_VALUES_FIXED, "By default, the environment variable $CWPROOT will be queried" );
   pdef->addValue( "", VALTYPE_STRING, "SU root directory, full path name" );
+
+  pdef->addParam( "transport", "Method of passing traces to and from external SU process", NUM_VALUES_VARIABLE );
+  pdef->addValue( "shm", VALTYPE_OPTION );
+  pdef->addOption( "shm", "Shared memory ring buffers. Traces are written once into shared memory, and passed on to SU by a separate adapter process" );
+  pdef->addOption( "pipe", "Named pipes" );
+  pdef->addValue( "64", VALTYPE_NUMBER, "Number of trace slots in each shared memory ring buffer" );
 }
 
 extern "C" void _params_mod_sumodule_( csParamDef* pdef ) {
@@ -3,6 +3,8 @@
 
 #include "cseis_includes.h"
 #include "csGeolibUtils.h"
+#include "csTransposeBuffer.h"
+#include <cstring>
 #include <cmath>
 
 using namespace cseis_system;
@@ -29,7 +31,11 @@ namespace mod_time_slice {
     int nSlices;
     int* sampleIndexSlice;
     int* hdrId_slice;
-    cseis_system::csTraceGather* gather;
+    /// Time slices, one row per slice. One column per output sample: dim2 x dim1
+    cseis_geolib::csTransposeBuffer* transpose;
+    float* sliceValues;
+    float* sliceBuffer;
+    int currentSlice;
 
     Dimension dim1;
     Dimension dim2;
@@ -70,7 +76,10 @@ void init_mod_time_slice_( csParamManager* param, csInitPhaseEnv* env, csLogWrit
   vars->nSlices     = 0;
   vars->hdrId_slice = NULL;
   vars->sampleIndexSlice = NULL;
-  vars->gather = NULL;
+  vars->transpose    = NULL;
+  vars->sliceValues  = NULL;
+  vars->sliceBuffer  = NULL;
+  vars->currentSlice = 0;
   vars->mode   = mod_time_slice::MODE_HEADER;
   vars->slice1     = 0;
   vars->slice2     = 0;
@@ -165,21 +174,27 @@ void init_mod_time_slice_( csParamManager* param, csInitPhaseEnv* env, csLogWrit
     }
     hdef->resetByteLocation();
 
-    vars->gather = new csTraceGather( hdef );
-    vars->gather->createTraces( 0, vars->dim2.nVal*vars->nSlices, hdef, shdr->numSamples );
-    for( int islice = 0; islice < vars->nSlices; islice++ ) {
-      float time = (float)vars->sampleIndexSlice[islice] * shdr->sampleInt;
-      for( int itrc = 0; itrc < vars->dim2.nVal; itrc++ ) {
-        int indexTrace = islice * vars->dim2.nVal + itrc;
-        csTraceHeader* trcHdr = vars->gather->trace(indexTrace)->getTraceHeader();
-        trcHdr->setFloatValue( vars->hdrId_time, time );
-        trcHdr->setIntValue( vars->hdrId_dim2, itrc * vars->dim2.inc + vars->dim2.val1 );
-        float* samples = vars->gather->trace(indexTrace)->getTraceSamples();
-        for( int isamp = 0; isamp < vars->dim1.nVal; isamp++ ) {
-          samples[isamp] = 0.0;
-        }
-      }
+    int maxMemory_mb = 2048;
+    if( param->exists("max_memory") ) {
+      param->getInt("max_memory", &maxMemory_mb);
+      if( maxMemory_mb <= 0 ) log->error("Maximum memory must be larger than 0. Specified: %dMB", maxMemory_mb);
+    }
+    std::string tempDir = "/tmp";
+    if( param->exists("temp_dir") ) {
+      param->getString("temp_dir", &tempDir);
+    }
+    try {
+      vars->transpose = new csTransposeBuffer( vars->nSlices, vars->dim2.nVal*vars->dim1.nVal, (csInt64_t)maxMemory_mb*1024*1024, tempDir );
+    }
+    catch( csException& e ) {
+      log->error("%s", e.getMessage());
+    }
+    if( vars->transpose->isOutOfCore() ) {
+      log->line("Time slices do not fit into %dMB of memory. Buffer time slices in temporary file '%s', %d slice(s) per block.",
+                maxMemory_mb, vars->transpose->tempFilename().c_str(), vars->transpose->numRowsBlock() );
     }
+    vars->sliceValues = new float[vars->nSlices];
+    vars->sliceBuffer = new float[vars->dim2.nVal*vars->dim1.nVal];
 
     vars->sampleIntIn  = shdr->sampleInt;
     vars->numSamplesIn = shdr->numSamples;
@@ -252,9 +267,17 @@ void exec_mod_time_slice_(
   csSuperHeader const* shdr = env->superHeader;
 
   if( edef->isCleanup()){
-    if( vars->gather != NULL ) {
-      delete vars->gather;
-      vars->gather = NULL;
+    if( vars->transpose != NULL ) {
+      delete vars->transpose;
+      vars->transpose = NULL;
+    }
+    if( vars->sliceValues != NULL ) {
+      delete [] vars->sliceValues;
+      vars->sliceValues = NULL;
+    }
+    if( vars->sliceBuffer != NULL ) {
+      delete [] vars->sliceBuffer;
+      vars->sliceBuffer = NULL;
     }
     if( vars->hdrId_slice != NULL ) {
       delete [] vars->hdrId_slice;
@@ -268,46 +291,64 @@ void exec_mod_time_slice_(
     return;
   }
 
-  float* samplesIn = traceGather->trace(0)->getTraceSamples();
-  csTraceHeader* trcHdr = traceGather->trace(0)->getTraceHeader();
-
   if( vars->mode == mod_time_slice::MODE_HEADER ) {
+    float* samplesIn = traceGather->trace(0)->getTraceSamples();
+    csTraceHeader* trcHdr = traceGather->trace(0)->getTraceHeader();
     for( int islice = 0; islice < vars->nSlices; islice++ ) {
       trcHdr->setFloatValue( vars->hdrId_slice[islice], samplesIn[vars->sampleIndexSlice[islice]] );
     }
+    return;
   }
-  else {
-    if( edef->isLastCall() ) {
-      vars->gather->moveTracesTo( 0, vars->gather->numTraces(), traceGather );
-    }
-    else {
-      int val_dim1 = trcHdr->intValue( vars->hdrId_dim1 );
-      int val_dim2 = trcHdr->intValue( vars->hdrId_dim2 );
-      int indexDim1 = (int)( (val_dim1-vars->dim1.val1)/vars->dim1.inc );
-      int indexDim2 = (int)( (val_dim2-vars->dim2.val1)/vars->dim2.inc );
-      bool isOK = ( (val_dim1 >= vars->dim1.val1) && (val_dim1 <= vars->dim1.val2) && (indexDim1*vars->dim1.inc+vars->dim1.val1 == val_dim1) );
-      isOK = isOK && ( (val_dim2 >= vars->dim2.val1) && (val_dim2 <= vars->dim2.val2) && (indexDim2*vars->dim2.inc+vars->dim2.val1 == val_dim2) );
-      if( isOK ) {
-        if( indexDim1 >= shdr->numSamples ) {
-          throw csException("Program bug: Incorrect samle index: %d  (numSamples = %d)\n", indexDim1, shdr->numSamples );
-        }
-        for( int islice = 0; islice < vars->nSlices; islice++ ) {
-          int indexTrace  = islice * vars->dim2.nVal + indexDim2;
-          if( indexTrace >= vars->gather->numTraces() ) {
-            throw csException("Program bug: Incorrect trace index: %d  (numTraces = %d)\n", indexTrace, vars->gather->numTraces() );
-          }
-          float* samples = vars->gather->trace(indexTrace)->getTraceSamples();
-          samples[indexDim1] = samplesIn[vars->sampleIndexSlice[islice]];
-        }
-      } // END isOK
-      // else {
-      //        log->warning("Throwing out trace with trace header values (dim1/dim2):  %d / %d", val_dim1, val_dim2);
-      // }
-      traceGather->freeAllTraces();
-      edef->setTracesAreWaiting();
-    }
+
+  if( traceGather->numTraces() > 0 ) {
+    float* samplesIn = traceGather->trace(0)->getTraceSamples();
+    csTraceHeader* trcHdr = traceGather->trace(0)->getTraceHeader();
+    int val_dim1 = trcHdr->intValue( vars->hdrId_dim1 );
+    int val_dim2 = trcHdr->intValue( vars->hdrId_dim2 );
+    int indexDim1 = (int)( (val_dim1-vars->dim1.val1)/vars->dim1.inc );
+    int indexDim2 = (int)( (val_dim2-vars->dim2.val1)/vars->dim2.inc );
+    bool isOK = ( (val_dim1 >= vars->dim1.val1) && (val_dim1 <= vars->dim1.val2) && (indexDim1*vars->dim1.inc+vars->dim1.val1 == val_dim1) );
+    isOK = isOK && ( (val_dim2 >= vars->dim2.val1) && (val_dim2 <= vars->dim2.val2) && (indexDim2*vars->dim2.inc+vars->dim2.val1 == val_dim2) );
+    if( isOK ) {
+      if( indexDim1 >= shdr->numSamples ) {
+        throw csException("Program bug: Incorrect samle index: %d  (numSamples = %d)\n", indexDim1, shdr->numSamples );
+      }
+      for( int islice = 0; islice < vars->nSlices; islice++ ) {
+        vars->sliceValues[islice] = samplesIn[vars->sampleIndexSlice[islice]];
+      }
+      vars->transpose->putColumn( indexDim2 * vars->dim1.nVal + indexDim1, vars->sliceValues );
+    } // END isOK
+    // else {
+    //        log->warning("Throwing out trace with trace header values (dim1/dim2):  %d / %d", val_dim1, val_dim2);
+    // }
+    traceGather->freeAllTraces();
+  }
+  if( !edef->isLastCall() ) {
+    edef->setTracesAreWaiting();
+    return;
   }
 
+  //--------------------------------------------------------------------------------
+  // All input traces have been collected: Output one time slice per call
+  //
+  if( vars->currentSlice < vars->nSlices ) {
+    csTraceHeaderDef const* hdef = env->headerDef;
+    int islice = vars->currentSlice;
+    vars->transpose->getRow( islice, vars->sliceBuffer );
+    float time = (float)vars->sampleIndexSlice[islice] * vars->sampleIntIn;
+    traceGather->createTraces( 0, vars->dim2.nVal, hdef, shdr->numSamples );
+    for( int itrc = 0; itrc < vars->dim2.nVal; itrc++ ) {
+      csTraceHeader* trcHdr = traceGather->trace(itrc)->getTraceHeader();
+      trcHdr->setFloatValue( vars->hdrId_time, time );
+      trcHdr->setIntValue( vars->hdrId_dim2, itrc * vars->dim2.inc + vars->dim2.val1 );
+      float* samples = traceGather->trace(itrc)->getTraceSamples();
+      memcpy( samples, &vars->sliceBuffer[itrc*vars->dim1.nVal], vars->dim1.nVal * sizeof(float) );
+    }
+    vars->currentSlice += 1;
+  }
+  if( vars->currentSlice < vars->nSlices ) {
+    edef->setTracesAreWaiting();
+  }
 }
 
 //*************************************************************************************************
@@ -345,6 +386,12 @@ void params_mod_time_slice_( csParamDef* pdef ) {
   pdef->addValue( "", VALTYPE_NUMBER, "End value" );
   pdef->addValue( "", VALTYPE_NUMBER, "Increment" );
 
+  pdef->addParam( "max_memory", "Maximum memory for holding time slices [MB]", NUM_VALUES_FIXED, "Only used in mode 'data'" );
+  pdef->addValue( "2048", VALTYPE_NUMBER, "Maximum memory [MB]", "If all time slices do not fit into this memory size, slices are buffered in a temporary file and transposed block by block" );
+
+  pdef->addParam( "temp_dir", "Directory for temporary file", NUM_VALUES_FIXED, "Only used in mode 'data', if time slices do not fit into memory" );
+  pdef->addValue( "/tmp", VALTYPE_STRING, "Directory name" );
+
   pdef->addParam( "domain", "Time or sample domain", NUM_VALUES_FIXED );
   pdef->addValue( "time", VALTYPE_OPTION );
   pdef->addOption( "time", "Window is specified in time [ms] (or frequency [Hz])" );
@@ -5,6 +5,7 @@
 #include "csSegdFunctions.h"
 #include <iomanip>
 #include <cmath>
+#include <cstring>
 
 using namespace std;
 
@@ -317,6 +318,65 @@ namespace cseis_segd {
     }
   }
 
+  //---------------------------------------------------------------
+  // Sample decoding
+  // Loops are written without function calls or branches per sample so that the compiler can vectorise them.
+  //
+  bool decodeSamples( int segdFormatCode, byte const* in, float* out, int numSamples, float scalar ) {
+    switch( segdFormatCode ) {
+    case 8015:
+      decodeSamples_8015( in, out, numSamples, scalar );
+      return true;
+    case 8036:
+      decodeSamples_8036( in, out, numSamples, scalar );
+      return true;
+    case 8058:
+      decodeSamples_8058( in, out, numSamples, scalar );
+      return true;
+    default:
+      return false;
+    }
+  }
+
+  // 32 bit IEEE, big endian
+  void decodeSamples_8058( byte const* in, float* out, int numSamples, float scalar ) {
+    for( int isamp = 0; isamp < numSamples; isamp++ ) {
+      byte const* ptr = &in[4*isamp];
+      unsigned int word = ( (unsigned int)ptr[0] << 24 ) | ( (unsigned int)ptr[1] << 16 ) | ( (unsigned int)ptr[2] << 8 ) | (unsigned int)ptr[3];
+      float value;
+      memcpy( &value, &word, 4 );
+      out[isamp] = value * scalar;
+    }
+  }
+
+  // 24 bit 2's complement integer, big endian
+  void decodeSamples_8036( byte const* in, float* out, int numSamples, float scalar ) {
+    for( int isamp = 0; isamp < numSamples; isamp++ ) {
+      byte const* ptr = &in[3*isamp];
+      int accum = ( (int)ptr[0] << 16 ) | ( (int)ptr[1] << 8 ) | (int)ptr[2];
+      int value = (accum ^ 0x800000) - 0x800000;
+      out[isamp] = (float)value * scalar;
+    }
+  }
+
+  // 20 bit binary: Groups of 4 samples, one 16bit word holding 4 exponents followed by 4 16bit fractions
+  void decodeSamples_8015( byte const* in, float* out, int numSamples, float scalar ) {
+    static float const powerOfTwo[16] = { 1.0f, 2.0f, 4.0f, 8.0f, 16.0f, 32.0f, 64.0f, 128.0f,
+                                          256.0f, 512.0f, 1024.0f, 2048.0f, 4096.0f, 8192.0f, 16384.0f, 32768.0f };
+    short group[5];
+    for( int isamp = 0; isamp < numSamples; isamp += 4 ) {
+      memcpy( group, &in[10*(isamp/4)], 10 );
+      int allExponents = group[0];
+      int numSamplesGroup = numSamples - isamp < 4 ? numSamples - isamp : 4;
+      for( int i = 0; i < numSamplesGroup; i++ ) {
+        int expo = (allExponents >> (4*i)) & 15;
+        int frac = group[i+1];
+        if( frac < 0 ) frac += 1;
+        out[isamp+i] = ( (float)frac * powerOfTwo[expo] ) * scalar;
+      }
+    }
+  }
+
   void dumpCommonHeaders( commonTraceHeaderStruct& comTrcHdr ) {
     fprintf(stdout,"chanNum: %d, chanTypeID: %d, traceEdit: %d\n", comTrcHdr.chanNum, comTrcHdr.chanTypeID, comTrcHdr.traceEdit);
     fprintf(stdout,"rcvLineNum: %d, rcvPointNum: %d, rcvPointIndex: %d\n", comTrcHdr.rcvLineNumber, comTrcHdr.rcvPointNumber, comTrcHdr.rcvPointIndex );
@@ -34,6 +34,21 @@ namespace cseis_segd {
   /// Return external header identifier
   int manufacturerRecordingSystem( int manufactCode );
 
+  /**
+   * Decode demultiplexed SEGD trace samples and apply descale factor in one pass
+   * Supported format codes: 8015, 8036, 8058
+   * @param segdFormatCode SEGD format code
+   * @param in         (i) Raw trace samples as stored in SEGD record. Input buffer is not modified
+   * @param out        (o) Decoded samples
+   * @param numSamples Number of samples to decode
+   * @param scalar     Descale factor (MP factor) applied to all samples
+   * @return false if format code is not supported
+   */
+  bool decodeSamples( int segdFormatCode, byte const* in, float* out, int numSamples, float scalar );
+  void decodeSamples_8015( byte const* in, float* out, int numSamples, float scalar );
+  void decodeSamples_8036( byte const* in, float* out, int numSamples, float scalar );
+  void decodeSamples_8058( byte const* in, float* out, int numSamples, float scalar );
+
   void dumpRawHex( std::ostream& os, byte const* buffer, int numBytes );
   void dumpRawHex( FILE* file, byte const* buffer, int numBytes );
   void dumpRawASCII( std::ostream& os, byte const* buffer, int numBytes );
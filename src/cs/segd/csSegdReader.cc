@@ -15,7 +15,6 @@
 
 #include "csTimer.h"
 #include "csException.h"
-#include "geolib_endian.h"
 
 #include <iostream>
 #include <iomanip>
@@ -29,11 +28,6 @@ using std::endl;
 using std::string;
 using std::memcpy;
 
-void convertToFloat_20bit( short const* in, float* out, int numSamples );
-void convertToFloat_24bit( unsigned char const* in, float* out, int numSamples );
-
-#define SIGNBIT (1UL << 23)
-
 csSegdReader::csSegdReader() {
   myRecordingSystemID = UNKNOWN;
   myFile = NULL;
@@ -706,7 +700,7 @@ bool csSegdReader::getNextTrace( float* trace, commonTraceHeaderStruct& comTrcHd
   myBytePos.currentTraceData += myFullTraceByteSize[mySequentialChanSetIndexCounter];
   int dataByteSize = traceDataByteSize(mySequentialChanSetIndexCounter);
   int numSamples = myChanSetNumSamples[mySequentialChanSetIndexCounter];
-  extractCommonTraceHeaders( &myBuffer_oneRecord[bytePosHdr], comTrcHdr );
+  extractCommonTraceHeaders( &myBuffer_oneRecord[bytePosHdr], comTrcHdr, mySequentialTraceCounter );
   comTrcHdr.chanSet      = mySequentialChanSetIndexCounter + 1; // +1 to convert to 'user-domain' number starting at 1
   comTrcHdr.numSamples   = myChanSetNumSamples[mySequentialChanSetIndexCounter];
   comTrcHdr.sampleInt_us = myChanSetSampleInt_us[mySequentialChanSetIndexCounter];
@@ -723,23 +717,8 @@ bool csSegdReader::getNextTrace( float* trace, commonTraceHeaderStruct& comTrcHd
   mySequentialTraceCounter += 1;
 
   if( comTrcHdr.chanTypeID == 1 || myConfig.readAuxTraces ) {  // Only read in if this is a seismic trace, or if aux traces shall be read in as well
-    switch( myComFileHdr.formatCode ) {
-    case 8058:
-      cseis_geolib::swapEndian4( reinterpret_cast<char*>(&myBuffer_oneRecord[bytePosData]), dataByteSize );
-      memcpy( trace, &myBuffer_oneRecord[bytePosData], dataByteSize );
-      break;
-    case 8015:
-      convertToFloat_20bit( reinterpret_cast<short*>(&myBuffer_oneRecord[bytePosData]), trace, numSamples );
-      break;
-    case 8036:
-      fprintf(stdout,"Byte pos %d  numSamples %d  byteSize %d\n", bytePosData, numSamples, dataByteSize);
-      convertToFloat_24bit( reinterpret_cast<unsigned char*>(&myBuffer_oneRecord[bytePosData]), trace, numSamples );
-      break;
-    }
-  
-    for( int i = 0; i < numSamples; i++ ) {
-      trace[i] *= (float)myMPDescaleOperator[mySequentialChanSetIndexCounter];
-    }
+    decodeSamples( myComFileHdr.formatCode, &myBuffer_oneRecord[bytePosData], trace, numSamples,
+                   (float)myMPDescaleOperator[mySequentialChanSetIndexCounter] );
   }
   else { // try reading in next trace
     retValue = getNextTrace( trace, comTrcHdr );
@@ -749,6 +728,41 @@ bool csSegdReader::getNextTrace( float* trace, commonTraceHeaderStruct& comTrcHd
   return retValue;
 }
 //---------------------------------------------------------
+int csSegdReader::getChanSetGather( int chanSetIndex, float* samples, commonTraceHeaderStruct* comTrcHdrs ) {
+  if( chanSetIndex < 0 || chanSetIndex >= (myNumScanTypes * myNumChanSetsPerScanType) ) {
+    throw( csException("csSegdReader::getChanSetGather: Wrong chan set index passed: %d\n", chanSetIndex) );
+  }
+  // Byte position and sequential index of first trace in requested channel set
+  int bytePosData = myBytePos.firstTraceData;
+  int traceIndex  = 0;
+  for( int ichanset = 0; ichanset < chanSetIndex; ichanset++ ) {
+    bytePosData += myChanSetHdr[ichanset].numChannels * myFullTraceByteSize[ichanset];
+    traceIndex  += myChanSetHdr[ichanset].numChannels;
+  }
+  int numChannels  = myChanSetHdr[chanSetIndex].numChannels;
+  int numSamples   = myChanSetNumSamples[chanSetIndex];
+  int sampleInt_us = myChanSetSampleInt_us[chanSetIndex];
+  int hdrByteOffset = csTraceHeader::BLOCK_SIZE;
+  if( myTraceHdrExtension ) hdrByteOffset += csBaseHeader::BLOCK_SIZE * myTraceHdrExtension->numBlocks();
+  float scalar = (float)myMPDescaleOperator[chanSetIndex];
+
+  int numTracesOut = 0;
+  commonTraceHeaderStruct comTrcHdr;
+  for( int ichan = 0; ichan < numChannels && traceIndex < myComFileHdr.totalNumChan; ichan++, traceIndex++ ) {
+    commonTraceHeaderStruct& hdr = ( comTrcHdrs != NULL ) ? comTrcHdrs[numTracesOut] : comTrcHdr;
+    extractCommonTraceHeaders( &myBuffer_oneRecord[bytePosData-hdrByteOffset], hdr, traceIndex );
+    if( hdr.chanTypeID == 1 || myConfig.readAuxTraces ) {
+      hdr.chanSet      = chanSetIndex + 1;
+      hdr.numSamples   = numSamples;
+      hdr.sampleInt_us = sampleInt_us;
+      decodeSamples( myComFileHdr.formatCode, &myBuffer_oneRecord[bytePosData], &samples[numTracesOut*numSamples], numSamples, scalar );
+      numTracesOut += 1;
+    }
+    bytePosData += myFullTraceByteSize[chanSetIndex];
+  }
+  return numTracesOut;
+}
+//---------------------------------------------------------
 //
 void csSegdReader::extractCommonRecordHeaders( commonRecordHeaderStruct& comRecHdr ) {
   myGeneralHdr1->extractHeaders( myBuffer_oneRecord );
@@ -772,11 +786,11 @@ void csSegdReader::extractCommonRecordHeaders( commonRecordHeaderStruct& comRecH
 }
 //---------------------------------------------------------
 //
-void csSegdReader::extractCommonTraceHeaders( byte const* bufferPtr, commonTraceHeaderStruct& comTrcHdr ) {
+void csSegdReader::extractCommonTraceHeaders( byte const* bufferPtr, commonTraceHeaderStruct& comTrcHdr, int traceIndex ) {
   myTraceHdr->extractHeaders( bufferPtr );
   comTrcHdr.chanNum    = myTraceHdr->traceNumber;
   comTrcHdr.traceEdit  = myTraceHdr->traceEdit;
-  comTrcHdr.chanTypeID = myChanTypeID[mySequentialTraceCounter];
+  comTrcHdr.chanTypeID = myChanTypeID[traceIndex];
 
   //  myTraceHdr->dump( cout );
 
@@ -964,49 +978,6 @@ int csSegdReader::traceDataByteSize( int chanSetIndex ) const {
   }
 }
 
-void convertToFloat_20bit( short const* in, float* out, int numSamples ) {
-  int counter_2bytes = 0;
-
-  for( int isamp = 0; isamp < numSamples; isamp +=4 ) {
-    short allExponents = (int)in[counter_2bytes++];
-    int expo1 = (allExponents & 15);
-    int expo2 = ((allExponents >> 4) & 15);
-    int expo3 = ((allExponents >> 8) & 15);
-    int expo4 = ((allExponents >> 12) & 15);
-    short frac1 = in[counter_2bytes++];
-    short frac2 = in[counter_2bytes++];
-    short frac3 = in[counter_2bytes++];
-    short frac4 = in[counter_2bytes++];
-
-    if( frac1 < 0 ) frac1 = (short)-(~frac1);
-    if( frac2 < 0 ) frac2 = (short)-(~frac2);
-    if( frac3 < 0 ) frac3 = (short)-(~frac3);
-    if( frac4 < 0 ) frac4 = (short)-(~frac4);
-
-    out[isamp]   = ldexp( (double)frac1, expo1 );
-    out[isamp+1] = ldexp( (double)frac2, expo2 );
-    out[isamp+2] = ldexp( (double)frac3, expo3 );
-    out[isamp+3] = ldexp( (double)frac4, expo4 );
-
-    // fprintf(stdout,"Expo: %4x -- %4d %4d %4d %4d -- %6d %6d %6d %6d -- %f %f %f %f\n",
-    // allExponents, expo1, expo2, expo3, expo4, frac1, frac2, frac3, frac4, out[isamp], out[isamp+1], out[isamp+2], out[isamp+3]);
-
-  }
-}
-
-void convertToFloat_24bit( unsigned char const* in, float* out, int numSamples ) {
-  int counter = 0;
-  for( int isamp = 0; isamp < numSamples; isamp++ ) {
-    unsigned long accum;
-    accum = (unsigned long)in[counter+0] << 16; // Top most byte
-    accum |= (unsigned)in[counter+1] << 8;
-    accum |= in[counter+2];
-    long val = (long)(accum ^ SIGNBIT) - (long)SIGNBIT;
-    out[isamp] = (float)val;
-    counter += 3;
-  }
-}
-
 int csSegdReader::numTraces() const {
   if( myConfig.readAuxTraces ) {
     return myComFileHdr.totalNumChan;
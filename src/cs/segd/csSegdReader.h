@@ -116,6 +116,16 @@ public:
   * @return false if no further traces are found in this record, or if current record has not been fully read in yet
   */
   bool getNextTrace( float* trace, commonTraceHeaderStruct& comTrcHdr );
+  /**
+  * Decode all traces of one channel set of the current record into one contiguous gather.
+  * Traces are decoded directly from the record buffer. Sequential retrieval via getNextTrace() is not affected.
+  * Auxiliary traces are skipped unless configured to be read in.
+  * @param chanSetIndex  Channel set index, starting at 0
+  * @param samples    (o) Gather samples, trace i starts at samples[i*numSamples]. Must hold numChannels*numSamples of this channel set
+  * @param comTrcHdrs (o) Common trace headers, one for each output trace. Must hold numChannels entries, or NULL
+  * @return Number of traces written to output gather
+  */
+  int getChanSetGather( int chanSetIndex, float* samples, commonTraceHeaderStruct* comTrcHdrs );
   float const* getNextTracePointer( commonTraceHeaderStruct& comTrcHdr );
   /**
   * @return common file headers
@@ -179,7 +189,7 @@ private:
   /// Extract common set of headers for current record
   void extractCommonRecordHeaders( commonRecordHeaderStruct& comRecHdr );
   /// Extract common set of headers for current trace
-  void extractCommonTraceHeaders( byte const* bufferPtr, commonTraceHeaderStruct& commonTrcHdr );
+  void extractCommonTraceHeaders( byte const* bufferPtr, commonTraceHeaderStruct& commonTrcHdr, int traceIndex );
 
   std::string myFileName;
   FILE* myFile;
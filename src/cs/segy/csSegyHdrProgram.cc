@@ -0,0 +1,401 @@
+/* Copyright (c) Colorado School of Mines, 2013.*/
+/* All rights reserved.                       */
+
+#include "csSegyHdrProgram.h"
+#include "csSegyHdrMap.h"
+#include "csSegyHeaderInfo.h"
+#include "csSegyHeader.h"
+#include "csFlexHeader.h"
+#include "csByteConversions.h"
+#include "csException.h"
+#include <cmath>
+#include <cstring>
+#include <string>
+
+using namespace cseis_geolib;
+
+namespace {
+  int const SIZE_TRCHDR = csSegyHeader::SIZE_TRCHDR;
+
+  inline void swapWords2( byte_t* ptr, int numWords ) {
+    for( int i = 0; i < 2*numWords; i += 2 ) {
+      byte_t b0 = ptr[i];
+      ptr[i]   = ptr[i+1];
+      ptr[i+1] = b0;
+    }
+  }
+  inline void swapWords4( byte_t* ptr, int numWords ) {
+    for( int i = 0; i < 4*numWords; i += 4 ) {
+      byte_t b0 = ptr[i];
+      byte_t b1 = ptr[i+1];
+      ptr[i]   = ptr[i+3];
+      ptr[i+1] = ptr[i+2];
+      ptr[i+2] = b1;
+      ptr[i+3] = b0;
+    }
+  }
+  inline int readInt( byte_t const* ptr, bool doSwap ) {
+    return( doSwap ? byte2Int_SWAP( ptr ) : byte2Int( ptr ) );
+  }
+  inline int readShort( byte_t const* ptr, bool doSwap ) {
+    return( doSwap ? byte2Short_SWAP( ptr ) : byte2Short( ptr ) );
+  }
+  inline float readFloat( byte_t const* ptr, bool doSwap ) {
+    int bits = readInt( ptr, doSwap );
+    float value;
+    memcpy( &value, &bits, 4 );
+    return value;
+  }
+  inline void writeInt( int value, byte_t* ptr, bool doSwap ) {
+    if( doSwap ) int2Byte_SWAP( value, ptr );
+    else int2Byte( value, ptr );
+  }
+  inline void writeShort( short value, byte_t* ptr, bool doSwap ) {
+    if( doSwap ) short2Byte_SWAP( value, ptr );
+    else short2Byte( value, ptr );
+  }
+}
+
+//--------------------------------------------------------------------------------
+csSegyHdrProgram::csSegyHdrProgram( csSegyHdrMap const* hdrMap ) {
+  myNumHeaders = hdrMap->numHeaders();
+  myDecodeOps = new Op[myNumHeaders > 0 ? myNumHeaders : 1];
+  myEncodeOps = new Op[myNumHeaders > 0 ? myNumHeaders : 1];
+  myNumEncodeOps = 0;
+
+  Op* ops = new Op[myNumHeaders > 0 ? myNumHeaders : 1];
+  int numOps = 0;
+  for( int ihdr = 0; ihdr < myNumHeaders; ihdr++ ) {
+    csSegyHeaderInfo const* info = hdrMap->header( ihdr );
+    Op op;
+    op.byteLoc  = info->byteLoc;
+    op.byteSize = info->byteSize;
+    op.hdrIndex = ihdr;
+    if( info->inType == TYPE_SHORT || (info->inType == TYPE_INT && info->byteSize == 2) ) {
+      op.type = OP_INT2;
+    }
+    else if( info->inType == TYPE_INT ) {
+      op.type = OP_INT4;
+    }
+    else if( info->inType == TYPE_USHORT ) {
+      op.type = OP_UINT2;
+    }
+    else if( info->inType == TYPE_FLOAT ) {
+      op.type = OP_FLOAT4;
+    }
+    else if( info->inType == TYPE_STRING ) {
+      op.type = OP_STRING;
+    }
+    else if( info->inType == csSegyHdrMap::SEGY_HDR_TYPE_6BYTE ) {
+      op.type = OP_6BYTE;
+    }
+    else {
+      continue;  // Other types are not decoded
+    }
+    ops[numOps++] = op;
+    if( op.type != OP_STRING && op.type != OP_6BYTE ) {
+      myEncodeOps[myNumEncodeOps++] = op;
+    }
+  }
+  // Group decode instructions by type
+  int numDecodeOps = 0;
+  for( int type = 0; type < NUM_OP_TYPES; type++ ) {
+    myOpStart[type] = numDecodeOps;
+    for( int iop = 0; iop < numOps; iop++ ) {
+      if( ops[iop].type == type ) myDecodeOps[numDecodeOps++] = ops[iop];
+    }
+  }
+  myOpStart[NUM_OP_TYPES] = numDecodeOps;
+  delete [] ops;
+
+  for( int mode = 0; mode < 2; mode++ ) {
+    mySwapRuns[mode][0] = NULL;
+    mySwapRuns[mode][1] = NULL;
+    setSwapRuns( mode == 1 );
+  }
+
+  myHdrIndexScalarCoord = hdrMap->getCoordScalarHeaderIndex();
+  myHdrIndexScalarElev  = hdrMap->getElevScalarHeaderIndex();
+  myHdrIndexScalarStat  = hdrMap->getStatScalarHeaderIndex();
+  myNumCoordHeaders = hdrMap->numCoordHeaders();
+  myNumElevHeaders  = hdrMap->numElevHeaders();
+  myNumStatHeaders  = hdrMap->numStatHeaders();
+  myHdrIndexCoord = new int[myNumCoordHeaders > 0 ? myNumCoordHeaders : 1];
+  myHdrIndexElev  = new int[myNumElevHeaders > 0 ? myNumElevHeaders : 1];
+  myHdrIndexStat  = new int[myNumStatHeaders > 0 ? myNumStatHeaders : 1];
+  for( int i = 0; i < myNumCoordHeaders; i++ ) {
+    myHdrIndexCoord[i] = hdrMap->getCoordHeaderIndex( i );
+  }
+  for( int i = 0; i < myNumElevHeaders; i++ ) {
+    myHdrIndexElev[i] = hdrMap->getElevHeaderIndex( i );
+  }
+  for( int i = 0; i < myNumStatHeaders; i++ ) {
+    myHdrIndexStat[i] = hdrMap->getStatHeaderIndex( i );
+  }
+}
+csSegyHdrProgram::~csSegyHdrProgram() {
+  delete [] myDecodeOps;
+  delete [] myEncodeOps;
+  for( int mode = 0; mode < 2; mode++ ) {
+    delete [] mySwapRuns[mode][0];
+    delete [] mySwapRuns[mode][1];
+  }
+  delete [] myHdrIndexCoord;
+  delete [] myHdrIndexElev;
+  delete [] myHdrIndexStat;
+}
+//--------------------------------------------------------------------------------
+// Determine which bytes of the header block belong to which word, then collect runs of adjacent words of same size
+//
+void csSegyHdrProgram::setSwapRuns( bool isEncode ) {
+  int mode = isEncode ? 1 : 0;
+  int wordLoc[SIZE_TRCHDR];
+  int wordSize[SIZE_TRCHDR];
+  for( int ibyte = 0; ibyte < SIZE_TRCHDR; ibyte++ ) {
+    wordLoc[ibyte]  = -1;
+    wordSize[ibyte] = 0;
+  }
+  Op const* ops = isEncode ? myEncodeOps : myDecodeOps;
+  int numOps    = isEncode ? myNumEncodeOps : myOpStart[NUM_OP_TYPES];
+  bool isConflict = false;
+  for( int iop = 0; iop < numOps; iop++ ) {
+    int numWords = 1;
+    int loc[SIZE_TRCHDR];
+    int size[SIZE_TRCHDR];
+    loc[0] = ops[iop].byteLoc;
+    switch( ops[iop].type ) {
+    case OP_INT4:
+    case OP_FLOAT4:
+      size[0] = 4;
+      break;
+    case OP_INT2:
+    case OP_UINT2:
+      size[0] = 2;
+      break;
+    case OP_6BYTE:
+      size[0] = 4;
+      loc[1]  = loc[0] + 4;
+      size[1] = 2;
+      numWords = 2;
+      break;
+    case OP_STRING:
+      // Strings are not swapped. Every byte is a word of its own
+      numWords = ops[iop].byteSize;
+      for( int i = 0; i < numWords; i++ ) {
+        loc[i]  = loc[0] + i;
+        size[i] = 1;
+      }
+      break;
+    }
+    for( int iword = 0; iword < numWords; iword++ ) {
+      for( int ibyte = loc[iword]; ibyte < loc[iword] + size[iword]; ibyte++ ) {
+        if( ibyte >= SIZE_TRCHDR ) {
+          isConflict = true;
+        }
+        else if( wordLoc[ibyte] < 0 ) {
+          wordLoc[ibyte]  = loc[iword];
+          wordSize[ibyte] = size[iword];
+        }
+        else if( wordLoc[ibyte] != loc[iword] || wordSize[ibyte] != size[iword] ) {
+          isConflict = true;
+        }
+      }
+    }
+  }
+
+  myIsBlockSwap[mode] = !isConflict;
+  myNumSwapRuns[mode][0] = 0;
+  myNumSwapRuns[mode][1] = 0;
+  mySwapRuns[mode][0] = new SwapRun[SIZE_TRCHDR/2];
+  mySwapRuns[mode][1] = new SwapRun[SIZE_TRCHDR/4];
+  int ibyte = 0;
+  while( ibyte < SIZE_TRCHDR ) {
+    int size = wordSize[ibyte];
+    if( wordLoc[ibyte] != ibyte || (size != 2 && size != 4) ) {
+      ibyte += 1;
+      continue;
+    }
+    int irun = size / 4;
+    SwapRun& run = mySwapRuns[mode][irun][myNumSwapRuns[mode][irun]++];
+    run.byteLoc  = ibyte;
+    run.numWords = 0;
+    while( ibyte < SIZE_TRCHDR && wordLoc[ibyte] == ibyte && wordSize[ibyte] == size ) {
+      run.numWords += 1;
+      ibyte += size;
+    }
+  }
+}
+//--------------------------------------------------------------------------------
+//
+void csSegyHdrProgram::decode( byte_t const* buffer, bool doSwapEndian, bool isAutoScaleHeaders, csFlexHeader* hdrValues ) const {
+  byte_t block[SIZE_TRCHDR];
+  byte_t const* hdr = buffer;
+  bool doSwap = doSwapEndian;
+  if( doSwapEndian && myIsBlockSwap[0] ) {
+    memcpy( block, buffer, SIZE_TRCHDR );
+    for( int irun = 0; irun < myNumSwapRuns[0][1]; irun++ ) {
+      swapWords4( &block[mySwapRuns[0][1][irun].byteLoc], mySwapRuns[0][1][irun].numWords );
+    }
+    for( int irun = 0; irun < myNumSwapRuns[0][0]; irun++ ) {
+      swapWords2( &block[mySwapRuns[0][0][irun].byteLoc], mySwapRuns[0][0][irun].numWords );
+    }
+    hdr = block;
+    doSwap = false;
+  }
+
+  for( int iop = myOpStart[OP_INT4]; iop < myOpStart[OP_INT4+1]; iop++ ) {
+    hdrValues[myDecodeOps[iop].hdrIndex].setIntValue( readInt( &hdr[myDecodeOps[iop].byteLoc], doSwap ) );
+  }
+  for( int iop = myOpStart[OP_INT2]; iop < myOpStart[OP_INT2+1]; iop++ ) {
+    hdrValues[myDecodeOps[iop].hdrIndex].setIntValue( readShort( &hdr[myDecodeOps[iop].byteLoc], doSwap ) );
+  }
+  for( int iop = myOpStart[OP_UINT2]; iop < myOpStart[OP_UINT2+1]; iop++ ) {
+    hdrValues[myDecodeOps[iop].hdrIndex].setIntValue( (int)(unsigned short)readShort( &hdr[myDecodeOps[iop].byteLoc], doSwap ) );
+  }
+  for( int iop = myOpStart[OP_FLOAT4]; iop < myOpStart[OP_FLOAT4+1]; iop++ ) {
+    hdrValues[myDecodeOps[iop].hdrIndex].setFloatValue( readFloat( &hdr[myDecodeOps[iop].byteLoc], doSwap ) );
+  }
+  for( int iop = myOpStart[OP_6BYTE]; iop < myOpStart[OP_6BYTE+1]; iop++ ) {
+    byte_t const* ptr = &hdr[myDecodeOps[iop].byteLoc];
+    int value       = readInt( ptr, doSwap );
+    int power_of_10 = readShort( ptr+4, doSwap );
+    hdrValues[myDecodeOps[iop].hdrIndex].setDoubleValue( (double)value * pow(10,power_of_10) );
+  }
+  for( int iop = myOpStart[OP_STRING]; iop < myOpStart[OP_STRING+1]; iop++ ) {
+    char const* ptr = reinterpret_cast<char const*>( &hdr[myDecodeOps[iop].byteLoc] );
+    int length = 0;
+    while( length < myDecodeOps[iop].byteSize && ptr[length] != '\0' ) {
+      length += 1;
+    }
+    std::string text( ptr, length );
+    hdrValues[myDecodeOps[iop].hdrIndex].setStringValue( text );
+  }
+
+  if( isAutoScaleHeaders ) {
+    applyScalars( hdrValues );
+  }
+}
+//--------------------------------------------------------------------------------
+//
+void csSegyHdrProgram::encode( csFlexHeader* hdrValues, bool doSwapEndian, bool isAutoScaleHeaders, byte_t* buffer ) const {
+  if( isAutoScaleHeaders ) {
+    applyScalarsWriting( hdrValues );
+  }
+  byte_t block[SIZE_TRCHDR];
+  byte_t* hdr = buffer;
+  bool doSwap = doSwapEndian;
+  if( doSwapEndian && myIsBlockSwap[1] ) {
+    memcpy( block, buffer, SIZE_TRCHDR );
+    hdr = block;
+    doSwap = false;
+  }
+  for( int iop = 0; iop < myNumEncodeOps; iop++ ) {
+    Op const& op = myEncodeOps[iop];
+    switch( op.type ) {
+    case OP_INT4:
+      writeInt( hdrValues[op.hdrIndex].intValue(), &hdr[op.byteLoc], doSwap );
+      break;
+    case OP_INT2:
+      writeShort( (short)hdrValues[op.hdrIndex].intValue(), &hdr[op.byteLoc], doSwap );
+      break;
+    case OP_UINT2:
+      writeShort( (short)(unsigned short)hdrValues[op.hdrIndex].intValue(), &hdr[op.byteLoc], doSwap );
+      break;
+    case OP_FLOAT4: {
+      float value = (float)hdrValues[op.hdrIndex].doubleValue();
+      int bits;
+      memcpy( &bits, &value, 4 );
+      writeInt( bits, &hdr[op.byteLoc], doSwap );
+      break;
+    }
+    }
+  }
+  if( hdr == block ) {
+    for( int irun = 0; irun < myNumSwapRuns[1][1]; irun++ ) {
+      swapWords4( &block[mySwapRuns[1][1][irun].byteLoc], mySwapRuns[1][1][irun].numWords );
+    }
+    for( int irun = 0; irun < myNumSwapRuns[1][0]; irun++ ) {
+      swapWords2( &block[mySwapRuns[1][0][irun].byteLoc], mySwapRuns[1][0][irun].numWords );
+    }
+    memcpy( buffer, block, SIZE_TRCHDR );
+  }
+
+  // Reverse polarity for output scalars, so that on input the data is inversely scaled
+  if( isAutoScaleHeaders ) {
+    if( myHdrIndexScalarCoord >= 0 ) {
+      writeShort( -hdrValues[myHdrIndexScalarCoord].intValue(), &buffer[csSegyHeader::BYTE_LOC_SCALAR_COORD], doSwapEndian );
+    }
+    if( myHdrIndexScalarElev >= 0 ) {
+      writeShort( -hdrValues[myHdrIndexScalarElev].intValue(), &buffer[csSegyHeader::BYTE_LOC_SCALAR_ELEV], doSwapEndian );
+    }
+    if( myHdrIndexScalarStat >= 0 ) {
+      writeShort( -hdrValues[myHdrIndexScalarStat].intValue(), &buffer[csSegyHeader::BYTE_LOC_SCALAR_STAT], doSwapEndian );
+    }
+  }
+}
+//--------------------------------------------------------------------------------
+// Same as csSegyHdrMap::applyCoordinateScalar(), with pre-resolved header indexes
+//
+void csSegyHdrProgram::applyScalars( csFlexHeader* hdrValues ) const {
+  if( myHdrIndexScalarElev < 0 || myHdrIndexScalarCoord < 0 ) {
+    throw( csException("csSegyHdrProgram::applyScalars: Coordinate or elevation scalar not defined in SEG-Y header map. Program bug.") );
+  }
+  double scalarElev  = (double)hdrValues[myHdrIndexScalarElev].intValue();
+  double scalarCoord = (double)hdrValues[myHdrIndexScalarCoord].intValue();
+  double scalarStat  = myHdrIndexScalarStat >= 0 ? (double)hdrValues[myHdrIndexScalarStat].intValue() : 0.0;
+  if( scalarElev  < 0 ) scalarElev  = -1/scalarElev;
+  if( scalarCoord < 0 ) scalarCoord = -1/scalarCoord;
+  if( scalarStat  < 0 ) scalarStat  = -1/scalarStat;
+
+  if( scalarElev != 0.0 ) {
+    for( int i = 0; i < myNumElevHeaders; i++ ) {
+      csFlexHeader& value = hdrValues[myHdrIndexElev[i]];
+      value.setFloatValue( (float)( (double)value.intValue() * scalarElev ) );
+    }
+  }
+  if( scalarCoord != 0.0 ) {
+    for( int i = 0; i < myNumCoordHeaders; i++ ) {
+      csFlexHeader& value = hdrValues[myHdrIndexCoord[i]];
+      value.setDoubleValue( (double)value.intValue() * scalarCoord );
+    }
+  }
+  if( scalarStat != 0.0 ) {
+    for( int i = 0; i < myNumStatHeaders; i++ ) {
+      csFlexHeader& value = hdrValues[myHdrIndexStat[i]];
+      value.setDoubleValue( (double)value.intValue() * scalarStat );
+    }
+  }
+}
+//--------------------------------------------------------------------------------
+// Same as csSegyHdrMap::applyCoordinateScalarWriting(), with pre-resolved header indexes
+//
+void csSegyHdrProgram::applyScalarsWriting( csFlexHeader* hdrValues ) const {
+  if( myHdrIndexScalarElev < 0 || myHdrIndexScalarCoord < 0 ) {
+    throw( csException("csSegyHdrProgram::applyScalarsWriting: Coordinate or elevation scalar not defined in SEG-Y header map. Program bug.") );
+  }
+  double scalarElev  = (double)hdrValues[myHdrIndexScalarElev].intValue();
+  double scalarCoord = (double)hdrValues[myHdrIndexScalarCoord].intValue();
+  double scalarStat  = myHdrIndexScalarStat >= 0 ? (double)hdrValues[myHdrIndexScalarStat].intValue() : 0.0;
+  if( scalarElev  < 0 ) scalarElev  = -1/scalarElev;
+  if( scalarCoord < 0 ) scalarCoord = -1/scalarCoord;
+  if( scalarStat  < 0 ) scalarStat  = -1/scalarStat;
+
+  if( scalarElev != 0.0 ) {
+    for( int i = 0; i < myNumElevHeaders; i++ ) {
+      csFlexHeader& value = hdrValues[myHdrIndexElev[i]];
+      value.setIntValue( (int)round( value.floatValue() * scalarElev ) );
+    }
+  }
+  if( scalarCoord != 0.0 ) {
+    for( int i = 0; i < myNumCoordHeaders; i++ ) {
+      csFlexHeader& value = hdrValues[myHdrIndexCoord[i]];
+      value.setIntValue( (int)round( value.doubleValue() * scalarCoord ) );
+    }
+  }
+  if( scalarStat != 0.0 ) {
+    for( int i = 0; i < myNumStatHeaders; i++ ) {
+      csFlexHeader& value = hdrValues[myHdrIndexStat[i]];
+      value.setIntValue( (int)round( value.doubleValue() * scalarStat ) );
+    }
+  }
+}
@@ -0,0 +1,98 @@
+/* Copyright (c) Colorado School of Mines, 2013.*/
+/* All rights reserved.                       */
+
+#ifndef CS_SEGY_HDR_PROGRAM_H
+#define CS_SEGY_HDR_PROGRAM_H
+
+#include "geolib_defines.h"
+
+namespace cseis_geolib {
+
+class csSegyHdrMap;
+class csFlexHeader;
+
+/**
+ * Compiled SEG-Y trace header map
+ *
+ * Translates a SEG-Y header map once into flat decode/encode instructions, so that reading and writing
+ * trace headers does not need to look up and interpret every header definition again for each trace:
+ *  - Header fields are grouped by SEG-Y type (4-byte int, 2-byte int, float...).
+ *  - Endian swapping is done for the whole header block at once, in runs of adjacent 2-byte and 4-byte words.
+ *    Runs are simple loops over consecutive words which the compiler can vectorise.
+ *  - Indexes of coordinate, elevation and statics headers, and their scalars, are resolved in advance.
+ * The header map must not be changed after the program has been compiled.
+ *
+ * @author Bjorn Olofsson
+ * @date 2013
+ */
+class csSegyHdrProgram {
+public:
+  csSegyHdrProgram( csSegyHdrMap const* hdrMap );
+  ~csSegyHdrProgram();
+  /**
+   * Decode trace header values from SEG-Y trace header block
+   * @param buffer       (i) 240 byte SEG-Y trace header block
+   * @param doSwapEndian (i) True if endian byte order needs to be swapped
+   * @param isAutoScaleHeaders (i) True if coordinate, elevation and statics scalars shall be applied
+   * @param hdrValues    (o) Header values, one for each header in header map
+   */
+  void decode( byte_t const* buffer, bool doSwapEndian, bool isAutoScaleHeaders, csFlexHeader* hdrValues ) const;
+  /**
+   * Encode trace header values into SEG-Y trace header block
+   * Bytes not covered by the header map are not modified.
+   * If isAutoScaleHeaders is set, scalars are applied to hdrValues before encoding.
+   */
+  void encode( csFlexHeader* hdrValues, bool doSwapEndian, bool isAutoScaleHeaders, byte_t* buffer ) const;
+  int numHeaders() const { return myNumHeaders; }
+
+private:
+  static int const OP_INT4   = 0;
+  static int const OP_INT2   = 1;
+  static int const OP_UINT2  = 2;
+  static int const OP_FLOAT4 = 3;
+  static int const OP_6BYTE  = 4;
+  static int const OP_STRING = 5;
+  static int const NUM_OP_TYPES = 6;
+
+  struct Op {
+    int type;
+    int byteLoc;
+    int byteSize;
+    int hdrIndex;
+  };
+  /// Run of adjacent words of same size that are byte swapped together
+  struct SwapRun {
+    int byteLoc;
+    int numWords;
+  };
+
+  void setSwapRuns( bool isEncode );
+  void applyScalars( csFlexHeader* hdrValues ) const;
+  void applyScalarsWriting( csFlexHeader* hdrValues ) const;
+
+  int myNumHeaders;
+  /// Decode instructions, grouped by type: Instructions of type T are myDecodeOps[myOpStart[T]...myOpStart[T+1]-1]
+  Op* myDecodeOps;
+  int myOpStart[NUM_OP_TYPES+1];
+  /// Encode instructions, in header map order
+  Op* myEncodeOps;
+  int myNumEncodeOps;
+
+  SwapRun* mySwapRuns[2][2];   // [decode/encode][2-byte/4-byte words]
+  int myNumSwapRuns[2][2];
+  /// False if fields overlap so that the header block cannot be swapped as a whole. Fields are then swapped one by one
+  bool myIsBlockSwap[2];
+
+  int myHdrIndexScalarCoord;
+  int myHdrIndexScalarElev;
+  int myHdrIndexScalarStat;
+  int* myHdrIndexCoord;
+  int* myHdrIndexElev;
+  int* myHdrIndexStat;
+  int myNumCoordHeaders;
+  int myNumElevHeaders;
+  int myNumStatHeaders;
+};
+
+} // end namespace
+#endif
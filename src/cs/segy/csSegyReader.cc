@@ -23,6 +23,64 @@
 #include "geolib_defines.h"
 #include "csSegyHdrMap.h"
 #include "csIOSelection.h"
+#include "csThreadPool.h"
+#include "geolib_platform_dependent.h"
+#include <cerrno>
+
+#ifndef PLATFORM_WINDOWS
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace cseis_geolib {
+/**
+ * Reads one block of traces in parallel read mode, through its own file handle
+ */
+class csSegyReadTask : public csRunnable {
+public:
+  csSegyReadTask( csSegyReader const* reader, char* buffer ) {
+    myReader     = reader;
+    myBuffer     = buffer;
+    myFileDesc   = -1;
+    myFirstTrace = 0;
+    myNumTraces  = 0;
+  }
+  ~csSegyReadTask() {
+#ifndef PLATFORM_WINDOWS
+    if( myFileDesc >= 0 ) close( myFileDesc );
+#endif
+    delete [] myBuffer;
+  }
+  void set( int firstTrace, int numTraces ) {
+    myFirstTrace = firstTrace;
+    myNumTraces  = numTraces;
+  }
+  virtual void run() {
+#ifndef PLATFORM_WINDOWS
+    if( myFileDesc < 0 ) {
+      myFileDesc = open( myReader->filename(), O_RDONLY );
+      if( myFileDesc < 0 ) {
+        throw( csException("Could not open SEGY file: %s", myReader->filename()) );
+      }
+    }
+#endif
+    myReader->readBlock( myFileDesc, myBuffer, myFirstTrace, myNumTraces );
+  }
+  int numTraces() const { return myNumTraces; }
+  /// Exchange trace buffer with given buffer of same size
+  char* swapBuffer( char* buffer ) {
+    char* bufferOut = myBuffer;
+    myBuffer = buffer;
+    return bufferOut;
+  }
+private:
+  csSegyReader const* myReader;
+  char* myBuffer;
+  int myFileDesc;
+  int myFirstTrace;
+  int myNumTraces;
+};
+}
 
 using namespace cseis_geolib;
 
@@ -58,6 +116,28 @@ csSegyReader::csSegyReader( std::string filename, SegyReaderConfig const& config
   myEnableRandomAccess      = config.enableRandomAccess;
   myIsSUFormat              = config.isSUFormat;
 
+  myFirstTraceIndex = 0;
+  myPartitionIndex  = config.partitionIndex;
+  myNumPartitions   = config.numPartitions;
+  if( myNumPartitions < 1 || myPartitionIndex < 0 || myPartitionIndex >= myNumPartitions ) {
+    throw csException( "Incorrect SEGY file partition: %d (number of partitions: %d)", myPartitionIndex, myNumPartitions );
+  }
+#ifdef PLATFORM_WINDOWS
+  myNumThreads = 1;
+#else
+  myNumThreads = config.numThreads > 0 ? config.numThreads : csThreadPool::numProcessors();
+#endif
+  myIsParallelRead = false;
+  myThreadPool     = NULL;
+  myNumSlots       = 0;
+  myReadTasks      = NULL;
+  myIsSlotPending  = NULL;
+  myCurrentSlot    = 0;
+  myNextBlockTrace = 0;
+  myIsPipelineRunning = false;
+  // File size is required to split file into partitions or trace blocks
+  if( myNumPartitions > 1 || myNumThreads > 1 ) myEnableRandomAccess = true;
+
   myHdrCheckByteOffset = 0;
   myHdrCheckInType       = cseis_geolib::TYPE_UNKNOWN;
   myHdrCheckOutType       = cseis_geolib::TYPE_UNKNOWN;
@@ -105,6 +185,19 @@ csSegyReader::csSegyReader( std::string filename, SegyReaderConfig const& config
 }
 //-----------------------------------------------------------------------------------------
 csSegyReader::~csSegyReader() {
+  if( myThreadPool != NULL ) {
+    myThreadPool->waitAll();
+    delete myThreadPool;
+    myThreadPool = NULL;
+  }
+  if( myReadTasks != NULL ) {
+    for( int islot = 0; islot < myNumSlots; islot++ ) {
+      delete myReadTasks[islot];
+    }
+    delete [] myReadTasks;
+    delete [] myIsSlotPending;
+    myReadTasks = NULL;
+  }
   if( myIOSelection != NULL ) {
     delete myIOSelection;
     myIOSelection = NULL;
@@ -178,6 +271,7 @@ void csSegyReader::initialize() {
   // First, read char & bin hdrs. This is necessary to set total trace size etc..
   readCharBinHdr();
 
+  bool isAutoBufferCapacity = ( myBufferCapacityNumTraces <= 0 );
   if( myBufferCapacityNumTraces <= 0 ) {  // Set number of buffered traces if it wasn't set explicitely before
     myBufferCapacityNumTraces = DEFAULT_BUFFERED_SAMPLES / myNumSamples;
     if( myBufferCapacityNumTraces <= 0 ) myBufferCapacityNumTraces = 1;
@@ -201,6 +295,37 @@ void csSegyReader::initialize() {
     }
   }
 
+  if( myNumPartitions > 1 ) {
+    if( myTrcHdrMap->mapID() == csSegyHdrMap::SEGY_PSEGY ) {
+      throw( csException("Reading partitions of P-SEGY files is not supported") );
+    }
+    // Restrict traces to partition, and move to first trace of partition
+    int traceIndexEnd = (int)( (csInt64_t)myNumTraces * (csInt64_t)(myPartitionIndex+1) / (csInt64_t)myNumPartitions );
+    myFirstTraceIndex = (int)( (csInt64_t)myNumTraces * (csInt64_t)myPartitionIndex / (csInt64_t)myNumPartitions );
+    myNumTraces       = traceIndexEnd;
+    myLastTraceIndex  = myNumTraces-1;
+    revertFromPeekPosition();
+    myFile->clear();
+    if( !csFileUtils::seekg_relative( (csInt64_t)myFirstTraceIndex * (csInt64_t)myTraceByteSize, myFile ) || myFile->fail() ) {
+      throw( csException("Could not move to first trace of partition #%d in SEGY file %s", myPartitionIndex, myFilename.c_str()) );
+    }
+    myCurrentTraceInFile = myFirstTraceIndex;
+    myResidualNumBytesAtEnd = 0;
+  }
+
+  myIsParallelRead = ( myNumThreads > 1 &&
+                       myFileSize != csFileUtils::FILESIZE_UNKNOWN &&
+                       myTrcHdrMap->mapID() != csSegyHdrMap::SEGY_PSEGY &&
+                       myDataSampleFormat != csSegyHeader::DATA_FORMAT_INT16 );
+  if( myIsParallelRead ) {
+    if( isAutoBufferCapacity ) {
+      myBufferCapacityNumTraces = DEFAULT_PARALLEL_BLOCK_SIZE / myTraceByteSize;
+      if( myBufferCapacityNumTraces <= 0 ) myBufferCapacityNumTraces = 1;
+    }
+    int numTracesRange = myNumTraces - myFirstTraceIndex;
+    if( numTracesRange < myBufferCapacityNumTraces ) myBufferCapacityNumTraces = std::max( numTracesRange, 1 );
+  }
+
   myBigBuffer = new char[ myBufferCapacityNumTraces * myTraceByteSize ];
   if( !myBigBuffer ) {
     throw( csException("csSegyReader::initialize(): Not enough memory...") );
@@ -431,6 +556,7 @@ bool csSegyReader::moveToTrace( int traceIndex, int numTracesToRead ) {
 //    throw( csException("csSegyReader::moveToTrace: Called method before initializing SEGY reader. This is a program bug in the calling method") );
   }
   if (myPeekIsInProgress ) revertFromPeekPosition();
+  if( myIsPipelineRunning ) stopPipeline();
 
   //  fprintf(stdout,"SEGY movetotrace: %d %d %d\n", myCurrentTraceInFile, myBufferNumTraces, traceIndex );
   //  fflush(stdout);
@@ -486,6 +612,10 @@ bool csSegyReader::getNextTrace( byte_t* sampleBufferOut, int nSamples ) {
   //  fprintf(stdout,"SEGY %d %d:  %d  %d\n", myBufferCurrentTrace, myCurrentTraceInFile, myBufferNumTraces, myResidualNumBytesAtEnd );
   //  fflush(stdout);
 
+  if( myBufferCurrentTrace == myBufferNumTraces && myIsParallelRead && myIOSelection == NULL ) {
+    // Parallel read mode: Next block has already been read in and converted by worker thread
+    if( !fetchNextBlock() ) return false;
+  }
   if( myBufferCurrentTrace == myBufferNumTraces ) {
     if( myFile->eof() ) {
       return false;
@@ -598,6 +728,101 @@ bool csSegyReader::getNextTrace( byte_t* sampleBufferOut, int nSamples ) {
   myBufferCurrentTrace += 1;
   return true;
 }
+//--------------------------------------------------------------------------------
+// Parallel read mode
+//
+bool csSegyReader::fetchNextBlock() {
+  if( myCurrentTraceInFile >= myNumTraces ) return false;
+  if( myThreadPool == NULL ) {
+    myThreadPool = new csThreadPool( myNumThreads );
+    myNumSlots   = myThreadPool->numThreads() + 1;
+    myReadTasks     = new csSegyReadTask*[myNumSlots];
+    myIsSlotPending = new bool[myNumSlots];
+    for( int islot = 0; islot < myNumSlots; islot++ ) {
+      myReadTasks[islot] = new csSegyReadTask( this, new char[ myBufferCapacityNumTraces * myTraceByteSize ] );
+      myIsSlotPending[islot] = false;
+    }
+    myCurrentSlot = 0;
+  }
+  if( !myIsPipelineRunning ) {
+    myIsPipelineRunning = true;
+    myNextBlockTrace    = myCurrentTraceInFile;
+    for( int i = 0; i < myNumSlots; i++ ) {
+      submitReadTask( (myCurrentSlot + i) % myNumSlots );
+    }
+  }
+  int slot = myCurrentSlot;
+  if( !myIsSlotPending[slot] ) return false;
+  myThreadPool->wait( myReadTasks[slot] );
+  myIsSlotPending[slot] = false;
+  if( myReadTasks[slot]->hasError() ) {
+    stopPipeline();
+    throw( csException("csSegyReader::getNextTrace: Unexpected error occurred when reading in data from input file '%s': %s",
+                       myFilename.c_str(), myReadTasks[slot]->errorMessage()) );
+  }
+  myBigBuffer = myReadTasks[slot]->swapBuffer( myBigBuffer );
+  myBufferNumTraces    = myReadTasks[slot]->numTraces();
+  myBufferCurrentTrace = 0;
+  myCurrentTraceInFile += myBufferNumTraces;
+  // Keep file pointer at current trace position, for peek and moveToTrace
+  myFile->clear();
+  csFileUtils::seekg_relative( (csInt64_t)myBufferNumTraces * (csInt64_t)myTraceByteSize, myFile );
+
+  submitReadTask( slot );
+  myCurrentSlot = (slot + 1) % myNumSlots;
+  return true;
+}
+//--------------------------------------------------------------------------------
+void csSegyReader::submitReadTask( int slot ) {
+  if( myNextBlockTrace >= myNumTraces ) return;
+  int numTraces = std::min( myBufferCapacityNumTraces, myNumTraces - myNextBlockTrace );
+  myReadTasks[slot]->set( myNextBlockTrace, numTraces );
+  myIsSlotPending[slot] = true;
+  myThreadPool->submit( myReadTasks[slot] );
+  myNextBlockTrace += numTraces;
+}
+//--------------------------------------------------------------------------------
+void csSegyReader::stopPipeline() {
+  myThreadPool->waitAll();
+  for( int islot = 0; islot < myNumSlots; islot++ ) {
+    myIsSlotPending[islot] = false;
+  }
+  myIsPipelineRunning = false;
+}
+//--------------------------------------------------------------------------------
+void csSegyReader::readBlock( int fileDesc, char* buffer, int firstTrace, int numTraces ) const {
+#ifndef PLATFORM_WINDOWS
+  csInt64_t offset = (csInt64_t)firstTrace * (csInt64_t)myTraceByteSize;
+  if( !myIsSUFormat ) offset += (csInt64_t)( csSegyHeader::SIZE_CHARHDR + csSegyHeader::SIZE_BINHDR );
+  size_t sizeRemain = (size_t)numTraces * (size_t)myTraceByteSize;
+  char* bufferPtr = buffer;
+  while( sizeRemain > 0 ) {
+    ssize_t sizeRead = pread( fileDesc, bufferPtr, sizeRemain, (off_t)offset );
+    if( sizeRead < 0 ) {
+      if( errno == EINTR ) continue;
+      throw( csException("%s", strerror(errno)) );
+    }
+    else if( sizeRead == 0 ) {
+      throw( csException("Unexpected end of file at trace #%d", firstTrace + (int)((bufferPtr-buffer)/myTraceByteSize)) );
+    }
+    bufferPtr  += sizeRead;
+    offset     += sizeRead;
+    sizeRemain -= sizeRead;
+  }
+  for( int itrc = 0; itrc < numTraces; itrc++ ) {
+    char* samplePtr = buffer + myTraceByteSize*itrc + csSegyHeader::SIZE_TRCHDR;
+    if( myDoSwapEndianData ) {
+      swapEndian4( samplePtr, myNumSamples*mySampleByteSize );
+    }
+    if( myDataSampleFormat == csSegyHeader::DATA_FORMAT_IBM ) {
+      ibm2ieee( (unsigned char*)samplePtr, myNumSamples );
+    }
+    else if( myDataSampleFormat == csSegyHeader::DATA_FORMAT_INT32 ) {
+      convertInt2Float( (int*)samplePtr, myNumSamples );
+    }
+  }
+#endif
+}
 // This method returns a constant pointer to the trace buffer
 //
 float const* csSegyReader::getNextTracePointer() {
@@ -22,6 +22,8 @@ namespace cseis_geolib {
   class csFlexHeader;
   class csSegyTraceHeader;
   class csIOSelection;
+  class csThreadPool;
+  class csSegyReadTask;
 
 /**
  * SEGY reader
@@ -30,6 +32,16 @@ namespace cseis_geolib {
  * a) Determine platform.
  * b) If Little Endian, swap endian format on input.
  *
+ * Parallel read mode (numThreads > 1):
+ * The file is read in blocks of consecutive traces. Blocks are read ahead by worker threads, each through its own file handle,
+ * and sample values are converted (byte swapping, IBM->IEEE...) in the worker thread. Blocks are handed over in file order.
+ * Trace headers are decoded by the calling thread. Parallel read mode is not used for trace selections, P-SEGY and 16bit
+ * integer data, and is not available on Windows.
+ *
+ * Partitions (numPartitions > 1):
+ * The traces of the file are split into numPartitions ranges of (nearly) equal size. Only the traces of the given partition
+ * are read in. This allows several independent flows to read the same file, each one processing a different partition.
+ *
  * @author Bjorn Olofsson
  * @date 2006
  */
@@ -38,6 +50,8 @@ namespace cseis_geolib {
 class csSegyReader : public cseis_geolib::csIReader {
 public:
   static int const DEFAULT_BUFFERED_SAMPLES = 250000;
+  /// Default size of trace blocks read in parallel read mode [bytes]
+  static int const DEFAULT_PARALLEL_BLOCK_SIZE = 8*1024*1024;
   struct SegyReaderConfig {
     SegyReaderConfig() {
       numTracesBuffer   = 20;
@@ -48,6 +62,9 @@ public:
       overrideSampleFormat = csSegyHeader::AUTO;
       enableRandomAccess = false;
       isSUFormat = false;
+      numThreads = 1;
+      partitionIndex = 0;
+      numPartitions  = 1;
     }
     int  numTracesBuffer;
     int  segyHeaderMapping;
@@ -57,6 +74,11 @@ public:
     int  overrideSampleFormat;
     bool enableRandomAccess;
     bool isSUFormat;
+    /// Number of threads reading trace blocks. 1: Read sequentially, 0: Use number of processors
+    int  numThreads;
+    /// Index of partition to read (starting at 0), and number of partitions that the file is split into
+    int  partitionIndex;
+    int  numPartitions;
   };
 
 //---------------------------------------------------------------------------------------
@@ -164,8 +186,11 @@ public:
 
   int numTracesCapacity() { return myBufferCapacityNumTraces; }
   int getCurrentTraceIndex() const { return myCurrentTraceInFile; }
+  /// @return Index of first trace in partition that is read in (0 if file is not partitioned)
+  int firstTraceIndex() const { return myFirstTraceIndex; }
 
 private:
+  friend class csSegyReadTask;
   csSegyHdrMap*      myTrcHdrMap;
   csSegyTraceHeader* myTrcHdr;
   
@@ -248,6 +273,26 @@ private:
   bool myIsSUFormat;
   cseis_geolib::csIOSelection* myIOSelection;
 
+  /// Index of first trace in partition
+  int myFirstTraceIndex;
+  int myPartitionIndex;
+  int myNumPartitions;
+
+  // Parallel read mode
+  int myNumThreads;
+  /// true if file is eligible for parallel reading
+  bool myIsParallelRead;
+  csThreadPool* myThreadPool;
+  /// Ring of read tasks, each with its own trace block buffer. Blocks are consumed in ring order
+  int myNumSlots;
+  csSegyReadTask** myReadTasks;
+  bool* myIsSlotPending;
+  int myCurrentSlot;
+  /// Index of first trace of next block to submit
+  int myNextBlockTrace;
+  /// true if read tasks have been submitted starting from the current trace position
+  bool myIsPipelineRunning;
+
 public:
   void resetTrcHdrMap( csSegyHdrMap* map );
   csSegyHdrMap const* getTrcHdrMap() const { return myTrcHdrMap; }
@@ -257,6 +302,12 @@ public:
 private:
   void readCharBinHdr();
   void openFile();
+  /// Retrieve next block of traces from read tasks, into big buffer
+  bool fetchNextBlock();
+  void submitReadTask( int slot );
+  void stopPipeline();
+  /// Read block of traces from file and convert samples. Called by worker threads
+  void readBlock( int fileDesc, char* buffer, int firstTrace, int numTraces ) const;
 
   csSegyReader();
   csSegyReader( csSegyReader const& obj );
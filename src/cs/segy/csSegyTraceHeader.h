@@ -12,6 +12,7 @@ namespace cseis_geolib {
 template<typename T> class csVector;
 class csFlexHeader;
 class csSegyHdrMap;
+class csSegyHdrProgram;
 
 /**
  * Segy trace header
@@ -72,6 +73,8 @@ private:
   csSegyTraceHeader();
   cseis_geolib::csFlexHeader* myHdrValues;
   csSegyHdrMap const* myHdrMapPtr;
+  /// Header map compiled into decode/encode instructions
+  csSegyHdrProgram* myProgram;
 };
 
 } // end namespace
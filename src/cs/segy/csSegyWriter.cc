@@ -17,14 +17,51 @@
 #include "geolib_math.h"
 #include "methods_number_conversions.h"
 #include "csFileUtils.h"
+#include "csThreadPool.h"
+#include "geolib_platform_dependent.h"
 #include <string>
 #include <cstring>
+#include <cerrno>
+
+#ifndef PLATFORM_WINDOWS
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+namespace cseis_geolib {
+/**
+ * Converts and writes one buffer of traces in parallel write mode
+ */
+class csSegyWriterTask : public csRunnable {
+public:
+  csSegyWriterTask( csSegyWriter const* writer, char* buffer ) {
+    myWriter     = writer;
+    myBuffer     = buffer;
+    myFirstTrace = 0;
+    myNumTraces  = 0;
+  }
+  void set( csInt64_t firstTrace, int numTraces ) {
+    myFirstTrace = firstTrace;
+    myNumTraces  = numTraces;
+  }
+  virtual void run() {
+    myWriter->writeSlot( myBuffer, myFirstTrace, myNumTraces );
+  }
+private:
+  csSegyWriter const* myWriter;
+  char* myBuffer;
+  csInt64_t myFirstTrace;
+  int myNumTraces;
+};
+}
 
 using namespace cseis_geolib;
 
-csSegyWriter::csSegyWriter( std::string filename, int nTracesBuffer, bool reverseByteOrder, bool doAutoScaleHdrs, bool isSUFormat ) :
+csSegyWriter::csSegyWriter( std::string filename, int nTracesBuffer, bool reverseByteOrder, bool doAutoScaleHdrs, bool isSUFormat, int numThreads ) :
     NTRACES_BUFFER(nTracesBuffer)
 {
+  myFile         = NULL;
   myHdrValues    = NULL;
   myCharHdrBlock = NULL;
   myBinHdrBlock  = NULL;
@@ -40,6 +77,21 @@ csSegyWriter::csSegyWriter( std::string filename, int nTracesBuffer, bool revers
   myTrcHdr            = NULL;
   myTrcHdrMap         = NULL;//new csSegyHdrMap(csSegyHdrMap::NONE);
 
+#ifdef PLATFORM_WINDOWS
+  myNumThreads = 1;
+#else
+  myNumThreads = numThreads > 0 ? numThreads : csThreadPool::numProcessors();
+#endif
+  myThreadPool    = NULL;
+  myNumSlots      = 0;
+  mySlotBuffers   = NULL;
+  myTasks         = NULL;
+  myIsSlotPending = NULL;
+  myCurrentSlot   = 0;
+  myFileDesc      = -1;
+  myDataOffset    = isSUFormat ? 0 : (csInt64_t)(csSegyHeader::SIZE_CHARHDR + csSegyHeader::SIZE_BINHDR);
+  myPreallocSize  = 0;
+
   myFilename     = filename;
   myIsAtEOF      = false;
   myDoSwapEndian = isPlatformLittleEndian();
@@ -58,7 +110,26 @@ csSegyWriter::csSegyWriter( std::string filename, int nTracesBuffer, bool revers
 //-----------------------------------------------------------------------------------------
 csSegyWriter::~csSegyWriter() {
   freeCharBinHdr();
-  closeFile();
+  try {
+    closeFile();
+  }
+  catch( ... ) {
+    // Nothing to be done
+  }
+  if( myThreadPool != NULL ) {
+    delete myThreadPool;
+    myThreadPool = NULL;
+  }
+  if( mySlotBuffers != NULL ) {
+    for( int islot = 0; islot < myNumSlots; islot++ ) {
+      delete myTasks[islot];
+      delete [] mySlotBuffers[islot];
+    }
+    delete [] myTasks;
+    delete [] mySlotBuffers;
+    delete [] myIsSlotPending;
+    mySlotBuffers = NULL;
+  }
   if( myBigBuffer ) {
     delete [] myBigBuffer;
     myBigBuffer = NULL;
@@ -95,11 +166,28 @@ void csSegyWriter::initialize( csSegyHdrMap const* hdrMap, char const* newCharHd
   mySampleByteSize = 4;   // assume 4 byte floating point
   myTotalTraceSize = myNumSamples*mySampleByteSize+csSegyHeader::SIZE_TRCHDR;
 
-  myBigBuffer = new char[ NTRACES_BUFFER * myTotalTraceSize ];
-  memset( myBigBuffer, 0, NTRACES_BUFFER * myTotalTraceSize );
+  if( myNumThreads > 1 ) {
+    myThreadPool = new csThreadPool( myNumThreads );
+    myNumSlots = myThreadPool->numThreads() + 1;
+    mySlotBuffers   = new char*[myNumSlots];
+    myTasks         = new csSegyWriterTask*[myNumSlots];
+    myIsSlotPending = new bool[myNumSlots];
+    for( int islot = 0; islot < myNumSlots; islot++ ) {
+      mySlotBuffers[islot] = new char[ NTRACES_BUFFER * myTotalTraceSize ];
+      memset( mySlotBuffers[islot], 0, NTRACES_BUFFER * myTotalTraceSize );
+      myTasks[islot] = new csSegyWriterTask( this, mySlotBuffers[islot] );
+      myIsSlotPending[islot] = false;
+    }
+    myCurrentSlot = 0;
+    myBigBuffer   = NULL;
+  }
+  else {
+    myBigBuffer = new char[ NTRACES_BUFFER * myTotalTraceSize ];
+    memset( myBigBuffer, 0, NTRACES_BUFFER * myTotalTraceSize );
 
-  if( !myBigBuffer ) {
-    throw( csException("Not enough memory...") );
+    if( !myBigBuffer ) {
+      throw( csException("Not enough memory...") );
+    }
   }
 
   myTraceCounter   = 0;
@@ -121,6 +209,10 @@ int csSegyWriter::numTraceHeaders() const {
 
 //-----------------------------------------------------------------------------------------
 void csSegyWriter::openFile() {
+  if( isParallel() ) {
+    openFileParallel();
+    return;
+  }
   myFile = fopen( myFilename.c_str(), "wb" );
   if( myFile == NULL ) {
     throw csException("Could not open SEGY file %s", myFilename.c_str());
@@ -128,6 +220,10 @@ void csSegyWriter::openFile() {
   writeCharBinHdr();
 }
 void csSegyWriter::closeFile() {
+  if( isParallel() ) {
+    closeFileParallel();
+    return;
+  }
   if( myFile != NULL ) {
     myForceToWrite = true;
     writeNextTrace( NULL, NULL, 0 );
@@ -136,6 +232,140 @@ void csSegyWriter::closeFile() {
   }
 }
 
+//-----------------------------------------------------------------------------------------
+// Parallel write mode
+//
+void csSegyWriter::openFileParallel() {
+#ifndef PLATFORM_WINDOWS
+  myFileDesc = open( myFilename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666 );
+  if( myFileDesc < 0 ) {
+    throw csException("Could not open SEGY file %s", myFilename.c_str());
+  }
+  myPreallocSize = 0;
+  if( !myIsSUFormat ) {
+    char* hdrBuffer = new char[myDataOffset];
+    memcpy( hdrBuffer, myCharHdrBlock, csSegyHeader::SIZE_CHARHDR );
+    memcpy( &hdrBuffer[csSegyHeader::SIZE_CHARHDR], myBinHdrBlock, csSegyHeader::SIZE_BINHDR );
+    ssize_t sizeWrite = pwrite( myFileDesc, hdrBuffer, (size_t)myDataOffset, 0 );
+    delete [] hdrBuffer;
+    if( sizeWrite != (ssize_t)myDataOffset ) {
+      throw csException("Unexpected error encountered while writing SEGY char & binary headers: %s", strerror(errno));
+    }
+  }
+#endif
+}
+//-----------------------------------------------------------------------------------------
+void csSegyWriter::closeFileParallel() {
+#ifndef PLATFORM_WINDOWS
+  if( myFileDesc < 0 ) return;
+  int fd = myFileDesc;
+  try {
+    if( myNumSavedTraces > 0 ) {
+      submitCurrentSlot();
+    }
+    for( int islot = 0; islot < myNumSlots; islot++ ) {
+      if( myIsSlotPending[islot] ) waitSlot( islot );
+    }
+  }
+  catch( ... ) {
+    myThreadPool->waitAll();
+    myFileDesc = -1;
+    close( fd );
+    throw;
+  }
+  myFileDesc = -1;
+  // Remove preallocated space beyond last trace, and make sure all data has reached the disk
+  csInt64_t fileSize = myDataOffset + (csInt64_t)myTraceCounter * (csInt64_t)myTotalTraceSize;
+  if( ftruncate( fd, (off_t)fileSize ) != 0 ) {
+    close( fd );
+    throw csException("Error occurred when truncating SEGY file %s: %s", myFilename.c_str(), strerror(errno));
+  }
+  if( fsync( fd ) != 0 ) {
+    close( fd );
+    throw csException("Error occurred when flushing SEGY file %s to disk: %s", myFilename.c_str(), strerror(errno));
+  }
+  struct stat fileStat;
+  if( fstat( fd, &fileStat ) != 0 || (csInt64_t)fileStat.st_size != fileSize ) {
+    close( fd );
+    throw csException("Inconsistent size of SEGY file %s. Expected %lld bytes (%d traces)", myFilename.c_str(), fileSize, myTraceCounter);
+  }
+  if( close( fd ) != 0 ) {
+    throw csException("Error occurred when closing SEGY file %s: %s", myFilename.c_str(), strerror(errno));
+  }
+#endif
+}
+//-----------------------------------------------------------------------------------------
+void csSegyWriter::submitCurrentSlot() {
+  int slot = myCurrentSlot;
+  csInt64_t firstTrace = (csInt64_t)(myTraceCounter - myNumSavedTraces);
+#ifdef PLATFORM_LINUX
+  // Preallocate file ahead of write position. Failure is only fatal if disk is full
+  csInt64_t endOffset = myDataOffset + (firstTrace + myNumSavedTraces) * (csInt64_t)myTotalTraceSize;
+  if( myPreallocSize >= 0 && endOffset > myPreallocSize ) {
+    csInt64_t startOffset = myPreallocSize > myDataOffset ? myPreallocSize : myDataOffset;
+    csInt64_t allocSize   = endOffset - startOffset + PREALLOC_BYTE_SIZE;
+    int err = posix_fallocate( myFileDesc, (off_t)startOffset, (off_t)allocSize );
+    if( err == 0 ) {
+      myPreallocSize = startOffset + allocSize;
+    }
+    else if( err == ENOSPC ) {
+      throw csException("Not enough disk space to write SEGY file %s", myFilename.c_str());
+    }
+    else {
+      myPreallocSize = -1;  // Preallocation not supported by file system
+    }
+  }
+#endif
+  myTasks[slot]->set( firstTrace, myNumSavedTraces );
+  myIsSlotPending[slot] = true;
+  myThreadPool->submit( myTasks[slot] );
+
+  myCurrentSlot    = (slot + 1) % myNumSlots;
+  myNumSavedTraces = 0;
+  myCurrentTrace   = 0;
+  // Next buffer to fill is oldest buffer in ring: Wait until it has been written out
+  if( myIsSlotPending[myCurrentSlot] ) {
+    waitSlot( myCurrentSlot );
+  }
+}
+//-----------------------------------------------------------------------------------------
+void csSegyWriter::waitSlot( int slot ) {
+  myThreadPool->wait( myTasks[slot] );
+  myIsSlotPending[slot] = false;
+  if( myTasks[slot]->hasError() ) {
+    throw( csException("Error occurred when writing to SEGY file: %s", myTasks[slot]->errorMessage()) );
+  }
+}
+//-----------------------------------------------------------------------------------------
+void csSegyWriter::writeSlot( char* buffer, csInt64_t firstTrace, int numTraces ) const {
+#ifndef PLATFORM_WINDOWS
+  if( myFileDesc < 0 ) {
+    throw( csException("SEGY file %s has not been opened for writing", myFilename.c_str()) );
+  }
+  for( int itrc = 0; itrc < numTraces; itrc++ ) {
+    char* samplePtr = buffer + myTotalTraceSize*itrc + csSegyHeader::SIZE_TRCHDR;
+    if( myDataSampleFormat == csSegyHeader::DATA_FORMAT_IBM ) {
+      ieee2ibm( (unsigned char*)samplePtr, myNumSamples );
+    }
+    if( myDoSwapEndian ) {
+      swapEndian4( samplePtr, myNumSamples*mySampleByteSize );
+    }
+  }
+  csInt64_t offset  = myDataOffset + firstTrace * (csInt64_t)myTotalTraceSize;
+  size_t sizeRemain = (size_t)numTraces * (size_t)myTotalTraceSize;
+  while( sizeRemain > 0 ) {
+    ssize_t sizeWrite = pwrite( myFileDesc, buffer, sizeRemain, (off_t)offset );
+    if( sizeWrite < 0 ) {
+      if( errno == EINTR ) continue;
+      throw( csException("Unexpected error occurred when writing to SEGY file: %s", strerror(errno)) );
+    }
+    buffer     += sizeWrite;
+    offset     += sizeWrite;
+    sizeRemain -= sizeWrite;
+  }
+#endif
+}
+
 //*******************************************************************
 //
 // Char & bin headers
@@ -204,6 +434,22 @@ void csSegyWriter::writeNextTrace( byte_t const* theBuffer, csSegyTraceHeader co
 //  fprintf(stdout,"Has been initialized? %d %d %d %d\n", myHasBeenInitialized, myTotalTraceSize, myCurrentTrace, myNumSavedTraces );
   if( nSamples == 0 || nSamples > myNumSamples ) nSamples = myNumSamples;
 
+  if( isParallel() ) {
+    // Remaining traces are written out in closeFile()
+    if( theBuffer == NULL ) return;
+    int indexCurrentTrace = myCurrentTrace*myTotalTraceSize;
+    char* slotBuffer = mySlotBuffers[myCurrentSlot];
+    memcpy( &slotBuffer[indexCurrentTrace+csSegyHeader::SIZE_TRCHDR], theBuffer, nSamples*mySampleByteSize );
+    trcHdr->writeHeaderValues( reinterpret_cast<byte_t*>( &slotBuffer[indexCurrentTrace] ), myDoSwapEndian, myIsAutoScaleHeaders );
+    myTraceCounter++;
+    myCurrentTrace++;
+    myNumSavedTraces++;
+    if( myNumSavedTraces == NTRACES_BUFFER ) {
+      submitCurrentSlot();
+    }
+    return;
+  }
+
   if( myCurrentTrace == NTRACES_BUFFER || myForceToWrite ) {
     if( myDataSampleFormat == csSegyHeader::DATA_FORMAT_IBM ) {
       for( int itrc = 0; itrc < myNumSavedTraces; itrc++ ) {
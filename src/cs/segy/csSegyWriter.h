@@ -17,6 +17,8 @@ namespace cseis_geolib {
   class csFlexNumber;
   class csSegyHeader;
   class csSegyHdrMap;
+  class csThreadPool;
+  class csSegyWriterTask;
 
 /**
  * SEGY Writer
@@ -24,6 +26,13 @@ namespace cseis_geolib {
  * Segy files are stored in Big Endian format, independent of which platform they were created on.
  * --> Determine platform. If Little Endian, swap endian format on output.
  *
+ * Parallel write mode (numThreads != 1):
+ * Since all SEGY traces have the same size, the file offset of each trace is known in advance. Traces are collected in a ring
+ * of trace buffers. Full buffers are handed to worker threads which convert the samples (IBM conversion, byte swapping) and
+ * write them directly to their position in the file. Trace headers are encoded by the calling thread.
+ * The file is preallocated ahead of the write position, and truncated, synced and verified when the file is closed.
+ * Parallel write mode is not available on Windows, where traces are always written sequentially.
+ *
  * @author Bjorn Olofsson
  * @date 2006
  */
@@ -31,7 +40,10 @@ namespace cseis_geolib {
 class csSegyWriter {
 //---------------------------------------------------------------------------------------
 public:
-  csSegyWriter( std::string filename, int nTracesBuffer,  bool reverseByteOrder, bool autoscale_hdrs, bool isSUFormat );
+  /**
+   * @param numThreads  Number of threads used to convert and write trace buffers. 1: Write sequentially, 0: Use number of processors
+   */
+  csSegyWriter( std::string filename, int nTracesBuffer,  bool reverseByteOrder, bool autoscale_hdrs, bool isSUFormat, int numThreads = 1 );
   ~csSegyWriter();
   /// Initialize
   void initialize( csSegyHdrMap const* hdrMap, char const* newCharHdr );
@@ -66,6 +78,10 @@ public:
   csSegyTraceHeader* getTraceHeader() const { return myTrcHdr; }
 
 private:
+  friend class csSegyWriterTask;
+  /// Number of bytes by which output file is preallocated ahead of the write position (parallel write mode)
+  static csInt64_t const PREALLOC_BYTE_SIZE = 256LL*1024LL*1024LL;
+
   /// Actual SEGY header map, after user has added all relevant headers to be written to output file
   csSegyHdrMap* myTrcHdrMap;
   cseis_geolib::csFlexNumber* myHdrValues;
@@ -102,12 +118,35 @@ private:
   int myDataSampleFormat;
   int const NTRACES_BUFFER;
 
+  // Parallel write mode
+  int myNumThreads;
+  csThreadPool* myThreadPool;
+  /// Ring of trace buffers, and tasks converting and writing them out
+  int myNumSlots;
+  char** mySlotBuffers;
+  csSegyWriterTask** myTasks;
+  bool* myIsSlotPending;
+  int myCurrentSlot;
+  /// File descriptor of output file
+  int myFileDesc;
+  /// File offset of first trace (=size of char & bin headers)
+  csInt64_t myDataOffset;
+  /// Number of bytes preallocated in output file
+  csInt64_t myPreallocSize;
+
 //-----------------------------------------------------------------------------------------
 // Private access methods
 //
 private:
   void setCharHdr( char const* newCharHdr );
   void writeCharBinHdr();
+  bool isParallel() const { return myThreadPool != NULL; }
+  void openFileParallel();
+  void closeFileParallel();
+  void submitCurrentSlot();
+  void waitSlot( int slot );
+  /// Convert samples of given trace buffer and write buffer to file. Called by worker threads
+  void writeSlot( char* buffer, csInt64_t firstTrace, int numTraces ) const;
 
   csSegyWriter();
   csSegyWriter( csSegyWriter const& obj );
@@ -0,0 +1,155 @@
+/* Copyright (c) Colorado School of Mines, 2013.*/
+/* All rights reserved.                       */
+
+#include "csSUStencilEngine.h"
+#include "csException.h"
+#include <cstdlib>
+#include <cstring>
+
+using namespace cseis_su;
+
+namespace {
+  /// Row alignment of grids, in number of floats (64 bytes)
+  int const GRID_ALIGN_FLOATS = 16;
+  /// Number of tiles per thread when tile size is chosen automatically
+  int const NUM_TILES_PER_THREAD = 4;
+}
+
+csSUStencilEngine::csSUStencilEngine( int numThreads, int numRowsTile ) {
+  myNumThreads      = numThreads > 1 ? numThreads : 1;
+  myNumRowsTileUser = numRowsTile > 0 ? numRowsTile : 0;
+  myThreads = NULL;
+  myNumThreadsStarted = 0;
+
+  myFunc = NULL;
+  myData = NULL;
+  myLastRow      = -1;
+  myNumRowsTile  = 1;
+  myNextRow      = 0;
+  myNumTiles     = 0;
+  myNumTilesDone = 0;
+  myRunCounter   = 0;
+  myTerminate    = false;
+
+  pthread_mutex_init( &myMutex, NULL );
+  pthread_cond_init( &myCondStart, NULL );
+  pthread_cond_init( &myCondDone, NULL );
+
+  // Calling thread is the first member of the team
+  if( myNumThreads > 1 ) {
+    myThreads = new pthread_t[myNumThreads-1];
+    for( int ithread = 0; ithread < myNumThreads-1; ithread++ ) {
+      if( pthread_create( &myThreads[ithread], NULL, csSUStencilEngine::startThread, this ) != 0 ) break;
+      myNumThreadsStarted += 1;
+    }
+    myNumThreads = myNumThreadsStarted + 1;
+  }
+}
+csSUStencilEngine::~csSUStencilEngine() {
+  pthread_mutex_lock( &myMutex );
+  myTerminate = true;
+  pthread_cond_broadcast( &myCondStart );
+  pthread_mutex_unlock( &myMutex );
+  for( int ithread = 0; ithread < myNumThreadsStarted; ithread++ ) {
+    pthread_join( myThreads[ithread], NULL );
+  }
+  if( myThreads != NULL ) {
+    delete [] myThreads;
+    myThreads = NULL;
+  }
+  pthread_cond_destroy( &myCondDone );
+  pthread_cond_destroy( &myCondStart );
+  pthread_mutex_destroy( &myMutex );
+}
+//--------------------------------------------------------------------
+void csSUStencilEngine::run( KernelFunc func, void* data, int firstRow, int lastRow ) {
+  if( lastRow < firstRow ) return;
+  if( myNumThreads == 1 ) {
+    func( firstRow, lastRow, data );
+    return;
+  }
+  int numRows = lastRow - firstRow + 1;
+  int numRowsTile = myNumRowsTileUser;
+  if( numRowsTile == 0 ) {
+    int numTilesAuto = NUM_TILES_PER_THREAD * myNumThreads;
+    numRowsTile = ( numRows + numTilesAuto - 1 ) / numTilesAuto;
+  }
+  pthread_mutex_lock( &myMutex );
+  myFunc = func;
+  myData = data;
+  myLastRow      = lastRow;
+  myNumRowsTile  = numRowsTile;
+  myNextRow      = firstRow;
+  myNumTiles     = ( numRows + numRowsTile - 1 ) / numRowsTile;
+  myNumTilesDone = 0;
+  myRunCounter  += 1;
+  pthread_cond_broadcast( &myCondStart );
+  pthread_mutex_unlock( &myMutex );
+
+  processTiles();
+
+  pthread_mutex_lock( &myMutex );
+  while( myNumTilesDone < myNumTiles ) {
+    pthread_cond_wait( &myCondDone, &myMutex );
+  }
+  pthread_mutex_unlock( &myMutex );
+}
+//--------------------------------------------------------------------
+void csSUStencilEngine::processTiles() {
+  pthread_mutex_lock( &myMutex );
+  while( myNextRow <= myLastRow ) {
+    int firstRow = myNextRow;
+    int lastRow  = firstRow + myNumRowsTile - 1;
+    if( lastRow > myLastRow ) lastRow = myLastRow;
+    myNextRow = lastRow + 1;
+    KernelFunc func = myFunc;
+    void* data = myData;
+    pthread_mutex_unlock( &myMutex );
+
+    func( firstRow, lastRow, data );
+
+    pthread_mutex_lock( &myMutex );
+    myNumTilesDone += 1;
+    if( myNumTilesDone == myNumTiles ) pthread_cond_broadcast( &myCondDone );
+  }
+  pthread_mutex_unlock( &myMutex );
+}
+//--------------------------------------------------------------------
+void* csSUStencilEngine::startThread( void* engine ) {
+  csSUStencilEngine* obj = reinterpret_cast<csSUStencilEngine*>( engine );
+  int runCounter = 0;
+  pthread_mutex_lock( &obj->myMutex );
+  while( true ) {
+    while( !obj->myTerminate && obj->myRunCounter == runCounter ) {
+      pthread_cond_wait( &obj->myCondStart, &obj->myMutex );
+    }
+    if( obj->myTerminate ) break;
+    runCounter = obj->myRunCounter;
+    pthread_mutex_unlock( &obj->myMutex );
+    obj->processTiles();
+    pthread_mutex_lock( &obj->myMutex );
+  }
+  pthread_mutex_unlock( &obj->myMutex );
+  return NULL;
+}
+//--------------------------------------------------------------------
+float** csSUStencilEngine::allocGrid( int n1, int n2 ) {
+  int numFloatsRow = ( (n1 + GRID_ALIGN_FLOATS - 1) / GRID_ALIGN_FLOATS ) * GRID_ALIGN_FLOATS;
+  size_t byteSize  = (size_t)numFloatsRow * (size_t)(n2 > 0 ? n2 : 1) * sizeof(float);
+  void* block = NULL;
+  if( posix_memalign( &block, GRID_ALIGN_FLOATS*sizeof(float), byteSize ) != 0 ) {
+    throw( cseis_geolib::csException("csSUStencilEngine::allocGrid: Cannot allocate grid of %d x %d samples", n1, n2) );
+  }
+  memset( block, 0, byteSize );
+  float** grid = new float*[n2 > 0 ? n2 : 1];
+  grid[0] = (float*)block;
+  for( int i2 = 1; i2 < n2; i2++ ) {
+    grid[i2] = grid[0] + (size_t)i2 * (size_t)numFloatsRow;
+  }
+  return grid;
+}
+void csSUStencilEngine::freeGrid( float** grid ) {
+  if( grid == NULL ) return;
+  free( grid[0] );
+  delete [] grid;
+}
@@ -0,0 +1,92 @@
+/* Copyright (c) Colorado School of Mines, 2013.*/
+/* All rights reserved.                       */
+
+#ifndef CS_SU_STENCIL_ENGINE_H
+#define CS_SU_STENCIL_ENGINE_H
+
+extern "C" {
+  #include <pthread.h>
+}
+
+namespace cseis_su {
+
+/**
+ * Stencil engine for finite-difference modeling in SU modules
+ *
+ * Applies one finite-difference kernel to a range of grid rows, split into tiles of consecutive rows.
+ * Tiles are handed out to a team of threads which is created once, and kept alive until the engine is deleted.
+ * The calling thread takes part in the work. run() returns once all tiles are done, so that successive calls
+ * act as a barrier between e.g. the velocity and stress updates of one time step.
+ *
+ * Grids allocated by allocGrid() have the same [n2][n1] layout as the CWP function alloc2float(),
+ * but each row starts on a 64 byte boundary, so that inner loops over the fast dimension vectorise well.
+ * Rows are padded, i.e. grid[0] cannot be used to access all n1*n2 values as one flat array.
+ *
+ * Kernel functions must not throw.
+ *
+ * @author Bjorn Olofsson
+ * @date 2013
+ */
+class csSUStencilEngine {
+ public:
+  /**
+   * Kernel function, applied to rows firstRow to lastRow (inclusive)
+   * @param firstRow  First row of tile
+   * @param lastRow   Last row of tile
+   * @param data      User data passed to run()
+   */
+  typedef void (*KernelFunc)( int firstRow, int lastRow, void* data );
+
+ public:
+  /**
+   * @param numThreads   Number of threads, including the calling thread. 1: Run all kernels in calling thread
+   * @param numRowsTile  Number of rows per tile. 0: Choose automatically
+   */
+  csSUStencilEngine( int numThreads, int numRowsTile = 0 );
+  ~csSUStencilEngine();
+  /**
+   * Apply kernel to rows firstRow to lastRow (inclusive). Returns when all rows are done.
+   */
+  void run( KernelFunc func, void* data, int firstRow, int lastRow );
+  int numThreads() const { return myNumThreads; }
+
+  /**
+   * Allocate grid of n2 rows with n1 values each. All values are set to zero.
+   * Throws csException if memory cannot be allocated.
+   * @return Pointers to n2 rows
+   */
+  static float** allocGrid( int n1, int n2 );
+  /**
+   * Free grid allocated with allocGrid()
+   */
+  static void freeGrid( float** grid );
+
+ private:
+  static void* startThread( void* engine );
+  void processTiles();
+
+  int myNumThreads;
+  int myNumRowsTileUser;
+  pthread_t* myThreads;
+  int myNumThreadsStarted;
+  pthread_mutex_t myMutex;
+  /// Signals start of new run, or termination
+  pthread_cond_t myCondStart;
+  /// Signals completion of all tiles of current run
+  pthread_cond_t myCondDone;
+
+  /// Current run. All fields are guarded by myMutex
+  KernelFunc myFunc;
+  void* myData;
+  int myLastRow;
+  int myNumRowsTile;
+  int myNextRow;
+  int myNumTiles;
+  int myNumTilesDone;
+  int myRunCounter;
+  bool myTerminate;
+};
+
+} // END namespace
+
+#endif
@@ -8,20 +8,34 @@
 #include <cstdio>
 #include <cstring>
 #include <stdarg.h>
+#include <algorithm>
 
 using namespace cseis_su;
 using namespace std;
  
-csSUTraceManager::csSUTraceManager() {
-  myStatus     = STATUS_EMPTY;
+csSUTraceManager::csSUTraceManager( int numSlots, csSUTraceManager* lockSharedWith ) {
   myIsEOF      = false;
   myIsError    = false;
   myTrace      = -1;
   myLogFilePtr = NULL;
-  mySleepMilliSec = 2.0f;
   mySUDoc      = "";
   myBuffer     = NULL;
   myIsDocRequestOnly = false;
+  myNumSlots   = std::max( numSlots, 1 );
+  myHeadSlot   = 0;
+  myNumTraces  = 0;
+  if( lockSharedWith != NULL ) {
+    myMutex     = lockSharedWith->myMutex;
+    myCondition = lockSharedWith->myCondition;
+    myIsLockOwner = false;
+  }
+  else {
+    myMutex     = new pthread_mutex_t;
+    myCondition = new pthread_cond_t;
+    pthread_mutex_init( myMutex, NULL );
+    pthread_cond_init( myCondition, NULL );
+    myIsLockOwner = true;
+  }
   reallocateBuffer( SU_NFLTS );
 }
 
@@ -30,15 +44,23 @@ csSUTraceManager::~csSUTraceManager() {
     delete [] myBuffer;
     myBuffer = NULL;
   }
+  if( myIsLockOwner ) {
+    pthread_cond_destroy( myCondition );
+    pthread_mutex_destroy( myMutex );
+    delete myCondition;
+    delete myMutex;
+  }
+  myCondition = NULL;
+  myMutex = NULL;
 }
 
 void csSUTraceManager::reallocateBuffer( int numSamples ) {
   if( myBuffer != NULL ) delete [] myBuffer;
-  myNumSamples = numSamples;
-  myBuffer = new unsigned char[cseis_su::HDRBYTES+myNumSamples*4];
-  for( int i = 0; i < (cseis_su::HDRBYTES+myNumSamples*4); i++ ) {
-    myBuffer[i] = 0;
-  }
+  myNumSamples   = numSamples;
+  mySlotByteSize = cseis_su::HDRBYTES + myNumSamples*4;
+  size_t bufferSize = (size_t)mySlotByteSize * (size_t)myNumSlots;
+  myBuffer = new unsigned char[bufferSize];
+  memset( myBuffer, 0, bufferSize );
 }
 void csSUTraceManager::setLogFile( FILE* logFile ) {
   myLogFilePtr = logFile;
@@ -49,70 +71,133 @@ void csSUTraceManager::setDocRequestOnly() {
 bool csSUTraceManager::isDocRequestOnly() const {
   return myIsDocRequestOnly;
 }
+void csSUTraceManager::notifyAll() {
+  pthread_cond_broadcast( myCondition );
+}
+int csSUTraceManager::traceByteSize( segy const* trace ) const {
+  int numSamples = (int)trace->ns;
+  if( numSamples <= 0 || numSamples > myNumSamples ) numSamples = myNumSamples;
+  return( cseis_su::HDRBYTES + numSamples*(int)sizeof(float) );
+}
 
+//--------------------------------------------------------------------
+// Producer side
+// Only the thread putting traces into the manager increases the number of traces. The free slot
+// at the tail of the ring buffer can therefore be filled without holding the lock.
+//
 int csSUTraceManager::putTrace( cseis_geolib::csSegyTraceHeader const* suTrcHdr, float const* samplesPtr, int numSamples ) {
-  while( myStatus == STATUS_TRACE_WAITING && !myIsEOF ) {
-    csSUTraceManager::sleep_ms( mySleepMilliSec );
+  pthread_mutex_lock( myMutex );
+  while( myNumTraces == myNumSlots && !myIsEOF ) {
+    pthread_cond_wait( myCondition, myMutex );
+  }
+  if( myIsEOF ) {
+    pthread_mutex_unlock( myMutex );
+    return SU_FALSE;
   }
-  if( myIsEOF ) return SU_FALSE;
+  unsigned char* buffer = slot( myNumTraces );
+  pthread_mutex_unlock( myMutex );
 
-  suTrcHdr->writeHeaderValues(myBuffer,false,true);   // swapEndian=false, isAutoScaleHeaders=true
-  memcpy( &myBuffer[240], samplesPtr, numSamples*sizeof(float) );
-  // End: copy trace
+  suTrcHdr->writeHeaderValues(buffer,false,true);   // swapEndian=false, isAutoScaleHeaders=true
+  memcpy( &buffer[240], samplesPtr, std::min(numSamples,myNumSamples)*sizeof(float) );
 
-  myStatus = STATUS_TRACE_WAITING;
-  // fprintf(stdout,"Manager: Put trace ...\n");
+  pthread_mutex_lock( myMutex );
+  myNumTraces += 1;
+  if( myNumTraces == 1 ) notifyAll();
+  pthread_mutex_unlock( myMutex );
   return SU_TRUE;
 }
 
-
-int csSUTraceManager::getTracePtr( unsigned char const** bufferPtr ) {
-  while( myStatus == STATUS_EMPTY && !myIsEOF ) {
-    csSUTraceManager::sleep_ms( mySleepMilliSec );
+int csSUTraceManager::putTrace( segy const* trace ) {
+  pthread_mutex_lock( myMutex );
+  while( myNumTraces == myNumSlots && !myIsEOF ) {
+    pthread_cond_wait( myCondition, myMutex );
+  }
+  if( myIsEOF ) {
+    pthread_mutex_unlock( myMutex );
+    return SU_FALSE;
   }
-  if( myStatus == STATUS_EMPTY && myIsEOF ) return SU_FALSE;
-  //  fprintf(stdout,"Pulling the buffer... %x\n", myBuffer);
-  *bufferPtr = myBuffer;
+  unsigned char* buffer = slot( myNumTraces );
+  pthread_mutex_unlock( myMutex );
+
+  memcpy( buffer, trace, traceByteSize( trace ) );
+
+  pthread_mutex_lock( myMutex );
+  myNumTraces += 1;
+  if( myNumTraces == 1 ) notifyAll();
+  pthread_mutex_unlock( myMutex );
   return SU_TRUE;
 }
-void csSUTraceManager::freeTrace() {
-  myStatus = STATUS_EMPTY;
-}
 
-int csSUTraceManager::putTrace( segy const* trace ) {
-  while( myStatus == STATUS_TRACE_WAITING && !myIsEOF ) {
-    csSUTraceManager::sleep_ms( mySleepMilliSec );
+//--------------------------------------------------------------------
+// Consumer side
+// Only the thread retrieving traces from the manager decreases the number of traces. Occupied slots
+// at the head of the ring buffer can therefore be read without holding the lock.
+//
+int csSUTraceManager::waitForTraces() {
+  pthread_mutex_lock( myMutex );
+  while( myNumTraces == 0 && !myIsEOF ) {
+    pthread_cond_wait( myCondition, myMutex );
   }
-  if( myIsEOF ) return SU_FALSE;
+  int numTraces = myNumTraces;
+  pthread_mutex_unlock( myMutex );
+  return numTraces;
+}
 
-  memcpy( myBuffer, trace, 240+myNumSamples*sizeof(float) );
+unsigned char const* csSUTraceManager::tracePtr( int index ) const {
+  return slot( index );
+}
+
+void csSUTraceManager::freeTraces( int numTraces ) {
+  if( numTraces <= 0 ) return;
+  pthread_mutex_lock( myMutex );
+  numTraces = std::min( numTraces, myNumTraces );
+  bool wasFull = ( myNumTraces == myNumSlots );
+  myHeadSlot   = ( myHeadSlot + numTraces ) % myNumSlots;
+  myNumTraces -= numTraces;
+  if( wasFull && numTraces > 0 ) notifyAll();
+  pthread_mutex_unlock( myMutex );
+}
 
-  myStatus = STATUS_TRACE_WAITING;
-  //  fprintf(stdout,"Manager: Put trace...\n");
+int csSUTraceManager::getTracePtr( unsigned char const** bufferPtr ) {
+  if( waitForTraces() == 0 ) return SU_FALSE;
+  *bufferPtr = slot( 0 );
   return SU_TRUE;
 }
+void csSUTraceManager::freeTrace() {
+  freeTraces( 1 );
+}
 
 int csSUTraceManager::getTrace( segy* trace ) {
-  while( myStatus == STATUS_EMPTY && !myIsEOF ) {
-    csSUTraceManager::sleep_ms( mySleepMilliSec );
-  }
-  if( myStatus == STATUS_EMPTY && myIsEOF ) return SU_FALSE;
-  memcpy( trace, myBuffer, 240+myNumSamples*sizeof(float) );
-
-  myStatus = STATUS_EMPTY;
+  if( waitForTraces() == 0 ) return SU_FALSE;
+  segy const* buffer = (segy const*)slot( 0 );
+  memcpy( trace, buffer, traceByteSize( buffer ) );
+  freeTraces( 1 );
   return SU_TRUE;
 }
 
 int csSUTraceManager::getTraceMaybe( int* trace ) {
-  if( myStatus == STATUS_EMPTY ) return SU_FALSE;
-  myStatus = STATUS_EMPTY;
+  if( isEmpty() ) return SU_FALSE;
+  freeTraces( 1 );
   *trace = myTrace;
   //  fprintf(stdout,"Manager: Get trace %d\n", *trace);
   return SU_TRUE;
 }
 
+bool csSUTraceManager::waitForSpace( csSUTraceManager const* other ) {
+  pthread_mutex_lock( myMutex );
+  while( myNumTraces == myNumSlots && !myIsEOF && other->myNumTraces == 0 && !other->myIsEOF ) {
+    pthread_cond_wait( myCondition, myMutex );
+  }
+  bool hasSpace = ( myNumTraces < myNumSlots && !myIsEOF );
+  pthread_mutex_unlock( myMutex );
+  return hasSpace;
+}
+
 void csSUTraceManager::setEOF() {
+  pthread_mutex_lock( myMutex );
   myIsEOF = true;
+  notifyAll();
+  pthread_mutex_unlock( myMutex );
 }
 
 void csSUTraceManager::setError( char const* text, ... ) {
@@ -122,16 +207,40 @@ void csSUTraceManager::setError( char const* text, ... ) {
     vfprintf( myLogFilePtr, text, argList );
     fprintf( myLogFilePtr, "\n" );
   }
+  pthread_mutex_lock( myMutex );
   myIsError = true;
-  setEOF();
+  myIsEOF   = true;
+  notifyAll();
+  pthread_mutex_unlock( myMutex );
 }
 
 bool csSUTraceManager::isError() const {
-  return myIsError;
+  pthread_mutex_lock( myMutex );
+  bool isError = myIsError;
+  pthread_mutex_unlock( myMutex );
+  return isError;
+}
+
+bool csSUTraceManager::isEOF() const {
+  pthread_mutex_lock( myMutex );
+  bool isEOF = myIsEOF;
+  pthread_mutex_unlock( myMutex );
+  return isEOF;
+}
+
+int csSUTraceManager::numTraces() const {
+  pthread_mutex_lock( myMutex );
+  int numTraces = myNumTraces;
+  pthread_mutex_unlock( myMutex );
+  return numTraces;
 }
 
 bool csSUTraceManager::isEmpty() const {
-  return( myStatus == STATUS_EMPTY );
+  return( numTraces() == 0 );
+}
+
+bool csSUTraceManager::isFull() const {
+  return( numTraces() == myNumSlots );
 }
 
 void csSUTraceManager::setSUDoc( std::string& sdoc ) {
@@ -141,14 +250,14 @@ char const* csSUTraceManager::getSUDoc() const {
   return mySUDoc.c_str();
 }
 
-int csSUTraceManager::numSamples() const {
-  if( isEmpty() ) return -1;
-  segy const* trace = (segy*)myBuffer;
+int csSUTraceManager::numSamples( int index ) const {
+  if( index >= numTraces() ) return -1;
+  segy const* trace = (segy*)slot( index );
   return trace->ns;
 }
 
-float csSUTraceManager::sampleInt() const {
-  if( isEmpty() ) return -1;
-  segy const* trace = (segy*)myBuffer;
+float csSUTraceManager::sampleInt( int index ) const {
+  if( index >= numTraces() ) return -1;
+  segy const* trace = (segy*)slot( index );
   return ( (float)trace->dt / 1000.0 );
 }
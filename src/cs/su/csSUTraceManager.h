@@ -21,6 +21,9 @@
 #endif
 
 #include "csVector.h"
+extern "C" {
+  #include <pthread.h>
+}
 
 namespace cseis_geolib {
   class csSegyTraceHeader;
@@ -36,20 +39,33 @@ namespace cseis_su {
   static int const SU_TRUE  = 1;
 
   static int const HDRBYTES = 240;
+  /// Default number of trace slots in ring buffer
+  static int const DEFAULT_NUM_SLOTS = 16;
 
 /**
  * SU "trace manager"
  * - Manages the seismic traces exchanged between CSEIS and SU.
  * - Helps to pass on SU module self-documentation to CSEIS.
  * - Certain methods are designed to used only by CSEIS, and others by SU.
- * - Only one seismic trace is held at any one time
+ * - Traces are held in a ring buffer of N slots. One thread puts traces into the manager,
+ *   and one other thread retrieves them. Waiting threads are woken up by a condition variable.
+ * - Trace data is copied in and out of the ring buffer outside of the lock: Only the number of
+ *   traces held in the ring buffer is guarded by the mutex.
+ * - Two managers can share the same mutex & condition variable. This allows one thread to wait
+ *   for a state change in either of the two managers, see method waitForSpace().
  *
  * Enables running of SU module within CSEIS flow, with minor modifications
  * to SU source code.
  */
 class csSUTraceManager {
  public:
-  csSUTraceManager();
+  /**
+   * @param numSlots       Number of trace slots in ring buffer
+   * @param lockSharedWith Manager whose mutex & condition variable shall be used by this manager as well.
+   *                       Pass NULL to allocate separate mutex & condition variable.
+   *                       The other manager must not be deleted before this one.
+   */
+  csSUTraceManager( int numSlots = DEFAULT_NUM_SLOTS, csSUTraceManager* lockSharedWith = NULL );
   ~csSUTraceManager();
 
   /**
@@ -61,7 +77,7 @@ class csSUTraceManager {
   /**
    * @return Status: Either STATUS_TRACE_WAITING or STATUS_EMPTY (no trace available)
    */
-  int getStatus() const { return myStatus; }
+  int getStatus() const { return( isEmpty() ? STATUS_EMPTY : STATUS_TRACE_WAITING ); }
 
   /**
    * Retrieve seismic trace if available. Otherwise, return SU_FALSE.
@@ -86,7 +102,7 @@ class csSUTraceManager {
    */
   int putTrace( segy const* trace );
 
-  //-------------------- Methods to be used in SU program --------------------
+  //-------------------- Methods to be used in CSEIS --------------------
   /**
    * Retrieve pointer to trace (to be used by CSEIS)
    * The pointer is alive until method 'freeTrace' is called.
@@ -99,6 +115,33 @@ class csSUTraceManager {
    * Free seismic trace whose pointer was previously retrieved using method 'getTracePointer()'
    */
   void freeTrace();
+  /**
+   * Wait until at least one trace is available, or the EOF flag was set (to be used by CSEIS)
+   *
+   * @return Number of traces currently held in the manager. 0 if EOF flag was set and no traces are left.
+   */
+  int waitForTraces();
+  /**
+   * Retrieve pointer to one of the traces currently held in the manager (to be used by CSEIS)
+   * Traces are retrieved in bulk: Call numTraces() or waitForTraces() first, access traces by index,
+   * then release all accessed traces with one call to freeTraces().
+   *
+   * @param index  Index of trace, 0 = oldest trace. Must be smaller than number of traces held in manager
+   */
+  unsigned char const* tracePtr( int index ) const;
+  /**
+   * Free the given number of oldest traces (to be used by CSEIS)
+   */
+  void freeTraces( int numTraces );
+  /**
+   * Wait until this manager can accept a new trace, the other manager holds at least one trace,
+   * or the EOF flag was set in either manager (to be used by CSEIS).
+   * Both managers must share the same mutex & condition variable.
+   *
+   * @param other  Manager holding traces in opposite direction
+   * @return true if this manager can accept a new trace, false otherwise
+   */
+  bool waitForSpace( csSUTraceManager const* other );
   /**
    * Put a trace in the manager (to be used by CSEIS)
    *
@@ -129,11 +172,23 @@ class csSUTraceManager {
   /**
    * @return  true if EOF flag has been set
    */
-  bool isEOF() const { return myIsEOF; }
+  bool isEOF() const;
   /**
    * @return true if manager currently doesn't hold any traces
    */
   bool isEmpty() const;
+  /**
+   * @return true if all trace slots are occupied
+   */
+  bool isFull() const;
+  /**
+   * @return Number of traces currently held in the manager
+   */
+  int numTraces() const;
+  /**
+   * @return Number of trace slots
+   */
+  int numSlots() const { return myNumSlots; }
   /**
    * Indicate that this call to the SU module is for retrieval of the self-doc only
    */
@@ -164,34 +219,54 @@ class csSUTraceManager {
   char const* getSUDoc() const;
 
   /**
+   * @param index  Index of trace, 0 = oldest trace
    * @return Number of samples output by SU (if trace is available, -1 otherwise)
    */
-  int numSamples() const;
+  int numSamples( int index = 0 ) const;
 
   /**
+   * @param index  Index of trace, 0 = oldest trace
    * @return Number of sample interval [ms] output by SU (if trace is available, -1 otherwise)
    */
-  float sampleInt() const;
+  float sampleInt( int index = 0 ) const;
 
  private:
   void reallocateBuffer( int numSamples );
+  /// Pointer to trace slot with given index, counted from oldest trace
+  unsigned char* slot( int index ) const {
+    return &myBuffer[ (size_t)((myHeadSlot + index) % myNumSlots) * (size_t)mySlotByteSize ];
+  }
+  /// Number of bytes to copy for given SU trace: Header + actual number of samples
+  int traceByteSize( segy const* trace ) const;
+  /// Wake up all waiting threads. Must be called with mutex locked
+  void notifyAll();
 
   /// Pointer to log file/stream: Do not allocate or deallocate
   std::FILE* myLogFilePtr;
   int myTrace;
-  int myStatus;
-  ///
-  float mySleepMilliSec;
+  /// Mutex guarding number of traces and flags. May be shared with other manager
+  pthread_mutex_t* myMutex;
+  /// Condition variable signalling change of state. May be shared with other manager
+  pthread_cond_t* myCondition;
+  /// true if this manager allocated the mutex & condition variable
+  bool myIsLockOwner;
   /// EOF flag
   bool myIsEOF;
   /// Error flag
   bool myIsError;
   /// Flag indicating that this call to SU module is to retrieve self-doc only
   bool myIsDocRequestOnly;
-  ///
+  /// Ring buffer: myNumSlots trace slots
   unsigned char* myBuffer;
-  /// Numbwer of samples in trace
+  /// Number of samples in trace slot
   int myNumSamples;
+  /// Byte size of one trace slot (header + samples)
+  int mySlotByteSize;
+  int myNumSlots;
+  /// Slot index of oldest trace
+  int myHeadSlot;
+  /// Number of traces currently held in the ring buffer
+  int myNumTraces;
   std::string mySUDoc;
 };
 
@@ -6,6 +6,17 @@
 
 #include "csSUGetPars.h"
 
+/*
+ * Storage class of all file-scope variables and static variables in SU module source code.
+ * Each SU module runs in its own thread. Thread-local storage gives each running instance of an SU module
+ * its own copy of these variables, so the same SU module can be used several times in one flow.
+ */
+#ifdef _MSC_VER
+ #define CSEIS_SU_THREAD_LOCAL static __declspec(thread)
+#else
+ #define CSEIS_SU_THREAD_LOCAL static __thread
+#endif
+
 /* Forward declarations of SU library functions which had to be modified for SEASEIS  */
 
 void cseis_decodeReflectors( cseis_su::csSUGetPars* parObj, int *nrPtr,
@@ -7,6 +7,7 @@
 #include <cstring>
 #include <ctime>
 #include "csVector.h"
+#include "csCompareVector.h"
 #include "csFileUtils.h"
  
 using namespace std;
@@ -36,6 +37,20 @@ void countCurlyBrackets( int* numCurlyBrackets, char const* buffer );
 void findReplaceDecodeReflectors( std::string& str );
 void findReplaceGetParVal( std::string& str );
 
+/// Scope information carried from one source line to the next
+struct ScopeState {
+  ScopeState() : numCurlyBrackets(0), numRoundBrackets(0), isInComment(false), isInStatement(false) {}
+  int numCurlyBrackets;
+  int numRoundBrackets;
+  bool isInComment;
+  bool isInStatement;
+  /// Names of variables converted to thread-local variables
+  csCompareVector<std::string> threadLocalNames;
+};
+// Make file-scope variables and static function variables thread-local
+void findReplaceStaticVariables( std::string& str, ScopeState* scope );
+int convertThreadLocal( int numFiles, char** filenames );
+
 static int const STATE_00_START    = 0;
 static int const STATE_01_INCLUDE  = 1;
 static int const STATE_02_SDOC_START = 2;
@@ -62,12 +77,24 @@ g++ helper_convert_su_c2cpp.cc -o helper_convert_su_c2cpp -I../geolib -Wl,-rpath
 
 Next, enter the new modules into the list of available SU modules in file $SRCDIR/src/su/su_modules.txt.
 
+  Global and static variables:
+All file-scope variables and static variables in SU module source code are converted into thread-local variables
+(storage class CSEIS_SU_THREAD_LOCAL, see cseis_sulib.h). Each SU module runs in its own thread, so several instances
+of the same SU module can run concurrently in one flow.
+SU module source files that were converted by an earlier version of this helper program can be updated in place.
+Pass all C++ source files in directory $SRCDIR/src/cs/su/main, for example:
+cd $SRCDIR/src/cs/su/main
+../helper_convert_su_c2cpp  -thread_local  *.cc
+
  */
 
 
 int main( int argc, char** argv ) {
   int numCurlyBrackets = 0;
 
+  if( argc > 1 && !strcmp( argv[1], "-thread_local" ) ) {
+    return convertThreadLocal( argc-2, &argv[2] );
+  }
   if( argc < 3 ) {
     fprintf(stderr,"Error. Missing arguments: input directory, output directory\n");
     exit(-1);
@@ -118,6 +145,7 @@ int main( int argc, char** argv ) {
   FILE* fout = fopen(filenameOut.c_str(),"w");
 
   bool mainBracketFound = false;
+  ScopeState scope;
 
   //  fprintf(stderr,"Input file:  %s\n", filenameIn.c_str());
   //  fprintf(stderr,"Output file: %s\n", filenameOut.c_str());
@@ -126,6 +154,8 @@ int main( int argc, char** argv ) {
     string text(buffer);
     bool writeBuffer = true;
     int found = 0;
+    // Only source code inside module namespace is scanned for variables
+    bool isInNamespace = ( state >= STATE_05_MAIN );
 
     if( state > STATE_05_MAIN && state < STATE_08_END ) {
       countCurlyBrackets( &numCurlyBrackets, buffer );
@@ -315,6 +345,9 @@ int main( int argc, char** argv ) {
       }
     }
 
+    if( isInNamespace ) {
+      findReplaceStaticVariables( text, &scope );
+    }
     if( writeBuffer ) {
       fprintf(fout,"%s", text.c_str());
     }
@@ -332,6 +365,171 @@ int main( int argc, char** argv ) {
   return 0;
 }
 
+//--------------------------------------------------------------------
+// Convert file-scope variables and static variables of previously converted SU module source files
+// Source code is scanned from the module namespace onwards. Files are overwritten.
+//
+int convertThreadLocal( int numFiles, char** filenames ) {
+  for( int ifile = 0; ifile < numFiles; ifile++ ) {
+    FILE* fin = fopen( filenames[ifile], "r" );
+    if( fin == NULL ) {
+      fprintf(stderr,"Cannot open file '%s'\n", filenames[ifile]);
+      continue;
+    }
+    std::string textOut;
+    char buffer[512];
+    bool isInNamespace = false;
+    ScopeState scope;
+    while( fgets( buffer, 512, fin ) != NULL ) {
+      string text(buffer);
+      if( isInNamespace ) {
+        if( !text.compare(0,20,"} // END namespace\n") ) isInNamespace = false;
+        else findReplaceStaticVariables( text, &scope );
+      }
+      else if( !text.compare(0,10,"namespace ") ) {
+        isInNamespace = true;
+      }
+      textOut.append( text );
+    }
+    fclose(fin);
+    FILE* fout = fopen( filenames[ifile], "w" );
+    if( fout == NULL ) {
+      fprintf(stderr,"Cannot write file '%s'\n", filenames[ifile]);
+      continue;
+    }
+    fprintf(fout,"%s",textOut.c_str());
+    fclose(fout);
+  }
+  return 0;
+}
+
+//--------------------------------------------------------------------
+// Declarations of variables at file scope, and of static variables within functions, are prefixed with
+// thread-local storage class. Function declarations, type definitions and constants are left untouched.
+// Only the first line of each declaration is considered.
+//
+void findReplaceStaticVariables( std::string& text, ScopeState* scope ) {
+  // Step 1: Strip comments and string literals
+  std::string code;
+  bool isInString = false;
+  char quote = '"';
+  int length = text.length();
+  for( int i = 0; i < length; i++ ) {
+    char c = text[i];
+    if( scope->isInComment ) {
+      if( c == '*' && i+1 < length && text[i+1] == '/' ) {
+        scope->isInComment = false;
+        i += 1;
+      }
+      continue;
+    }
+    if( isInString ) {
+      if( c == '\\' ) i += 1;
+      else if( c == quote ) isInString = false;
+      continue;
+    }
+    if( c == '/' && i+1 < length && text[i+1] == '*' ) {
+      scope->isInComment = true;
+      code.append(" ");
+      i += 1;
+    }
+    else if( c == '/' && i+1 < length && text[i+1] == '/' ) {
+      break;
+    }
+    else if( c == '"' || c == '\'' ) {
+      isInString = true;
+      quote = c;
+      code.append(" ");
+    }
+    else {
+      code += c;
+    }
+  }
+  code = trim( code );
+  if( code.length() == 0 || code[0] == '#' ) return;
+
+  // Step 2: Check if line starts new variable declaration
+  bool isStatic = !code.compare(0,7,"static ") || !code.compare(0,7,"static\t");
+  // Line converted in an earlier run: Not modified again, but its variable names are still recorded
+  bool isConverted = !code.compare(0,21,"CSEIS_SU_THREAD_LOCAL");
+  if( !scope->isInStatement && scope->numRoundBrackets == 0 && (scope->numCurlyBrackets == 0 || isStatic || isConverted) ) {
+    std::string decl = code;
+    if( isStatic ) decl = trim( code.substr(7) );
+    else if( isConverted ) decl = trim( code.substr(21) );
+    char const* skipWords[] = { "const", "typedef", "struct", "union", "enum", "extern", "inline", "namespace", "using", "return" };
+    bool isVariable = true;
+    for( int iword = 0; iword < 10; iword++ ) {
+      int len = strlen( skipWords[iword] );
+      if( !decl.compare(0,len,skipWords[iword]) && ((int)decl.length() == len || decl[len] == ' ' || decl[len] == '\t' || decl[len] == '{') ) {
+        isVariable = false;
+        break;
+      }
+    }
+    if( isVariable ) {
+      // Variable declaration: Type name is followed by '=', ';', '[' or ','. Function declaration: By '('. '{': Type or function definition
+      int pos = decl.find_first_of( "(=;[,{" );
+      if( pos < 0 || decl[pos] == '(' || decl[pos] == '{' ) isVariable = false;
+    }
+    // Leave lines untouched that start with a comment
+    int found = text.find_first_not_of( " \t" );
+    if( isVariable && !text.compare(found,2,"/*") ) isVariable = false;
+    // Thread-local variables cannot be initialized with the address of another thread-local variable
+    csVector<std::string> names;
+    if( isVariable ) {
+      int pos = decl.find_first_of( ";" );
+      std::string declarators = decl.substr( 0, pos < 0 ? decl.length() : pos );
+      int start = 0;
+      while( start < (int)declarators.length() ) {
+        // Find end of declarator: Next comma outside of initializer list
+        int end = start;
+        int numBrackets = 0;
+        while( end < (int)declarators.length() && (declarators[end] != ',' || numBrackets > 0) ) {
+          if( declarators[end] == '{' ) numBrackets += 1;
+          else if( declarators[end] == '}' ) numBrackets -= 1;
+          end += 1;
+        }
+        std::string item = declarators.substr( start, end-start );
+        int posEqual = item.find( '=' );
+        if( posEqual >= 0 ) {
+          std::string init = trim( item.substr( posEqual+1 ) );
+          if( !isConverted && scope->threadLocalNames.contains( init ) ) isVariable = false;
+          item = item.substr( 0, posEqual );
+        }
+        int posBracket = item.find( '[' );
+        if( posBracket >= 0 ) item = item.substr( 0, posBracket );
+        item = trim( item );
+        int posName = item.find_last_not_of( "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_" );
+        names.insertEnd( item.substr( posName+1 ) );
+        start = end + 1;
+      }
+    }
+    if( isVariable ) {
+      if( isConverted ) {
+        // Already thread-local
+      }
+      else if( isStatic ) {
+        text.replace( found, 6, "CSEIS_SU_THREAD_LOCAL" );
+      }
+      else {
+        text.insert( found, "CSEIS_SU_THREAD_LOCAL " );
+      }
+      for( int i = 0; i < names.size(); i++ ) {
+        scope->threadLocalNames.insertEnd( names.at(i) );
+      }
+    }
+  }
+
+  // Step 3: Update scope
+  for( int i = 0; i < (int)code.length(); i++ ) {
+    if( code[i] == '{' ) scope->numCurlyBrackets += 1;
+    else if( code[i] == '}' ) scope->numCurlyBrackets -= 1;
+    else if( code[i] == '(' ) scope->numRoundBrackets += 1;
+    else if( code[i] == ')' ) scope->numRoundBrackets -= 1;
+  }
+  char lastChar = code[code.length()-1];
+  scope->isInStatement = ( lastChar != ';' && lastChar != '{' && lastChar != '}' );
+}
+
 void writeCSEISIncludes( FILE* fout ) {
   fprintf(fout,"#include \"csException.h\"\n");
   fprintf(fout,"#include \"csSUTraceManager.h\"\n");
@@ -133,7 +133,7 @@ void writeMake( FILE* fout, cseis_geolib::csVector<std::string>* moduleList ) {
   fprintf(fout,"	rm -f $(LIBDIR)/$(LIB_SU)\n");
   fprintf(fout,"\n");
   fprintf(fout,"$(LIBDIR)/$(LIB_SU): $(OBJS_SU)\n");
-  fprintf(fout,"	$(CPP) -shared -Wl,-soname,$(LIB_SU) -o $(LIBDIR)/$(LIB_SU) $(OBJS_SU) -L$(LIBDIR) -L$(CWPROOT)/lib -lc -lgeolib -lsu -lpar -lcwp -lm -lpthread\n");
+  fprintf(fout,"	$(CPP) -shared -Wl,-soname,$(LIB_SU) -o $(LIBDIR)/$(LIB_SU) $(OBJS_SU) -L$(LIBDIR) -L$(CWPROOT)/lib -lc -lgeolib -lcseis_supar -lsu -lpar -lcwp -lm -lpthread\n");
   fprintf(fout,"\n");
   fprintf(fout,"##################################################\n");
   fprintf(fout,"###### SU modules ##############\n");
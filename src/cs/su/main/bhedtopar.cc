@@ -64,7 +64,7 @@ static char *getbhkey(const int index);
 static void fprintfparval(FILE *stream, cwp_String key,
 				cwp_String type, Value val);
 
-static bhed bh;		/* binary header read from file */
+CSEIS_SU_THREAD_LOCAL bhed bh;		/* binary header read from file */
 
 void* main_bhedtopar( void* args )
 {
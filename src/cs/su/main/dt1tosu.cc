@@ -124,11 +124,11 @@ typedef struct {
 	short data[SU_NFLTS];  /* use SU maximum number data values */
 } ssdt1;
 
-ssdt1 sstr;
-segy tr;
+CSEIS_SU_THREAD_LOCAL ssdt1 sstr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 /* list explaining the ssdt1 convention */
-char *list[] = {
+CSEIS_SU_THREAD_LOCAL char *list[] = {
 " float	 tracl;		trace number				",
 " float	 posit;		position				",
 " float	 ns;		number of points per trace		",
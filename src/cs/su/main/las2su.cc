@@ -83,7 +83,7 @@ namespace las2su {
 /* function prototype for subroutine used internally */
 int las_getnewline(char line[], int maxline);
 
-segy tr;	/* output trace structure */
+CSEIS_SU_THREAD_LOCAL segy tr;	/* output trace structure */
 
 void* main_las2su( void* args )
 {
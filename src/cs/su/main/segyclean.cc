@@ -46,7 +46,7 @@ namespace segyclean {
 /**************** end self doc ********************************/
 
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_segyclean( void* args )
 {
@@ -66,8 +66,8 @@ namespace segyhdrs {
  */
 /**************** end self doc ***********************************/
 
-static segy tr;
-static bhed bh;
+CSEIS_SU_THREAD_LOCAL segy tr;
+CSEIS_SU_THREAD_LOCAL bhed bh;
 
 void* main_segyhdrs( void* args )
 {
@@ -200,10 +200,10 @@ static void ugethval(cwp_String type1, Value *valp1,
 		      char *tr, int endian, int conv, int verbose);
 
 /* Globals */
-tapesegy tapetr;
-tapebhed tapebh;
-segy tr;
-bhed bh;
+CSEIS_SU_THREAD_LOCAL tapesegy tapetr;
+CSEIS_SU_THREAD_LOCAL tapebhed tapebh;
+CSEIS_SU_THREAD_LOCAL segy tr;
+CSEIS_SU_THREAD_LOCAL bhed bh;
 
 void* main_segyread( void* args )
 {
@@ -125,13 +125,13 @@ static void
 	segy_to_tapesegy(const segy *trptr, tapesegy *tapetrptr, size_t nsegy); 
 
 /*  globals */
-tapesegy tapetr;
-tapebhed tapebh;
+CSEIS_SU_THREAD_LOCAL tapesegy tapetr;
+CSEIS_SU_THREAD_LOCAL tapebhed tapebh;
 #endif			/* end if SUXDR */
 
 /* globals */
-segy tr;
-bhed bh;
+CSEIS_SU_THREAD_LOCAL segy tr;
+CSEIS_SU_THREAD_LOCAL bhed bh;
 
 void* main_segywrite( void* args )
 {
@@ -84,8 +84,8 @@ namespace setbhed {
  */
 /**************** end self doc ***********************************/
 
-segy tr;
-bhed bh;
+CSEIS_SU_THREAD_LOCAL segy tr;
+CSEIS_SU_THREAD_LOCAL bhed bh;
 
 void* main_setbhed( void* args )
 {
@@ -68,7 +68,7 @@ Author:  B.Nemeth, Potash Corporation of Saskatoon, Saskatchewan CA
 /**************** end self doc ********************************/
    
 /* Segy data constans */
-segy tr;				/* SEGY trace */
+CSEIS_SU_THREAD_LOCAL segy tr;				/* SEGY trace */
 
 void* main_su2voxet( void* args )
 {
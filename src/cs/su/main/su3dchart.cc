@@ -62,7 +62,7 @@ namespace su3dchart {
 
 /**************** end self doc ***********************************/
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_su3dchart( void* args )
 {
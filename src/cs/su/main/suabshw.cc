@@ -48,7 +48,7 @@ namespace suabshw {
 /* function prototype of function used internally */
 void absval(cwp_String type, Value *valp);
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suabshw( void* args )
 {
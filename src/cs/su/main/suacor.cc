@@ -45,7 +45,7 @@ namespace suacor {
  */
 /**************** end self doc *******************************************/
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suacor( void* args )
 {
@@ -70,7 +70,7 @@ complex dopow(complex u, float a, float b);
 #define LOOKFAC		2	/* Look ahead factor for npfao	  */
 #define PFA_MAX		720720	/* Largest allowed nfft		  */
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suacorfrac( void* args )
 {
@@ -61,7 +61,7 @@ namespace suaddevent {
  */
 /**************** end self doc *******************************************/
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suaddevent( void* args )
 {
@@ -80,7 +80,7 @@ namespace suaddhead {
 extern unsigned char su_text_hdr[3200];
 extern bhed su_binary_hdr;
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suaddhead( void* args )
 {
@@ -154,7 +154,7 @@ void* main_suaddhead( void* args )
 #endif
 		
 	while (isreading==cwp_true) {
-		static int tracl = 0;	/* one-based trace number */
+		CSEIS_SU_THREAD_LOCAL int tracl = 0;	/* one-based trace number */
 
 		/* If Fortran data, read past the record size bytes */
 		if (ftn) efread(junk, ISIZE, 1, stdin);
@@ -101,15 +101,15 @@ namespace suaddnoise {
 static void closefiles(void);
 
 /* Globals (so can trap signal) defining temporary disk files */
-char tracefile[BUFSIZ];	/* filename for the file of traces	*/
-char headerfile[BUFSIZ];/* filename for the file of headers	*/
-FILE *tracefp;		/* fp for trace storage file		*/
-FILE *headerfp;		/* fp for header storage file		*/
-static char bandoutfile[L_tmpnam];  /* output file for sufilter	*/
-static FILE *bandoutfp;		    /* fp for output file	*/
+CSEIS_SU_THREAD_LOCAL char tracefile[BUFSIZ];	/* filename for the file of traces	*/
+CSEIS_SU_THREAD_LOCAL char headerfile[BUFSIZ];/* filename for the file of headers	*/
+CSEIS_SU_THREAD_LOCAL FILE *tracefp;		/* fp for trace storage file		*/
+CSEIS_SU_THREAD_LOCAL FILE *headerfp;		/* fp for header storage file		*/
+CSEIS_SU_THREAD_LOCAL char bandoutfile[L_tmpnam];  /* output file for sufilter	*/
+CSEIS_SU_THREAD_LOCAL FILE *bandoutfp;		    /* fp for output file	*/
 
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suaddnoise( void* args )
 {
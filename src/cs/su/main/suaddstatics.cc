@@ -63,7 +63,7 @@ namespace suaddstatics {
  */
 /************************ end self doc ***********************************/
 
-segy tr;		/* SEGY DATA */
+CSEIS_SU_THREAD_LOCAL segy tr;		/* SEGY DATA */
 
 extern void sranuni();
 extern double Randdouble();
@@ -106,7 +106,7 @@ namespace suahw {
 #define PRESERVE	3
 #define TRANSFER	4
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 /* Prototypes */
 
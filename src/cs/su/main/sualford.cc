@@ -127,10 +127,10 @@ namespace sualford {
 
 
 /* Global variables */
-segy in_S11_tr, out_S11_tr;
-segy in_S12_tr, out_S12_tr;
-segy in_S21_tr, out_S21_tr;
-segy in_S22_tr, out_S22_tr;
+CSEIS_SU_THREAD_LOCAL segy in_S11_tr, out_S11_tr;
+CSEIS_SU_THREAD_LOCAL segy in_S12_tr, out_S12_tr;
+CSEIS_SU_THREAD_LOCAL segy in_S21_tr, out_S21_tr;
+CSEIS_SU_THREAD_LOCAL segy in_S22_tr, out_S22_tr;
 
 
 /* function prototypes */
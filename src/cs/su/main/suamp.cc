@@ -96,7 +96,7 @@ namespace suamp {
 #define	SUPHASE	5
 #define	OUPHASE	6
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suamp( void* args )
 {
@@ -70,7 +70,7 @@ namespace suanalytic {
 /**************** end self doc ***********************************/
 
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suanalytic( void* args )
 {
@@ -83,7 +83,7 @@ namespace suascii {
 /* function prototype (for bare=5) */
 void printXYZ(segy tr, char *key);
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suascii( void* args )
 {
@@ -312,8 +312,8 @@ Author: Nils Maercklin, March 2006
     Value val;           /* ... its value */
     float x;             /* trace coordinate (slow dimension) */
     float d1,f1;         /* time sampling and time of first sample */
-    static float d2,f2;  /* trace sampling and coordinate of first trace */
-    static int itr=0;    /* internal trace counter */
+    CSEIS_SU_THREAD_LOCAL float d2,f2;  /* trace sampling and coordinate of first trace */
+    CSEIS_SU_THREAD_LOCAL int itr=0;    /* internal trace counter */
     register int i;      /* loop index */
 
 
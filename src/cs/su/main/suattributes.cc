@@ -120,7 +120,7 @@ namespace suattributes {
 void differentate1d(int n, float h, float *f);
 void twindow(int nt, int wtime, float *data);
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suattributes( void* args )
 {
@@ -121,7 +121,7 @@ double computeAzimuth(double sx, double sy,
 void setval(cwp_String type_out, Value *val_out, double dval_out);
 
 /* SEG-Y trace */
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suazimuth( void* args )
 {
@@ -97,7 +97,7 @@ namespace subackush {
 static void dobackus(int navg, int nz, float *p, float *avg);
 static void handlEnds(int navg, int nz, float *p);
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_subackush( void* args )
 {
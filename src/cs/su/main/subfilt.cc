@@ -64,7 +64,7 @@ namespace subfilt {
 
 
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_subfilt( void* args )
 {
@@ -64,8 +64,8 @@ namespace succepstrum {
 #define PFA_MAX 720720  /* Largest allowed nfft	   */
 
 /* Segy data constants */
-segy tr;				/* SEGY trace */
-segy trout;
+CSEIS_SU_THREAD_LOCAL segy tr;				/* SEGY trace */
+CSEIS_SU_THREAD_LOCAL segy trout;
 
 void rcceps(int sign1, int sign2, float unwrap, int trend, int zeromean, 
 			int nt, float *x, float *c);
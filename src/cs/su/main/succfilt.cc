@@ -64,8 +64,8 @@ namespace succfilt {
 
 /**************** end self doc ********************************/
 
-segy tr;
-segy tr2;
+CSEIS_SU_THREAD_LOCAL segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr2;
 
 void* main_succfilt( void* args )
 {
@@ -129,8 +129,8 @@ cfourier (float a, float fmax, float c, float p,float dt, int nt, complex *w);
 
 #define I	cmplx(0.0, 1.0)
 
-segy tr;	/* input trace */
-segy cwt;	/* wavelet transform trace for one scale value */
+CSEIS_SU_THREAD_LOCAL segy tr;	/* input trace */
+CSEIS_SU_THREAD_LOCAL segy cwt;	/* wavelet transform trace for one scale value */
 
 void* main_succwt( void* args )
 {
@@ -83,7 +83,7 @@ namespace sucddecon {
  */
 /**************** end self doc *******************************************/
 
-segy tr, sutrace;
+CSEIS_SU_THREAD_LOCAL segy tr, sutrace;
 
 void* main_sucddecon( void* args )
 {
@@ -53,7 +53,7 @@ namespace sucdpbin {
 
 /**************** end self doc ***********************************/
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sucdpbin( void* args )
 {
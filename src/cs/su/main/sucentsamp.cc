@@ -53,7 +53,7 @@ namespace sucentsamp {
  */
 /**************** end self doc ***********************************/
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sucentsamp( void* args )
 {
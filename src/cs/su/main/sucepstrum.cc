@@ -59,8 +59,8 @@ namespace sucepstrum {
 #define PFA_MAX 720720  /* Largest allowed nfft	   */
 
 /* Segy data constants */
-segy tr;				/* SEGY trace */
-segy trout;
+CSEIS_SU_THREAD_LOCAL segy tr;				/* SEGY trace */
+CSEIS_SU_THREAD_LOCAL segy trout;
 
 void rceps(int sign1, int sign2, int nt, int mph,float *x,float *c);
 
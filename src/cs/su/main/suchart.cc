@@ -66,7 +66,7 @@ namespace suchart {
 /**************** end self doc ***********************************/
 
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suchart( void* args )
 {
@@ -85,7 +85,7 @@ void changeval(cwp_String type1, Value *valp1, cwp_String type2,
 	       Value *valp2, cwp_String type3, Value *valp3,
 		double a, double b, double c, double d, double e, double f);
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suchw( void* args )
 {
@@ -48,7 +48,7 @@ namespace sucliphead {
 
 void changeval(cwp_String type, Value *valp, float fval);
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sucliphead( void* args )
 {
@@ -95,7 +95,7 @@ namespace suclogfft {
 #define SIMPLE 0
 #define OPPEN 1
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suclogfft( void* args )
 {
@@ -107,8 +107,8 @@ namespace sucmp {
 /************************** end self doc ******************************/
       
 
-segy traceA;
-segy traceB;
+CSEIS_SU_THREAD_LOCAL segy traceA;
+CSEIS_SU_THREAD_LOCAL segy traceB;
 
 void* main_sucmp( void* args )
 {
@@ -66,7 +66,7 @@ namespace sucommand {
 /**************** end self doc ***********************************/
 
 
-segy trace;
+CSEIS_SU_THREAD_LOCAL segy trace;
 
 void* main_sucommand( void* args )
 {
@@ -75,7 +75,7 @@ namespace suconv {
  */
 /**************** end self doc *******************************************/
 
-segy intrace, outtrace, sutrace;
+CSEIS_SU_THREAD_LOCAL segy intrace, outtrace, sutrace;
 
 void* main_suconv( void* args )
 {
@@ -49,7 +49,7 @@ namespace sucountkey {
 /**************** end self doc ********************************/
 
 /* Globals variables*/
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 /* internal structure */
 typedef struct {
@@ -109,8 +109,8 @@ void
 MexicanHatFunction(int nwavelet, float xmin, float xcenter,
 			float xmax, float sigma, float *wavelet);
 
-segy tr;	/* data for which transform is calculated */
-segy outtr;	/* transforms */
+CSEIS_SU_THREAD_LOCAL segy tr;	/* data for which transform is calculated */
+CSEIS_SU_THREAD_LOCAL segy outtr;	/* transforms */
 
 void* main_sucwt( void* args )
 {
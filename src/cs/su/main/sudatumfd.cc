@@ -102,7 +102,7 @@ void unpadsub(complex ***ifr,complex ***ifr_pad,int nsx,int nx,
 void taper(complex ***ifr_pad,complex ***ifr_pt,int nsx,int nx_pad,
 	   int nw,float dw,int tap_len,int buff,int nx);
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sudatumfd( void* args )
 {
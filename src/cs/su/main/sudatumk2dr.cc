@@ -167,7 +167,7 @@ typedef struct SurfaceStruct {
              Surface *srf,float **szif,float *sz,float *nangl);
 
 /* segy trace */
-segy tr, tro;
+CSEIS_SU_THREAD_LOCAL segy tr, tro;
 
 void* main_sudatumk2dr( void* args )
 {
@@ -1196,8 +1196,8 @@ void filt(float *trace,int nt,float dt,float fmax,int m,
     tracei(nt) 	filtered, integrated and phase-shifted seismic trace 
 ********************************************************************/
 {
-	static int nfft=0, itaper, nw, nwf;
-	static float *taper, *amp, *ampi, dw;
+	CSEIS_SU_THREAD_LOCAL int nfft=0, itaper, nw, nwf;
+	CSEIS_SU_THREAD_LOCAL float *taper, *amp, *ampi, dw;
 	int  it,iw,itemp;
 	float temp, ftaper, const2, *rt;
 	complex *ct;
@@ -83,7 +83,7 @@ namespace sudgwaveform {
 */
 /************************ end self doc **********************************/
 
-static segy tr;	/* structure of type segy that contains the waveform */
+CSEIS_SU_THREAD_LOCAL segy tr;	/* structure of type segy that contains the waveform */
 
 void* main_sudgwaveform( void* args )
 {
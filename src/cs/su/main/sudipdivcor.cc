@@ -99,7 +99,7 @@ void divcortable(int nt,int np,float dt,float tt[],float vt[],float **divcor,
 void dipfilt(float k,float dpx, float dt, int np, int nw, int nt, float
 		**div, complex *p,complex *q);
 	
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sudipdivcor( void* args )
 {
@@ -59,7 +59,7 @@ namespace sudivcor {
 /**************** end self doc *******************************************/
 
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sudivcor( void* args )
 {
@@ -84,7 +84,7 @@ namespace sudivstack {
 /**************** end self doc ********************************/
 
 
-segy intrace,outtrace;
+CSEIS_SU_THREAD_LOCAL segy intrace,outtrace;
 
 void* main_sudivstack( void* args )
 {   
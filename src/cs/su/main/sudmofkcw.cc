@@ -118,7 +118,7 @@ static void table (int ntable, float gamma, float *zoh, float *boh);
 static void stretchfactor (float sdmo, float gamma, float *s1, float *s2);
 
 /* Globals */
-segy tr,tro;
+CSEIS_SU_THREAD_LOCAL segy tr,tro;
 
 void* main_sudmofkcw( void* args )
 {
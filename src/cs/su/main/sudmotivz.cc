@@ -133,7 +133,7 @@ void rayvt (float p, int nt, float dt,
 	float a1111[], float a3333[], float a1313[], float a1133[],
 	float tau[], float x[], float a[], float s[]);
 
-segy tr,tro;
+CSEIS_SU_THREAD_LOCAL segy tr,tro;
 
 void* main_sudmotivz( void* args )
 {
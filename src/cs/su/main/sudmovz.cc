@@ -111,7 +111,7 @@ void intder (float **f, int nx, float dx, float fx,
 void rayvt (float p, int nt, float dt,
 	float v[], float tau[], float x[], float a[]); 
 
-segy tr,tro;
+CSEIS_SU_THREAD_LOCAL segy tr,tro;
 
 void* main_sudmovz( void* args )
 {
@@ -65,12 +65,12 @@ void dump(float *data, float dt, float *hedr, cwp_String *key,
 static void closefiles(void) ;
 
 /* Globals (so can trap signal) defining temporary disk files */
-char tracefile[BUFSIZ] ;   /* filename for the file of traces */
-char headerfile[BUFSIZ] ;  /* filename for the file of headers */
-FILE *tracefp ;            /* fp for trace storage file */
-FILE *headerfp ;           /* fp for header storage file */
+CSEIS_SU_THREAD_LOCAL char tracefile[BUFSIZ] ;   /* filename for the file of traces */
+CSEIS_SU_THREAD_LOCAL char headerfile[BUFSIZ] ;  /* filename for the file of headers */
+CSEIS_SU_THREAD_LOCAL FILE *tracefp ;            /* fp for trace storage file */
+CSEIS_SU_THREAD_LOCAL FILE *headerfp ;           /* fp for header storage file */
 
-segy tr ;
+CSEIS_SU_THREAD_LOCAL segy tr ;
 
 void* main_sudumptrace( void* args )
 {
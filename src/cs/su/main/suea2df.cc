@@ -9,6 +9,7 @@
 #include "csSUGetPars.h"
 #include "su_complex_declarations.h"
 #include "cseis_sulib.h"
+#include "csSUStencilEngine.h"
 #include <string>
 
 extern "C" {
@@ -104,6 +105,7 @@ std::string sdoc_suea2df =
 "			media - may help reduce dispersion tsw=1. If	"
 "			tsw=0 then standard calculation	  		"
 " verbose=0		=1 to print progress on screen			"
+" nthreads=1		number of threads for velocity and stress updates"
 "									"
 " Notes:								"
 " 1) The outfile contains information generated by the input parameters,"
@@ -213,7 +215,7 @@ namespace suea2df {
 #define	F1	1.125
 #define	F2	-0.04166667
 
-segy tr, trv, trh;
+CSEIS_SU_THREAD_LOCAL segy tr, trv, trh;
 
 /* prototypes for functions defined and used below */
 int get_source(float dt, float ts, float favg, char *wtype, float *source);
@@ -230,6 +232,20 @@ void update_stress_ani(int ifx, int ilx, int jfz, int jlz,
 	float **u, float **w, float **txx, float **tzz, float **txz,
 	float **c11, float **c55, float **c33, float **c13, 
 	float **c15, float **c35, float dtx, float dtz);
+
+/* arguments of velocity and stress updates, passed on through the stencil engine */
+typedef struct UpdateArgsStruct {
+	int ifx,ilx;		/* x range of active grid	*/
+	int tsw;		/* switch for shear stress updating */
+	int aniso;		/* switch to include anisotropy */
+	float **u,**w,**txx,**tzz,**txz;
+	float **rho,**c11,**c55,**c33,**c13,**c15,**c35,**q;
+	float dtx,dtz;
+} UpdateArgs;
+static void update_vel_rows(int jf, int jl, void *data);
+static void update_stress_rows(int jf, int jl, void *data);
+static void attenuate_rows(int jf, int jl, void *data);
+
 void add_p_source(float **txx, float** tzz, float amp, int i, int j);
 
 void add_v_source(float **u, float **w, float amp, int i, int j);
@@ -398,6 +414,9 @@ void* main_suea2df( void* args )
 	int *limits=NULL;	/* calculation area in grid	*/
 
 	int verbose;		/* is verbose? 			*/
+	int nthreads;		/* number of threads for updates */
+	cseis_su::csSUStencilEngine *engine=NULL; /* applies updates to grid rows */
+	UpdateArgs uargs;	/* arguments of updates		*/
 
 	int vs2;		/* depth in samples of horiz rec line */
 	int hs1;		/* horiz sample of vert rec line */
@@ -513,6 +532,8 @@ void* main_suea2df( void* args )
 	if (!parObj.getparint("aniso",&aniso)) aniso = 0;
 	if (!parObj.getparint("tsw",&tsw)) tsw = 0;
 	if (!parObj.getparint("verbose",&verbose)) verbose = 0;
+	if (!parObj.getparint("nthreads",&nthreads)) nthreads = 1;
+	if (nthreads<1) throw cseis_geolib::csException("nthreads=%d must be >= 1\n",nthreads);
 	if (!parObj.getparint("mode",&mode)) mode = 0;
 
 	/***...begin......... shapshot and source files....... */
@@ -1086,6 +1107,26 @@ void* main_suea2df( void* args )
 			bc,qsw,aniso,vsx,vchdfp,2,mfile);
 	fclose(vchdfp);
 
+	/* start threads for velocity and stress updates */
+	engine = new cseis_su::csSUStencilEngine(nthreads);
+	uargs.tsw = tsw;
+	uargs.aniso = aniso;
+	uargs.u = u;
+	uargs.w = w;
+	uargs.txx = txx;
+	uargs.tzz = tzz;
+	uargs.txz = txz;
+	uargs.rho = rho;
+	uargs.c11 = c11;
+	uargs.c55 = c55;
+	uargs.c33 = c33;
+	uargs.c13 = c13;
+	uargs.c15 = c15;
+	uargs.c35 = c35;
+	uargs.q = q;
+	uargs.dtx = dtx;
+	uargs.dtz = dtz;
+
 	/* begin wave propagation */
 	k=0;
 	for (t=ft; t<=lt; t=t+dt) {
@@ -1111,13 +1152,10 @@ void* main_suea2df( void* args )
 				add_v_source(u,w,dt*source[k],is,js);
 		}
 
-		/* update velocities */
-		if(tsw==0)
-			update_vel(ifx,ilx,jfz,jlz,u,w,txx,tzz,txz,
-					rho,c55,dtx,dtz);
-		if(tsw==1)
-			update_vel_tsw(ifx,ilx,jfz,jlz,u,w,txx,tzz,
-					txz,rho,c55,dtx,dtz);
+		/* update velocities, rows jfz,...,jlz in parallel */
+		uargs.ifx = ifx;
+		uargs.ilx = ilx;
+		engine->run(update_vel_rows,&uargs,jfz,jlz);
 	
 		/* introduce plane wave velocity source */
 		if (strcmp(stype,"pw")==0){
@@ -1144,15 +1182,8 @@ void* main_suea2df( void* args )
 				add_p_source(txx,tzz,dt*source[k],is,js);
 		}
 	
-		/* update stresses */
-		if(!aniso) {  /* isotropic */
-			update_stress_iso(ifx,ilx,jfz,jlz,u,w,txx,tzz,txz,
-						c11,c55,dtx,dtz);
-		} else {
-			update_stress_ani(ifx,ilx,jfz,jlz,u,w,txx,tzz,txz,
-						c11,c55,c33,c13,c15,c35,
-						dtx,dtz);
-		}
+		/* update stresses, rows jfz,...,jlz in parallel */
+		engine->run(update_stress_rows,&uargs,jfz,jlz);
 
 		/* introduce plane wave stress source */
 		if (strcmp(stype,"pw")==0) {
@@ -1189,22 +1220,16 @@ void* main_suea2df( void* args )
 
 		/* attenuation */
 		if(qsw==1) {
-			for (j=jfz-2; j<jlz+2; j++){
-				for (i=ifx-2; i<ilx+2; i++) {
-			 		u[j][i]*=q[j][i];
-					w[j][i]*=q[j][i];
-			 		txx[j][i]*=q[j][i];
-					tzz[j][i]*=q[j][i];
-					txz[j][i]*=q[j][i];
-				}
-			}	
+			engine->run(attenuate_rows,&uargs,jfz-2,jlz+1);
 		}
 	
-		/* "energy" */
+		/* "energy", only needed for progress output */
 		energy=0;
-		for (i=ifx; i<ilx; i++){
-			for (j=jfz; j<jlz; j++) {
-				energy=energy+u[j][i]*u[j][i]+w[j][i]*w[j][i]; 
+		if((verbose==1) && (k%50==0)) {
+			for (i=ifx; i<ilx; i++){
+				for (j=jfz; j<jlz; j++) {
+					energy=energy+u[j][i]*u[j][i]+w[j][i]*w[j][i]; 
+				}
 			}
 		}
 	
@@ -1249,6 +1274,8 @@ void* main_suea2df( void* args )
 	}
 
 	warn("propagation completed\n");
+	delete engine;
+	engine = NULL;
 
 	/* free space */
 	free2float(u);
@@ -1301,6 +1328,7 @@ void* main_suea2df( void* args )
 	return retPtr;
 }
 catch( cseis_geolib::csException& exc ) {
+  if( engine != NULL ) delete engine;
   su2cs->setError("%s",exc.getMessage());
   pthread_exit(NULL);
   return retPtr;
@@ -1338,6 +1366,51 @@ int get_source(float dt, float ts, float favg, char *wtype, float *source)
 	return(i);
 }
 
+/* update velocities in rows jf,...,jl */
+static void update_vel_rows(int jf, int jl, void *data)
+{
+	UpdateArgs *a = (UpdateArgs*)data;
+
+	if(a->tsw==0)
+		update_vel(a->ifx,a->ilx,jf,jl,a->u,a->w,a->txx,a->tzz,a->txz,
+				a->rho,a->c55,a->dtx,a->dtz);
+	if(a->tsw==1)
+		update_vel_tsw(a->ifx,a->ilx,jf,jl,a->u,a->w,a->txx,a->tzz,
+				a->txz,a->rho,a->c55,a->dtx,a->dtz);
+}
+
+/* update stresses in rows jf,...,jl */
+static void update_stress_rows(int jf, int jl, void *data)
+{
+	UpdateArgs *a = (UpdateArgs*)data;
+
+	if(!a->aniso) {  /* isotropic */
+		update_stress_iso(a->ifx,a->ilx,jf,jl,a->u,a->w,a->txx,a->tzz,
+				a->txz,a->c11,a->c55,a->dtx,a->dtz);
+	} else {
+		update_stress_ani(a->ifx,a->ilx,jf,jl,a->u,a->w,a->txx,a->tzz,
+				a->txz,a->c11,a->c55,a->c33,a->c13,a->c15,
+				a->c35,a->dtx,a->dtz);
+	}
+}
+
+/* apply attenuation to rows jf,...,jl */
+static void attenuate_rows(int jf, int jl, void *data)
+{
+	UpdateArgs *a = (UpdateArgs*)data;
+	int i,j;
+
+	for (j=jf; j<=jl; j++){
+		for (i=a->ifx-2; i<a->ilx+2; i++) {
+	 		a->u[j][i]*=a->q[j][i];
+			a->w[j][i]*=a->q[j][i];
+	 		a->txx[j][i]*=a->q[j][i];
+			a->tzz[j][i]*=a->q[j][i];
+			a->txz[j][i]*=a->q[j][i];
+		}
+	}
+}
+
 void update_vel(int ifx, int ilx, int jfz, int jlz,
 	float **u, float **w, float **txx, float **tzz, float **txz,
 	float **rho, float **c55, float dtx, float dtz)
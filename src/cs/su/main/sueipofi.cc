@@ -102,7 +102,7 @@ void fputdata(FILE *fileptr, FILE *headerptr, float outdata[], int nt);
 void fputdata3c(FILE *fileptr, FILE *headerptr, float **outdata3c, int nt);
 
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sueipofi( void* args )
 {
@@ -50,8 +50,8 @@ namespace sufbpickw {
 
    
 /* segy data  */
-segy *trp;				/* SEGY trace array */
-segy trtp;				/* SEGY trace */
+CSEIS_SU_THREAD_LOCAL segy *trp;				/* SEGY trace array */
+CSEIS_SU_THREAD_LOCAL segy trtp;				/* SEGY trace */
 void* main_sufbpickw( void* args )
 {
 	
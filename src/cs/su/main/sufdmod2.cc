@@ -11,6 +11,7 @@
 #include "csSUGetPars.h"
 #include "su_complex_declarations.h"
 #include "cseis_sulib.h"
+#include "csSUStencilEngine.h"
 #include <string>
 
 extern "C" {
@@ -64,6 +65,7 @@ std::string sdoc_sufdmod2 =
 " hsfile=		output file for horizontal line of seismograms[nx][nt]"
 " ssfile=		output file for source point seismograms[nt]	"
 " verbose=0		=1 for diagnostic messages, =2 for more		"
+" nthreads=1		number of threads for finite-difference star	"
 " abs=1,1,1,1		absorbing boundary conditions on top,left,bottom,right"
 "			sides of the model. 				"
 " 			=0,1,1,1 for free surface condition on the top	"
@@ -112,15 +114,16 @@ void exsrc (int ns, float *xs, float *zs,
 	int nx, float dx, float fx,
 	int nz, float dz, float fz,
 	float dt, float t, float fmax, int pwt, int mono, float **s);
-void tstep2 (int nx, float dx, int nz, float dz, float dt,
+void tstep2 (cseis_su::csSUStencilEngine *engine,
+	int nx, float dx, int nz, float dz, float dt,
 	float **dvv, float **od, float **s,
 	float **pm, float **p, float **pp, int *abs);
 static float ricker (float t, float fpeak, int mono);
 
-segy cubetr; 	/* data cube traces */
-segy srctr;	/* source seismogram traces */
-segy horiztr;	/* horizontal line seismogram traces */
-segy verttr;	/* vertical line seismogram traces */
+CSEIS_SU_THREAD_LOCAL segy cubetr; 	/* data cube traces */
+CSEIS_SU_THREAD_LOCAL segy srctr;	/* source seismogram traces */
+CSEIS_SU_THREAD_LOCAL segy horiztr;	/* horizontal line seismogram traces */
+CSEIS_SU_THREAD_LOCAL segy verttr;	/* vertical line seismogram traces */
 
 void* main_sufdmod2( void* args )
 {
@@ -128,6 +131,8 @@ void* main_sufdmod2( void* args )
 	int nx,nz,nt,mt;	/* x,z,t,tsizes */
 
 	int verbose;		/* is verbose? */
+	int nthreads;		/* number of threads for finite-difference star */
+	cseis_su::csSUStencilEngine *engine=NULL; /* applies star to grid rows */
 	int nxs;		/* number of source x coordinates */
 	int nzs;		/* number of source y coordinates */
 	int ns;			/* total number of sources ns=nxs=nxz */
@@ -330,21 +335,24 @@ void* main_sufdmod2( void* args )
 	vs2 = NINT((vsx - fx)/dx );
 	
 	if (!parObj.getparint("verbose",&verbose)) verbose = 0;
+	if (!parObj.getparint("nthreads",&nthreads)) nthreads = 1;
+	if (nthreads<1) throw cseis_geolib::csException("nthreads=%d must be >= 1\n",nthreads);
 	parObj.getparstring("dfile",&dfile);
 	parObj.getparstring("hsfile",&hsfile);
 	parObj.getparstring("vsfile",&vsfile);
 	parObj.getparstring("ssfile",&ssfile);
 	
 	/* allocate space */
-	s = alloc2float(nz,nx);
-	dvv = alloc2float(nz,nx);
-	od = alloc2float(nz,nx);
-	pm = alloc2float(nz,nx);
-	p = alloc2float(nz,nx);
-	pp = alloc2float(nz,nx);
+	s = cseis_su::csSUStencilEngine::allocGrid(nz,nx);
+	dvv = cseis_su::csSUStencilEngine::allocGrid(nz,nx);
+	od = cseis_su::csSUStencilEngine::allocGrid(nz,nx);
+	pm = cseis_su::csSUStencilEngine::allocGrid(nz,nx);
+	p = cseis_su::csSUStencilEngine::allocGrid(nz,nx);
+	pp = cseis_su::csSUStencilEngine::allocGrid(nz,nx);
 	
-	/* read velocities */
-	fread(dvv[0],sizeof(float),nx*nz,velocityfp);
+	/* read velocities, row by row (grid rows are padded) */
+	for (ix=0; ix<nx; ++ix)
+		fread(dvv[ix],sizeof(float),nz,velocityfp);
 	
 	/* determine minimum and maximum velocities */
 	vmin = vmax = dvv[0][0];
@@ -403,8 +411,9 @@ void* main_sufdmod2( void* args )
 	if (*dfile!='\0') {
 		if((densityfp=fopen(dfile,"r"))==NULL)
 			throw cseis_geolib::csException("cannot open dfile=%s\n",dfile);
-		if (fread(od[0],sizeof(float),nx*nz,densityfp)!=nx*nz)
-			throw cseis_geolib::csException("error reading dfile=%s\n",dfile);
+		for (ix=0; ix<nx; ++ix)
+			if (fread(od[ix],sizeof(float),nz,densityfp)!=nz)
+				throw cseis_geolib::csException("error reading dfile=%s\n",dfile);
 		fclose(densityfp);
 		dmin = dmax = od[0][0];
 		for (ix=0; ix<nx; ++ix) {
@@ -434,7 +443,7 @@ void* main_sufdmod2( void* args )
 	
 	/* if densities constant, free space and set NULL pointer */
 	if (dmin==dmax) {
-		free2float(od);
+		cseis_su::csSUStencilEngine::freeGrid(od);
 		od = NULL;
 	}
 	
@@ -452,6 +461,7 @@ void* main_sufdmod2( void* args )
 		fprintf(stderr,"vmin = %g\n",vmin);
 		fprintf(stderr,"vmax = %g\n",vmax);
 		fprintf(stderr,"mt = %d\n",mt);
+		fprintf(stderr,"nthreads = %d\n",nthreads);
 		if (dmin==dmax) {
 			fprintf(stderr,"constant density\n");
 		} else {
@@ -472,6 +482,9 @@ void* main_sufdmod2( void* args )
 	}
 	
 
+	/* start threads for finite-difference star */
+	engine = new cseis_su::csSUStencilEngine(nthreads);
+
 	/* loop over time steps */
 	for (it=0,t=0.0; it<nt; ++it,t+=dt) {
 	
@@ -486,7 +499,7 @@ void* main_sufdmod2( void* args )
 			exsrc(ns,xs,zs,nx,dx,fx,nz,dz,fz,dt,t,fmax,pwt,mono,s);
 		
 		/* do one time step */
-		tstep2(nx,dx,nz,dz,dt,dvv,od,s,pm,p,pp,abs);
+		tstep2(engine,nx,dx,nz,dz,dt,dvv,od,s,pm,p,pp,abs);
 		
 		/* write waves */
 	/* if (it%mt==0) fwrite(pp[0],sizeof(float),nx*nz,stdout); */
@@ -646,22 +659,26 @@ void* main_sufdmod2( void* args )
 
 	
 	/* free space before returning */
-	free2float(s);
-	free2float(dvv);
-	free2float(pm);
-	free2float(p);
-	free2float(pp);
+	cseis_su::csSUStencilEngine::freeGrid(s);
+	cseis_su::csSUStencilEngine::freeGrid(dvv);
+	cseis_su::csSUStencilEngine::freeGrid(pm);
+	cseis_su::csSUStencilEngine::freeGrid(p);
+	cseis_su::csSUStencilEngine::freeGrid(pp);
 	
-	if (od!=NULL) free2float(od);
+	if (od!=NULL) cseis_su::csSUStencilEngine::freeGrid(od);
 	if (hs!=NULL) free2float(hs);
 	if (vs!=NULL) free2float(vs);
 	if (ss!=NULL) free2float(ss);
 	
+	delete engine;
+	engine = NULL;
+
 	su2cs->setEOF();
 	pthread_exit(NULL);
 	return retPtr;
 }
 catch( cseis_geolib::csException& exc ) {
+  if( engine != NULL ) delete engine;
   su2cs->setError("%s",exc.getMessage());
   pthread_exit(NULL);
   return retPtr;
@@ -701,8 +718,8 @@ Author:  Dave Hale, Colorado School of Mines, 03/01/90
 	int ix,iz,ixv,izv,is;
 	float ts,xn,zn,v,xv,zv,dxdv,dzdv,xvn,zvn;
 	float amp,dv,dist,distprev;
-	static float *vs,(*xsd)[4],(*zsd)[4];
-	static int made=0;
+	CSEIS_SU_THREAD_LOCAL float *vs,(*xsd)[4],(*zsd)[4];
+	CSEIS_SU_THREAD_LOCAL int made=0;
 	float a, pio2, opwt;
 	float fpeak, tdelay;
 	
@@ -874,29 +891,40 @@ Author:  Dave Hale, Colorado School of Mines, 04/29/90
 /* 2D finite differencing subroutine */
 
 /* functions declared and used internally */
-static void star1 (int nx, float dx, int nz, float dz, float dt,
+static void star1 (int ixf, int ixl, float dx, int nz, float dz, float dt,
 	float **dvv, float **od, float **s,
 	float **pm, float **p, float **pp);
-static void star2 (int nx, float dx, int nz, float dz, float dt,
+static void star2 (int ixf, int ixl, float dx, int nz, float dz, float dt,
 	float **dvv, float **od, float **s,
 	float **pm, float **p, float **pp);
-static void star3 (int nx, float dx, int nz, float dz, float dt,
+static void star3 (int ixf, int ixl, float dx, int nz, float dz, float dt,
 	float **dvv, float **od, float **s,
 	float **pm, float **p, float **pp);
-static void star4 (int nx, float dx, int nz, float dz, float dt,
+static void star4 (int ixf, int ixl, float dx, int nz, float dz, float dt,
 	float **dvv, float **od, float **s,
 	float **pm, float **p, float **pp);
+static void star_rows (int ixf, int ixl, void *data);
 static void absorb (int nx, float dx, int nz, float dz, float dt,
 	float **dvv, float **od, float **pm, float **p, float **pp,
 	int *abs);
 
-void tstep2 (int nx, float dx, int nz, float dz, float dt,
+/* arguments of finite-difference star, passed on through the stencil engine */
+typedef struct StarArgsStruct {
+	int star;		/* =1,...,4 for star1,...,star4 */
+	int nz;
+	float dx,dz,dt;
+	float **dvv,**od,**s,**pm,**p,**pp;
+} StarArgs;
+
+void tstep2 (cseis_su::csSUStencilEngine *engine,
+	int nx, float dx, int nz, float dz, float dt,
 	float **dvv, float **od, float **s,
 	float **pm, float **p, float **pp, int *abs)
 /*****************************************************************************
 One time step of FD solution (2nd order in space) to acoustic wave equation
 ******************************************************************************
 Input:
+engine		stencil engine, applies finite-difference star to rows of grid
 nx		number of x samples
 dx		x sampling interval
 nz		number of z samples
@@ -915,31 +943,63 @@ Notes:
 This function is optimized for special cases of constant density=1 and/or
 equal spatial sampling intervals dx=dz.  The slowest case is variable
 density and dx!=dz.  The fastest case is density=1.0 (od==NULL) and dx==dz.
+The finite-difference star is applied to tiles of x rows, in parallel if the
+engine runs several threads.  Boundaries are done after all rows are done.
 ******************************************************************************
 Author:  Dave Hale, Colorado School of Mines, 03/13/90
 ******************************************************************************/
 {
+	StarArgs args;
+
 	/* convolve with finite-difference star (special cases for speed) */
 	if (od!=NULL && dx!=dz) {
-		star1(nx,dx,nz,dz,dt,dvv,od,s,pm,p,pp);
+		args.star = 1;
 	} else if (od!=NULL && dx==dz) {
-		star2(nx,dx,nz,dz,dt,dvv,od,s,pm,p,pp);
+		args.star = 2;
 	} else if (od==NULL && dx!=dz) {
-		star3(nx,dx,nz,dz,dt,dvv,od,s,pm,p,pp);
+		args.star = 3;
 	} else {
-		star4(nx,dx,nz,dz,dt,dvv,od,s,pm,p,pp);
+		args.star = 4;
 	}
+	args.nz = nz;
+	args.dx = dx;
+	args.dz = dz;
+	args.dt = dt;
+	args.dvv = dvv;
+	args.od = od;
+	args.s = s;
+	args.pm = pm;
+	args.p = p;
+	args.pp = pp;
+	engine->run(star_rows,&args,1,nx-2);
 	
 	/* absorb along boundaries */
 	absorb(nx,dx,nz,dz,dt,dvv,od,pm,p,pp,abs);
 }
 
+/* apply finite-difference star to x rows ixf,...,ixl */
+static void star_rows (int ixf, int ixl, void *data)
+{
+	StarArgs *a = (StarArgs*)data;
+
+	if (a->star==1) {
+		star1(ixf,ixl,a->dx,a->nz,a->dz,a->dt,a->dvv,a->od,a->s,a->pm,a->p,a->pp);
+	} else if (a->star==2) {
+		star2(ixf,ixl,a->dx,a->nz,a->dz,a->dt,a->dvv,a->od,a->s,a->pm,a->p,a->pp);
+	} else if (a->star==3) {
+		star3(ixf,ixl,a->dx,a->nz,a->dz,a->dt,a->dvv,a->od,a->s,a->pm,a->p,a->pp);
+	} else {
+		star4(ixf,ixl,a->dx,a->nz,a->dz,a->dt,a->dvv,a->od,a->s,a->pm,a->p,a->pp);
+	}
+}
+
 /* convolve with finite-difference star for variable density and dx!=dz */
-static void star1 (int nx, float dx, int nz, float dz, float dt,
+static void star1 (int ixf, int ixl, float dx, int nz, float dz, float dt,
 	float **dvv, float **od, float **s,
 	float **pm, float **p, float **pp)
 {
 	int ix,iz;
+	float *ppx,*px,*pxm,*pxp,*pmx,*dvvx,*odx,*odxm,*odxp,*sx;
 	float xscale1,zscale1,xscale2,zscale2;
 		
 	/* determine constants */
@@ -949,48 +1009,61 @@ static void star1 (int nx, float dx, int nz, float dz, float dt,
 	zscale2 = 0.25*zscale1;
 	
 	/* do the finite-difference star */
-	for (ix=1; ix<nx-1; ++ix) {
+	for (ix=ixf; ix<=ixl; ++ix) {
+
+		/* rows of grids: contiguous inner loop over z */
+		ppx = pp[ix];
+		px = p[ix];
+		pxm = p[ix-1];
+		pxp = p[ix+1];
+		pmx = pm[ix];
+		dvvx = dvv[ix];
+		odx = od[ix];
+		odxm = od[ix-1];
+		odxp = od[ix+1];
+		sx = s[ix];
 		for (iz=1; iz<nz-1; ++iz) {
-			pp[ix][iz] = 2.0*p[ix][iz]-pm[ix][iz] +
-				dvv[ix][iz]*(
-					od[ix][iz]*(
+			ppx[iz] = 2.0*px[iz]-pmx[iz] +
+				dvvx[iz]*(
+					odx[iz]*(
 						xscale1*(
-							p[ix+1][iz]+
-							p[ix-1][iz]-
-							2.0*p[ix][iz]
+							pxp[iz]+
+							pxm[iz]-
+							2.0*px[iz]
 						) +
 						zscale1*(
-							p[ix][iz+1]+
-							p[ix][iz-1]-
-							2.0*p[ix][iz]
+							px[iz+1]+
+							px[iz-1]-
+							2.0*px[iz]
 						)
 					) +
 					(
 						xscale2*(
-							(od[ix+1][iz]-
-							od[ix-1][iz]) *
-							(p[ix+1][iz]-
-							p[ix-1][iz])
+							(odxp[iz]-
+							odxm[iz]) *
+							(pxp[iz]-
+							pxm[iz])
 						) +
 						zscale2*(
-							(od[ix][iz+1]-
-							od[ix][iz-1])*
-							(p[ix][iz+1]-
-							p[ix][iz-1])
+							(odx[iz+1]-
+							odx[iz-1])*
+							(px[iz+1]-
+							px[iz-1])
 						)
 					)
 				) +
-				s[ix][iz];
+				sx[iz];
 		}
 	}
 }
 
 /* convolve with finite-difference star for variable density and dx==dz */
-static void star2 (int nx, float dx, int nz, float dz, float dt,
+static void star2 (int ixf, int ixl, float dx, int nz, float dz, float dt,
 	float **dvv, float **od, float **s,
 	float **pm, float **p, float **pp)
 {
 	int ix,iz;
+	float *ppx,*px,*pxm,*pxp,*pmx,*dvvx,*odx,*odxm,*odxp,*sx;
 	float scale1,scale2;
 	
 	if ( dx != dz ) 
@@ -1000,43 +1073,56 @@ static void star2 (int nx, float dx, int nz, float dz, float dt,
 	scale2 = 0.25*scale1;
 	
 	/* do the finite-difference star */
-	for (ix=1; ix<nx-1; ++ix) {
+	for (ix=ixf; ix<=ixl; ++ix) {
+
+		/* rows of grids: contiguous inner loop over z */
+		ppx = pp[ix];
+		px = p[ix];
+		pxm = p[ix-1];
+		pxp = p[ix+1];
+		pmx = pm[ix];
+		dvvx = dvv[ix];
+		odx = od[ix];
+		odxm = od[ix-1];
+		odxp = od[ix+1];
+		sx = s[ix];
 		for (iz=1; iz<nz-1; ++iz) {
-			pp[ix][iz] = 2.0*p[ix][iz]-pm[ix][iz] +
-				dvv[ix][iz]*(
-					od[ix][iz]*(
+			ppx[iz] = 2.0*px[iz]-pmx[iz] +
+				dvvx[iz]*(
+					odx[iz]*(
 						scale1*(
-							p[ix+1][iz]+
-							p[ix-1][iz]+
-							p[ix][iz+1]+
-							p[ix][iz-1]-
-							4.0*p[ix][iz]
+							pxp[iz]+
+							pxm[iz]+
+							px[iz+1]+
+							px[iz-1]-
+							4.0*px[iz]
 						)
 					) +
 					(
 						scale2*(
-							(od[ix+1][iz]-
-							od[ix-1][iz]) *
-							(p[ix+1][iz]-
-							p[ix-1][iz]) +
-							(od[ix][iz+1]-
-							od[ix][iz-1]) *
-							(p[ix][iz+1]-
-							p[ix][iz-1])
+							(odxp[iz]-
+							odxm[iz]) *
+							(pxp[iz]-
+							pxm[iz]) +
+							(odx[iz+1]-
+							odx[iz-1]) *
+							(px[iz+1]-
+							px[iz-1])
 						)
 					)
 				) +
-				s[ix][iz];
+				sx[iz];
 		}
 	}
 }
 
 /* convolve with finite-difference star for density==1.0 and dx!=dz */
-static void star3 (int nx, float dx, int nz, float dz, float dt,
+static void star3 (int ixf, int ixl, float dx, int nz, float dz, float dt,
 	float **dvv, float **od, float **s,
 	float **pm, float **p, float **pp)
 {
 	int ix,iz;
+	float *ppx,*px,*pxm,*pxp,*pmx,*dvvx,*sx;
 	float xscale,zscale;
 		
 	if ( od != ((float **) NULL) ) 
@@ -1046,32 +1132,42 @@ static void star3 (int nx, float dx, int nz, float dz, float dt,
 	zscale = (dt*dt)/(dz*dz);
 	
 	/* do the finite-difference star */
-	for (ix=1; ix<nx-1; ++ix) {
+	for (ix=ixf; ix<=ixl; ++ix) {
+
+		/* rows of grids: contiguous inner loop over z */
+		ppx = pp[ix];
+		px = p[ix];
+		pxm = p[ix-1];
+		pxp = p[ix+1];
+		pmx = pm[ix];
+		dvvx = dvv[ix];
+		sx = s[ix];
 		for (iz=1; iz<nz-1; ++iz) {
-			pp[ix][iz] = 2.0*p[ix][iz]-pm[ix][iz] +
-				dvv[ix][iz]*(
+			ppx[iz] = 2.0*px[iz]-pmx[iz] +
+				dvvx[iz]*(
 					xscale*(
-						p[ix+1][iz]+
-						p[ix-1][iz]-
-						2.0*p[ix][iz]
+						pxp[iz]+
+						pxm[iz]-
+						2.0*px[iz]
 					) +
 					zscale*(
-						p[ix][iz+1]+
-						p[ix][iz-1]-
-						2.0*p[ix][iz]
+						px[iz+1]+
+						px[iz-1]-
+						2.0*px[iz]
 					)
 				) +
-				s[ix][iz];
+				sx[iz];
 		}
 	}
 }
 
 /* convolve with finite-difference star for density==1.0 and dx==dz */
-static void star4 (int nx, float dx, int nz, float dz, float dt,
+static void star4 (int ixf, int ixl, float dx, int nz, float dz, float dt,
 	float **dvv, float **od, float **s,
 	float **pm, float **p, float **pp)
 {
 	int ix,iz;
+	float *ppx,*px,*pxm,*pxp,*pmx,*dvvx,*sx;
 	float scale;
 	
 	/* determine constants */
@@ -1082,17 +1178,26 @@ static void star4 (int nx, float dx, int nz, float dz, float dt,
 	scale = (dt*dt)/(dx*dz);
 	
 	/* do the finite-difference star */
-	for (ix=1; ix<nx-1; ++ix) {
+	for (ix=ixf; ix<=ixl; ++ix) {
+
+		/* rows of grids: contiguous inner loop over z */
+		ppx = pp[ix];
+		px = p[ix];
+		pxm = p[ix-1];
+		pxp = p[ix+1];
+		pmx = pm[ix];
+		dvvx = dvv[ix];
+		sx = s[ix];
 		for (iz=1; iz<nz-1; ++iz) {
-			pp[ix][iz] = 2.0*p[ix][iz]-pm[ix][iz] +
-				scale*dvv[ix][iz]*(
-					p[ix+1][iz]+
-					p[ix-1][iz]+
-					p[ix][iz+1]+
-					p[ix][iz-1]-
-					4.0*p[ix][iz]
+			ppx[iz] = 2.0*px[iz]-pmx[iz] +
+				scale*dvvx[iz]*(
+					pxp[iz]+
+					pxm[iz]+
+					px[iz+1]+
+					px[iz-1]-
+					4.0*px[iz]
 				) +
-				s[ix][iz];
+				sx[iz];
 		}
 	}
 }
@@ -80,7 +80,7 @@ namespace sufft {
 #define LOOKFAC	2	/* Look ahead factor for npfaro	  */
 #define PFA_MAX	720720	/* Largest allowed nfft	          */
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sufft( void* args )
 {
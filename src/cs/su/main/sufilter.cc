@@ -75,7 +75,7 @@ void polygonalFilter(float *f, float *amps,
 #define PFA_MAX 720720  /* Largest allowed nfft           */
 
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sufilter( void* args )
 {
@@ -83,12 +83,12 @@ void flipper(register float **indata, register float **flipdata,
 static void closefiles(void);
 
 /* Globals (so can trap signal) defining temporary disk files */
-char tracefile[BUFSIZ];	/* filename for the file of traces	*/
-char headerfile[BUFSIZ];/* filename for the file of headers	*/
-FILE *tracefp;		/* fp for trace storage file		*/
-FILE *headerfp;		/* fp for header storage file		*/
+CSEIS_SU_THREAD_LOCAL char tracefile[BUFSIZ];	/* filename for the file of traces	*/
+CSEIS_SU_THREAD_LOCAL char headerfile[BUFSIZ];/* filename for the file of headers	*/
+CSEIS_SU_THREAD_LOCAL FILE *tracefp;		/* fp for trace storage file		*/
+CSEIS_SU_THREAD_LOCAL FILE *headerfp;		/* fp for header storage file		*/
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suflip( void* args )
 {
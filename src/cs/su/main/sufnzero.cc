@@ -52,7 +52,7 @@ namespace sufnzero {
  */
 /**************** end self doc ***********************************/
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sufnzero( void* args )
 {
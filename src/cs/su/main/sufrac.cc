@@ -76,7 +76,7 @@ namespace sufrac {
 #define LOOKFAC		2	/* Look ahead factor for npfao	  */
 #define PFA_MAX		720720	/* Largest allowed nfft	          */
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sufrac( void* args )
 {
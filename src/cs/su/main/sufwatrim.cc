@@ -57,12 +57,12 @@ namespace sufwatrim {
 #define AMPSP(c) rcabs(c)
 #define PHSSP(c) atan2(c.i,c.r)
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 float n_distance(segy **rec_o,int *index,cwp_String *type,float *dx,unsigned int nd,unsigned int imx,unsigned int itr);
 float alpha_trim(float *a,int n,float p);
 float alpha_trim_w(float *a,float *w,int n,float p);
 
-int verbose;
+CSEIS_SU_THREAD_LOCAL int verbose;
 
 void* main_sufwatrim( void* args )
 {
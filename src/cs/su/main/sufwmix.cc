@@ -59,14 +59,14 @@ namespace sufwmix {
 #define AMPSP(c) rcabs(c)
 #define PHSSP(c) atan2(c.i,c.r)
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 /* function prototype of subroutine used internally */
 float n_distance(segy **rec_o,int *index, cwp_String *type,
 			float *dx,unsigned int nd,
 			unsigned int imx,unsigned int itr);
 
-int verbose;
+CSEIS_SU_THREAD_LOCAL int verbose;
 
 void* main_sufwmix( void* args )
 {
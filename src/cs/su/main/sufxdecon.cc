@@ -104,13 +104,13 @@ void cconv (int lx, int ifx, complex *x,
 static void closefiles(void);
 
 /* Globals (so can trap signal) defining temporary disk files */
-char tracefile[BUFSIZ];	/* filename for the file of traces	*/
-char headerfile[BUFSIZ];/* filename for the file of headers	*/
-FILE *tracefp;		/* fp for trace storage file		*/
-FILE *headerfp;		/* fp for header storage file		*/
+CSEIS_SU_THREAD_LOCAL char tracefile[BUFSIZ];	/* filename for the file of traces	*/
+CSEIS_SU_THREAD_LOCAL char headerfile[BUFSIZ];/* filename for the file of headers	*/
+CSEIS_SU_THREAD_LOCAL FILE *tracefp;		/* fp for trace storage file		*/
+CSEIS_SU_THREAD_LOCAL FILE *headerfp;		/* fp for header storage file		*/
 
 /* segy trace */
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sufxdecon( void* args )
 {
@@ -142,7 +142,7 @@ static void gaussianFilter(float fcent, float dt,
 #define PFA_MAX 720720  /* Largest allowed nfft	   */
 
 /* global SEGY declaration */
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sugabor( void* args )
 {
@@ -140,12 +140,12 @@ static void closefiles(void);
 #define VRED     0.0
 
 /* Globals (so can trap signal) defining temporary disk files */
-char tracefile[BUFSIZ];	/* filename for the file of traces	*/
-char headerfile[BUFSIZ];/* filename for the file of headers	*/
-FILE *tracefp;		/* fp for trace storage file		*/
-FILE *headerfp;		/* fp for header storage file		*/
+CSEIS_SU_THREAD_LOCAL char tracefile[BUFSIZ];	/* filename for the file of traces	*/
+CSEIS_SU_THREAD_LOCAL char headerfile[BUFSIZ];/* filename for the file of headers	*/
+CSEIS_SU_THREAD_LOCAL FILE *tracefp;		/* fp for trace storage file		*/
+CSEIS_SU_THREAD_LOCAL FILE *headerfp;		/* fp for header storage file		*/
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sugain( void* args )
 {
@@ -364,8 +364,8 @@ void do_tpow(
 	int nt		  /* number of samples	    */
 )
 {
-	static cwp_Bool first = cwp_true;   /* first entry flag     */
-	static float *tpowfac;	  /* tpow values	  */
+	CSEIS_SU_THREAD_LOCAL cwp_Bool first = cwp_true;   /* first entry flag     */
+	CSEIS_SU_THREAD_LOCAL float *tpowfac;	  /* tpow values	  */
 	register int i;		 /* counter		*/
 	register float tred;	/* reduced time in seconds	*/
 
@@ -403,8 +403,8 @@ void do_epow(
 )
 {
 	register int i;		 /* counter		*/
-	static cwp_Bool first = cwp_true;   /* first entry flag     */
-	static float *epowfac;	  /* exponent stretchs    */
+	CSEIS_SU_THREAD_LOCAL cwp_Bool first = cwp_true;   /* first entry flag     */
+	CSEIS_SU_THREAD_LOCAL float *epowfac;	  /* exponent stretchs    */
 
 	if (first) {
 		epowfac = ealloc1float(nt);
@@ -500,9 +500,9 @@ void do_qclip(
 )
 {
 	register int i;
-	static cwp_Bool first = cwp_true;   /* first entry flag	     */
-	static float *absdata;	  /* absolute value trace	 */
-	static int iq;		  /* index of qclipth quantile    */
+	CSEIS_SU_THREAD_LOCAL cwp_Bool first = cwp_true;   /* first entry flag	     */
+	CSEIS_SU_THREAD_LOCAL float *absdata;	  /* absolute value trace	 */
+	CSEIS_SU_THREAD_LOCAL int iq;		  /* index of qclipth quantile    */
 	float clip;		     /* ... value of rank[iq]	*/
 
 	if (first) {
@@ -526,9 +526,9 @@ void do_qbal(
 )
 {
 	register int i;
-	static cwp_Bool first = cwp_true;   /* first entry flag	     */
-	static float *absdata;	  /* absolute value trace	 */
-	static int iq;		  /* index of qclipth quantile    */
+	CSEIS_SU_THREAD_LOCAL cwp_Bool first = cwp_true;   /* first entry flag	     */
+	CSEIS_SU_THREAD_LOCAL float *absdata;	  /* absolute value trace	 */
+	CSEIS_SU_THREAD_LOCAL int iq;		  /* index of qclipth quantile    */
 	float bal;			/* value used to balance trace  */
 
 	if (qclip == 1.0) { /* balance by max magnitude on trace */
@@ -564,8 +564,8 @@ void do_qbal(
 /* Automatic Gain Control--standard box */
 void do_agc(float *data, int iwagc, int nt)
 {
-	static cwp_Bool first = cwp_true;
-	static float *agcdata;
+	CSEIS_SU_THREAD_LOCAL cwp_Bool first = cwp_true;
+	CSEIS_SU_THREAD_LOCAL float *agcdata;
 	register int i;
 	register float val;
 	register float sum;
@@ -630,11 +630,11 @@ void do_agc(float *data, int iwagc, int nt)
 /* Automatic Gain Control--gaussian taper */
 void do_gagc(float *data, int iwagc, int nt)
 {
-	static cwp_Bool first=cwp_true; /* first entry flag		 */
-	static float *agcdata;  /* agc'd data			   */
-	static float *w;	/* Gaussian window weights		*/
-	static float *d2;	/* square of input data		 */
-	static float *s;	/* weighted sum of squares of the data  */
+	CSEIS_SU_THREAD_LOCAL cwp_Bool first=cwp_true; /* first entry flag		 */
+	CSEIS_SU_THREAD_LOCAL float *agcdata;  /* agc'd data			   */
+	CSEIS_SU_THREAD_LOCAL float *w;	/* Gaussian window weights		*/
+	CSEIS_SU_THREAD_LOCAL float *d2;	/* square of input data		 */
+	CSEIS_SU_THREAD_LOCAL float *s;	/* weighted sum of squares of the data  */
 	float u;		/* related to reciprocal of std dev     */
 	float usq;		/* u*u				  */
 
@@ -122,7 +122,7 @@ float gasDensity(float g, float t, float p);
 #define pi		3.14159265358979323846264
 #define Degree		0.01745329251994329576924
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sugassmann( void* args )
 {
@@ -49,7 +49,7 @@ namespace suget {
 
 int fgettrn(FILE *fp, segy *tp);
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 void* main_suget( void* args )
 {
 	FILE *fp;
@@ -65,7 +65,7 @@ namespace sugetgthr {
 
 
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sugetgthr( void* args )
 {
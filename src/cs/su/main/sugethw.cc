@@ -71,7 +71,7 @@ namespace sugethw {
 #define BINARY 1
 #define GEOM 2
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sugethw( void* args )
 {
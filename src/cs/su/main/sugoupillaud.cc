@@ -123,7 +123,7 @@ void rev(double p[], int l, double pr[] );
 void upsample(double p4[], int l, double p2[], int ll);
 
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sugoupillaud( void* args )
 {
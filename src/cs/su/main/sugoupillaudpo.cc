@@ -92,7 +92,7 @@ int imax( int c1, int c2 )
 }
 /*********************************/
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sugoupillaudpo( void* args )
 {
@@ -45,7 +45,7 @@ namespace sugprfb {
 
    
 /* Segy data constans */
-segy 	tr;				/* SEGY trace */
+CSEIS_SU_THREAD_LOCAL segy 	tr;				/* SEGY trace */
 
 void remove_fb(float *data,float *wavelet,int n,short *scaler,short *shft);
 
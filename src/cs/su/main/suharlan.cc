@@ -217,13 +217,13 @@ void golden_search(float fvalue, int *iter, float *xvalue, float *alpha);
 static void closefiles(void);
 
 /* Globals (so can trap signal) defining temporary disk files */
-char tracefile[BUFSIZ];	/* filename for the file of traces	*/
-char headerfile[BUFSIZ];/* filename for the file of headers	*/
-FILE *tracefp;		/* fp for trace storage file		*/
-FILE *headerfp;		/* fp for header storage file		*/
+CSEIS_SU_THREAD_LOCAL char tracefile[BUFSIZ];	/* filename for the file of traces	*/
+CSEIS_SU_THREAD_LOCAL char headerfile[BUFSIZ];/* filename for the file of headers	*/
+CSEIS_SU_THREAD_LOCAL FILE *tracefp;		/* fp for trace storage file		*/
+CSEIS_SU_THREAD_LOCAL FILE *headerfp;		/* fp for header storage file		*/
 
 
-segy tro1,tro2,tro3;
+CSEIS_SU_THREAD_LOCAL segy tro1,tro2,tro3;
 
 void* main_suharlan( void* args )
 {
@@ -733,7 +733,7 @@ rand_traces	2-D array[nx][nt] of tau-p transformed extracted noise traces
 	float *amps;		/* 1-d array of amplitudes in histograms */
 	float *pspn;		/* 1-d array of ps*pn */
 	char *plotname="";	/* pointer to name of output plot files */
-	static int count;
+	CSEIS_SU_THREAD_LOCAL int count;
 
 	/* if requested, print processing information */
 	if (verbose==1) {
@@ -1823,12 +1823,12 @@ Translated to C by Gabriel Alvarez (1995) from a Fortran IV  version
 ******************************************************************************/
 {
 	int j;				/* loop counter */
-	static int ifill=0;		/* auxiliary function index */
+	CSEIS_SU_THREAD_LOCAL int ifill=0;		/* auxiliary function index */
 	int im;				/* auxiliary index */
 	float fm;			/* auxiliary variable */
-	static float rmag=1.0;		/* golden ratio */
-	static float x[4];		/* array to store searching points */
-	static float f[4];		/* array to store function values */
+	CSEIS_SU_THREAD_LOCAL float rmag=1.0;		/* golden ratio */
+	CSEIS_SU_THREAD_LOCAL float x[4];		/* array to store searching points */
+	CSEIS_SU_THREAD_LOCAL float f[4];		/* array to store function values */
 
 	/* test condition for iteration index */
 	if (*iter<1) *iter=1;			/* this should never happen */
@@ -42,7 +42,7 @@ namespace suhilb {
 /**************** end self doc ***********************************/
 
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suhilb( void* args )
 {
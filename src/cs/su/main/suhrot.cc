@@ -79,7 +79,7 @@ namespace suhrot {
 #define HROT_TRADIAL TRADIAL
 #define HROT_TTRANS TTRANS
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suhrot( void* args )
 {
@@ -62,7 +62,7 @@ namespace suhtmath {
 #define	MULT	2
 #define	DIV	3
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 float getval(   cwp_String type, Value *valp)
 {
@@ -58,7 +58,7 @@ namespace suiclogfft {
 
 #define PFA_MAX	720720		/* Largest allowed fft	*/
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suiclogfft( void* args )
 {
@@ -54,7 +54,7 @@ namespace suifft {
 
 #define PFA_MAX	720720		/* Largest allowed fft	*/
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suifft( void* args )
 {
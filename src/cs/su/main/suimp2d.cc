@@ -73,7 +73,7 @@ namespace suimp2d {
 #define LOOKFAC	2	/* Look ahead factor for npfao	  */
 #define PFA_MAX	720720	/* Largest allowed nfft	          */
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suimp2d( void* args )
 {
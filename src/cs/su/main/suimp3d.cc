@@ -82,7 +82,7 @@ namespace suimp3d {
 #define PFA_MAX	720720	/* Largest allowed nfft	          */
 
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suimp3d( void* args )
 {
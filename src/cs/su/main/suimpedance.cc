@@ -49,7 +49,7 @@ namespace suimpedance {
  */
 /**************** end self doc ***********************************/
 
-static segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 /* Prototype of function used internally */
 static void rctoimp(float v0, float rho0, int nt, float *trace);
@@ -108,10 +108,10 @@ void jea_xinterpolate(VND *vndorig, VND *vndinterp, int ninterp,
 static void closefiles(void);
 
 /* Globals (so can trap signal) defining temporary disk files */
-char headerfile[BUFSIZ];/* filename for the file of headers	*/
-FILE *headerfp;		/* fp for header storage file		*/
+CSEIS_SU_THREAD_LOCAL char headerfile[BUFSIZ];/* filename for the file of headers	*/
+CSEIS_SU_THREAD_LOCAL FILE *headerfp;		/* fp for header storage file		*/
 
-segy tr;	/* Input and output trace data of length nt */
+CSEIS_SU_THREAD_LOCAL segy tr;	/* Input and output trace data of length nt */
 
 void* main_suinterp( void* args )
 {
@@ -67,7 +67,7 @@ namespace suinterpfowler {
  */
 /**************** end self doc ********************************/
 
-segy tr;	/* Input and output trace data of length nt */
+CSEIS_SU_THREAD_LOCAL segy tr;	/* Input and output trace data of length nt */
 void* main_suinterpfowler( void* args )
 {
 	int nt;
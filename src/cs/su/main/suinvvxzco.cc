@@ -94,9 +94,9 @@ namespace suinvvxzco {
 /**************** end self doc ***********************************/
  
 /*global varibles for detecting turned rays in solving eikonal equation */
-int ierr=0;
-float x_err, z_err, r_err;
-int ia_err;
+CSEIS_SU_THREAD_LOCAL int ierr=0;
+CSEIS_SU_THREAD_LOCAL float x_err, z_err, r_err;
+CSEIS_SU_THREAD_LOCAL int ia_err;
 
 /* Prototypes for additional eikonal equation functions */
 void delta_t (int na, float da, float r, float dr, 
@@ -108,7 +108,7 @@ void eiktam_pert (float xs, float zs, int nz, float dz, float fz, int nx,
 
 
 /* segy trace */
-segy tr, tro;
+CSEIS_SU_THREAD_LOCAL segy tr, tro;
 
 void* main_suinvvxzco( void* args )
 {
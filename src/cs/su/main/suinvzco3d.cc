@@ -88,7 +88,7 @@ void amplitude(float fx, float fy, int nx, int ny, int nz,
 
 
 /*segy trace */ 
-segy tr, tro;
+CSEIS_SU_THREAD_LOCAL segy tr, tro;
 
 void* main_suinvzco3d( void* args )
 {
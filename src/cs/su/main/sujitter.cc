@@ -57,7 +57,7 @@ namespace sujitter {
 /************************ end self doc ***********************************/
 
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sujitter( void* args )
 {
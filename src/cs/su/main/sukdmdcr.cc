@@ -147,7 +147,7 @@ namespace sukdmdcr {
 
 
 /* segy trace */
-segy tr, tro;
+CSEIS_SU_THREAD_LOCAL segy tr, tro;
 
 void* main_sukdmdcr( void* args )
 {
@@ -879,8 +879,8 @@ void filt(float *trace,int nt,float dt,int sgn)
     trace(nt) 	filtered and phase-shifted seismic trace 
 ********************************************************************/
 {
-	static int nfft, n;
-	static float dw, fw;
+	CSEIS_SU_THREAD_LOCAL int nfft, n;
+	CSEIS_SU_THREAD_LOCAL float dw, fw;
 	int  it,iw,sgnw;
 	float temp, const2, amp, omega;
         complex *ct;
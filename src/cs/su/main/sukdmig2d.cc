@@ -73,6 +73,7 @@ std::string sdoc_sukdmig2d =
 " mtr=100  		print verbal information at every mtr traces	"
 " ntr=100000		maximum number of input traces to be migrated	"
 " npv=0			flag of computing quantities for velocity analysis"
+" nthreads=1		number of migration threads			"
 " rscale=1000.0 	scaling for roundoff error suppression		"
 "									"
 "   ...if npv>0 specify the following three files:			"
@@ -105,6 +106,10 @@ std::string sdoc_sukdmig2d =
 "    noff, will get migrated into the extremal offset bins/planes.  E.g. if "
 "    absoff=0 and limoff=0, all traces with gx<sx will get migrated into the "
 "    off0 bin."
+" 9. For nthreads>1, input traces are distributed over nthreads threads."
+"    Each thread accumulates its own copy of the migrated sections, these"
+"    are summed up once all traces have been migrated. The memory for	"
+"    the migrated sections is multiplied by nthreads.			"
 "									"
 ;
 
@@ -137,11 +142,41 @@ namespace sukdmig2d {
 	float **tsum,int nzt,float fzt,float dzt,int nxt,float fxt,float dxt,
 	int npv,float **cssum,float **tvsum,float **mig1);
 
+/* input traces, tables and parameters shared by all migration threads */
+struct MIGJOB {
+	pthread_mutex_t mutex;	/* serializes trace input and job print	*/
+	FILE *infp,*jpfp;
+	segy *firsttr;		/* first trace, already read in, or NULL */
+	int isEOF;
+	int jtr,ktr,ntr,mtr;
+	int nt,nzt,nxt,nzo,nxo,ns,noff,nr,ls,mtmax,npv,absoff,limoff;
+	float ft,fzt,fxt,fzo,fxo,fs,off0,dt,dzt,dxt,dzo,dxo,ds,doff,dxm,es;
+	float fmax,angmax,offmax,aperx;
+	float ***ttab,**tb,**pb,**cs0b,**angb,***cs,***tv;
+	int isError;
+	char errmsg[256];
+};
+
+/* private data of one migration thread */
+struct MIGTHREAD {
+	struct MIGJOB *job;
+	float ***mig,***mig1;	/* migrated sections of this thread	*/
+	float **tsum,**tt,**tvsum,**cssum;
+	segy trace;
+	pthread_t thread;
+};
+
+  int next_trace(struct MIGJOB *job,struct MIGTHREAD *mt,
+	float *sx,float *gx,int *io);
+  void migrate_traces(struct MIGTHREAD *mt);
+  void* migrate_thread(void *arg);
+  void free_migthreads(struct MIGTHREAD *mt,int nthreads,int npv);
+
 /* define */
 #define RSCALE_KDMIG 1000.0
 
 /* segy trace */
-segy tr, tro;
+CSEIS_SU_THREAD_LOCAL segy tr, tro;
 
 void* main_sukdmig2d( void* args )
 {
@@ -154,15 +189,19 @@ void* main_sukdmig2d( void* args )
 	int noff;	/* number of offsets in output data		*/
 	int nr;
 	int is,io,ixo,izo; /* counters */
-	int ls,ntr,jtr,ktr,mtr,npv,mtmax;
-	int   offset,absoff,limoff;
+	int ls,ntr,ktr,mtr,npv,mtmax;
+	int   absoff,limoff;
 	off_t nseek;
 	float   ft,fzt,fxt,fzo,fxo,fs,off0,dt,dzt,dxt,dzo,dxo,ds,doff,dxm,
 		ext,ezt,ezo,exo,es,s,scal;	
-	float v0,dvz,fmax,angmax,offmax,rmax,aperx,sx=0,gx=0;
+	float v0,dvz,fmax,angmax,offmax,rmax,aperx;
 	float ***mig=NULL,***ttab=NULL,**tb=NULL,**pb=NULL;
-	float **cs0b=NULL,**angb=NULL,**tsum=NULL,**tt=NULL;
-	float **tvsum=NULL,***mig1=NULL,***cs=NULL,***tv=NULL,**cssum=NULL;
+	float **cs0b=NULL,**angb=NULL;
+	float ***mig1=NULL,***cs=NULL,***tv=NULL;
+	int nthreads,ithread;	/* number of migration threads, index	*/
+	size_t nmig,imig;	/* number of samples in migrated section */
+	struct MIGJOB job;
+	struct MIGTHREAD *mt=NULL;
 
 	float rscale;			/* scaling factor for roundoff */
 	
@@ -275,6 +314,8 @@ void* main_sukdmig2d( void* args )
 	if (!parObj.getparint("ntr",&ntr))	ntr = 100000;
 	if (!parObj.getparint("mtr",&mtr))	mtr = 100;
 	if (!parObj.getparint("npv",&npv))	npv = 0;
+	if (!parObj.getparint("nthreads",&nthreads))	nthreads = 1;
+	if (nthreads<1) throw cseis_geolib::csException("nthreads must be positive!\n");
 	if(npv){
 		if( !parObj.getparstring("tvfile",&tvfile))
 			throw cseis_geolib::csException("must specify tvfile!\n");
@@ -319,7 +360,7 @@ void* main_sukdmig2d( void* args )
  	fprintf(jpfp," noff=%d off0=%g doff=%g\n",noff,off0,doff);
 	fprintf(jpfp," v0=%g dvz=%g \n",v0,dvz);
  	fprintf(jpfp," aperx=%g offmax=%g angmax=%g\n",aperx,offmax,angmax);
- 	fprintf(jpfp," ntr=%d mtr=%d ls=%d npv=%d\n",ntr,mtr,ls,npv);
+ 	fprintf(jpfp," ntr=%d mtr=%d ls=%d npv=%d nthreads=%d\n",ntr,mtr,ls,npv,nthreads);
 	fprintf(jpfp," absoff=%d limoff=%d\n",absoff,limoff);
 	if(npv)
  	  fprintf(jpfp," tvfile=%s csfile=%s outfile1=%s\n",
@@ -330,13 +371,9 @@ void* main_sukdmig2d( void* args )
 	/* allocate space */
 	mig = ealloc3float(nzo,nxo,noff);
 	ttab = ealloc3float(nzt,nxt,ns);
-	tt = ealloc2float(nzt,nxt);
-	tsum = ealloc2float(nzt,nxt);
 	if(npv){
 		tv = ealloc3float(nzt,nxt,ns);
-		tvsum = ealloc2float(nzt,nxt);
 		cs = ealloc3float(nzt,nxt,ns);
-		cssum = ealloc2float(nzt,nxt);
 	}
 	if(!npv) 
 		mig1 = ealloc3float(1,1,noff);
@@ -371,90 +408,121 @@ void* main_sukdmig2d( void* args )
 	fprintf(jpfp," \n");
 	fflush(jpfp);
 	
-
-	jtr = 1;
-	ktr = 0;
-
 	  fprintf(jpfp," fs=%g es=%g offmax=%g\n",fs,es,offmax);
 
-	do {
-		/* determine offset index	*/
-	    float as,res;
-
-		if (tr.scalco) { /* if tr.scalco is set, apply value */
-			if (tr.scalco>0) {
-				sx = tr.sx*tr.scalco;
-				gx = tr.gx*tr.scalco;
-		   	} else { /* if tr.scalco is negative divide */
-				sx = tr.sx/ABS(tr.scalco);
-				gx = tr.gx/ABS(tr.scalco);
+	/* each thread migrates into its own sections, thread 0 into mig */
+	job.infp = infp;
+	job.jpfp = jpfp;
+	job.firsttr = &tr;
+	job.isEOF = 0;
+	job.jtr = 1;
+	job.ktr = 0;
+	job.ntr = ntr;
+	job.mtr = mtr;
+	job.nt = nt;	job.ft = ft;	job.dt = dt;
+	job.nzt = nzt;	job.fzt = fzt;	job.dzt = dzt;
+	job.nxt = nxt;	job.fxt = fxt;	job.dxt = dxt;
+	job.nzo = nzo;	job.fzo = fzo;	job.dzo = dzo;
+	job.nxo = nxo;	job.fxo = fxo;	job.dxo = dxo;
+	job.ns = ns;	job.fs = fs;	job.ds = ds;	job.es = es;
+	job.noff = noff;	job.off0 = off0;	job.doff = doff;
+	job.nr = nr;
+	job.ls = ls;
+	job.mtmax = mtmax;
+	job.npv = npv;
+	job.absoff = absoff;
+	job.limoff = limoff;
+	job.dxm = dxm;
+	job.fmax = fmax;
+	job.angmax = angmax;
+	job.offmax = offmax;
+	job.aperx = aperx;
+	job.ttab = ttab;
+	job.tb = tb;
+	job.pb = pb;
+	job.cs0b = cs0b;
+	job.angb = angb;
+	job.cs = cs;
+	job.tv = tv;
+	job.isError = 0;
+	job.errmsg[0] = '\0';
+	pthread_mutex_init(&job.mutex,NULL);
+
+	nmig = (size_t)noff*nxo*nzo;
+	mt = new struct MIGTHREAD[nthreads];
+	for(ithread=0; ithread<nthreads; ++ithread) {
+		mt[ithread].job = &job;
+		if(ithread==0) {
+			mt[ithread].mig = mig;
+			mt[ithread].mig1 = mig1;
+		} else {
+			mt[ithread].mig = ealloc3float(nzo,nxo,noff);
+			memset((void *) mt[ithread].mig[0][0],0,nmig*sizeof(float));
+			if(!npv) {
+				mt[ithread].mig1 = ealloc3float(1,1,noff);
+			} else {
+				mt[ithread].mig1 = ealloc3float(nzo,nxo,noff);
+				memset((void *) mt[ithread].mig1[0][0],0,nmig*sizeof(float));
 			}
-			
+		}
+		mt[ithread].tt = ealloc2float(nzt,nxt);
+		mt[ithread].tsum = ealloc2float(nzt,nxt);
+		if(npv){
+			mt[ithread].tvsum = ealloc2float(nzt,nxt);
+			mt[ithread].cssum = ealloc2float(nzt,nxt);
 		} else {
-			     sx = tr.sx;
-			     gx = tr.gx;
+			mt[ithread].tvsum = NULL;
+			mt[ithread].cssum = NULL;
 		}
+	}
 
-		/* GWB 2005.09.22: */
-		/* io = (int)((gx-sx-off0)/doff+0.5); */
-		offset=gx-sx;
-		if( absoff && offset<0 )offset=-offset;
-		io = (int)((offset-off0)/doff+0.5);
-		if( limoff && (io<0 || io>=noff) ) continue;
-		/* end of GWB 2005.09.22 */
-
-	    if(io<0) io = 0;
-	    if(io>=noff) io = noff-1;
-
-		/* fprintf(jpfp," read trace jtr=%d: sx=%g gx=%g io=%d ktr=%d\n",jtr,sx,gx,io,ktr); */
-
-	    if(MIN(sx,gx)>=fs && MAX(sx,gx)<=es && 
-		 MAX(gx-sx,sx-gx)<=offmax ){
-		/*     migrate this trace	*/
-
-		    /* fprintf(jpfp," Good! Condition NOT satisfied\n"); */
-
-	    	as = (sx-fs)/ds;
-	    	is = (int)as;
-		if(is==ns-1) is=ns-2;
-		res = as-is;
-		if(res<=0.01) res = 0.0;
-		if(res>=0.99) res = 1.0;
-		sum2(nxt,nzt,1-res,res,ttab[is],ttab[is+1],tsum);
-		if(npv)  {
-			sum2(nxt,nzt,1-res,res,tv[is],tv[is+1],tvsum);
-			sum2(nxt,nzt,1-res,res,cs[is],cs[is+1],cssum);
+	if(nthreads==1) {
+		migrate_thread(&mt[0]);
+	} else {
+		int nstarted;
+		for(nstarted=0; nstarted<nthreads; ++nstarted) {
+			if(pthread_create(&mt[nstarted].thread,NULL,migrate_thread,&mt[nstarted])!=0) break;
 		}
-		
-	    	as = (gx-fs)/ds;
-	    	is = (int)as;
-		if(is==ns-1) is=ns-2;
-		res = as-is;
-		if(res<=0.01) res = 0.0;
-		if(res>=0.99) res = 1.0;
-		sum2(nxt,nzt,1-res,res,ttab[is],ttab[is+1],tt);
-		sum2(nxt,nzt,1,1,tt,tsum,tsum);
-		if(npv)  {
-			sum2(nxt,nzt,1-res,res,tv[is],tv[is+1],tt);
-			sum2(nxt,nzt,1,1,tt,tvsum,tvsum);
-			sum2(nxt,nzt,1-res,res,cs[is],cs[is+1],tt);
-			sum2(nxt,nzt,1,1,tt,cssum,cssum);
+		if(nstarted<nthreads) {
+			pthread_mutex_lock(&job.mutex);
+			job.isEOF = 1;
+			job.isError = 1;
+			sprintf(job.errmsg,"cannot create migration thread\n");
+			pthread_mutex_unlock(&job.mutex);
 		}
+		for(ithread=0; ithread<nstarted; ++ithread)
+			pthread_join(mt[ithread].thread,NULL);
+	}
+	pthread_mutex_destroy(&job.mutex);
+	if(job.isError) {
+		free_migthreads(mt,nthreads,npv);
+		free2float(pb);
+		free2float(tb);
+		free2float(cs0b);
+		free2float(angb);
+		free3float(ttab);
+		free3float(mig);
+		free3float(mig1);
+		if(npv){
+			free3float(tv);
+			free3float(cs);
+		}
+		throw cseis_geolib::csException("%s",job.errmsg);
+	}
+	ktr = job.ktr;
 
-		mig2d(tr.data,nt,ft,dt,sx,gx,mig[io],aperx,
-		  nxo,fxo,dxo,nzo,fzo,dzo,
-		  ls,mtmax,dxm,fmax,angmax,
-		  tb,pb,cs0b,angb,nr,tsum,nzt,fzt,dzt,nxt,fxt,dxt,
-		  npv,cssum,tvsum,mig1[io]);
-
-		  ktr++;
-		  if((jtr-1)%mtr ==0 ){
-			fprintf(jpfp," migrated trace %d\n",jtr);
-			fflush(jpfp);
-	    	}
-	    }
-	    jtr++;
-	} while (fgettr(infp,&tr) && jtr<ntr);
+	/* sum up sections of all threads */
+	for(ithread=1; ithread<nthreads; ++ithread) {
+		float *mig0 = mig[0][0];
+		float *migt = mt[ithread].mig[0][0];
+		for(imig=0; imig<nmig; ++imig) mig0[imig] += migt[imig];
+		if(npv) {
+			mig0 = mig1[0][0];
+			migt = mt[ithread].mig1[0][0];
+			for(imig=0; imig<nmig; ++imig) mig0[imig] += migt[imig];
+		}
+	}
+	free_migthreads(mt,nthreads,npv);
 
 	fprintf(jpfp," migrated %d traces in total\n",ktr);
 
@@ -504,8 +572,6 @@ void* main_sukdmig2d( void* args )
 	efclose(outfp);
 
 	    
-	free2float(tsum);
-	free2float(tt);
 	free2float(pb);
 	free2float(tb);
 	free2float(cs0b);
@@ -516,8 +582,6 @@ void* main_sukdmig2d( void* args )
 	if(npv){
 		free3float(tv);
 		free3float(cs);
-		free2float(tvsum);
-		free2float(cssum);
 	}
 	su2cs->setEOF();
 	pthread_exit(NULL);
@@ -530,6 +594,166 @@ catch( cseis_geolib::csException& exc ) {
 }
 }
 
+/* read next input trace to be migrated, return 0 if there are no more traces.
+   Must be called with job->mutex locked	*/
+  int next_trace(struct MIGJOB *job,struct MIGTHREAD *mt,
+	float *sx,float *gx,int *io)
+{
+	segy *trp = &mt->trace;
+	int offset;
+
+	for(;;) {
+		if(job->firsttr!=NULL) {
+			memcpy((void *) trp,(const void *) job->firsttr,sizeof(segy));
+			job->firsttr = NULL;
+		} else if(job->isEOF || job->jtr>=job->ntr || !fgettr(job->infp,trp)) {
+			job->isEOF = 1;
+			return 0;
+		}
+
+		/* determine offset index	*/
+		if (trp->scalco) { /* if tr.scalco is set, apply value */
+			if (trp->scalco>0) {
+				*sx = trp->sx*trp->scalco;
+				*gx = trp->gx*trp->scalco;
+		   	} else { /* if tr.scalco is negative divide */
+				*sx = trp->sx/ABS(trp->scalco);
+				*gx = trp->gx/ABS(trp->scalco);
+			}
+			
+		} else {
+			     *sx = trp->sx;
+			     *gx = trp->gx;
+		}
+
+		/* GWB 2005.09.22: */
+		/* io = (int)((gx-sx-off0)/doff+0.5); */
+		offset=*gx-*sx;
+		if( job->absoff && offset<0 )offset=-offset;
+		*io = (int)((offset-job->off0)/job->doff+0.5);
+		if( job->limoff && (*io<0 || *io>=job->noff) ) continue;
+		/* end of GWB 2005.09.22 */
+
+	    if(*io<0) *io = 0;
+	    if(*io>=job->noff) *io = job->noff-1;
+
+	    if(MIN(*sx,*gx)>=job->fs && MAX(*sx,*gx)<=job->es && 
+		 MAX(*gx-*sx,*sx-*gx)<=job->offmax ){
+		  job->ktr++;
+		  if((job->jtr-1)%job->mtr ==0 ){
+			fprintf(job->jpfp," migrated trace %d\n",job->jtr);
+			fflush(job->jpfp);
+	    	  }
+		  job->jtr++;
+		  return 1;
+	    }
+	    job->jtr++;
+	}
+}
+
+/* migrate input traces until there are no more left: traces are read one
+   by one from the shared input, and migrated into the sections of the
+   calling thread	*/
+  void migrate_traces(struct MIGTHREAD *mt)
+{
+	struct MIGJOB *job = mt->job;
+	float ***ttab = job->ttab, ***tv = job->tv, ***cs = job->cs;
+	int nxt = job->nxt, nzt = job->nzt, ns = job->ns, npv = job->npv;
+	float fs = job->fs, ds = job->ds;
+	float sx,gx,as,res;
+	int io,is,isTrace;
+
+	for(;;) {
+		pthread_mutex_lock(&job->mutex);
+		try {
+			isTrace = next_trace(job,mt,&sx,&gx,&io);
+		}
+		catch( cseis_geolib::csException& exc ) {
+			/* release input lock, error is handled by caller */
+			pthread_mutex_unlock(&job->mutex);
+			throw;
+		}
+		pthread_mutex_unlock(&job->mutex);
+		if(!isTrace) break;
+
+		/*     migrate this trace	*/
+	    	as = (sx-fs)/ds;
+	    	is = (int)as;
+		if(is==ns-1) is=ns-2;
+		res = as-is;
+		if(res<=0.01) res = 0.0;
+		if(res>=0.99) res = 1.0;
+		sum2(nxt,nzt,1-res,res,ttab[is],ttab[is+1],mt->tsum);
+		if(npv)  {
+			sum2(nxt,nzt,1-res,res,tv[is],tv[is+1],mt->tvsum);
+			sum2(nxt,nzt,1-res,res,cs[is],cs[is+1],mt->cssum);
+		}
+		
+	    	as = (gx-fs)/ds;
+	    	is = (int)as;
+		if(is==ns-1) is=ns-2;
+		res = as-is;
+		if(res<=0.01) res = 0.0;
+		if(res>=0.99) res = 1.0;
+		sum2(nxt,nzt,1-res,res,ttab[is],ttab[is+1],mt->tt);
+		sum2(nxt,nzt,1,1,mt->tt,mt->tsum,mt->tsum);
+		if(npv)  {
+			sum2(nxt,nzt,1-res,res,tv[is],tv[is+1],mt->tt);
+			sum2(nxt,nzt,1,1,mt->tt,mt->tvsum,mt->tvsum);
+			sum2(nxt,nzt,1-res,res,cs[is],cs[is+1],mt->tt);
+			sum2(nxt,nzt,1,1,mt->tt,mt->cssum,mt->cssum);
+		}
+
+		mig2d(mt->trace.data,job->nt,job->ft,job->dt,sx,gx,mt->mig[io],job->aperx,
+		  job->nxo,job->fxo,job->dxo,job->nzo,job->fzo,job->dzo,
+		  job->ls,job->mtmax,job->dxm,job->fmax,job->angmax,
+		  job->tb,job->pb,job->cs0b,job->angb,job->nr,mt->tsum,
+		  nzt,job->fzt,job->dzt,nxt,job->fxt,job->dxt,
+		  npv,mt->cssum,mt->tvsum,mt->mig1[io]);
+	}
+}
+
+  void* migrate_thread(void *arg)
+{
+	struct MIGTHREAD *mt = (struct MIGTHREAD *) arg;
+	struct MIGJOB *job = mt->job;
+
+	try {
+		migrate_traces(mt);
+	}
+	catch( cseis_geolib::csException& exc ) {
+		pthread_mutex_lock(&job->mutex);
+		if(!job->isError) {
+			job->isError = 1;
+			snprintf(job->errmsg,sizeof(job->errmsg),"%s",exc.getMessage());
+		}
+		/* stop all other threads */
+		job->isEOF = 1;
+		pthread_mutex_unlock(&job->mutex);
+	}
+	return NULL;
+}
+
+/* free work buffers of all migration threads; sections of thread 0 belong to the caller */
+  void free_migthreads(struct MIGTHREAD *mt,int nthreads,int npv)
+{
+	int ithread;
+
+	for(ithread=0; ithread<nthreads; ++ithread) {
+		if(ithread>0) {
+			free3float(mt[ithread].mig);
+			free3float(mt[ithread].mig1);
+		}
+		free2float(mt[ithread].tt);
+		free2float(mt[ithread].tsum);
+		if(npv){
+			free2float(mt[ithread].tvsum);
+			free2float(mt[ithread].cssum);
+		}
+	}
+	delete [] mt;
+}
+
 /* residual traveltime calculation based  on reference   time	*/
   void resit(int nx,float fx,float dx,int nz,int nr,float dr,
 		float **tb,float **t,float x0)
@@ -859,8 +1083,8 @@ void filt(float *trace,int nt,float dt,float fmax,int ls,int m,float *trf)
     tracei(nt) 	filtered, integrated and phase-shifted seismic trace 
  */
 {
-	static int nfft=0, itaper, nw, nwf;
-	static float *taper, *amp, *ampi, dw;
+	CSEIS_SU_THREAD_LOCAL int nfft=0, itaper, nw, nwf;
+	CSEIS_SU_THREAD_LOCAL float *taper, *amp, *ampi, dw;
 	int  it, iw, itemp;
 	float temp, ftaper, const2, *rt;
 	complex *ct;
@@ -86,6 +86,7 @@ std::string sdoc_sukdmig3d =
 " pptr=100		print verbal information at every pptr traces	"
 " ntrmax=100000		maximum number of input traces to be migrated	"
 " ls=0                  point =0 line source =1                         "
+" nthreads=1            number of migration threads                     "
 "									"
 " Notes:								"
 " 1. Traveltime tables were generated by program SUTETRARAY (or other	"
@@ -103,6 +104,10 @@ std::string sdoc_sukdmig3d =
 " 6. Input traces must specify source and receiver positions via header	"
 "    fields tr.sx and tr.gx, as well as tr.sy and tr.gy. Offset is 	"
 "    computed automatically.						"
+" 7. For nthreads>1, input traces are distributed over nthreads threads."
+"    Each thread accumulates its own copy of the migrated image, these	"
+"    are summed up once all traces have been migrated. The memory for	"
+"    the migrated image is multiplied by nthreads.			"
 "									"
 " Disclaimer:								"
 " This is a research code that will take considerable work to get into	"
@@ -133,6 +138,16 @@ namespace sukdmig3d {
 #define InfByte1 255
 #define InfByte2 65535
 
+/*bilinear interpolation in [ny][nx] table t, k: flat index of lower left sample*/
+#define BILIN(t,k,nx,wy0,wy,wx0,wx) \
+      ((wy0)*((wx0)*(t)[k]+(wx)*(t)[(k)+1])+ \
+       (wy) *((wx0)*(t)[(k)+(nx)]+(wx)*(t)[(k)+(nx)+1]))
+
+/*true if any of the four samples around flat index k is infinite time*/
+#define ISINF4(t,k,nx) \
+      ((t)[k]>=InfByte2 || (t)[(k)+(nx)]>=InfByte2 || \
+       (t)[(k)+1]>=InfByte2 || (t)[(k)+(nx)+1]>=InfByte2)
+
 struct GD {
       float fxgd;
       float dxgd;
@@ -191,6 +206,38 @@ struct TTAB {
       unsigned char r;   /*real r=r/InfByte1*InfDistance*/
 };
 
+/*input traces and tables shared by all migration threads*/
+struct MIGJOB {
+      pthread_mutex_t mutex; /*serializes trace input and job print*/
+      FILE *infp;
+      segy *firsttr;    /*first trace, already read in, or NULL*/
+      int isEOF;
+      int imigtr;
+      int itotmigtr;
+      int ntrmax;
+      int pptr;
+      float exs,eys;
+      float xoffsetmax,yoffsetmax;
+      int nxoffset,nyoffset;
+      float fxoffset,fyoffset,dxoffset,dyoffset;
+      unsigned short ******tbuf;
+      unsigned char  *****cbuf;
+      unsigned char  *****rbuf;
+      int isError;
+      char errmsg[256];
+};
+
+/*private data of one migration thread*/
+struct MIGTHREAD {
+      struct MIGJOB *job;
+      struct GD gd;     /*copy: source & receiver position change per trace*/
+      float *****mig;   /*image of size nyoffset*nxoffset*nyo*nxo*nzo*/
+      float *trf;
+      float **rhos,**rhog;
+      segy trace;
+      pthread_t thread;
+};
+
 void filt(float *trace, struct GD *gd, float *trf);
 
 void get_bufs( struct GD *gd, float ******ttab, float *****ctab,
@@ -199,12 +246,21 @@ void get_bufs( struct GD *gd, float ******ttab, float *****ctab,
 
 void mig3d( struct GD *gd, float *trace, float *trf, float ***mig,
       unsigned short ******buf, unsigned char  *****cbuf,
-      unsigned char  *****rbuf);
+      unsigned char  *****rbuf, float **rhos, float **rhog);
+
+int next_trace( struct MIGJOB *job, struct MIGTHREAD *mt,
+      int *ixoffset, int *iyoffset);
+
+void migrate_traces( struct MIGTHREAD *mt );
+
+void* migrate_thread( void *arg );
+
+void free_migthreads( struct MIGTHREAD *mt, int nthreads );
 
 void preproc( float *data, struct GD *gd);
 
 /*segy trace*/
-segy tr,tro,ttr;
+CSEIS_SU_THREAD_LOCAL segy tr,tro,ttr;
 
 void* main_sukdmig3d( void* args )
 {
@@ -240,8 +296,6 @@ void* main_sukdmig3d( void* args )
       int iyt;	        /*index for nyt*/
       int izs;	        /*index for nzs*/
       int ntrmax;	/*maximum number of input traces to be migrated*/
-      int imigtr;	/*index for migrated traces*/
-      int itotmigtr;    /*index for migrated traces*/
       int pptr;	        /*print verbal information for every pptr traces*/
 
       float fxoffset;   /*first offset in output in x*/
@@ -272,7 +326,6 @@ void* main_sukdmig3d( void* args )
 
       int iys,ixs;      /*indices for nys, nxs*/
 
-      float *trf;       /*integrated traced*/
       int imul;
 
       char *datain="stdin";/*input data*/
@@ -284,7 +337,12 @@ void* main_sukdmig3d( void* args )
       FILE *outfp;	/*output file pointer*/
       FILE *ttfp;	/*tttable file pointer*/
 
-      float xm,ym;      /*mid point*/
+      int nthreads;     /*number of migration threads*/
+      int ithread;      /*index for nthreads*/
+      size_t nmig;      /*number of samples in migrated image*/
+      size_t imig;      /*index for nmig*/
+      struct MIGJOB job;
+      struct MIGTHREAD *mt=NULL;
 
       /*hook up getpar to handle the parameters*/
       cseis_su::csSUArguments* suArgs = (cseis_su::csSUArguments*)args;
@@ -388,6 +446,8 @@ void* main_sukdmig3d( void* args )
 
       if (!parObj.getparint("ntrmax",&ntrmax)) ntrmax=100000;
       if (!parObj.getparint("pptr",&pptr)) pptr=100;
+      if (!parObj.getparint("nthreads",&nthreads)) nthreads=1;
+      if (nthreads<1) throw cseis_geolib::csException("nthreads must be positive");
 
       gd->fxs=gd->fxgd+gd->ixsf*gd->dxgd;
       gd->dxs=gd->ixsr*gd->dxgd;
@@ -511,7 +571,7 @@ void* main_sukdmig3d( void* args )
 	    gd->xaper,xoffsetmax);
       fprintf(gd->jpfp," yaper=%g yoffsetmax=%g\n",
 	    gd->yaper,yoffsetmax);
-      fprintf(gd->jpfp," ntrmax=%d pptr=%d\n",ntrmax,pptr);
+      fprintf(gd->jpfp," ntrmax=%d pptr=%d nthreads=%d\n",ntrmax,pptr,nthreads);
       fprintf(gd->jpfp," ext=%g exo=%g\n",ext,exo);
       fprintf(gd->jpfp," eyt=%g eyo=%g\n",eyt,eyo);
       fprintf(gd->jpfp," ezs=%g ezo=%g\n",ezs,ezo);
@@ -531,7 +591,7 @@ void* main_sukdmig3d( void* args )
       Allocate space
       ****************************************************/
       fprintf(gd->jpfp,"allocating mig of size %g Mbytes\n",(4.0e-6)*
-	    gd->nzo*gd->nxo*gd->nyo*nxoffset*nyoffset);
+	    gd->nzo*gd->nxo*gd->nyo*nxoffset*nyoffset*nthreads);
 
       mig =ealloc5float(gd->nzo,gd->nxo,gd->nyo,nxoffset,nyoffset);
 
@@ -543,12 +603,10 @@ void* main_sukdmig3d( void* args )
 
       fprintf(gd->jpfp,"allocating tbuf, cbuf and rbuf of size %g Mbytes\n",(4.0e-6)*
 	    gd->nys*gd->nxo*gd->nzo*gd->nyt*gd->nxt);
-      tbuf=ealloc6ushort(gd->multit,gd->nxt,gd->nyt,gd->nzo,gd->nxo,gd->nys);
+      tbuf=ealloc6ushort(gd->nxt,gd->nyt,gd->nzo,gd->nxo,gd->nys,gd->multit);
       cbuf=ealloc5uchar(gd->nxt,gd->nyt,gd->nzo,gd->nxo,gd->nys);
       rbuf=ealloc5uchar(gd->nxt,gd->nyt,gd->nzo,gd->nxo,gd->nys);
 
-      trf=ealloc1float(gd->nt + 2*gd->ntrimax);
-
       memset((void *)mig[0][0][0][0],0,
 	    nxoffset*nyoffset*gd->nxo*gd->nyo*gd->nzo*sizeof(float));
 
@@ -608,76 +666,90 @@ void* main_sukdmig3d( void* args )
       fprintf(gd->jpfp,"Start migration ...\n");
       fflush(gd->jpfp);
 	
-      imigtr=1;
-      itotmigtr=0; 
-
-      do { 
-	    /*****************************************************	
-	    To determine offset index
-	    *****************************************************/
-	    gd->sx=tr.sx;    /*source position in x*/
-	    gd->gx=tr.gx;    /*geophone position in x*/
-	    gd->sy=tr.sy;    /*source position in y*/
-	    gd->gy=tr.gy;    /*geophone position in y*/ 
-
-            #ifdef DEBUG
-	    gd->sy=3;	
-	    gd->gy=3;
-	    fprintf(gd->jpfp,"trace %d: sx,gx,sy,gy=%g %g %g %g\n",
-		  imigtr,gd->sx,gd->gx,gd->sy,gd->gy);
-	    fprintf(gd->jpfp,"trace in line: %d; trace in reel: %d\n",
-		  tr.tracl,tr.tracr);
-            #endif
-
-            xm=0.5*(gd->sx+gd->gx);
-            ym=0.5*(gd->sy+gd->gy);
-
-	    if (xm<gd->fxs || xm>exs || 
-	        MAX(gd->gx-gd->sx,gd->sx-gd->gx)>xoffsetmax  || 
-		ym<gd->fys || ym>eys || 
-		MAX(gd->gy-gd->sy,gd->sy-gd->gy)>yoffsetmax )
-		  continue; 
-
-	    /****************************************************
-	    Determine the index for offset in x, fxoffset is the 
-	    starting offset
-	    ****************************************************/
-	    ixoffset=(int)((gd->gx-gd->sx-fxoffset)/dxoffset+0.5);
-	    if (ixoffset<0) ixoffset=0;	
-	    if (ixoffset>=nxoffset) ixoffset=nxoffset-1;
-
-	    /****************************************************
-	    Determine the index for offset in y, fxoffset is the 
-	    starting offset
-	    ****************************************************/
-	    iyoffset=(int)((gd->gy-gd->sy-fyoffset)/dyoffset+0.5);
-	    if (iyoffset<0) iyoffset=0;	
-	    if (iyoffset>=nyoffset) iyoffset=nyoffset-1;
-
-	    /*******************************************
-	    Take the t-derivative of the data
-	    *******************************************/
-	    /*For the 1D synthetic data, turn this off*/
-
-            filt(tr.data,gd,trf); 
+      /*****************************************************
+      Each thread migrates into its own image, thread 0 into
+      mig. Traces are handed out one by one in input order.
+      *****************************************************/
+      job.infp=infp;
+      job.firsttr=&tr;
+      job.isEOF=0;
+      job.imigtr=1;
+      job.itotmigtr=0;
+      job.ntrmax=ntrmax;
+      job.pptr=pptr;
+      job.exs=exs;
+      job.eys=eys;
+      job.xoffsetmax=xoffsetmax;
+      job.yoffsetmax=yoffsetmax;
+      job.nxoffset=nxoffset;
+      job.nyoffset=nyoffset;
+      job.fxoffset=fxoffset;
+      job.fyoffset=fyoffset;
+      job.dxoffset=dxoffset;
+      job.dyoffset=dyoffset;
+      job.tbuf=tbuf;
+      job.cbuf=cbuf;
+      job.rbuf=rbuf;
+      job.isError=0;
+      job.errmsg[0]='\0';
+      pthread_mutex_init(&job.mutex,NULL);
+
+      nmig=(size_t)nxoffset*nyoffset*gd->nxo*gd->nyo*gd->nzo;
+      mt=new struct MIGTHREAD[nthreads];
+      for (ithread=0;ithread<nthreads;ithread++) {
+	    mt[ithread].job=&job;
+	    mt[ithread].gd=gd0;
+	    if (ithread==0) {
+		  mt[ithread].mig=mig;
+	    } else {
+		  mt[ithread].mig=ealloc5float(gd->nzo,gd->nxo,gd->nyo,nxoffset,nyoffset);
+		  memset((void *)mt[ithread].mig[0][0][0][0],0,nmig*sizeof(float));
+	    }
+	    mt[ithread].trf=ealloc1float(gd->nt + 2*gd->ntrimax);
+	    mt[ithread].rhos=ealloc2float(gd->nxo,gd->nyo);
+	    mt[ithread].rhog=ealloc2float(gd->nxo,gd->nyo);
+      }
 
-	    mig3d(gd,
-	       	  tr.data,  /*the data of this trace*/
-                  trf,      /*integrated trace*/
-		  mig[iyoffset][ixoffset],/*of nyo*nxo*nzo*/
-		  tbuf,	    
-		  cbuf,
-		  rbuf); 
+      if (nthreads==1) {
+	    migrate_thread(&mt[0]);
+      } else {
+	    int nstarted;
+	    for (nstarted=0;nstarted<nthreads;nstarted++) {
+		  if (pthread_create(&mt[nstarted].thread,NULL,migrate_thread,&mt[nstarted])!=0) break;
+	    }
+	    if (nstarted<nthreads) {
+		  pthread_mutex_lock(&job.mutex);
+		  job.isEOF=1;
+		  job.isError=1;
+		  sprintf(job.errmsg,"Can not create migration thread");
+		  pthread_mutex_unlock(&job.mutex);
+	    }
+	    for (ithread=0;ithread<nstarted;ithread++) {
+		  pthread_join(mt[ithread].thread,NULL);
+	    }
+      }
+      pthread_mutex_destroy(&job.mutex);
+      if (job.isError) {
+	    free_migthreads(mt,nthreads);
+	    free6ushort(tbuf);
+	    free5uchar(cbuf);
+	    free5uchar(rbuf);
+	    free6float(ttab);
+	    free5float(ctab);
+	    free5float(rtab);
+	    free5float(mig);
+	    throw cseis_geolib::csException("%s",job.errmsg);
+      }
 
-	    itotmigtr++;
-	    if ((imigtr-1)%pptr ==0 ){
-		  fprintf(gd->jpfp,"Migrated trace %d\n",imigtr);
-		  fflush(gd->jpfp);
-    	    }
-	    imigtr++;
-      } while (fgettr(infp,&tr) && imigtr<ntrmax);
+      /*sum up images of all threads*/
+      for (ithread=1;ithread<nthreads;ithread++) {
+	    float *mig0=mig[0][0][0][0];
+	    float *migt=mt[ithread].mig[0][0][0][0];
+	    for (imig=0;imig<nmig;imig++) mig0[imig]+=migt[imig];
+      }
+      free_migthreads(mt,nthreads);
 
-      fprintf(gd->jpfp,"Migrated %d traces in total\n",itotmigtr);
+      fprintf(gd->jpfp,"Migrated %d traces in total\n",job.itotmigtr);
 
       memset((void *)&tro,0,sizeof(segy));
       tro.ns=gd->nzo;
@@ -732,16 +804,179 @@ catch( cseis_geolib::csException& exc ) {
 }
 }
 
+int next_trace( struct MIGJOB *job, struct MIGTHREAD *mt,
+      int *ixoffset, int *iyoffset)
+/******************************************************************
+next_trace - read next input trace to be migrated
+*******************************************************************
+Inputs:
+struct *job  shared input
+Outputs:
+struct *mt   trace and source & receiver positions of this thread
+int *ixoffset,*iyoffset  offset indices of trace
+Return 1 if a trace was read, 0 if there are no more traces
+*******************************************************************
+Must be called with job->mutex locked
+******************************************************************/
+{
+      struct GD *gd=&mt->gd;
+      float xm,ym;      /*mid point*/
+
+      for (;;) {
+	    if (job->firsttr!=NULL) {
+		  memcpy((void *)&mt->trace,(const void *)job->firsttr,sizeof(segy));
+		  job->firsttr=NULL;
+	    } else if (job->isEOF || job->imigtr>=job->ntrmax ||
+		       !fgettr(job->infp,&mt->trace)) {
+		  job->isEOF=1;
+		  return 0;
+	    }
+
+	    /*****************************************************	
+	    To determine offset index
+	    *****************************************************/
+	    gd->sx=mt->trace.sx;    /*source position in x*/
+	    gd->gx=mt->trace.gx;    /*geophone position in x*/
+	    gd->sy=mt->trace.sy;    /*source position in y*/
+	    gd->gy=mt->trace.gy;    /*geophone position in y*/ 
+
+            #ifdef DEBUG
+	    gd->sy=3;	
+	    gd->gy=3;
+	    fprintf(gd->jpfp,"trace %d: sx,gx,sy,gy=%g %g %g %g\n",
+		  job->imigtr,gd->sx,gd->gx,gd->sy,gd->gy);
+	    fprintf(gd->jpfp,"trace in line: %d; trace in reel: %d\n",
+		  mt->trace.tracl,mt->trace.tracr);
+            #endif
+
+            xm=0.5*(gd->sx+gd->gx);
+            ym=0.5*(gd->sy+gd->gy);
+
+	    if (xm<gd->fxs || xm>job->exs || 
+	        MAX(gd->gx-gd->sx,gd->sx-gd->gx)>job->xoffsetmax  || 
+		ym<gd->fys || ym>job->eys || 
+		MAX(gd->gy-gd->sy,gd->sy-gd->gy)>job->yoffsetmax )
+		  continue; 
+
+	    /****************************************************
+	    Determine the index for offset in x, fxoffset is the 
+	    starting offset
+	    ****************************************************/
+	    *ixoffset=(int)((gd->gx-gd->sx-job->fxoffset)/job->dxoffset+0.5);
+	    if (*ixoffset<0) *ixoffset=0;	
+	    if (*ixoffset>=job->nxoffset) *ixoffset=job->nxoffset-1;
+
+	    /****************************************************
+	    Determine the index for offset in y, fxoffset is the 
+	    starting offset
+	    ****************************************************/
+	    *iyoffset=(int)((gd->gy-gd->sy-job->fyoffset)/job->dyoffset+0.5);
+	    if (*iyoffset<0) *iyoffset=0;	
+	    if (*iyoffset>=job->nyoffset) *iyoffset=job->nyoffset-1;
+
+	    job->itotmigtr++;
+	    if ((job->imigtr-1)%job->pptr ==0 ){
+		  fprintf(gd->jpfp,"Migrated trace %d\n",job->imigtr);
+		  fflush(gd->jpfp);
+    	    }
+	    job->imigtr++;
+	    return 1;
+      }
+}
+
+void migrate_traces( struct MIGTHREAD *mt )
+/******************************************************************
+migrate_traces - migrate input traces until there are no more left
+*******************************************************************
+Traces are read one by one from the shared input, and migrated
+into the image of the calling thread
+******************************************************************/
+{
+      struct MIGJOB *job=mt->job;
+      int ixoffset,iyoffset;
+      int isTrace;
+
+      for (;;) {
+	    pthread_mutex_lock(&job->mutex);
+	    try {
+		  isTrace=next_trace(job,mt,&ixoffset,&iyoffset);
+	    }
+	    catch( cseis_geolib::csException& exc ) {
+		  /*release input lock, error is handled by caller*/
+		  pthread_mutex_unlock(&job->mutex);
+		  throw;
+	    }
+	    pthread_mutex_unlock(&job->mutex);
+	    if (!isTrace) break;
+
+	    /*******************************************
+	    Take the t-derivative of the data
+	    *******************************************/
+	    /*For the 1D synthetic data, turn this off*/
+
+            filt(mt->trace.data,&mt->gd,mt->trf); 
+
+	    mig3d(&mt->gd,
+	       	  mt->trace.data,  /*the data of this trace*/
+                  mt->trf,         /*integrated trace*/
+		  mt->mig[iyoffset][ixoffset],/*of nyo*nxo*nzo*/
+		  job->tbuf,	    
+		  job->cbuf,
+		  job->rbuf,
+		  mt->rhos,
+		  mt->rhog); 
+      }
+}
+
+void* migrate_thread( void *arg )
+{
+      struct MIGTHREAD *mt=(struct MIGTHREAD *)arg;
+      struct MIGJOB *job=mt->job;
+
+      try {
+	    migrate_traces(mt);
+      }
+      catch( cseis_geolib::csException& exc ) {
+	    pthread_mutex_lock(&job->mutex);
+	    if (!job->isError) {
+		  job->isError=1;
+		  snprintf(job->errmsg,sizeof(job->errmsg),"%s",exc.getMessage());
+	    }
+	    /*stop all other threads*/
+	    job->isEOF=1;
+	    pthread_mutex_unlock(&job->mutex);
+      }
+      return NULL;
+}
+
+void free_migthreads( struct MIGTHREAD *mt, int nthreads )
+/******************************************************************
+free_migthreads - free work buffers of all migration threads
+*******************************************************************
+The image of thread 0 is owned by the caller
+******************************************************************/
+{
+      int ithread;
+
+      for (ithread=0;ithread<nthreads;ithread++) {
+	    if (ithread>0) free5float(mt[ithread].mig);
+	    free1float(mt[ithread].trf);
+	    free2float(mt[ithread].rhos);
+	    free2float(mt[ithread].rhog);
+      }
+      delete [] mt;
+}
+
 void mig3d( struct GD *gd, float *trace, float *trf, float ***mig,
       unsigned short ******tbuf, unsigned char  *****cbuf,
-      unsigned char  *****rbuf)
+      unsigned char  *****rbuf, float **rhos, float **rhog)
 /******************************************************************
 mig3d - migrate a single trace
 *******************************************************************
 Function prototype:
 void mig3d( struct GD *gd, float *trace, float *trf, float ***mig,
       unsigned short ******tbuf, unsigned char  *****cbuf,
-      unsigned char  *****rbuf);
+      unsigned char  *****rbuf, float **rhos, float **rhog);
 *******************************************************************
 Inputs:
 struct *gd   grid information
@@ -750,6 +985,7 @@ float *trf   integrated trace
 unsigned short *******tbuf traveltime buffer
 unsigned char  *****cbuf  cosine buffer
 unsigned char  *****rbuf  path buffer
+float **rhos,**rhog  work arrays of size nyo*nxo
 Outputs:
 float ***mig migrated section
 
@@ -812,13 +1048,16 @@ Author: CWP: Zhaobo Meng, Sept 1997
 
       /*for the meaning of these varibles, refer to Claerbout's
       triabgle filter notation*/
-      float **rhos,**rhog;
       int ntri;    /*triangle filter length*/
       float drho,ddxg,ddyg,ddxs,ddys;
       float temp,ts=0.0,tg=0.0;
 
-      rhos=ealloc2float(gd->nxo,gd->nyo);
-      rhog=ealloc2float(gd->nxo,gd->nyo);
+      /*tables at [iys][ixo][izo] and [iys+1][ixo][izo] are contiguous
+      [nyt][nxt] blocks: index by flat offsets of lower left samples*/
+      int nxt=gd->nxt;
+      int ks0,kg0,ks1,kg1;
+      unsigned short *t0,*t1;
+      unsigned char  *c0,*c1,*r0,*r1;
 
       /**************************************************************
       Geometry:
@@ -984,6 +1223,11 @@ Author: CWP: Zhaobo Meng, Sept 1997
 		  ixtg1=MIN(ixtg1,gd->nxt-2);
                   ixtg1=MAX(ixtg1,0);
 
+                  ks0=iyts0*nxt+ixts0;
+                  kg0=iytg0*nxt+ixtg0;
+                  ks1=iyts1*nxt+ixts1;
+                  kg1=iytg1*nxt+ixtg1;
+
 		  /********************************
 		  Apply anti-aliasing operator here
 		  using scaling functions
@@ -994,41 +1238,26 @@ Author: CWP: Zhaobo Meng, Sept 1997
                         zo=gd->fzo+izo*gd->dzo;
 
                         if (gd->crfp!=NULL) {
+                              c0=cbuf[iys][ixo][izo][0];
+                              c1=cbuf[iys+1][ixo][izo][0];
+                              r0=rbuf[iys][ixo][izo][0];
+                              r1=rbuf[iys+1][ixo][izo][0];
+
                               /*cosine table at [iys][ixo][izo][nyt][nxt]*/
-                              ciys0=yg0b0*(xg0a0*cbuf[iys][ixo][izo][iytg0][ixtg0]+
-                                         xg0a *cbuf[iys][ixo][izo][iytg0][ixtg0+1])+
-			            yg0b *(xg0a0*cbuf[iys][ixo][izo][iytg0+1][ixtg0]+
-                                         xg0a *cbuf[iys][ixo][izo][iytg0+1][ixtg0+1]);
+                              ciys0=BILIN(c0,kg0,nxt,yg0b0,yg0b,xg0a0,xg0a);
 
                               /*cos table at [iys+1][ixo][izo][nyt][nxt]*/
-                              ciys1=yg1b0*(xg1a0*cbuf[iys+1][ixo][izo][iytg1][ixtg1]+
-                                          xg1a *cbuf[iys+1][ixo][izo][iytg1][ixtg1+1])+
-			             yg1b *(xg1a0*cbuf[iys+1][ixo][izo][iytg1+1][ixtg1]+
-                                          xg1a *cbuf[iys+1][ixo][izo][iytg1+1][ixtg1+1]);
+                              ciys1=BILIN(c1,kg1,nxt,yg1b0,yg1b,xg1a0,xg1a);
 
 			      cosine=(ybeta0*ciys0+ybeta*ciys1)/(float)InfByte1;
 
                               /*r table at [iys][ixo][izo][nyt][nxt]*/
-                              riys0=ys0b0*(xs0a0*rbuf[iys][ixo][izo][iyts0][ixts0]+
-                                         xs0a *rbuf[iys][ixo][izo][iyts0][ixts0+1])+
-			            ys0b *(xs0a0*rbuf[iys][ixo][izo][iyts0+1][ixts0]+
-                                         xs0a *rbuf[iys][ixo][izo][iyts0+1][ixts0+1]);
-
-                              riyg0=yg0b0*(xg0a0*rbuf[iys][ixo][izo][iytg0][ixtg0]+
-                                         xg0a *rbuf[iys][ixo][izo][iytg0][ixtg0+1])+
-			            yg0b *(xg0a0*rbuf[iys][ixo][izo][iytg0+1][ixtg0]+
-                                         xg0a *rbuf[iys][ixo][izo][iytg0+1][ixtg0+1]);
+                              riys0=BILIN(r0,ks0,nxt,ys0b0,ys0b,xs0a0,xs0a);
+                              riyg0=BILIN(r0,kg0,nxt,yg0b0,yg0b,xg0a0,xg0a);
 
                               /*traveltime table at [iys+1][ixo][izo][nyt][nxt]*/
-                              riys1=ys1b0*(xs1a0*rbuf[iys+1][ixo][izo][iyts1][ixts1]+
-                                         xs1a *rbuf[iys+1][ixo][izo][iyts1][ixts1+1])+
-			            ys1b *(xs1a0*rbuf[iys+1][ixo][izo][iyts1+1][ixts1]+
-                                         xs1a *rbuf[iys+1][ixo][izo][iyts1+1][ixts1+1]);
-
-                              riyg1=yg1b0*(xg1a0*rbuf[iys+1][ixo][izo][iytg1][ixtg1]+
-                                          xg1a *rbuf[iys+1][ixo][izo][iytg1][ixtg1+1])+
-			             yg1b *(xg1a0*rbuf[iys+1][ixo][izo][iytg1+1][ixtg1]+
-                                          xg1a *rbuf[iys+1][ixo][izo][iytg1+1][ixtg1+1]);
+                              riys1=BILIN(r1,ks1,nxt,ys1b0,ys1b,xs1a0,xs1a);
+                              riyg1=BILIN(r1,kg1,nxt,yg1b0,yg1b,xg1a0,xg1a);
                               
 			      rs=(ybeta0*riys0+ybeta*riys1)/
 				     (float)InfByte1*InfDistance;
@@ -1064,47 +1293,22 @@ Author: CWP: Zhaobo Meng, Sept 1997
                         amp=cosine*zo*rtotal*(1.0/rs/rs+1.0/rg/rg);
 
                         for (im=0;im<gd->multit;im++) {
-                              if (tbuf[im][iys][ixo][izo][iyts0][ixts0]>=InfByte2     ||
-		                  tbuf[im][iys][ixo][izo][iyts0+1][ixts0]>=InfByte2   ||
-		                  tbuf[im][iys][ixo][izo][iyts0][ixts0+1]>=InfByte2   ||
-		                  tbuf[im][iys][ixo][izo][iyts0+1][ixts0+1]>=InfByte2 ||
-		                  tbuf[im][iys][ixo][izo][iytg0][ixtg0]>=InfByte2     ||
-		                  tbuf[im][iys][ixo][izo][iytg0+1][ixtg0]>=InfByte2   ||
-		                  tbuf[im][iys][ixo][izo][iytg0][ixtg0+1]>=InfByte2   ||
-		                  tbuf[im][iys][ixo][izo][iytg0+1][ixtg0+1]>=InfByte2 ||
-		                  tbuf[im][iys+1][ixo][izo][iyts1][ixts1]>=InfByte2   ||
-		                  tbuf[im][iys+1][ixo][izo][iyts1+1][ixts1]>=InfByte2 ||
-		                  tbuf[im][iys+1][ixo][izo][iyts1][ixts1+1]>=InfByte2 ||
-		                  tbuf[im][iys+1][ixo][izo][iyts1+1][ixts1+1]>=InfByte2 ||
-		                  tbuf[im][iys+1][ixo][izo][iytg1][ixtg1]>=InfByte2   ||
-		                  tbuf[im][iys+1][ixo][izo][iytg1+1][ixtg1]>=InfByte2 ||
-		                  tbuf[im][iys+1][ixo][izo][iytg1][ixtg1+1]>=InfByte2 ||
-		                  tbuf[im][iys+1][ixo][izo][iytg1+1][ixtg1+1]>=InfByte2) {
+                              t0=tbuf[im][iys][ixo][izo][0];
+                              t1=tbuf[im][iys+1][ixo][izo][0];
+
+                              if (ISINF4(t0,ks0,nxt) || ISINF4(t0,kg0,nxt) ||
+                                  ISINF4(t1,ks1,nxt) || ISINF4(t1,kg1,nxt)) {
                                     fprintf(gd->jpfp," skipped ixo=%d ",ixo);
                                     continue;
                               }
 
                               /*traveltime table at [iys][ixo][izo][nyt][nxt]*/
-                              tiys0=ys0b0*(xs0a0*tbuf[im][iys][ixo][izo][iyts0][ixts0]+
-                                           xs0a *tbuf[im][iys][ixo][izo][iyts0][ixts0+1])+
-			            ys0b *(xs0a0*tbuf[im][iys][ixo][izo][iyts0+1][ixts0]+
-                                           xs0a *tbuf[im][iys][ixo][izo][iyts0+1][ixts0+1]);
-
-                              tiyg0=yg0b0*(xg0a0*tbuf[im][iys][ixo][izo][iytg0][ixtg0]+
-                                           xg0a *tbuf[im][iys][ixo][izo][iytg0][ixtg0+1])+
-			            yg0b *(xg0a0*tbuf[im][iys][ixo][izo][iytg0+1][ixtg0]+
-                                           xg0a *tbuf[im][iys][ixo][izo][iytg0+1][ixtg0+1]);
+                              tiys0=BILIN(t0,ks0,nxt,ys0b0,ys0b,xs0a0,xs0a);
+                              tiyg0=BILIN(t0,kg0,nxt,yg0b0,yg0b,xg0a0,xg0a);
 
                               /*traveltime table at [iys+1][ixo][izo][nyt][nxt]*/
-                              tiys1=ys1b0*(xs1a0*tbuf[im][iys+1][ixo][izo][iyts1][ixts1]+
-                                           xs1a *tbuf[im][iys+1][ixo][izo][iyts1][ixts1+1])+
-			            ys1b *(xs1a0*tbuf[im][iys+1][ixo][izo][iyts1+1][ixts1]+
-                                       xs1a *tbuf[im][iys+1][ixo][izo][iyts1+1][ixts1+1]);
-
-                              tiyg1=yg1b0*(xg1a0*tbuf[im][iys+1][ixo][izo][iytg1][ixtg1]+
-                                           xg1a *tbuf[im][iys+1][ixo][izo][iytg1][ixtg1+1])+
-			            yg1b *(xg1a0*tbuf[im][iys+1][ixo][izo][iytg1+1][ixtg1]+
-                                        xg1a *tbuf[im][iys+1][ixo][izo][iytg1+1][ixtg1+1]);
+                              tiys1=BILIN(t1,ks1,nxt,ys1b0,ys1b,xs1a0,xs1a);
+                              tiyg1=BILIN(t1,kg1,nxt,yg1b0,yg1b,xg1a0,xg1a);
                               ts=(ybeta0*tiys0+ybeta*tiys1)/(float)InfByte2*InfTime;
                               tg=(ybeta0*tiyg0+ybeta*tiyg1)/(float)InfByte2*InfTime;
                         
@@ -1275,9 +1479,9 @@ float *trf  filtered and phase-shifted seismic trace
 Author: CWP: Zhaobo Meng, Sept 1997
 ***********************************************************************/
 {
-      static int nfft=0; 
-      static int itaper, nw, nwf;
-      static float *taper, *amp, *ampi, dw;
+      CSEIS_SU_THREAD_LOCAL int nfft=0; 
+      CSEIS_SU_THREAD_LOCAL int itaper, nw, nwf;
+      CSEIS_SU_THREAD_LOCAL float *taper, *amp, *ampi, dw;
 
       int  it, iw, itemp;
       float temp, ftaper, const2, *rt;
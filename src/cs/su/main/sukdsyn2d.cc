@@ -136,7 +136,7 @@ void maketrace(float *trace,int nt,float ft,float dt,
 #define NHD 1+2*LHD
 
 /* segy trace */
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sukdsyn2d( void* args )
 {
@@ -583,8 +583,8 @@ trace		array[nt] containing synthetic seismogram
 	      odt=1.0/dt,pd,az,sz,sz0,at,td,res,temp;
 	float *zpt,**ampt,**ampti,**zmt,*amp,*ampi,*zm,*tzt,*work1;
 	int lhd=LHD,nhd=NHD;
-	static float hd[NHD];
-	static int madehd=0;
+	CSEIS_SU_THREAD_LOCAL float hd[NHD];
+	CSEIS_SU_THREAD_LOCAL int madehd=0;
 
 	/* if half-derivative filter not yet made, make it */
 	if (!madehd) {
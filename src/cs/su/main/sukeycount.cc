@@ -56,7 +56,7 @@ namespace sukeycount {
  */
 /**************** end self doc ***********************************/
 
-segy tr ;
+CSEIS_SU_THREAD_LOCAL segy tr ;
 
 void* main_sukeycount( void* args )
 {
@@ -80,7 +80,7 @@ namespace sukfilter {
 /* prototype of function used internally */
 void polygonalFilter(float *f, float *amps, int npoly,
 				int nfft, float dt, float *filter);
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sukfilter( void* args )
 {
@@ -108,7 +108,7 @@ namespace sukfrac {
 #define TWOPI	(2.0 * PI)
 #define SQRT2	(sqrt(2.0))
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sukfrac( void* args )
 {
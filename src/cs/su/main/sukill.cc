@@ -50,7 +50,7 @@ namespace sukill {
 /**************** end self doc ***********************************/
 
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sukill( void* args )
 {
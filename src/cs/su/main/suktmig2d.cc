@@ -82,8 +82,8 @@ namespace suktmig2d {
 /* Prototype of functions used internally */
 void lpfilt(int nfc, int nfft, float dt, float fhi, float *filter);
 
-segy intrace; 	/* input traces */
-segy outtrace;	/* migrated output traces */
+CSEIS_SU_THREAD_LOCAL segy intrace; 	/* input traces */
+CSEIS_SU_THREAD_LOCAL segy outtrace;	/* migrated output traces */
 
 void* main_suktmig2d( void* args )
 {
@@ -73,7 +73,7 @@ namespace sulcthw {
 #define PP180 0.017453292
 
 /* Segy data */
-segy tr;				/* SEGY trace */
+CSEIS_SU_THREAD_LOCAL segy tr;				/* SEGY trace */
 
 /* type defined to store coordinates */
 typedef struct {
@@ -66,7 +66,7 @@ namespace sulhead {
 /**************** end self doc ********************************/
 
 /* Segy data constants */
-segy tr;				/* SEGY trace */
+CSEIS_SU_THREAD_LOCAL segy tr;				/* SEGY trace */
 
 /* function prototype of subroutine used internally */
 Value *setval_f_i( cwp_String type, int a);
@@ -214,7 +214,7 @@ catch( cseis_geolib::csException& exc ) {
 Value *setval_f_i( cwp_String type, int a)
 /* set value form integer */
 {
-	 static  Value val;
+	 CSEIS_SU_THREAD_LOCAL  Value val;
 	switch (*type) {
 	case 's':
 		throw cseis_geolib::csException("can't set char header word");
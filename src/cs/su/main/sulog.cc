@@ -76,7 +76,7 @@ int nextpower(int p, int n); /* function for padding to power of 2 */
 void stretch(float *q, float *p, float *w, int *it, int lq, int nw);
 void lintrp(float *q, float *w, int *it, int lp, int lq);
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sulog( void* args )
 {
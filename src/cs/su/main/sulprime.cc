@@ -68,7 +68,7 @@ namespace sulprime {
 
 static void dobackus(int navg, int nz, float *p, float *avg);
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sulprime( void* args )
 {
@@ -88,12 +88,12 @@ namespace sultt {
 
 
 /* Global variables */
-segy in_S11_tr, out_S11_tr;
-segy in_S12_tr, out_S12_tr;
-segy in_S21_tr, out_S21_tr;
-segy in_S22_tr, out_S22_tr;
-segy alpha_tr, theta_tr;
-segy gamma_tr;
+CSEIS_SU_THREAD_LOCAL segy in_S11_tr, out_S11_tr;
+CSEIS_SU_THREAD_LOCAL segy in_S12_tr, out_S12_tr;
+CSEIS_SU_THREAD_LOCAL segy in_S21_tr, out_S21_tr;
+CSEIS_SU_THREAD_LOCAL segy in_S22_tr, out_S22_tr;
+CSEIS_SU_THREAD_LOCAL segy alpha_tr, theta_tr;
+CSEIS_SU_THREAD_LOCAL segy gamma_tr;
 
 /* function prototypes */
 
@@ -88,7 +88,7 @@ namespace sumax {
 /**************** end self doc ***********************************/
 
 
-segy   tr;
+CSEIS_SU_THREAD_LOCAL segy   tr;
 
 void* main_sumax( void* args )
 {
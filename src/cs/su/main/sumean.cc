@@ -58,7 +58,7 @@ namespace sumean {
 
 
 /* Globals */
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sumean( void* args )
 {
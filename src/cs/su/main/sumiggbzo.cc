@@ -116,7 +116,7 @@ static void miggbzo (float bwh, float fmin, float fmax, float amin, float amax,
 	int nt, float dt, int nx, float dx, int nz, float dz, 
 	float **f, float **v, float **g, int verbose);
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sumiggbzo( void* args )
 {
@@ -867,19 +867,19 @@ ddv/dxdx and ddv/dzdz are discontinuous.
 #define LTABLE 4
 
 /* table of pre-computed interpolators, for 0th, 1st, and 2nd derivatives */
-static float tbl[3][NTABLE][LTABLE];
+CSEIS_SU_THREAD_LOCAL float tbl[3][NTABLE][LTABLE];
 
 /* constants */
-static int ix=1-LTABLE/2-LTABLE,iz=1-LTABLE/2-LTABLE;
-static float ltable=LTABLE,ntblm1=NTABLE-1;
+CSEIS_SU_THREAD_LOCAL int ix=1-LTABLE/2-LTABLE,iz=1-LTABLE/2-LTABLE;
+CSEIS_SU_THREAD_LOCAL float ltable=LTABLE,ntblm1=NTABLE-1;
 
 /* indices for 0th, 1st, and 2nd derivatives */
-static int kx[6]={0,1,0,2,1,0};
-static int kz[6]={0,0,1,0,1,2};
+CSEIS_SU_THREAD_LOCAL int kx[6]={0,1,0,2,1,0};
+CSEIS_SU_THREAD_LOCAL int kz[6]={0,0,1,0,1,2};
 
 /* function to build interpolator tables; sets tabled=1 when built */
 static void buildTables (void);
-static int tabled=0;
+CSEIS_SU_THREAD_LOCAL int tabled=0;
 
 /* interpolator for velocity function v(x,z) of two variables */
 typedef struct Vel2Struct {
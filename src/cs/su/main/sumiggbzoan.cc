@@ -140,7 +140,7 @@ static void miggbzoaniso(float bwh, float fmin, float fmax,
 				float **a3313, float **f, float **g,
 				int verbose);
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sumiggbzoan( void* args )
 {
@@ -2562,19 +2562,19 @@ Technical Reference:
 #define LTABLE 4
 
 /* table of pre-computed interpolators, for 0th, 1st, and 2nd derivatives */
-static float tbl[3][NTABLE][LTABLE];
+CSEIS_SU_THREAD_LOCAL float tbl[3][NTABLE][LTABLE];
 
 /* constants */
-static int ix=1-LTABLE/2-LTABLE,iz=1-LTABLE/2-LTABLE;
-static float ltable=LTABLE,ntblm1=NTABLE-1;
+CSEIS_SU_THREAD_LOCAL int ix=1-LTABLE/2-LTABLE,iz=1-LTABLE/2-LTABLE;
+CSEIS_SU_THREAD_LOCAL float ltable=LTABLE,ntblm1=NTABLE-1;
 
 /* indices for 0th, 1st, and 2nd derivatives */
-static int kx[6]={0,1,0,2,1,0};
-static int kz[6]={0,0,1,0,1,2};
+CSEIS_SU_THREAD_LOCAL int kx[6]={0,1,0,2,1,0};
+CSEIS_SU_THREAD_LOCAL int kz[6]={0,0,1,0,1,2};
 
 /* function to build interpolator tables; sets tabled=1 when built */
 static void buildTables (void);
-static int tabled=0;
+CSEIS_SU_THREAD_LOCAL int tabled=0;
 
 /* interpolator for velocity function v(x,z) of two variables */
 typedef struct Vel2Struct {
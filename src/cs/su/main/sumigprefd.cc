@@ -110,7 +110,7 @@ void retris(complex *data,complex *a,complex *c,complex *b,complex
 void fdmig(complex **cp, int nx, int nw, float *v,float fw,float
 		dw,float dz,float dx,float dt,int dip);
 void get_sx_gx(float *sx, float *gx);
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 
 
@@ -103,7 +103,7 @@ void fdmig( complex **cp, int nx, int nw, float *v,float fw,float
 		dw,float dz,float dx,float dt,float vc,int dip);
 void get_sx_gx(float *sx, float *gx);
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sumigpreffd( void* args )
 {
@@ -102,7 +102,7 @@ namespace sumigprepspi {
  float *ricker(float Freq,float dt,int *Npoint);
  void get_sx_gx(float *sx, float *gx);
 
-segy tr, tro;
+CSEIS_SU_THREAD_LOCAL segy tr, tro;
 
 void* main_sumigprepspi( void* args )
  {
@@ -99,7 +99,7 @@ float *ricker(float Freq,float dt,int *Npoint);
 void get_sx_gx(float *sx, float *gx);
 
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 /* static time_t t1,t2; */
 
@@ -95,12 +95,12 @@ TATable *tableta (int np, int ntau, float dtau, float vtau[],
 static void closefiles(void);
 
 /* Globals (so can trap signal) defining temporary disk files */
-char tracefile[BUFSIZ];	/* filename for the file of traces	*/
-char headerfile[BUFSIZ];/* filename for the file of headers	*/
-FILE *tracefp;		/* fp for trace storage file		*/
-FILE *headerfp;		/* fp for header storage file		*/
+CSEIS_SU_THREAD_LOCAL char tracefile[BUFSIZ];	/* filename for the file of traces	*/
+CSEIS_SU_THREAD_LOCAL char headerfile[BUFSIZ];/* filename for the file of headers	*/
+CSEIS_SU_THREAD_LOCAL FILE *tracefp;		/* fp for trace storage file		*/
+CSEIS_SU_THREAD_LOCAL FILE *headerfp;		/* fp for header storage file		*/
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sumigps( void* args )
 {
@@ -338,8 +338,8 @@ cq		array[ntau] of migrated data
 		ampi,phsi,phsn,
 		*p,*taumax,*taumin,*tturn,**t,**a;
 	complex *pt,*pw,*qn,*qt;
-	static int tabbed=0;
-	static float fntab,*ctab,*stab,opi2=1.0/(PI*2.0);
+	CSEIS_SU_THREAD_LOCAL int tabbed=0;
+	CSEIS_SU_THREAD_LOCAL float fntab,*ctab,*stab,opi2=1.0/(PI*2.0);
 
 	/* if not already built, build cosine/sine tables */
 	if (!tabbed) {
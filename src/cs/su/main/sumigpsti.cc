@@ -90,7 +90,7 @@ TATable *tableta (int np, int ntau, float dtau, float a3333[],
 	float a1111[], float a1133[], float a1313[],
 	int nt, float dt, int verbose);
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sumigpsti( void* args )
 {
@@ -374,8 +374,8 @@ cq		array[ntau] of migrated data
 		ampi,phsi,phsn,
 		*p,*taumax,*taumin,*tturn,**t,**a;
 	complex *pt,*pw,*qn,*qt;
-	static int tabbed=0;
-	static float fntab,*ctab,*stab,opi2=1.0/(PI*2.0);
+	CSEIS_SU_THREAD_LOCAL int tabbed=0;
+	CSEIS_SU_THREAD_LOCAL float fntab,*ctab,*stab,opi2=1.0/(PI*2.0);
 
 	/* if not already built, build cosine/sine tables */
 	if (!tabbed) {
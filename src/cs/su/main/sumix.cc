@@ -58,7 +58,7 @@ namespace sumix {
 #define VAL4	0.6
 
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sumix( void* args )
 {
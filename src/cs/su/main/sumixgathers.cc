@@ -56,7 +56,7 @@ namespace sumixgathers {
 
 /**************** end self doc ***********************************/
 
-segy tr,tr2; 
+CSEIS_SU_THREAD_LOCAL segy tr,tr2; 
 void* main_sumixgathers( void* args )
 {
 	int j,ih;
@@ -110,7 +110,7 @@ namespace sumute {
  */
 /**************** end self doc ***********************************/
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 
 #define SQ(x) ((x))*((x))
@@ -65,7 +65,7 @@ namespace sunan {
 
 /**************** end self doc ********************************/
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sunan( void* args )
 {
@@ -77,7 +77,7 @@ namespace sunhmospike {
 /**************** end self doc ***********************************/
 
 float gofx(int igopt, float offset, float intercept_off,float refdepth);
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sunhmospike( void* args )
 {
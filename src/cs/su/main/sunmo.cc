@@ -99,7 +99,7 @@ namespace sunmo {
 static void interpovv (int nt, int ncdp, float *cdp, 
 	float **ovv, float cdpt, float *ovvt );
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sunmo( void* args )
 {
@@ -388,7 +388,7 @@ catch( cseis_geolib::csException& exc ) {
 static void interpovv (int nt, int ncdp, float *cdp, float **ovv, 
 	float cdpt, float *ovvt)
 {
-	static int index=0;
+	CSEIS_SU_THREAD_LOCAL int index=0;
 	int it;
 	float a1,a2;
 
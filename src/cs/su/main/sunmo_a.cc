@@ -124,7 +124,7 @@ static void interpovv_a (int nt, int ncdp, float *cdp,
 	float **ovv, float **oa1, float **oa2, float cdpt, 
 	float *ovvt, float *oa1t, float *oa2t);
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sunmo_a( void* args )
 {
@@ -479,7 +479,7 @@ catch( cseis_geolib::csException& exc ) {
 static void interpovv_a (int nt, int ncdp, float *cdp, float **ovv, float **oa1, 
 	float **oa2, float cdpt, float *ovvt, float *oa1t, float *oa2t)
 {
-	static int indx=0;
+	CSEIS_SU_THREAD_LOCAL int indx=0;
 	int it;
 	float a1,a2;
 
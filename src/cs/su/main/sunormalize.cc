@@ -69,7 +69,7 @@ void rmvesq(float *r,float *rsq,int *n);
 void maxmgv(float *r,float *rmx,int *n);
 cwp_div_t cwp_div( int num, int denom);
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sunormalize( void* args )
 {
@@ -108,10 +108,10 @@ static void closefiles(void);
 
 
 /* Globals (so can trap signal) defining temporary disk files */
-char headerfile[BUFSIZ];/* filename for the file of headers	*/
-FILE *headerfp;		/* fp for header storage file		*/
+CSEIS_SU_THREAD_LOCAL char headerfile[BUFSIZ];/* filename for the file of headers	*/
+CSEIS_SU_THREAD_LOCAL FILE *headerfp;		/* fp for header storage file		*/
 
-segy tr,tro;
+CSEIS_SU_THREAD_LOCAL segy tr,tro;
 
 void* main_suocext( void* args )
 {
@@ -49,7 +49,7 @@ namespace suoldtonew {
 /**************** end self doc ***********************************/
 
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suoldtonew( void* args )
 {
@@ -72,7 +72,7 @@ void* main_suoldtonew( void* args )
 
 
 	while (!(feof(stdin) || ferror(stdin))) {
-		static int ntr=0; /* for user info only */
+		CSEIS_SU_THREAD_LOCAL int ntr=0; /* for user info only */
 
 		/* Do read of header for the segy */
 		if (0 >= efread(&tr, HDRBYTES, 1, stdin)) {
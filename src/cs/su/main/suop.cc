@@ -161,7 +161,7 @@ namespace suop {
 float mymedian(float *a, int nw);
 int floatcomp(const void* elem1, const void* elem2);
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suop( void* args )
 {
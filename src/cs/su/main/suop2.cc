@@ -118,7 +118,7 @@ namespace suop2 {
 #define	PTMUL	8
 #define	PTDIV	9
 
-segy intrace1, intrace2;
+CSEIS_SU_THREAD_LOCAL segy intrace1, intrace2;
 
 void* main_suop2( void* args )
 {
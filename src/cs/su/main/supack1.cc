@@ -64,7 +64,7 @@ namespace supack1 {
 
 #define GPOW	0.5	/* default power parameter */
 
-segy tr;	/* on  input: SEGY hdr & (float) trace data */
+CSEIS_SU_THREAD_LOCAL segy tr;	/* on  input: SEGY hdr & (float) trace data */
 		/* on output: data as signed chars          */
 
 void* main_supack1( void* args )
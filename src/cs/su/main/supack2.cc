@@ -64,7 +64,7 @@ namespace supack2 {
 
 #define GPOW	0.5	/* default power parameter */
 
-segy tr;	/* on  input: SEGY hdr & (float) trace data */
+CSEIS_SU_THREAD_LOCAL segy tr;	/* on  input: SEGY hdr & (float) trace data */
 		/* on output: data as 2-byte shorts          */
 
 void* main_supack2( void* args )
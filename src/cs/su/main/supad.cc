@@ -77,7 +77,7 @@ namespace supad {
  */
 /**************** end self doc ***********************************/
 
-segy tr, nulltr;
+CSEIS_SU_THREAD_LOCAL segy tr, nulltr;
 
 /* Prototypes */
 void assgnval(cwp_String type1, Value *valp1, double dval1);
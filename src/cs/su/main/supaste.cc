@@ -55,7 +55,7 @@ namespace supaste {
 /**************** end self doc ***********************************/
 
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_supaste( void* args )
 {
@@ -103,7 +103,7 @@ void* main_supaste( void* args )
 	/* trace giving the length of the trace in bytes*/
 	/* as per the Fortran unformatted record format.*/
 	while (!(feof(headfp) || ferror(headfp) || feof(stdin) || ferror(stdin))) {
-		static int ntr=0; /* for user info only */
+		CSEIS_SU_THREAD_LOCAL int ntr=0; /* for user info only */
 
 		/* Do read of header for the segy */
 		if (0 >= efread(&tr, HDRBYTES, 1, headfp)) {
@@ -152,7 +152,7 @@ namespace supef {
 
 
 
-segy intrace, outtrace;
+CSEIS_SU_THREAD_LOCAL segy intrace, outtrace;
 
 void* main_supef( void* args )
 {
@@ -389,7 +389,7 @@ void* main_supef( void* args )
 	jcdp = 0;
 	/* Main loop over traces */
 	do {
-		static int itr = 0;
+		CSEIS_SU_THREAD_LOCAL int itr = 0;
 		++itr;
 		
 		/* if neccessary, compute new filter parameters */
@@ -59,7 +59,7 @@ namespace supermute {
 /**************** end self doc ***********************************/
 
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_supermute( void* args )
 {
@@ -42,7 +42,7 @@ namespace supgc {
 
 /**************** end self doc ********************************/
 
-segy tr;	/* Input and output trace data of length nt */
+CSEIS_SU_THREAD_LOCAL segy tr;	/* Input and output trace data of length nt */
 void* main_supgc( void* args )
 {
 	FILE *fp;
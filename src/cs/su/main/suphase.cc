@@ -49,7 +49,7 @@ namespace suphase {
 #define PFA_MAX	720720	/* Largest allowed nfft	          */
 
 /* segy trace */
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suphase( void* args )
 {
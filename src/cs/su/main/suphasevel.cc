@@ -89,10 +89,10 @@ namespace suphasevel {
 static void closefiles(void);
 
 /* Globals (so can trap signal) defining temporary disk files */
-char tracefile[BUFSIZ];	/* filename for the file of traces	*/
-FILE *tracefp;		/* fp for trace storage file		*/
+CSEIS_SU_THREAD_LOCAL char tracefile[BUFSIZ];	/* filename for the file of traces	*/
+CSEIS_SU_THREAD_LOCAL FILE *tracefp;		/* fp for trace storage file		*/
 
-segy intrace, outtrace;
+CSEIS_SU_THREAD_LOCAL segy intrace, outtrace;
 
 void* main_suphasevel( void* args )
 {
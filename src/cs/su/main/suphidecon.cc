@@ -67,7 +67,7 @@ namespace suphidecon {
 #define PFA_MAX 720720  /* Largest allowed nfft	   */
 
 /* Segy data constants */
-segy tr;				/* SEGY trace */
+CSEIS_SU_THREAD_LOCAL segy tr;				/* SEGY trace */
 
 /* function prototype of routine used internally */
 int computePseudoCepstrum(int *nt,float *percpad, float *x,complex *c,int init);
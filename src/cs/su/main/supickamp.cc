@@ -99,7 +99,7 @@ namespace supickamp {
 #define dfprint(expr) printf(#expr " = %f\n",expr)
 #define ddprint(expr) printf(#expr " = %g\n",expr)
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 /* Pick parameterss */
 typedef struct PickStruct {
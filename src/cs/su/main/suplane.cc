@@ -73,7 +73,7 @@ namespace suplane {
 #define NPL	3
 
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suplane( void* args )
 {
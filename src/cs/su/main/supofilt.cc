@@ -77,7 +77,7 @@ namespace supofilt {
 /* prototypes of functions used internally */
 void do_smooth(float *data, int nt, int isl);
 
-segy tr,dtr,wtr;
+CSEIS_SU_THREAD_LOCAL segy tr,dtr,wtr;
 
 void* main_supofilt( void* args )
 {       
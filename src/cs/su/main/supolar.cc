@@ -149,7 +149,7 @@ void fputdata3c(FILE *fileptr, FILE *headerptr, float **outdata3c, int nt);
 #define WWELSH 3
 
 
-segy tr;                /* SEG-Y record (trace and header) */
+CSEIS_SU_THREAD_LOCAL segy tr;                /* SEG-Y record (trace and header) */
 
 void* main_supolar( void* args )
 {
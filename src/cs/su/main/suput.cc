@@ -49,7 +49,7 @@ namespace suput {
 
 void fputtrn(FILE *fp, segy *tp);
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 void* main_suput( void* args )
 {
 	FILE *fp;
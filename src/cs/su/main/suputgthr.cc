@@ -69,8 +69,8 @@ namespace suputgthr {
 /**************** end self doc ***********************************/
 
 
-segy intrace;
-segy tmptr;
+CSEIS_SU_THREAD_LOCAL segy intrace;
+CSEIS_SU_THREAD_LOCAL segy tmptr;
 
 void* main_suputgthr( void* args )
 {
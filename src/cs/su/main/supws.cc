@@ -84,7 +84,7 @@ namespace supws {
 void do_smooth(float *data, int nt, int isl);
 
 
-segy intr, outtr;
+CSEIS_SU_THREAD_LOCAL segy intr, outtr;
 
 void* main_supws( void* args )
 {
@@ -63,12 +63,12 @@ int cmp_indirect(int *r, int *s);
 static void closefiles(void);
 
 /* Globals (so can trap signal) defining temporary disk files */
-char tracefile[BUFSIZ];	/* filename for the file of traces	*/
-FILE *tracefp;		/* fp for trace storage file		*/
+CSEIS_SU_THREAD_LOCAL char tracefile[BUFSIZ];	/* filename for the file of traces	*/
+CSEIS_SU_THREAD_LOCAL FILE *tracefp;		/* fp for trace storage file		*/
 
-float *data;		/* the data; global to use system qsort */
+CSEIS_SU_THREAD_LOCAL float *data;		/* the data; global to use system qsort */
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suquantile( void* args )
 {
@@ -9,6 +9,7 @@
 #include "csSUGetPars.h"
 #include "su_complex_declarations.h"
 #include "cseis_sulib.h"
+#include "csThreadPool.h"
 #include <string>
 
 extern "C" {
@@ -58,6 +59,11 @@ std::string sdoc_suradon =
 " offkey=offset   name of header word with spatial information		"
 " nxmax=240       maximum number of input traces per ensemble		"
 " ltaper=7	  taper (integer) for mute tapering function		"
+" nthreads=1      number of threads for the frequency loops		"
+" ncache=0        number of offset geometries for which the Toeplitz	"
+"                 systems of all frequencies are kept in memory		"
+"                 (=0 to recompute them for every ensemble)		"
+"                 See NCACHE notes below before increasing this value	"
 "									"
 " Optimizing Parameters:						"
 " The following parameters are occasionally used to avoid spatial aliasing"
@@ -98,6 +104,24 @@ namespace suradon {
  * 	and subtract the multiples.  See the May, 1993 CWP Project
  *	Review for more extensive documentation.
  *
+ * NTHREADS notes:
+ *	All frequencies are transformed independently, and are shared
+ *	among nthreads threads.  Output does not depend on nthreads.
+ *
+ * NCACHE notes:
+ *	The Toeplitz system of one frequency only depends on the offsets
+ *	of the ensemble.  For the ncache most recent offset geometries,
+ *	the systems and their Levinson factorisations are kept, so that
+ *	ensembles with a repeated geometry only pay for the back
+ *	substitution.  This only helps if the offsets of many ensembles
+ *	are exactly identical, for example for synthetic data or
+ *	regularised marine gathers.  Irregular land geometries never hit
+ *	the cache, and only pay for the memory.
+ *	Per geometry, roughly 4*np*np*nwin bytes are needed for each
+ *	frequency below f2, where np is the number of p values.  For
+ *	example, np=200, nwin=1, 4ms sampling, 1024 samples and f2=80 Hz
+ *	need about 50MB per geometry.  Output does not depend on ncache.
+ *
  * NWIN notes:
  *	The parabolic transform runs with higher resolution if the
  * 	mute zone is honored.  When "nwin" is specified larger than
@@ -140,19 +164,102 @@ namespace suradon {
  */
 /**************** end self doc ********************************/
 
+/* Toeplitz system of one frequency and one offset window */
+typedef struct RadonSystemStruct {
+	int isset;	/* =1 if system has been computed		*/
+	int cg;		/* =1 solve by conjugate gradients, =0 Levinson	*/
+	int nlev;	/* number of completed Levinson iterations	*/
+	complex *r;	/* top row of prewhitened Toeplitz matrix	*/
+	complex *f;	/* spiking filters of all Levinson iterations	*/
+	float *v;	/* (vr,vi,vsq) of all Levinson iterations	*/
+} RadonSystem;
+
+/* Toeplitz systems of all frequencies for one offset geometry */
+typedef struct RadonGeometryStruct {
+	int nx;		/* number of spatial positions			*/
+	float *g;	/* g[nx] spatial function			*/
+	int np;
+	int nk;
+	int ntfft;
+	float dt;
+	float dp;
+	float prewhite;
+	RadonSystem *sys;	/* sys[iw*nk+k]: frequency iw, window k	*/
+	struct RadonGeometryStruct *next;
+} RadonGeometry;
+
+/* cache of offset geometries, most recently used first */
+typedef struct RadonCacheStruct {
+	int nmax;	/* maximum number of geometries			*/
+	RadonGeometry *first;
+} RadonCache;
+
+/* arguments of the forward frequency loop */
+typedef struct ForwardArgsStruct {
+	VND *vndb;		/* input spectra, output if nk==1	*/
+	VND *vndc;		/* output tau-p spectra			*/
+	int nx;
+	int np;
+	int nk;
+	int nxxinc;
+	size_t ncrt;		/* length of input frequency slice	*/
+	size_t nccrt;		/* length of output frequency slice	*/
+	float *g;
+	float pmin;
+	float dp;
+	float df;
+	float dw;
+	float f1;
+	float f2;
+	float prewhite;
+	RadonGeometry *geom;	/* cached systems, NULL if no cache	*/
+	pthread_mutex_t *mutex;	/* guards VND access and error flag	*/
+	int error;
+} ForwardArgs;
+
+/* arguments of the inverse frequency loop */
+typedef struct InverseArgsStruct {
+	VND *vnda;
+	int nx;
+	int np;
+	int ip1;
+	size_t ncrt;		/* length of frequency slice		*/
+	float *g;
+	float pmin;
+	float dp;
+	float df;
+	float dw;
+	float f1;
+	float f2;
+	pthread_mutex_t *mutex;	/* guards VND access and error flag	*/
+	int error;
+} InverseArgs;
+
 static void forward_p_transform(VND *vnda,VND *vndb,int nx, int nt, float *g,
 	float dt, int ntfft, int np, float pmin, float dp,
 	float *mutetime, float *offset, int nk,float f1,
-	float f2,float prewhite);
+	float f2,float prewhite, RadonCache *cache,
+	cseis_geolib::csThreadPool *pool);
+static void forward_freqs(int iwf, int iwl, void *data);
 
 static void inverse_p_transform(VND *vnda,int nx, float *g,
 	float dt, int ntfft, int np, float pmin, float dp, int ip1,
-	float f1,float f2);
+	float f1,float f2, cseis_geolib::csThreadPool *pool);
+static void inverse_freqs(int iwf, int iwl, void *data);
+static void run_freqs(cseis_geolib::csThreadPool *pool,
+	void (*func)(int iwf, int iwl, void *data), void *data, int nw);
+static RadonGeometry *radon_cache_get(RadonCache *cache, int nx, float *g,
+	int np, int nk, int ntfft, float dt, float dp, float prewhite);
+static void radon_cache_free(RadonCache *cache);
+static void radon_geometry_free(RadonGeometry *geom);
+static int radon_system_set(float w, int nx, float *g, int np, float dp,
+		float prewhite, RadonSystem *sys, complex *f, complex *wrk);
+static void radon_system_free(RadonSystem *sys);
 static void compute_r(float w, int nx, float *g, int np, float dp, complex *r);
 static void compute_rhs(float w, int nx, float *g, complex *data, int np,
 		float pmin, float dp, complex *rhs);
-static int ctoep(int n, complex *r, complex *a, complex *b,
-		complex *f, complex *wrk);
+static void ctoep_factor(int n, RadonSystem *sys, complex *f, complex *wrk);
+static void ctoep_solve(int n, RadonSystem *sys, complex *a, complex *b);
 static int ctoephcg(int niter, int n, complex *r, complex *a, complex *b,
 		complex *wrk1, complex *wrk2, complex *wrk3, complex *wrk4 );
 static float rcdot(int n, complex *a, complex *b);
@@ -166,8 +273,8 @@ static void jea_xinterpolate(VND *vndorig, VND *vndinterp, int ninterp,
 		int lent, int lenx, int xopt, float dt, int iopt);
 static void runav(int n,int len,float *a,float *b);
 
-segy tr;
-segy tro;
+CSEIS_SU_THREAD_LOCAL segy tr;
+CSEIS_SU_THREAD_LOCAL segy tro;
 void* main_suradon( void* args )
 {
 	char *cdpkey=NULL;	/* key denoting the ensemble */
@@ -201,6 +308,8 @@ void* main_suradon( void* args )
 	int nk;
 	int igopt;
 	int ltaper;
+	int nthreads;
+	int ncache;
 	int cdpindex;
 	int offindex;
 	int iend;
@@ -233,6 +342,8 @@ void* main_suradon( void* args )
 	VND *vndorig=NULL;
 	VND *vndinterp=NULL;
 	VND *vndresult=NULL;
+	RadonCache cache;	/* Toeplitz systems of recent geometries */
+	cseis_geolib::csThreadPool *pool=NULL;	/* NULL: single thread */
 
 	cseis_su::csSUArguments* suArgs = (cseis_su::csSUArguments*)args;
 	cseis_su::csSUTraceManager* cs2su = suArgs->cs2su;
@@ -245,6 +356,8 @@ void* main_suradon( void* args )
 	su2cs->setSUDoc( sdoc_suradon );
 	if( su2cs->isDocRequestOnly() ) return retPtr;
 	parObj.initargs(argc, argv);
+	cache.nmax=0;
+	cache.first=NULL;
 
 	try {  /* Try-catch block encompassing the main function body */
 
@@ -275,6 +388,8 @@ void* main_suradon( void* args )
 	if (!parObj.getparfloat("interoff",&intercept_off)) intercept_off=0.;
 	if (!parObj.getparfloat("prewhite",&prewhite)) prewhite=0.1;
 	if (!parObj.getparint("ltaper",&ltaper)) ltaper=7;
+	if (!parObj.getparint("nthreads",&nthreads)) nthreads=1;
+	if (!parObj.getparint("ncache",&ncache)) ncache=0;
 
 
         parObj.checkpars();
@@ -292,6 +407,10 @@ void* main_suradon( void* args )
 	ipb=( pmulb -  pmin)/ dp;
 	np=1+( pmax -  pmin)/ dp;
 	if(np<1)throw cseis_geolib::csException("Range of PMIN and PMAX invalid");
+	if(nthreads<1) throw cseis_geolib::csException("nthreads must be positive");
+	if(ncache<0) ncache=0;
+	cache.nmax=ncache;
+	if(nthreads>1) pool = new cseis_geolib::csThreadPool(nthreads);
 	if(choose==0) ipa=0;
 	if(choose==3) ipa=0;
 	if(choose==4) ipa=0;
@@ -388,7 +507,8 @@ void* main_suradon( void* args )
 				forward_p_transform( vndinterp,
 					 vndresult, nxinterp,nt,gg,dt,
 					 ntfft,np,pmin,dp,mutetime,
-					 offset,nk,f1,f2,prewhite);
+					 offset,nk,f1,f2,prewhite,
+					 (ncache>0) ? &cache : NULL,pool);
 				nxout= np;
 			}
 			if(choose>=1) {
@@ -405,7 +525,7 @@ void* main_suradon( void* args )
 				}
 				inverse_p_transform( vndresult, nx,
 					 g, dt, ntfft, np,
-					 pmin, dp, ipa, f1, f2);
+					 pmin, dp, ipa, f1, f2, pool);
 				if(choose==1){
 				    for(ix=0;ix< nx;ix++) {
 					V2Dr0( vndorig,ix,(char *)trace,1005);
@@ -484,6 +604,8 @@ void* main_suradon( void* args )
 	VNDcl(vndorig,1);
 	VNDcl(vndinterp,1);
 	VNDcl(vndresult,1);
+	radon_cache_free(&cache);
+	if( pool != NULL ) delete pool;
 	if(VNDtotalmem()!=0) {
 		fprintf(stderr,"Warning, not all of the VND memory \n");
 		fprintf(stderr,"has been freed and checked for overruns\n");
@@ -495,6 +617,8 @@ void* main_suradon( void* args )
 	return retPtr;
 }
 catch( cseis_geolib::csException& exc ) {
+  radon_cache_free(&cache);
+  if( pool != NULL ) delete pool;
   su2cs->setError("%s",exc.getMessage());
   pthread_exit(NULL);
   return retPtr;
@@ -504,7 +628,8 @@ catch( cseis_geolib::csException& exc ) {
 static void forward_p_transform(VND *vnda,VND *vndb,int nx, int nt, float *g,
 	float dt, int ntfft, int np, float pmin, float dp,
 	float *mutetime, float *offset, int nk,float f1, float f2,
-	float prewhite)
+	float prewhite, RadonCache *cache,
+	cseis_geolib::csThreadPool *pool)
 /*******************************************************************
 do forward generalized radon transform
 
@@ -528,18 +653,22 @@ int nk          number of offset ranges to transform separately
 float f1        max freq without taper
 float f2        max non-zero freq component
 prewhite	0.01 means prewhiten 1 percent
+RadonCache *cache  Toeplitz systems of previous ensembles (NULL: no cache)
+csThreadPool *pool  worker threads for the frequency loop (NULL: none)
 
 key assumption: offsets are sorted to increase with index
 *******************************************************************
 Author: John Anderson (visitor to CSM from Mobil) Spring 1993
 *******************************************************************/
 {
-	int ix,ip,it,iw,j,ntfftny,k,nxx,nxxinc,ik,ik2;
+	int ix,ip,it,j,ntfftny,k,nxx,nxxinc,ik,ik2;
 	size_t nmax;
-	float *rt=NULL,*rrt=NULL,*kindex=NULL,*tindex=NULL,w,dw,rsum,fac,wa,wb,rk[2],rit[2],df;
-	complex czero,*crt=NULL,*ccrt=NULL,*r=NULL,*rhs=NULL,*wrk1=NULL,*wrk2=NULL,*wrk3=NULL,*wrk4=NULL;
+	float *rt=NULL,*rrt=NULL,*kindex=NULL,*tindex=NULL,dw,fac,wa,wb,rk[2],rit[2],df;
+	complex *crt=NULL,*ccrt=NULL;
 	VND *vndc=NULL;
 	char *fname=NULL;
+	pthread_mutex_t mutex;
+	ForwardArgs fargs;
 
 	fac=1./ntfft;
 	ntfftny=1+ntfft/2;
@@ -547,7 +676,6 @@ Author: John Anderson (visitor to CSM from Mobil) Spring 1993
 	dw=2.*PI*df;
 	nmax=MAX(vndb->N[0],vndb->N[1]);
 	nxxinc=1+(nx-1)/nk;
-	czero.r=czero.i=0.;
 
 	if(nk>1) {
 /* allocate file space and build a set of (mute time, group index) pairs */
@@ -575,18 +703,6 @@ Author: John Anderson (visitor to CSM from Mobil) Spring 1993
 	ccrt=(complex *)VNDemalloc(MAX((nk+1)*np,vndb->N[1])*sizeof(complex),
 		"forward_transform:ccrt");
 	rrt=(float *)ccrt;
-	r=(complex *)VNDemalloc(np*sizeof(complex),
-		"forward_p_transform:r");
-	rhs=(complex *)VNDemalloc(np*sizeof(complex),
-		"forward_p_transform:rhs");
-	wrk1=(complex *)VNDemalloc(np*sizeof(complex),
-		"forward_p_transform:wrk1");
-	wrk2=(complex *)VNDemalloc(np*sizeof(complex),
-		"forward_p_transform:wrk2");
-	wrk3=(complex *)VNDemalloc(np*sizeof(complex),
-		"forward_p_transform:wrk3");
-	wrk4=(complex *)VNDemalloc(np*sizeof(complex),
-		"forward_p_transform:wrk4");
 
 
 /* do forward time to frequency fft */
@@ -600,34 +716,32 @@ Author: John Anderson (visitor to CSM from Mobil) Spring 1993
 	VNDr2c(vndb);
 
 /* do radon transform, frequency by frequency, for multiple spatial windows */
-	for(iw=0;iw<ntfftny;iw++) {
-		wa=freqweight(iw,df,f1,f2);
-		if(wa>0.) {
-		    w=iw*dw;
-		    V2Dr1(vndb,iw,(char *)crt,203);
-		    if(wa<1.) {
-		    	for(ix=0;ix<nx;ix++) crt[ix]=crmul(crt[ix],wa);
-		    }
-		    for(k=0;k<nk;k++) {
-			nxx=MIN(nx,(k+1)*nxxinc);
-			compute_rhs(w,nxx,g,crt,np,pmin,dp,rhs);
-			compute_r(w,nxx,g,np,dp,r);
-			r[0].r *= (1.+prewhite);
-			for(rsum=0.,j=1;j<np;j++)
-				rsum +=sqrt(r[j].r*r[j].r + r[j].i*r[j].i);
-			rsum=rsum/r[0].r;
-			if (rsum>1.+np/5) {
-				j=ctoephcg(np/7,np,r,&ccrt[k*np],rhs,
-					wrk1,wrk2,wrk3,wrk4);
-			}else{
-				j=ctoep(np,r,&ccrt[k*np],rhs,wrk1,wrk2);
-			}
-		    }
-		}else{
-		    for(ip=0;ip<np*nk;ip++) ccrt[ip]=czero;
-		}
-		V2Dw1(vndc,iw,(char *)ccrt,204);
-	}
+	pthread_mutex_init(&mutex,NULL);
+	fargs.vndb=vndb;
+	fargs.vndc=vndc;
+	fargs.nx=nx;
+	fargs.np=np;
+	fargs.nk=nk;
+	fargs.nxxinc=nxxinc;
+	fargs.ncrt=nmax;
+	fargs.nccrt=MAX((nk+1)*np,vndb->N[1]);
+	fargs.g=g;
+	fargs.pmin=pmin;
+	fargs.dp=dp;
+	fargs.df=df;
+	fargs.dw=dw;
+	fargs.f1=f1;
+	fargs.f2=f2;
+	fargs.prewhite=prewhite;
+	fargs.geom=NULL;
+	if(cache!=NULL) fargs.geom=radon_cache_get(cache,nx,g,np,nk,
+				ntfft,dt,dp,prewhite);
+	fargs.mutex=&mutex;
+	fargs.error=0;
+	run_freqs(pool,forward_freqs,&fargs,ntfftny);
+	pthread_mutex_destroy(&mutex);
+	if(fargs.error) throw cseis_geolib::csException(
+		"forward_p_transform: cannot allocate work space");
 
 /* do fourier transform from frequency to tau */
 	for(ip=0;ip<np*nk;ip++) {
@@ -660,14 +774,89 @@ Author: John Anderson (visitor to CSM from Mobil) Spring 1993
 	}
 	VNDfree(crt,"forward_p_transform: crt");
 	VNDfree(ccrt,"forward_p_transform: ccrt");
-	VNDfree(r,"forward_p_transform: r");
-	VNDfree(rhs,"forward_p_transform: rhs");
-	VNDfree(wrk1,"forward_p_transform: wrk1");
-	VNDfree(wrk2,"forward_p_transform: wrk2");
-	VNDfree(wrk3,"forward_p_transform: wrk3");
-	VNDfree(wrk4,"forward_p_transform: wrk4");
 	return;
 }
+
+static void forward_freqs(int iwf, int iwl, void *data)
+/*******************************************************************
+forward radon transform of frequencies iwf to iwl (inclusive)
+******************************************************************
+Called from several threads at once.  Work arrays are private to the
+call, each system of the cached geometry is only touched by the call
+that owns its frequency.
+*******************************************************************/
+{
+	ForwardArgs *fa=(ForwardArgs *)data;
+	int ix,iw,k,nxx;
+	int nx=fa->nx,np=fa->np,nk=fa->nk;
+	size_t i;
+	float w,wa;
+	complex czero,*work=NULL,*crt,*ccrt,*rhs,*wrk1,*wrk2,*wrk3,*wrk4;
+	complex *f,*fwrk;
+	RadonSystem tmpsys,*sys;
+
+	czero.r=czero.i=0.;
+	tmpsys.r=tmpsys.f=NULL;
+	tmpsys.v=NULL;
+	work=alloc1complex(fa->ncrt+fa->nccrt+7*np);
+	if(work==NULL) {
+		pthread_mutex_lock(fa->mutex);
+		fa->error=1;
+		pthread_mutex_unlock(fa->mutex);
+		return;
+	}
+	crt=work;
+	ccrt=crt+fa->ncrt;
+	rhs=ccrt+fa->nccrt;
+	wrk1=rhs+np;
+	wrk2=wrk1+np;
+	wrk3=wrk2+np;
+	wrk4=wrk3+np;
+	f=wrk4+np;
+	fwrk=f+np;
+
+	for(iw=iwf;iw<=iwl;iw++) {
+		for(i=0;i<fa->nccrt;i++) ccrt[i]=czero;
+		wa=freqweight(iw,fa->df,fa->f1,fa->f2);
+		if(wa>0.) {
+		    w=iw*fa->dw;
+		    pthread_mutex_lock(fa->mutex);
+		    V2Dr1(fa->vndb,iw,(char *)crt,203);
+		    pthread_mutex_unlock(fa->mutex);
+		    if(wa<1.) {
+		    	for(ix=0;ix<nx;ix++) crt[ix]=crmul(crt[ix],wa);
+		    }
+		    for(k=0;k<nk;k++) {
+			nxx=MIN(nx,(k+1)*fa->nxxinc);
+			compute_rhs(w,nxx,fa->g,crt,np,fa->pmin,fa->dp,rhs);
+			if(fa->geom!=NULL) {
+				sys=&fa->geom->sys[iw*nk+k];
+			}else{
+				sys=&tmpsys;
+				sys->isset=0;
+			}
+			if(!sys->isset && !radon_system_set(w,nxx,fa->g,np,
+					fa->dp,fa->prewhite,sys,f,fwrk)) {
+				pthread_mutex_lock(fa->mutex);
+				fa->error=1;
+				pthread_mutex_unlock(fa->mutex);
+				break;
+			}
+			if (sys->cg) {
+				ctoephcg(np/7,np,sys->r,&ccrt[k*np],rhs,
+					wrk1,wrk2,wrk3,wrk4);
+			}else{
+				ctoep_solve(np,sys,&ccrt[k*np],rhs);
+			}
+		    }
+		}
+		pthread_mutex_lock(fa->mutex);
+		V2Dw1(fa->vndc,iw,(char *)ccrt,204);
+		pthread_mutex_unlock(fa->mutex);
+	}
+	radon_system_free(&tmpsys);
+	free1complex(work);
+}
 static float gofx(int igopt, float offset, float intercept_off,float refdepth)
 /*******************************************************************
 return g(x) for various options
@@ -757,7 +946,7 @@ Author: John Anderson (visitor to CSM from Mobil) Spring 1993
 
 static void inverse_p_transform(VND *vnda,int nx, float *g, float dt,
 	int ntfft, int np, float pmin, float dp, int ip1,
-	float f1, float f2)
+	float f1, float f2, cseis_geolib::csThreadPool *pool)
 /*******************************************************************
 do inverse generalized radon transform
 
@@ -778,20 +967,22 @@ int ip1		starting generalized ray parameter index to compute
 		just invert multiples)
 float f1        max freq without taper
 float f2        max non-zero freq component
+csThreadPool *pool  worker threads for the frequency loop (NULL: none)
 *******************************************************************
 Author: John Anderson (visitor to CSM from Mobil) Spring 1993
 *******************************************************************/
 {
-	int ip,iw,ntfftny,ix,it;
+	int ip,ntfftny,ix,it;
 	size_t nmax;
-	float w,dw,p,rsum,isum,dr,di,tr,ti,fac,wa,df;
+	float dw,fac,df;
 	float *rt=NULL;
-	complex *crt=NULL, *ctemp=NULL,czero;
+	complex *crt=NULL;
+	pthread_mutex_t mutex;
+	InverseArgs iargs;
 
 	ntfftny=1+ntfft/2;
 	df=1./(ntfft*dt);
 	dw=2.*PI*df;
-	czero.r=czero.i=0.;
 
 	nmax=MAX(vnda->N[0],2*vnda->N[1])*vnda->NumBytesPerNode;
 	nmax=MAX(nmax,nx*sizeof(complex));
@@ -799,8 +990,6 @@ Author: John Anderson (visitor to CSM from Mobil) Spring 1993
 	crt=(complex *)VNDemalloc(nmax,
 		"inverse_p_transform:crt");
 	rt=(float *)crt;
-	ctemp=(complex *)VNDemalloc(np*sizeof(complex),
-		"inverse_p_transform:ctemp");
 
 	fac=1./ntfft;
 	ntfftny=ntfft/2+1;
@@ -812,12 +1001,65 @@ Author: John Anderson (visitor to CSM from Mobil) Spring 1993
 	}
 	VNDr2c(vnda);
 
+	pthread_mutex_init(&mutex,NULL);
+	iargs.vnda=vnda;
+	iargs.nx=nx;
+	iargs.np=np;
+	iargs.ip1=ip1;
+	iargs.ncrt=(nmax+sizeof(complex)-1)/sizeof(complex);
+	iargs.g=g;
+	iargs.pmin=pmin;
+	iargs.dp=dp;
+	iargs.df=df;
+	iargs.dw=dw;
+	iargs.f1=f1;
+	iargs.f2=f2;
+	iargs.mutex=&mutex;
+	iargs.error=0;
+	run_freqs(pool,inverse_freqs,&iargs,ntfftny);
+	pthread_mutex_destroy(&mutex);
+	if(iargs.error) throw cseis_geolib::csException(
+		"inverse_p_transform: cannot allocate work space");
+	for(ix=0;ix<nx;ix++) {
+		V2Dr0(vnda,ix,(char *)crt,305);
+		pfacr(-1,ntfft,crt,rt);
+		V2Dw0(vnda,ix,(char *)rt,306);
+	}
+	VNDc2r(vnda);
+	VNDfree(crt,"inverse_p_transform: crt");
+	return;
+}
+
+static void inverse_freqs(int iwf, int iwl, void *data)
+/*******************************************************************
+inverse radon transform of frequencies iwf to iwl (inclusive)
+*******************************************************************/
+{
+	InverseArgs *ia=(InverseArgs *)data;
+	int ip,iw,ix;
+	int nx=ia->nx,np=ia->np,ip1=ia->ip1;
+	float w,p,rsum,isum,dr,di,tr,ti,fac,wa;
+	float *g=ia->g;
+	complex *crt=NULL,*ctemp=NULL,czero;
+
+	czero.r=czero.i=0.;
+	crt=alloc1complex(ia->ncrt+np);
+	if(crt==NULL) {
+		pthread_mutex_lock(ia->mutex);
+		ia->error=1;
+		pthread_mutex_unlock(ia->mutex);
+		return;
+	}
+	ctemp=crt+ia->ncrt;
+
 	fac=1./np;
-	for(iw=0;iw<ntfftny;iw++) {
-		wa=freqweight(iw,df,f1,f2);
+	for(iw=iwf;iw<=iwl;iw++) {
+		wa=freqweight(iw,ia->df,ia->f1,ia->f2);
 		if(wa>0.) {
-			w=iw*dw;
-			V2Dr1(vnda,iw,(char *)crt,303);
+			w=iw*ia->dw;
+			pthread_mutex_lock(ia->mutex);
+			V2Dr1(ia->vnda,iw,(char *)crt,303);
+			pthread_mutex_unlock(ia->mutex);
 			if(wa<1.) {
 				for(ip=0;ip<np;ip++) crt[ip]=crmul(crt[ip],wa);
 			}
@@ -825,7 +1067,7 @@ Author: John Anderson (visitor to CSM from Mobil) Spring 1993
 			for(ix=0;ix<nx;ix++) {
 			    rsum = isum = 0.;
 			    for(ip=ip1;ip<np;ip++) {
-				p = pmin + ip*dp;
+				p = ia->pmin + ip*ia->dp;
 				tr = cos(w*p*g[ix]);
 				ti = sin(w*p*g[ix]);
 				dr = ctemp[ip].r;
@@ -839,17 +1081,51 @@ Author: John Anderson (visitor to CSM from Mobil) Spring 1993
 		}else{
 			for(ix=0;ix<nx;ix++) crt[ix]=czero;
 		}
-		V2Dw1(vnda,iw,(char *)crt,304);
+		pthread_mutex_lock(ia->mutex);
+		V2Dw1(ia->vnda,iw,(char *)crt,304);
+		pthread_mutex_unlock(ia->mutex);
 	}
-	for(ix=0;ix<nx;ix++) {
-		V2Dr0(vnda,ix,(char *)crt,305);
-		pfacr(-1,ntfft,crt,rt);
-		V2Dw0(vnda,ix,(char *)rt,306);
+	free1complex(crt);
+}
+
+/* frequencies iwf to iwl of the forward or inverse loop, run by a worker thread */
+class RadonFreqTask : public cseis_geolib::csRunnable {
+public:
+	RadonFreqTask() : func(NULL), data(NULL), iwf(0), iwl(-1) {}
+	void run() { func(iwf,iwl,data); }
+	void (*func)(int iwf, int iwl, void *data);
+	void *data;
+	int iwf;
+	int iwl;
+};
+
+static void run_freqs(cseis_geolib::csThreadPool *pool,
+	void (*func)(int iwf, int iwl, void *data), void *data, int nw)
+/*******************************************************************
+run func for frequencies 0 to nw-1, split into blocks of consecutive
+frequencies.  Several blocks per thread balance the cheap frequencies
+above f2 against the expensive ones below.  Returns when all
+frequencies are done.
+*******************************************************************/
+{
+	RadonFreqTask *tasks=NULL;
+	int itask,ntask;
+
+	if(pool==NULL) {
+		func(0,nw-1,data);
+		return;
 	}
-	VNDc2r(vnda);
-	VNDfree(crt,"inverse_p_transform: crt");
-	VNDfree(ctemp,"inverse_p_transform: ctemp");
-	return;
+	ntask=MIN(nw,4*pool->numThreads());
+	tasks=new RadonFreqTask[ntask];
+	for(itask=0;itask<ntask;itask++) {
+		tasks[itask].func=func;
+		tasks[itask].data=data;
+		tasks[itask].iwf=(int)(((long)itask*nw)/ntask);
+		tasks[itask].iwl=(int)(((long)(itask+1)*nw)/ntask)-1;
+		pool->submit(&tasks[itask]);
+	}
+	pool->waitAll();
+	delete [] tasks;
 }
 
 static void compute_r( float w, int nx, float *g, int np, float dp, complex *r)
@@ -957,8 +1233,7 @@ Author: John Anderson (visitor to CSM from Mobil) Spring 1993
 	}
 }
 
-static int ctoep( int n, complex *r, complex *a, complex *b,
-		 complex *f, complex *g )
+static void ctoep_factor( int n, RadonSystem *sys, complex *f, complex *g )
 /***********************************************************************
 Complex Hermitian Toeplitz Solver for
 
@@ -997,20 +1272,25 @@ and
 
 
 ***********************************************************************
+ctoep_factor runs the Levinson recursion for the spiking filter F,
+and keeps the filter and (vr,vi,vsq) of every iteration in sys.
+ctoep_solve then computes the shaping filter A for any right hand
+side B, with exactly the operations the combined recursion would
+use.  The factorisation of one frequency is thus computed once, and
+reused for all ensembles with the same offset geometry.
+
+The filter of iteration j (j+1 values) is stored at
+sys->f[(j-1)*(j+2)/2], and (vr,vi,vsq) at sys->v[3*j].
+
 where the function parameters are defined by
 
 n     dimension of system
-*r    provides the top row of the Hermitian Toeplitz matrix R
-*a    returns the complex solution vector A
-*b    input as complex vector B (not changed during call)
-*f    returns the complex spiking filter F
-      (may be needed later for Simpson's sideways recursion
-      if do search for optimum filter lag)
+*sys  sys->r provides the top row of the Hermitian Toeplitz matrix R,
+      sys->f and sys->v return the filters and normalisations,
+      sys->nlev returns as the number of successful iterations (up
+      to n), or 0 if no coefficients could be computed
+*f    work space of length n complex values
 *g    work space of length n complex values
-
-The function value returns as the number of successfully
-computed complex filter coefficients (up to n) if successful or
-0 if no coefficients could be computed.
 ***********************************************************************
 Author: John Anderson (visitor to CSM from Mobil) Spring 1993
 ***********************************************************************/
@@ -1020,12 +1300,15 @@ Author: John Anderson (visitor to CSM from Mobil) Spring 1993
 	int j;	  	/*  for the jth iteration, j=0,n-1 	*/
 	int k;			/*  for the kth component, k=0,j-1 	*/
 	int jmk;		/*  j-k 				*/
-	if (r[0].r==0.) return 0;
+	complex *r=sys->r;
+	complex *fj;		/*  spiking filter of iteration j	*/
+	float *vj;		/*  (vr,vi,vsq) of iteration j		*/
+
+	sys->nlev=0;
+	if (r[0].r==0.) return;
 
 	f[0].r = 1.0/r[0].r;
 	f[0].i = 0.;
-	a[0].r = b[0].r/r[0].r;
-	a[0].i = b[0].i/r[0].r;
 	vr=1.;
 	vi=0.;
 	vsq=1.;
@@ -1052,9 +1335,44 @@ Author: John Anderson (visitor to CSM from Mobil) Spring 1993
 			g[k].r = f[k].r - cr*f[jmk].r - ci*f[jmk].i;
 			g[k].i = f[k].i + cr*f[jmk].i - ci*f[jmk].r;
 		}
+		fj = &sys->f[(j-1)*(j+2)/2];
 		for(k=0;k<=j;k++) {
 			f[k]=g[k];
+			fj[k]=g[k];
 		}
+		vj = &sys->v[3*j];
+		vj[0] = vr;
+		vj[1] = vi;
+		vj[2] = vsq;
+	}
+	sys->nlev=j;
+}
+
+static void ctoep_solve( int n, RadonSystem *sys, complex *a, complex *b )
+/***********************************************************************
+Solve R A = B, using the Levinson factorisation of R computed by
+ctoep_factor
+
+n     dimension of system
+*sys  factorised system
+*a    returns the complex solution vector A
+*b    input as complex vector B (not changed during call)
+***********************************************************************/
+{
+	float er, ei, vr, vi, cr, ci, vsq;
+	int j, k, jmk;
+	complex *r=sys->r;
+	complex *fj;
+
+	if (sys->nlev==0) return;
+
+	a[0].r = b[0].r/r[0].r;
+	a[0].i = b[0].i/r[0].r;
+	for(j=1;j<sys->nlev;j++) {
+		fj  = &sys->f[(j-1)*(j+2)/2];
+		vr  = sys->v[3*j];
+		vi  = sys->v[3*j+1];
+		vsq = sys->v[3*j+2];
 
 		/*  Compute shaping filter for this iteration */
 		a[j].r=0.;
@@ -1071,29 +1389,126 @@ Author: John Anderson (visitor to CSM from Mobil) Spring 1993
 		ci  = (er*vi + ei*vr)/vsq;
 		for(k=0;k<=j;k++) {
 			jmk=j-k;
-			a[k].r += - cr*f[jmk].r - ci*f[jmk].i;
-			a[k].i += + cr*f[jmk].i - ci*f[jmk].r;
+			a[k].r += - cr*fj[jmk].r - ci*fj[jmk].i;
+			a[k].i += + cr*fj[jmk].i - ci*fj[jmk].r;
 		}
 	}
+}
 
-	/* Properly normalize the spiking filter so that R F = {1,0,0,...} */
-	/* instead of {v,0,0,...}.  To be accurate, recompute vr,vi,vsq */
-	vr=vi=0.;
-	for(k=0;k<j;k++) {
-		vr+=r[k].r*f[k].r-r[k].i*f[k].i;
-		vi+=r[k].r*f[k].i+r[k].i*f[k].r;
+static int radon_system_set(float w, int nx, float *g, int np, float dp,
+		float prewhite, RadonSystem *sys, complex *f, complex *wrk)
+/***********************************************************************
+Compute the prewhitened Toeplitz system of angular frequency w, and
+factorise it unless it is solved by conjugate gradients.
+Returns 0 if memory could not be allocated, 1 otherwise.
+***********************************************************************/
+{
+	int j;
+	float rsum;
+
+	if (sys->r==NULL && (sys->r=alloc1complex(np))==NULL) return 0;
+	compute_r(w,nx,g,np,dp,sys->r);
+	sys->r[0].r *= (1.+prewhite);
+	for(rsum=0.,j=1;j<np;j++)
+		rsum +=sqrt(sys->r[j].r*sys->r[j].r + sys->r[j].i*sys->r[j].i);
+	rsum=rsum/sys->r[0].r;
+	sys->cg = (rsum>1.+np/5);
+	if (!sys->cg) {
+		if (sys->f==NULL &&
+		    (sys->f=alloc1complex(MAX(1,(np-1)*(np+2)/2)))==NULL)
+			return 0;
+		if (sys->v==NULL && (sys->v=alloc1float(3*np))==NULL)
+			return 0;
+		ctoep_factor(np,sys,f,wrk);
 	}
+	sys->isset=1;
+	return 1;
+}
 
-	vsq = vr*vr + vi*vi;
+static void radon_system_free(RadonSystem *sys)
+{
+	if (sys->r!=NULL) free1complex(sys->r);
+	if (sys->f!=NULL) free1complex(sys->f);
+	if (sys->v!=NULL) free1float(sys->v);
+	sys->r=sys->f=NULL;
+	sys->v=NULL;
+	sys->isset=0;
+}
 
-	/*  Compute (er,ei) = 1./(vr,vi)   */
-	er = vr/vsq;
-	ei = -vi/vsq;
-	for(k=0;k<j;k++) {
-		f[k].r = er*f[k].r - ei*f[k].i;
-		f[k].i = er*f[k].i + ei*f[k].r;
+static RadonGeometry *radon_cache_get(RadonCache *cache, int nx, float *g,
+	int np, int nk, int ntfft, float dt, float dp, float prewhite)
+/***********************************************************************
+Return the Toeplitz systems for the given offset geometry, moved to the
+front of the cache.  If the geometry is not cached yet, an empty entry
+is added, replacing the least recently used one if the cache is full.
+***********************************************************************/
+{
+	RadonGeometry *geom,*prev=NULL;
+	int ngeom=0,nsys,isys;
+
+	for(geom=cache->first;geom!=NULL;prev=geom,geom=geom->next) {
+		if (geom->nx==nx && geom->np==np && geom->nk==nk &&
+		    geom->ntfft==ntfft && geom->dt==dt && geom->dp==dp &&
+		    geom->prewhite==prewhite &&
+		    memcmp(geom->g,g,nx*sizeof(float))==0) break;
+		ngeom++;
+	}
+	if (geom!=NULL) {
+		if (prev!=NULL) {
+			prev->next=geom->next;
+			geom->next=cache->first;
+			cache->first=geom;
+		}
+		return geom;
+	}
+
+	if (ngeom>=cache->nmax && cache->first!=NULL) {
+		for(prev=NULL,geom=cache->first;geom->next!=NULL;
+		    prev=geom,geom=geom->next);
+		if (prev==NULL) cache->first=NULL;
+		else prev->next=NULL;
+		radon_geometry_free(geom);
+	}
+
+	nsys=(1+ntfft/2)*nk;
+	geom=(RadonGeometry *)ealloc1(1,sizeof(RadonGeometry));
+	geom->g=ealloc1float(nx);
+	geom->sys=(RadonSystem *)ealloc1(nsys,sizeof(RadonSystem));
+	memcpy(geom->g,g,nx*sizeof(float));
+	for(isys=0;isys<nsys;isys++) {
+		geom->sys[isys].isset=0;
+		geom->sys[isys].r=geom->sys[isys].f=NULL;
+		geom->sys[isys].v=NULL;
+	}
+	geom->nx=nx;
+	geom->np=np;
+	geom->nk=nk;
+	geom->ntfft=ntfft;
+	geom->dt=dt;
+	geom->dp=dp;
+	geom->prewhite=prewhite;
+	geom->next=cache->first;
+	cache->first=geom;
+	return geom;
+}
+
+static void radon_geometry_free(RadonGeometry *geom)
+{
+	int isys,nsys=(1+geom->ntfft/2)*geom->nk;
+	for(isys=0;isys<nsys;isys++) radon_system_free(&geom->sys[isys]);
+	free1(geom->sys);
+	free1float(geom->g);
+	free1(geom);
+}
+
+static void radon_cache_free(RadonCache *cache)
+{
+	RadonGeometry *geom;
+	while(cache->first!=NULL) {
+		geom=cache->first;
+		cache->first=geom->next;
+		radon_geometry_free(geom);
 	}
-	return (j);
 }
 
 static int ctoephcg( int niter, int n, complex *a, complex *x, complex *y,
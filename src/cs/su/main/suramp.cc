@@ -51,7 +51,7 @@ namespace suramp {
 /**************** end self doc ***********************************/
 
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suramp( void* args )
 {
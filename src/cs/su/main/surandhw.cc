@@ -73,7 +73,7 @@ namespace surandhw {
  */
 
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 /* Prototypes */
 void setrandval(cwp_String type, Value *valp,
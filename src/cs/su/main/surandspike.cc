@@ -55,7 +55,7 @@ namespace surandspike {
 /**************** end self doc ***********************************/
 
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_surandspike( void* args )
 {
@@ -50,7 +50,7 @@ namespace surandstat {
 /************************ end self doc ***********************************/
 
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_surandstat( void* args )
 {
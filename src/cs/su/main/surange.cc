@@ -65,7 +65,7 @@ namespace surange {
 void printrange(segy *tpmin, segy *tpmax, segy *tpfirst, segy *tplast);
 static void closeinput(void);
 
-segy tr, trmin, trmax, trfirst, trlast;
+CSEIS_SU_THREAD_LOCAL segy tr, trmin, trmax, trfirst, trlast;
 
 void* main_surange( void* args )
 {
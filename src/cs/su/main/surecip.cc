@@ -59,7 +59,7 @@ namespace surecip {
 /**************** end self doc ***********************************/
 
 
-segy intrace, outtrace;
+CSEIS_SU_THREAD_LOCAL segy intrace, outtrace;
 
 void* main_surecip( void* args )
 {
@@ -51,7 +51,7 @@ namespace sureduce {
  * Trace header fields accessed: ns, dt, offset
  */
 /**************** end self doc ***********************************/
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sureduce( void* args )
 {
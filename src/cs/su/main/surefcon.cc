@@ -88,7 +88,7 @@ namespace surefcon {
  */
 /**************** end self doc ********************************/
 
-segy intrace, outtrace, sutrace;
+CSEIS_SU_THREAD_LOCAL segy intrace, outtrace, sutrace;
 
 void* main_surefcon( void* args )
 {
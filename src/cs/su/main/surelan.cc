@@ -61,7 +61,7 @@ namespace surelan {
  * Trace header fields modified:  ns, d1, offset, cdp
  */
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_surelan( void* args )
 {
@@ -64,7 +64,7 @@ namespace surelanan {
  * Trace header fields modified:  ns, d1, offset, cdp
  */
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_surelanan( void* args )
 {
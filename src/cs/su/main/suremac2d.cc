@@ -159,9 +159,9 @@ namespace suremac2d {
  *      University of Hamburg: Ekkehart Tessmer, October 2012
  */
 
-FILE *snp, *sepx, *sepz, *vel, *dens, *jpfp, *sfp, *fpbes;
+CSEIS_SU_THREAD_LOCAL FILE *snp, *sepx, *sepz, *vel, *dens, *jpfp, *sfp, *fpbes;
 
-segy tri, tro, sno;
+CSEIS_SU_THREAD_LOCAL segy tri, tro, sno;
 
 void* main_suremac2d( void* args )
 {
@@ -1001,11 +1001,11 @@ void difx(float **vin, float **vout, float **bulk, int nx, int nz, float dx,
 */
    
 {
-  static int i, k;
+  CSEIS_SU_THREAD_LOCAL int i, k;
   float  tmp;
-  static float *a, *rkx;
-  static int icall=0, ieo=0, m1=-1, p1=1 ;
-  static int num;
+  CSEIS_SU_THREAD_LOCAL float *a, *rkx;
+  CSEIS_SU_THREAD_LOCAL int icall=0, ieo=0, m1=-1, p1=1 ;
+  CSEIS_SU_THREAD_LOCAL int num;
 
   void rk(float *ak, int n, float d, int ind);
  
@@ -1098,10 +1098,10 @@ void difx2(float **vin, float **vout, float **bulk, int nx, int nz, float dx,
 */
 
 {
-  static int i, k;
-  static float *a, *rkx;
-  static int icall=0, ieo=0, m1=-1, p1=1 ;
-  static int num;
+  CSEIS_SU_THREAD_LOCAL int i, k;
+  CSEIS_SU_THREAD_LOCAL float *a, *rkx;
+  CSEIS_SU_THREAD_LOCAL int icall=0, ieo=0, m1=-1, p1=1 ;
+  CSEIS_SU_THREAD_LOCAL int num;
 
   void rk(float *ak, int n, float d, int ind);
  
@@ -1196,11 +1196,11 @@ void difz(float **vin, float **vout, float **bulk, int nx, int nz, int nzpad, fl
 */
 
 {
-  static int i, k, nzunl;
+  CSEIS_SU_THREAD_LOCAL int i, k, nzunl;
   float  tmp;
-  static float *a, *rkz;
-  static int icall=0, ieo=0, m1=-1, p1=1 ;
-  static int num;
+  CSEIS_SU_THREAD_LOCAL float *a, *rkz;
+  CSEIS_SU_THREAD_LOCAL int icall=0, ieo=0, m1=-1, p1=1 ;
+  CSEIS_SU_THREAD_LOCAL int num;
 
   void rk(float *ak, int n, float d, int ind);
 
@@ -1324,10 +1324,10 @@ void difz2(float **vin,float **vout, float **bulk, int nx, int nz, int nzpad, fl
 */
 
 {
-  static int i, k;
-  static float *a, *rkz;
-  static int icall=0, ieo=0, m1=-1, p1=1 ;
-  static int num;
+  CSEIS_SU_THREAD_LOCAL int i, k;
+  CSEIS_SU_THREAD_LOCAL float *a, *rkz;
+  CSEIS_SU_THREAD_LOCAL int icall=0, ieo=0, m1=-1, p1=1 ;
+  CSEIS_SU_THREAD_LOCAL int num;
 
   void rk(float *ak, int n, float d, int ind);
 
@@ -1505,12 +1505,12 @@ void intgr(float t, float r, float fmax, int mm, float (*func)(float,float), dou
     sum:    quadrature result
 */
 {
-  static int icall=0;
+  CSEIS_SU_THREAD_LOCAL int icall=0;
   int i, j, nn;
   float u, x, f;
-  static double pi2;
+  CSEIS_SU_THREAD_LOCAL double pi2;
   double pi, arg;
-  static double *bes;
+  CSEIS_SU_THREAD_LOCAL double *bes;
 
   void bessel_jn(double arg, int mm, double *bes);
 
@@ -1562,13 +1562,13 @@ void intgru(float t, float r, float dt, int nt, int mm, float *wave, double* sum
     sum:    quadrature result
 */
 {
-  static int icall=0, nnmax=10000;
+  CSEIS_SU_THREAD_LOCAL int icall=0, nnmax=10000;
   int i, j, nn;
   float f;
-  static float *x, *u, *xout, *yout;
-  static double pi2;
+  CSEIS_SU_THREAD_LOCAL float *x, *u, *xout, *yout;
+  CSEIS_SU_THREAD_LOCAL double pi2;
   double pi, arg;
-  static double *bes;
+  CSEIS_SU_THREAD_LOCAL double *bes;
 
   void bessel_jn(double arg, int mm, double *bes);
 
@@ -1636,8 +1636,8 @@ float fwave(float t, float fmax)
 !
 */
 {
-  static int ienter=0;
-  static float pi, pi2, agauss, tcut, s, res;
+  CSEIS_SU_THREAD_LOCAL int ienter=0;
+  CSEIS_SU_THREAD_LOCAL float pi, pi2, agauss, tcut, s, res;
 
   if (ienter == 0) {
     ienter = 1;
@@ -1717,8 +1717,8 @@ void tbc2d(float *a, float *wbx, float *wbz, int nwbx, int nwbz,
          bottom
 */
 {
-  static int *ist;
-  static int ienter = 0;
+  CSEIS_SU_THREAD_LOCAL int *ist;
+  CSEIS_SU_THREAD_LOCAL int ienter = 0;
   int i, k;
   int ifl, ihv, istart, is, iz;
   int ind1, ind2, nwb, ng1, ng2, nz0;   
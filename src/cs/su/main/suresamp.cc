@@ -86,7 +86,7 @@ namespace suresamp {
 /************************ end self doc ***************************/
 
 
-segy intrace, outtrace;
+CSEIS_SU_THREAD_LOCAL segy intrace, outtrace;
 
 void* main_suresamp( void* args )
 {
@@ -116,7 +116,7 @@ namespace suresstat {
 /**************** end self doc *******************************************/
 
 
-segy tr, tr2;
+CSEIS_SU_THREAD_LOCAL segy tr, tr2;
 
 /* prototypes for functions defined and used below */
 int max (float *trace, int mode, float perc, int nt);
@@ -63,7 +63,7 @@ namespace susehw {
 /* Prototypes of functions used internally */
 void setval(cwp_String type, Value *valp, double a, double b, double i);
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_susehw( void* args )
 {
@@ -73,8 +73,8 @@ namespace sushape {
 #define PNOISE	0.001
 
 
-segy intrace, outtrace;
-segy dtr, wtr;
+CSEIS_SU_THREAD_LOCAL segy intrace, outtrace;
+CSEIS_SU_THREAD_LOCAL segy dtr, wtr;
 
 void* main_sushape( void* args )
 {
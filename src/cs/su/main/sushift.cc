@@ -72,7 +72,7 @@ namespace sushift {
  */
 /**************** end self doc ********************************/
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sushift( void* args )
 {
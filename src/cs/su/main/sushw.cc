@@ -125,7 +125,7 @@ namespace sushw {
 /**************** end self doc ****************************************/
 
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 /* Prototypes */
 double mod(double x, double y);
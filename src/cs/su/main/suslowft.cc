@@ -76,7 +76,7 @@ namespace suslowft {
 void dftcc (int sign, int nsamp, complex *cz);
 void dftrc (int sign, int nsamp, float *re, complex *out);
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suslowft( void* args )
 {
@@ -63,7 +63,7 @@ namespace suslowift {
 /* Prototype of function used internally */
 void dftcr (int sign, int nsamp, float *re, complex *ct);
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suslowift( void* args )
 {
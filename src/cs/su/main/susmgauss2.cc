@@ -55,7 +55,7 @@ namespace susmgauss2 {
 #define PFA_MAX 720720   /* Largest allowed nfft */
 #define LOOKFAC 2	/* Look factor */
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_susmgauss2( void* args )
 {
@@ -82,9 +82,9 @@ namespace susort {
 
 #define NTRSTEP	1024	/* realloc() icrement measured in traces */
 
-segy tr;
-static int nkey;	/* number of keys to sort on	*/
-static cwp_String type;	/* header key types		*/
+CSEIS_SU_THREAD_LOCAL segy tr;
+CSEIS_SU_THREAD_LOCAL int nkey;	/* number of keys to sort on	*/
+CSEIS_SU_THREAD_LOCAL cwp_String type;	/* header key types		*/
 
 /* Prototypes */
 Value negval(cwp_String type, Value val);   /* reverse sign of value	*/
@@ -93,17 +93,17 @@ int cmp_list(const void *a, const void *b);
 static void closefiles(void);		/* signal handler		*/
 
 /* Globals (so can trap signal) defining temporary disk files */
-char tracefile[BUFSIZ];	/* filename for trace storage file	*/
-FILE *tracefp;		/* fp for trace storage file		*/
+CSEIS_SU_THREAD_LOCAL char tracefile[BUFSIZ];	/* filename for trace storage file	*/
+CSEIS_SU_THREAD_LOCAL FILE *tracefp;		/* fp for trace storage file		*/
 
 
 void* main_susort( void* args )
 {
-	static Value *val_list;	/* a list of the key values for each    */
+	CSEIS_SU_THREAD_LOCAL Value *val_list;	/* a list of the key values for each    */
 				/* trace with each group headed by the	*/
 				/* trace number of that trace		*/
-	static int *index;	/* header key indices			*/
-  	static cwp_Bool *up;	/* sort direction (+ = up = ascending)	*/
+	CSEIS_SU_THREAD_LOCAL int *index;	/* header key indices			*/
+  	CSEIS_SU_THREAD_LOCAL cwp_Bool *up;	/* sort direction (+ = up = ascending)	*/
 	register Value *vptr;	/* location pointer for val_list	*/
 	int ngroup;		/* size of unit in val_list (nkey + 1)	*/
 	int nv;			/* number of groups in val_list		*/
@@ -69,7 +69,7 @@ namespace susorty {
 /**************** end self doc ***********************************/
 
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_susorty( void* args )
 {
@@ -75,10 +75,10 @@ namespace suspecfk {
 static void closefiles(void);
 
 /* Globals (so can trap signal) defining temporary disk files */
-char tracefile[BUFSIZ];	/* filename for the file of traces	*/
-FILE *tracefp;		/* fp for trace storage file		*/
+CSEIS_SU_THREAD_LOCAL char tracefile[BUFSIZ];	/* filename for the file of traces	*/
+CSEIS_SU_THREAD_LOCAL FILE *tracefp;		/* fp for trace storage file		*/
 
-segy intrace, outtrace;
+CSEIS_SU_THREAD_LOCAL segy intrace, outtrace;
 
 void* main_suspecfk( void* args )
 {
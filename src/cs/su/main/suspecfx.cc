@@ -48,7 +48,7 @@ namespace suspecfx {
 #define LOOKFAC	2	/* Look ahead factor for npfaro	  */
 #define PFA_MAX	720720	/* Largest allowed nfft	          */
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suspecfx( void* args )
 {
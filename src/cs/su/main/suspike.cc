@@ -57,7 +57,7 @@ namespace suspike {
 /**************** end self doc ***********************************/
 
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suspike( void* args )
 {
@@ -59,7 +59,7 @@ namespace susplit {
 /**************** end self doc *******************************************/
 
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_susplit( void* args )
 {
@@ -77,7 +77,7 @@ namespace sustack {
 /**************** end self doc ***********************************/
 
 
-segy intrace, outtrace;
+CSEIS_SU_THREAD_LOCAL segy intrace, outtrace;
 
 void* main_sustack( void* args )
 {
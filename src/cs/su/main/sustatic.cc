@@ -100,7 +100,7 @@ namespace sustatic {
 /************************ end self doc ***********************************/
 
 
-segy intrace, outtrace;
+CSEIS_SU_THREAD_LOCAL segy intrace, outtrace;
 
 void* main_sustatic( void* args )
 {
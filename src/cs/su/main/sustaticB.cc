@@ -103,7 +103,7 @@ namespace sustaticB {
 /************************ end self doc ***********************************/
 
 
-segy intrace, outtrace;
+CSEIS_SU_THREAD_LOCAL segy intrace, outtrace;
 
 void* main_sustaticB( void* args )
 {
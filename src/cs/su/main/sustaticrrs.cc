@@ -133,7 +133,7 @@ namespace sustaticrrs {
 /************************ end self doc ***********************************/
 
 
-segy intrace, outtrace;
+CSEIS_SU_THREAD_LOCAL segy intrace, outtrace;
 
 void* main_sustaticrrs( void* args )
 {
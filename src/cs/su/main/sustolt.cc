@@ -96,10 +96,10 @@ static void taper (int lxtaper, int lbtaper,
 static void closefiles(void);
 
 /* Globals (so can trap signal) defining temporary disk files */
-char headerfile[BUFSIZ];/* filename for the file of headers	*/
-FILE *headerfp=NULL;		/* fp for header storage file		*/
+CSEIS_SU_THREAD_LOCAL char headerfile[BUFSIZ];/* filename for the file of headers	*/
+CSEIS_SU_THREAD_LOCAL FILE *headerfp=NULL;		/* fp for header storage file		*/
 
-segy tr,tro;
+CSEIS_SU_THREAD_LOCAL segy tr,tro;
 
 void* main_sustolt( void* args )
 {
@@ -56,7 +56,7 @@ namespace suswapbytes {
 
 /* function prototypes for subroutines used internally */
 
-static segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suswapbytes( void* args )
 {
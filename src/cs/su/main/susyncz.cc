@@ -78,7 +78,7 @@ namespace susyncz {
 /* prototype */
 void tabtrcoefs(int ninf, float *rho, float *v, float **theta,
 					float *dip, float *trcoefs);
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_susyncz( void* args )
 {
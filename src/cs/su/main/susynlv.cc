@@ -122,7 +122,7 @@ static void makeone (float v00, float dvdx, float dvdz,
 	int nr, Reflector *r, int nt, float dt, float ft, float *trace);
 
 /* segy trace */
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_susynlv( void* args )
 {
@@ -354,8 +354,8 @@ trace		array[nt] containing synthetic seismogram
 		ci,cr,time,amp,*temp;
 	ReflectorSegment *rs;
 	int lhd=LHD,nhd=NHD;
-	static float hd[NHD];
-	static int madehd=0;
+	CSEIS_SU_THREAD_LOCAL float hd[NHD];
+	CSEIS_SU_THREAD_LOCAL int madehd=0;
 	
 	/* if half-derivative filter not yet made, make it */
 	if (!madehd) {
@@ -128,7 +128,7 @@ static void makeone (float v00, float dvdx, float dvdz,
 
 
 /* segy trace */
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_susynlvcw( void* args )
 {
@@ -352,8 +352,8 @@ trace		array[nt] containing synthetic seismogram
 		ci,cr,time,amp,*temp,tos;
 	ReflectorSegment *rs;
 	int lhd=LHD,nhd=NHD;
-	static float hd[NHD];
-	static int madehd=0;
+	CSEIS_SU_THREAD_LOCAL float hd[NHD];
+	CSEIS_SU_THREAD_LOCAL int madehd=0;
 
 	/* constant depending on gamma and v00*/
 	tos = 2.0/(1.0+1.0/gamma);
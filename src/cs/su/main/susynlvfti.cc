@@ -147,7 +147,7 @@ static void raylvt (float v00, float dvdx, float dvdz,
 	float *c, float *s, float *t, float *q);
 
 /* segy trace */
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_susynlvfti( void* args )
 {
@@ -424,8 +424,8 @@ trace		array[nt] containing synthetic seismogram
 		ci,cr,time,amp,*temp;
 	ReflectorSegment *rs;
 	int lhd=LHD,nhd=NHD;
-	static float hd[NHD];
-	static int madehd=0;
+	CSEIS_SU_THREAD_LOCAL float hd[NHD];
+	CSEIS_SU_THREAD_LOCAL int madehd=0;
 	
 	/* if half-derivative filter not yet made, make it */
 	if (!madehd) {
@@ -116,7 +116,7 @@ static void makeone (float **ts, float **as, float **sgs, float **tg,
 	int nr, Reflector *r, int nt, float dt, float ft, float *trace);
 
 /* segy trace */
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_susynvxz( void* args )
 {
@@ -437,8 +437,8 @@ trace		array[nt] containing synthetic seismogram
 		*temp;
 	ReflectorSegment *rs;
 	int lhd=LHD,nhd=NHD;
-	static float hd[NHD];
-	static int madehd=0;
+	CSEIS_SU_THREAD_LOCAL float hd[NHD];
+	CSEIS_SU_THREAD_LOCAL int madehd=0;
 
 	/* if half-derivative filter not yet made, make it */
 	if (!madehd) {
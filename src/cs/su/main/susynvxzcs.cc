@@ -108,9 +108,9 @@ namespace susynvxzcs {
 /**************** end self doc ***********************************/
 
 /* global varibles for detecting error in solving eikonal equation */
-int ierr=0;
-float x_err, z_err, r_err;
-int ia_err;
+CSEIS_SU_THREAD_LOCAL int ierr=0;
+CSEIS_SU_THREAD_LOCAL float x_err, z_err, r_err;
+CSEIS_SU_THREAD_LOCAL int ia_err;
 
 
 /* parameters for half-derivative filter */
@@ -131,7 +131,7 @@ void eiktam_pert (float xs, float zs, int nz, float dz, float fz, int nx,
 	float **time, float **angle, float **sig, float **bet);
 
 /* segy trace */
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_susynvxzcs( void* args )
 {
@@ -547,8 +547,8 @@ trace		array[nt] containing synthetic seismogram
 		*temp;
 	ReflectorSegment *rs;
 	int lhd=LHD,nhd=NHD;
-	static float hd[NHD];
-	static int madehd=0;
+	CSEIS_SU_THREAD_LOCAL float hd[NHD];
+	CSEIS_SU_THREAD_LOCAL int madehd=0;
 
 	/* if half-derivative filter not yet made, make it */
 	if (!madehd) {
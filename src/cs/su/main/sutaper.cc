@@ -62,7 +62,7 @@ namespace sutaper {
  */
 /**************** end self doc ***********************************/
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 /* Prototypes for functions used internally */
 void taper( float t1, float t2, int tap_type, float T, float dt, 
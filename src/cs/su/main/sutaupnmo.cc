@@ -93,7 +93,7 @@ namespace sutaupnmo {
 static void interpvv (int nt, int ncdp, float *cdp, 
 	float **vv, float cdpt, float *vvt);
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sutaupnmo( void* args )
 {
@@ -314,7 +314,7 @@ catch( cseis_geolib::csException& exc ) {
 /* linearly interpolate/extrapolate vel2 between cdps */
 static void interpvv (int nt, int ncdp, float *cdp, float **vv, float cdpt, float *vvt)
 {
-	static int indx=0;
+	CSEIS_SU_THREAD_LOCAL int indx=0;
 	int it;
 	float a1,a2;
 
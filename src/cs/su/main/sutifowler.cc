@@ -133,8 +133,8 @@ VND *ptablemig(int nv, float *v, float etamin, float deta,
 static void taper (int lxtaper, int lbtaper,
 		int nx, int ix, int nt, float *trace);
 
-segy tr;	/* input and output SEGY data */
-FILE *fpl;	/* file pointer for print listing */
+CSEIS_SU_THREAD_LOCAL segy tr;	/* input and output SEGY data */
+CSEIS_SU_THREAD_LOCAL FILE *fpl;	/* file pointer for print listing */
 void* main_sutifowler( void* args )
 {
 	VND *vnd=NULL;	/* big file holding data, all cmps, all etas, all velocities */
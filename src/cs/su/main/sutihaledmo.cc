@@ -95,7 +95,7 @@ void weakdmo(float h,float k,complex *p,complex *pwork,
 		int nt,int ntfft,float dt, float e, float d,float v);
 /* the main program */
 
-segy tr;	/* Input and output trace data of length nt */
+CSEIS_SU_THREAD_LOCAL segy tr;	/* Input and output trace data of length nt */
 void* main_sutihaledmo( void* args )
 {
 	int 	ntfft;
@@ -59,7 +59,7 @@ namespace sutrcount {
 /**************** end self doc ********************************/
    
 /* Segy data constants */
-segy tr;				/* SEGY trace */
+CSEIS_SU_THREAD_LOCAL segy tr;				/* SEGY trace */
 
 void* main_sutrcount( void* args )
 {
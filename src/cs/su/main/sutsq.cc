@@ -55,7 +55,7 @@ namespace sutsq {
  */
 /**************** end self doc ***********************************/
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sutsq( void* args )
 {
@@ -76,7 +76,7 @@ static void maketz (int nt, float dt, float ft, float v[],
 static void zttz(int nt, float dt, float ft, float zt[], float vft, float vlt, 
 	int nz, float dz, float fz, float tz[]);
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suttoz( void* args )
 {
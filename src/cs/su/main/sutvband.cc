@@ -59,7 +59,7 @@ void makefilter(float *f, int nfft, int nfreq, float dt, float *filter);
 void bandpass(float *data, int ntime, int nfft, int nfreq, 
 		float *filterj, float *ftracej);
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_sutvband( void* args )
 {
@@ -77,9 +77,9 @@ namespace sutxtaper {
  */
 /**************** end self doc ***********************************/
 
-segy tr;
-  float *taperv=NULL;		/* vector of taper weights	*/
-  float *x2=NULL;		/* vector of taper weights	*/
+CSEIS_SU_THREAD_LOCAL segy tr;
+  CSEIS_SU_THREAD_LOCAL float *taperv=NULL;		/* vector of taper weights	*/
+  CSEIS_SU_THREAD_LOCAL float *x2=NULL;		/* vector of taper weights	*/
 
 /* Prototypes for functions used internally */
 void taper( float t1, float t2, int tap_type, float T, float dt, 
@@ -51,7 +51,7 @@ namespace suunpack1 {
 /**************** end self doc ***********************************/
 
 
-segy tr;	/* on input: SEGY hdr & (signed char) trace data */
+CSEIS_SU_THREAD_LOCAL segy tr;	/* on input: SEGY hdr & (signed char) trace data */
 		/* on output: data is floats */
 
 void* main_suunpack1( void* args )
@@ -52,7 +52,7 @@ namespace suunpack2 {
  */
 /**************** end self doc ***********************************/
 
-segy tr;	/* on input: SEGY hdr & (short) trace data */
+CSEIS_SU_THREAD_LOCAL segy tr;	/* on input: SEGY hdr & (short) trace data */
 		/* on output: data is floats */
 
 void* main_suunpack2( void* args )
@@ -150,7 +150,7 @@ short getUTMZone(double lat, double lon);
 RefEllipsoid getRefEllipsoid(int idx);
 
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suutm( void* args )
 {
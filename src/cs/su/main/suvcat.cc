@@ -81,7 +81,7 @@ namespace suvcat {
  */
 /**************** end self doc ***********************************/
 
-segy intrace1, intrace2;
+CSEIS_SU_THREAD_LOCAL segy intrace1, intrace2;
 
 void* main_suvcat( void* args )
 {
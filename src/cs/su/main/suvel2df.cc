@@ -75,7 +75,7 @@ namespace suvel2df {
  */
 /**************** end self doc *******************************************/
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suvel2df( void* args )
 {
@@ -98,7 +98,7 @@ namespace suvelan {
  */
 /**************** end self doc *******************************************/
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suvelan( void* args )
 {
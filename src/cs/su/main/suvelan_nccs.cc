@@ -74,7 +74,7 @@ namespace suvelan_nccs {
  */
 /**************** end self doc *******************************************/
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suvelan_nccs( void* args )
 {
@@ -97,7 +97,7 @@ namespace suvelan_nsel {
  */
 /**************** end self doc *******************************************/
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suvelan_nsel( void* args )
 {
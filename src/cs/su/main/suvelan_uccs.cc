@@ -67,7 +67,7 @@ namespace suvelan_uccs {
  */
 /**************** end self doc *******************************************/
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suvelan_uccs( void* args )
 {
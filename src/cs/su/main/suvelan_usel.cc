@@ -91,7 +91,7 @@ namespace suvelan_usel {
  */
 /**************** end self doc *******************************************/
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suvelan_usel( void* args )
 {
@@ -74,7 +74,7 @@ namespace suvibro {
  */
 /**************** end self doc ***********************************/
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 /* Prototypes for functions used interally */
 void Linear( float fs, float fe, float T, float dt, float phz );
@@ -44,7 +44,7 @@ namespace suvlength {
  * Trace header fields modified:  ns
  */
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suvlength( void* args )
 {
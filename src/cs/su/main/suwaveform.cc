@@ -130,7 +130,7 @@ namespace suwaveform {
  */
 /**************** end self doc ***********************************/
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suwaveform( void* args )
 {
@@ -77,7 +77,7 @@ namespace suweight {
 
 
 /* Globals */
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suweight( void* args )
 {
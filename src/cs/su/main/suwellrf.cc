@@ -84,7 +84,7 @@ namespace suwellrf {
 /**************** end self doc ********************************/
 
 
-segy tr;	/* output trace of reflectivity spikes */
+CSEIS_SU_THREAD_LOCAL segy tr;	/* output trace of reflectivity spikes */
 
 void* main_suwellrf( void* args )
 {
@@ -122,7 +122,7 @@ namespace suwind {
 /**************** end self doc *******************************************/
 
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suwind( void* args )
 {
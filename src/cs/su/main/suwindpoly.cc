@@ -101,7 +101,7 @@ int PolylineTransform(
 );
 
 /* Global variable */
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suwindpoly( void* args )
 {
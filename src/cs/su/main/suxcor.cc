@@ -117,7 +117,7 @@ namespace suxcor {
  */
 /**************** end self doc *******************************************/
 
-segy intrace, outtrace, sutrace;
+CSEIS_SU_THREAD_LOCAL segy intrace, outtrace, sutrace;
 
 void* main_suxcor( void* args )
 {
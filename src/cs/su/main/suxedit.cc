@@ -66,15 +66,15 @@ namespace suxedit {
 /**************** end self doc ***********************************/
 
 
-segy tr;		/* a segy trace structure		*/
-FILE *tty;		/* /dev/tty is used to read user input	*/
-char userin[BUFSIZ];	/* buffer user requests			*/
-int nt;			/* number of sample points on traces	*/
-FILE *infp;		/* file descriptor of trace file	*/
-char tmpwig[L_tmpnam];	/* file for trace plots			*/
+CSEIS_SU_THREAD_LOCAL segy tr;		/* a segy trace structure		*/
+CSEIS_SU_THREAD_LOCAL FILE *tty;		/* /dev/tty is used to read user input	*/
+CSEIS_SU_THREAD_LOCAL char userin[BUFSIZ];	/* buffer user requests			*/
+CSEIS_SU_THREAD_LOCAL int nt;			/* number of sample points on traces	*/
+CSEIS_SU_THREAD_LOCAL FILE *infp;		/* file descriptor of trace file	*/
+CSEIS_SU_THREAD_LOCAL char tmpwig[L_tmpnam];	/* file for trace plots			*/
 
 /* tabulate help message as an array of strings */
-char *help[] = {
+CSEIS_SU_THREAD_LOCAL char *help[] = {
 "					",
 " n		read in trace #n	",
 " <CR>		step			",
@@ -49,7 +49,7 @@ namespace suzero {
 /**************** end self doc ***********************************/
 
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suzero( void* args )
 {
@@ -77,7 +77,7 @@ static void makezt (int nz, float dz, float fz, float v[],
 static void tzzt(int nz, float dz, float fz, float tz[], float vfz, float vlz, 
 	int nt, float dt, float ft, float zt[]);
 
-segy tr;
+CSEIS_SU_THREAD_LOCAL segy tr;
 
 void* main_suztot( void* args )
 {
@@ -47,8 +47,8 @@ namespace swapbhed {
  */
 /**************** end self doc ***********************************/
 
-segy tr;
-bhed bh;
+CSEIS_SU_THREAD_LOCAL segy tr;
+CSEIS_SU_THREAD_LOCAL bhed bh;
 
 void* main_swapbhed( void* args )
 {
@@ -5,7 +5,6 @@
 #include "cseis_includes.h"
 #include "geolib_endian.h"
 #include "geolib_string_utils.h"
-#include "csCompareVector.h"
 
 #include "csSegyTraceHeader.h"
 #include "csSegyHdrMap.h"
@@ -47,20 +46,18 @@ namespace mod_su {
 
     int counter;
   };
-  static cseis_geolib::csCompareVector<std::string>* moduleList = NULL;
   static int CALL_COUNTER = 0;
-  // Idle sleep time while pushing traces from Seaseis to SU, in [microseconds]
-  static int PUSH_IDLE_SLEEP_TIME_US = 1000;
 }
 using mod_su::VariableStruct;
 
 void setHeaders( csSegyTraceHeader* segyTrcHdr, csSegyHdrMap* segyHdrMap, int* hdrIndexSegy, type_t* hdrTypeSegy,
                  int numSamples, float sampleInt, csTraceHeaderDef* hdef, int scalarPolarity );
-void performPull( mod_su::VariableStruct* vars,
-                  csTraceGather* traceGather,
-                  csTraceHeaderDef const* hdef,
-                  csSuperHeader const* shdr,
-                  bool isDebug );
+int performPull( mod_su::VariableStruct* vars,
+                 csTraceGather* traceGather,
+                 csTraceHeaderDef const* hdef,
+                 csSuperHeader const* shdr,
+                 bool waitForTraces,
+                 bool isDebug );
 
 //*************************************************************************************************
 // Init phase
@@ -80,8 +77,14 @@ void init_mod_su_( csParamManager* param, csInitPhaseEnv* env, csLogWriter* log
   edef->setExecType( EXEC_TYPE_MULTITRACE );
   edef->setTraceSelectionMode( TRCMODE_FIXED, 1 );
 
-  vars->suPush = new cseis_su::csSUTraceManager();
-  vars->suPull = new cseis_su::csSUTraceManager();
+  int numSlots = cseis_su::DEFAULT_NUM_SLOTS;
+  if( param->exists("nslots") ) {
+    param->getInt( "nslots", &numSlots );
+    if( numSlots < 1 ) log->error("Number of trace slots must be larger than 0. Specified: %d", numSlots);
+  }
+  // Push & pull manager share one mutex & condition variable: Seaseis waits for a change in either of them
+  vars->suPush = new cseis_su::csSUTraceManager( numSlots );
+  vars->suPull = new cseis_su::csSUTraceManager( numSlots, vars->suPush );
   vars->suPull->setLogFile( log->getFile() );
   vars->args   = new cseis_su::csSUArguments();  // MUST be allocated on heap!! Memory on stack cannot be used by other threads
   vars->ignoreSUHdr = false;
@@ -164,7 +167,8 @@ void init_mod_su_( csParamManager* param, csInitPhaseEnv* env, csLogWriter* log
   }
 
   // Create separate thread where SU module/process will run
-  // SU module (csTraceManager) will wait in idle loop until new trace is received
+  // SU module (csTraceManager) will wait until new trace is received
+  // Several instances of the same SU module may run concurrently: All global & static variables in SU module source code are thread-local
   // SU thread will terminate when SeaSeis has indicated that no more traces will be pushed (csSUTraceManager::setEOF)
   int rc = pthread_create( &vars->thread, NULL, SU_MAIN_METHODS[suModuleIndex], (void*)vars->args );
   if( rc ) {
@@ -174,17 +178,6 @@ void init_mod_su_( csParamManager* param, csInitPhaseEnv* env, csLogWriter* log
   log->line("Successfully launched thread for module '%s': Return code from pthread_create() is %d\n", vars->suModuleName.c_str(), rc);
   vars->isThreadAlive = true;
 
-  //--------------------------------------------------
-  if( mod_su::moduleList == NULL ) {
-    mod_su::moduleList = new cseis_geolib::csCompareVector<std::string>();
-  }
-  if( mod_su::moduleList->contains( vars->suModuleName ) ) {
-    log->error("This flow already contains a call to SU module '%s'.\nThis is not supported yet due to 'static variables' used in the source code of many SU modules.\n", vars->suModuleName.c_str() );
-  }
-  mod_su::moduleList->insertEnd( vars->suModuleName );
-  //--------------------------------------------------  
-
-
   //--------------------------------------------------------------------------------
   // Prepare CSEIS -> SU header mapping, and vice versa
   //
@@ -287,12 +280,15 @@ void exec_mod_su_(
   if( traceGather->numTraces() > 0 ) {
     vars->traceCounter += 1;
 
-    // Before pushing, make sure the 'push' object can receive a new trace (=it must be 'empty')
-    while( !vars->suPush->isEmpty() ) {
-      if( vars->suPull->isEmpty() ) cseis_su::csSUTraceManager::sleep_ms( (float)mod_su::PUSH_IDLE_SLEEP_TIME_US/1000.0f );
-      // Meanwhile, if the 'pull' object has a trace waiting, retrieve it
-      while( !vars->suPull->isEmpty() ) {
-        performPull( vars, traceGather, hdef, shdr, edef->isDebug() );
+    // Before pushing, make sure the 'push' object can receive a new trace (=it must have a free slot)
+    // Meanwhile, if the 'pull' object has traces waiting, retrieve them
+    while( !vars->suPush->waitForSpace( vars->suPull ) ) {
+      if( performPull( vars, traceGather, hdef, shdr, false, edef->isDebug() ) == 0 && vars->suPull->isEOF() ) {
+        // SU process has terminated without reading all input traces
+        if( vars->suPull->isError() ) {
+          log->error("SU module '%s' returned an error message.", vars->suModuleName.c_str() );
+        }
+        break;
       }
     }
 
@@ -322,7 +318,11 @@ void exec_mod_su_(
       }
     }
 
-    if( vars->suPush->putTrace( vars->suTrcHdrWrite, trace->getTraceSamples(), vars->numSamplesIn ) ) {
+    if( vars->suPull->isEOF() && vars->suPush->isFull() ) {
+      traceGather->freeTrace(0);  // SU process does not accept any more traces: Discard input trace
+      if( edef->isDebug() ) fprintf(stdout,"CSEIS: Discard trace %d\n", vars->traceCounter);
+    }
+    else if( vars->suPush->putTrace( vars->suTrcHdrWrite, trace->getTraceSamples(), vars->numSamplesIn ) ) {
       traceGather->freeTrace(0);  // Remove trace
       if( edef->isDebug() ) fprintf(stdout,"CSEIS: Push trace %d\n", vars->traceCounter);
     }
@@ -337,18 +337,17 @@ void exec_mod_su_(
 
 
   // Retrieve any traces from the 'pull' object
-  while( !vars->suPull->isEmpty() ) {
-    performPull( vars, traceGather, hdef, shdr, edef->isDebug() );
-  }
+  performPull( vars, traceGather, hdef, shdr, false, edef->isDebug() );
 
   // --------------------------------------------------
   // Last call: Pull all remaining traces from SU process
   if( edef->isLastCall() ) {
     if( edef->isDebug() ) fprintf(stdout,"CSEIS: AT EOF, last call!\n");
     vars->suPush->setEOF();  // Indicate to SU process that no more traces will arrive
-    while( !vars->suPull->isEOF() ) {
-      if( vars->suPull->isEmpty() ) cseis_su::csSUTraceManager::sleep_ms(1);
-      performPull( vars, traceGather, hdef, shdr, edef->isDebug() );
+    // Wait for traces until SU process has set EOF flag and no traces are left
+    while( performPull( vars, traceGather, hdef, shdr, true, edef->isDebug() ) > 0 );
+    if( vars->suPull->isError() ) {
+      log->error("SU module '%s' returned an error message.", vars->suModuleName.c_str() );
     }
     if( edef->isDebug() ) fprintf(stdout,"CSEIS: END\n");
   }
@@ -389,6 +388,10 @@ void params_mod_su_( csParamDef* pdef ) {
   pdef->addParam( "nsamples", "Number of samples in output trace", NUM_VALUES_FIXED, "This parameter needs to specified only if the number of samples output by the SU module differs from the input. In this case it is required in order to inform Seaseis about the correct number of output samples." );
   pdef->addValue( "", VALTYPE_NUMBER, "Number of samples in output trace" );
 
+  pdef->addParam( "nslots", "Number of trace slots in buffers between Seaseis and SU", NUM_VALUES_FIXED,
+                  "Traces are passed to and from the SU module through ring buffers holding this many traces. Larger values reduce thread switching between Seaseis and SU" );
+  pdef->addValue( "16", VALTYPE_NUMBER, "Number of trace slots" );
+
   pdef->addParam( "ignore_su_hdr", "Ignore SU headers for number of samples and sample interval?", NUM_VALUES_FIXED );
   pdef->addValue( "no", VALTYPE_OPTION );
   pdef->addOption( "no", "Number of samples and sample interval in Seaseis output trace must match output from SU" );
@@ -475,37 +478,43 @@ void setHeaders( csSegyTraceHeader* segyTrcHdr, csSegyHdrMap* segyHdrMap, int* h
 }
 
 //--------------------------------------------------------------------------------
+// Retrieve all traces currently held in 'pull' object
+// @param waitForTraces  true: Wait until at least one trace is available, or SU process has set EOF flag
+// @return Number of retrieved traces
 //
-void performPull( mod_su::VariableStruct* vars,
-                  csTraceGather* traceGather,
-                  csTraceHeaderDef const* hdef,
-                  csSuperHeader const* shdr,
-                  bool isDebug )
+int performPull( mod_su::VariableStruct* vars,
+                 csTraceGather* traceGather,
+                 csTraceHeaderDef const* hdef,
+                 csSuperHeader const* shdr,
+                 bool waitForTraces,
+                 bool isDebug )
 {
-  unsigned char const* bufferPtr = NULL;
-  if( vars->suPull->getTracePtr( &bufferPtr ) ) {
+  int numTraces = waitForTraces ? vars->suPull->waitForTraces() : vars->suPull->numTraces();
+  if( numTraces == 0 ) {
+    if( isDebug ) fprintf(stdout,"CSEIS: Couldn't pull trace %d\n", vars->traceCounter);
+    return 0;
+  }
+  for( int itrc = 0; itrc < numTraces; itrc++ ) {
+    unsigned char const* bufferPtr = vars->suPull->tracePtr( itrc );
     // First, check consistency of sample interval and number of samples in trace from SU:
     if(  !vars->ignoreSUHdr ) {
-      if( vars->suPull->numSamples() != shdr->numSamples ) {
+      if( vars->suPull->numSamples(itrc) != shdr->numSamples ) {
         throw( csException("Number of samples output by SU module '%s' (=%d) does not match number of samples specified for SeaSeis (=%d). Specify ' num_samples  %d' in Seaseis flow",
-                           vars->suModuleName.c_str(), vars->suPull->numSamples(), shdr->numSamples, vars->suPull->numSamples())  );
+                           vars->suModuleName.c_str(), vars->suPull->numSamples(itrc), shdr->numSamples, vars->suPull->numSamples(itrc))  );
       }
-      if( fabs(vars->suPull->sampleInt()-shdr->sampleInt) > 0.0001 ) {
+      if( fabs(vars->suPull->sampleInt(itrc)-shdr->sampleInt) > 0.0001 ) {
         throw( csException("Sample interval output by SU module '%s' (=%.4fms) does not match sample interval specified for SeaSeis (=%.4fms). Specify ' sample_int  %f' or ' ignore_su_hdr yes' in Seaseis flow",
-                           vars->suModuleName.c_str(), vars->suPull->sampleInt(), shdr->sampleInt, vars->suPull->sampleInt())  );
+                           vars->suModuleName.c_str(), vars->suPull->sampleInt(itrc), shdr->sampleInt, vars->suPull->sampleInt(itrc))  );
       }
     }
 
     csTrace* newTrace = traceGather->createTrace( hdef, shdr->numSamples );
     csTraceHeader* newTrcHdr = newTrace->getTraceHeader();
-    //    fprintf(stdout,"CSEIS: Successful pull of trace %d   %x\n", vars->traceCounter, bufferPtr );
-    //  fflush(stdout);
     float* newSamples = newTrace->getTraceSamples();
 
     memcpy(newSamples,&bufferPtr[240],shdr->numSamples*sizeof(float));
 
     vars->suTrcHdrRead->readHeaderValues( bufferPtr, false, true );  // swapEndian=false, isAutoScaleHeaders=true
-    vars->suPull->freeTrace(); // Crucial to free trace after calling getTracePtr()
           
     int nHeaders = vars->suTrcHdrRead->numHeaders();
     for( int ihdr = 0; ihdr < nHeaders; ihdr++ ) {
@@ -532,7 +541,6 @@ void performPull( mod_su::VariableStruct* vars,
     
     if( isDebug ) fprintf(stdout,"CSEIS: Successful pull of trace %d\n", vars->traceCounter);
   }
-  else {
-    if( isDebug ) fprintf(stdout,"CSEIS: Couldn't pull trace %d\n", vars->traceCounter);
-  }
+  vars->suPull->freeTraces( numTraces ); // Crucial to free traces after accessing them, in one go for all retrieved traces
+  return numTraces;
 }
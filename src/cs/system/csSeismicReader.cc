@@ -14,6 +14,9 @@
 #include "csTraceHeaderInfo.h"
 #include "csFlexHeader.h"
 #include "csIOSelection.h"
+#include "csHeaderColumnReader.h"
+#include "csHeaderColumnWriter.h"
+#include "csFileUtils.h"
 #include <string>
 
 using namespace cseis_system;
@@ -21,11 +24,13 @@ using namespace cseis_system;
 csSeismicReader::csSeismicReader( std::string filename, int numTraces ) {
   bool enableRandomAccess = false;
   myReader = cseis_io::csSeismicReader_ver::createReaderObject( filename, enableRandomAccess, numTraces );
+  myFilename = filename;
   init();
 }
 
 csSeismicReader::csSeismicReader( std::string filename, bool enableRandomAccess, int numTraces ) {
   myReader = cseis_io::csSeismicReader_ver::createReaderObject( filename, enableRandomAccess, numTraces );
+  myFilename = filename;
   init();
 }
 
@@ -37,6 +42,8 @@ void csSeismicReader::init() {
   myHdrCheckBuffer     = NULL;
   myTrcHdrDef          = NULL;
   myIOSelection        = NULL;
+  myHdrColumnReader    = NULL;
+  myHdrCheckColumnIndex = -1;
 }
 
 csSeismicReader::~csSeismicReader() {
@@ -48,6 +55,10 @@ csSeismicReader::~csSeismicReader() {
     delete myReader;
     myReader = NULL;
   }
+  if( myHdrColumnReader != NULL ) {
+    delete myHdrColumnReader;
+    myHdrColumnReader = NULL;
+  }
   if( myHdrCheckBuffer != NULL ) {
     delete [] myHdrCheckBuffer;
     myHdrCheckBuffer = NULL;
@@ -110,8 +121,37 @@ bool csSeismicReader::readFileHeader( csSuperHeader* shdr, csTraceHeaderDef* hde
 
   myTrcHdrDef = hdef;
 
+  openHeaderColumns();
+
   return true;
 }
+//--------------------------------------------------------------------
+void csSeismicReader::openHeaderColumns() {
+  std::string filename = cseis_io::csHeaderColumnWriter::filename( myFilename );
+  if( !cseis_geolib::csFileUtils::fileExists( filename ) ) return;
+  try {
+    myHdrColumnReader = new cseis_io::csHeaderColumnReader( filename );
+    // Only use header column file if it was written together with current version of seismic file
+    if( myHdrColumnReader->numTraces() != myNumTraces ||
+        myHdrColumnReader->seismicFileSize() != cseis_geolib::csFileUtils::retrieveFileSize( myFilename ) ) {
+      delete myHdrColumnReader;
+      myHdrColumnReader = NULL;
+    }
+  }
+  catch( cseis_geolib::csException& e ) {
+    myHdrColumnReader = NULL;
+  }
+}
+int csSeismicReader::headerColumnIndex( std::string const& headerName, int byteSize ) const {
+  if( myHdrColumnReader == NULL ) return -1;
+  int index = myHdrColumnReader->headerIndex( headerName );
+  // Header may have been renamed when reading file header, see readFileHeader()
+  if( index < 0 && headerName.length() > 1 && headerName[0] == '_' ) {
+    index = myHdrColumnReader->headerIndex( headerName.substr(1) );
+  }
+  if( index >= 0 && myHdrColumnReader->headerByteSize( index ) != byteSize ) return -1;
+  return index;
+}
 
 bool csSeismicReader::readTrace( float* samples, char* hdrValueBlock, int numSamples ) {
   if( myIOSelection ) {
@@ -125,6 +165,12 @@ bool csSeismicReader::readTrace( float* samples, char* hdrValueBlock ) {
   }
   return myReader->readTrace( samples, hdrValueBlock );
 }
+bool csSeismicReader::readTraceHeader( char* hdrValueBlock ) {
+  if( myIOSelection ) {
+    if( !performIOSelection() ) return false;
+  }
+  return myReader->readTraceHeader( hdrValueBlock );
+}
 bool csSeismicReader::performIOSelection() {
   bool success = false;
   int traceIndex = myIOSelection->getNextTraceIndex();
@@ -155,6 +201,7 @@ bool csSeismicReader::setHeaderToPeek( std::string const& headerName ) {
     myHdrCheckBuffer = NULL;
   }
   myHdrCheckBuffer = new char[myHdrCheckByteSize];
+  myHdrCheckColumnIndex = headerColumnIndex( headerName, myHdrCheckByteSize );
   return true;
 }
 
@@ -166,6 +213,10 @@ bool csSeismicReader::peekHeaderValue( cseis_geolib::csFlexHeader* hdrValue, int
   if( traceIndex < 0 ) {
     success = myReader->peek( myHdrCheckByteOffset, myHdrCheckByteSize, myHdrCheckBuffer );
   }
+  else if( myHdrCheckColumnIndex >= 0 ) {
+    if( traceIndex >= myNumTraces ) return false;
+    myHdrColumnReader->readValue( myHdrCheckColumnIndex, traceIndex, myHdrCheckBuffer );
+  }
   else {
     success = myReader->peek( myHdrCheckByteOffset, myHdrCheckByteSize, myHdrCheckBuffer, traceIndex );
   }
@@ -11,6 +11,7 @@
 
 namespace cseis_io {
   class csSeismicReader_ver;
+  class csHeaderColumnReader;
 }
 
 namespace cseis_geolib {
@@ -65,6 +66,12 @@ public:
   */
   bool readTrace( float* samples, char* hdrValueBlock );
   bool readTrace( float* samples, char* hdrValueBlock, int numSamples );
+  /**
+  * Read trace header of next trace only. Trace samples are skipped.
+  * @param hdrValueBlock (o) Buffer to hold all trace header values in the format defined in the trace header definition
+   * @return false if something went wrong.
+  */
+  bool readTraceHeader( char* hdrValueBlock );
   /**
    * Set header to peek
    * Initiates header 'peeking' operation. Next, the method 'peekheaderValue' may be called to retrieve the header value
@@ -89,6 +96,10 @@ public:
    * @return false     if something went wrong.
    */
   bool peekHeaderValue( cseis_geolib::csFlexHeader* hdrValue, int traceIndex = -1 );
+  /**
+   * @return true if a valid header column file exists for this seismic file, see cseis_io::csHeaderColumnReader
+   */
+  bool hasHeaderColumns() const { return myHdrColumnReader != NULL; }
   /** 
    * @return Number of traces in file
    */
@@ -127,6 +138,8 @@ public:
 private:
   void init();
   bool performIOSelection();
+  void openHeaderColumns();
+  int headerColumnIndex( std::string const& headerName, int byteSize ) const;
 
   cseis_io::csSeismicReader_ver* myReader;
   int myNumTraces;
@@ -137,6 +150,10 @@ private:
   char* myHdrCheckBuffer;
   cseis_system::csTraceHeaderDef const* myTrcHdrDef;  // Pointer only, do not free!
   cseis_geolib::csIOSelection* myIOSelection;
+  std::string myFilename;
+  cseis_io::csHeaderColumnReader* myHdrColumnReader;
+  /// Index of peek header in header column file, or -1 if not available
+  int myHdrCheckColumnIndex;
 };
 
 } // end namespace
@@ -3,6 +3,9 @@
 
 #include "csSeismicWriter.h"
 #include "csSeismicWriter_ver.h"
+#include "csSeismicWriter_ver05.h"
+#include "csHeaderColumnWriter.h"
+#include "csOverviewWriter.h"
 #include "csSeismicIOConfig.h"
 #include "csSuperHeader.h"
 #include "csTraceHeaderDef.h"
@@ -10,26 +13,83 @@
 #include "csTraceHeaderInfo.h"
 #include "csGeolibUtils.h"
 #include "csException.h"
+#include "csFileUtils.h"
 #include <cstring>
+#include <cstdio>
 
 using namespace cseis_system;
 
 csSeismicWriter::csSeismicWriter( std::string filename, int numTracesBuffer, int sampleByteSize, bool overwrite ) {
   myWriter = new cseis_io::csSeismicWriter_ver( filename, numTracesBuffer, sampleByteSize, overwrite );
+  myWriter05 = NULL;
+  myHdrColumnWriter  = NULL;
+  myOverviewWriter   = NULL;
   myHdrTempBuffer    = NULL;
   myHdef = NULL;
+  myFilename = filename;
+  removeSidecarFiles();
+}
+csSeismicWriter::csSeismicWriter( std::string filename, int numTracesBlock, int codec, float tolerance, int numThreads, bool overwrite ) {
+  myWriter   = NULL;
+  myWriter05 = new cseis_io::csSeismicWriter_ver05( filename, numTracesBlock, codec, tolerance, numThreads, overwrite );
+  myHdrColumnWriter  = NULL;
+  myOverviewWriter   = NULL;
+  myHdrTempBuffer    = NULL;
+  myHdef = NULL;
+  myFilename = filename;
+  removeSidecarFiles();
 }
 csSeismicWriter::~csSeismicWriter() {
+  try {
+    close();
+  }
+  catch( ... ) {
+    // Nothing to be done. Call close() explicitly to find out about write errors
+  }
   if( myWriter != NULL ) {
     delete myWriter;
     myWriter = NULL;
   }
+  if( myWriter05 != NULL ) {
+    delete myWriter05;
+    myWriter05 = NULL;
+  }
   if( myHdrTempBuffer != NULL ) {
     delete [] myHdrTempBuffer;
     myHdrTempBuffer = NULL;
   }
 }
 //--------------------------------------------------------------------
+void csSeismicWriter::close() {
+  if( myWriter != NULL ) {
+    myWriter->close();
+  }
+  if( myWriter05 != NULL ) {
+    myWriter05->close();
+  }
+  if( myHdrColumnWriter != NULL ) {
+    // Seismic file has been closed: Complete header column file with final size of seismic file
+    try {
+      myHdrColumnWriter->close( cseis_geolib::csFileUtils::retrieveFileSize( myFilename ) );
+    }
+    catch( ... ) {
+      // Nothing to be done. Incomplete header column file will be ignored by reader
+    }
+    delete myHdrColumnWriter;
+    myHdrColumnWriter = NULL;
+  }
+  if( myOverviewWriter != NULL ) {
+    try {
+      myOverviewWriter->close( cseis_geolib::csFileUtils::retrieveFileSize( myFilename ) );
+    }
+    catch( ... ) {
+      // Nothing to be done. Incomplete overview file will be ignored by reader
+    }
+    delete myOverviewWriter;
+    myOverviewWriter = NULL;
+  }
+}
+//--------------------------------------------------------------------
 bool csSeismicWriter::writeFileHeader( csSuperHeader const* shdr, csTraceHeaderDef const* hdef ) {
   myHdef = hdef;
 
@@ -84,10 +144,22 @@ bool csSeismicWriter::writeFileHeader( csSuperHeader const* shdr, csTraceHeaderD
     myHdrTempBuffer = new char[config.byteSizeHdrValueBlock];
   }
 
+  if( myHdrColumnWriter != NULL ) {
+    myHdrColumnWriter->writeFileHeader( &config );
+  }
+  if( myOverviewWriter != NULL ) {
+    myOverviewWriter->writeFileHeader( &config );
+  }
+  if( myWriter05 != NULL ) {
+    return myWriter05->writeFileHeader( &config );
+  }
   return myWriter->writeFileHeader( &config );
 }
 bool csSeismicWriter::writeTrace( float* samples, char const* hdrValueBlock ) {
+  if( myOverviewWriter != NULL ) myOverviewWriter->writeTrace( samples );
   if( myHdrTempBuffer == NULL ) {
+    if( myHdrColumnWriter != NULL ) myHdrColumnWriter->writeTraceHeader( hdrValueBlock );
+    if( myWriter05 != NULL ) return myWriter05->writeTrace( samples, hdrValueBlock );
     return myWriter->writeTrace( samples, hdrValueBlock );
   }
   else {
@@ -106,7 +178,23 @@ bool csSeismicWriter::writeTrace( float* samples, char const* hdrValueBlock ) {
       memcpy( &myHdrTempBuffer[counterBytes], &hdrValueBlock[byteLocation[ihdr]], numHdrBytes );
       counterBytes += numHdrBytes;
     }
+    if( myHdrColumnWriter != NULL ) myHdrColumnWriter->writeTraceHeader( myHdrTempBuffer );
+    if( myWriter05 != NULL ) return myWriter05->writeTrace( samples, myHdrTempBuffer );
     return myWriter->writeTrace( samples, myHdrTempBuffer );
   }
 }
-
+void csSeismicWriter::removeSidecarFiles() {
+  // Header column and overview files of a previous version of the seismic file are no longer valid
+  std::remove( cseis_io::csHeaderColumnWriter::filename( myFilename ).c_str() );
+  std::remove( cseis_io::csOverviewWriter::filename( myFilename ).c_str() );
+}
+void csSeismicWriter::enableHeaderColumns() {
+  if( myHdrColumnWriter == NULL ) {
+    myHdrColumnWriter = new cseis_io::csHeaderColumnWriter( cseis_io::csHeaderColumnWriter::filename( myFilename ) );
+  }
+}
+void csSeismicWriter::enableOverviews( int numLevels, int factor ) {
+  if( myOverviewWriter == NULL ) {
+    myOverviewWriter = new cseis_io::csOverviewWriter( cseis_io::csOverviewWriter::filename( myFilename ), numLevels, factor );
+  }
+}
@@ -9,6 +9,9 @@
 
 namespace cseis_io {
   class csSeismicWriter_ver;
+  class csSeismicWriter_ver05;
+  class csHeaderColumnWriter;
+  class csOverviewWriter;
 }
 
 namespace cseis_system {
@@ -35,6 +38,16 @@ public:
    * @param overwrite       true to overwrite even if file exists. false if existing file shall not be overwritten.
    */
   csSeismicWriter( std::string filename, int numTracesBuffer, int sampleByteSize = 4, bool overwrite = true );
+  /**
+   * Constructor, block format (SeaSeis format version 0.5)
+   * @param filename Name of output file
+   * @param numTracesBlock  Number of traces per block. 0: Use default block size
+   * @param codec           Sample codec, see cseis_io::csSeismicBlockCodec
+   * @param tolerance       Maximum absolute sample error for lossy codec
+   * @param numThreads      Number of encoder threads. 0: Use number of processors
+   * @param overwrite       true to overwrite even if file exists. false if existing file shall not be overwritten.
+   */
+  csSeismicWriter( std::string filename, int numTracesBlock, int codec, float tolerance, int numThreads, bool overwrite = true );
   ~csSeismicWriter();
 
   /**
@@ -50,11 +63,36 @@ public:
    * @param hdrValueBlock (i) Buffer holding all trace header values in the format defined in the trace header definition
    */
   bool writeTrace( float* samples, char const* hdrValueBlock );
+  /**
+   * Write out all buffered traces and close file. Complete header column and overview files, if enabled.
+   * Call once after the last trace has been written. Otherwise, the file is closed when this object is deleted,
+   * without reporting errors.
+   * @throws csException if the seismic file could not be written
+   */
+  void close();
+  /**
+   * Also write trace headers into column-wise header file, see cseis_io::csHeaderColumnWriter.
+   * Call before writeFileHeader(). The header column file is completed when the seismic file is closed.
+   */
+  void enableHeaderColumns();
+  /**
+   * Also write decimated overview traces into overview file, see cseis_io::csOverviewWriter.
+   * Call before writeFileHeader(). The overview file is completed when the seismic file is closed.
+   * @param numLevels  Number of overview levels
+   * @param factor     Decimation factor from one level to the next
+   */
+  void enableOverviews( int numLevels, int factor );
 
 private:
+  void removeSidecarFiles();
+
   cseis_io::csSeismicWriter_ver* myWriter;
+  cseis_io::csSeismicWriter_ver05* myWriter05;
+  cseis_io::csHeaderColumnWriter* myHdrColumnWriter;
+  cseis_io::csOverviewWriter* myOverviewWriter;
   char* myHdrTempBuffer;
   csTraceHeaderDef const* myHdef;
+  std::string myFilename;
 };
 
 } // end namespace
@@ -10,6 +10,8 @@
 #include "csException.h"
 #include "csTraceHeaderDef.h"
 #include "csTraceHeader.h"
+#include "csTraceGather.h"
+#include "csTrace.h"
 #include "csException.h"
 #include <string>
 
@@ -24,6 +26,8 @@ csSelectionManager::csSelectionManager() {
   myHeaderNames = NULL;
   myValues      = NULL;
   mySelection   = NULL;
+  myGatherValues = NULL;
+  myNumGatherTracesAlloc = 0;
 }
 //--------------------------------------------------------------
 //
@@ -32,6 +36,7 @@ csSelectionManager::~csSelectionManager() {
   if( myHeaderType ) { delete [] myHeaderType; myHeaderType = NULL; }
   if( myHeaderNames ) { delete [] myHeaderNames; myHeaderNames = NULL; }
   if( myValues ) { delete [] myValues; myValues = NULL; }
+  if( myGatherValues ) { delete [] myGatherValues; myGatherValues = NULL; }
   if( mySelection ) { delete mySelection; mySelection = NULL; }
   myNumHeaders   = 0;
 }
@@ -69,19 +74,22 @@ void csSelectionManager::dump() {
 }
 //----------------------------------------------------------
 //
-bool csSelectionManager::contains( cseis_system::csTraceHeader const* trcHeader ) {
+void csSelectionManager::extractValues( cseis_system::csTraceHeader const* trcHeader, cseis_geolib::csFlexNumber* values ) const {
   for( int i = 0; i < myNumHeaders; i++ ) {
     if( myHeaderType[i] == cseis_geolib::TYPE_FLOAT ) {
-      myValues[i].setDoubleValue( trcHeader->floatValue(myHeaderIndex[i]) );
-//      myValues[i].setFloatValue( trcHeader->floatValue(myHeaderIndex[i]) );
+      values[i].setDoubleValue( trcHeader->floatValue(myHeaderIndex[i]) );
+//      values[i].setFloatValue( trcHeader->floatValue(myHeaderIndex[i]) );
     }
     else if( myHeaderType[i] == cseis_geolib::TYPE_DOUBLE ) {
-      myValues[i].setDoubleValue( trcHeader->doubleValue(myHeaderIndex[i]) );
+      values[i].setDoubleValue( trcHeader->doubleValue(myHeaderIndex[i]) );
     }
     else { // TYPE_INT
-      myValues[i].setIntValue( trcHeader->intValue( myHeaderIndex[i] ) );
+      values[i].setIntValue( trcHeader->intValue( myHeaderIndex[i] ) );
     }
   }
+}
+bool csSelectionManager::contains( cseis_system::csTraceHeader const* trcHeader ) {
+  extractValues( trcHeader, myValues );
   if( mySelection != NULL ) {
     return mySelection->contains( myValues );
   }
@@ -89,6 +97,24 @@ bool csSelectionManager::contains( cseis_system::csTraceHeader const* trcHeader
     return true;
   }
 }
+int csSelectionManager::contains( cseis_system::csTraceGather const* traceGather, bool* isSelected ) {
+  int numTraces = traceGather->numTraces();
+  if( mySelection == NULL ) {
+    for( int itrc = 0; itrc < numTraces; itrc++ ) {
+      isSelected[itrc] = true;
+    }
+    return numTraces;
+  }
+  if( numTraces > myNumGatherTracesAlloc ) {
+    if( myGatherValues ) delete [] myGatherValues;
+    myNumGatherTracesAlloc = numTraces;
+    myGatherValues = new cseis_geolib::csFlexNumber[myNumGatherTracesAlloc*myNumHeaders];
+  }
+  for( int itrc = 0; itrc < numTraces; itrc++ ) {
+    extractValues( traceGather->trace(itrc)->getTraceHeader(), &myGatherValues[itrc*myNumHeaders] );
+  }
+  return mySelection->contains( myGatherValues, numTraces, isSelected );
+}
 bool csSelectionManager::contains( cseis_geolib::csFlexHeader const* hdrValue ) {
   for( int i = 0; i < myNumHeaders; i++ ) {
     if( myHeaderType[i] == cseis_geolib::TYPE_FLOAT ) {
@@ -19,6 +19,7 @@ namespace cseis_system {
 
 class csTraceHeaderDef;
 class csTraceHeader;
+class csTraceGather;
 
 /**
  * Manages all aspects of a user header 'selection'
@@ -65,6 +66,15 @@ public:
    * @return true if the header value passed to this method is contained in the trace header value selections
    */
   bool contains( cseis_geolib::csFlexHeader const* hdrValue );
+  /**
+   * Which traces of the given trace gather are contained in the selection?
+   * All header values of the gather are extracted first, and then evaluated in one go.
+   *
+   * @param traceGather  Trace gather
+   * @param isSelected   (o) For each trace: true if trace header values are contained in the selection
+   * @return Number of selected traces
+   */
+  int contains( cseis_system::csTraceGather const* traceGather, bool* isSelected );
   /**
    * @param index Index of trace header to return (>0 in case selection is based on more than one trace header)
    * @return Trace header name
@@ -74,6 +84,7 @@ public:
   void dump();
 private:
   csSelectionManager( csSelectionManager const& obj );
+  void extractValues( cseis_system::csTraceHeader const* trcHeader, cseis_geolib::csFlexNumber* values ) const;
   /// Number of trace headers in this selection
   int  myNumHeaders;
   /// Trace header indexes 
@@ -86,6 +97,9 @@ private:
   cseis_geolib::csSelection* mySelection;
   /// Temporary field used to store the trace header values of the current trace
   cseis_geolib::csFlexNumber* myValues;
+  /// Trace header values of all traces of one gather
+  cseis_geolib::csFlexNumber* myGatherValues;
+  int myNumGatherTracesAlloc;
 };
 
 } // namespace
@@ -226,6 +226,17 @@ void csStackUtil::normStackedTrace( csTrace* trace, int nTraces ) {
     }
   } // END norm time variant
 }
+void csStackUtil::resetNormTrace( csTrace const* trace ) {
+  if( !myNormTimeVariant ) return;
+  int keyValue = 0;
+  if( myHdrId_keyValue >= 0 ) keyValue = trace->getTraceHeader()->intValue(myHdrId_keyValue);
+  std::map<int,int>::iterator iter = myNormTraceIndexMap->find( keyValue );
+  if( iter == myNormTraceIndexMap->end() ) return;
+  int* normTrace = myNormTraceList->at( iter->second );
+  for( int isamp = 0; isamp < myNumSamples; isamp++ ) {
+    normTrace[isamp] = 0;
+  }
+}
 void csStackUtil::stackHeaders( csTraceHeader* trcHdrOut, csTraceHeader const* trcHdrIn ) {
   int nHeaders = trcHdrIn->numHeaders();
   for( int ihdr = 0; ihdr < nHeaders; ihdr++ ) {
@@ -45,6 +45,11 @@ public:
   void stackTrace( csTrace* stackedTrace, csTrace const* traceIn );
   void normStackedTraceOld( csTrace* trace, int nTraces );
   void normStackedTrace( csTrace* trace, int nTraces );
+  /**
+  * Reset coverage trace used for time variant normalisation of the given stacked trace.
+  * Call after the stacked trace has been normalised and output, if further traces with the same key value may follow.
+  */
+  void resetNormTrace( csTrace const* trace );
 
   void setOutputNormTrace( bool doOutputNormTrace );
   void setTimeVariantNorm( bool doTimeVariantNorm, int hdrId_keyValue );